@@ -20,6 +20,7 @@
 #include <sstream>
 #include "../math_linalg/liblinalg.h"
 #include "../qobjects/libqobjects.h"
+#include "../math_symmetry/libsymmetry.h"
 
 
 /// liblibra namespace
@@ -28,6 +29,7 @@ namespace liblibra{
 using namespace std;
 using namespace liblinalg;
 using namespace libqobjects;
+using namespace libsymmetry;
 
 /// libbasis namespace
 namespace libbasis{
@@ -54,6 +56,7 @@ int num_valence_elec(int);
 
 // Basis_ovlp.cpp
 void update_overlap_matrix(int,int,int,const VECTOR&,const VECTOR&,const VECTOR&, vector<AO>&,MATRIX&);
+void update_overlap_matrix(int,int,int,const VECTOR&,const VECTOR&,const VECTOR&, vector<AO>&,MATRIX&, PairIntegralCache*);
 
 void MO_overlap(MATRIX& Smo, vector<AO>& ao_i, vector<AO>& ao_j, MATRIX& Ci, MATRIX& Cj,
  vector<int>& active_orb_i, vector<int>& active_orb_j, double max_d2);
@@ -88,6 +91,16 @@ void update_derivative_coupling_matrix
 );
 
 
+// Basis_symmetry.cpp
+MATRIX ao_transformation_matrix(vector<AO>& basis_ao, vector<int>& ao_atom, SYMMETRY& sym, int g);
+
+void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
+                           vector<AO>& basis_ao, MATRIX& Sao, PairIntegralCache* cache,
+                           SYMMETRY& sym, vector<int>& ao_atom);
+void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
+                           vector<AO>& basis_ao, MATRIX& Sao, SYMMETRY& sym, vector<int>& ao_atom);
+
+
 
 
 }//namespace libbasis
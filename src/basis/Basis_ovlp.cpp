@@ -31,7 +31,7 @@ namespace libbasis{
 
 
 void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
-                           vector<AO>& basis_ao, MATRIX& Sao){
+                           vector<AO>& basis_ao, MATRIX& Sao, PairIntegralCache* cache){
 /**
   \brief Update the oberlap matrix (in AO basis): <AO(i)|AO(j)>
   \param[in] x_period Then number of periodic shells in X direction: 0 - only the central shell, 1 - [-1,0,1], etc.
@@ -42,6 +42,7 @@ void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR&
   \param[in] t3 The periodicity vector along c crystal direction ("Z")
   \param[in] basis_ao The list of all AOs (basis)
   \param[out] Sao The output overlap matrix
+  \param[in,out] cache The tables of the two-center overlaps (NULL - compute all the integrals directly)
 
   This function can also take periodic images of the system into account
 */
@@ -69,12 +70,14 @@ void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR&
             if(i==j){
               AO tmp_ao(basis_ao[i]); 
               tmp_ao.shift_position(TV);
-              Sao.M[i*Norb+j] += gaussian_overlap(basis_ao[i],tmp_ao); //,0,dIdA,dIdB,aux,n_aux,TV);
+              if(cache==NULL){ Sao.M[i*Norb+j] += gaussian_overlap(basis_ao[i],tmp_ao); } //,0,dIdA,dIdB,aux,n_aux,TV);
+              else{ Sao.M[i*Norb+j] += cache->overlap(basis_ao[i],tmp_ao); }
             }
             else{
 
               basis_ao[j].shift_position(TV);
-              Sao.M[i*Norb+j] += gaussian_overlap(basis_ao[i],basis_ao[j]); //,0,dIdA,dIdB,aux,n_aux,TV);
+              if(cache==NULL){ Sao.M[i*Norb+j] += gaussian_overlap(basis_ao[i],basis_ao[j]); } //,0,dIdA,dIdB,aux,n_aux,TV);
+              else{ Sao.M[i*Norb+j] += cache->overlap(basis_ao[i],basis_ao[j]); }
               basis_ao[j].shift_position(-TV);
 
             }// i != j
@@ -145,6 +148,17 @@ void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR&
 }
 
 
+void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
+                           vector<AO>& basis_ao, MATRIX& Sao){
+/**
+  Same as above, but all the integrals are computed directly
+*/
+
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, Sao, NULL);
+
+}
+
+
 void pop_cols(MATRIX& X, MATRIX& x, vector<int>& cols){
 // Copies selected columns from X to x 
 
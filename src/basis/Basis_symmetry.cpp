@@ -0,0 +1,393 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Basis_symmetry.cpp
+  \brief The file implements the transformation of the AOs by the symmetry operations and the symmetry-reduced
+  build of the AO overlap matrix
+
+*/
+
+#include <map>
+#include "Basis.h"
+#include "../math_meigen/libmeigen.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace libmeigen;
+using namespace libqobjects;
+using namespace libsymmetry;
+
+
+/// libbasis namespace
+namespace libbasis{
+
+
+// The polynomials are stored as the maps: the key of the monomial x^a * y^b * z^c -> its coefficient
+static int mono_key(int a, int b, int c){  return (a*32 + b)*32 + c;  }
+
+
+static void ao_polynomial(AO& ao, std::map<int,double>& poly){
+/**
+  The angular part of the AO: the sum of the coefficients of the primitives with the exponent of the first
+  primitive. All the other exponents of the contraction enter with the same angular polynomial
+*/
+
+  poly.clear();
+  double alp0 = ao.primitives[0].alpha;
+
+  for(int k=0;k<ao.expansion_size;k++){
+    PrimitiveG& g = ao.primitives[k];
+    if(fabs(g.alpha - alp0) > 1e-10*alp0){ continue; }
+    poly[mono_key(g.x_exp, g.y_exp, g.z_exp)] += ao.coefficients[k];
+  }
+}
+
+
+static void rotate_polynomial(std::map<int,double>& p, MATRIX3x3& R, std::map<int,double>& res){
+/**
+  Computes res(u) = p(R*u)
+*/
+
+  double L[3][3] = { {R.xx, R.xy, R.xz}, {R.yx, R.yy, R.yz}, {R.zx, R.zy, R.zz} };
+
+  res.clear();
+
+  std::map<int,double>::iterator it, jt;
+  for(it=p.begin(); it!=p.end(); it++){
+    int e[3] = { it->first/1024, (it->first/32)%32, it->first%32 };
+
+    std::map<int,double> t, t2;
+    t[0] = it->second;
+
+    // Multiply by the linear forms (R*u)_x, (R*u)_y, (R*u)_z the needed number of times
+    for(int d=0; d<3; d++){
+      for(int n=0; n<e[d]; n++){
+        t2.clear();
+        for(jt=t.begin(); jt!=t.end(); jt++){
+          int a = jt->first/1024, b = (jt->first/32)%32, c = jt->first%32;
+          t2[mono_key(a+1, b, c)] += jt->second * L[d][0];
+          t2[mono_key(a, b+1, c)] += jt->second * L[d][1];
+          t2[mono_key(a, b, c+1)] += jt->second * L[d][2];
+        }
+        t = t2;
+      }
+    }
+
+    for(jt=t.begin(); jt!=t.end(); jt++){  res[jt->first] += jt->second;  }
+  }
+
+}
+
+
+static vector< vector<int> > atom_ao_lists(int nat, vector<int>& ao_atom){
+/**
+  The lists of the AOs (in the order of the basis) of every atom
+*/
+  vector< vector<int> > res(nat);
+  for(int i=0;i<ao_atom.size();i++){
+    if(ao_atom[i]<0 || ao_atom[i]>=nat){
+      cout<<"Error in atom_ao_lists: the AO "<<i<<" refers to a non-existing atom "<<ao_atom[i]<<"\n"; exit(0);
+    }
+    res[ao_atom[i]].push_back(i);
+  }
+  return res;
+}
+
+
+static void ao_transformation_blocks(vector<AO>& basis_ao, vector< vector<int> >& at_aos, SYMMETRY& sym, int g,
+                                     vector<MATRIX>& D){
+/**
+  Computes, for every atom a, the matrix D[a] that expresses the AOs of the atom a' = perm[g][a] transformed
+  by the inverse of the operation g via the AOs of the atom a:
+
+  AO_n(a') o g  =  sum_m { D[a]_mn * AO_m(a) }   (both AOs on the same lattice cell)
+
+  The AOs of the two atoms are matched shell by shell, the shells being the consecutive AOs with the same ao_shell.
+*/
+
+  int nat = at_aos.size();
+  MATRIX3x3& R = sym.rot[g];
+
+  D.clear();
+
+  for(int a=0;a<nat;a++){
+    int ap = sym.perm[g][a];
+    vector<int>& A = at_aos[a];
+    vector<int>& B = at_aos[ap];
+    int na = A.size();
+
+    if(B.size()!=na){
+      cout<<"Error in ao_transformation_blocks: the atoms "<<a<<" and "<<ap<<" are symmetry-equivalent, but have "
+          <<na<<" and "<<B.size()<<" AOs\n"; exit(0);
+    }
+
+    D.push_back(MATRIX(na, na));
+
+    int s = 0;
+    while(s<na){
+      // The shell: [s, e)
+      int e = s+1;
+      while(e<na && basis_ao[A[e]].ao_shell==basis_ao[A[s]].ao_shell){ e++; }
+      int ns = e - s;
+
+      vector< std::map<int,double> > q(ns), y(ns);
+      std::map<int,double> p;
+      std::map<int,int> idx;   // monomial key -> row
+
+      for(int k=0;k<ns;k++){
+        ao_polynomial(basis_ao[A[s+k]], q[k]);
+        ao_polynomial(basis_ao[B[s+k]], p);
+        rotate_polynomial(p, R, y[k]);
+
+        std::map<int,double>::iterator it;
+        for(it=q[k].begin(); it!=q[k].end(); it++){ if(!idx.count(it->first)){ int r = idx.size(); idx[it->first] = r; } }
+        for(it=y[k].begin(); it!=y[k].end(); it++){ if(!idx.count(it->first)){ int r = idx.size(); idx[it->first] = r; } }
+      }
+
+      // Least squares: Q * x = y_k, with Q(monomials x shell AOs of a)
+      int nm = idx.size();
+      MATRIX Q(nm, ns), Y(nm, ns);
+      for(int k=0;k<ns;k++){
+        std::map<int,double>::iterator it;
+        for(it=q[k].begin(); it!=q[k].end(); it++){ Q.M[idx[it->first]*ns + k] = it->second; }
+        for(it=y[k].begin(); it!=y[k].end(); it++){ Y.M[idx[it->first]*ns + k] = it->second; }
+      }
+
+      MATRIX QQ(ns, ns), iQQ(ns, ns);
+      QQ = Q.T() * Q;
+      FullPivLU_inverse(QQ, iQQ);
+      MATRIX X(ns, ns);
+      X = iQQ * (Q.T() * Y);
+
+      MATRIX res(nm, ns);
+      res = Q * X - Y;
+      double err = 0.0, nrm = 0.0;
+      for(int k=0;k<nm*ns;k++){ err += res.M[k]*res.M[k];  nrm += Y.M[k]*Y.M[k]; }
+      if(err > 1e-12*nrm){
+        cout<<"Error in ao_transformation_blocks: the AO shell "<<basis_ao[A[s]].ao_shell<<" of the atom "<<a
+            <<" is not closed under the symmetry operation "<<g<<"\n"; exit(0);
+      }
+
+      for(int m=0;m<ns;m++){
+        for(int n=0;n<ns;n++){  D[a].M[(s+m)*na + (s+n)] = X.M[m*ns+n];  }
+      }
+
+      s = e;
+    }// while s
+
+  }// for a
+
+}
+
+
+MATRIX ao_transformation_matrix(vector<AO>& basis_ao, vector<int>& ao_atom, SYMMETRY& sym, int g){
+/**
+  \brief The representation of the symmetry operation in the AO basis
+  \param[in] basis_ao The AO basis
+  \param[in] ao_atom The index of the atom on which every AO is centered
+  \param[in] sym The symmetry operations of the system (e.g. from System::find_symmetry)
+  \param[in] g The index of the operation
+
+  Returns the Norb x Norb matrix D such that the AO i transformed by the inverse of g (the AO of the atom
+  perm[g][a_i] if i is on the atom a_i) is sum_j { D_ji * AO_j }. For the molecules, the overlap (and any other
+  operator invariant w.r.t. the symmetry) matrix satisfies: D^T * S * D = S
+*/
+
+  int Norb = basis_ao.size();
+  vector< vector<int> > at_aos = atom_ao_lists(sym.nat, ao_atom);
+  vector<MATRIX> D;
+
+  ao_transformation_blocks(basis_ao, at_aos, sym, g, D);
+
+  MATRIX res(Norb, Norb);
+
+  for(int a=0;a<sym.nat;a++){
+    vector<int>& A = at_aos[a];
+    vector<int>& B = at_aos[sym.perm[g][a]];
+    int na = A.size();
+
+    for(int m=0;m<na;m++){
+      for(int n=0;n<na;n++){  res.M[A[m]*Norb + B[n]] = D[a].M[m*na+n];  }
+    }
+  }
+
+  return res;
+}
+
+
+
+void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
+                           vector<AO>& basis_ao, MATRIX& Sao, PairIntegralCache* cache,
+                           SYMMETRY& sym, vector<int>& ao_atom){
+/**
+  \brief Same as update_overlap_matrix, but only the symmetry-inequivalent atom-pair blocks are computed
+  \param[in] x_period, y_period, z_period The numbers of the periodic shells in every direction
+  \param[in] t1, t2, t3 The periodicity vectors; if any images are included, they must be the cell vectors
+  of the space group sym
+  \param[in] basis_ao The list of all AOs (basis)
+  \param[out] Sao The output overlap matrix
+  \param[in,out] cache The tables of the two-center overlaps (NULL - compute all the integrals directly)
+  \param[in] sym The symmetry operations of the system (e.g. from System::find_symmetry)
+  \param[in] ao_atom The index of the atom on which every AO is centered
+
+  The blocks S_ab(n) = <AO(a)|AO(b) + n> for the atoms a and b and the image n are related by the symmetry:
+
+  S_a'b'(W*n + L_b - L_a) = D_a^T * S_ab(n) * D_b
+
+  so every block is computed directly only once per orbit of (a, b, n) and all the other blocks of the orbit
+  (within the considered images) are obtained by the transformation. The result is the same as computed without
+  the symmetry, with the cost reduced by up to the order of the group.
+*/
+
+  int i, j, a, b, g;
+  int Norb = basis_ao.size();
+  int nat = sym.nat;
+  int ng = sym.order();
+
+  if(ao_atom.size()!=Norb){
+    cout<<"Error in update_overlap_matrix: the size of ao_atom ("<<ao_atom.size()<<") is not equal to the number of AOs ("
+        <<Norb<<")\n"; exit(0);
+  }
+  if(!sym.is_periodic && (x_period>0 || y_period>0 || z_period>0)){
+    cout<<"Error in update_overlap_matrix: the point group symmetry can not be used with the periodic images\n"; exit(0);
+  }
+  if(sym.is_periodic && (x_period>0 || y_period>0 || z_period>0)){
+    // The lattice shifts of the operations are in the units of the cell of sym
+    VECTOR c1, c2, c3;
+    MATRIX3x3 cell(sym.get_cell());
+    cell.get_vectors(c1, c2, c3);
+    if((c1 - t1).length() > sym.tol || (c2 - t2).length() > sym.tol || (c3 - t3).length() > sym.tol){
+      cout<<"Error in update_overlap_matrix: the periodicity vectors t1 = "<<t1<<", t2 = "<<t2<<", t3 = "<<t3
+          <<" do not match the cell of the space group: "<<c1<<", "<<c2<<", "<<c3<<"\n"; exit(0);
+    }
+  }
+
+  vector< vector<int> > at_aos = atom_ao_lists(nat, ao_atom);
+
+  vector< vector<MATRIX> > D(ng);
+  for(g=0;g<ng;g++){  ao_transformation_blocks(basis_ao, at_aos, sym, g, D[g]);  }
+
+  int nx = 2*x_period+1, ny = 2*y_period+1, nz = 2*z_period+1;
+  int nimg = nx*ny*nz;
+
+  vector<MATRIX*> blk(nat*nat*nimg, NULL);
+
+  #define BLOCK_INDEX(a, b, ix, iy, iz) ( ((a)*nat + (b))*nimg + (((ix)+x_period)*ny + ((iy)+y_period))*nz + ((iz)+z_period) )
+  #define IN_BOX(ix, iy, iz) ( abs(ix)<=x_period && abs(iy)<=y_period && abs(iz)<=z_period )
+
+  for(a=0;a<nat;a++){
+    for(b=0;b<nat;b++){
+      int na = at_aos[a].size(), nb = at_aos[b].size();
+
+      for(int ix=-x_period; ix<=x_period; ix++){
+        for(int iy=-y_period; iy<=y_period; iy++){
+          for(int iz=-z_period; iz<=z_period; iz++){
+
+            if(blk[BLOCK_INDEX(a,b,ix,iy,iz)]!=NULL){ continue; }
+
+            // Compute the block directly
+            VECTOR TV = ix*t1 + iy*t2 + iz*t3;
+            MATRIX* S = new MATRIX(na, nb);
+
+            for(int m=0;m<na;m++){
+              for(int n=0;n<nb;n++){
+                i = at_aos[a][m];  j = at_aos[b][n];
+
+                if(i==j){
+                  AO tmp_ao(basis_ao[i]);
+                  tmp_ao.shift_position(TV);
+                  if(cache==NULL){ S->M[m*nb+n] = gaussian_overlap(basis_ao[i],tmp_ao); }
+                  else{ S->M[m*nb+n] = cache->overlap(basis_ao[i],tmp_ao); }
+                }
+                else{
+                  basis_ao[j].shift_position(TV);
+                  if(cache==NULL){ S->M[m*nb+n] = gaussian_overlap(basis_ao[i],basis_ao[j]); }
+                  else{ S->M[m*nb+n] = cache->overlap(basis_ao[i],basis_ao[j]); }
+                  basis_ao[j].shift_position(-TV);
+                }
+              }// for n
+            }// for m
+
+            blk[BLOCK_INDEX(a,b,ix,iy,iz)] = S;
+
+            // Unfold it to the whole orbit: S_a'b'(n') = D_a^T * S * D_b and S_b'a'(-n') = (S_a'b'(n'))^T
+            for(g=0;g<ng;g++){
+              int ap = sym.perm[g][a], bp = sym.perm[g][b];
+              MATRIX3x3& W = sym.rot_frac[g];
+              int* La = &sym.lattice_shift[g][3*a];
+              int* Lb = &sym.lattice_shift[g][3*b];
+
+              int jx = (int)floor(W.xx*ix + W.xy*iy + W.xz*iz + 0.5) + Lb[0] - La[0];
+              int jy = (int)floor(W.yx*ix + W.yy*iy + W.yz*iz + 0.5) + Lb[1] - La[1];
+              int jz = (int)floor(W.zx*ix + W.zy*iy + W.zz*iz + 0.5) + Lb[2] - La[2];
+
+              if(!IN_BOX(jx, jy, jz)){ continue; }
+
+              int I1 = BLOCK_INDEX(ap, bp, jx, jy, jz);
+              int I2 = BLOCK_INDEX(bp, ap, -jx, -jy, -jz);
+              if(blk[I1]!=NULL && blk[I2]!=NULL){ continue; }
+
+              MATRIX Sg(na, nb);
+              Sg = D[g][a].T() * (*S) * D[g][b];
+
+              if(blk[I1]==NULL){  blk[I1] = new MATRIX(Sg);  }
+              if(blk[I2]==NULL){  blk[I2] = new MATRIX(Sg.T());  }
+            }// for g
+
+          }// for iz
+        }// for iy
+      }// for ix
+
+    }// for b
+  }// for a
+
+
+  // Sum over the images
+  Sao = 0.0;
+
+  for(a=0;a<nat;a++){
+    for(b=0;b<nat;b++){
+      int na = at_aos[a].size(), nb = at_aos[b].size();
+
+      for(int I=0; I<nimg; I++){
+        MATRIX* S = blk[(a*nat + b)*nimg + I];
+
+        for(int m=0;m<na;m++){
+          for(int n=0;n<nb;n++){  Sao.M[at_aos[a][m]*Norb + at_aos[b][n]] += S->M[m*nb+n];  }
+        }
+        delete S;
+      }
+    }// for b
+  }// for a
+
+  #undef BLOCK_INDEX
+  #undef IN_BOX
+
+}
+
+
+void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR& t1, const VECTOR& t2, const VECTOR& t3,
+                           vector<AO>& basis_ao, MATRIX& Sao, SYMMETRY& sym, vector<int>& ao_atom){
+/**
+  Same as above, but all the integrals are computed directly
+*/
+
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, Sao, NULL, sym, ao_atom);
+
+}
+
+
+
+}//namespace libbasis
+}//namespace liblibra
+
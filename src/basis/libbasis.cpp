@@ -104,6 +104,13 @@ void export_basis_objects(){
    vector<AO>& basis_ao, int c, MATRIX& Dao_x, MATRIX& Dao_y, MATRIX& Dao_z
   ) = &update_derivative_coupling_matrix;
 
+  // Basis_symmetry.cpp
+  MATRIX (*expt_ao_transformation_matrix_v1)(vector<AO>& basis_ao, vector<int>& ao_atom, SYMMETRY& sym, int g)
+  = &ao_transformation_matrix;
+
+  void (*expt_update_overlap_matrix_v2)(int,int,int,const VECTOR&,const VECTOR&,const VECTOR&,
+  vector<AO>&,MATRIX&, SYMMETRY&, vector<int>&) = &update_overlap_matrix;
+
 
 
 
@@ -131,6 +138,9 @@ void export_basis_objects(){
 
   def("update_derivative_coupling_matrix", expt_update_derivative_coupling_matrix_v1);
 
+  def("ao_transformation_matrix", expt_ao_transformation_matrix_v1);
+  def("update_overlap_matrix", expt_update_overlap_matrix_v2);
+
 
 
   class_<basisset_shell_struct>("basisset_shell_struct",init<int>())
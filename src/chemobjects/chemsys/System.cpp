@@ -59,6 +59,10 @@ void System::init_variables(){
   Number_of_frag_pairs = 0;
   Number_of_surface_atoms = 0;
 
+  indexed_bonds = 0;
+  indexed_angles = 0;
+  indexed_dihedrals = 0;
+
   Nf_t = 0;     is_Nf_t = 1;
   Nf_r = 0;     is_Nf_r = 1;
 /*
@@ -120,6 +124,10 @@ void System::copy_content(const System& sys){
   Frag_pairs = sys.Frag_pairs;
   Surface_atoms = sys.Surface_atoms;
 
+  atom_bonds = sys.atom_bonds;          indexed_bonds = sys.indexed_bonds;
+  atom_angles = sys.atom_angles;        indexed_angles = sys.indexed_angles;
+  atom_dihedrals = sys.atom_dihedrals;  indexed_dihedrals = sys.indexed_dihedrals;
+
   if(sys.is_name){  name = sys.name;  is_name = 1; }
   if(sys.is_id){  id = sys.id;  is_id = 1; }
   if(sys.is_mass){ mass = sys.mass; is_mass = 1; }
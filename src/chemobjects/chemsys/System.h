@@ -19,6 +19,7 @@
 
 #include "../../math_random/librandom.h"
 #include "../../math_graph/libgraph.h"
+#include "../../math_symmetry/libsymmetry.h"
 #include "../../math_linalg/liblinalg.h"
 #include "../mol/libmol.h"
 
@@ -29,6 +30,7 @@ namespace liblibra{
 
 using namespace librandom;
 using namespace libgraph;
+using namespace libsymmetry;
 using namespace liblinalg;
 
 
@@ -70,6 +72,17 @@ class System{
   int max_fragment_id; int is_max_fragment_id;
   int max_molecule_id; int is_max_molecule_id;
 
+  //---------- Topology index: defined in System_methods.cpp ----------
+  // For each atom - the indices of the bonds, angles and dihedrals which this atom terminates
+  // (any atom of a bond, atoms 1 and 3 of an angle, atoms 1 and 4 of a dihedral), in increasing order
+  vector< vector<int> > atom_bonds;
+  vector< vector<int> > atom_angles;
+  vector< vector<int> > atom_dihedrals;
+  int indexed_bonds, indexed_angles, indexed_dihedrals;  ///< The number of the groups included in the index
+
+  void index_group(vector< vector<int> >& atom_groups,int at_indx,int gr_indx);
+  void update_topology_index();
+
   //----------- Defined in System_methods4.cpp ------------------
   // Chemistry related functions:
   int is(std::string,int,int,int,Atom**,vector<Atom*>&);
@@ -186,12 +199,14 @@ public:
   int is_13pair(int,int);
   int is_14pair(int,int);
   int is_group_pair(int,int);
+  void get_12_13_14_atoms(int,vector<int>&,vector<int>&,vector<int>&);
 
   //----------- Defined in System_methods1.cpp -----------
   // Topological functions
   void Generate_Connectivity_Matrix();
   void Assign_Rings();
   void DIVIDE_GRAPH(int,int, vector<int>&);  
+  void find_symmetry(double tol, SYMMETRY& sym);
 
   //----------- Defined in System_methods2.cpp ------------------
   // Builder functions
@@ -329,6 +344,12 @@ public:
   void print_xyz(std::string,int);
   void print_xyz(std::string,int,std::string,int);
 
+  //---------------- Defined in System_methods8.cpp -----------------
+  void write_binary_frame(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies);
+  void write_binary_frame(BinaryTrajectoryWriter& w, int step, double time);
+  void read_binary_frame(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr);
+  void read_binary_frame(BinaryTrajectoryReader& r, int i);
+
 
   
 };
@@ -72,6 +72,58 @@ int System::get_molecule_index_by_molecule_id(int id){
 }
 
 
+void System::index_group(vector< vector<int> >& atom_groups,int at_indx,int gr_indx){
+/**
+  \brief Auxiliary function: adds the group (bond, angle, dihedral) with index gr_indx to the list
+  of the groups of the atom with index at_indx
+*/
+  if(at_indx<0){ return; }
+  if(at_indx>=atom_groups.size()){ atom_groups.resize(at_indx+1); }
+  vector<int>& lst = atom_groups[at_indx];
+  if(lst.size()==0 || lst[lst.size()-1]!=gr_indx){ lst.push_back(gr_indx); }
+}
+
+void System::update_topology_index(){
+/**
+  \brief Makes sure the per-atom lists of bonds, angles and dihedrals are consistent with the
+  Bonds, Angles and Dihedrals arrays.
+
+  The lists are extended incrementally as the groups are created (see create_bond, create_angle
+  and create_dihedral), so normally this function does nothing. The lists are rebuilt from scratch
+  only if the arrays have been changed otherwise (e.g. set directly from Python).
+*/
+  int i;
+
+  if(indexed_bonds!=Number_of_bonds){
+    atom_bonds.clear();  atom_bonds.resize(Number_of_atoms);
+    for(i=0;i<Number_of_bonds;i++){
+      index_group(atom_bonds, Bonds[i].globAtom_Index[0], i);
+      index_group(atom_bonds, Bonds[i].globAtom_Index[1], i);
+    }
+    indexed_bonds = Number_of_bonds;
+  }
+
+  if(indexed_angles!=Number_of_angles){
+    atom_angles.clear();  atom_angles.resize(Number_of_atoms);
+    for(i=0;i<Number_of_angles;i++){
+      index_group(atom_angles, Angles[i].globAtom_Index[0], i);
+      index_group(atom_angles, Angles[i].globAtom_Index[2], i);
+    }
+    indexed_angles = Number_of_angles;
+  }
+
+  if(indexed_dihedrals!=Number_of_dihedrals){
+    atom_dihedrals.clear();  atom_dihedrals.resize(Number_of_atoms);
+    for(i=0;i<Number_of_dihedrals;i++){
+      index_group(atom_dihedrals, Dihedrals[i].globAtom_Index[0], i);
+      index_group(atom_dihedrals, Dihedrals[i].globAtom_Index[3], i);
+    }
+    indexed_dihedrals = Number_of_dihedrals;
+  }
+
+}
+
+
 int System::Find_Bond(int at_indx1,int at_indx2){
 /**
   \param[in] at_indx1 The index of the atom #1
@@ -80,10 +132,17 @@ int System::Find_Bond(int at_indx1,int at_indx2){
   This class System method is looking for the bond formed by 2 atoms 
   with globAtom_Indexes given by at_indx1, at_indx2
   It returns globGroup_Index of corresponding bond
+  Only the bonds of the atom #1 are checked, so the cost is O(number of bonds of the atom)
 */
 
+  update_topology_index();
+
   int res = -1;
-  for(int i=0;i<Number_of_bonds;i++){
+  if(at_indx1<0 || at_indx1>=atom_bonds.size()){ return res; }
+
+  vector<int>& lst = atom_bonds[at_indx1];
+  for(int n=0;n<lst.size();n++){
+    int i = lst[n];
     if((  (Bonds[i].globAtom_Index[0]==at_indx1) && (Bonds[i].globAtom_Index[1]==at_indx2)  )||
        (  (Bonds[i].globAtom_Index[0]==at_indx2) && (Bonds[i].globAtom_Index[1]==at_indx1)  )
       ){   res = i;break;   }
@@ -121,8 +180,14 @@ int System::Find_Angle(int at_indx1,int at_indx3){
   It returns globGroup_Index of corresponding angle
 */
 
+  update_topology_index();
+
   int res = -1;
-  for(int i=0;i<Number_of_angles;i++){
+  if(at_indx1<0 || at_indx1>=atom_angles.size()){ return res; }
+
+  vector<int>& lst = atom_angles[at_indx1];
+  for(int n=0;n<lst.size();n++){
+    int i = lst[n];
     if((  (Angles[i].globAtom_Index[0]==at_indx1) && (Angles[i].globAtom_Index[2]==at_indx3)  )||
        (  (Angles[i].globAtom_Index[0]==at_indx3) && (Angles[i].globAtom_Index[2]==at_indx1)  )
       ){   res = i;break;   }
@@ -141,8 +206,14 @@ int System::Find_Angle(int at_indx1,int at_indx2,int at_indx3){
   It returns globGroup_Index of corresponding angle
 */
 
+  update_topology_index();
+
   int res = -1;
-  for(int i=0;i<Number_of_angles;i++){
+  if(at_indx1<0 || at_indx1>=atom_angles.size()){ return res; }
+
+  vector<int>& lst = atom_angles[at_indx1];
+  for(int n=0;n<lst.size();n++){
+    int i = lst[n];
     if((  (Angles[i].globAtom_Index[0]==at_indx1) && (Angles[i].globAtom_Index[1]==at_indx2) && (Angles[i].globAtom_Index[2]==at_indx3) )||
        (  (Angles[i].globAtom_Index[0]==at_indx3) && (Angles[i].globAtom_Index[1]==at_indx2) && (Angles[i].globAtom_Index[2]==at_indx1) )
       ){   res = i;break;   }
@@ -162,8 +233,14 @@ int System::Find_Dihedral(int at_indx1,int at_indx2,int at_indx3,int at_indx4){
   It returns globGroup_Index of corresponding dihedral
 */
 
+  update_topology_index();
+
   int res = -1;
-  for(int i=0;i<Number_of_dihedrals;i++){
+  if(at_indx1<0 || at_indx1>=atom_dihedrals.size()){ return res; }
+
+  vector<int>& lst = atom_dihedrals[at_indx1];
+  for(int n=0;n<lst.size();n++){
+    int i = lst[n];
     if((  (Dihedrals[i].globAtom_Index[0]==at_indx1)
         &&(Dihedrals[i].globAtom_Index[1]==at_indx2)
         &&(Dihedrals[i].globAtom_Index[2]==at_indx3)
@@ -207,7 +284,7 @@ int System::is_12pair(int at_indx1,int at_indx2){
 
   int res = 0;
   for(int i=0;i<Atoms[at_indx1].globAtom_Adjacent_Atoms.size();i++){
-    if(Atoms[at_indx1].globAtom_Adjacent_Atoms[i]==at_indx2){ res = 1; }
+    if(Atoms[at_indx1].globAtom_Adjacent_Atoms[i]==at_indx2){ res = 1; break; }
   }
   return res;
 }
@@ -224,9 +301,9 @@ int System::is_13pair(int at_indx1,int at_indx2){
 */
 
   int res = 0;
-  for(int i=0;i<Atoms[at_indx1].globAtom_Adjacent_Atoms.size();i++){
+  for(int i=0;i<Atoms[at_indx1].globAtom_Adjacent_Atoms.size() && !res;i++){
     for(int j=0;j<Atoms[at_indx2].globAtom_Adjacent_Atoms.size();j++){
-      if(Atoms[at_indx1].globAtom_Adjacent_Atoms[i]==Atoms[at_indx2].globAtom_Adjacent_Atoms[j]){ res = 1; }
+      if(Atoms[at_indx1].globAtom_Adjacent_Atoms[i]==Atoms[at_indx2].globAtom_Adjacent_Atoms[j]){ res = 1; break; }
     }
   }
   return res;
@@ -245,9 +322,9 @@ int System::is_14pair(int at_indx1,int at_indx2){
 */
 
   int res = 0;
-  for(int i=0;i<Atoms[at_indx1].globAtom_Adjacent_Atoms.size();i++){
+  for(int i=0;i<Atoms[at_indx1].globAtom_Adjacent_Atoms.size() && !res;i++){
     for(int j=0;j<Atoms[at_indx2].globAtom_Adjacent_Atoms.size();j++){
-      if(is_12pair(Atoms[at_indx1].globAtom_Adjacent_Atoms[i],Atoms[at_indx2].globAtom_Adjacent_Atoms[j])){ res = 1; }
+      if(is_12pair(Atoms[at_indx1].globAtom_Adjacent_Atoms[i],Atoms[at_indx2].globAtom_Adjacent_Atoms[j])){ res = 1; break; }
     }
   }
   return res;
@@ -267,6 +344,39 @@ int System::is_group_pair(int at_indx1,int at_indx2){
   return (Atoms[at_indx1].globGroup_Index == Atoms[at_indx2].globGroup_Index);
 }
 
+void System::get_12_13_14_atoms(int at_indx,vector<int>& at12,vector<int>& at13,vector<int>& at14){
+/**
+  \param[in] at_indx The index of the atom
+  \param[out] at12 The indices of all atoms j for which is_12pair(at_indx, j) is 1
+  \param[out] at13 The indices of all atoms j for which is_13pair(at_indx, j) is 1
+  \param[out] at14 The indices of all atoms j for which is_14pair(at_indx, j) is 1
+
+  The lists are sorted and contain no repetitions. They are obtained by walking the adjacency
+  lists, so the cost depends only on the local connectivity, not on the size of the system.
+  Note that the lists may overlap (e.g. in small rings) and at13 contains at_indx itself if the
+  atom has any neighbors - exactly as the is_12pair, is_13pair and is_14pair predicates do.
+*/
+
+  int i,j,k;
+  at12.clear(); at13.clear(); at14.clear();
+
+  vector<int>& adj1 = Atoms[at_indx].globAtom_Adjacent_Atoms;
+  for(i=0;i<adj1.size();i++){
+    at12.push_back(adj1[i]);
+    vector<int>& adj2 = Atoms[adj1[i]].globAtom_Adjacent_Atoms;
+    for(j=0;j<adj2.size();j++){
+      at13.push_back(adj2[j]);
+      vector<int>& adj3 = Atoms[adj2[j]].globAtom_Adjacent_Atoms;
+      for(k=0;k<adj3.size();k++){  at14.push_back(adj3[k]);  }
+    }
+  }
+
+  std::sort(at12.begin(),at12.end());  at12.erase(std::unique(at12.begin(),at12.end()),at12.end());
+  std::sort(at13.begin(),at13.end());  at13.erase(std::unique(at13.begin(),at13.end()),at13.end());
+  std::sort(at14.begin(),at14.end());  at14.erase(std::unique(at14.begin(),at14.end()),at14.end());
+
+}
+
 
 void System::show_atoms(){
 /**
@@ -53,89 +53,47 @@ void System::Generate_Connectivity_Matrix(){
 
 void System::Assign_Rings(){
 /**
-  This function assings the rings - meaning it determines how many and which rings are present in the system. 
-  Carefully - this may become a very slow procedure for large and dense graphs. 
+  This function assings the rings - meaning it determines how many and which rings are present in the system.
+  The rings are the smallest set of smallest rings (SSSR), found on the compact (CSR) graph of the bonds - see
+  libgraph::CSR_GRAPH::find_sssr. The atoms of every ring are listed in the order along the ring.
+  The atoms not belonging to any ring get Atom_min_ring_size = 1.
 */
 
   cout<<"In System::Assign_Rings\n";
-  typedef GRAPH<Atom*,Group*> Graph;
-  Graph g;
-  // Create a vertices of the graph
-  for(int i2=0;i2<Number_of_atoms;i2++){
-    VERTEX<Atom*> vrtx(&Atoms[i2]);
-    g.ADD_VERTEX(vrtx);
-  }
-  // Create edges of the graph
-  for(int i3=0;i3<Number_of_bonds;i3++){
-    int indx1 = Bonds[i3].globAtom_Index[0];
-    int indx2 = Bonds[i3].globAtom_Index[1];
-    EDGE<Group*> edg(indx1,indx2,0,&Bonds[i3]);
-    g.ADD_EDGE(edg);
-  }
-
-  vector<Path> rings;
 
-//  std::cout<<std::endl<<"Original graph"<<std::endl;
-//  int _V_ = g.show_vertices(1);
-//  int _E_ = g.show_edges(1);
-//  std::cout<<"_V_ = "<<_V_<<std::endl;
-//  std::cout<<"_E_ = "<<_E_<<std::endl;
+  int i,j,sz;
 
-  // Reduce graph 
-  g.REDUCE_GRAPH();
+  // Create the graph: atoms are the vertices, bonds are the edges
+  vector<int> v1(Number_of_bonds), v2(Number_of_bonds);
+  for(i=0;i<Number_of_bonds;i++){
+    v1[i] = Bonds[i].globAtom_Index[0];
+    v2[i] = Bonds[i].globAtom_Index[1];
+  }
+  CSR_GRAPH g(Number_of_atoms, v1, v2);
 
-//  std::cout<<std::endl<<"Reduced Original graph"<<std::endl;
-//  _V_ = g.show_vertices(1);
-//  _E_ = g.show_edges(1);
-//  std::cout<<"_V_ = "<<_V_<<std::endl;
-//  std::cout<<"_E_ = "<<_E_<<std::endl;
+  // Find the smallest rings
+  vector<Path> rings = g.find_sssr();
 
-  // Find the smallest rings 
-  // !!! This option is commented by default - uncomment it when you need the information about rings !!!!
-  g.FIND_SSSR(rings);
+  vector< vector<int> > ring_sizes;
+  vector<int> min_ring_size;
+  g.ring_membership(rings, ring_sizes, min_ring_size);
 
   // Now assign
-  int indx,i,j,nrings,sz;
-  nrings = rings.size();
-//  cout<<"nrings = "<<nrings<<endl;
-  for(i=0;i<nrings;i++){
+  Rings.clear();
+  Number_of_rings = 0;
+
+  for(i=0;i<rings.size();i++){
     sz = rings[i].size();
     Group rng;
-    int loc_indx = 0;
-//    cout<<"Ring "<<i<<" : ";
 
     for(j=0;j<sz;j++){
-      int indx1 = g.E[rings[i][j]].edge_vertex_id1;
-      int indx2 = g.E[rings[i][j]].edge_vertex_id2;
-
-      if(!is_in_vector(indx1,rng.globAtom_Index)){
-        rng.globAtom_Index.push_back(indx1);
-        rng.locAtom_Index.push_back(loc_indx++); 
-        rng.Group_Size++;
-        rng.globGroup_Size++;
-        rng.locGroup_Size++;
-      }
-      if(!is_in_vector(indx2,rng.globAtom_Index)){ 
-        rng.globAtom_Index.push_back(indx2);
-        rng.locAtom_Index.push_back(loc_indx++);
-        rng.Group_Size++;
-        rng.globGroup_Size++;
-        rng.locGroup_Size++;
-      }
-
-//      cout<<Atoms[indx1].Atom_id<<"  "<<Atoms[indx2].Atom_id<<"  ";
-
-      if(!is_in_vector(sz,Atoms[indx1].Atom_ring_sizes)){
-        Atoms[indx1].Atom_ring_sizes.push_back(sz);
-        Atoms[indx1].is_Atom_ring_sizes = 1;
-      }
-
-      if(!is_in_vector(sz,Atoms[indx2].Atom_ring_sizes)){
-        Atoms[indx2].Atom_ring_sizes.push_back(sz);
-        Atoms[indx2].is_Atom_ring_sizes = 1;
-      }
+      rng.globAtom_Index.push_back(rings[i][j]);
+      rng.locAtom_Index.push_back(j);
+      rng.Group_Size++;
+      rng.globGroup_Size++;
+      rng.locGroup_Size++;
     }// for j
-//    cout<<endl;
+
     rng.globGroup_Index = Number_of_rings;
     Rings.push_back(rng);
     Number_of_rings++;
@@ -143,17 +101,11 @@ void System::Assign_Rings(){
   }// for i
 
   for(i=0;i<Number_of_atoms;i++){
-    sz = Atoms[i].Atom_ring_sizes.size();
-    cout<<"i= "<<i<<" number of rings this atom belong to = "<<sz<<endl;
-    int min_sz=1;
-    if(sz>=1){ min_sz = Atoms[i].Atom_ring_sizes[0];}
-    else{
-      for(j=0;j<sz-1;j++){
-        min_sz=(Atoms[i].Atom_ring_sizes[j]<=Atoms[i].Atom_ring_sizes[j+1])?Atoms[i].Atom_ring_sizes[j]:Atoms[i].Atom_ring_sizes[j+1];
-      }
-    }      
-    Atoms[i].Atom_min_ring_size = min_sz;
+    Atoms[i].Atom_ring_sizes = ring_sizes[i];
+    Atoms[i].is_Atom_ring_sizes = (ring_sizes[i].size()>0);
+    Atoms[i].Atom_min_ring_size = (min_ring_size[i]>0) ? min_ring_size[i] : 1;
 
+    cout<<"i= "<<i<<" number of rings this atom belong to = "<<ring_sizes[i].size()<<endl;
     cout<<"Atom i="<<i<<" belongs to the minimal ring of size = "<<Atoms[i].Atom_min_ring_size<<endl;
   }// for i
 
@@ -190,6 +142,39 @@ void System::DIVIDE_GRAPH(int IndxStart,int IndxException, vector<int>& P){
 }
 
 
+void System::find_symmetry(double tol, SYMMETRY& sym){
+/**
+  \param[in] tol The tolerance on the positions of atoms
+  \param[out] sym The symmetry operations of the system and the induced permutations of atoms
+
+  Finds the space group of the system if the periodic box is defined, or its point group otherwise.
+  The atoms of the same element are treated as equivalent.
+*/
+
+  int i, j;
+
+  vector<VECTOR> R(Number_of_atoms);
+  vector<int> types(Number_of_atoms, 0);
+
+  for(i=0;i<Number_of_atoms;i++){
+    R[i] = Atoms[i].Atom_RB.rb_cm;
+
+    types[i] = i;
+    for(j=0;j<i;j++){
+      if(Atoms[j].Atom_element==Atoms[i].Atom_element){ types[i] = types[j]; break; }
+    }
+  }
+
+  if(is_Box){
+    VECTOR t1, t2, t3;
+    Box.get_vectors(t1, t2, t3);
+    sym.find_space_group(R, types, t1, t2, t3, tol);
+  }
+  else{  sym.find_point_group(R, types, tol);  }
+
+}
+
+
 }// namespace libchemsys
 }// namespace libchemobjects
 }// liblibra
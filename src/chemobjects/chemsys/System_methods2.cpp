@@ -82,6 +82,13 @@ void System::create_bond(int a1,int a2,int exclude12){
 
         Bonds.push_back(bond);
 
+        // Extend the topology index (it is in sync after Find_Bond above)
+        if(indexed_bonds==Number_of_bonds-1){
+          index_group(atom_bonds, a1, bond.globGroup_Index);
+          index_group(atom_bonds, a2, bond.globGroup_Index);
+          indexed_bonds++;
+        }
+
       //-------------- Create fragmental bond ------------------------
       int g1,g2;
       g1 = Atoms[a1].globGroup_Index;
@@ -156,6 +163,12 @@ void System::create_angle(int a1,int a2,int a3,int exclude13){
         angle.globMolecule_Index = Atoms[a1].globMolecule_Index;
 
         Angles.push_back(angle);
+
+        if(indexed_angles==Number_of_angles-1){
+          index_group(atom_angles, a1, angle.globGroup_Index);
+          index_group(atom_angles, a3, angle.globGroup_Index);
+          indexed_angles++;
+        }
     
       //-------------- Create fragmental angle ------------------------
       int g1,g2,g3;
@@ -235,6 +248,12 @@ void System::create_dihedral(int a1,int a2,int a3,int a4,int exclude14){
 
         Dihedrals.push_back(dihedral);
 
+        if(indexed_dihedrals==Number_of_dihedrals-1){
+          index_group(atom_dihedrals, a1, dihedral.globGroup_Index);
+          index_group(atom_dihedrals, a4, dihedral.globGroup_Index);
+          indexed_dihedrals++;
+        }
+
       //-------------- Create fragmental dihedral ------------------------
       int g1,g2,g3,g4;
       g1 = Atoms[a1].globGroup_Index;
@@ -0,0 +1,116 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file System_methods8.cpp
+  \brief This file implements the output of the System's state to the binary trajectories and reading it back
+    
+*/
+
+#include "System.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libchemobjects namespace
+namespace libchemobjects{
+
+/// libchemsys namespace
+namespace libchemsys{
+
+
+void System::write_binary_frame(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies){
+/**
+  \brief Appends the current atomic coordinates, momenta and forces to the binary trajectory
+
+  \param[in,out] w The trajectory writer. It must be created for ndof = 3*Number_of_atoms, ntraj = 1
+  \param[in] step The index of the MD step
+  \param[in] time The time of the frame
+  \param[in] energies The per-frame scalars (their number must match the writer's nenergies)
+
+  Only the arrays selected by the writer's flags are stored.
+*/
+
+  if(w.ndof!=3*Number_of_atoms || w.ntraj!=1){
+    cout<<"Error in System::write_binary_frame: the writer is set up for ndof = "<<w.ndof<<", ntraj = "<<w.ntraj
+        <<" but the System needs ndof = "<<3*Number_of_atoms<<", ntraj = 1\n"; exit(0);
+  }
+
+  TrajectoryFrame fr;
+  fr.step = step;
+  fr.time = time;
+  fr.energies = energies;
+
+  if(w.flags & TRJ_Q){  fr.q.resize(3*Number_of_atoms);  }
+  if(w.flags & TRJ_P){  fr.p.resize(3*Number_of_atoms);  }
+  if(w.flags & TRJ_F){  fr.f.resize(3*Number_of_atoms);  }
+
+  for(int i=0;i<Number_of_atoms;i++){
+    RigidBody& at = Atoms[i].Atom_RB;
+    if(w.flags & TRJ_Q){ fr.q[3*i] = at.rb_cm.x;    fr.q[3*i+1] = at.rb_cm.y;    fr.q[3*i+2] = at.rb_cm.z;    }
+    if(w.flags & TRJ_P){ fr.p[3*i] = at.rb_p.x;     fr.p[3*i+1] = at.rb_p.y;     fr.p[3*i+2] = at.rb_p.z;     }
+    if(w.flags & TRJ_F){ fr.f[3*i] = at.rb_force.x; fr.f[3*i+1] = at.rb_force.y; fr.f[3*i+2] = at.rb_force.z; }
+  }
+
+  w.write_frame(fr);
+
+}
+
+void System::write_binary_frame(BinaryTrajectoryWriter& w, int step, double time){
+/**
+  \brief Same as above, for the writers with no per-frame scalars
+*/
+  vector<double> energies;
+  write_binary_frame(w, step, time, energies);
+}
+
+
+void System::read_binary_frame(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr){
+/**
+  \brief Loads the i-th frame of the binary trajectory into the atoms of the System
+
+  \param[in] r The trajectory reader. The file must be written for ndof = 3*Number_of_atoms, ntraj = 1
+  \param[in] i The index of the frame
+  \param[out] fr The frame itself - gives access to the step, time and energies
+
+  The atomic coordinates, momenta and forces are updated (those that are stored in the file). The fragment
+  variables are not changed, so this is meant for the analysis of the atomistic properties.
+*/
+
+  if(r.ndof!=3*Number_of_atoms || r.ntraj!=1){
+    cout<<"Error in System::read_binary_frame: the trajectory contains ndof = "<<r.ndof<<", ntraj = "<<r.ntraj
+        <<" but the System needs ndof = "<<3*Number_of_atoms<<", ntraj = 1\n"; exit(0);
+  }
+
+  r.read_frame(i, fr);
+
+  for(int a=0;a<Number_of_atoms;a++){
+    RigidBody& at = Atoms[a].Atom_RB;
+    if(r.flags & TRJ_Q){ at.rb_cm.x = fr.q[3*a];    at.rb_cm.y = fr.q[3*a+1];    at.rb_cm.z = fr.q[3*a+2];    }
+    if(r.flags & TRJ_P){ at.rb_p.x = fr.p[3*a];     at.rb_p.y = fr.p[3*a+1];     at.rb_p.z = fr.p[3*a+2];     }
+    if(r.flags & TRJ_F){ at.rb_force.x = fr.f[3*a]; at.rb_force.y = fr.f[3*a+1]; at.rb_force.z = fr.f[3*a+2]; }
+  }
+
+}
+
+void System::read_binary_frame(BinaryTrajectoryReader& r, int i){
+/**
+  \brief Same as above, when only the atomic variables are needed
+*/
+  TrajectoryFrame fr;
+  read_binary_frame(r, i, fr);
+}
+
+
+
+}// namespace libchemsys
+}// namespace libchemobjects
+}// liblibra
+
@@ -54,6 +54,11 @@ void (System::*print_ent4)(std::string,boost::python::list,int,std::string) = &S
 void (System::*print_xyz1)(std::string,int) = &System::print_xyz;
 void (System::*print_xyz2)(std::string,int,std::string,int) = &System::print_xyz;
 
+void (System::*expt_write_binary_frame_v1)(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies) = &System::write_binary_frame;
+void (System::*expt_write_binary_frame_v2)(BinaryTrajectoryWriter& w, int step, double time) = &System::write_binary_frame;
+void (System::*expt_read_binary_frame_v1)(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr) = &System::read_binary_frame;
+void (System::*expt_read_binary_frame_v2)(BinaryTrajectoryReader& r, int i) = &System::read_binary_frame;
+
 int (System::*expt_Find_Angle_v1)(int,int) = &System::Find_Angle;
 int (System::*expt_Find_Angle_v2)(int,int,int) = &System::Find_Angle;
 
@@ -162,6 +167,7 @@ void (System::*expt_ROTATE_FRAGMENT_v3)(double, VECTOR, int, int) = &System::ROT
       .def("Generate_Connectivity_Matrix", &System::Generate_Connectivity_Matrix)
       .def("Assign_Rings", &System::Assign_Rings)
       .def("DIVIDE_GRAPH", &System::DIVIDE_GRAPH)
+      .def("find_symmetry", &System::find_symmetry)
 
 
   //----------- Defined in System_methods2.cpp ------------------
@@ -301,6 +307,12 @@ void (System::*expt_ROTATE_FRAGMENT_v3)(double, VECTOR, int, int) = &System::ROT
       .def("print_xyz",print_xyz1)
       .def("print_xyz",print_xyz2)
 
+  //---------------- Defined in System_methods8.cpp -----------------
+      .def("write_binary_frame",expt_write_binary_frame_v1)
+      .def("write_binary_frame",expt_write_binary_frame_v2)
+      .def("read_binary_frame",expt_read_binary_frame_v1)
+      .def("read_binary_frame",expt_read_binary_frame_v2)
+
   ;
 
 
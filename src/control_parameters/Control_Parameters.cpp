@@ -47,6 +47,8 @@ Control_Parameters::Control_Parameters(){
   use_disk = 0;          /// use_disk = 0 
   use_rosh = 0;          /// use_rosh = 0 
   do_annihilate = 0;     /// do_annihilate = 0 -  do not do spin annihilation by default
+  fock_nthreads = 0;     /// fock_nthreads = 0 - use all available threads
+  use_integral_cache = 0;  /// use_integral_cache = 0 - compute all the integrals directly
   pop_opt = 0;           /// pop_opt = 0 - integer occupations
 
   use_diis = 0;          /// use_diis = 0
@@ -285,6 +287,8 @@ void get_parameters_from_file(std::string filename, Control_Parameters& prms){
             else if(file[i1][0]=="use_disk"){ prms.use_disk = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="use_rosh"){ prms.use_rosh = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="do_annihilate"){ prms.do_annihilate = atoi(file[i1][2].c_str());   } 
+            else if(file[i1][0]=="fock_nthreads"){ prms.fock_nthreads = atoi(file[i1][2].c_str());   } 
+            else if(file[i1][0]=="use_integral_cache"){ prms.use_integral_cache = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="pop_opt"){  prms.pop_opt = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="use_diis"){  prms.use_diis = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="diis_max"){  prms.diis_max = atoi(file[i1][2].c_str());   } 
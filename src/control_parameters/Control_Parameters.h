@@ -76,6 +76,12 @@ public:
   int use_rosh;                  ///< use restricted open-shell
                                  ///< Possible options: 1 (use), 0 (do not use)
                                  ///< Default: 0
+  int fock_nthreads;             ///< The number of threads for the Fock matrix build; the result does not depend on it
+                                 ///< Possible options: 0 - all available threads (OMP_NUM_THREADS), 1 - serial, 2, 3, ...
+                                 ///< Default: 0
+  int use_integral_cache;        ///< Tabulate the two-center integrals of the s and p AOs once and interpolate them afterwards
+                                 ///< Possible options: 1 (use), 0 (compute all the integrals directly)
+                                 ///< Default: 0
   int do_annihilate;             ///< Do spin annihilation at the last iteration
                                  ///< Possible options: 1 (do annihilation), 0 (don't do annihilation)
                                  ///< Default: 0
@@ -57,6 +57,8 @@ void export_Control_Parameters_objects(){
       .def_readwrite("use_disk", &Control_Parameters::use_disk)
       .def_readwrite("use_rosh", &Control_Parameters::use_rosh)
       .def_readwrite("do_annihilate", &Control_Parameters::do_annihilate)
+      .def_readwrite("fock_nthreads", &Control_Parameters::fock_nthreads)
+      .def_readwrite("use_integral_cache", &Control_Parameters::use_integral_cache)
       .def_readwrite("pop_opt", &Control_Parameters::pop_opt)
       .def_readwrite("use_diis", &Control_Parameters::use_diis)
       .def_readwrite("diis_max", &Control_Parameters::diis_max)
@@ -0,0 +1,125 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Adaptive_Stepping.h
+  \brief The file describes the adaptive (error-controlled) time stepping for the ensembles of the TSH trajectories
+
+  Each trajectory has its own refinement level k: during the coarse step dt it makes 2^k nuclear substeps
+  of dt/2^k. After every substep the error indicators of the trajectory are computed:
+
+  eta_nac  = max_{i!=j} |Hvib_ij| * dt_k / nac_tol           - the rotation of the amplitudes due to the couplings
+  eta_gap  = max_i |g_i(t+dt_k) - g_i(t)| / max(g_i, gap_floor) / gap_tol
+                                                             - the relative change of the gaps g_i between the
+                                                               consecutive (sorted) adiabatic energies
+  eta_norm = | |C(t+dt_k)|^2 - |C(t)|^2 | / norm_tol         - the electronic norm error (|C|^2 = C^+ S C in the
+                                                               diabatic representation)
+
+  If any of them exceeds 1, the trajectory is refined (k -> k+1) for the rest of the coarse step. The level
+  is reduced (k -> k-1) at the end of the coarse step, if all the indicators stayed below merge_ratio for
+  merge_delay coarse steps. The electronic DOFs are propagated in nel substeps, with Hvib interpolated
+  linearly between the ends of the nuclear substep; nel is adapted by comparing the results with nel and
+  2*nel substeps.
+
+  Every rev_stride-th substep of a trajectory is also checked for the time reversibility: the end state is
+  integrated back with -dt_k (the nuclear Verlet step with the forces of the two ends and the electronic
+  propagation with Hvib interpolated from the end to the beginning) and compared with the initial state.
+  The deviations |dq|, |dp|, |dC| are the round-off level for a correct reversible step; larger values point
+  to the inconsistent forces or Hamiltonians (e.g. the state reordering within the substep) or to too few
+  electronic substeps.
+*/
+
+#ifndef ADAPTIVE_STEPPING_H
+#define ADAPTIVE_STEPPING_H
+
+#include "Surface_Hopping.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+class TSH_Adaptive_Control{
+/**
+  \brief The parameters, the state and the log of the adaptive time stepping of an ensemble
+
+  The log of the trajectory i is a list of records, one per nuclear substep:
+  [ t, dt, nel, eta_nac, eta_gap, eta_norm, el_err, dE, rev_dq, rev_dp, rev_dC ]
+  dE is the change of the total (kinetic + active adiabatic state) energy over the substep - the energy
+  conservation diagnostic; it is set to 0 for the substeps with the hops.
+  rev_dq, rev_dp, rev_dC are max |q_back - q|, max |p_back - p| and |C_back - C| of the reversibility check,
+  they are -1 for the substeps that were not checked.
+*/
+
+  vector< vector<double> > log;  ///< the flattened records of the log, 11 numbers per record
+
+public:
+
+  // Parameters
+  int max_level;                ///< the maximal refinement level: the smallest nuclear step is dt/2^max_level
+  double nac_tol;               ///< the threshold for max |Hvib_ij| * dt
+  double gap_tol;               ///< the threshold for the relative change of the energy gaps
+  double gap_floor;             ///< the smallest gap used in the relative gap change, a.u.
+  double norm_tol;              ///< the threshold for the electronic norm error
+  double el_tol;                ///< the threshold for the error of the electronic propagation
+  int max_el_substeps;          ///< the maximal number of the electronic substeps
+  double merge_ratio;           ///< the indicators must stay below this value ...
+  int merge_delay;              ///< ... for this number of coarse steps to merge to the coarser level
+  int do_log;                   ///< 1 - keep the per-trajectory log of the substeps
+  int rev_stride;               ///< check the reversibility of every rev_stride-th substep (0 - never)
+
+  // State
+  vector<int> level;            ///< the current refinement levels of the trajectories
+  vector<int> nel;              ///< the current numbers of the electronic substeps
+  vector<int> calm;             ///< the number of the consecutive coarse steps with small indicators
+  vector<double> time;          ///< the times of the trajectories, a.u.
+
+  // Diagnostics
+  vector<int> nsplit;           ///< the number of the refinements of each trajectory
+  vector<int> nmerge;           ///< the number of the coarsenings of each trajectory
+  vector<int> nsubsteps;        ///< the total number of the nuclear substeps of each trajectory
+  vector<double> max_dE;        ///< the largest |dE| over the substeps without the hops
+  vector<double> max_rev;       ///< the largest deviation (any of |dq|, |dp|, |dC|) of the reversibility checks
+  int nevals;                   ///< the number of the ensemble Hamiltonian evaluations
+
+
+  TSH_Adaptive_Control(int ntraj);
+  TSH_Adaptive_Control(boost::python::dict params, int ntraj);
+
+  void set_parameters(boost::python::dict params);
+  void init(int ntraj);
+  void clear_log();
+
+  void add_record(int traj, double dt, double eta_nac, double eta_gap, double eta_norm, double el_err, double dE,
+                  double rev_dq, double rev_dp, double rev_dC);
+  MATRIX get_log(int traj);
+  int get_nrecords(int traj){ return log[traj].size() / 11; }
+
+};
+
+
+///================  In tsh_methods_adaptive.cpp  ===================================
+
+void tsh1_adaptive(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& act_states,
+                   nHamiltonian& ham, bp::object py_funct, bp::object params, boost::python::dict params1, Random& rnd,
+                   TSH_Adaptive_Control& ctrl, int do_reordering, int do_phase_correction);
+
+void tsh1_adaptive(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& act_states,
+                   nHamiltonian& ham, bp::object py_funct, bp::object params, boost::python::dict params1, Random& rnd,
+                   TSH_Adaptive_Control& ctrl);
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // ADAPTIVE_STEPPING_H
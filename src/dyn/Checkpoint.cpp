@@ -0,0 +1,578 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Checkpoint.cpp
+  \brief The file implements the binary checkpoint (restart) files of the dynamics state
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include "Checkpoint.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+static const char CHK_MAGIC[8] = {'L','I','B','R','A','C','H','K'};
+static const int CHK_VERSION = 1;
+
+
+//----------------------- Low-level helpers ------------------------------
+
+template<typename X>
+static void wr(std::ofstream& out, const X& x){  out.write((const char*)&x, sizeof(X));  }
+
+template<typename X>
+static void wr_vec(std::ofstream& out, const vector<X>& x){
+  int32_t n = x.size();
+  wr(out, n);
+  if(n>0){ out.write((const char*)&x[0], n*sizeof(X)); }
+}
+
+static void wr_str(std::ofstream& out, const std::string& s){
+  int32_t n = s.size();
+  wr(out, n);
+  out.write(s.c_str(), n);
+}
+
+static void wr_cmat(std::ofstream& out, const CMATRIX& x){
+  int32_t r = x.n_rows, c = x.n_cols;
+  wr(out, r);  wr(out, c);
+  out.write((const char*)x.M, sizeof(complex<double>)*r*c);
+}
+
+
+template<typename X>
+static void rd(std::ifstream& in, X& x){
+  in.read((char*)&x, sizeof(X));
+  if(!in.good()){ cout<<"Error in CheckpointReader: unexpected end of the file\n"; exit(0); }
+}
+
+template<typename X>
+static void rd_vec(std::ifstream& in, vector<X>& x){
+  int32_t n;
+  rd(in, n);
+  x.resize(n);
+  if(n>0){ in.read((char*)&x[0], n*sizeof(X)); }
+  if(!in.good()){ cout<<"Error in CheckpointReader: unexpected end of the file\n"; exit(0); }
+}
+
+static void rd_str(std::ifstream& in, std::string& s){
+  int32_t n;
+  rd(in, n);
+  vector<char> buf(n+1, 0);
+  in.read(&buf[0], n);
+  s = std::string(&buf[0], n);
+}
+
+static void rd_cmat(std::ifstream& in, CMATRIX& x){
+/**
+  Reads the matrix values into an existing matrix of the same size
+*/
+  int32_t r, c;
+  rd(in, r);  rd(in, c);
+  if(r!=x.n_rows || c!=x.n_cols){
+    cout<<"Error in CheckpointReader: the stored matrix is "<<r<<"x"<<c<<", but the target is "<<x.n_rows<<"x"<<x.n_cols<<"\n"; exit(0);
+  }
+  in.read((char*)x.M, sizeof(complex<double>)*r*c);
+}
+
+
+// nHamiltonian members: flag (is the memory allocated) + values
+static void wr_ptr(std::ofstream& out, CMATRIX* x, int mem_status){
+  int32_t flag = (mem_status!=0 && x!=NULL);
+  wr(out, flag);
+  if(flag){ wr_cmat(out, *x); }
+}
+
+template<class T1>
+static void reshape(base_matrix<T1>& x, int nrows, int ncols){
+/**
+  The assignment operators of the matrices do not reallocate the memory, so the target is reallocated here
+*/
+  delete [] x.M;
+  x.n_rows = nrows;  x.n_cols = ncols;  x.n_elts = nrows * ncols;
+  x.M = new T1[x.n_elts];
+}
+
+static void rd_ptr(std::ifstream& in, CMATRIX*& x, int& mem_status, int nrows, int ncols){
+/**
+  If the matrix is stored, but the target has no memory allocated - the memory is allocated internally (mem_status = 1)
+*/
+  int32_t flag;
+  rd(in, flag);
+  if(flag){
+    if(mem_status==0 || x==NULL){  x = new CMATRIX(nrows, ncols); mem_status = 1; }
+    rd_cmat(in, *x);
+  }
+}
+
+static void wr_ptrs(std::ofstream& out, vector<CMATRIX*>& x, vector<int>& mem_status){
+  int32_t n = x.size();
+  wr(out, n);
+  for(int i=0;i<n;i++){ wr_ptr(out, x[i], mem_status[i]); }
+}
+
+static void rd_ptrs(std::ifstream& in, vector<CMATRIX*>& x, vector<int>& mem_status, int nrows, int ncols){
+  int32_t n;
+  rd(in, n);
+  if(n!=x.size()){ cout<<"Error in CheckpointReader: the stored nHamiltonian has "<<n<<" derivative matrices, the target - "<<x.size()<<"\n"; exit(0); }
+  for(int i=0;i<n;i++){ rd_ptr(in, x[i], mem_status[i], nrows, ncols); }
+}
+
+
+
+//============================== Writer =====================================
+
+CheckpointWriter::CheckpointWriter(std::string filename_){
+/**
+  \param[in] filename_ The name of the checkpoint file
+*/
+
+  filename = filename_;
+  out.open((filename+".tmp").c_str(), ios::out | ios::trunc | ios::binary);
+  if(!out.good()){ cout<<"Error in CheckpointWriter: can not open "<<filename<<".tmp\n"; exit(0); }
+
+  out.write(CHK_MAGIC, 8);
+  wr(out, (int32_t)CHK_VERSION);
+  is_open = 1;
+  sec_start = -1;
+
+}
+
+CheckpointWriter::~CheckpointWriter(){
+  close();
+}
+
+void CheckpointWriter::close(){
+/**
+  Finishes the file and atomically replaces the previous checkpoint with it
+*/
+  if(!is_open){ return; }
+
+  out.close();
+  is_open = 0;
+  if(rename((filename+".tmp").c_str(), filename.c_str())!=0){
+    cout<<"Error in CheckpointWriter::close: can not rename "<<filename<<".tmp to "<<filename<<"\n"; exit(0);
+  }
+}
+
+
+void CheckpointWriter::begin_section(const char* tag){
+
+  if(!is_open){ cout<<"Error in CheckpointWriter: the file "<<filename<<" is already closed\n"; exit(0); }
+  out.write(tag, 4);
+  sec_start = out.tellp();
+  wr(out, (long long)0);
+
+}
+
+void CheckpointWriter::end_section(){
+
+  long long end = out.tellp();
+  long long sz = end - sec_start - sizeof(long long);
+  out.seekp(sec_start);
+  wr(out, sz);
+  out.seekp(end);
+
+}
+
+
+void CheckpointWriter::save_int(int x){
+  begin_section("INT ");  wr(out, (int32_t)x);  end_section();
+}
+
+void CheckpointWriter::save_double(double x){
+  begin_section("DBL ");  wr(out, x);  end_section();
+}
+
+void CheckpointWriter::save(MATRIX& x){
+
+  begin_section("MAT ");
+  int32_t r = x.n_rows, c = x.n_cols;
+  wr(out, r);  wr(out, c);
+  out.write((const char*)x.M, sizeof(double)*r*c);
+  end_section();
+
+}
+
+void CheckpointWriter::save(CMATRIX& x){
+  begin_section("CMAT");  wr_cmat(out, x);  end_section();
+}
+
+void CheckpointWriter::save(Random& rnd){
+/**
+  Saves the full state of the generator - the restored generator continues the same sequence
+*/
+  begin_section("RAND");
+  for(int i=0;i<4;i++){ wr(out, rnd.state[i]); }
+  end_section();
+}
+
+void CheckpointWriter::save(Nuclear& mol){
+
+  begin_section("NUCL");
+  wr(out, (int32_t)mol.nnucl);
+  wr_vec(out, mol.mass);
+  wr_vec(out, mol.q);
+  wr_vec(out, mol.p);
+  wr_vec(out, mol.f);
+  wr_vec(out, mol.ctyp);
+  end_section();
+
+}
+
+void CheckpointWriter::save(Electronic& el){
+
+  begin_section("ELEC");
+  wr(out, (int32_t)el.nstates);
+  wr(out, (int32_t)el.istate);
+  wr_vec(out, el.q);
+  wr_vec(out, el.p);
+  end_section();
+
+}
+
+void CheckpointWriter::save(Thermostat& th){
+/**
+  Saves the chain variables (positions, velocities, forces, masses), the Nose-Poincare variables and the parameters
+*/
+
+  begin_section("THRM");
+  wr_vec(out, th.s_t);    wr_vec(out, th.s_r);    wr_vec(out, th.s_b);
+  wr_vec(out, th.ksi_t);  wr_vec(out, th.ksi_r);  wr_vec(out, th.ksi_b);
+  wr_vec(out, th.G_t);    wr_vec(out, th.G_r);    wr_vec(out, th.G_b);
+  wr_vec(out, th.Q_t);    wr_vec(out, th.Q_r);    wr_vec(out, th.Q_b);
+
+  wr(out, th.Nf_t);  wr(out, (int32_t)th.is_Nf_t);
+  wr(out, th.Nf_r);  wr(out, (int32_t)th.is_Nf_r);
+  wr(out, th.Nf_b);  wr(out, (int32_t)th.is_Nf_b);
+
+  wr(out, th.s_var);  wr(out, (int32_t)th.is_s_var);
+  wr(out, th.Ps);     wr(out, (int32_t)th.is_Ps);
+  wr(out, th.Q);      wr(out, (int32_t)th.is_Q);
+
+  wr(out, th.NHC_size);     wr(out, (int32_t)th.is_NHC_size);
+  wr(out, th.nu_therm);     wr(out, (int32_t)th.is_nu_therm);
+  wr(out, th.Temperature);  wr(out, (int32_t)th.is_Temperature);
+  wr_str(out, th.thermostat_type);  wr(out, (int32_t)th.is_thermostat_type);
+  end_section();
+
+}
+
+void CheckpointWriter::save(vector<Thermostat>& therm){
+
+  save_int(therm.size());
+  for(int i=0;i<therm.size();i++){ save(therm[i]); }
+
+}
+
+void CheckpointWriter::save(Ensemble& ens){
+/**
+  Saves the nuclear and electronic variables of all trajectories and their activity flags. The Hamiltonian
+  handlers are not saved - they should be set up again and recomputed (or use save(nHamiltonian&))
+*/
+
+  begin_section("ENSB");
+  wr(out, (int32_t)ens.ntraj);
+  wr(out, (int32_t)ens.nnucl);
+  wr(out, (int32_t)ens.nelec);
+  wr_vec(out, ens.is_active);
+  end_section();
+
+  for(int i=0;i<ens.ntraj;i++){  save(ens.mol[i]);  save(ens.el[i]);  }
+
+}
+
+
+void CheckpointWriter::write_node(nHamiltonian& ham){
+
+  wr(out, (int32_t)ham.ndia);
+  wr(out, (int32_t)ham.nadi);
+  wr(out, (int32_t)ham.nnucl);
+  wr(out, (int32_t)ham.children.size());
+
+  wr_ptr(out, ham.ovlp_dia, ham.ovlp_dia_mem_status);
+  wr_ptrs(out, ham.dc1_dia, ham.dc1_dia_mem_status);
+  wr_ptr(out, ham.ham_dia, ham.ham_dia_mem_status);
+  wr_ptr(out, ham.nac_dia, ham.nac_dia_mem_status);
+  wr_ptr(out, ham.hvib_dia, ham.hvib_dia_mem_status);
+  wr_ptrs(out, ham.d1ham_dia, ham.d1ham_dia_mem_status);
+  wr_ptrs(out, ham.d2ham_dia, ham.d2ham_dia_mem_status);
+
+  wr_ptrs(out, ham.dc1_adi, ham.dc1_adi_mem_status);
+  wr_ptr(out, ham.ham_adi, ham.ham_adi_mem_status);
+  wr_ptr(out, ham.nac_adi, ham.nac_adi_mem_status);
+  wr_ptr(out, ham.hvib_adi, ham.hvib_adi_mem_status);
+  wr_ptrs(out, ham.d1ham_adi, ham.d1ham_adi_mem_status);
+  wr_ptrs(out, ham.d2ham_adi, ham.d2ham_adi_mem_status);
+
+  wr_ptr(out, ham.basis_transform, ham.basis_transform_mem_status);
+  wr_ptr(out, ham.cum_phase_corr, ham.cum_phase_corr_mem_status);
+  wr_vec(out, *ham.ordering_adi);
+
+  for(int i=0;i<ham.children.size();i++){ write_node(*ham.children[i]); }
+
+}
+
+void CheckpointWriter::save(nHamiltonian& ham){
+/**
+  Saves all the allocated matrices of the Hamiltonian and, recursively, of all its children
+*/
+
+  begin_section("NHAM");
+  write_node(ham);
+  end_section();
+
+}
+
+
+
+//============================== Reader =====================================
+
+CheckpointReader::CheckpointReader(std::string filename_){
+/**
+  \param[in] filename_ The name of the checkpoint file
+*/
+
+  filename = filename_;
+  in.open(filename.c_str(), ios::binary);
+  if(!in.good()){ cout<<"Error in CheckpointReader: can not open "<<filename<<"\n"; exit(0); }
+
+  char mg[8];
+  int32_t ver;
+  in.read(mg, 8);
+  if(!in.good() || memcmp(mg, CHK_MAGIC, 8)){ cout<<"Error in CheckpointReader: "<<filename<<" is not a checkpoint file\n"; exit(0); }
+  rd(in, ver);
+  if(ver!=CHK_VERSION){ cout<<"Error in CheckpointReader: unsupported checkpoint version "<<ver<<"\n"; exit(0); }
+  sec_end = -1;
+
+}
+
+CheckpointReader::~CheckpointReader(){
+  in.close();
+}
+
+
+void CheckpointReader::begin_section(const char* tag){
+
+  char tg[5] = {0,0,0,0,0};
+  long long sz;
+  in.read(tg, 4);
+  if(!in.good() || memcmp(tg, tag, 4)){
+    cout<<"Error in CheckpointReader: expected the section \""<<std::string(tag,4)<<"\", found \""<<tg<<"\" - "
+        <<"the objects must be loaded in the same order as they were saved\n"; exit(0);
+  }
+  rd(in, sz);
+  sec_end = (long long)in.tellg() + sz;
+
+}
+
+void CheckpointReader::end_section(){
+
+  if((long long)in.tellg()!=sec_end){ cout<<"Error in CheckpointReader: the section size does not match its content\n"; exit(0); }
+
+}
+
+
+int CheckpointReader::load_int(){
+  int32_t x;
+  begin_section("INT ");  rd(in, x);  end_section();
+  return x;
+}
+
+double CheckpointReader::load_double(){
+  double x;
+  begin_section("DBL ");  rd(in, x);  end_section();
+  return x;
+}
+
+void CheckpointReader::load(MATRIX& x){
+/**
+  The target matrix is resized if needed
+*/
+
+  begin_section("MAT ");
+  int32_t r, c;
+  rd(in, r);  rd(in, c);
+  if(r!=x.n_rows || c!=x.n_cols){ reshape(x, r, c); }
+  in.read((char*)x.M, sizeof(double)*r*c);
+  end_section();
+
+}
+
+void CheckpointReader::load(CMATRIX& x){
+/**
+  The target matrix is resized if needed
+*/
+
+  begin_section("CMAT");
+  int32_t r, c;
+  long long pos = in.tellg();
+  rd(in, r);  rd(in, c);
+  if(r!=x.n_rows || c!=x.n_cols){ reshape(x, r, c); }
+  in.seekg(pos);
+  rd_cmat(in, x);
+  end_section();
+
+}
+
+void CheckpointReader::load(Random& rnd){
+  begin_section("RAND");
+  for(int i=0;i<4;i++){ rd(in, rnd.state[i]); }
+  end_section();
+}
+
+void CheckpointReader::load(Nuclear& mol){
+
+  begin_section("NUCL");
+  int32_t n;
+  rd(in, n);  mol.nnucl = n;
+  rd_vec(in, mol.mass);
+  rd_vec(in, mol.q);
+  rd_vec(in, mol.p);
+  rd_vec(in, mol.f);
+  rd_vec(in, mol.ctyp);
+  end_section();
+
+}
+
+void CheckpointReader::load(Electronic& el){
+
+  begin_section("ELEC");
+  int32_t n;
+  rd(in, n);  el.nstates = n;
+  rd(in, n);  el.istate = n;
+  rd_vec(in, el.q);
+  rd_vec(in, el.p);
+  end_section();
+
+}
+
+void CheckpointReader::load(Thermostat& th){
+
+  begin_section("THRM");
+  rd_vec(in, th.s_t);    rd_vec(in, th.s_r);    rd_vec(in, th.s_b);
+  rd_vec(in, th.ksi_t);  rd_vec(in, th.ksi_r);  rd_vec(in, th.ksi_b);
+  rd_vec(in, th.G_t);    rd_vec(in, th.G_r);    rd_vec(in, th.G_b);
+  rd_vec(in, th.Q_t);    rd_vec(in, th.Q_r);    rd_vec(in, th.Q_b);
+
+  th.s_t_size = th.s_t.size();      th.s_r_size = th.s_r.size();      th.s_b_size = th.s_b.size();
+  th.ksi_t_size = th.ksi_t.size();  th.ksi_r_size = th.ksi_r.size();  th.ksi_b_size = th.ksi_b.size();
+  th.G_t_size = th.G_t.size();      th.G_r_size = th.G_r.size();      th.G_b_size = th.G_b.size();
+  th.Q_t_size = th.Q_t.size();      th.Q_r_size = th.Q_r.size();      th.Q_b_size = th.Q_b.size();
+
+  int32_t f;
+  rd(in, th.Nf_t);  rd(in, f);  th.is_Nf_t = f;
+  rd(in, th.Nf_r);  rd(in, f);  th.is_Nf_r = f;
+  rd(in, th.Nf_b);  rd(in, f);  th.is_Nf_b = f;
+
+  rd(in, th.s_var);  rd(in, f);  th.is_s_var = f;
+  rd(in, th.Ps);     rd(in, f);  th.is_Ps = f;
+  rd(in, th.Q);      rd(in, f);  th.is_Q = f;
+
+  rd(in, th.NHC_size);     rd(in, f);  th.is_NHC_size = f;
+  rd(in, th.nu_therm);     rd(in, f);  th.is_nu_therm = f;
+  rd(in, th.Temperature);  rd(in, f);  th.is_Temperature = f;
+  rd_str(in, th.thermostat_type);  rd(in, f);  th.is_thermostat_type = f;
+  end_section();
+
+}
+
+void CheckpointReader::load(vector<Thermostat>& therm){
+/**
+  The vector is resized to the number of the stored thermostats
+*/
+
+  int n = load_int();
+  therm.resize(n);
+  for(int i=0;i<n;i++){ load(therm[i]); }
+
+}
+
+void CheckpointReader::load(Ensemble& ens){
+/**
+  An empty Ensemble is allocated with the stored dimensions; otherwise the dimensions must agree.
+  The Hamiltonian handlers of the Ensemble are left unchanged.
+*/
+
+  begin_section("ENSB");
+  int32_t ntraj, nnucl, nelec;
+  rd(in, ntraj);  rd(in, nnucl);  rd(in, nelec);
+
+  if(ens.ntraj==0){ ens._init(ntraj, nelec, nnucl); }
+  else if(ens.ntraj!=ntraj || ens.nnucl!=nnucl || ens.nelec!=nelec){
+    cout<<"Error in CheckpointReader::load: the stored Ensemble has ntraj = "<<ntraj<<", nnucl = "<<nnucl<<", nelec = "<<nelec
+        <<", the target - "<<ens.ntraj<<", "<<ens.nnucl<<", "<<ens.nelec<<"\n"; exit(0);
+  }
+  rd_vec(in, ens.is_active);
+  end_section();
+
+  for(int i=0;i<ntraj;i++){  load(ens.mol[i]);  load(ens.el[i]);  }
+
+}
+
+
+void CheckpointReader::read_node(nHamiltonian& ham){
+
+  int32_t ndia, nadi, nnucl, nch;
+  rd(in, ndia);  rd(in, nadi);  rd(in, nnucl);  rd(in, nch);
+
+  if(ndia!=ham.ndia || nadi!=ham.nadi || nnucl!=ham.nnucl || nch!=ham.children.size()){
+    cout<<"Error in CheckpointReader::load: the stored nHamiltonian (ndia = "<<ndia<<", nadi = "<<nadi<<", nnucl = "<<nnucl
+        <<", children = "<<nch<<") does not match the target (level "<<ham.level<<", id "<<ham.id<<")\n"; exit(0);
+  }
+
+  rd_ptr(in, ham.ovlp_dia, ham.ovlp_dia_mem_status, ndia, ndia);
+  rd_ptrs(in, ham.dc1_dia, ham.dc1_dia_mem_status, ndia, ndia);
+  rd_ptr(in, ham.ham_dia, ham.ham_dia_mem_status, ndia, ndia);
+  rd_ptr(in, ham.nac_dia, ham.nac_dia_mem_status, ndia, ndia);
+  rd_ptr(in, ham.hvib_dia, ham.hvib_dia_mem_status, ndia, ndia);
+  rd_ptrs(in, ham.d1ham_dia, ham.d1ham_dia_mem_status, ndia, ndia);
+  rd_ptrs(in, ham.d2ham_dia, ham.d2ham_dia_mem_status, ndia, ndia);
+
+  rd_ptrs(in, ham.dc1_adi, ham.dc1_adi_mem_status, nadi, nadi);
+  rd_ptr(in, ham.ham_adi, ham.ham_adi_mem_status, nadi, nadi);
+  rd_ptr(in, ham.nac_adi, ham.nac_adi_mem_status, nadi, nadi);
+  rd_ptr(in, ham.hvib_adi, ham.hvib_adi_mem_status, nadi, nadi);
+  rd_ptrs(in, ham.d1ham_adi, ham.d1ham_adi_mem_status, nadi, nadi);
+  rd_ptrs(in, ham.d2ham_adi, ham.d2ham_adi_mem_status, nadi, nadi);
+
+  rd_ptr(in, ham.basis_transform, ham.basis_transform_mem_status, ndia, nadi);
+  rd_ptr(in, ham.cum_phase_corr, ham.cum_phase_corr_mem_status, nadi, 1);
+  rd_vec(in, *ham.ordering_adi);
+
+  for(int i=0;i<nch;i++){ read_node(*ham.children[i]); }
+
+}
+
+void CheckpointReader::load(nHamiltonian& ham){
+/**
+  Restores the matrices of the Hamiltonian tree. The tree must have the same structure (the same dimensions
+  and numbers of children at all nodes) as the saved one. The matrices not allocated in the target are
+  allocated internally.
+*/
+
+  begin_section("NHAM");
+  read_node(ham);
+  end_section();
+
+}
+
+
+
+}// namespace libdyn
+}// liblibra
+
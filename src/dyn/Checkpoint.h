@@ -0,0 +1,124 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Checkpoint.h
+  \brief The file describes the binary checkpoint (restart) files of the dynamics state
+
+  A checkpoint is a sequence of tagged sections written by CheckpointWriter::save(...) calls and read back,
+  in the same order, by CheckpointReader::load(...) calls. All the real and complex numbers are stored with
+  the full (binary) precision, so a run restarted from a checkpoint reproduces the uninterrupted one bitwise.
+
+  The file is written to <filename>.tmp and renamed to <filename> by close(), so an interrupted write never
+  destroys the previous checkpoint.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <fstream>
+#include "../math_linalg/liblinalg.h"
+#include "../math_random/librandom.h"
+#include "../hamiltonian/libhamiltonian.h"
+#include "nuclear/libnuclear.h"
+#include "electronic/libelectronic.h"
+#include "thermostat/libthermostat.h"
+#include "ensemble/libensemble.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace librandom;
+using namespace libhamiltonian::libhamiltonian_generic;
+
+/// libdyn namespace
+namespace libdyn{
+
+using namespace libnuclear;
+using namespace libelectronic;
+using namespace libthermostat;
+using namespace libensemble;
+
+
+class CheckpointWriter{
+/**
+  \brief Writes the dynamics objects into a binary checkpoint file
+*/
+
+  std::string filename;
+  std::ofstream out;
+  int is_open;
+  long long sec_start;       ///< position of the size field of the current section
+
+  void begin_section(const char* tag);
+  void end_section();
+  void write_node(nHamiltonian& ham);
+
+public:
+
+  CheckpointWriter(std::string filename_);
+ ~CheckpointWriter();
+
+  void save_int(int x);
+  void save_double(double x);
+  void save(MATRIX& x);
+  void save(CMATRIX& x);
+  void save(Random& rnd);
+  void save(Nuclear& mol);
+  void save(Electronic& el);
+  void save(Thermostat& therm);
+  void save(vector<Thermostat>& therm);
+  void save(Ensemble& ens);
+  void save(nHamiltonian& ham);
+
+  void close();
+
+};
+
+
+class CheckpointReader{
+/**
+  \brief Restores the dynamics objects from a binary checkpoint file
+*/
+
+  std::string filename;
+  std::ifstream in;
+  long long sec_end;         ///< end of the current section
+
+  void begin_section(const char* tag);
+  void end_section();
+  void read_node(nHamiltonian& ham);
+
+public:
+
+  CheckpointReader(std::string filename_);
+ ~CheckpointReader();
+
+  int load_int();
+  double load_double();
+  void load(MATRIX& x);
+  void load(CMATRIX& x);
+  void load(Random& rnd);
+  void load(Nuclear& mol);
+  void load(Electronic& el);
+  void load(Thermostat& therm);
+  void load(vector<Thermostat>& therm);
+  void load(Ensemble& ens);
+  void load(nHamiltonian& ham);
+
+};
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // CHECKPOINT_H
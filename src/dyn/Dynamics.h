@@ -22,6 +22,7 @@
 #include "../hamiltonian/libhamiltonian.h"
 #include "../io/libio.h"
 #include "thermostat/Thermostat.h"
+#include "thermostat/Ensemble_Thermostat.h"
 
 
 /// liblibra namespace
@@ -48,6 +49,8 @@ void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ha
 void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, int entanglement_opt, vector<Thermostat>& therm);
 void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, Thermostat& therm);
 void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, int entanglement_opt, Thermostat& therm);
+void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, Ensemble_Thermostat& therm);
+void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, int entanglement_opt, Ensemble_Thermostat& therm);
 
 
 // Ehrenfest.cpp
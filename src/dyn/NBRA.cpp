@@ -0,0 +1,603 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file NBRA.cpp
+  \brief The file implements the NBRA Hvib store and the ensemble surface hopping runs on top of it
+
+*/
+
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "NBRA.h"
+#include "../math_meigen/libmeigen.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libmeigen;
+
+/// libdyn namespace
+namespace libdyn{
+
+
+static const char nbra_magic[8] = {'L','I','B','R','A','N','B','R'};
+static const int nbra_version = 1;
+static const int nbra_header_size = 64;
+
+
+static void write_nbra_header(std::ofstream& out, int nstates, long long nsteps, double dt){
+
+  char buf[nbra_header_size];
+  memset(buf, 0, nbra_header_size);
+
+  memcpy(buf, nbra_magic, 8);
+  memcpy(buf+8, &nbra_version, sizeof(int));
+  memcpy(buf+12, &nstates, sizeof(int));
+  memcpy(buf+16, &nsteps, sizeof(long long));
+  memcpy(buf+24, &dt, sizeof(double));
+
+  out.write(buf, nbra_header_size);
+}
+
+
+void write_nbra_store(std::string filename, vector<CMATRIX>& Hvib, double dt){
+/**
+  \brief Writes the Hvib time series into the binary NBRA store
+
+  \param[in] filename The name of the store file
+  \param[in] Hvib The vibronic Hamiltonians at the consecutive time steps, all of the same size N x N
+  \param[in] dt The time between the snapshots [a.u.]
+*/
+
+  int nsteps = Hvib.size();
+  if(nsteps==0){
+    cout<<"Error in write_nbra_store: the time series is empty\n"; exit(0);
+  }
+  int nst = Hvib[0].n_rows;
+
+  for(int i=0; i<nsteps; i++){
+    if(Hvib[i].n_rows!=nst || Hvib[i].n_cols!=nst){
+      cout<<"Error in write_nbra_store: the snapshot "<<i<<" is not a "<<nst<<" x "<<nst<<" matrix\n"; exit(0);
+    }
+  }
+
+  std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+  if(!out.is_open()){
+    cout<<"Error in write_nbra_store: can not open the file "<<filename<<" for writing\n"; exit(0);
+  }
+
+  write_nbra_header(out, nst, nsteps, dt);
+
+  vector<double> row(2*nst*nst);
+  for(int i=0; i<nsteps; i++){
+    for(int a=0; a<nst*nst; a++){  row[2*a] = Hvib[i].M[a].real(); row[2*a+1] = Hvib[i].M[a].imag(); }
+    out.write((const char*)&row[0], row.size()*sizeof(double));
+  }
+
+  out.close();
+
+}
+
+void write_nbra_store(std::string filename, vector<CMATRIX>& E, vector<CMATRIX>& St, double dt){
+/**
+  \brief Writes the NBRA store from the energies and the time-overlaps of the states
+
+  Hvib(i) = E(i) - i*hbar * (St(i) - St(i)^+)/(2*dt),  with St(i) = <psi(i)|psi(i+1)>
+
+  \param[in] filename The name of the store file
+  \param[in] E The (diagonal) energy matrices at the consecutive time steps
+  \param[in] St The time-overlaps of the states at the consecutive steps
+  \param[in] dt The time between the snapshots [a.u.]
+*/
+
+  if(E.size()!=St.size()){
+    cout<<"Error in write_nbra_store: the number of the energy ("<<E.size()<<") and the overlap ("
+        <<St.size()<<") matrices are not equal\n"; exit(0);
+  }
+
+  vector<CMATRIX> Hvib;
+  for(int i=0; i<E.size(); i++){
+    int nst = E[i].n_rows;
+    if(St[i].n_rows!=nst || St[i].n_cols!=nst){
+      cout<<"Error in write_nbra_store: the sizes of E and St matrices at the step "<<i<<" do not match\n"; exit(0);
+    }
+
+    Hvib.push_back(CMATRIX(E[i]));
+
+    for(int a=0; a<nst; a++){
+      for(int b=0; b<nst; b++){
+        complex<double> d = (0.5/dt)*(St[i].get(a,b) - std::conj(St[i].get(b,a)));
+        Hvib[i].add(a, b, complex<double>(0.0, -1.0)*d);
+      }
+    }
+  }
+
+  write_nbra_store(filename, Hvib, dt);
+
+}
+
+
+
+NBRAStore::NBRAStore(std::string filename){
+/**
+  \brief Maps the NBRA store file into the memory
+
+  \param[in] filename The name of the store file
+*/
+
+  map = NULL; map_size = 0; data = NULL;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd<0){
+    cout<<"Error in NBRAStore::NBRAStore: can not open the file "<<filename<<"\n"; exit(0);
+  }
+
+  struct stat st;
+  fstat(fd, &st);
+  map_size = st.st_size;
+
+  if(map_size<nbra_header_size){
+    cout<<"Error in NBRAStore::NBRAStore: the file "<<filename<<" is too short\n"; exit(0);
+  }
+
+  map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if(map==MAP_FAILED){
+    cout<<"Error in NBRAStore::NBRAStore: can not map the file "<<filename<<"\n"; exit(0);
+  }
+
+  const char* buf = (const char*)map;
+  int version;
+  long long n;
+
+  memcpy(&version, buf+8, sizeof(int));
+  memcpy(&nstates, buf+12, sizeof(int));
+  memcpy(&n, buf+16, sizeof(long long));
+  memcpy(&dt, buf+24, sizeof(double));
+  nsteps = n;
+
+  if(memcmp(buf, nbra_magic, 8)!=0 || version!=nbra_version){
+    cout<<"Error in NBRAStore::NBRAStore: the file "<<filename<<" is not an NBRA store (version "<<nbra_version<<")\n"; exit(0);
+  }
+
+  if(map_size < nbra_header_size + n*nstates*nstates*2*(long long)sizeof(double) || nsteps<=0){
+    cout<<"Error in NBRAStore::NBRAStore: the file "<<filename<<" is truncated\n"; exit(0);
+  }
+
+  data = (const double*)(buf + nbra_header_size);
+
+}
+
+NBRAStore::NBRAStore(vector<CMATRIX>& Hvib, double dt_){
+/**
+  \brief The in-memory store with the copy of the Hvib time series
+
+  \param[in] Hvib The vibronic Hamiltonians at the consecutive time steps
+  \param[in] dt_ The time between the snapshots [a.u.]
+*/
+
+  map = NULL; map_size = 0;
+  dt = dt_;
+  nsteps = Hvib.size();
+
+  if(nsteps==0){
+    cout<<"Error in NBRAStore::NBRAStore: the time series is empty\n"; exit(0);
+  }
+  nstates = Hvib[0].n_rows;
+
+  buffer = vector<double>(2*(long long)nsteps*nstates*nstates);
+  for(int i=0; i<nsteps; i++){
+    if(Hvib[i].n_rows!=nstates || Hvib[i].n_cols!=nstates){
+      cout<<"Error in NBRAStore::NBRAStore: the snapshot "<<i<<" is not a "<<nstates<<" x "<<nstates<<" matrix\n"; exit(0);
+    }
+    double* x = &buffer[2*(long long)i*nstates*nstates];
+    for(int a=0; a<nstates*nstates; a++){  x[2*a] = Hvib[i].M[a].real(); x[2*a+1] = Hvib[i].M[a].imag(); }
+  }
+
+  data = &buffer[0];
+
+}
+
+NBRAStore::~NBRAStore(){
+
+  if(map!=NULL){ munmap(map, map_size); }
+
+}
+
+
+const double* NBRAStore::snapshot(int i) const{
+/**
+  \brief Returns the pointer to the (re, im) data of the snapshot i mod nsteps
+*/
+
+  i = i % nsteps;  if(i<0){ i += nsteps; }
+
+  return data + 2*(long long)i*nstates*nstates;
+
+}
+
+CMATRIX NBRAStore::get_Hvib(int i){
+/**
+  \brief Returns Hvib of the snapshot i (the time axis is cyclic)
+*/
+
+  CMATRIX H(nstates, nstates);
+  const double* x = snapshot(i);
+
+  for(int a=0; a<nstates*nstates; a++){  H.M[a] = complex<double>(x[2*a], x[2*a+1]);  }
+
+  return H;
+
+}
+
+void NBRAStore::get_Hvib(double t, CMATRIX& H){
+/**
+  \brief Computes Hvib at the time t [a.u.] by the linear interpolation between the snapshots
+
+  \param[in] t The time counted from the first snapshot; it is wrapped around the end of the series
+  \param[out] H The nstates x nstates matrix to hold the result
+*/
+
+  double x = t/dt;
+  int i = (int)floor(x);
+  double f = x - i;
+
+  const double* h0 = snapshot(i);
+  const double* h1 = snapshot(i+1);
+
+  for(int a=0; a<nstates*nstates; a++){
+    H.M[a] = complex<double>( (1.0-f)*h0[2*a]   + f*h1[2*a],
+                              (1.0-f)*h0[2*a+1] + f*h1[2*a+1] );
+  }
+
+}
+
+CMATRIX NBRAStore::get_Hvib(double t){
+/**
+  \brief Returns Hvib at the time t [a.u.], linearly interpolated between the snapshots
+*/
+
+  CMATRIX H(nstates, nstates);
+  get_Hvib(t, H);
+
+  return H;
+
+}
+
+
+MATRIX NBRAStore::decoherence_rates(){
+/**
+  \brief Computes the pure dephasing rates of all pairs of states from the energy gap fluctuations:
+
+  1/tau_ij = sqrt(5/12) * sqrt( <(dE_ij - <dE_ij>)^2> ) / hbar,   dE_ij = Re(Hvib_ii - Hvib_jj)
+
+  The averages are taken over the whole stored series.
+*/
+
+  MATRIX rates(nstates, nstates);
+
+  for(int i=0; i<nstates; i++){
+    for(int j=i+1; j<nstates; j++){
+
+      double s1 = 0.0, s2 = 0.0;
+      for(int n=0; n<nsteps; n++){
+        const double* h = snapshot(n);
+        double de = h[2*(i*nstates+i)] - h[2*(j*nstates+j)];
+        s1 += de; s2 += de*de;
+      }
+      s1 /= nsteps;  s2 /= nsteps;
+
+      double var = s2 - s1*s1;  if(var<0.0){ var = 0.0; }
+      double r = sqrt(5.0*var/12.0);
+
+      rates.set(i, j, r);  rates.set(j, i, r);
+    }
+  }
+
+  return rates;
+
+}
+
+
+
+static void fssh_row(const complex<double>* c, const complex<double>* H, int nst, int i, double dt,
+                     int use_boltz_factor, double kT, double* g){
+/**
+  The row i of the FSSH hopping probabilities matrix - the same expressions as in
+  compute_hopping_probabilities_fssh(CMATRIX& Coeff, CMATRIX* Hvib, double dt, int use_boltz_factor, double T),
+  but only for the active state and without the temporary matrices
+
+  g[j] = dt * Im( rho_ij * Hvib_ji - Hvib_ij * rho_ji ) / rho_ii,  rho = c * c^+ ;  negative values are set to zero
+*/
+
+  double a_ii = std::norm(c[i]);
+
+  for(int j=0; j<nst; j++){
+    g[j] = 0.0;
+    if(j==i || a_ii<1e-8){ continue; }
+
+    complex<double> rho_ij = c[i]*std::conj(c[j]);
+    double imHaij = ( rho_ij * H[j*nst+i] - H[i*nst+j] * std::conj(rho_ij) ).imag();
+    double g_ij = dt*imHaij/a_ii;
+
+    if(use_boltz_factor){
+      double dE = H[j*nst+j].real() - H[i*nst+i].real();
+      if(dE>0.0){ g_ij *= exp(-dE/kT); }
+    }
+
+    if(g_ij>0.0){ g[j] = g_ij; }
+  }
+
+}
+
+
+NBRAStatistics run_nbra(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states,
+                        MATRIX& decoh_rates){
+/**
+  \brief Runs the NBRA surface hopping for a set of initial conditions, with prms.ntraj stochastic
+  realizations per initial condition, and returns the ensemble-averaged populations and energies
+
+  \param[in] store The Hvib time series
+  \param[in] prms The parameters of the runs
+  \param[in] init_times The indices of the snapshots at which the runs start (one per initial condition)
+  \param[in] init_states The initial states (one per initial condition)
+  \param[in] decoh_rates The matrix of the pure dephasing rates [a.u.^-1], used by DISH
+
+  The electronic propagators of the steps visited by the runs, [min(init_times), max(init_times) + nsteps)
+  (at most the whole stored series), are computed once, with nsubsteps steps of the interpolated Hvib per
+  nuclear step, and shared by all the realizations. The realization r
+  of the initial condition ic uses the random number stream (prms.seed, ic*prms.ntraj + r), so every
+  realization is the same for any number of OpenMP threads; the SH populations are the exact counts.
+
+  Methods (prms.method):
+   0 - FSSH: the hops with the (optionally Boltzmann-scaled) FSSH probabilities
+   1 - FSSH with ID-A: the unscaled FSSH proposals, the upward hops are accepted with the Boltzmann
+       probability; the wavefunction collapses onto the resulting state at every attempted hop
+   2 - DISH: the decoherence events at the coherence intervals of the states are the only source of hops;
+       the upward hops are accepted with the Boltzmann probability if prms.use_boltz_factor is 1
+*/
+
+  const double kb = 3.166811429e-6;  // Hartree/K
+
+  int nst = store.nstates;
+  int ns = store.nsteps;
+  int nsteps = (prms.nsteps>0) ? prms.nsteps : ns;
+  int nic = init_times.size();
+  int nsub = prms.nsubsteps;
+  double dt = store.dt;
+  double kT = kb*prms.Temperature;
+
+  if(init_states.size()!=nic){
+    cout<<"Error in run_nbra: the numbers of the initial times ("<<nic<<") and states ("<<init_states.size()
+        <<") are not equal\n"; exit(0);
+  }
+  for(int ic=0; ic<nic; ic++){
+    if(init_states[ic]<0 || init_states[ic]>=nst){
+      cout<<"Error in run_nbra: the initial state "<<init_states[ic]<<" is out of range [0, "<<nst<<")\n"; exit(0);
+    }
+  }
+  if(prms.method<0 || prms.method>2){
+    cout<<"Error in run_nbra: the method "<<prms.method<<" is not known. Use 0 - FSSH, 1 - ID-A, 2 - DISH\n"; exit(0);
+  }
+  if(nsub<1 || prms.ntraj<1){
+    cout<<"Error in run_nbra: nsubsteps and ntraj must be positive\n"; exit(0);
+  }
+  if(prms.method==2 && (decoh_rates.n_rows!=nst || decoh_rates.n_cols!=nst)){
+    cout<<"Error in run_nbra: the decoherence rates must be a "<<nst<<" x "<<nst<<" matrix\n"; exit(0);
+  }
+
+
+  // The window of the snapshots visited by the runs: the step n of the initial condition ic uses
+  // the slot (init_times[ic] + n - t_lo) mod ns, which is the snapshot (t_lo + slot) mod ns
+  long long t_lo = 0, t_hi = 0;
+  for(int ic=0; ic<nic; ic++){
+    if(ic==0 || init_times[ic] < t_lo){ t_lo = init_times[ic]; }
+    if(ic==0 || init_times[ic] + (long long)nsteps > t_hi){ t_hi = init_times[ic] + (long long)nsteps; }
+  }
+  int nwin = (t_hi - t_lo < ns) ? int(t_hi - t_lo) : ns;
+
+
+  // The propagators U(i) = prod_k exp(-i*Hvib(t_k)*dt/nsub) over the step i -> i+1 and the mid-step Hvib(i+1/2)
+  vector<CMATRIX> U(nwin, CMATRIX(nst, nst));
+  vector<CMATRIX> Hmid(nwin, CMATRIX(nst, nst));
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int w=0; w<nwin; w++){
+    CMATRIX H(nst, nst);
+    int i = (t_lo + w) % ns;  if(i<0){ i += ns; }
+
+    U[w].identity();
+    for(int k=0; k<nsub; k++){
+      CMATRIX Uk(nst, nst);
+      store.get_Hvib((i + (k+0.5)/nsub)*dt, H);
+      exp_matrix(Uk, H, complex<double>(0.0, -dt/nsub));
+      U[w] = Uk * U[w];
+    }
+
+    store.get_Hvib((i+0.5)*dt, Hmid[w]);
+  }
+
+
+  long long ntot = (long long)nic*prms.ntraj;
+
+  vector<double> pse(nsteps*nst, 0.0);
+  vector<long long> cnt(nsteps*nst, 0);
+  vector<double> ese(nsteps, 0.0);
+  vector<double> esh(nsteps, 0.0);
+
+  #pragma omp parallel
+  {
+    vector<double> l_pse(nsteps*nst, 0.0);
+    vector<long long> l_cnt(nsteps*nst, 0);
+    vector<double> l_ese(nsteps, 0.0);
+    vector<double> l_esh(nsteps, 0.0);
+
+    vector< complex<double> > c(nst), tmp(nst);
+    vector<double> g(nst), t_m(nst);
+
+    #pragma omp for schedule(dynamic, 16)
+    for(long long r=0; r<ntot; r++){
+
+      int ic = r / prms.ntraj;
+      CounterRandom rnd(prms.seed, r);
+
+      int ist = init_states[ic];
+      for(int a=0; a<nst; a++){ c[a] = 0.0; t_m[a] = 0.0; }
+      c[ist] = 1.0;
+
+      for(int n=0; n<nsteps; n++){
+
+        int it = (init_times[ic] + n) % ns;  if(it<0){ it += ns; }
+        int w = (init_times[ic] + n - t_lo) % ns;
+        const double* h = store.snapshot(it);
+
+        // Statistics at the beginning of the step
+        double e = 0.0;
+        for(int a=0; a<nst; a++){
+          double p = std::norm(c[a]);
+          l_pse[n*nst+a] += p;
+          e += p*h[2*(a*nst+a)];
+        }
+        l_ese[n] += e;
+        l_esh[n] += h[2*(ist*nst+ist)];
+        l_cnt[n*nst+ist]++;
+
+
+        // Electronic propagation
+        const complex<double>* u = U[w].M;
+        for(int a=0; a<nst; a++){
+          tmp[a] = 0.0;
+          for(int b=0; b<nst; b++){ tmp[a] += u[a*nst+b]*c[b]; }
+        }
+        c = tmp;
+
+
+        // Hops
+        const complex<double>* H = Hmid[w].M;
+
+        if(prms.method==0 || prms.method==1){
+
+          fssh_row(&c[0], H, nst, ist, dt, (prms.method==0 ? prms.use_boltz_factor : 0), kT, &g[0]);
+
+          double ksi = rnd.uniform();
+          double sum = 0.0;
+          int fst = ist;
+          for(int j=0; j<nst; j++){
+            sum += g[j];
+            if(ksi<sum){ fst = j; break; }
+          }
+
+          if(prms.method==0){ ist = fst; }
+
+          else if(fst!=ist){
+            double dE = H[fst*nst+fst].real() - H[ist*nst+ist].real();
+            if(dE<=0.0 || rnd.uniform() < exp(-dE/kT)){ ist = fst; }
+
+            for(int a=0; a<nst; a++){ c[a] = 0.0; }
+            c[ist] = 1.0;
+          }
+
+        }// FSSH, ID-A
+
+        else if(prms.method==2){
+
+          for(int a=0; a<nst; a++){ t_m[a] += dt; }
+
+          for(int i=0; i<nst; i++){
+
+            // Coherence interval of the state i, as in coherence_intervals(...)
+            double summ = 0.0;
+            for(int j=0; j<nst; j++){
+              if(j!=i){ summ += std::norm(c[j]) * decoh_rates.get(i,j); }
+            }
+            if(summ<=0.0 || t_m[i] < 1.0/summ){ continue; }
+
+            // Decoherence event, as in dish(...): either collapse onto the state i or project it out
+            double p_i = std::norm(c[i]);
+            int can_hop = 0;
+            if(rnd.uniform() < p_i){
+              double dE = H[i*nst+i].real() - H[ist*nst+ist].real();
+              can_hop = 1;
+              if(prms.use_boltz_factor==1 && dE>0.0){ can_hop = (rnd.uniform() < exp(-dE/kT)); }
+            }
+
+            if(can_hop){
+              complex<double> ci = c[i]/sqrt(p_i);
+              for(int a=0; a<nst; a++){ c[a] = 0.0; }
+              c[i] = ci;
+              ist = i;
+            }
+            else{
+              c[i] = 0.0;
+              double nrm = 0.0;
+              for(int a=0; a<nst; a++){ nrm += std::norm(c[a]); }
+              if(nrm>0.0){ nrm = sqrt(nrm); for(int a=0; a<nst; a++){ c[a] /= nrm; } }
+            }
+
+            t_m[i] = 0.0;
+            break;
+
+          }// for i
+        }// DISH
+
+      }// for n
+    }// for r
+
+    #pragma omp critical
+    {
+      for(int a=0; a<nsteps*nst; a++){ pse[a] += l_pse[a]; cnt[a] += l_cnt[a]; }
+      for(int n=0; n<nsteps; n++){ ese[n] += l_ese[n]; esh[n] += l_esh[n]; }
+    }
+
+  }// omp parallel
+
+
+  NBRAStatistics res(nsteps, nst);
+  res.ntraj = ntot;
+
+  if(ntot>0){
+    for(int n=0; n<nsteps; n++){
+      for(int a=0; a<nst; a++){
+        res.pop_se.set(n, a, pse[n*nst+a]/ntot);
+        res.pop_sh.set(n, a, double(cnt[n*nst+a])/ntot);
+      }
+      res.E_se.set(n, 0, ese[n]/ntot);
+      res.E_sh.set(n, 0, esh[n]/ntot);
+    }
+  }
+
+  return res;
+
+}
+
+NBRAStatistics run_nbra(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states){
+/**
+  \brief Same as run_nbra(store, prms, init_times, init_states, decoh_rates) with the dephasing rates
+  computed from the energy gap fluctuations of the whole stored series
+*/
+
+  MATRIX decoh_rates(store.decoherence_rates());
+
+  return run_nbra(store, prms, init_times, init_states, decoh_rates);
+
+}
+
+
+}// namespace libdyn
+}// liblibra
+
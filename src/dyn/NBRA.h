@@ -0,0 +1,135 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file NBRA.h
+  \brief The file describes the native engine for the neglect-of-back-reaction (NBRA) NA-MD with the
+  precomputed vibronic Hamiltonian time series
+
+  The Hvib(t) time series is kept in a binary store that is memory-mapped as a whole:
+
+  Header (64 bytes):  "LIBRANBR" | version (int32) | nstates (int32) | nsteps (int64) | dt (double) | reserved
+  Data:               nsteps snapshots of Hvib, each - nstates x nstates complex numbers (row-major, re, im)
+
+  Since in the NBRA the nuclear trajectory does not depend on the electronic state, the electronic propagator
+  of every time step is computed only once and is shared by all the stochastic realizations of the surface hopping.
+*/
+
+#ifndef NBRA_H
+#define NBRA_H
+
+#include <string>
+#include "../math_linalg/liblinalg.h"
+#include "../math_random/librandom.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace librandom;
+
+/// libdyn namespace
+namespace libdyn{
+
+
+void write_nbra_store(std::string filename, vector<CMATRIX>& Hvib, double dt);
+void write_nbra_store(std::string filename, vector<CMATRIX>& E, vector<CMATRIX>& St, double dt);
+
+
+class NBRAStore{
+/**
+  \brief Read-only access to the Hvib time series: a memory-mapped store file or an in-memory copy
+
+  The time axis is cyclic: the snapshot i is the snapshot i mod nsteps, so the runs may be longer
+  than the precomputed trajectory. Between the snapshots Hvib is interpolated linearly.
+*/
+
+  void* map;                    ///< the mapped file (NULL for the in-memory store)
+  long long map_size;           ///< the size of the mapped region
+  vector<double> buffer;        ///< the data of the in-memory store
+  const double* data;           ///< the first snapshot
+
+  // Not copyable: the store owns the mapping, and data points into it (or into buffer)
+  NBRAStore(const NBRAStore&);
+  NBRAStore& operator=(const NBRAStore&);
+
+public:
+
+  int nstates;                  ///< the dimension of Hvib
+  int nsteps;                   ///< the number of snapshots
+  double dt;                    ///< the time between the snapshots, a.u.
+
+  NBRAStore(std::string filename);
+  NBRAStore(vector<CMATRIX>& Hvib, double dt_);
+ ~NBRAStore();
+
+  const double* snapshot(int i) const;      ///< raw (re, im) data of the snapshot i (cyclic)
+  CMATRIX get_Hvib(int i);
+  void get_Hvib(double t, CMATRIX& H);
+  CMATRIX get_Hvib(double t);
+
+  MATRIX decoherence_rates();
+
+};
+
+
+class NBRAParams{
+/**
+  \brief The parameters of the NBRA surface hopping runs
+*/
+
+public:
+
+  int nsteps;                   ///< the number of nuclear steps to run (may exceed the store length); 0 - the store length
+  int nsubsteps;                ///< the number of electronic integration steps per nuclear step
+  int method;                   ///< 0 - FSSH, 1 - FSSH with ID-A, 2 - DISH
+  int use_boltz_factor;         ///< 1 - scale the FSSH upward hopping probabilities by the Boltzmann factor
+  double Temperature;           ///< the temperature of the nuclei, K
+  int ntraj;                    ///< the number of stochastic realizations per initial condition
+  int seed;                     ///< the seed of the random number streams
+
+  NBRAParams(){
+    nsteps = 0; nsubsteps = 1; method = 0; use_boltz_factor = 1;
+    Temperature = 300.0; ntraj = 1000; seed = 0;
+  }
+
+};
+
+
+class NBRAStatistics{
+/**
+  \brief The ensemble averages over all the initial conditions and all the realizations: the row n
+  corresponds to the time n*dt after the start of each run
+*/
+
+public:
+
+  MATRIX pop_se;                ///< nsteps x nstates: the populations of the states by the amplitudes (SE)
+  MATRIX pop_sh;                ///< nsteps x nstates: the fractions of the realizations in each state (SH)
+  MATRIX E_se;                  ///< nsteps x 1: the average energy sum_i |c_i|^2 H_ii
+  MATRIX E_sh;                  ///< nsteps x 1: the average energy of the active state
+  int ntraj;                    ///< the total number of realizations averaged
+
+  NBRAStatistics(int nsteps, int nstates)
+  : pop_se(nsteps, nstates), pop_sh(nsteps, nstates), E_se(nsteps, 1), E_sh(nsteps, 1){ ntraj = 0; }
+
+};
+
+
+NBRAStatistics run_nbra(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states,
+                        MATRIX& decoh_rates);
+NBRAStatistics run_nbra(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states);
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // NBRA_H
@@ -356,6 +356,119 @@ void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ha
 }// Verlet1
 
 
+void Verlet1_nvt(double dt, MATRIX& q, MATRIX& P, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, 
+                 int entanglement_opt, Ensemble_Thermostat& therm){
+/**
+  \brief One step of the BAOAB integrator for an ensemble of trajectories, each coupled to its own bath
+
+  \param[in] Integration time step
+  \param[in,out] q [Ndof x Ntraj] nuclear coordinates. Change during the integration.
+  \param[in,out] P [Ndof x Ntraj] nuclear momenta. Change during the integration.
+  \param[in,out] invM [Ndof  x 1] inverse nuclear DOF masses. 
+  \param[in,out] ham Is the Hamiltonian object that works as a functor (takes care of all calculations of given type) - its internal variables
+  (well, actually the variables it points to) are changed during the compuations
+  \param[in] py_funct Python function object that is called when this algorithm is executed. The called Python function does the necessary 
+  computations to update the diabatic Hamiltonian matrix (and derivatives), stored externally.
+  \param[in] params The Python object containing any necessary parameters passed to the "py_funct" function when it is executed.
+  \param[in] entanglement_opt - a selector of a method to couple the trajectories in this ensemble:
+             0 - no coupling, 1 - ETHD, 2 - RPMD
+  \param[in,out] therm The thermostats of all the trajectories
+
+  The splitting is: B(dt/2) A(dt/2) O(dt) A(dt/2) B(dt/2), where O is the action of the thermostat
+  (for the Langevin thermostat this is the BAOAB scheme of Leimkuhler and Matthews)
+*/
+
+  int ndof = q.n_rows;
+  int ntraj = q.n_cols;
+  int nadi = ham.nadi;
+  int traj, dof;
+
+  int ham_rep = 0; // default -- assume the Hamiltonian is first computed in the diabatic representation
+                   // and then will be transformed to the adiabatic in this function. 
+
+  int act_state = 0; // default -- assume the active adiabatic surface is the ground state
+
+
+  //============= Extract optional parameters: needed for some execution scenarios =============
+  double ETHD3_alpha = 1.0;
+  std::string key;
+  boost::python::dict d = (boost::python::dict)params;
+  for(int i=0;i<len(d.values());i++){
+    key = extract<std::string>(d.keys()[i]);
+    if(key=="ETHD3_alpha") { ETHD3_alpha = extract<double>(d.values()[i]);   }
+    if(key=="ham_rep") { ham_rep = extract<int>(d.values()[i]);   }
+    if(key=="act_state"){ act_state = extract<int>(d.values()[i]); }
+  }
+
+
+  vector<int> t1(ndof, 0); for(int i=0;i<ndof;i++){  t1[i] = i; }
+  vector<int> t2(1,0);
+  vector<int> t3(2,0);
+
+  CMATRIX Cadi(nadi,1); Cadi.set(act_state,0, 1.0,0.0);
+  MATRIX F(ndof, ntraj);
+  MATRIX f(ndof, 1);
+
+  
+  for(traj=0; traj<ntraj; traj++){
+    t2[0] = traj;  t3[1] = traj;
+    f = ham.forces_adi(Cadi, t3).real();
+    push_submatrix(F, f, t1, t2);
+  }
+
+  P = P + F * 0.5*dt;
+
+  for(traj=0; traj<ntraj; traj++){
+    for(dof=0; dof<ndof; dof++){  q.add(dof, traj,  invM.get(dof,0) * P.get(dof,traj) * 0.5*dt );   }
+  }
+
+  therm.apply(dt, P, invM);
+
+  for(traj=0; traj<ntraj; traj++){
+    for(dof=0; dof<ndof; dof++){  q.add(dof, traj,  invM.get(dof,0) * P.get(dof,traj) * 0.5*dt );   }
+  }
+
+
+  if(ham_rep==0){
+    ham.compute_diabatic(py_funct, bp::object(q), params, 1);
+    ham.compute_adiabatic(1, 1);
+  }
+  else if(ham_rep==1){
+    ham.compute_adiabatic(py_funct, bp::object(q), params, 1);
+  }
+
+  if(entanglement_opt==0){    /* Nothing to do */   }
+  else if(entanglement_opt==1){   ham.add_ethd_adi(q, invM, 1);  }
+  else if(entanglement_opt==2){   ham.add_ethd3_adi(q, invM, ETHD3_alpha, 1);  }
+  else{
+    cout<<"ERROR in Verlet1: The entanglement option = "<<entanglement_opt<<" is not avaialable\n";
+    exit(0);
+  }
+
+
+  for(traj=0; traj<ntraj; traj++){
+    t2[0] = traj;  t3[1] = traj;
+    f = ham.forces_adi(Cadi, t3).real();
+    push_submatrix(F, f, t1, t2);
+  }
+
+  P = P + F * 0.5*dt;
+
+
+}// Verlet1
+
+
+void Verlet1_nvt(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, 
+                 bp::object params, Ensemble_Thermostat& therm){
+/**
+  \brief BAOAB integrator for an ensemble of (uncoupled trajectories)
+*/
+
+  Verlet1_nvt(dt, q, p, invM, ham, py_funct, params, 0, therm);
+
+
+}// Verlet1
+
 
 
 
@@ -134,6 +134,12 @@ void propagate_electronic(double dt,CMATRIX& Coeff, CMATRIX& Hvib, CMATRIX& S);
 
 void propagate_electronic_nonHermitian(double dt, CMATRIX& Coeff, CMATRIX& Hvib);
 
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian, double tol, int m_max);
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian);
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib);
+void propagate_electronic_krylov(double dt, CMATRIX& C, nHamiltonian& ham, int rep, double tol, int m_max);
+void propagate_electronic_krylov(double dt, CMATRIX& C, nHamiltonian& ham, int rep);
+
 void propagate_electronic(double dt, CMATRIX& C, nHamiltonian& ham, int rep);
 void propagate_electronic(double dt, CMATRIX& C, nHamiltonian* ham, int rep);
 void propagate_electronic(double dt, CMATRIX& C, vector<nHamiltonian*>& ham, int rep);
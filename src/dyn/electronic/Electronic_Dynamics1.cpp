@@ -456,6 +456,93 @@ void propagate_electronic_nonHermitian(double dt, CMATRIX& Coeff, CMATRIX& Hvib)
 }// propagate_electronic
 
 
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian, double tol, int m_max){
+/**
+  Solves the time-dependent Schrodinger equation:
+
+  i*hbar*dc/dt = Hvib*c
+
+  by the short-iterative Krylov method: c(t+dt) = exp(-i*Hvib*dt) * c(t) is computed from the matrix-vector
+  products Hvib * v only, so no diagonalization of the full Hvib is needed. This is the method of choice for
+  the large (100s - 1000s of states) Hamiltonians.
+
+  \param[in] dt The integration time step (also the duration of propagation)
+  \param[in,out] Coeff The N x ntraj matrix of the coefficients, every column is propagated independently
+  \param[in] Hvib The vibronic Hamiltonian matrix (N x N)
+  \param[in] is_hermitian 1 - Hvib is Hermitian (use the Lanczos recurrence), 0 - Hvib is non-Hermitian, e.g.
+             includes the complex absorbing potential (use the Arnoldi process)
+  \param[in] tol The error tolerance of the Krylov propagation
+  \param[in] m_max The maximal dimension of the Krylov subspace
+
+*/
+
+  libmeigen::expmv_krylov(Hvib, Coeff, complex<double>(0.0, -dt), is_hermitian, tol, m_max);
+
+}// propagate_electronic_krylov
+
+
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian){
+/**
+  Same as above with the tolerance 1e-10 and the maximal Krylov dimension 30
+*/
+
+  propagate_electronic_krylov(dt, Coeff, Hvib, is_hermitian, 1e-10, 30);
+
+}
+
+void propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib){
+/**
+  Same as above for the Hermitian Hvib
+*/
+
+  propagate_electronic_krylov(dt, Coeff, Hvib, 1, 1e-10, 30);
+
+}
+
+
+void propagate_electronic_krylov(double dt, CMATRIX& C, nHamiltonian& ham, int rep, double tol, int m_max){
+/**
+  \param[in] dt The integration time step
+  \param[in,out] C The coefficients, diabatic (rep = 0) or adiabatic (rep = 1)
+  \param[in] ham The Hamiltonian object
+  \param[in] rep The representation: 0 - diabatic, 1 - adiabatic
+  \param[in] tol The error tolerance of the Krylov propagation
+  \param[in] m_max The maximal dimension of the Krylov subspace
+
+  In the diabatic representation, i*hbar*S*dc/dt = Hvib*c is solved as i*hbar*dc/dt = (S^-1 * Hvib)*c,
+  with the non-Hermitian S^-1 * Hvib matrix (Arnoldi process)
+*/
+
+  if(rep==0){  // diabatic
+
+    CMATRIX Hvib(ham.ndia, ham.ndia);  Hvib = ham.get_hvib_dia();
+    CMATRIX Sdia(ham.ndia, ham.ndia);  Sdia = ham.get_ovlp_dia();
+    CMATRIX Sinv(ham.ndia, ham.ndia);
+
+    libmeigen::FullPivLU_inverse(Sdia, Sinv);
+    Hvib = Sinv * Hvib;
+
+    propagate_electronic_krylov(dt, C, Hvib, 0, tol, m_max);
+
+  }
+
+  else if(rep==1){  // adiabatic
+
+    CMATRIX Hvib(ham.nadi, ham.nadi);  Hvib = ham.get_hvib_adi();
+
+    propagate_electronic_krylov(dt, C, Hvib, 1, tol, m_max);
+  }
+
+}
+
+void propagate_electronic_krylov(double dt, CMATRIX& C, nHamiltonian& ham, int rep){
+
+  propagate_electronic_krylov(dt, C, ham, rep, 1e-10, 30);
+
+}
+
+
+
 
 
 
@@ -103,6 +103,17 @@ void export_Electronic_objects(){
   void (*expt_propagate_electronic_nonHermitian_v1)(double dt,CMATRIX& Coeff, CMATRIX& Hvib) = &propagate_electronic_nonHermitian;
   def("propagate_electronic_nonHermitian", expt_propagate_electronic_nonHermitian_v1);
 
+  void (*expt_propagate_electronic_krylov_v1)(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian, double tol, int m_max) = &propagate_electronic_krylov;
+  void (*expt_propagate_electronic_krylov_v2)(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int is_hermitian) = &propagate_electronic_krylov;
+  void (*expt_propagate_electronic_krylov_v3)(double dt, CMATRIX& Coeff, CMATRIX& Hvib) = &propagate_electronic_krylov;
+  void (*expt_propagate_electronic_krylov_v4)(double dt, CMATRIX& C, nHamiltonian& ham, int rep, double tol, int m_max) = &propagate_electronic_krylov;
+  void (*expt_propagate_electronic_krylov_v5)(double dt, CMATRIX& C, nHamiltonian& ham, int rep) = &propagate_electronic_krylov;
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v1);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v2);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v3);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v4);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v5);
+
 
   void (*expt_grid_propagator_v1)(double dt, CMATRIX& Hvib, CMATRIX& S, CMATRIX& U) = &grid_propagator;
   def("grid_propagator", expt_grid_propagator_v1);
@@ -172,6 +172,12 @@ class Ensemble{
 
   void compute_averages();
 
+  // Defined in Ensemble_traj.cpp
+  void write_binary_frame(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies);
+  void write_binary_frame(BinaryTrajectoryWriter& w, int step, double time);
+  void read_binary_frame(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr);
+  void read_binary_frame(BinaryTrajectoryReader& r, int i);
+
 
 };
 
@@ -0,0 +1,135 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Ensemble_traj.cpp
+  \brief The file implements the output of the Ensemble to the binary trajectories and reading it back
+    
+*/
+
+#include "Ensemble.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libensemble namespace
+namespace libensemble{
+
+
+void Ensemble::write_binary_frame(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies){
+/**
+  \brief Appends the state of all trajectories to the binary trajectory
+
+  \param[in,out] w The trajectory writer. It must be created for ndof = nnucl*ntraj, ntraj = ntraj, nstates = nelec
+  \param[in] step The index of the step
+  \param[in] time The time of the frame
+  \param[in] energies The per-frame scalars (their number must match the writer's nenergies)
+
+  The nuclear q, p, f of all trajectories are concatenated; the active states and the amplitudes of the
+  electronic subsystems are stored if the writer's flags contain TRJ_ISTATE and TRJ_AMP, respectively.
+*/
+
+  if(w.ndof!=nnucl*ntraj || w.ntraj!=ntraj || w.nstates!=nelec){
+    cout<<"Error in Ensemble::write_binary_frame: the writer layout (ndof = "<<w.ndof<<", ntraj = "<<w.ntraj
+        <<", nstates = "<<w.nstates<<") does not match the Ensemble\n"; exit(0);
+  }
+
+  TrajectoryFrame fr;
+  fr.step = step;
+  fr.time = time;
+  fr.energies = energies;
+
+  if(w.flags & TRJ_Q){  fr.q.resize(nnucl*ntraj);  }
+  if(w.flags & TRJ_P){  fr.p.resize(nnucl*ntraj);  }
+  if(w.flags & TRJ_F){  fr.f.resize(nnucl*ntraj);  }
+  if(w.flags & TRJ_ISTATE){  fr.istate.resize(ntraj);  }
+  if(w.flags & TRJ_AMP){  fr.amp_re.resize(nelec*ntraj);  fr.amp_im.resize(nelec*ntraj);  }
+
+  for(int tr=0;tr<ntraj;tr++){
+    for(int n=0;n<nnucl;n++){
+      if(w.flags & TRJ_Q){ fr.q[tr*nnucl+n] = mol[tr].q[n]; }
+      if(w.flags & TRJ_P){ fr.p[tr*nnucl+n] = mol[tr].p[n]; }
+      if(w.flags & TRJ_F){ fr.f[tr*nnucl+n] = mol[tr].f[n]; }
+    }
+    if(w.flags & TRJ_ISTATE){ fr.istate[tr] = el[tr].istate; }
+    if(w.flags & TRJ_AMP){
+      for(int i=0;i<nelec;i++){
+        fr.amp_re[tr*nelec+i] = el[tr].q[i];
+        fr.amp_im[tr*nelec+i] = el[tr].p[i];
+      }
+    }
+  }// for tr
+
+  w.write_frame(fr);
+
+}
+
+void Ensemble::write_binary_frame(BinaryTrajectoryWriter& w, int step, double time){
+/**
+  \brief Same as above, for the writers with no per-frame scalars
+*/
+  vector<double> energies;
+  write_binary_frame(w, step, time, energies);
+}
+
+
+void Ensemble::read_binary_frame(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr){
+/**
+  \brief Loads the i-th frame of the binary trajectory into the nuclear and electronic subsystems
+
+  \param[in] r The trajectory reader. The file must be written for ndof = nnucl*ntraj, ntraj = ntraj, nstates = nelec
+  \param[in] i The index of the frame
+  \param[out] fr The frame itself - gives access to the step, time and energies
+
+  Only the variables stored in the file are updated. The Hamiltonians are not recomputed.
+*/
+
+  if(r.ndof!=nnucl*ntraj || r.ntraj!=ntraj || r.nstates!=nelec){
+    cout<<"Error in Ensemble::read_binary_frame: the trajectory layout (ndof = "<<r.ndof<<", ntraj = "<<r.ntraj
+        <<", nstates = "<<r.nstates<<") does not match the Ensemble\n"; exit(0);
+  }
+
+  r.read_frame(i, fr);
+
+  for(int tr=0;tr<ntraj;tr++){
+    for(int n=0;n<nnucl;n++){
+      if(r.flags & TRJ_Q){ mol[tr].q[n] = fr.q[tr*nnucl+n]; }
+      if(r.flags & TRJ_P){ mol[tr].p[n] = fr.p[tr*nnucl+n]; }
+      if(r.flags & TRJ_F){ mol[tr].f[n] = fr.f[tr*nnucl+n]; }
+    }
+    if(r.flags & TRJ_ISTATE){ el[tr].istate = fr.istate[tr]; }
+    if(r.flags & TRJ_AMP){
+      for(int j=0;j<nelec;j++){
+        el[tr].q[j] = fr.amp_re[tr*nelec+j];
+        el[tr].p[j] = fr.amp_im[tr*nelec+j];
+      }
+    }
+  }// for tr
+
+}
+
+void Ensemble::read_binary_frame(BinaryTrajectoryReader& r, int i){
+/**
+  \brief Same as above, when only the trajectory variables are needed
+*/
+  TrajectoryFrame fr;
+  read_binary_frame(r, i, fr);
+}
+
+
+
+}// namespace libensemble
+}// namespace libdyn
+}// liblibra
+
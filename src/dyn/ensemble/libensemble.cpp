@@ -99,6 +99,11 @@ void export_Ensemble_objects(){
   boost::python::list (Ensemble::*expt_sh_pop1_v3)(double xmax,double xmin) = &Ensemble::sh_pop1;
   boost::python::list (Ensemble::*expt_sh_pop1_v4)() = &Ensemble::sh_pop1;
 
+  void (Ensemble::*expt_write_binary_frame_v1)(BinaryTrajectoryWriter& w, int step, double time, vector<double>& energies) = &Ensemble::write_binary_frame;
+  void (Ensemble::*expt_write_binary_frame_v2)(BinaryTrajectoryWriter& w, int step, double time) = &Ensemble::write_binary_frame;
+  void (Ensemble::*expt_read_binary_frame_v1)(BinaryTrajectoryReader& r, int i, TrajectoryFrame& fr) = &Ensemble::read_binary_frame;
+  void (Ensemble::*expt_read_binary_frame_v2)(BinaryTrajectoryReader& r, int i) = &Ensemble::read_binary_frame;
+
 
 
 
@@ -178,6 +183,11 @@ void export_Ensemble_objects(){
       .def("sh_pop1", expt_sh_pop1_v3)
       .def("sh_pop1", expt_sh_pop1_v4)
 
+      .def("write_binary_frame", expt_write_binary_frame_v1)
+      .def("write_binary_frame", expt_write_binary_frame_v2)
+      .def("read_binary_frame", expt_read_binary_frame_v1)
+      .def("read_binary_frame", expt_read_binary_frame_v2)
+
 
  
   ;
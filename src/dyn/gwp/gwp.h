@@ -19,6 +19,8 @@
 
 
 #include "../../math_linalg/liblinalg.h"
+#include "../../math_meigen/libmeigen.h"
+#include "../../io/libio.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -52,6 +54,42 @@ complex<double> gwp_kinetic(MATRIX& R1, MATRIX& P1, double gamma1,
                             double alp, double hbar);
 
 
+///< In gwp_batch.cpp
+int check_basis(std::string function_name, MATRIX& q, MATRIX& p, MATRIX& gamma);
+void gwp_ints_batch(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, CMATRIX& S, CMATRIX& T);
+CMATRIX gwp_overlap_matrix(MATRIX& q, MATRIX& p, MATRIX& gamma, double alp, double hbar);
+CMATRIX gwp_kinetic_matrix(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar);
+
+void gwp_potential_batch(MATRIX& q, MATRIX& p, double alp, double hbar, CMATRIX& S,
+                         vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham,
+                         int approx, CMATRIX& V);
+
+void gwp_tdc_batch(MATRIX& q, MATRIX& p, MATRIX& dqdt, MATRIX& dpdt, MATRIX& dgamma, double alp, double hbar,
+                   CMATRIX& S, CMATRIX& tau);
+
+
+///< In gwp_dynamics.cpp
+void gwp_surfaces(MATRIX& q, int nstates, bp::object py_funct, bp::object params,
+                  vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham);
+
+void gwp_ehrenfest(CMATRIX& A, int nstates, vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, MATRIX& F, MATRIX& E);
+
+void gwp_hamiltonian(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, int nstates,
+                     vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham, int approx,
+                     CMATRIX& S, CMATRIX& H);
+
+void gwp_mce_step(double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM,
+                   double alp, double hbar, int nstates, bp::object py_funct, bp::object params,
+                   int approx, double s_reg);
+void gwp_mce_step(double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM,
+                   double alp, double hbar, int nstates, bp::object py_funct, bp::object params, int approx);
+
+double gwp_norm(CMATRIX& A, CMATRIX& S, int nstates);
+MATRIX gwp_populations(CMATRIX& A, CMATRIX& S, int nstates);
+double gwp_energy(MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM, double alp, double hbar, int nstates,
+                  bp::object py_funct, bp::object params, int approx);
+
+
 
 
 }// namespace libgwp
@@ -0,0 +1,310 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file gwp_batch.cpp
+  \brief The integrals for the whole basis of N Gaussian wavepackets (GWPs), computed in one pass
+
+  The packets are stored column-wise: q and p are Ndof x N matrices, gamma is a N x 1 matrix. All the packets
+  have the same width alp. For every pair (a, b) with a <= b the overlap S_ab is computed once, and all the other
+  matrix elements are obtained as S_ab times a polynomial in the complex center of the product G_a^* G_b:
+
+  r0_ab = (q_a + q_b)/2 + i*(p_b - p_a)/(4*alp*hbar)
+
+  The elements with a > b are obtained by the Hermiticity.
+
+  The multistate matrices (potential) use the packet-major ordering of the basis functions: I = a * nstates + s
+*/
+
+#include "gwp.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libgwp namespace
+namespace libgwp{
+
+
+int check_basis(std::string function_name, MATRIX& q, MATRIX& p, MATRIX& gamma){
+/**
+  Checks the consistency of the basis parameters and returns the number of the packets
+*/
+
+  if(q.n_rows!=p.n_rows || q.n_cols!=p.n_cols){
+    cout<<"Error in "<<function_name<<": The dimensions of q ("<<q.n_rows<<" x "<<q.n_cols<<") and p ("
+        <<p.n_rows<<" x "<<p.n_cols<<") do not match\n"; exit(0);
+  }
+  if(gamma.n_rows*gamma.n_cols!=q.n_cols){
+    cout<<"Error in "<<function_name<<": gamma should contain "<<q.n_cols<<" elements\n"; exit(0);
+  }
+
+  return q.n_cols;
+}
+
+
+void gwp_ints_batch(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, CMATRIX& S, CMATRIX& T){
+/**
+  Computes the overlap and the kinetic energy matrices in the basis of N GWPs
+
+  S_ab = <G_a|G_b>,   T_ab = <G_a| sum_k { -hbar^2/(2*m_k) * d^2/dr_k^2 } |G_b>
+
+  \param[in] q The positions of the packets - Ndof x N matrix
+  \param[in] p The momenta of the packets - Ndof x N matrix
+  \param[in] gamma The phases of the packets - N x 1 matrix
+  \param[in] iM The inverse masses of all DOFs - Ndof x 1 matrix
+  \param[in] alp The Gaussian width factor (same for all packets and DOFs)
+  \param[in] hbar The Planck constant in selected units
+  \param[out] S The overlap matrix - N x N
+  \param[out] T The kinetic energy matrix - N x N
+*/
+
+  int N = check_basis("libgwp::gwp_ints_batch", q, p, gamma);
+  int Ndof = q.n_rows;
+
+  if(iM.n_rows*iM.n_cols!=Ndof){
+    cout<<"Error in libgwp::gwp_ints_batch: iM should contain "<<Ndof<<" elements\n"; exit(0);
+  }
+  if(S.n_rows!=N || S.n_cols!=N || T.n_rows!=N || T.n_cols!=N){
+    cout<<"Error in libgwp::gwp_ints_batch: S and T should be "<<N<<" x "<<N<<" matrices\n"; exit(0);
+  }
+
+  double ihbar = 1.0/hbar;
+
+  for(int a=0;a<N;a++){
+    for(int b=a;b<N;b++){
+
+      double re = 0.0, im = (gamma.M[b] - gamma.M[a])*ihbar;
+      complex<double> t(0.0, 0.0);
+
+      for(int k=0;k<Ndof;k++){
+        double dq = q.M[k*N+b] - q.M[k*N+a];
+        double dp = p.M[k*N+b] - p.M[k*N+a];
+        double pm = 0.5*(p.M[k*N+a] + p.M[k*N+b])*ihbar;
+
+        re += -0.5*alp*dq*dq - (0.125/alp)*dp*dp*ihbar*ihbar;
+        im += -pm*dq;
+
+        // <G_a|d/dr_k|G_b> / <G_a|G_b> = alp*dq + i*pm
+        complex<double> d1(alp*dq, pm);
+        t += -0.5*hbar*hbar*iM.M[k]*(d1*d1 - alp);
+      }
+
+      complex<double> s = std::exp(complex<double>(re, im));
+
+      S.M[a*N+b] = s;
+      T.M[a*N+b] = s*t;
+
+      if(b!=a){
+        S.M[b*N+a] = std::conj(S.M[a*N+b]);
+        T.M[b*N+a] = std::conj(T.M[a*N+b]);
+      }
+
+    }// for b
+  }// for a
+
+}
+
+
+CMATRIX gwp_overlap_matrix(MATRIX& q, MATRIX& p, MATRIX& gamma, double alp, double hbar){
+/**
+  The overlap matrix S_ab = <G_a|G_b> of the N GWPs. The parameters are as in gwp_ints_batch
+*/
+
+  int N = check_basis("libgwp::gwp_overlap_matrix", q, p, gamma);
+
+  MATRIX iM(q.n_rows, 1);  iM = 1.0;
+  CMATRIX S(N, N), T(N, N);
+
+  gwp_ints_batch(q, p, gamma, iM, alp, hbar, S, T);
+
+  return S;
+}
+
+
+CMATRIX gwp_kinetic_matrix(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar){
+/**
+  The kinetic energy matrix T_ab = <G_a|T|G_b> of the N GWPs. The parameters are as in gwp_ints_batch
+*/
+
+  int N = check_basis("libgwp::gwp_kinetic_matrix", q, p, gamma);
+
+  CMATRIX S(N, N), T(N, N);
+
+  gwp_ints_batch(q, p, gamma, iM, alp, hbar, S, T);
+
+  return T;
+}
+
+
+
+void gwp_potential_batch(MATRIX& q, MATRIX& p, double alp, double hbar, CMATRIX& S,
+                         vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham,
+                         int approx, CMATRIX& V){
+/**
+  Computes the potential energy matrix in the multistate basis of N GWPs: V_{as,bs'} = <G_a|H_ss'(r)|G_b>
+
+  The bra-ket averaged Taylor (BAT) expansion is used: the potential is expanded around the centers of both
+  packets and the two expansions are averaged:
+
+  V_{as,bs'} = S_ab * 1/2 * sum_{c = a,b} { H_c + sum_k dH_c,k * d_k + 1/2 * sum_kl d2H_c,kl * (d_k * d_l + delta_kl/(4*alp)) }
+
+  with d = r0_ab - q_c. For a = b this is the local harmonic approximation (LHA) for the packet a.
+
+  \param[in] q, p The positions and momenta of the packets - Ndof x N matrices
+  \param[in] alp The Gaussian width factor
+  \param[in] hbar The Planck constant in selected units
+  \param[in] S The overlap matrix of the packets (e.g. from gwp_ints_batch) - N x N
+  \param[in] ham The Hamiltonians at the centers of the packets - N matrices nstates x nstates
+  \param[in] d1ham The first derivatives at the centers: d1ham[a*Ndof+k] = dH/dq_k at q_a - N*Ndof matrices
+  \param[in] d2ham The second derivatives at the centers: d2ham[(a*Ndof+k)*Ndof+l] = d^2H/(dq_k dq_l) at q_a -
+             N*Ndof*Ndof matrices (not used if approx < 2)
+  \param[in] approx The order of the expansion: 0 - only the values at the centers, 1 - with the gradients,
+             2 - with the Hessians
+  \param[out] V The potential energy matrix - (N*nstates) x (N*nstates)
+*/
+
+  int N = q.n_cols;
+  int Ndof = q.n_rows;
+
+  if(ham.size()!=N){
+    cout<<"Error in libgwp::gwp_potential_batch: ham should contain "<<N<<" matrices\n"; exit(0);
+  }
+  int nst = ham[0].n_rows;
+
+  if(approx>=1 && d1ham.size()!=N*Ndof){
+    cout<<"Error in libgwp::gwp_potential_batch: d1ham should contain "<<N*Ndof<<" matrices\n"; exit(0);
+  }
+  if(approx>=2 && d2ham.size()!=N*Ndof*Ndof){
+    cout<<"Error in libgwp::gwp_potential_batch: d2ham should contain "<<N*Ndof*Ndof<<" matrices\n"; exit(0);
+  }
+  if(V.n_rows!=N*nst || V.n_cols!=N*nst){
+    cout<<"Error in libgwp::gwp_potential_batch: V should be a "<<N*nst<<" x "<<N*nst<<" matrix\n"; exit(0);
+  }
+
+  int sz = N*nst;
+  double w = 0.25/alp;   // the variance of the product Gaussian
+
+  vector< complex<double> > d(Ndof);
+  CMATRIX v(nst, nst);
+
+  for(int a=0;a<N;a++){
+    for(int b=a;b<N;b++){
+
+      v = 0.0;
+
+      for(int ic=0; ic<2; ic++){
+        int c = (ic==0) ? a : b;
+
+        for(int k=0;k<Ndof;k++){
+          d[k] = complex<double>(0.5*(q.M[k*N+a] + q.M[k*N+b]) - q.M[k*N+c],
+                                 (p.M[k*N+b] - p.M[k*N+a])*w/hbar);
+        }
+
+        for(int n=0;n<nst*nst;n++){
+          complex<double> val = ham[c].M[n];
+
+          if(approx>=1){
+            for(int k=0;k<Ndof;k++){  val += d1ham[c*Ndof+k].M[n] * d[k];  }
+          }
+          if(approx>=2){
+            for(int k=0;k<Ndof;k++){
+              for(int l=0;l<Ndof;l++){
+                complex<double> m2 = d[k]*d[l];
+                if(k==l){ m2 += w; }
+                val += 0.5 * d2ham[(c*Ndof+k)*Ndof+l].M[n] * m2;
+              }
+            }
+          }
+
+          v.M[n] += 0.5*val;
+        }// for n
+      }// for ic
+
+      complex<double> s = S.M[a*N+b];
+
+      for(int i=0;i<nst;i++){
+        for(int j=0;j<nst;j++){
+          complex<double> val = s * v.M[i*nst+j];
+          V.M[(a*nst+i)*sz + (b*nst+j)] = val;
+          if(b!=a){  V.M[(b*nst+j)*sz + (a*nst+i)] = std::conj(val);  }
+        }
+      }
+
+    }// for b
+  }// for a
+
+}
+
+
+
+void gwp_tdc_batch(MATRIX& q, MATRIX& p, MATRIX& dqdt, MATRIX& dpdt, MATRIX& dgamma, double alp, double hbar,
+                   CMATRIX& S, CMATRIX& tau){
+/**
+  Computes the time-derivative matrix of the basis: tau_ab = <G_a| d/dt G_b>
+
+  tau_ab = S_ab * { sum_k [ (2*alp*d_k - i*p_bk/hbar) * dq_bk/dt + (i/hbar) * d_k * dp_bk/dt ] + i*(dgamma_b/dt)/hbar }
+
+  with d = r0_ab - q_b. Note that tau + tau^+ = dS/dt.
+
+  \param[in] q, p The positions and momenta of the packets - Ndof x N matrices
+  \param[in] dqdt, dpdt The time-derivatives of q and p - Ndof x N matrices
+  \param[in] dgamma The time-derivatives of the phases - N x 1 matrix
+  \param[in] alp The Gaussian width factor
+  \param[in] hbar The Planck constant in selected units
+  \param[in] S The overlap matrix of the packets - N x N
+  \param[out] tau The time-derivative matrix - N x N
+*/
+
+  int N = q.n_cols;
+  int Ndof = q.n_rows;
+
+  if(p.n_rows!=Ndof || p.n_cols!=N || dqdt.n_rows!=Ndof || dqdt.n_cols!=N || dpdt.n_rows!=Ndof || dpdt.n_cols!=N){
+    cout<<"Error in libgwp::gwp_tdc_batch: p, dqdt and dpdt should be "<<Ndof<<" x "<<N<<" matrices, as q\n"; exit(0);
+  }
+  if(dgamma.n_rows*dgamma.n_cols!=N){
+    cout<<"Error in libgwp::gwp_tdc_batch: dgamma should contain "<<N<<" elements\n"; exit(0);
+  }
+  if(S.n_rows!=N || S.n_cols!=N || tau.n_rows!=N || tau.n_cols!=N){
+    cout<<"Error in libgwp::gwp_tdc_batch: S and tau should be "<<N<<" x "<<N<<" matrices\n"; exit(0);
+  }
+
+  double ihbar = 1.0/hbar;
+  double w = 0.25/alp;
+
+  for(int a=0;a<N;a++){
+    for(int b=0;b<N;b++){
+
+      complex<double> t(0.0, dgamma.M[b]*ihbar);
+
+      for(int k=0;k<Ndof;k++){
+        complex<double> d(0.5*(q.M[k*N+a] - q.M[k*N+b]), (p.M[k*N+b] - p.M[k*N+a])*w*ihbar);
+
+        t += (2.0*alp*d - complex<double>(0.0, p.M[k*N+b]*ihbar)) * dqdt.M[k*N+b]
+           + complex<double>(0.0, ihbar) * d * dpdt.M[k*N+b];
+      }
+
+      tau.M[a*N+b] = S.M[a*N+b] * t;
+
+    }// for b
+  }// for a
+
+}
+
+
+
+}// namespace libgwp
+}// namespace libdyn
+}// liblibra
+
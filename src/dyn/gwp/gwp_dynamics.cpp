@@ -0,0 +1,406 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file gwp_dynamics.cpp
+  \brief The propagator for the multistate wavefunction expanded in the basis of N coupled GWPs
+
+  Psi(r,t) = sum_a sum_s A_as(t) * G_a(r; q_a(t), p_a(t), gamma_a(t)) |s>
+
+  The amplitudes are propagated by the variational (Dirac-Frenkel) equations in the non-orthogonal moving basis:
+
+  i*hbar * S * dA/dt = (H - i*hbar*tau) * A
+
+  where H = V + T (x) I is the full multistate Hamiltonian matrix in the basis (gwp_potential_batch and
+  gwp_ints_batch) and tau is the time-derivative matrix of the basis (gwp_tdc_batch). The packet parameters
+  follow the classical trajectories (as in the AIMS and multiconfigurational Ehrenfest methods) on the
+  Ehrenfest surfaces defined by the amplitudes of each packet, with dgamma/dt = p^2/(2m) - E_a.
+*/
+
+#include "gwp.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace libmeigen;
+using namespace libio;
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libgwp namespace
+namespace libgwp{
+
+
+void gwp_surfaces(MATRIX& q, int nstates, bp::object py_funct, bp::object params,
+                  vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham){
+/**
+  Computes the Hamiltonian and its derivatives at the centers of all packets
+
+  \param[in] q The positions of the packets - Ndof x N matrix
+  \param[in] nstates The number of electronic states
+  \param[in] py_funct The Python function with the signature py_funct(q, params), where q is a Ndof x 1 MATRIX.
+             It should return an object with the members "ham_dia" (CMATRIX nstates x nstates), "d1ham_dia"
+             (list of Ndof CMATRIX) and, optionally, "d2ham_dia" (list of Ndof*Ndof CMATRIX, index k*Ndof+l)
+  \param[in] params The parameters of the Python function
+  \param[out] ham, d1ham, d2ham The Hamiltonians and their derivatives at the centers in the format used by
+             gwp_potential_batch. d2ham is empty if the function does not return "d2ham_dia"
+*/
+
+  int N = q.n_cols;
+  int Ndof = q.n_rows;
+
+  ham = vector<CMATRIX>(N, CMATRIX(nstates, nstates));
+  d1ham = vector<CMATRIX>(N*Ndof, CMATRIX(nstates, nstates));
+  d2ham.clear();
+
+  MATRIX qa(Ndof, 1);
+
+  for(int a=0;a<N;a++){
+
+    for(int k=0;k<Ndof;k++){  qa.M[k] = q.M[k*N+a];  }
+
+    bp::object obj = py_funct(qa, params);
+
+    if(!hasattr(obj, "ham_dia") || !hasattr(obj, "d1ham_dia")){
+      cout<<"Error in libgwp::gwp_surfaces: the Python function should return an object with the "
+          <<"ham_dia and d1ham_dia members\n"; exit(0);
+    }
+
+    ham[a] = extract<CMATRIX>(obj.attr("ham_dia"));
+
+    vector<CMATRIX> d1 = extract<CMATRIXList>(obj.attr("d1ham_dia"));
+    if(d1.size()!=Ndof){
+      cout<<"Error in libgwp::gwp_surfaces: d1ham_dia should contain "<<Ndof<<" matrices\n"; exit(0);
+    }
+    for(int k=0;k<Ndof;k++){  d1ham[a*Ndof+k] = d1[k];  }
+
+    if(hasattr(obj, "d2ham_dia")){
+      vector<CMATRIX> d2 = extract<CMATRIXList>(obj.attr("d2ham_dia"));
+      if(d2.size()!=Ndof*Ndof){
+        cout<<"Error in libgwp::gwp_surfaces: d2ham_dia should contain "<<Ndof*Ndof<<" matrices\n"; exit(0);
+      }
+      if(a==0){  d2ham = vector<CMATRIX>(N*Ndof*Ndof, CMATRIX(nstates, nstates));  }
+      for(int kl=0;kl<Ndof*Ndof;kl++){  d2ham[a*Ndof*Ndof+kl] = d2[kl];  }
+    }
+
+  }// for a
+
+}
+
+
+
+void gwp_ehrenfest(CMATRIX& A, int nstates, vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, MATRIX& F, MATRIX& E){
+/**
+  Computes the Ehrenfest forces and energies for every packet, with the electronic state given by the
+  amplitudes of this packet: F_ak = -<A_a|dH/dq_k|A_a>/<A_a|A_a>,  E_a = <A_a|H|A_a>/<A_a|A_a>.
+  If the packet carries no amplitude, the states are averaged with equal weights.
+
+  \param[in] A The amplitudes - (N*nstates) x 1 matrix
+  \param[in] nstates The number of electronic states
+  \param[in] ham, d1ham The Hamiltonians and their first derivatives at the centers
+  \param[out] F The forces - Ndof x N matrix
+  \param[out] E The energies - N x 1 matrix
+*/
+
+  int N = ham.size();
+  int Ndof = F.n_rows;
+
+  vector< complex<double> > c(nstates);
+
+  for(int a=0;a<N;a++){
+
+    double nrm = 0.0;
+    for(int s=0;s<nstates;s++){  c[s] = A.M[a*nstates+s];  nrm += std::norm(c[s]);  }
+
+    if(nrm<1e-30){
+      for(int s=0;s<nstates;s++){  c[s] = 1.0;  }
+      nrm = nstates;
+    }
+
+    double e = 0.0;
+    for(int i=0;i<nstates;i++){
+      for(int j=0;j<nstates;j++){  e += std::real(std::conj(c[i]) * ham[a].M[i*nstates+j] * c[j]);  }
+    }
+    E.M[a] = e/nrm;
+
+    for(int k=0;k<Ndof;k++){
+      double f = 0.0;
+      CMATRIX& dh = d1ham[a*Ndof+k];
+      for(int i=0;i<nstates;i++){
+        for(int j=0;j<nstates;j++){  f += std::real(std::conj(c[i]) * dh.M[i*nstates+j] * c[j]);  }
+      }
+      F.M[k*N+a] = -f/nrm;
+    }
+
+  }// for a
+
+}
+
+
+
+void gwp_hamiltonian(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, int nstates,
+                     vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham, int approx,
+                     CMATRIX& S, CMATRIX& H){
+/**
+  The overlap of the packets (N x N) and the full multistate Hamiltonian H = V + T (x) I ((N*nstates) x (N*nstates))
+*/
+
+  int N = q.n_cols;
+  int sz = N*nstates;
+
+  CMATRIX T(N, N);
+
+  gwp_ints_batch(q, p, gamma, iM, alp, hbar, S, T);
+
+  if(approx>=2 && d2ham.size()==0){ approx = 1; }
+  gwp_potential_batch(q, p, alp, hbar, S, ham, d1ham, d2ham, approx, H);
+
+  for(int a=0;a<N;a++){
+    for(int b=0;b<N;b++){
+      for(int s=0;s<nstates;s++){  H.M[(a*nstates+s)*sz + (b*nstates+s)] += T.M[a*N+b];  }
+    }
+  }
+
+}
+
+
+void gwp_generator(MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, int nstates,
+                   vector<CMATRIX>& ham, vector<CMATRIX>& d1ham, vector<CMATRIX>& d2ham, int approx,
+                   MATRIX& F, MATRIX& dgamma, double s_reg, CMATRIX& M){
+/**
+  The generator of the amplitudes propagation: i*hbar*dA/dt = M * A,  M = S^-1 * (H - i*hbar*tau)
+
+  S^-1 is the regularized inverse: the eigenvalues s of S are inverted as s/(s^2 + s_reg^2), so the nearly
+  linearly-dependent combinations of the packets are filtered out.
+*/
+
+  int N = q.n_cols;
+  int Ndof = q.n_rows;
+  int sz = N*nstates;
+
+  CMATRIX S(N, N), H(sz, sz), tau(N, N);
+
+  gwp_hamiltonian(q, p, gamma, iM, alp, hbar, nstates, ham, d1ham, d2ham, approx, S, H);
+
+  MATRIX dqdt(Ndof, N);
+  for(int k=0;k<Ndof;k++){
+    for(int a=0;a<N;a++){  dqdt.M[k*N+a] = iM.M[k] * p.M[k*N+a];  }
+  }
+  gwp_tdc_batch(q, p, dqdt, F, dgamma, alp, hbar, S, tau);
+
+  complex<double> ihbar(0.0, hbar);
+  for(int a=0;a<N;a++){
+    for(int b=0;b<N;b++){
+      for(int s=0;s<nstates;s++){  H.M[(a*nstates+s)*sz + (b*nstates+s)] -= ihbar * tau.M[a*N+b];  }
+    }
+  }
+
+
+  // Regularized inverse of S
+  CMATRIX Seig(N, N), C(N, N), Sinv(N, N);
+  solve_eigen(S, Seig, C, 0);
+
+  CMATRIX D(N, N);  D = 0.0;
+  for(int a=0;a<N;a++){
+    double s = Seig.get(a,a).real();
+    D.M[a*N+a] = s/(s*s + s_reg*s_reg);
+  }
+  Sinv = C * D * C.H();
+
+
+  // M = (S^-1 (x) I) * H
+  M = 0.0;
+  for(int a=0;a<N;a++){
+    for(int c=0;c<N;c++){
+      complex<double> sac = Sinv.M[a*N+c];
+      if(std::abs(sac)==0.0){ continue; }
+
+      for(int s=0;s<nstates;s++){
+        int ra = (a*nstates+s)*sz;
+        int rc = (c*nstates+s)*sz;
+        for(int J=0;J<sz;J++){  M.M[ra+J] += sac * H.M[rc+J];  }
+      }
+    }
+  }
+
+}
+
+
+
+void gwp_mce_step(double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM,
+                   double alp, double hbar, int nstates, bp::object py_funct, bp::object params,
+                   int approx, double s_reg){
+/**
+  Propagates the GWP wavefunction for one time step
+
+  \param[in] dt The integration time step
+  \param[in,out] q, p The positions and momenta of the packets - Ndof x N matrices
+  \param[in,out] gamma The phases of the packets - N x 1 matrix
+  \param[in,out] A The amplitudes - (N*nstates) x 1 matrix, index a*nstates + s
+  \param[in] iM The inverse masses of all DOFs - Ndof x 1 matrix
+  \param[in] alp The Gaussian width factor
+  \param[in] hbar The Planck constant in selected units
+  \param[in] nstates The number of electronic states
+  \param[in] py_funct, params The Python function computing the Hamiltonian and its derivatives (see gwp_surfaces)
+  \param[in] approx The order of the BAT expansion of the potential matrix elements (see gwp_potential_batch)
+  \param[in] s_reg The regularization parameter for the inverse of the overlap matrix
+
+  This is the multiconfigurational Ehrenfest (MCE) scheme, not the variational MCG: the packets are not
+  variational parameters, they follow the Ehrenfest trajectories propagated by the velocity Verlet algorithm.
+  The amplitudes are propagated variationally in this moving basis, with the exponential of the generator
+  averaged over the beginning and the end of the step (second order), using the Krylov (Arnoldi) method.
+  The Hamiltonian is computed at the beginning and at the end of the step.
+*/
+
+  int N = check_basis("libgwp::gwp_mce_step", q, p, gamma);
+  int Ndof = q.n_rows;
+  int sz = N*nstates;
+
+  if(A.n_rows!=sz || A.n_cols!=1){
+    cout<<"Error in libgwp::gwp_mce_step: A should be a "<<sz<<" x 1 matrix\n"; exit(0);
+  }
+
+  vector<CMATRIX> ham, d1ham, d2ham;
+  MATRIX F(Ndof, N), E(N, 1), dgamma0(N, 1), dgamma1(N, 1);
+  CMATRIX M0(sz, sz), M1(sz, sz);
+
+
+  // Beginning of the step
+  gwp_surfaces(q, nstates, py_funct, params, ham, d1ham, d2ham);
+  gwp_ehrenfest(A, nstates, ham, d1ham, F, E);
+
+  for(int a=0;a<N;a++){
+    double ekin = 0.0;
+    for(int k=0;k<Ndof;k++){  ekin += 0.5*iM.M[k]*p.M[k*N+a]*p.M[k*N+a];  }
+    dgamma0.M[a] = ekin - E.M[a];
+  }
+
+  gwp_generator(q, p, gamma, iM, alp, hbar, nstates, ham, d1ham, d2ham, approx, F, dgamma0, s_reg, M0);
+
+
+  // Packets: velocity Verlet
+  for(int k=0;k<Ndof;k++){
+    for(int a=0;a<N;a++){
+      p.M[k*N+a] += 0.5*dt*F.M[k*N+a];
+      q.M[k*N+a] += dt*iM.M[k]*p.M[k*N+a];
+    }
+  }
+
+  gwp_surfaces(q, nstates, py_funct, params, ham, d1ham, d2ham);
+  gwp_ehrenfest(A, nstates, ham, d1ham, F, E);
+
+  for(int k=0;k<Ndof;k++){
+    for(int a=0;a<N;a++){  p.M[k*N+a] += 0.5*dt*F.M[k*N+a];  }
+  }
+
+  for(int a=0;a<N;a++){
+    double ekin = 0.0;
+    for(int k=0;k<Ndof;k++){  ekin += 0.5*iM.M[k]*p.M[k*N+a]*p.M[k*N+a];  }
+    dgamma1.M[a] = ekin - E.M[a];
+    gamma.M[a] += 0.5*dt*(dgamma0.M[a] + dgamma1.M[a]);
+  }
+
+
+  // End of the step
+  gwp_generator(q, p, gamma, iM, alp, hbar, nstates, ham, d1ham, d2ham, approx, F, dgamma1, s_reg, M1);
+
+
+  // Amplitudes
+  M0 = 0.5*(M0 + M1);
+  expmv_krylov(M0, A, complex<double>(0.0, -dt/hbar), 0);
+
+}
+
+
+void gwp_mce_step(double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM,
+                   double alp, double hbar, int nstates, bp::object py_funct, bp::object params, int approx){
+/**
+  Same as above with the regularization parameter s_reg = 1e-8
+*/
+
+  gwp_mce_step(dt, q, p, gamma, A, iM, alp, hbar, nstates, py_funct, params, approx, 1e-8);
+
+}
+
+
+
+double gwp_norm(CMATRIX& A, CMATRIX& S, int nstates){
+/**
+  The norm of the GWP wavefunction: <Psi|Psi> = A^+ * (S (x) I) * A
+
+  \param[in] A The amplitudes - (N*nstates) x 1 matrix
+  \param[in] S The overlap of the packets - N x N
+  \param[in] nstates The number of electronic states
+*/
+
+  int N = S.n_rows;
+  complex<double> res(0.0, 0.0);
+
+  for(int a=0;a<N;a++){
+    for(int b=0;b<N;b++){
+      for(int s=0;s<nstates;s++){
+        res += std::conj(A.M[a*nstates+s]) * S.M[a*N+b] * A.M[b*nstates+s];
+      }
+    }
+  }
+
+  return res.real();
+}
+
+
+MATRIX gwp_populations(CMATRIX& A, CMATRIX& S, int nstates){
+/**
+  The populations of the electronic states: P_s = sum_ab A_as^* S_ab A_bs - nstates x 1 matrix
+*/
+
+  int N = S.n_rows;
+  MATRIX res(nstates, 1);
+
+  for(int s=0;s<nstates;s++){
+    complex<double> pop(0.0, 0.0);
+    for(int a=0;a<N;a++){
+      for(int b=0;b<N;b++){  pop += std::conj(A.M[a*nstates+s]) * S.M[a*N+b] * A.M[b*nstates+s];  }
+    }
+    res.M[s] = pop.real();
+  }
+
+  return res;
+}
+
+
+double gwp_energy(MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM, double alp, double hbar, int nstates,
+                  bp::object py_funct, bp::object params, int approx){
+/**
+  The total energy of the GWP wavefunction: <Psi|H|Psi>/<Psi|Psi>. The parameters are as in gwp_mce_step
+*/
+
+  int N = check_basis("libgwp::gwp_energy", q, p, gamma);
+  int sz = N*nstates;
+
+  vector<CMATRIX> ham, d1ham, d2ham;
+  gwp_surfaces(q, nstates, py_funct, params, ham, d1ham, d2ham);
+
+  CMATRIX S(N, N), H(sz, sz);
+  gwp_hamiltonian(q, p, gamma, iM, alp, hbar, nstates, ham, d1ham, d2ham, approx, S, H);
+
+  CMATRIX e(1,1);  e = A.H() * H * A;
+
+  return e.M[0].real() / gwp_norm(A, S, nstates);
+
+}
+
+
+
+}// namespace libgwp
+}// namespace libdyn
+}// liblibra
+
@@ -218,9 +218,9 @@ complex<double> gwp_kinetic(MATRIX& R1, MATRIX& P1, double gamma1,
  
   int Ndof = check_dimensions("libgwp::gwp_kinetic", R1, P1, R2, P2);
 
-  // Overlap part 
-  double re = -alp + alp*alp*( (R2-R1).T()*(R2-R1) ).M[0] - ( (P2-P1).T()*(P2-P1) ).M[0]/(hbar*hbar)  ;
-  double im = alp* ((P1+P2).T() * (R2-R1)).M[0];
+  // Overlap part: <G_1|d/dr|G_2> / <G_1|G_2> = alp*(R2-R1) + i*(P1+P2)/(2*hbar) for each DOF, plus the width term
+  double re = -alp*Ndof + alp*alp*( (R2-R1).T()*(R2-R1) ).M[0] - 0.25*( (P1+P2).T()*(P1+P2) ).M[0]/(hbar*hbar)  ;
+  double im = alp* ((P1+P2).T() * (R2-R1)).M[0] / hbar;
 
   complex<double> res(re, im);  
   complex<double> ovlp  = gwp_overlap(R1, P1, gamma1, R2, P2, gamma2, alp, hbar);
@@ -61,6 +61,50 @@ void export_gwp_objects(){
   def("gwp_kinetic",  expt_gwp_kinetic_v1);
 
 
+  void (*expt_gwp_ints_batch_v1)
+  (MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar, CMATRIX& S, CMATRIX& T) = &gwp_ints_batch;
+
+  CMATRIX (*expt_gwp_overlap_matrix_v1)
+  (MATRIX& q, MATRIX& p, MATRIX& gamma, double alp, double hbar) = &gwp_overlap_matrix;
+
+  CMATRIX (*expt_gwp_kinetic_matrix_v1)
+  (MATRIX& q, MATRIX& p, MATRIX& gamma, MATRIX& iM, double alp, double hbar) = &gwp_kinetic_matrix;
+
+  void (*expt_gwp_potential_batch_v1)
+  (MATRIX& q, MATRIX& p, double alp, double hbar, CMATRIX& S, vector<CMATRIX>& ham, vector<CMATRIX>& d1ham,
+   vector<CMATRIX>& d2ham, int approx, CMATRIX& V) = &gwp_potential_batch;
+
+  void (*expt_gwp_tdc_batch_v1)
+  (MATRIX& q, MATRIX& p, MATRIX& dqdt, MATRIX& dpdt, MATRIX& dgamma, double alp, double hbar,
+   CMATRIX& S, CMATRIX& tau) = &gwp_tdc_batch;
+
+  def("gwp_ints_batch", expt_gwp_ints_batch_v1);
+  def("gwp_overlap_matrix", expt_gwp_overlap_matrix_v1);
+  def("gwp_kinetic_matrix", expt_gwp_kinetic_matrix_v1);
+  def("gwp_potential_batch", expt_gwp_potential_batch_v1);
+  def("gwp_tdc_batch", expt_gwp_tdc_batch_v1);
+
+
+  void (*expt_gwp_mce_step_v1)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM, double alp, double hbar, int nstates,
+   bp::object py_funct, bp::object params, int approx, double s_reg) = &gwp_mce_step;
+  void (*expt_gwp_mce_step_v2)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM, double alp, double hbar, int nstates,
+   bp::object py_funct, bp::object params, int approx) = &gwp_mce_step;
+
+  double (*expt_gwp_norm_v1)(CMATRIX& A, CMATRIX& S, int nstates) = &gwp_norm;
+  MATRIX (*expt_gwp_populations_v1)(CMATRIX& A, CMATRIX& S, int nstates) = &gwp_populations;
+  double (*expt_gwp_energy_v1)
+  (MATRIX& q, MATRIX& p, MATRIX& gamma, CMATRIX& A, MATRIX& iM, double alp, double hbar, int nstates,
+   bp::object py_funct, bp::object params, int approx) = &gwp_energy;
+
+  def("gwp_mce_step", expt_gwp_mce_step_v1);
+  def("gwp_mce_step", expt_gwp_mce_step_v2);
+  def("gwp_norm", expt_gwp_norm_v1);
+  def("gwp_populations", expt_gwp_populations_v1);
+  def("gwp_energy", expt_gwp_energy_v1);
+
+
 
 }
 
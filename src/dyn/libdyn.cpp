@@ -64,6 +64,12 @@ void export_Verlet_objects(){
   void (*expt_Verlet1_nvt_v4)
   (double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, int ent_opt, Thermostat& therm)
   = &Verlet1_nvt;
+  void (*expt_Verlet1_nvt_v5)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, Ensemble_Thermostat& therm)
+  = &Verlet1_nvt;
+  void (*expt_Verlet1_nvt_v6)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& invM, nHamiltonian& ham, bp::object py_funct, bp::object params, int ent_opt, Ensemble_Thermostat& therm)
+  = &Verlet1_nvt;
 
 
   def("Verlet0_nvt", expt_Verlet0_nvt_v1);
@@ -71,6 +77,8 @@ void export_Verlet_objects(){
   def("Verlet1_nvt", expt_Verlet1_nvt_v2);
   def("Verlet1_nvt", expt_Verlet1_nvt_v3);
   def("Verlet1_nvt", expt_Verlet1_nvt_v4);
+  def("Verlet1_nvt", expt_Verlet1_nvt_v5);
+  def("Verlet1_nvt", expt_Verlet1_nvt_v6);
 
 }
 
@@ -379,6 +387,110 @@ void export_decoherence_objects(){
 
 }
 
+void export_Checkpoint_objects(){
+
+  void (CheckpointWriter::*expt_save_v1)(MATRIX& x) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v2)(CMATRIX& x) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v3)(Random& rnd) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v4)(Nuclear& mol) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v5)(Electronic& el) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v6)(Thermostat& therm) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v7)(vector<Thermostat>& therm) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v8)(Ensemble& ens) = &CheckpointWriter::save;
+  void (CheckpointWriter::*expt_save_v9)(nHamiltonian& ham) = &CheckpointWriter::save;
+
+  class_<CheckpointWriter, boost::noncopyable>("CheckpointWriter",init<std::string>())
+      .def("save_int", &CheckpointWriter::save_int)
+      .def("save_double", &CheckpointWriter::save_double)
+      .def("save", expt_save_v1)
+      .def("save", expt_save_v2)
+      .def("save", expt_save_v3)
+      .def("save", expt_save_v4)
+      .def("save", expt_save_v5)
+      .def("save", expt_save_v6)
+      .def("save", expt_save_v7)
+      .def("save", expt_save_v8)
+      .def("save", expt_save_v9)
+      .def("close", &CheckpointWriter::close)
+  ;
+
+  void (CheckpointReader::*expt_load_v1)(MATRIX& x) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v2)(CMATRIX& x) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v3)(Random& rnd) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v4)(Nuclear& mol) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v5)(Electronic& el) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v6)(Thermostat& therm) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v7)(vector<Thermostat>& therm) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v8)(Ensemble& ens) = &CheckpointReader::load;
+  void (CheckpointReader::*expt_load_v9)(nHamiltonian& ham) = &CheckpointReader::load;
+
+  class_<CheckpointReader, boost::noncopyable>("CheckpointReader",init<std::string>())
+      .def("load_int", &CheckpointReader::load_int)
+      .def("load_double", &CheckpointReader::load_double)
+      .def("load", expt_load_v1)
+      .def("load", expt_load_v2)
+      .def("load", expt_load_v3)
+      .def("load", expt_load_v4)
+      .def("load", expt_load_v5)
+      .def("load", expt_load_v6)
+      .def("load", expt_load_v7)
+      .def("load", expt_load_v8)
+      .def("load", expt_load_v9)
+  ;
+
+}
+
+void export_NBRA_objects(){
+
+  void (*expt_write_nbra_store_v1)(std::string filename, vector<CMATRIX>& Hvib, double dt) = &write_nbra_store;
+  void (*expt_write_nbra_store_v2)(std::string filename, vector<CMATRIX>& E, vector<CMATRIX>& St, double dt) = &write_nbra_store;
+
+  def("write_nbra_store", expt_write_nbra_store_v1);
+  def("write_nbra_store", expt_write_nbra_store_v2);
+
+
+  CMATRIX (NBRAStore::*expt_get_Hvib_v1)(int i) = &NBRAStore::get_Hvib;
+  CMATRIX (NBRAStore::*expt_get_Hvib_v2)(double t) = &NBRAStore::get_Hvib;
+
+  class_<NBRAStore, boost::noncopyable>("NBRAStore",init<std::string>())
+      .def(init<vector<CMATRIX>&, double>())
+      .def_readonly("nstates", &NBRAStore::nstates)
+      .def_readonly("nsteps", &NBRAStore::nsteps)
+      .def_readonly("dt", &NBRAStore::dt)
+      .def("get_Hvib_snapshot", expt_get_Hvib_v1)
+      .def("get_Hvib_at", expt_get_Hvib_v2)
+      .def("decoherence_rates", &NBRAStore::decoherence_rates)
+  ;
+
+  class_<NBRAParams>("NBRAParams",init<>())
+      .def("__copy__", &generic__copy__<NBRAParams>)
+      .def("__deepcopy__", &generic__deepcopy__<NBRAParams>)
+      .def_readwrite("nsteps", &NBRAParams::nsteps)
+      .def_readwrite("nsubsteps", &NBRAParams::nsubsteps)
+      .def_readwrite("method", &NBRAParams::method)
+      .def_readwrite("use_boltz_factor", &NBRAParams::use_boltz_factor)
+      .def_readwrite("Temperature", &NBRAParams::Temperature)
+      .def_readwrite("ntraj", &NBRAParams::ntraj)
+      .def_readwrite("seed", &NBRAParams::seed)
+  ;
+
+  class_<NBRAStatistics>("NBRAStatistics",init<int, int>())
+      .def_readwrite("pop_se", &NBRAStatistics::pop_se)
+      .def_readwrite("pop_sh", &NBRAStatistics::pop_sh)
+      .def_readwrite("E_se", &NBRAStatistics::E_se)
+      .def_readwrite("E_sh", &NBRAStatistics::E_sh)
+      .def_readwrite("ntraj", &NBRAStatistics::ntraj)
+  ;
+
+  NBRAStatistics (*expt_run_nbra_v1)(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states,
+                                     MATRIX& decoh_rates) = &run_nbra;
+  NBRAStatistics (*expt_run_nbra_v2)(NBRAStore& store, NBRAParams& prms, vector<int>& init_times, vector<int>& init_states) = &run_nbra;
+
+  def("run_nbra", expt_run_nbra_v1);
+  def("run_nbra", expt_run_nbra_v2);
+
+}
+
 void export_Dyn_objects(){
 /** 
   \brief Exporter of libdyn classes and functions
@@ -409,6 +521,9 @@ void export_Dyn_objects(){
 
   export_decoherence_objects();
 
+  export_Checkpoint_objects();
+  export_NBRA_objects();
+
 
 
 
@@ -459,6 +574,52 @@ void export_Dyn_objects(){
   def("tsh1", expt_tsh1_v2);
 
 
+  class_<TSH_Adaptive_Control>("TSH_Adaptive_Control",init<int>())
+      .def(init<boost::python::dict, int>())
+      .def("__copy__", &generic__copy__<TSH_Adaptive_Control>)
+      .def("__deepcopy__", &generic__deepcopy__<TSH_Adaptive_Control>)
+
+      .def_readwrite("max_level", &TSH_Adaptive_Control::max_level)
+      .def_readwrite("nac_tol", &TSH_Adaptive_Control::nac_tol)
+      .def_readwrite("gap_tol", &TSH_Adaptive_Control::gap_tol)
+      .def_readwrite("gap_floor", &TSH_Adaptive_Control::gap_floor)
+      .def_readwrite("norm_tol", &TSH_Adaptive_Control::norm_tol)
+      .def_readwrite("el_tol", &TSH_Adaptive_Control::el_tol)
+      .def_readwrite("max_el_substeps", &TSH_Adaptive_Control::max_el_substeps)
+      .def_readwrite("merge_ratio", &TSH_Adaptive_Control::merge_ratio)
+      .def_readwrite("merge_delay", &TSH_Adaptive_Control::merge_delay)
+      .def_readwrite("do_log", &TSH_Adaptive_Control::do_log)
+      .def_readwrite("rev_stride", &TSH_Adaptive_Control::rev_stride)
+
+      .def_readwrite("level", &TSH_Adaptive_Control::level)
+      .def_readwrite("nel", &TSH_Adaptive_Control::nel)
+      .def_readwrite("calm", &TSH_Adaptive_Control::calm)
+      .def_readwrite("time", &TSH_Adaptive_Control::time)
+      .def_readwrite("nsplit", &TSH_Adaptive_Control::nsplit)
+      .def_readwrite("nmerge", &TSH_Adaptive_Control::nmerge)
+      .def_readwrite("nsubsteps", &TSH_Adaptive_Control::nsubsteps)
+      .def_readwrite("max_dE", &TSH_Adaptive_Control::max_dE)
+      .def_readwrite("max_rev", &TSH_Adaptive_Control::max_rev)
+      .def_readwrite("nevals", &TSH_Adaptive_Control::nevals)
+
+      .def("set_parameters", &TSH_Adaptive_Control::set_parameters)
+      .def("init", &TSH_Adaptive_Control::init)
+      .def("clear_log", &TSH_Adaptive_Control::clear_log)
+      .def("get_log", &TSH_Adaptive_Control::get_log)
+      .def("get_nrecords", &TSH_Adaptive_Control::get_nrecords)
+  ;
+
+  void (*expt_tsh1_adaptive_v1)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& states, nHamiltonian& ham,
+   bp::object py_funct, bp::object params,  boost::python::dict params1, Random& rnd, TSH_Adaptive_Control& ctrl,
+   int do_reordering, int do_phase_correction) = &tsh1_adaptive;
+  void (*expt_tsh1_adaptive_v2)
+  (double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& states, nHamiltonian& ham,
+   bp::object py_funct, bp::object params,  boost::python::dict params1, Random& rnd, TSH_Adaptive_Control& ctrl) = &tsh1_adaptive;
+  def("tsh1_adaptive", expt_tsh1_adaptive_v1);
+  def("tsh1_adaptive", expt_tsh1_adaptive_v2);
+
+
 
 
 
@@ -34,6 +34,9 @@
 #include "Surface_Hopping.h"
 #include "Dynamics_Nuclear.h"
 #include "Dynamics_Ensemble.h"
+#include "Checkpoint.h"
+#include "NBRA.h"
+#include "Adaptive_Stepping.h"
 
 
 /// liblibra namespace
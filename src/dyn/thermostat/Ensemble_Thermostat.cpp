@@ -0,0 +1,377 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Ensemble_Thermostat.cpp
+  \brief The file implements the thermostat acting on all the trajectories of an ensemble at once
+
+*/
+
+#include "Ensemble_Thermostat.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libthermostat namespace
+namespace libthermostat{
+
+
+Ensemble_Thermostat::Ensemble_Thermostat(boost::python::dict params, int ntraj_, int ndof_){
+/**
+  \param[in] params The Python dictionary with the parameters: thermostat_type, Temperature, Nf, NHC_size,
+  nu_therm, gamma, tau, nu_andersen, seed. The missing ones take the default values.
+  \param[in] ntraj_ The number of trajectories in the ensemble
+  \param[in] ndof_ The number of DOFs per trajectory
+*/
+
+  ntraj = ntraj_;
+  ndof = ndof_;
+  thermostat_type = "Nose-Hoover";
+  Temperature = 300.0;
+  Nf = ndof_;
+  NHC_size = 1;
+  nu_therm = 0.001;
+  gamma = 0.001;
+  tau = 1000.0;
+  nu_andersen = 0.001;
+  seed = 0;
+
+  std::string key;
+  for(int i=0;i<len(params.values());i++){
+    key = extract<std::string>(params.keys()[i]);
+
+    if(key=="thermostat_type") { thermostat_type = extract<std::string>(params.values()[i]); }
+    else if(key=="Temperature") { Temperature = extract<double>(params.values()[i]); }
+    else if(key=="Nf") { Nf = extract<double>(params.values()[i]); }
+    else if(key=="NHC_size") { NHC_size = extract<int>(params.values()[i]); }
+    else if(key=="nu_therm") { nu_therm = extract<double>(params.values()[i]); }
+    else if(key=="gamma") { gamma = extract<double>(params.values()[i]); }
+    else if(key=="tau") { tau = extract<double>(params.values()[i]); }
+    else if(key=="nu_andersen") { nu_andersen = extract<double>(params.values()[i]); }
+    else if(key=="seed") { seed = extract<int>(params.values()[i]); }
+  }
+
+  if(thermostat_type!="Nose-Hoover" && thermostat_type!="Langevin" &&
+     thermostat_type!="Bussi" && thermostat_type!="Andersen"){
+    cout<<"Error in Ensemble_Thermostat: thermostat_type = "<<thermostat_type<<" is not known\n";
+    cout<<"Use one of: Nose-Hoover, Langevin, Bussi, Andersen\n";
+    exit(0);
+  }
+  if(NHC_size<1){ NHC_size = 1; }
+
+  init();
+}
+
+
+void Ensemble_Thermostat::init(){
+/**
+  \brief Set the masses of the Nose-Hoover chains, reset all the bath variables and the random number streams
+*/
+
+  double kTt = kT() / (nu_therm * nu_therm);
+
+  Q = vector<double>(NHC_size, kTt);
+  Q[0] = Nf * kTt;
+
+  s = vector<double>(ntraj*NHC_size, 0.0);
+  ksi = vector<double>(ntraj*NHC_size, 0.0);
+  heat = vector<double>(ntraj, 0.0);
+  counter = vector<uint64_t>(ntraj, 0);
+}
+
+
+MATRIX Ensemble_Thermostat::kinetic_energies(MATRIX& p, MATRIX& invM){
+/**
+  \param[in] p [Ndof x Ntraj] The momenta of the ensemble
+  \param[in] invM [Ndof x 1] The inverse masses
+
+  Returns the [Ntraj x 1] matrix of the kinetic energies of the trajectories
+*/
+
+  MATRIX ekin(p.n_cols, 1);
+
+  for(int dof=0;dof<p.n_rows;dof++){
+    double im = invM.M[dof];
+    for(int traj=0;traj<p.n_cols;traj++){
+      double pi = p.M[dof*p.n_cols+traj];
+      ekin.M[traj] += 0.5*im*pi*pi;
+    }
+  }
+
+  return ekin;
+}
+
+
+void Ensemble_Thermostat::nhc_chain(int traj, double dt, double ekin){
+/**
+  \param[in] traj The index of the trajectory
+  \param[in] dt The integration time
+  \param[in] ekin The kinetic energy of the trajectory
+
+  Propagates the Nose-Hoover chain of the trajectory traj for the time dt at the fixed kinetic energy,
+  the same splitting as in Thermostat::propagate_nhc
+*/
+
+  double kt = kT();
+  int M = NHC_size - 1;
+  double* x = &s[traj*NHC_size];
+  double* v = &ksi[traj*NHC_size];
+  double arg, e, G;
+
+  // The force on the k-th thermostat of the chain
+  #define NHC_FORCE(k) ( ((k)==0) ? (2.0*ekin - Nf*kt)/Q[0] : (Q[(k)-1]*v[(k)-1]*v[(k)-1] - kt)/Q[(k)] )
+
+  G = NHC_FORCE(M);
+  v[M] += 0.5*dt*G;
+
+  for(int k=1;k<=M;k++){
+    G = NHC_FORCE(M-k);
+    arg = 0.25*dt*v[M-k+1];  e = exp(-arg);
+    v[M-k] = e*(e*v[M-k] + 0.5*dt*G*sinh_(arg));
+  }
+
+  for(int k=0;k<=M;k++){ x[k] += dt*v[k]; }
+
+  for(int k=0;k<=M-1;k++){
+    G = NHC_FORCE(k);
+    arg = 0.25*dt*v[k+1];  e = exp(-arg);
+    v[k] = e*(e*v[k] + 0.5*dt*G*sinh_(arg));
+  }
+
+  G = NHC_FORCE(M);
+  v[M] += 0.5*dt*G;
+
+  #undef NHC_FORCE
+}
+
+
+void Ensemble_Thermostat::propagate_nhc(double dt, MATRIX& p, MATRIX& invM){
+/**
+  \param[in] dt The integration time
+  \param[in] p [Ndof x Ntraj] The momenta of the ensemble (not changed)
+  \param[in] invM [Ndof x 1] The inverse masses
+
+  Propagates the Nose-Hoover chains of all the trajectories for the time dt
+*/
+
+  MATRIX ekin(kinetic_energies(p, invM));
+
+  #pragma omp parallel for
+  for(int traj=0;traj<ntraj;traj++){  nhc_chain(traj, dt, ekin.M[traj]);  }
+}
+
+
+void Ensemble_Thermostat::vel_scale(double dt, MATRIX& p){
+/**
+  \param[in] dt The integration time
+  \param[in,out] p [Ndof x Ntraj] The momenta of the ensemble
+
+  Scales the momenta of every trajectory by exp(-dt*ksi_0) of its Nose-Hoover chain
+*/
+
+  vector<double> scl(ntraj, 1.0);
+  for(int traj=0;traj<ntraj;traj++){  scl[traj] = exp(-dt*ksi[traj*NHC_size]);  }
+
+  for(int dof=0;dof<p.n_rows;dof++){
+    for(int traj=0;traj<ntraj;traj++){  p.M[dof*ntraj+traj] *= scl[traj];  }
+  }
+}
+
+
+void Ensemble_Thermostat::langevin(double dt, MATRIX& p, MATRIX& invM){
+/**
+  \param[in] dt The integration time
+  \param[in,out] p [Ndof x Ntraj] The momenta of the ensemble
+  \param[in] invM [Ndof x 1] The inverse masses (the DOFs with zero inverse masses are frozen)
+
+  The exact solution of the Ornstein-Uhlenbeck process (the "O" step of the BAOAB scheme):
+  p -> c1 * p + sqrt((1 - c1^2) * M * kT) * xi,  c1 = exp(-gamma * dt)
+*/
+
+  double c1 = exp(-gamma*dt);
+  double c2 = sqrt((1.0 - c1*c1) * kT());
+
+  #pragma omp parallel for
+  for(int traj=0;traj<ntraj;traj++){
+
+    CounterRandom rnd(seed, traj);
+    rnd.set_counter(counter[traj]);
+
+    double dE = 0.0;
+    for(int dof=0;dof<ndof;dof++){
+      double im = invM.M[dof];
+      if(im<=0.0){ continue; }
+
+      double& pi = p.M[dof*ntraj+traj];
+      double e0 = 0.5*im*pi*pi;
+      pi = c1*pi + c2*sqrt(1.0/im)*rnd.normal();
+      dE += e0 - 0.5*im*pi*pi;
+    }
+
+    heat[traj] += dE;
+    counter[traj] = rnd.get_counter();
+  }
+}
+
+
+void Ensemble_Thermostat::bussi(double dt, MATRIX& p, MATRIX& invM){
+/**
+  \param[in] dt The integration time
+  \param[in,out] p [Ndof x Ntraj] The momenta of the ensemble
+  \param[in] invM [Ndof x 1] The inverse masses
+
+  The stochastic velocity rescaling: the kinetic energy of each trajectory is propagated over dt
+  by the exact solution of its stochastic differential equation and the momenta are scaled accordingly.
+  G. Bussi, D. Donadio, M. Parrinello, J. Chem. Phys. 126, 014101 (2007)
+
+  The sum of the squares of Nf - 1 normal deviates is drawn as one chi-squared deviate, as in the
+  reference implementation: 2*Gamma((Nf-1)/2) for even Nf - 1, plus one squared normal for odd Nf - 1.
+*/
+
+  double c = (tau>0.0) ? exp(-dt/tau) : 0.0;
+  int nf = (int)(Nf + 0.5);
+  double K_target = 0.5*Nf*kT();
+  MATRIX ekin(kinetic_energies(p, invM));
+
+  #pragma omp parallel for
+  for(int traj=0;traj<ntraj;traj++){
+
+    double K = ekin.M[traj];
+    if(K<=0.0 || nf<1){ continue; }
+
+    CounterRandom rnd(seed, traj);
+    rnd.set_counter(counter[traj]);
+
+    double r1 = rnd.normal();
+    double sum = 0.0;
+    int nn = nf - 1;
+    if(nn>1){  sum += 2.0*rnd.gamma(0.5*(nn - nn%2));  }
+    if(nn%2==1){ double r = rnd.normal(); sum += r*r; }
+
+    double K_new = K + (1.0 - c)*(K_target*(sum + r1*r1)/Nf - K)
+                 + 2.0*r1*sqrt(K*K_target/Nf*(1.0 - c)*c);
+    double alpha = sqrt(K_new/K);
+    if(r1 + sqrt(c*Nf*K/((1.0 - c)*K_target)) < 0.0){ alpha = -alpha; }
+
+    for(int dof=0;dof<ndof;dof++){  p.M[dof*ntraj+traj] *= alpha;  }
+
+    heat[traj] += K - K_new;
+    counter[traj] = rnd.get_counter();
+  }
+}
+
+
+void Ensemble_Thermostat::andersen(double dt, MATRIX& p, MATRIX& invM){
+/**
+  \param[in] dt The integration time
+  \param[in,out] p [Ndof x Ntraj] The momenta of the ensemble
+  \param[in] invM [Ndof x 1] The inverse masses (the DOFs with zero inverse masses are frozen)
+
+  Each DOF of each trajectory collides with the bath with the probability 1 - exp(-nu_andersen * dt);
+  the momentum of the collided DOF is drawn from the Maxwell-Boltzmann distribution.
+*/
+
+  double prob = 1.0 - exp(-nu_andersen*dt);
+  double kt = kT();
+
+  #pragma omp parallel for
+  for(int traj=0;traj<ntraj;traj++){
+
+    CounterRandom rnd(seed, traj);
+    rnd.set_counter(counter[traj]);
+
+    double dE = 0.0;
+    for(int dof=0;dof<ndof;dof++){
+      double im = invM.M[dof];
+      double ksi_c = rnd.uniform();
+      double ksi_p = rnd.normal();     // always drawn, so the streams advance in the same way
+      if(im<=0.0 || ksi_c>=prob){ continue; }
+
+      double& pi = p.M[dof*ntraj+traj];
+      double e0 = 0.5*im*pi*pi;
+      pi = sqrt(kt/im)*ksi_p;
+      dE += e0 - 0.5*im*pi*pi;
+    }
+
+    heat[traj] += dE;
+    counter[traj] = rnd.get_counter();
+  }
+}
+
+
+void Ensemble_Thermostat::apply(double dt, MATRIX& p, MATRIX& invM){
+/**
+  \param[in] dt The integration time
+  \param[in,out] p [Ndof x Ntraj] The momenta of the ensemble
+  \param[in] invM [Ndof x 1] The inverse masses
+
+  The action of the thermostat of the selected type on the ensemble over the time dt. For the Nose-Hoover
+  chains it is: scaling for dt/2, propagation of the chains for dt, scaling for dt/2.
+*/
+
+  if(p.n_rows!=ndof || p.n_cols!=ntraj){
+    cout<<"Error in Ensemble_Thermostat::apply: the momenta must be "<<ndof<<" x "<<ntraj
+        <<" but are "<<p.n_rows<<" x "<<p.n_cols<<"\n";
+    exit(0);
+  }
+
+  if(thermostat_type=="Nose-Hoover"){
+    vel_scale(0.5*dt, p);
+    propagate_nhc(dt, p, invM);
+    vel_scale(0.5*dt, p);
+  }
+  else if(thermostat_type=="Langevin"){  langevin(dt, p, invM);  }
+  else if(thermostat_type=="Bussi"){     bussi(dt, p, invM);  }
+  else if(thermostat_type=="Andersen"){  andersen(dt, p, invM);  }
+
+}
+
+
+double Ensemble_Thermostat::energy(int traj){
+/**
+  \param[in] traj The index of the trajectory
+
+  Returns the energy of the bath of the trajectory traj, so that the sum of the energy of the trajectory and
+  of its bath is conserved: the NHC energy for the Nose-Hoover chains, the heat taken from the trajectory
+  for the stochastic thermostats.
+*/
+
+  if(thermostat_type!="Nose-Hoover"){ return heat[traj]; }
+
+  double kt = kT();
+  double res = 0.0;
+  for(int k=0;k<NHC_size;k++){
+    res += ((k==0) ? Nf*kt : kt) * s[traj*NHC_size+k];
+    res += 0.5*Q[k]*ksi[traj*NHC_size+k]*ksi[traj*NHC_size+k];
+  }
+  return res;
+}
+
+
+MATRIX Ensemble_Thermostat::energies(){
+/**
+  Returns the [Ntraj x 1] matrix of the bath energies of all the trajectories
+*/
+
+  MATRIX res(ntraj, 1);
+  for(int traj=0;traj<ntraj;traj++){  res.M[traj] = energy(traj);  }
+  return res;
+}
+
+
+
+}// namespace libthermostat
+}// namespace libdyn
+
+}// liblibra
@@ -0,0 +1,106 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Ensemble_Thermostat.h
+  \brief The file describes the thermostat acting on all the trajectories of an ensemble at once
+
+  The momenta of the ensemble are kept in the [Ndof x Ntraj] matrix, as in the ensemble integrators
+  (Verlet1, Verlet1_nvt), and each trajectory is coupled to its own bath. The bath variables of all the
+  trajectories are kept in the contiguous arrays, the random numbers of the stochastic thermostats come
+  from the counter-based streams (one per trajectory), so the results do not depend on the number of threads.
+*/
+
+#ifndef ENSEMBLE_THERMOSTAT_H
+#define ENSEMBLE_THERMOSTAT_H
+
+#include "../../math_linalg/liblinalg.h"
+#include "../../math_random/librandom.h"
+#include "../../math_specialfunctions/libspecialfunctions.h"
+#include "../../Units.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace librandom;
+using namespace libspecialfunctions;
+
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libthermostat namespace
+namespace libthermostat{
+
+
+class Ensemble_Thermostat{
+/**
+  \brief The thermostats of all the trajectories of an ensemble
+
+  thermostat_type:
+  "Nose-Hoover" - the Nose-Hoover chain (NHC_size, nu_therm), as in the Thermostat class
+  "Langevin"    - the Ornstein-Uhlenbeck step of the BAOAB scheme (gamma)
+  "Bussi"       - the stochastic velocity rescaling of Bussi, Donadio and Parrinello (tau)
+  "Andersen"    - the Andersen collisions of the individual DOFs (nu_andersen)
+*/
+
+  vector<uint64_t> counter;     ///< the states of the random number streams, one per trajectory
+
+  void nhc_chain(int traj, double dt, double ekin);
+
+public:
+
+  // Parameters
+  int ntraj;                    ///< the number of trajectories (fixed at construction)
+  int ndof;                     ///< the number of DOFs per trajectory (fixed at construction)
+  std::string thermostat_type;  ///< "Nose-Hoover", "Langevin", "Bussi" or "Andersen"
+  double Temperature;           ///< the target temperature, K
+  double Nf;                    ///< the number of DOFs of each trajectory coupled to the bath (default: ndof)
+  int NHC_size;                 ///< the length of the Nose-Hoover chains (fixed at construction)
+  double nu_therm;              ///< the frequency of the Nose-Hoover thermostat, a.u.
+  double gamma;                 ///< the friction of the Langevin thermostat, a.u.
+  double tau;                   ///< the relaxation time of the Bussi thermostat, a.u.
+  double nu_andersen;           ///< the collision frequency of the Andersen thermostat, a.u.
+  int seed;                     ///< the seed of the random number streams
+
+  // Bath variables
+  vector<double> Q;             ///< NHC_size: the masses of the chain thermostats (the same for all trajectories)
+  vector<double> s;             ///< ntraj*NHC_size: the chain positions, trajectory-major
+  vector<double> ksi;           ///< ntraj*NHC_size: the chain velocities, trajectory-major
+  vector<double> heat;          ///< ntraj: the energy taken from each trajectory by a stochastic thermostat
+
+
+  Ensemble_Thermostat(boost::python::dict params, int ntraj_, int ndof_);
+
+  void init();
+  double kT(){ return (boltzmann/hartree)*Temperature; }
+
+  MATRIX kinetic_energies(MATRIX& p, MATRIX& invM);
+
+  void propagate_nhc(double dt, MATRIX& p, MATRIX& invM);
+  void vel_scale(double dt, MATRIX& p);
+  void langevin(double dt, MATRIX& p, MATRIX& invM);
+  void bussi(double dt, MATRIX& p, MATRIX& invM);
+  void andersen(double dt, MATRIX& p, MATRIX& invM);
+  void apply(double dt, MATRIX& p, MATRIX& invM);
+
+  double energy(int traj);
+  MATRIX energies();
+
+};
+
+
+}// namespace libthermostat
+}// namespace libdyn
+}// liblibra
+
+
+#endif // ENSEMBLE_THERMOSTAT_H
@@ -116,6 +116,42 @@ void export_Thermostat_objects(){
   ;
 
 
+  class_<Ensemble_Thermostat>("Ensemble_Thermostat",init<boost::python::dict, int, int>())
+      .def(init<const Ensemble_Thermostat&>())
+      .def("__copy__", &generic__copy__<Ensemble_Thermostat>)
+      .def("__deepcopy__", &generic__deepcopy__<Ensemble_Thermostat>)
+
+      .def_readonly("ntraj", &Ensemble_Thermostat::ntraj)
+      .def_readonly("ndof", &Ensemble_Thermostat::ndof)
+      .def_readwrite("thermostat_type", &Ensemble_Thermostat::thermostat_type)
+      .def_readwrite("Temperature", &Ensemble_Thermostat::Temperature)
+      .def_readwrite("Nf", &Ensemble_Thermostat::Nf)
+      .def_readonly("NHC_size", &Ensemble_Thermostat::NHC_size)
+      .def_readwrite("nu_therm", &Ensemble_Thermostat::nu_therm)
+      .def_readwrite("gamma", &Ensemble_Thermostat::gamma)
+      .def_readwrite("tau", &Ensemble_Thermostat::tau)
+      .def_readwrite("nu_andersen", &Ensemble_Thermostat::nu_andersen)
+      .def_readwrite("seed", &Ensemble_Thermostat::seed)
+
+      .def_readwrite("Q", &Ensemble_Thermostat::Q)
+      .def_readwrite("s", &Ensemble_Thermostat::s)
+      .def_readwrite("ksi", &Ensemble_Thermostat::ksi)
+      .def_readwrite("heat", &Ensemble_Thermostat::heat)
+
+      .def("init", &Ensemble_Thermostat::init)
+      .def("kT", &Ensemble_Thermostat::kT)
+      .def("kinetic_energies", &Ensemble_Thermostat::kinetic_energies)
+      .def("propagate_nhc", &Ensemble_Thermostat::propagate_nhc)
+      .def("vel_scale", &Ensemble_Thermostat::vel_scale)
+      .def("langevin", &Ensemble_Thermostat::langevin)
+      .def("bussi", &Ensemble_Thermostat::bussi)
+      .def("andersen", &Ensemble_Thermostat::andersen)
+      .def("apply", &Ensemble_Thermostat::apply)
+      .def("energy", &Ensemble_Thermostat::energy)
+      .def("energies", &Ensemble_Thermostat::energies)
+  ;
+
+
 }// export_Thermostat_objects
 
 
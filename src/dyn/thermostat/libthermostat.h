@@ -19,6 +19,7 @@
 
 
 #include "Thermostat.h"
+#include "Ensemble_Thermostat.h"
 
 /// liblibra namespace
 namespace liblibra{
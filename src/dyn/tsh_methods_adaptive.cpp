@@ -0,0 +1,644 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file tsh_methods_adaptive.cpp
+  \brief The file implements the TSH for an ensemble of trajectories with the adaptive time stepping
+
+*/
+
+#include "Adaptive_Stepping.h"
+#include "Energy_and_Forces.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+
+TSH_Adaptive_Control::TSH_Adaptive_Control(int ntraj){
+/**
+  \param[in] ntraj The number of trajectories
+
+  The default parameters
+*/
+
+  max_level = 4;
+  nac_tol = 0.1;
+  gap_tol = 0.2;
+  gap_floor = 0.001;
+  norm_tol = 1e-6;
+  el_tol = 1e-6;
+  max_el_substeps = 64;
+  merge_ratio = 0.25;
+  merge_delay = 5;
+  do_log = 1;
+  rev_stride = 1;
+
+  init(ntraj);
+}
+
+
+TSH_Adaptive_Control::TSH_Adaptive_Control(boost::python::dict params, int ntraj) : TSH_Adaptive_Control(ntraj){
+/**
+  \param[in] params The Python dictionary with the parameters (the names are those of the class members),
+  the missing ones take the default values
+  \param[in] ntraj The number of trajectories
+*/
+
+  set_parameters(params);
+}
+
+
+void TSH_Adaptive_Control::set_parameters(boost::python::dict params){
+
+  std::string key;
+  for(int i=0;i<len(params.values());i++){
+    key = extract<std::string>(params.keys()[i]);
+
+    if(key=="max_level") { max_level = extract<int>(params.values()[i]); }
+    else if(key=="nac_tol") { nac_tol = extract<double>(params.values()[i]); }
+    else if(key=="gap_tol") { gap_tol = extract<double>(params.values()[i]); }
+    else if(key=="gap_floor") { gap_floor = extract<double>(params.values()[i]); }
+    else if(key=="norm_tol") { norm_tol = extract<double>(params.values()[i]); }
+    else if(key=="el_tol") { el_tol = extract<double>(params.values()[i]); }
+    else if(key=="max_el_substeps") { max_el_substeps = extract<int>(params.values()[i]); }
+    else if(key=="merge_ratio") { merge_ratio = extract<double>(params.values()[i]); }
+    else if(key=="merge_delay") { merge_delay = extract<int>(params.values()[i]); }
+    else if(key=="do_log") { do_log = extract<int>(params.values()[i]); }
+    else if(key=="rev_stride") { rev_stride = extract<int>(params.values()[i]); }
+  }
+
+  if(max_level<0 || max_level>20){
+    cout<<"Error in TSH_Adaptive_Control::set_parameters: max_level = "<<max_level<<" must be in the range [0, 20]\n";
+    exit(0);
+  }
+  if(max_el_substeps<1){ max_el_substeps = 1; }
+  if(rev_stride<0){ rev_stride = 0; }
+}
+
+
+void TSH_Adaptive_Control::init(int ntraj){
+/**
+  \brief Reset the state, the diagnostics and the log for ntraj trajectories
+*/
+
+  level = vector<int>(ntraj, 0);
+  nel = vector<int>(ntraj, 1);
+  calm = vector<int>(ntraj, 0);
+  time = vector<double>(ntraj, 0.0);
+
+  nsplit = vector<int>(ntraj, 0);
+  nmerge = vector<int>(ntraj, 0);
+  nsubsteps = vector<int>(ntraj, 0);
+  max_dE = vector<double>(ntraj, 0.0);
+  max_rev = vector<double>(ntraj, 0.0);
+  nevals = 0;
+
+  log = vector< vector<double> >(ntraj);
+}
+
+
+void TSH_Adaptive_Control::clear_log(){
+
+  for(int traj=0;traj<log.size();traj++){  log[traj].clear();  }
+}
+
+
+void TSH_Adaptive_Control::add_record(int traj, double dt, double eta_nac, double eta_gap, double eta_norm, double el_err, double dE,
+                                      double rev_dq, double rev_dp, double rev_dC){
+
+  if(!do_log){ return; }
+
+  double rec[11] = { time[traj], dt, double(nel[traj]), eta_nac, eta_gap, eta_norm, el_err, dE, rev_dq, rev_dp, rev_dC };
+  log[traj].insert(log[traj].end(), rec, rec+11);
+}
+
+
+MATRIX TSH_Adaptive_Control::get_log(int traj){
+/**
+  \param[in] traj The index of the trajectory
+
+  Returns the [nrecords x 11] matrix with the log of the trajectory: t, dt, nel, eta_nac, eta_gap, eta_norm, el_err, dE,
+  rev_dq, rev_dp, rev_dC
+*/
+
+  if(traj<0 || traj>=log.size()){
+    cout<<"Error in TSH_Adaptive_Control::get_log: traj = "<<traj<<" is out of range [0, "<<log.size()<<")\n";
+    exit(0);
+  }
+
+  int nrec = log[traj].size() / 11;
+  MATRIX res(nrec, 11);
+  for(int i=0;i<11*nrec;i++){  res.M[i] = log[traj][i];  }
+
+  return res;
+}
+
+
+
+static void propagate_electronic_interpolated(double dt, int nsteps, CMATRIX& C, CMATRIX& H0, CMATRIX& H1, CMATRIX* S, int rep){
+/**
+  \param[in] dt The propagation time
+  \param[in] nsteps The number of the substeps
+  \param[in,out] C [nst x 1] the electronic amplitudes
+  \param[in] H0, H1 The vibronic Hamiltonians at the beginning and at the end of the interval
+  \param[in] S The diabatic overlap (for rep = 0)
+  \param[in] rep 0 - diabatic, 1 - adiabatic representation
+
+  The Hamiltonian of the substep k is the linear interpolation between H0 and H1 taken at the middle of the substep
+*/
+
+  int nst = C.n_rows;
+  CMATRIX H(nst, nst);
+  double h = dt / nsteps;
+
+  for(int k=0;k<nsteps;k++){
+    double s = (k + 0.5) / nsteps;
+    H = (1.0 - s) * H0 + s * H1;
+
+    if(rep==0){  propagate_electronic(h, C, H, *S);  }
+    else{  propagate_electronic(h, C, H);  }
+  }
+}
+
+
+static double sorted_gap_change(MATRIX& E0, MATRIX& E1, double gap_floor){
+/**
+  \param[in] E0, E1 [nst x 1] the adiabatic energies at the beginning and at the end of the step
+  \param[in] gap_floor The smallest gap used as the reference
+
+  Returns the largest relative change of the gaps between the consecutive energy levels. The levels are sorted,
+  so the result does not depend on the ordering of the states.
+*/
+
+  int nst = E0.n_rows;
+  vector<double> e0(E0.M, E0.M+nst);
+  vector<double> e1(E1.M, E1.M+nst);
+  std::sort(e0.begin(), e0.end());
+  std::sort(e1.begin(), e1.end());
+
+  double res = 0.0;
+  for(int i=0;i<nst-1;i++){
+    double g0 = e0[i+1] - e0[i];
+    double g1 = e1[i+1] - e1[i];
+    double ref = std::max(std::max(g0, g1), gap_floor);
+    res = std::max(res, fabs(g1 - g0)/ref);
+  }
+  return res;
+}
+
+
+static void tsh1_substep(vector<double>& dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& act_states,
+                  nHamiltonian& ham, bp::object py_funct, bp::object params, boost::python::dict params1, Random& rnd,
+                  TSH_Adaptive_Control& ctrl, int do_reordering, int do_phase_correction,
+                  vector<double>& eta_nac, vector<double>& eta_gap, vector<double>& eta_norm,
+                  vector<double>& el_err, vector<double>& dE, vector<int>& do_rev,
+                  vector<double>& rev_dq, vector<double>& rev_dp, vector<double>& rev_dC){
+/**
+  \brief One step of the TSH (as in tsh1) with the individual time steps of the trajectories
+
+  \param[in] dt ntraj time steps of the trajectories; the trajectories with dt = 0 are not changed
+  \param[out] eta_nac, eta_gap, eta_norm The error indicators of the trajectories (in the units of the thresholds)
+  \param[out] el_err The errors of the electronic propagation
+  \param[out] dE The changes of the total energies (0 - if there was a hop)
+  \param[in] do_rev The flags of the trajectories whose step is checked for the time reversibility
+  \param[out] rev_dq, rev_dp, rev_dC max |q_back - q|, max |p_back - p| and |C_back - C| of the step integrated
+  back with -dt from its end (-1 - if not checked)
+
+  The other parameters are as in tsh1. The electronic DOFs are propagated after the nuclear ones, with the
+  vibronic Hamiltonian interpolated between the beginning and the end of the step. The backward step reuses
+  the forces and the Hamiltonians of the two ends (no extra Hamiltonian evaluations); it is done before the
+  hops, which are not reversible.
+*/
+
+  int rep = 1;                ///< The representation to run the Ehrenfest : 0 - diabatic, 1 - adiabatic
+  int rep_sh = 1;             ///< The representation to run the SH : 0 - diabatic, 1 - adiabatic
+  int tsh_method = 0;         ///< Formula for computing SH probabilities: 0 - FSSH, 1 - GFSH, 2 - MSSH
+  int use_boltz_factor = 0;   ///< Whether to scale the SH probabilities by the Boltzmann factor: 0 - do not scale, 1 - scale
+  double Temperature = 300.0; ///< Temperature of the system
+  int do_reverse = 1;         ///< 0 - do not revert momenta at the frustrated hops, 1 - do revert the momenta
+  int vel_rescale_opt = 0;    ///< How to rescale momenta if the hops are successful (see tsh1)
+
+  std::string key;
+  for(int i=0;i<len(params1.values());i++){
+    key = extract<std::string>(params1.keys()[i]);
+
+    if(key=="rep") { rep = extract<int>(params1.values()[i]); }
+    else if(key=="rep_sh") { rep_sh = extract<int>(params1.values()[i]);  }
+    else if(key=="tsh_method") { tsh_method = extract<int>(params1.values()[i]);  }
+    else if(key=="use_boltz_factor") { use_boltz_factor = extract<int>(params1.values()[i]);  }
+    else if(key=="Temperature") { Temperature = extract<double>(params1.values()[i]);  }
+    else if(key=="do_reverse") { do_reverse = extract<int>(params1.values()[i]);  }
+    else if(key=="vel_rescale_opt") { vel_rescale_opt = extract<int>(params1.values()[i]);  }
+  }
+
+
+  int ndof = q.n_rows;
+  int ntraj = q.n_cols;
+  int nst = C.n_rows;
+  int traj, dof, i;
+
+  vector<int> perm_t;
+  CMATRIX states(nst, ntraj);
+  vector<int> el_stenc_x(nst, 0); for(i=0;i<nst;i++){  el_stenc_x[i] = i; }
+  vector<int> el_stenc_y(1, 0);
+  vector<int> full_id(2,0);
+
+  vector<CMATRIX> H0(ntraj, CMATRIX(nst, nst));
+  vector<MATRIX> Eadi0(ntraj, MATRIX(nst, 1));
+  vector<double> nrm0(ntraj, 0.0);
+  vector<double> Etot0(ntraj, 0.0);
+  CMATRIX F(ndof, ntraj);
+  CMATRIX F0(ndof, ntraj);
+  MATRIX q0(q);
+  MATRIX p0(p);
+  CMATRIX x(nst, 1);
+  CMATRIX Hadi(nst, nst);
+  CMATRIX S0(nst, nst);
+
+
+  // The total energy of a trajectory: kinetic + the energy of the active state
+  // (the active states are the adiabatic ones in either representation)
+  auto total_energy = [&](int traj){
+    double ekin = 0.0;
+    for(dof=0; dof<ndof; dof++){  ekin += 0.5 * invM.get(dof,0) * p.get(dof,traj) * p.get(dof,traj);  }
+
+    CMATRIX Ham(nst, nst);
+    Ham = ham.children[traj]->get_ham_adi();
+
+    double epot = 0.0;
+    for(int a=0;a<nst;a++){
+      for(int b=0;b<nst;b++){
+        epot += (std::conj(states.get(a,traj)) * Ham.get(a,b) * states.get(b,traj)).real();
+      }
+    }
+    return ekin + epot;
+  };
+
+
+  //============== The state at the beginning of the step ===================
+  if(rep==0){
+    ham.compute_nac_dia(p, invM, 0, 1);
+    ham.compute_hvib_dia(1);
+  }
+  else if(rep==1){
+    ham.compute_nac_adi(p, invM, 0, 1);
+    ham.compute_hvib_adi(1);
+  }
+
+  tsh_indx2vec(ham, states, act_states);
+
+  for(traj=0; traj<ntraj; traj++){
+    if(rep==0){  H0[traj] = ham.children[traj]->get_hvib_dia(); }
+    else{  H0[traj] = ham.children[traj]->get_hvib_adi(); }
+
+    Hadi = ham.children[traj]->get_ham_adi();
+    for(i=0;i<nst;i++){ Eadi0[traj].M[i] = Hadi.get(i,i).real(); }
+
+    // The norm is C^+ S C in the diabatic representation
+    x = C.col(traj);
+    if(rep==0){  S0 = ham.children[traj]->get_ovlp_dia();  nrm0[traj] = (x.H() * S0 * x).get(0,0).real(); }
+    else{  nrm0[traj] = (x.H() * x).get(0,0).real(); }
+    Etot0[traj] = total_energy(traj);
+  }
+
+
+  //============== Nuclear propagation ===================
+  if(rep==0){  F = ham.Ehrenfest_forces_dia(states, 1);  }
+  else if(rep==1){  F = ham.Ehrenfest_forces_adi(states, 1);  }
+  F0 = F;
+
+  for(traj=0; traj<ntraj; traj++){
+    for(dof=0; dof<ndof; dof++){
+      p.add(dof, traj, F.get(dof,traj).real() * 0.5*dt[traj]);
+      q.add(dof, traj, invM.get(dof,0) * p.get(dof,traj) * dt[traj]);
+    }
+  }
+
+  vector<CMATRIX> Uprev;
+  if(rep==1 && (do_reordering || do_phase_correction)){
+    for(traj=0; traj<ntraj; traj++){  Uprev.push_back( ham.children[traj]->get_basis_transform() );  }
+  }
+
+  ham.compute_diabatic(py_funct, bp::object(q), params, 1);
+  ham.compute_adiabatic(1, 1);
+  ctrl.nevals++;
+
+
+  // The amplitudes and the Hamiltonians at the beginning of the step are transformed
+  // in the same way as the basis
+  if(rep==1){
+
+    for(traj=0; traj<ntraj; traj++){
+      el_stenc_y[0] = traj;
+      x = C.col(traj);
+
+      if(do_reordering){
+        CMATRIX X(nst, nst);
+        X = Uprev[traj].H() * ham.children[traj]->get_basis_transform();
+        perm_t = get_reordering(X);
+
+        ham.children[traj]->update_ordering(perm_t, 1);
+        x.permute_rows(perm_t);
+        H0[traj].permute_rows(perm_t);
+        H0[traj].permute_cols(perm_t);
+      }
+
+      if(do_phase_correction){
+        CMATRIX phases(nst, 1);
+        phases = ham.children[traj]->update_phases(Uprev[traj], 1);
+        phase_correct_ampl(x, phases);
+
+        for(int a=0;a<nst;a++){
+          for(int b=0;b<nst;b++){
+            H0[traj].scale(a, b, phases.get(a,0) * std::conj(phases.get(b,0)));
+          }
+        }
+      }
+
+      push_submatrix(C, x, el_stenc_x, el_stenc_y);
+    }// for traj
+
+  }// rep == 1
+
+
+  tsh_indx2vec(ham, states, act_states);
+  if(rep==0){  F = ham.Ehrenfest_forces_dia(states, 1);  }
+  else if(rep==1){  F = ham.Ehrenfest_forces_adi(states, 1);  }
+
+  for(traj=0; traj<ntraj; traj++){
+    for(dof=0; dof<ndof; dof++){  p.add(dof, traj, F.get(dof,traj).real() * 0.5*dt[traj]);  }
+  }
+
+
+  //============== Reversibility of the nuclear step ===================
+  for(traj=0; traj<ntraj; traj++){
+    rev_dq[traj] = rev_dp[traj] = rev_dC[traj] = -1.0;
+    if(dt[traj]==0.0 || !do_rev[traj]){ continue; }
+
+    rev_dq[traj] = rev_dp[traj] = 0.0;
+    for(dof=0; dof<ndof; dof++){
+      double ph = p.get(dof,traj) - F.get(dof,traj).real() * 0.5*dt[traj];
+      double qb = q.get(dof,traj) - invM.get(dof,0) * ph * dt[traj];
+      double pb = ph - F0.get(dof,traj).real() * 0.5*dt[traj];
+
+      rev_dq[traj] = std::max(rev_dq[traj], fabs(qb - q0.get(dof,traj)));
+      rev_dp[traj] = std::max(rev_dp[traj], fabs(pb - p0.get(dof,traj)));
+    }
+  }
+
+
+  //============== Electronic propagation ===================
+  if(rep==0){
+    ham.compute_nac_dia(p, invM, 0, 1);
+    ham.compute_hvib_dia(1);
+  }
+  else if(rep==1){
+    ham.compute_nac_adi(p, invM, 0, 1);
+    ham.compute_hvib_adi(1);
+  }
+
+  for(traj=0; traj<ntraj; traj++){
+
+    eta_nac[traj] = eta_gap[traj] = eta_norm[traj] = el_err[traj] = dE[traj] = 0.0;
+    if(dt[traj]==0.0){ continue; }
+
+    CMATRIX H1(nst, nst);
+    CMATRIX S(nst, nst);
+    if(rep==0){  H1 = ham.children[traj]->get_hvib_dia();  S = ham.children[traj]->get_ovlp_dia(); }
+    else{  H1 = ham.children[traj]->get_hvib_adi(); }
+
+    // Step doubling: nel and 2*nel electronic substeps
+    int n = ctrl.nel[traj];
+    CMATRIX c1(nst, 1);  c1 = C.col(traj);
+    CMATRIX c2(nst, 1);  c2 = c1;
+
+    propagate_electronic_interpolated(dt[traj], n, c1, H0[traj], H1, &S, rep);
+    propagate_electronic_interpolated(dt[traj], 2*n, c2, H0[traj], H1, &S, rep);
+
+    x = c2 - c1;
+    el_err[traj] = sqrt( (x.H() * x).get(0,0).real() );
+
+    if(el_err[traj] > ctrl.el_tol){ ctrl.nel[traj] = std::min(2*n, ctrl.max_el_substeps); }
+    else if(el_err[traj] < 0.125*ctrl.el_tol && n>1){ ctrl.nel[traj] = n/2; }
+
+    // Back from the end of the step, with the Hamiltonian interpolated from H1 to H0
+    if(do_rev[traj]){
+      CMATRIX cb(nst, 1);  cb = c2;
+      propagate_electronic_interpolated(-dt[traj], 2*n, cb, H1, H0[traj], &S, rep);
+      x = cb - C.col(traj);
+      rev_dC[traj] = sqrt( (x.H() * x).get(0,0).real() );
+    }
+
+    el_stenc_y[0] = traj;
+    push_submatrix(C, c2, el_stenc_x, el_stenc_y);
+
+    // Error indicators
+    double hmax = 0.0;
+    for(int a=0;a<nst;a++){
+      for(int b=0;b<nst;b++){  if(a!=b){ hmax = std::max(hmax, abs(H1.get(a,b)));  } }
+    }
+    eta_nac[traj] = hmax * dt[traj] / ctrl.nac_tol;
+
+    MATRIX Eadi1(nst, 1);
+    Hadi = ham.children[traj]->get_ham_adi();
+    for(i=0;i<nst;i++){ Eadi1.M[i] = Hadi.get(i,i).real(); }
+    eta_gap[traj] = sorted_gap_change(Eadi0[traj], Eadi1, ctrl.gap_floor) / ctrl.gap_tol;
+
+    double nrm1 = (rep==0) ? (c2.H() * S * c2).get(0,0).real() : (c2.H() * c2).get(0,0).real();
+    eta_norm[traj] = fabs( nrm1 - nrm0[traj] ) / ctrl.norm_tol;
+
+  }// for traj
+
+
+  //============== Begin the TSH part ===================
+
+  CMATRIX Coeff(nst,ntraj);
+  CMATRIX coeff(nst, 1);
+  MATRIX g(nst,nst);
+
+  if(rep==0){
+    if(rep_sh==0){  Coeff = C; }
+    else if(rep_sh==1){ ham.ampl_dia2adi(C, Coeff, 0, 1);  }
+  }
+  else if(rep==1){
+    if(rep_sh==0){  ham.ampl_adi2dia(Coeff, C, full_id); }
+    else if(rep_sh==1){ Coeff = C;  }
+  }
+
+  vector<int> istates(ntraj,0);
+  vector<int> fstates(ntraj,0);
+  tsh_physical2internal(ham, istates, act_states);
+
+  for(traj=0; traj<ntraj; traj++){
+
+    fstates[traj] = istates[traj];
+    if(dt[traj]==0.0){ continue; }   // frozen trajectories do not hop
+
+    el_stenc_y[0] = traj;
+    pop_submatrix(Coeff, coeff, el_stenc_x, el_stenc_y);
+
+    if(tsh_method == 0){ // FSSH
+      g = compute_hopping_probabilities_fssh(coeff, ham.children[traj], rep_sh, dt[traj], use_boltz_factor, Temperature);
+    }
+    else if(tsh_method == 1){ // GFSH
+      g = compute_hopping_probabilities_gfsh(coeff, ham.children[traj], rep_sh, dt[traj], use_boltz_factor, Temperature);
+    }
+    else if(tsh_method == 2){ // MSSH
+      g = compute_hopping_probabilities_mssh(coeff);
+    }
+    else{
+      cout<<"Error in tsh1_adaptive: tsh_method can be 0, 1, or 2. Other values are not defined\n";
+      cout<<"Exiting...\n";
+      exit(0);
+    }
+
+    double ksi = rnd.uniform(0.0,1.0);
+    fstates[traj] = hop(istates[traj], g, ksi);
+  }// for traj
+
+  vector<int> new_states = apply_transition1(p, invM, ham, istates, fstates, vel_rescale_opt, do_reverse, 1);
+  tsh_internal2physical(ham, new_states, act_states);
+
+
+  //============== Energy diagnostics ===================
+  tsh_indx2vec(ham, states, act_states);
+
+  for(traj=0; traj<ntraj; traj++){
+    if(dt[traj]==0.0 || new_states[traj]!=istates[traj]){ continue; }
+    dE[traj] = total_energy(traj) - Etot0[traj];
+  }
+
+}
+
+
+
+void tsh1_adaptive(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& act_states,
+                   nHamiltonian& ham, bp::object py_funct, bp::object params, boost::python::dict params1, Random& rnd,
+                   TSH_Adaptive_Control& ctrl, int do_reordering, int do_phase_correction){
+/**
+  \brief One coarse step of the TSH for an ensemble of trajectories with the adaptive time stepping
+
+  \param[in] dt The coarse integration time step
+  \param[in,out] q [Ndof x Ntraj] nuclear coordinates. Change during the integration.
+  \param[in,out] p [Ndof x Ntraj] nuclear momenta. Change during the integration.
+  \param[in] invM [Ndof  x 1] inverse nuclear DOF masses.
+  \param[in,out] C [nadi x ntraj]  or [ndia x ntraj] matrix containing the electronic coordinates
+  \param[in,out] act_states - vector of ntraj indices of the physical states in which each of the trajectories is
+  \param[in] ham Is the Hamiltonian object that works as a functor (takes care of all calculations of given type)
+  \param[in] py_funct Python function object that is called to update the diabatic Hamiltonians of all the trajectories
+  \param[in] params The Python object containing any necessary parameters passed to the "py_funct" function when it is executed.
+  \param[in] params1 The Python dictionary containing the control parameters, as in tsh1
+  \param[in] rnd The Random number generator object
+  \param[in,out] ctrl The state of the adaptive stepping: the levels, the electronic substeps, the log
+
+  All the trajectories are advanced by dt. The trajectory at the level k makes 2^k substeps; the substeps of the
+  trajectories at different levels are done in the same sweeps of the ensemble, the finished trajectories are
+  frozen (the step 0), so the Hamiltonian is evaluated 2^kmax times per coarse step. A substep is never repeated
+  (the orderings and the phases of the adiabatic states could not be restored), so the refinement is triggered
+  by the indicators of the substep already done and applies to the rest of the coarse step.
+  Every ctrl.rev_stride-th substep of a trajectory is integrated back from its end, the deviations from its
+  beginning are logged and their maximum is kept in ctrl.max_rev.
+*/
+
+  int ntraj = q.n_cols;
+  int traj;
+
+  if(ctrl.level.size()!=ntraj){  ctrl.init(ntraj);  }
+
+  // Times in the units of the finest substep
+  long long nunits = 1LL << ctrl.max_level;
+  vector<long long> remaining(ntraj, nunits);
+  vector<double> eta_max(ntraj, 0.0);
+
+  vector<double> dts(ntraj, 0.0);
+  vector<long long> step_units(ntraj, 0);
+  vector<double> eta_nac(ntraj, 0.0), eta_gap(ntraj, 0.0), eta_norm(ntraj, 0.0), el_err(ntraj, 0.0), dE(ntraj, 0.0);
+  vector<int> do_rev(ntraj, 0);
+  vector<double> rev_dq(ntraj, -1.0), rev_dp(ntraj, -1.0), rev_dC(ntraj, -1.0);
+
+  for(traj=0; traj<ntraj; traj++){  ctrl.level[traj] = std::min(ctrl.level[traj], ctrl.max_level);  }
+
+  int left = ntraj;
+  while(left>0){
+
+    for(traj=0; traj<ntraj; traj++){
+      if(remaining[traj]>0){
+        step_units[traj] = 1LL << (ctrl.max_level - ctrl.level[traj]);
+        dts[traj] = dt * double(step_units[traj]) / double(nunits);
+      }
+      else{  step_units[traj] = 0; dts[traj] = 0.0;  }
+
+      do_rev[traj] = (ctrl.rev_stride>0 && ctrl.nsubsteps[traj] % ctrl.rev_stride == 0);
+    }
+
+    tsh1_substep(dts, q, p, invM, C, act_states, ham, py_funct, params, params1, rnd, ctrl,
+                 do_reordering, do_phase_correction, eta_nac, eta_gap, eta_norm, el_err, dE,
+                 do_rev, rev_dq, rev_dp, rev_dC);
+
+    left = 0;
+    for(traj=0; traj<ntraj; traj++){
+      if(step_units[traj]==0){ continue; }
+
+      ctrl.time[traj] += dts[traj];
+      ctrl.nsubsteps[traj]++;
+      ctrl.max_dE[traj] = std::max(ctrl.max_dE[traj], fabs(dE[traj]));
+      ctrl.max_rev[traj] = std::max(ctrl.max_rev[traj], std::max(rev_dq[traj], std::max(rev_dp[traj], rev_dC[traj])));
+      ctrl.add_record(traj, dts[traj], eta_nac[traj], eta_gap[traj], eta_norm[traj], el_err[traj], dE[traj],
+                      rev_dq[traj], rev_dp[traj], rev_dC[traj]);
+
+      remaining[traj] -= step_units[traj];
+
+      double eta = std::max(eta_nac[traj], std::max(eta_gap[traj], eta_norm[traj]));
+      eta_max[traj] = std::max(eta_max[traj], eta);
+
+      // Split: the rest of the coarse step is done with the finer steps
+      if(eta > 1.0 && ctrl.level[traj] < ctrl.max_level){
+        ctrl.level[traj]++;
+        ctrl.nsplit[traj]++;
+      }
+
+      if(remaining[traj]>0){ left++; }
+    }
+  }// while
+
+
+  // Merge: back to the coarser steps, when the indicators stayed small for long enough
+  for(traj=0; traj<ntraj; traj++){
+    if(eta_max[traj] < ctrl.merge_ratio){  ctrl.calm[traj]++;  }
+    else{  ctrl.calm[traj] = 0;  }
+
+    if(ctrl.calm[traj] >= ctrl.merge_delay && ctrl.level[traj] > 0){
+      ctrl.level[traj]--;
+      ctrl.nmerge[traj]++;
+      ctrl.calm[traj] = 0;
+    }
+  }
+
+}
+
+
+void tsh1_adaptive(double dt, MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<int>& act_states,
+                   nHamiltonian& ham, bp::object py_funct, bp::object params, boost::python::dict params1, Random& rnd,
+                   TSH_Adaptive_Control& ctrl){
+
+  const int do_reordering = 1;
+  const int do_phase_correction = 1;
+
+  tsh1_adaptive(dt, q, p, invM, C, act_states, ham, py_funct, params, params1, rnd, ctrl, do_reordering, do_phase_correction);
+
+}
+
+
+}// namespace libdyn
+}// liblibra
@@ -54,6 +54,9 @@ class Wfcgrid{
 
   void print_complex_matrix_1D(CMATRIX& CM, std::string filename);
 
+  void local_bounds(int npts, double& emin, double& emax);
+  int propagate_chebyshev(double dt, double m0, double tol, int dim);
+
 public:
 
   // 2-D Grid
@@ -140,6 +143,18 @@ public:
   boost::python::list absorb_1D(double dL);
 
 
+  //--------------- in Wfcgrid_Dynamics2 ------------------
+
+  void spectral_bounds_1D(double m0, double& emin, double& emax);
+  void spectral_bounds_2D(double m0, double& emin, double& emax);
+
+  void apply_H_1D(vector<CMATRIX>& psi, vector<CMATRIX>& hpsi, double m0);
+  void apply_H_2D(vector<CMATRIX>& psi, vector<CMATRIX>& hpsi, double m0);
+
+  int propagate_chebyshev_1D(double dt, double m0, double tol);
+  int propagate_chebyshev_2D(double dt, double m0, double tol);
+
+
 }; //  class Wfcgrid
 
 
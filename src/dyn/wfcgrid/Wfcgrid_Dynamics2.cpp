@@ -0,0 +1,377 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Wfcgrid_Dynamics2.cpp
+  \brief The file implements the Chebyshev (Tal-Ezer - Kosloff) global propagator for the numerical
+  solution of TD-SE on the grid
+
+  exp(-i*H*dt) is expanded in the Chebyshev polynomials of the normalized Hamiltonian
+  Hn = (H - E_mid)/dE, with the spectrum of Hn in [-1, 1]:
+
+  exp(-i*H*dt) = exp(-i*E_mid*dt) * sum_k { (2 - delta_k0) * (-i)^k * J_k(dE*dt) * T_k(Hn) }
+
+  The Bessel functions J_k decay exponentially for k > dE*dt, so the series converges to the machine
+  precision with ~ dE*dt + O((dE*dt)^1/3) terms, and no splitting error is introduced: the whole
+  multistate grid Hamiltonian (the kinetic energy via FFT and the full local state matrices) is used.
+*/
+
+#include "Wfcgrid.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libwfcgrid namespace
+namespace libwfcgrid{
+
+
+
+vector< complex<double> > chebyshev_coefficients(double alpha, double tol){
+/**
+  \brief The coefficients of the Chebyshev expansion of exp(-i*alpha*x), x in [-1, 1]
+  \param[in] alpha The product of the spectral half-width and the time step
+  \param[in] tol The coefficients are truncated when |J_k(alpha)| < tol for k > alpha
+
+  a_k = (2 - delta_k0) * (-i)^k * J_k(alpha). The Bessel functions are computed by the Miller's
+  backward recurrence normalized with J_0 + 2 * sum_k J_2k = 1
+*/
+
+  vector< complex<double> > res;
+
+  if(alpha<=0.0){  res.push_back(complex<double>(1.0, 0.0)); return res;  }
+
+  int kmax = int(alpha + 12.0*std::cbrt(alpha) + 30.0);
+  int nstart = kmax + 30;  if(nstart%2){ nstart++; }
+
+  vector<double> J(nstart+2, 0.0);
+  J[nstart+1] = 0.0;
+  J[nstart] = 1e-30;
+
+  double sum = 0.0;
+  for(int k=nstart;k>=1;k--){
+    J[k-1] = (2.0*k/alpha)*J[k] - J[k+1];
+
+    // Rescale to avoid the overflow
+    if(fabs(J[k-1])>1e250){
+      for(int j=k-1;j<=nstart;j++){ J[j] *= 1e-250; }
+      sum *= 1e-250;
+    }
+    if((k-1)%2==0 && k-1>0){ sum += 2.0*J[k-1]; }
+  }
+  sum += J[0];
+
+  for(int k=0;k<=kmax;k++){  J[k] /= sum;  }
+
+
+  complex<double> mi(0.0, -1.0), ph(1.0, 0.0);
+
+  for(int k=0;k<=kmax;k++){
+
+    if(k>alpha && fabs(J[k])<tol){ break; }
+
+    res.push_back( ((k==0) ? 1.0 : 2.0) * ph * J[k] );
+    ph *= mi;
+
+  }
+
+  return res;
+
+}
+
+
+
+void Wfcgrid::spectral_bounds_1D(double m0, double& emin, double& emax){
+/**
+  \brief The estimate of the spectral range of the grid Hamiltonian for 1D grid
+  \param[in] m0 Mass of the particle (effective DOF)
+  \param[out] emin, emax The lower and upper bounds of the spectrum
+
+  The local part is bound by the Gershgorin circles of the state matrices at every grid point, the
+  kinetic part - by 0 and the kinetic energy of the largest grid momentum. The range is extended by 5%
+  on each side for safety.
+*/
+
+  local_bounds(Nx, emin, emax);
+
+  double tmax = 0.0;
+  for(int nx=0;nx<Nx;nx++){
+    double kx_ = Kx->M[nx].real();
+    tmax = std::max(tmax, (2.0*M_PI*M_PI/m0)*kx_*kx_);
+  }
+  emax += tmax;
+
+  double de = 0.05*(emax - emin) + 1e-10;
+  emin -= de;  emax += de;
+
+}
+
+
+void Wfcgrid::spectral_bounds_2D(double m0, double& emin, double& emax){
+/**
+  \brief The estimate of the spectral range of the grid Hamiltonian for 2D grid
+  \param[in] m0 Mass of the particle (effective DOF)
+  \param[out] emin, emax The lower and upper bounds of the spectrum
+
+  Same as for the 1D grid, with the kinetic energy of the largest grid momentum in both directions
+*/
+
+  local_bounds(Nx*Ny, emin, emax);
+
+  double tmax_x = 0.0, tmax_y = 0.0;
+  for(int nx=0;nx<Nx;nx++){
+    double kx_ = Kx->M[nx].real();
+    tmax_x = std::max(tmax_x, (2.0*M_PI*M_PI/m0)*kx_*kx_);
+  }
+  for(int ny=0;ny<Ny;ny++){
+    double ky_ = Ky->M[ny].real();
+    tmax_y = std::max(tmax_y, (2.0*M_PI*M_PI/m0)*ky_*ky_);
+  }
+  emax += tmax_x + tmax_y;
+
+  double de = 0.05*(emax - emin) + 1e-10;
+  emin -= de;  emax += de;
+
+}
+
+
+void Wfcgrid::local_bounds(int npts, double& emin, double& emax){
+/**
+  The Gershgorin bounds of the local (potential energy) part of the Hamiltonian over the first npts grid points
+*/
+
+  emin = 1e+300;  emax = -1e+300;
+
+  for(int n=0;n<npts;n++){
+    for(int nst=0;nst<nstates;nst++){
+
+      double r = 0.0;
+      for(int nst1=0;nst1<nstates;nst1++){
+        if(nst1!=nst){  r += std::abs(H[nst][nst1].M[n]);  }
+      }
+
+      double d = H[nst][nst].M[n].real();
+      emin = std::min(emin, d - r);
+      emax = std::max(emax, d + r);
+
+    }// for nst
+  }// for n
+
+}
+
+
+
+void Wfcgrid::apply_H_1D(vector<CMATRIX>& psi, vector<CMATRIX>& hpsi, double m0){
+/**
+  \brief Computes the action of the grid Hamiltonian on the 1D wavefunction: hpsi = H * psi
+  \param[in] psi The wavefunction - nstates x Nx x 1
+  \param[out] hpsi The result - nstates x Nx x 1, must be allocated
+  \param[in] m0 Mass of the particle (effective DOF)
+
+  working in atomic units: hbar = 1
+*/
+
+  int nst, nst1, nx;
+
+  // Kinetic part, in the reciprocal space
+  vector<CMATRIX> reci(psi);
+
+  ft_1D(psi, reci, 1, xmin, kxmin, dx);
+
+  for(nx=0;nx<Nx;nx++){
+    double kx_ = Kx->M[nx].real();
+    double t = (2.0*M_PI*M_PI/m0)*kx_*kx_;
+    for(nst=0;nst<nstates;nst++){  reci[nst].M[nx] *= t;  }
+  }
+
+  ft_1D(reci, hpsi, 2, xmin, kxmin, dx);
+
+
+  // Local part
+  for(nx=0;nx<Nx;nx++){
+    for(nst=0;nst<nstates;nst++){
+
+      complex<double> res(0.0, 0.0);
+      for(nst1=0;nst1<nstates;nst1++){
+        res += H[nst][nst1].M[nx] * psi[nst1].M[nx];
+      }
+
+      hpsi[nst].M[nx] += res;
+
+    }// for nst
+  }// for nx
+
+}// apply_H_1D
+
+
+void Wfcgrid::apply_H_2D(vector<CMATRIX>& psi, vector<CMATRIX>& hpsi, double m0){
+/**
+  \brief Computes the action of the grid Hamiltonian on the 2D wavefunction: hpsi = H * psi
+  \param[in] psi The wavefunction - nstates x Nx x Ny
+  \param[out] hpsi The result - nstates x Nx x Ny, must be allocated
+  \param[in] m0 Mass of the particle (effective DOF)
+
+  working in atomic units: hbar = 1
+*/
+
+  int nst, nst1, nx, ny;
+
+  // Kinetic part, in the reciprocal space
+  vector<CMATRIX> reci(psi);
+
+  ft_2D(psi, reci, 1, xmin, ymin, kxmin, kymin, dx, dy);
+
+  for(nx=0;nx<Nx;nx++){
+    for(ny=0;ny<Ny;ny++){
+      double kx_ = Kx->M[nx].real();
+      double ky_ = Ky->M[ny].real();
+      double t = (2.0*M_PI*M_PI/m0)*(kx_*kx_ + ky_*ky_);
+      for(nst=0;nst<nstates;nst++){  reci[nst].M[nx*Ny+ny] *= t;  }
+    }
+  }
+
+  ft_2D(reci, hpsi, 2, xmin, ymin, kxmin, kymin, dx, dy);
+
+
+  // Local part
+  for(nx=0;nx<Nx;nx++){
+    for(ny=0;ny<Ny;ny++){
+      for(nst=0;nst<nstates;nst++){
+
+        complex<double> res(0.0, 0.0);
+        for(nst1=0;nst1<nstates;nst1++){
+          res += H[nst][nst1].M[nx*Ny+ny] * psi[nst1].M[nx*Ny+ny];
+        }
+
+        hpsi[nst].M[nx*Ny+ny] += res;
+
+      }// for nst
+    }// for ny
+  }// for nx
+
+}// apply_H_2D
+
+
+
+int Wfcgrid::propagate_chebyshev(double dt, double m0, double tol, int dim){
+/**
+  The Chebyshev propagation of PSI for one time step dt, with dim = 1 or 2 selecting the 1D or 2D grid.
+  Returns the number of the Hamiltonian applications.
+*/
+
+  int nst, n;
+  int npts = Nx*Ny;
+
+  double emin, emax;
+  if(dim==1){  spectral_bounds_1D(m0, emin, emax);  }
+  else{  spectral_bounds_2D(m0, emin, emax);  }
+
+  double e_mid = 0.5*(emax + emin);
+  double e_half = 0.5*(emax - emin);
+
+  vector< complex<double> > a = chebyshev_coefficients(e_half*dt, tol);
+  int nterms = a.size();
+
+
+  // Normalized Hamiltonian: Hn * psi = (H * psi - e_mid * psi) / e_half
+  vector<CMATRIX> phi0(PSI);   // T_{k-1}(Hn) * PSI
+  vector<CMATRIX> phi1(PSI);   // T_k(Hn) * PSI
+  vector<CMATRIX> phi2(PSI);   // T_{k+1}(Hn) * PSI
+  vector<CMATRIX> res(PSI);
+
+  for(nst=0;nst<nstates;nst++){
+    for(n=0;n<npts;n++){  res[nst].M[n] = a[0] * PSI[nst].M[n];  }
+  }
+
+  for(int k=1;k<nterms;k++){
+
+    if(dim==1){ apply_H_1D(phi1, phi2, m0); }
+    else{ apply_H_2D(phi1, phi2, m0); }
+
+    double f = (k==1) ? 1.0 : 2.0;   // T_1 = Hn;  T_{k+1} = 2 * Hn * T_k - T_{k-1}
+
+    for(nst=0;nst<nstates;nst++){
+      for(n=0;n<npts;n++){
+
+        complex<double> val = f * (phi2[nst].M[n] - e_mid * phi1[nst].M[n]) / e_half;
+        if(k>1){ val -= phi0[nst].M[n]; }
+
+        phi2[nst].M[n] = val;
+        res[nst].M[n] += a[k] * val;
+
+      }// for n
+    }// for nst
+
+    phi0.swap(phi1);
+    phi1.swap(phi2);
+
+  }// for k
+
+
+  // Overall phase
+  complex<double> ph(std::cos(-e_mid*dt), std::sin(-e_mid*dt));
+
+  for(nst=0;nst<nstates;nst++){
+    for(n=0;n<npts;n++){  PSI[nst].M[n] = ph * res[nst].M[n];  }
+  }
+
+
+  // Update reciprocal part
+  if(dim==1){  ft_1D(PSI, reciPSI, 1, xmin, kxmin, dx);  }
+  else{  ft_2D(PSI, reciPSI, 1, xmin, ymin, kxmin, kymin, dx, dy);  }
+
+  return nterms - 1;
+
+}
+
+
+int Wfcgrid::propagate_chebyshev_1D(double dt, double m0, double tol){
+/**
+  \brief Chebyshev propagator for 1D grid wavefunction: PSI <- exp(-i*H*dt) * PSI
+  \param[in] dt Integration time. Unlike in the split-operator propagator, there is no splitting error,
+             so the time step is only limited by the time scale of the quantities to be recorded
+  \param[in] m0 Mass of the particle (effective DOF)
+  \param[in] tol The truncation threshold of the Chebyshev expansion (e.g. 1e-14 for the machine precision)
+
+  The Hamiltonian H must be updated (update_potential_1D) before calling this function. The propagators
+  expH and expK are not used.
+  Returns the number of the Hamiltonian applications (2 FFTs each).
+*/
+
+  return propagate_chebyshev(dt, m0, tol, 1);
+
+}
+
+int Wfcgrid::propagate_chebyshev_2D(double dt, double m0, double tol){
+/**
+  \brief Chebyshev propagator for 2D grid wavefunction: PSI <- exp(-i*H*dt) * PSI
+  \param[in] dt Integration time
+  \param[in] m0 Mass of the particle (effective DOF)
+  \param[in] tol The truncation threshold of the Chebyshev expansion
+
+  The Hamiltonian H must be updated (update_potential_2D) before calling this function.
+  Returns the number of the Hamiltonian applications.
+*/
+
+  return propagate_chebyshev(dt, m0, tol, 2);
+
+}
+
+
+
+
+}// namespace libwfcgrid
+}// namespace libdyn
+}// liblibra
+
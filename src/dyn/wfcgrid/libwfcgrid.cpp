@@ -81,6 +81,9 @@ void export_Wfcgrid_objects(){
       .def("propagate_exact_1D", &Wfcgrid::propagate_exact_1D)
       .def("propagate_exact_2D", &Wfcgrid::propagate_exact_2D)
 
+      .def("propagate_chebyshev_1D", &Wfcgrid::propagate_chebyshev_1D)
+      .def("propagate_chebyshev_2D", &Wfcgrid::propagate_chebyshev_2D)
+
       .def("absorb_1D",expt_absorb_1D)
 
       .def("e_kin_1D", &Wfcgrid::e_kin_1D)
@@ -148,6 +148,8 @@ void ForceField::init_variables(){
   is_elec_scale13       = 0;
   is_elec_scale14       = 0;
 
+  is_record_indices     = 0;
+
 }
 
 void ForceField::copy_content(const ForceField& ff){
@@ -196,6 +198,9 @@ void ForceField::copy_content(const ForceField& ff){
   Dihedral_Records = ff.Dihedral_Records;
   Improper_Records = ff.Improper_Records;
   Fragment_Records = ff.Fragment_Records;
+
+  clear_record_indices();
+  if(ff.is_record_indices){ build_record_indices(); }
 }
 
 ForceField::ForceField(){
@@ -383,6 +388,8 @@ void ForceField::load(boost::property_tree::ptree& pt,std::string path,int& stat
   libforcefield::load(pt,path+".Improper_Records",Improper_Records,st); if(st==1) { status=1;}
   libforcefield::load(pt,path+".Fragment_Records",Fragment_Records,st); if(st==1) { status=1;}
 
+  build_record_indices();
+
 }
 
 
@@ -394,6 +401,9 @@ int ForceField::Atom_Record_Index(int Atom_ff_int_type){
    data about atom of force field type "Atom_ff_int_type" are stored
    Returns -1 if such index has not been found
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_atom_record(Atom_ff_int_type); }
+
 
    int indx = -1;
    int sz   = Atom_Records.size();
@@ -416,6 +426,9 @@ int ForceField::Atom_Record_Index(std::string Atom_ff_type){
    data about atom of force field type "Atom_ff_type" are stored
    Returns -1 if such index has not been found
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_atom_record(Atom_ff_type); }
+
 
    int indx = -1;
    int sz   = Atom_Records.size();
@@ -557,6 +570,8 @@ int ForceField::Add_Atom_Record(Atom_Record rec){
        res = 0;
    }
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 
 }
@@ -623,6 +638,9 @@ int ForceField::Bond_Record_Index(int Atom1_ff_int_type, int Atom2_ff_int_type){
    "Atom1_ff_int_type" and "Atom2_ff_int_type" are stored
    Returns -1 if such index has not been found
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_bond_record(Atom1_ff_int_type,Atom2_ff_int_type); }
+
 
    int indx = -1;
    int sz   = Bond_Records.size();
@@ -821,9 +839,13 @@ int ForceField::Bond_Record_Index(std::string Atom1_ff_type, std::string Atom2_f
    The bond record will be chosen on the basis of additional comparison
    the Bond_type_index properties if they are available
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_bond_record(Atom1_ff_type,Atom2_ff_type); }
+
   int indx = -1;
   int sz   = Bond_Records.size();
   int cmpr11,cmpr12,cmpr21,cmpr22,cmpr;
+  cmpr = 1; // the bond type index is not compared in this search
 
   for(int i=0;i<sz;i++){
     cmpr11 = cmpr12 = cmpr21 = cmpr22 = 0;
@@ -997,6 +1019,8 @@ int ForceField::Add_Bond_Record(Bond_Record rec){
    }
 */
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 }
 
@@ -1008,6 +1032,9 @@ int ForceField::Angle_Record_Index(int Atom1_ff_int_type, int Atom2_ff_int_type,
    "Atom1_ff_int_type", "Atom2_ff_int_type" and "Atom3_ff_int_type" are stored
    Returns -1 if such index has not been found
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_angle_record(Atom1_ff_int_type,Atom2_ff_int_type,Atom3_ff_int_type); }
+
 
    int indx = -1;
    int sz   = Angle_Records.size();
@@ -1167,8 +1194,10 @@ int ForceField::Angle_Record_Index(std::string Atom1_ff_type, std::string Atom2_
    The angle record will be chosen on the basis of additional comparison
    the Angle_type_index properties if they are available
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_angle_record(Atom1_ff_type,Atom2_ff_type,Atom3_ff_type); }
+
   int indx = -1;
-  cout<<"In ForceField::Angle_Record_Index\n";
 
   int sz   = Angle_Records.size();
   int cmpr11,cmpr13,cmpr31,cmpr33,cmpr,cmpr2;
@@ -1177,7 +1206,6 @@ int ForceField::Angle_Record_Index(std::string Atom1_ff_type, std::string Atom2_
     if(Angle_Records[i].is_Atom2_ff_type){
       cmpr2 = (Angle_Records[i].Atom2_ff_type == Atom2_ff_type);
     }
-    cout<<"i = "<<i<<" cmpr2 = "<<cmpr2<<endl;
     if(cmpr2){
       cmpr11 = cmpr13 = cmpr31 = cmpr33 = 0;
       if(Angle_Records[i].is_Atom1_ff_type && Angle_Records[i].is_Atom3_ff_type){
@@ -1187,7 +1215,6 @@ int ForceField::Angle_Record_Index(std::string Atom1_ff_type, std::string Atom2_
         cmpr31 = (Angle_Records[i].Atom3_ff_type == Atom1_ff_type);
       }// if both Atom1_ff_int_type and Atom3_ff_int_type are defined
 
-      cout<<"cmpr11 = "<<cmpr11<<" cmpr33 = "<<cmpr33<<" cmpr13 = "<<cmpr13<<" cmpr31 = "<<cmpr31<<endl;
 
       // --------- Conclusions -------
 //      if((cmpr11&&cmpr33&&cmpr)||(cmpr13&&cmpr31&&cmpr)){ indx = i;  }
@@ -1256,6 +1283,8 @@ int ForceField::Add_Angle_Record(Angle_Record rec,int order){
    }
 
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 }
 
@@ -1322,6 +1351,8 @@ int ForceField::Add_Angle_Record(Angle_Record rec){
       Angle_Records.push_back(rec);
    }
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 }
 
@@ -1334,6 +1365,9 @@ int ForceField::Dihedral_Record_Index(int Atom1_ff_int_type, int Atom2_ff_int_ty
    "Atom4_ff_int_type" are stored
     Returns -1 if such index has not been found
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_dihedral_record(Atom1_ff_int_type,Atom2_ff_int_type,Atom3_ff_int_type,Atom4_ff_int_type); }
+
 
    int indx = -1;
    int sz   = Dihedral_Records.size();
@@ -1545,6 +1579,9 @@ int ForceField::Dihedral_Record_Index(std::string Atom1_ff_type, std::string Ato
    order - is a parameter defining importance of indices order
    if order = 1 => ijkl is not the same as lkji
 *****************************************************************/
+   // Use the hash indices, if they are up to date
+   if(is_valid_record_indices()){ return indexed_dihedral_record(Atom1_ff_type,Atom2_ff_type,Atom3_ff_type,Atom4_ff_type); }
+
   vector<int> tmp;
   return Dihedral_Record_Index(Atom1_ff_type,Atom2_ff_type,Atom3_ff_type,Atom4_ff_type,-1,0,tmp);
 }
@@ -1578,7 +1615,7 @@ int ForceField::Dihedral_Record_Index(std::string Atom1_ff_type, std::string Ato
     }
 
     //----------------------------------------------------
-    cmpr22 = cmpr33 = 0;
+    cmpr11 = cmpr22 = cmpr33 = cmpr44 = cmpr14 = cmpr41 = cmpr23 = cmpr32 = 0;
        if(Dihedral_Records[i].is_Atom1_ff_type &&
           Dihedral_Records[i].is_Atom2_ff_type &&
           Dihedral_Records[i].is_Atom3_ff_type &&
@@ -1675,6 +1712,8 @@ int ForceField::Add_Dihedral_Record(Dihedral_Record rec,int order){
    }
 
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 }
 
@@ -1754,6 +1793,8 @@ int ForceField::Add_Dihedral_Record(Dihedral_Record rec){
       Dihedral_Records.push_back(rec);
    }
 
+   is_record_indices = 0; // the records have changed - the indices are outdated
+
    return res;
 }
 
@@ -20,6 +20,8 @@
 #include "Dihedral_Record.h"
 #include "Fragment_Record.h"
 
+#include <boost/unordered_map.hpp>
+
 
 #include "../math_linalg/liblinalg.h"
 #include "../io/libio.h"
@@ -53,6 +55,30 @@ class ForceField{
   void copy_content(const ForceField&); // Copies the content which is defined
   void extract_dictionary(boost::python::dict);
 
+  //--------- Hashed indices of the records: ForceField_methods11.cpp -------------
+  int is_record_indices;                                        // 1 if the indices have been built
+  vector<int> record_indices_sizes;                             // sizes of Atom, Bond, Angle and Dihedral records at that time
+  boost::unordered_map<std::string,int> sym_type_ids;           // symbolic atom type -> dense integer id
+  boost::unordered_map<int,int> int_type_ids;                   // integer atom type -> dense integer id
+  boost::unordered_map<unsigned long long,int> atom_int_index,     atom_sym_index;  // canonical key -> record index
+  boost::unordered_map<unsigned long long,int> bond_int_index,     bond_sym_index;
+  boost::unordered_map<unsigned long long,int> angle_int_index,    angle_sym_index;
+  boost::unordered_map<unsigned long long,int> dihedral_int_index, dihedral_sym_index;
+
+  int sym_type_id(const std::string&);
+  int int_type_id(int);
+  void clear_record_indices();
+  int is_valid_record_indices();
+  void update_record_indices();
+  int indexed_atom_record(int);
+  int indexed_atom_record(const std::string&);
+  int indexed_bond_record(int,int);
+  int indexed_bond_record(const std::string&,const std::string&);
+  int indexed_angle_record(int,int,int);
+  int indexed_angle_record(const std::string&,const std::string&,const std::string&);
+  int indexed_dihedral_record(int,int,int,int);
+  int indexed_dihedral_record(const std::string&,const std::string&,const std::string&,const std::string&);
+
 public:
 
    std::string ForceField_Name;       int is_ForceField_Name;
@@ -248,6 +274,12 @@ public:
    int set_ff_epsilon_and_sigma(int, vector<string> ,double**, double**);
    // ForceField_method10.cpp
    int get_cg_parameters(map<string,double>& prms);
+   // ForceField_methods11.cpp
+   void build_record_indices();
+   int assign_all_parameters(std::string int_type,
+                             vector< vector<std::string> >& types, vector< vector<double> >& bond_orders,
+                             vector<int>& coordination, vector<std::string>& excl_pairs,
+                             vector<int>& prms_indx, vector< map<string,double> >& prms);
 
 };
 
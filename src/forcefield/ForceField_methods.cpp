@@ -156,6 +156,7 @@ int ForceField::get_bond_parameters(string ff_type1, string ff_type2, /*Inputs*/
   1 - if the parameters were successfully obtained
   0 - otherwise
 ******************************************************************/
+  update_record_indices();
   double K,D,r0,alpha;
   int is_K,is_D,is_r0,is_alpha;
   is_K = is_D = is_r0 = is_alpha = 0;
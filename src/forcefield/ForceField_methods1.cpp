@@ -128,6 +128,7 @@ int ForceField::get_vdw_parameters(string ff_type1, string ff_type2,string excl_
   1 - if the parameters were successfully obtained
   0 - otherwise
 ******************************************************************/
+  update_record_indices();
   double sigma,epsilon,D,r0,alpha,K;
   int is_sigma,is_epsilon,is_D,is_r0,is_alpha,is_K;
   is_sigma = is_epsilon = is_D = is_r0 = is_alpha = is_K = 0;
@@ -213,6 +214,7 @@ int ForceField::get_vdw_parameters(int sz,vector<string> types,double** epsilon,
 cout<<"In get_vdw_parameters:\n";
 
   int res = 1;
+  update_record_indices();
   for(int i=0;i<sz;i++){
     //-------------- Start with looking the whole record ---------------------
     // Find index of Atom_Record corresponding to the force field type types[i]
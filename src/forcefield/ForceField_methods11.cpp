@@ -0,0 +1,393 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+
+#include "ForceField.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+//using namespace liblinalg;
+//using namespace libio;
+
+namespace libforcefield{
+
+
+/****************************************************************
+  Hashed indices of the force field records.
+
+  Every distinct atom type (symbolic or integer) is mapped to a dense
+  integer id and the ids of the atoms forming a bond, an angle or a
+  dihedral are packed (16 bits per atom) into a single 64-bit key.
+  The keys are canonicalised the same way the linear searches compare
+  the records:  bonds are insensitive to the order of atoms (i-j = j-i),
+  angles to the order of the side atoms (i-j-k = k-j-i) and dihedrals
+  to the reversal of the whole sequence (i-j-k-l = l-k-j-i).
+*****************************************************************/
+
+static unsigned long long pack_key(int a,int b,int c,int d){
+  return  ((unsigned long long)a << 48) | ((unsigned long long)b << 32)
+        | ((unsigned long long)c << 16) |  (unsigned long long)d;
+}
+
+static unsigned long long atom_key(int a){  return pack_key(0,0,0,a); }
+
+static unsigned long long bond_key(int a,int b){
+  if(a>b){ return pack_key(0,0,b,a); }
+  return pack_key(0,0,a,b);
+}
+
+static unsigned long long angle_key(int a,int b,int c){
+  if(a>c){ return pack_key(0,c,b,a); }
+  return pack_key(0,a,b,c);
+}
+
+static unsigned long long dihedral_key(int a,int b,int c,int d){
+  // Choose lexicographically smallest of the direct and reversed sequences
+  if( (d<a) || (d==a && c<b) ){ return pack_key(d,c,b,a); }
+  return pack_key(a,b,c,d);
+}
+
+
+int ForceField::sym_type_id(const std::string& t){
+/****************************************************************
+  Returns the dense id of the symbolic atom type t, or -1 if t does
+  not appear in any of the indexed records
+*****************************************************************/
+  boost::unordered_map<std::string,int>::const_iterator it = sym_type_ids.find(t);
+  if(it==sym_type_ids.end()){ return -1; }
+  return it->second;
+}
+
+int ForceField::int_type_id(int t){
+/****************************************************************
+  Returns the dense id of the integer atom type t, or -1 if t does
+  not appear in any of the indexed records
+*****************************************************************/
+  boost::unordered_map<int,int>::const_iterator it = int_type_ids.find(t);
+  if(it==int_type_ids.end()){ return -1; }
+  return it->second;
+}
+
+static int add_type_id(boost::unordered_map<std::string,int>& ids,const std::string& t){
+  boost::unordered_map<std::string,int>::iterator it = ids.find(t);
+  if(it!=ids.end()){ return it->second; }
+  int id = ids.size();  ids[t] = id;
+  return id;
+}
+
+static int add_type_id(boost::unordered_map<int,int>& ids,int t){
+  boost::unordered_map<int,int>::iterator it = ids.find(t);
+  if(it!=ids.end()){ return it->second; }
+  int id = ids.size();  ids[t] = id;
+  return id;
+}
+
+static int find_record(boost::unordered_map<unsigned long long,int>& indx,unsigned long long key){
+  boost::unordered_map<unsigned long long,int>::const_iterator it = indx.find(key);
+  if(it==indx.end()){ return -1; }
+  return it->second;
+}
+
+// The integer searches return the first matching record, the symbolic searches
+// (except for atoms) return the last one - the indices reproduce that behavior
+static void first_record(boost::unordered_map<unsigned long long,int>& indx,unsigned long long key,int i){
+  if(indx.find(key)==indx.end()){ indx[key] = i; }
+}
+
+static void last_record(boost::unordered_map<unsigned long long,int>& indx,unsigned long long key,int i){
+  indx[key] = i;
+}
+
+
+void ForceField::clear_record_indices(){
+/****************************************************************
+  Marks the indices as outdated. The *_Record_Index functions fall
+  back to the linear searches until build_record_indices() is called
+*****************************************************************/
+
+  is_record_indices = 0;
+  sym_type_ids.clear();  int_type_ids.clear();
+  atom_int_index.clear();      atom_sym_index.clear();
+  bond_int_index.clear();      bond_sym_index.clear();
+  angle_int_index.clear();     angle_sym_index.clear();
+  dihedral_int_index.clear();  dihedral_sym_index.clear();
+}
+
+
+void ForceField::build_record_indices(){
+/****************************************************************
+  Builds the hash indices for the Atom, Bond, Angle and Dihedral records.
+  This is done automatically after loading the force field and before
+  the parameters are assigned; call it explicitly if the record arrays
+  were modified in place (not via Add_*_Record functions)
+*****************************************************************/
+
+  clear_record_indices();
+
+  int i;
+  int n_atoms = Atom_Records.size();
+  int n_bonds = Bond_Records.size();
+  int n_angles = Angle_Records.size();
+  int n_dihedrals = Dihedral_Records.size();
+
+  // Dense ids of all atom types met in the records
+  for(i=0;i<n_atoms;i++){
+    const Atom_Record& r = Atom_Records[i];
+    if(r.is_Atom_ff_type){ add_type_id(sym_type_ids,r.Atom_ff_type); }
+    if(r.is_Atom_ff_int_type){ add_type_id(int_type_ids,r.Atom_ff_int_type); }
+  }
+  for(i=0;i<n_bonds;i++){
+    const Bond_Record& r = Bond_Records[i];
+    if(r.is_Atom1_ff_type){ add_type_id(sym_type_ids,r.Atom1_ff_type); }
+    if(r.is_Atom2_ff_type){ add_type_id(sym_type_ids,r.Atom2_ff_type); }
+    if(r.is_Atom1_ff_int_type){ add_type_id(int_type_ids,r.Atom1_ff_int_type); }
+    if(r.is_Atom2_ff_int_type){ add_type_id(int_type_ids,r.Atom2_ff_int_type); }
+  }
+  for(i=0;i<n_angles;i++){
+    const Angle_Record& r = Angle_Records[i];
+    if(r.is_Atom1_ff_type){ add_type_id(sym_type_ids,r.Atom1_ff_type); }
+    if(r.is_Atom2_ff_type){ add_type_id(sym_type_ids,r.Atom2_ff_type); }
+    if(r.is_Atom3_ff_type){ add_type_id(sym_type_ids,r.Atom3_ff_type); }
+    if(r.is_Atom1_ff_int_type){ add_type_id(int_type_ids,r.Atom1_ff_int_type); }
+    if(r.is_Atom2_ff_int_type){ add_type_id(int_type_ids,r.Atom2_ff_int_type); }
+    if(r.is_Atom3_ff_int_type){ add_type_id(int_type_ids,r.Atom3_ff_int_type); }
+  }
+  for(i=0;i<n_dihedrals;i++){
+    const Dihedral_Record& r = Dihedral_Records[i];
+    if(r.is_Atom1_ff_type){ add_type_id(sym_type_ids,r.Atom1_ff_type); }
+    if(r.is_Atom2_ff_type){ add_type_id(sym_type_ids,r.Atom2_ff_type); }
+    if(r.is_Atom3_ff_type){ add_type_id(sym_type_ids,r.Atom3_ff_type); }
+    if(r.is_Atom4_ff_type){ add_type_id(sym_type_ids,r.Atom4_ff_type); }
+    if(r.is_Atom1_ff_int_type){ add_type_id(int_type_ids,r.Atom1_ff_int_type); }
+    if(r.is_Atom2_ff_int_type){ add_type_id(int_type_ids,r.Atom2_ff_int_type); }
+    if(r.is_Atom3_ff_int_type){ add_type_id(int_type_ids,r.Atom3_ff_int_type); }
+    if(r.is_Atom4_ff_int_type){ add_type_id(int_type_ids,r.Atom4_ff_int_type); }
+  }
+
+  // 16 bits per atom in the packed keys
+  if(sym_type_ids.size()>=65536 || int_type_ids.size()>=65536){
+    cout<<"Warning: In ForceField::build_record_indices : too many atom types, the records will be searched linearly\n";
+    clear_record_indices();
+    return;
+  }
+
+  for(i=0;i<n_atoms;i++){
+    const Atom_Record& r = Atom_Records[i];
+    if(r.is_Atom_ff_int_type){ first_record(atom_int_index, atom_key(int_type_id(r.Atom_ff_int_type)), i); }
+    if(r.is_Atom_ff_type){ first_record(atom_sym_index, atom_key(sym_type_id(r.Atom_ff_type)), i); }
+  }
+
+  for(i=0;i<n_bonds;i++){
+    const Bond_Record& r = Bond_Records[i];
+    if(r.is_Atom1_ff_int_type && r.is_Atom2_ff_int_type){
+      first_record(bond_int_index, bond_key(int_type_id(r.Atom1_ff_int_type),int_type_id(r.Atom2_ff_int_type)), i);
+    }
+    if(r.is_Atom1_ff_type && r.is_Atom2_ff_type){
+      last_record(bond_sym_index, bond_key(sym_type_id(r.Atom1_ff_type),sym_type_id(r.Atom2_ff_type)), i);
+    }
+  }
+
+  for(i=0;i<n_angles;i++){
+    const Angle_Record& r = Angle_Records[i];
+    if(r.is_Atom1_ff_int_type && r.is_Atom2_ff_int_type && r.is_Atom3_ff_int_type){
+      first_record(angle_int_index, angle_key(int_type_id(r.Atom1_ff_int_type),int_type_id(r.Atom2_ff_int_type),
+                                              int_type_id(r.Atom3_ff_int_type)), i);
+    }
+    if(r.is_Atom1_ff_type && r.is_Atom2_ff_type && r.is_Atom3_ff_type){
+      last_record(angle_sym_index, angle_key(sym_type_id(r.Atom1_ff_type),sym_type_id(r.Atom2_ff_type),
+                                             sym_type_id(r.Atom3_ff_type)), i);
+    }
+  }
+
+  for(i=0;i<n_dihedrals;i++){
+    const Dihedral_Record& r = Dihedral_Records[i];
+    if(r.is_Atom1_ff_int_type && r.is_Atom2_ff_int_type && r.is_Atom3_ff_int_type && r.is_Atom4_ff_int_type){
+      first_record(dihedral_int_index, dihedral_key(int_type_id(r.Atom1_ff_int_type),int_type_id(r.Atom2_ff_int_type),
+                                                    int_type_id(r.Atom3_ff_int_type),int_type_id(r.Atom4_ff_int_type)), i);
+    }
+    if(r.is_Atom1_ff_type && r.is_Atom2_ff_type && r.is_Atom3_ff_type && r.is_Atom4_ff_type){
+      last_record(dihedral_sym_index, dihedral_key(sym_type_id(r.Atom1_ff_type),sym_type_id(r.Atom2_ff_type),
+                                                   sym_type_id(r.Atom3_ff_type),sym_type_id(r.Atom4_ff_type)), i);
+    }
+  }
+
+  record_indices_sizes.clear();
+  record_indices_sizes.push_back(n_atoms);
+  record_indices_sizes.push_back(n_bonds);
+  record_indices_sizes.push_back(n_angles);
+  record_indices_sizes.push_back(n_dihedrals);
+  is_record_indices = 1;
+
+}
+
+int ForceField::is_valid_record_indices(){
+/****************************************************************
+  Returns 1 if the indices are built and consistent with the sizes
+  of the record arrays, 0 otherwise
+*****************************************************************/
+  if(!is_record_indices){ return 0; }
+  if(record_indices_sizes[0]!=Atom_Records.size()){ return 0; }
+  if(record_indices_sizes[1]!=Bond_Records.size()){ return 0; }
+  if(record_indices_sizes[2]!=Angle_Records.size()){ return 0; }
+  if(record_indices_sizes[3]!=Dihedral_Records.size()){ return 0; }
+  return 1;
+}
+
+void ForceField::update_record_indices(){
+  if(!is_valid_record_indices()){ build_record_indices(); }
+}
+
+
+int ForceField::indexed_atom_record(int t){
+  int a = int_type_id(t);  if(a==-1){ return -1; }
+  return find_record(atom_int_index, atom_key(a));
+}
+
+int ForceField::indexed_atom_record(const std::string& t){
+  int a = sym_type_id(t);  if(a==-1){ return -1; }
+  return find_record(atom_sym_index, atom_key(a));
+}
+
+int ForceField::indexed_bond_record(int t1,int t2){
+  int a = int_type_id(t1);  if(a==-1){ return -1; }
+  int b = int_type_id(t2);  if(b==-1){ return -1; }
+  return find_record(bond_int_index, bond_key(a,b));
+}
+
+int ForceField::indexed_bond_record(const std::string& t1,const std::string& t2){
+  int a = sym_type_id(t1);  if(a==-1){ return -1; }
+  int b = sym_type_id(t2);  if(b==-1){ return -1; }
+  return find_record(bond_sym_index, bond_key(a,b));
+}
+
+int ForceField::indexed_angle_record(int t1,int t2,int t3){
+  int a = int_type_id(t1);  if(a==-1){ return -1; }
+  int b = int_type_id(t2);  if(b==-1){ return -1; }
+  int c = int_type_id(t3);  if(c==-1){ return -1; }
+  return find_record(angle_int_index, angle_key(a,b,c));
+}
+
+int ForceField::indexed_angle_record(const std::string& t1,const std::string& t2,const std::string& t3){
+  int a = sym_type_id(t1);  if(a==-1){ return -1; }
+  int b = sym_type_id(t2);  if(b==-1){ return -1; }
+  int c = sym_type_id(t3);  if(c==-1){ return -1; }
+  return find_record(angle_sym_index, angle_key(a,b,c));
+}
+
+int ForceField::indexed_dihedral_record(int t1,int t2,int t3,int t4){
+  int a = int_type_id(t1);  if(a==-1){ return -1; }
+  int b = int_type_id(t2);  if(b==-1){ return -1; }
+  int c = int_type_id(t3);  if(c==-1){ return -1; }
+  int d = int_type_id(t4);  if(d==-1){ return -1; }
+  return find_record(dihedral_int_index, dihedral_key(a,b,c,d));
+}
+
+int ForceField::indexed_dihedral_record(const std::string& t1,const std::string& t2,const std::string& t3,const std::string& t4){
+  int a = sym_type_id(t1);  if(a==-1){ return -1; }
+  int b = sym_type_id(t2);  if(b==-1){ return -1; }
+  int c = sym_type_id(t3);  if(c==-1){ return -1; }
+  int d = sym_type_id(t4);  if(d==-1){ return -1; }
+  return find_record(dihedral_sym_index, dihedral_key(a,b,c,d));
+}
+
+
+
+int ForceField::assign_all_parameters(std::string int_type,
+                                      vector< vector<std::string> >& types, vector< vector<double> >& bond_orders,
+                                      vector<int>& coordination, vector<std::string>& excl_pairs,
+                                      vector<int>& prms_indx, vector< map<string,double> >& prms){
+/******************************************************************
+  The bulk version of the get_bond(angle, dihedral, oop, vdw)_parameters functions.
+
+  Topological elements (bonds, angles, ...) formed by the same atom types with the same
+  bond orders (and coordination/exclusion type, where it matters) share their parameters,
+  so every distinct combination is resolved only once.
+
+  \param[in] int_type The interaction type: "bond", "angle", "dihedral", "oop" or "vdw"
+  \param[in] types The atom types of each element: types[b][0..n-1], n = 2,3,4
+  \param[in] bond_orders The bond orders of each element: bond_orders[b] = {bo12} for bonds,
+  {bo12,bo23} for angles, {bo12,bo23,bo34} for dihedrals; ignored for "oop" and "vdw"
+  \param[in] coordination The coordination of the central atom of the angles; ignored otherwise
+  \param[in] excl_pairs The exclusion type ("no","12","13","14") of each vdw pair; ignored otherwise
+  \param[out] prms_indx For each element - the index of its parameters in prms, or -1 if the
+  parameters are insufficient (no interaction should be created)
+  \param[out] prms The distinct parameter sets
+
+  Returns the number of the elements with sufficient parameters
+******************************************************************/
+
+  update_record_indices();
+
+  int n = types.size();
+  int b, i, res, nres = 0;
+
+  if(prms_indx.size()>0){ prms_indx.clear(); }
+  if(prms.size()>0){ prms.clear(); }
+
+  // Dense ids of the atom types met in the elements: all types, not only those known to
+  // the force field, since the rules can handle the types without records
+  boost::unordered_map<std::string,int> ids;
+
+  // Canonical key of the element -> index of its parameter set (or -1)
+  std::map< std::pair< vector<int>, vector<double> >, int > seen;
+
+  for(b=0;b<n;b++){
+
+    vector<string>& t = types[b];
+
+    // The key does not assume any symmetry: the rules (e.g. bond orders of angles) are
+    // direction-dependent, so only the exactly matching elements are merged
+    std::pair< vector<int>, vector<double> > key;
+    for(i=0;i<t.size();i++){ key.first.push_back(add_type_id(ids,t[i])); }
+
+    if(int_type=="bond" || int_type=="angle" || int_type=="dihedral"){ key.second = bond_orders[b]; }
+    if(int_type=="angle"){ key.first.push_back(coordination[b]); }
+    if(int_type=="vdw"){ key.first.push_back(add_type_id(ids,"excl:"+excl_pairs[b])); }
+
+    std::map< std::pair< vector<int>, vector<double> >, int >::iterator it = seen.find(key);
+    if(it!=seen.end()){ prms_indx.push_back(it->second);  if(it->second>-1){ nres++; }  continue; }
+
+    map<string,double> p;
+    res = 0;
+    if(int_type=="bond"){
+      res = get_bond_parameters(t[0],t[1],bond_orders[b][0],p);
+    }
+    else if(int_type=="angle"){
+      res = get_angle_parameters(t[0],t[1],t[2],bond_orders[b][0],bond_orders[b][1],coordination[b],p);
+    }
+    else if(int_type=="dihedral"){
+      res = get_dihedral_parameters(t[0],t[1],t[2],t[3],bond_orders[b][0],bond_orders[b][1],bond_orders[b][2],p);
+    }
+    else if(int_type=="oop"){
+      res = get_oop_parameters(t[0],t[1],t[2],t[3],p);
+    }
+    else if(int_type=="vdw"){
+      res = get_vdw_parameters(t[0],t[1],excl_pairs[b],p);
+    }
+    else{
+      cout<<"Error in ForceField::assign_all_parameters: int_type = "<<int_type<<" is not supported\n"; exit(0);
+    }
+
+    int indx = -1;
+    if(res){ indx = prms.size(); prms.push_back(p); nres++; }
+    seen[key] = indx;
+    prms_indx.push_back(indx);
+
+  }// for b
+
+  return nres;
+}
+
+
+
+}// namespace libforcefield
+}// namespace liblibra
+
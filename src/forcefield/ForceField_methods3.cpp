@@ -96,6 +96,7 @@ int ForceField::get_angle_parameters(string ff_type1, string ff_type2,string ff_
   1 - if the parameters were successfully obtained
   0 - otherwise
 ******************************************************************/
+  update_record_indices();
 
   cout<<"In ForceField::get_angle_parameters()...\n";
   cout<<"ff_type1 = "<<ff_type1<<"ff_type2 = "<<ff_type2<<"ff_type3 = "<<ff_type3<<endl;
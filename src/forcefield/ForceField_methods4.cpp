@@ -224,6 +224,7 @@ int ForceField::get_dihedral_parameters(string ff_type1, string ff_type2, /*Inpu
   1 - if the parameters were successfully obtained
   0 - otherwise 
 ******************************************************************/
+  update_record_indices();
   double Vphi,Vphi1,Vphi2,Vphi3,phi0;
   int n,opt;
   int is_Vphi,is_Vphi1,is_Vphi2,is_Vphi3,is_phi0,is_n,is_opt;
@@ -72,6 +72,7 @@ int ForceField::get_oop_parameters(string ff_type1, string ff_type2, /*Inputs*/
   1 - if the parameters were successfully obtained
   0 - otherwise 
 ******************************************************************/
+  update_record_indices();
 
   double Vphi,Vphi1,Vphi2,Vphi3,phi0,K,C0,C1,C2;
   int n,opt;
@@ -28,6 +28,7 @@ int ForceField::get_elec_parameters(string ff_type1, string ff_type2,std::string
   1 - if the parameters were successfully obtained
   0 - otherwise
 ******************************************************************/
+  update_record_indices();
   double qi,qj,delta,eps;
   int is_delta,is_eps;  is_delta = is_eps = 0;
   int is_qi, is_qj; is_qi = is_q1; is_qj = is_q2;
@@ -23,6 +23,7 @@ int ForceField::set_ff_charges(int sz, vector<string> types, VECTOR** r, double*
 
   vector<int> indxs; 
   int res = 1;
+  update_record_indices();
 
   for(int i=0;i<sz;i++){
     //-------------- Start with looking the whole record ---------------------
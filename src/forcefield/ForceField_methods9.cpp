@@ -23,6 +23,7 @@ namespace libforcefield{
 int ForceField::set_ff_epsilon_and_sigma(int sz, vector<string> types,double** epsilon, double** sigma){
 
   int res = 1;
+  update_record_indices();
   for(int i=0;i<sz;i++){
     //-------------- Start with looking the whole record ---------------------
     // Find index of Atom_Record corresponding to the force field type types[i]
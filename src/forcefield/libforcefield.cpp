@@ -232,6 +232,7 @@ void export_forcefield_objects(){
         .def("set",&ForceField::set)
         .def("show_info",&ForceField::show_info)
         .def("set_functionals",&ForceField::set_functionals)
+        .def("build_record_indices",&ForceField::build_record_indices)
 
     ;
 
@@ -191,6 +191,38 @@ void Hamiltonian_Atomistic::set_respa_types(std::string inter_type,std::string r
   mm_ham->set_respa_types(inter_type, respa_type);
 }
 
+void Hamiltonian_Atomistic::set_mm_backend(int backend){
+
+  mm_ham->set_backend(backend);
+}
+
+double Hamiltonian_Atomistic::energy_respa(std::string respa_type){
+/**
+  \param[in] respa_type The class of the MM interactions to compute: "fast", "medium" or "slow" (see set_respa_types)
+
+  Computes only the MM interactions of a given RESPA class. The forces are added to the atoms of the bound System
+  (the caller is responsible for zeroing them and for updating fragment forces and torques), the energy is returned.
+  The diabatic/adiabatic Hamiltonians are marked as outdated, since the atomic forces are no longer the total ones.
+*/
+
+  if(ham_types[0]!=1){
+    cout<<"Error in Hamiltonian_Atomistic::energy_respa: MM Hamiltonian is not set up\n"; exit(0);
+  }
+
+  int rt = -1;
+  if(respa_type=="fast"){ rt = 0; }
+  else if(respa_type=="medium"){ rt = 1; }
+  else if(respa_type=="slow"){ rt = 2; }
+  else{ cout<<"Error in Hamiltonian_Atomistic::energy_respa: respa_type = "<<respa_type<<" is unknown\n"; exit(0); }
+
+  double res = mm_ham->calculate_respa(rt);
+
+  status_dia = 0;
+  status_adi = 0;
+
+  return res;
+}
+
 
 
 
@@ -417,13 +449,7 @@ void Hamiltonian_Atomistic::compute_diabatic(){
     if(ham_types[0]==1){
 
       // Do actual computations
-      int sz = mm_ham->interactions.size();
-      double res = 0.0;
-      int tmp;
-      for(int i=0;i<sz;i++){
-        res += mm_ham->interactions[i].calculate(tmp);
-        //cout<<"interactions #"<<i<<", energy = "<<mm_ham->interactions[i].calculate(tmp)<<endl;
-      }
+      double res = mm_ham->calculate();
 
       for(int st=0;st<nelec;st++){
         // Energies
@@ -1021,7 +1047,13 @@ MATRIX3x3 Hamiltonian_Atomistic::get_stress(std::string opt){
 
   MATRIX3x3 res; res = 0.0;
   
-  if(ham_types[0]==1){
+  if(ham_types[0]==1 && mm_ham->backend==1){
+    // SoA engine accumulates the totals during the calculation
+    if(opt=="at"){ res = mm_ham->stress_at; }
+    else if(opt=="fr"){ res = mm_ham->stress_fr; }
+    else if(opt=="ml"){ res = mm_ham->stress_ml; }
+  }
+  else if(ham_types[0]==1){
     int nint = mm_ham->active_interactions.size();
 
     if(opt=="at"){
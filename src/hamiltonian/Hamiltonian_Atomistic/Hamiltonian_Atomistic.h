@@ -89,6 +89,8 @@ public:
 
   void apply_pbc_to_interactions(System& syst, int int_type,int nx,int ny,int nz);
   void set_respa_types(std::string inter_type,std::string respa_type);
+  void set_mm_backend(int backend);
+  double energy_respa(std::string respa_type);
 
   MATRIX3x3 get_stress(std::string);
 
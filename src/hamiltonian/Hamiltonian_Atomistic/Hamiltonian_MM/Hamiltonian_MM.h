@@ -41,6 +41,7 @@ using namespace libcell;
 using namespace libforcefield;
 
 
+class MM_Engine;
 
 
 
@@ -55,6 +56,8 @@ class Hamiltonian_MM{
   void init_variables();// Initializes variables
   void copy_content(const Hamiltonian_MM&); // Copies the content which is defined
 
+  friend class MM_Engine;  // reads the interaction data when packing it into the SoA tables
+
 //----------------- Types of interaction supported ---------------
   struct bond_interaction{
     int id1,id2;
@@ -253,6 +256,99 @@ public:
 };
 
 
+
+class MM_Engine{
+/**
+  This class is a data-oriented (structure-of-arrays) back-end for the evaluation of a list of Hamiltonian_MM
+  objects. The parameters and atom indices of bonds, angles, dihedrals, out-of-plane (improper) terms and
+  non-periodic vdW/electrostatic pairs are packed once into contiguous tables (one column per parameter),
+  sorted by the functional form, so each term type is computed in a plain loop without per-object dispatch.
+
+  The per-term results are then scattered to the atomic forces in the original order of the interactions,
+  so the total energy, forces and stress are bitwise identical to calling Hamiltonian_MM::calculate for each
+  interaction. Interactions without a packed kernel (periodic images, many-body, Gay-Berne, exclusions) are
+  kept as references and evaluated by the original objects at their place in that order.
+*/
+
+  // Atomic coordinates: unique pointers found in the interactions and the gathered values
+  vector<VECTOR*> pos_ptr;
+  vector<VECTOR>  pos;
+
+  // Scatter order: one record per interaction
+  vector<int> slot_kind;   // 0...5 - packed bond, angle, dihedral, oop, vdw, elec; -1 - original object; -2 - no-op
+  vector<int> slot_entry;  // row in the table of given kind (or index of the interaction for -1)
+  vector<int> slot_respa;  // RESPA type of the interaction
+  int n_respa[6][3];       // number of packed rows of each kind in each RESPA class (fast, medium, slow)
+
+  // Bonds
+  vector<int> b_range;                               // rows [b_range[f], b_range[f+1]) use functional f
+  vector<int> b_i, b_j;
+  vector<double> b_K, b_D, b_r0, b_alpha;
+  vector<VECTOR*> b_f1, b_f2, b_g1, b_g2, b_m1, b_m2;
+  vector<double> b_en;  vector<VECTOR> b_out;        // 2 forces per row
+
+  // Angles
+  vector<int> a_range;
+  vector<int> a_i, a_j, a_k, a_coord;
+  vector<double> a_k_theta, a_theta_0, a_cos_theta_0, a_C0, a_C1, a_C2;
+  vector<VECTOR*> a_f1, a_f2, a_f3, a_g1, a_g2, a_g3;
+  vector<double> a_en;  vector<VECTOR> a_out;        // 3 forces per row
+
+  // Dihedrals
+  vector<int> d_range;
+  vector<int> d_i, d_j, d_k, d_l, d_opt, d_n;
+  vector<double> d_Vphi, d_phi0, d_Vphi1, d_Vphi2, d_Vphi3;
+  vector<VECTOR*> d_f1, d_f2, d_f3, d_f4, d_g1, d_g2, d_g3, d_g4;
+  vector<double> d_en;  vector<VECTOR> d_out;        // 4 forces per row
+
+  // Out-of-plane (impropers)
+  vector<int> o_range;
+  vector<int> o_i, o_j, o_k, o_l, o_opt;
+  vector<double> o_K, o_C0, o_C1, o_C2, o_xi_0;
+  vector<VECTOR*> o_f1, o_f2, o_f3, o_f4, o_g1, o_g2, o_g3, o_g4;
+  vector<double> o_en;  vector<VECTOR> o_out;        // 4 forces per row
+
+  // Non-periodic vdW pairs
+  vector<int> v_range;
+  vector<int> v_i, v_j, v_cut;
+  vector<double> v_sigma, v_epsilon, v_D, v_r0, v_alpha;   // epsilon and D are premultiplied by the pair scale
+  vector<double> v_R_on, v_R_off, v_R_on2, v_R_off2;
+  vector<VECTOR*> v_f1, v_f2, v_g1, v_g2;
+  vector<double> v_en;  vector<VECTOR> v_out;  vector<int> v_on;  // 1 force per row (f12)
+
+  // Non-periodic electrostatic pairs
+  vector<int> e_i, e_j, e_cut;
+  vector<double> e_q1, e_q2, e_eps, e_delta;
+  vector<double> e_R_on, e_R_off, e_R_on2, e_R_off2;
+  vector<VECTOR*> e_f1, e_f2, e_g1, e_g2;
+  vector<double> e_en;  vector<VECTOR> e_out;  vector<int> e_on;
+
+  int add_position(map<VECTOR*,int>& indx, VECTOR* r);
+
+  void compute_bonds();
+  void compute_angles();
+  void compute_dihedrals();
+  void compute_oops();
+  void compute_vdws();
+  void compute_elecs();
+
+public:
+
+  int is_built;        ///< Flag showing whether the tables are built and in sync with the list of interactions
+  int n_slots;         ///< The number of interactions packed (the size of the list at the time of building)
+  int is_stress;       ///< Flag that controls whether the atomic, fragment and molecular stress are accumulated
+
+  MM_Engine(){ is_built = 0; n_slots = 0; is_stress = 1; }
+
+  // Defined in Hamiltonian_MM_methods3.cpp
+  void clear();
+  void build(vector<Hamiltonian_MM>& interactions);
+  double compute(vector<Hamiltonian_MM>& interactions, MATRIX3x3& st_at, MATRIX3x3& st_fr, MATRIX3x3& st_ml, int respa_type = -1);
+  void show_info();
+
+};
+
+
 
 class listHamiltonian_MM{
 /**
@@ -265,7 +361,7 @@ class listHamiltonian_MM{
 
 public:
 
-    listHamiltonian_MM(){ ;; }
+    listHamiltonian_MM(){ backend = 0; is_stress_at = is_stress_fr = is_stress_ml = 0; }
 
 
     vector<Hamiltonian_MM> interactions;  ///< The list of classical interaction (individual, primitive Hamiltonians)
@@ -284,6 +380,9 @@ public:
     MATRIX3x3 respa_s_fast,respa_s_medium;     
     double respa_E_fast,respa_E_medium;          ///< RESPA energies: fast and medium components
 
+    int backend;           ///< How the interactions are evaluated: 0 - one Hamiltonian_MM object at a time, 1 - SoA engine
+    MM_Engine engine;      ///< The structure-of-arrays representation of the interactions (used if backend == 1)
+
 
   //----------- Defined in Hamiltonian_MM_methods2.cpp ------------------
   // Interaction related functions:
@@ -308,6 +407,12 @@ public:
   void apply_pbc_to_interactions(System& syst, int int_type,int nx,int ny,int nz);
   void set_respa_types(std::string inter_type,std::string respa_type);
 
+  //----------- Defined in Hamiltonian_MM_methods3.cpp ------------------
+  void set_backend(int backend_);
+  void build_engine();
+  double calculate();
+  double calculate_respa(int respa_type);
+
 
 
 };
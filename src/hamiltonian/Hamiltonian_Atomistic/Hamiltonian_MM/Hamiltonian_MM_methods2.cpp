@@ -352,11 +352,17 @@ void listHamiltonian_MM::set_atom_interactions_for_atoms
   int sz = top_elt.size();
   int* at; at = new int[sz];
   int* id; id = new int[sz];
+
+  // Membership mask of the atom lists
+  vector<int> is_in_lst(syst.Atoms.size(),0);
+  for(i=0;i<lst1.size();i++){ if(lst1[i]>=0 && lst1[i]<syst.Atoms.size()){ is_in_lst[lst1[i]] = 1; } }
+  for(i=0;i<lst2.size();i++){ if(lst2[i]>=0 && lst2[i]<syst.Atoms.size()){ is_in_lst[lst2[i]] = 1; } }
+
   bool x = true;
   for(j=0;j<sz;j++){
     at[j] = top_elt[j].globAtom_Index;
     id[j] = top_elt[j].Atom_id;
-    x = (x && (is_in_vector(at[j],lst1)||is_in_vector(at[j],lst2)));
+    x = (x && is_in_lst[at[j]]);
   }
   // If now x is true - then each of the atoms of the topological element
   // belongs to one of the lists
@@ -432,29 +438,55 @@ void listHamiltonian_MM::set_atom_interactions_for_atoms
 
       if(verb>1){  cout<<"=============== Exclusion map ========================\n"; }
 
+      // Only the atoms of the same group and the 1,2-, 1,3- and 1,4-neighbors can form
+      // the exclusion pairs, so there is no need to check all pairs of atoms
+      vector<int> pos(syst.Atoms.size(),-1);       // position of the atom in the at array
+      map<int, vector<int> > group_pos;             // positions of the atoms of each group
+      for(j=0;j<sz;j++){
+        pos[at[j]] = j;
+        group_pos[syst.Atoms[at[j]].globGroup_Index].push_back(j);
+      }
+
       int num_excl = 0;
       for(i=0;i<sz;i++){
         vector<int> ve1,ve2,vs;
-        for(j=i;j<sz;j++){ 
+
+        vector<int> at12,at13,at14;
+        syst.get_12_13_14_atoms(at[i],at12,at13,at14);
+
+        vector<int> cand = group_pos[syst.Atoms[at[i]].globGroup_Index];
+        for(j=0;j<at12.size();j++){ if(pos[at12[j]]>-1){ cand.push_back(pos[at12[j]]); } }
+        for(j=0;j<at13.size();j++){ if(pos[at13[j]]>-1){ cand.push_back(pos[at13[j]]); } }
+        for(j=0;j<at14.size();j++){ if(pos[at14[j]]>-1){ cand.push_back(pos[at14[j]]); } }
+        std::sort(cand.begin(),cand.end());
+        cand.erase(std::unique(cand.begin(),cand.end()),cand.end());
+
+        for(int c=0;c<cand.size();c++){
+          j = cand[c];
+          if(j<i){ continue; }
+          int is12 = std::binary_search(at12.begin(),at12.end(),at[j]);
+          int is13 = std::binary_search(at13.begin(),at13.end(),at[j]);
+          int is14 = std::binary_search(at14.begin(),at14.end(),at[j]);
+
           if(syst.is_group_pair(at[i],at[j])){ vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(0.0); 
                                                ve1.push_back(at[i]); ve2.push_back(at[j]); vs.push_back(0.0);
                                         }
           else{
-            if(syst.is_12pair(at[i],at[j])) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale12); 
+            if(is12) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale12); 
                                               ve1.push_back(at[i]); ve2.push_back(at[j]); vs.push_back(scale12);
                                        }
             else{
-              if(syst.is_13pair(at[i],at[j])) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale13); 
+              if(is13) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale13); 
                                                 ve1.push_back(at[i]); ve2.push_back(at[j]); vs.push_back(scale13);
                                          }
               else{
-                if(syst.is_14pair(at[i],at[j])) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale14);
+                if(is14) { vexcl1.push_back(at[i]); vexcl2.push_back(at[j]); vscale.push_back(scale14);
                                                   ve1.push_back(at[i]); ve2.push_back(at[j]); vs.push_back(scale14);
                                            }         
               }
             }
           }
-        }//for j
+        }//for c
 
         // Add new entry in excl_scales:
         vector<excl_scale> excli;
@@ -537,82 +569,105 @@ void listHamiltonian_MM::set_group_interactions_for_atoms
 
   int g_indx[4];
   int m_indx[4];
-  for(int b=0;b<top_elt.size();b++){
+  int i, b, n_elts = top_elt.size();
+
+  // Membership masks of the atom lists: checking the lists directly costs O(N) per atom
+  int nat = syst.Atoms.size();
+  vector<int> is_in_lst(nat,0);
+  for(i=0;i<lst1.size();i++){ if(lst1[i]>=0 && lst1[i]<nat){ is_in_lst[lst1[i]] = 1; } }
+  for(i=0;i<lst2.size();i++){ if(lst2[i]>=0 && lst2[i]<nat){ is_in_lst[lst2[i]] = 1; } }
+
+  //--------------- Collect the elements and their atom types, bond orders, etc. --------------
+  vector<int> elt_indx(n_elts,-1);     // index of the element among the selected ones, -1 if not selected
+  vector< vector<std::string> > types;
+  vector< vector<double> > bond_orders;
+  vector<int> coordination;
+  vector<std::string> excl_pairs;
+
+  for(b=0;b<n_elts;b++){
     int sz = top_elt[0].Group_Size;
     bool x = true;
     int at[4];
     for(int j=0;j<sz;j++){
       at[j] = top_elt[b].globAtom_Index[j];
-      g_indx[j] = syst.Atoms[at[j]].globGroup_Index;
-      m_indx[j] = syst.Atoms[at[j]].globMolecule_Index;
-      x = (x && (is_in_vector(at[j],lst1)||is_in_vector(at[j],lst2)));
+      x = (x && is_in_lst[at[j]]);
     }
     // If now x is true - then each of the atoms of the topological element
     // belongs to one of the lists
     if(x){
+      elt_indx[b] = types.size();
+
+      vector<std::string> t;
+      for(int j=0;j<sz;j++){ t.push_back(syst.Atoms[at[j]].Atom_ff_type); }
+
+      vector<double> bo;
+      int coord = 2;
+      std::string excl = "no";
 
-      //--------------- Get the interaction parameters from the force field --------------
-      map<string,double> prms;      
-      int res = 0;
       if(int_type=="bond"){
         double bond_order = 1.0;
         if(top_elt[b].is_Group_bond_order){ bond_order = top_elt[b].Group_bond_order;   }
-        res = ff.get_bond_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type,bond_order,prms); 
-      } 
-      else if(int_type=="angle"){
-        double bo12,bo23;
-        bo12 = bo23 = 1.0;
-        int a,b;
-        int coord = 2;
-        if(syst.Atoms[at[1]].is_Atom_coordination){ coord = syst.Atoms[at[1]].Atom_coordination; }
-        b = syst.Find_Bond(at[0],at[1]); if(b>-1){ if(syst.Bonds[b].is_Group_bond_order) { bo12 = syst.Bonds[b].Group_bond_order; } }
-        b = syst.Find_Bond(at[1],at[2]); if(b>-1){ if(syst.Bonds[b].is_Group_bond_order) { bo23 = syst.Bonds[b].Group_bond_order; } }
-
-        res = ff.get_angle_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type, syst.Atoms[at[2]].Atom_ff_type,
-                                      bo12,bo23,coord,prms);
-      }
-      else if(int_type=="dihedral"){
-        double bo12,bo23,bo34;
-        bo12 = bo23 = bo34 = 1.0;
-        int b;
-        b = syst.Find_Bond(at[0],at[1]); if(b>-1){ if(syst.Bonds[b].is_Group_bond_order) { bo12 = syst.Bonds[b].Group_bond_order; } }
-        b = syst.Find_Bond(at[1],at[2]); if(b>-1){ if(syst.Bonds[b].is_Group_bond_order) { bo23 = syst.Bonds[b].Group_bond_order; } }
-        b = syst.Find_Bond(at[2],at[3]); if(b>-1){ if(syst.Bonds[b].is_Group_bond_order) { bo34 = syst.Bonds[b].Group_bond_order; } }
-
-        res = ff.get_dihedral_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type,
-                                         syst.Atoms[at[2]].Atom_ff_type, syst.Atoms[at[3]].Atom_ff_type,
-                                         bo12,bo23,bo34,prms);
+        bo.push_back(bond_order);
       }
-      else if(int_type=="oop"){
-        res = ff.get_oop_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type,
-                                    syst.Atoms[at[2]].Atom_ff_type, syst.Atoms[at[3]].Atom_ff_type, prms);
+      else if(int_type=="angle" || int_type=="dihedral"){
+        // Bond orders of the consecutive pairs of atoms: 1-2, 2-3 (and 3-4)
+        for(int j=0;j<sz-1;j++){
+          double bond_order = 1.0;
+          int k = syst.Find_Bond(at[j],at[j+1]); if(k>-1){ if(syst.Bonds[k].is_Group_bond_order) { bond_order = syst.Bonds[k].Group_bond_order; } }
+          bo.push_back(bond_order);
+        }
+        if(int_type=="angle"){ if(syst.Atoms[at[1]].is_Atom_coordination){ coord = syst.Atoms[at[1]].Atom_coordination; } }
       }
-      else if(int_type=="vdw"){
+      else if(int_type=="vdw" || int_type=="elec"){
         // The order matters here (for small cycles it is more important to exclude 1,2-pairs
         // than 1,3-pairs and it is more important to exclude 1,3-pairs that 1,4-pairs)
-        std::string excl_pairs = "no";
-        if(syst.is_14pair(at[0],at[1])){ excl_pairs = "14";}
-        if(syst.is_13pair(at[0],at[1])){ excl_pairs = "13";}
-        if(syst.is_12pair(at[0],at[1])){ excl_pairs = "12";}
-
-        res = ff.get_vdw_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type, excl_pairs, prms);
+        if(syst.is_14pair(at[0],at[1])){ excl = "14";}
+        if(syst.is_13pair(at[0],at[1])){ excl = "13";}
+        if(syst.is_12pair(at[0],at[1])){ excl = "12";}
       }
-      else if(int_type=="elec"){
-        // The order matters here (for small cycles it is more important to exclude 1,2-pairs
-        // than 1,3-pairs and it is more important to exclude 1,3-pairs that 1,4-pairs)
-        std::string excl_pairs = "no";
-        if(syst.is_14pair(at[0],at[1])){ excl_pairs = "14";}
-        if(syst.is_13pair(at[0],at[1])){ excl_pairs = "13";}
-        if(syst.is_12pair(at[0],at[1])){ excl_pairs = "12";}
+
+      types.push_back(t);
+      bond_orders.push_back(bo);
+      coordination.push_back(coord);
+      excl_pairs.push_back(excl);
+
+    }// if x
+  }// for b
+
+  //--------------- Get the interaction parameters from the force field --------------
+  // All elements at once: the elements of the same types share the parameters, so each distinct
+  // combination is resolved only once. Electrostatic parameters depend on the atomic charges, so
+  // they are obtained for each pair separately
+  vector<int> prms_indx;
+  vector< map<string,double> > all_prms;
+  if(int_type!="elec"){
+    ff.assign_all_parameters(int_type,types,bond_orders,coordination,excl_pairs,prms_indx,all_prms);
+  }
+
+  for(b=0;b<n_elts;b++){
+    int sz = top_elt[0].Group_Size;
+    int at[4];
+    for(int j=0;j<sz;j++){
+      at[j] = top_elt[b].globAtom_Index[j];
+      g_indx[j] = syst.Atoms[at[j]].globGroup_Index;
+      m_indx[j] = syst.Atoms[at[j]].globMolecule_Index;
+    }
+
+    int e = elt_indx[b];
+    if(e>-1){
+
+      map<string,double> prms;      
+      int res = 0;
+      if(int_type=="elec"){
         double q1,q2; q1 = q2 = 0.0;
         if(syst.Atoms[at[0]].is_Atom_charge){ q1 = syst.Atoms[at[0]].Atom_charge; }
         if(syst.Atoms[at[1]].is_Atom_charge){ q2 = syst.Atoms[at[1]].Atom_charge; }
 
         res = ff.get_elec_parameters(syst.Atoms[at[0]].Atom_ff_type, syst.Atoms[at[1]].Atom_ff_type,
-                        excl_pairs,q1,q2, syst.Atoms[at[0]].is_Atom_charge, syst.Atoms[at[1]].is_Atom_charge,prms);
-//        cout<<"Atoms[at[0]].Atom_charge = "<<Atoms[at[0]].Atom_charge<<endl;
-//        cout<<"Atoms[at[1]].Atom_charge = "<<Atoms[at[1]].Atom_charge<<endl;
-//        cout<<"Parameters for elec exist? "<<res<<endl;
+                        excl_pairs[e],q1,q2, syst.Atoms[at[0]].is_Atom_charge, syst.Atoms[at[1]].is_Atom_charge,prms);
+      }
+      else if(prms_indx[e]>-1){
+        prms = all_prms[prms_indx[e]];  res = 1;
       }
 
       //------------------------------------------------------------------------------------
@@ -856,6 +911,8 @@ void listHamiltonian_MM::apply_pbc_to_interactions(System& syst, int int_type,in
   }// for i
   }// Box!= NULL
 
+  engine.is_built = 0;
+
 }
 
 
@@ -891,6 +948,8 @@ void listHamiltonian_MM::set_respa_types(std::string s_int_type,std::string s_re
     interactions[i].set_respa_type(int_type,respa_type);
   }
 
+  engine.is_built = 0;
+
 }
 
 
@@ -0,0 +1,743 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Hamiltonian_MM_methods3.cpp
+  \brief The file implements the structure-of-arrays (MM_Engine) back-end for the evaluation of the listHamiltonian_MM
+*/
+
+#include "Hamiltonian_MM.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_mm namespace
+namespace libhamiltonian_mm{
+
+
+void MM_Engine::clear(){
+/**
+  Removes all packed interactions
+*/
+
+  pos_ptr.clear(); pos.clear();
+  slot_kind.clear(); slot_entry.clear(); slot_respa.clear();
+
+  b_range.clear(); b_i.clear(); b_j.clear();
+  b_K.clear(); b_D.clear(); b_r0.clear(); b_alpha.clear();
+  b_f1.clear(); b_f2.clear(); b_g1.clear(); b_g2.clear(); b_m1.clear(); b_m2.clear();
+  b_en.clear(); b_out.clear();
+
+  a_range.clear(); a_i.clear(); a_j.clear(); a_k.clear(); a_coord.clear();
+  a_k_theta.clear(); a_theta_0.clear(); a_cos_theta_0.clear(); a_C0.clear(); a_C1.clear(); a_C2.clear();
+  a_f1.clear(); a_f2.clear(); a_f3.clear(); a_g1.clear(); a_g2.clear(); a_g3.clear();
+  a_en.clear(); a_out.clear();
+
+  d_range.clear(); d_i.clear(); d_j.clear(); d_k.clear(); d_l.clear(); d_opt.clear(); d_n.clear();
+  d_Vphi.clear(); d_phi0.clear(); d_Vphi1.clear(); d_Vphi2.clear(); d_Vphi3.clear();
+  d_f1.clear(); d_f2.clear(); d_f3.clear(); d_f4.clear(); d_g1.clear(); d_g2.clear(); d_g3.clear(); d_g4.clear();
+  d_en.clear(); d_out.clear();
+
+  o_range.clear(); o_i.clear(); o_j.clear(); o_k.clear(); o_l.clear(); o_opt.clear();
+  o_K.clear(); o_C0.clear(); o_C1.clear(); o_C2.clear(); o_xi_0.clear();
+  o_f1.clear(); o_f2.clear(); o_f3.clear(); o_f4.clear(); o_g1.clear(); o_g2.clear(); o_g3.clear(); o_g4.clear();
+  o_en.clear(); o_out.clear();
+
+  v_range.clear(); v_i.clear(); v_j.clear(); v_cut.clear();
+  v_sigma.clear(); v_epsilon.clear(); v_D.clear(); v_r0.clear(); v_alpha.clear();
+  v_R_on.clear(); v_R_off.clear(); v_R_on2.clear(); v_R_off2.clear();
+  v_f1.clear(); v_f2.clear(); v_g1.clear(); v_g2.clear();
+  v_en.clear(); v_out.clear(); v_on.clear();
+
+  e_i.clear(); e_j.clear(); e_cut.clear();
+  e_q1.clear(); e_q2.clear(); e_eps.clear(); e_delta.clear();
+  e_R_on.clear(); e_R_off.clear(); e_R_on2.clear(); e_R_off2.clear();
+  e_f1.clear(); e_f2.clear(); e_g1.clear(); e_g2.clear();
+  e_en.clear(); e_out.clear(); e_on.clear();
+
+  for(int t=0;t<6;t++){ for(int r=0;r<3;r++){ n_respa[t][r] = 0; } }
+
+  n_slots = 0;
+  is_built = 0;
+
+}
+
+int MM_Engine::add_position(map<VECTOR*,int>& indx, VECTOR* r){
+/**
+  Returns the index of the coordinate pointed by r in the gathered coordinates array, adding it if needed
+*/
+
+  map<VECTOR*,int>::iterator it = indx.find(r);
+  if(it!=indx.end()){ return it->second; }
+
+  int n = pos_ptr.size();
+  pos_ptr.push_back(r);
+  indx[r] = n;
+  return n;
+}
+
+
+void MM_Engine::build(vector<Hamiltonian_MM>& inter){
+/**
+  \param[in] inter The list of interactions (e.g. listHamiltonian_MM::interactions) to pack
+
+  Packs the parameters of the interactions into the SoA tables. Within each table the rows are grouped by the
+  functional form (keeping the original relative order), so each (term type, functional) pair is a single loop.
+  The tables refer to the same coordinates and forces as the interactions themselves, so they must be rebuilt
+  if the interactions are re-created, (de)activated or put into a periodic box.
+*/
+
+  clear();
+
+  n_slots = inter.size();
+  slot_kind  = vector<int>(n_slots, -1);
+  slot_entry = vector<int>(n_slots, -1);
+  slot_respa = vector<int>(n_slots, 0);
+
+  // Number of functionals with a packed kernel, for each term type
+  const int nfunc[6] = {3, 7, 2, 3, 3, 1};
+  vector< vector<int> > rows(6, vector<int>());
+
+  for(int n=0;n<n_slots;n++){
+    Hamiltonian_MM& h = inter[n];
+    slot_respa[n] = h.respa_type;
+
+    int kind = -1;
+    if(h.is_int_type && h.is_functional){
+      int t = h.int_type;
+      if(t>=0 && t<=3){
+        if(h.functional>=0 && h.functional<nfunc[t]){  kind = (h.is_active ? t : -2);  }
+      }
+      else if(t==4 && h.Box==NULL){
+        if(h.functional>=0 && h.functional<nfunc[4]){  kind = (h.is_active ? 4 : -2);  }
+      }
+      else if(t==5 && h.Box==NULL){
+        if(h.functional==0){  kind = (h.is_active ? 5 : -2);  }
+      }
+    }
+    slot_kind[n] = kind;
+    if(kind==-1){ slot_entry[n] = n; }
+    if(kind>=0){
+      rows[kind].push_back(n);
+      if(h.respa_type>=0 && h.respa_type<3){ n_respa[kind][h.respa_type]++; }
+    }
+  }
+
+  map<VECTOR*,int> indx;
+  int t, f, r, n, k, sz;
+
+  // Bonds
+  t = 0;  b_range = vector<int>(nfunc[t]+1, 0);
+  for(f=0;f<nfunc[t];f++){
+    sz = rows[t].size();
+    for(r=0;r<sz;r++){
+      n = rows[t][r];
+      if(inter[n].functional!=f){ continue; }
+      Hamiltonian_MM::bond_interaction* d = inter[n].data_bond;
+      slot_entry[n] = b_i.size();
+      b_i.push_back(add_position(indx, d->r1));  b_j.push_back(add_position(indx, d->r2));
+      b_K.push_back(d->K);  b_D.push_back(d->D);  b_r0.push_back(d->r0);  b_alpha.push_back(d->alpha);
+      b_f1.push_back(d->f1);  b_f2.push_back(d->f2);
+      b_g1.push_back(d->g1);  b_g2.push_back(d->g2);
+      b_m1.push_back(d->m1);  b_m2.push_back(d->m2);
+    }
+    b_range[f+1] = b_i.size();
+  }
+  b_en = vector<double>(b_i.size(), 0.0);  b_out = vector<VECTOR>(2*b_i.size());
+
+  // Angles
+  t = 1;  a_range = vector<int>(nfunc[t]+1, 0);
+  for(f=0;f<nfunc[t];f++){
+    sz = rows[t].size();
+    for(r=0;r<sz;r++){
+      n = rows[t][r];
+      if(inter[n].functional!=f){ continue; }
+      Hamiltonian_MM::angle_interaction* d = inter[n].data_angle;
+      slot_entry[n] = a_i.size();
+      a_i.push_back(add_position(indx, d->r1));  a_j.push_back(add_position(indx, d->r2));  a_k.push_back(add_position(indx, d->r3));
+      a_k_theta.push_back(d->k_theta);  a_theta_0.push_back(d->theta_0);  a_cos_theta_0.push_back(d->cos_theta_0);
+      a_C0.push_back(d->C0);  a_C1.push_back(d->C1);  a_C2.push_back(d->C2);  a_coord.push_back(d->coordination);
+      a_f1.push_back(d->f1);  a_f2.push_back(d->f2);  a_f3.push_back(d->f3);
+      a_g1.push_back(d->g1);  a_g2.push_back(d->g2);  a_g3.push_back(d->g3);
+    }
+    a_range[f+1] = a_i.size();
+  }
+  a_en = vector<double>(a_i.size(), 0.0);  a_out = vector<VECTOR>(3*a_i.size());
+
+  // Dihedrals
+  t = 2;  d_range = vector<int>(nfunc[t]+1, 0);
+  for(f=0;f<nfunc[t];f++){
+    sz = rows[t].size();
+    for(r=0;r<sz;r++){
+      n = rows[t][r];
+      if(inter[n].functional!=f){ continue; }
+      Hamiltonian_MM::dihedral_interaction* d = inter[n].data_dihedral;
+      slot_entry[n] = d_i.size();
+      d_i.push_back(add_position(indx, d->r1));  d_j.push_back(add_position(indx, d->r2));
+      d_k.push_back(add_position(indx, d->r3));  d_l.push_back(add_position(indx, d->r4));
+      d_Vphi.push_back(d->Vphi);  d_phi0.push_back(d->phi0);
+      d_Vphi1.push_back(d->Vphi1);  d_Vphi2.push_back(d->Vphi2);  d_Vphi3.push_back(d->Vphi3);
+      d_opt.push_back(d->opt);  d_n.push_back(d->n);
+      d_f1.push_back(d->f1);  d_f2.push_back(d->f2);  d_f3.push_back(d->f3);  d_f4.push_back(d->f4);
+      d_g1.push_back(d->g1);  d_g2.push_back(d->g2);  d_g3.push_back(d->g3);  d_g4.push_back(d->g4);
+    }
+    d_range[f+1] = d_i.size();
+  }
+  d_en = vector<double>(d_i.size(), 0.0);  d_out = vector<VECTOR>(4*d_i.size());
+
+  // Out-of-plane
+  t = 3;  o_range = vector<int>(nfunc[t]+1, 0);
+  for(f=0;f<nfunc[t];f++){
+    sz = rows[t].size();
+    for(r=0;r<sz;r++){
+      n = rows[t][r];
+      if(inter[n].functional!=f){ continue; }
+      Hamiltonian_MM::oop_interaction* d = inter[n].data_oop;
+      slot_entry[n] = o_i.size();
+      o_i.push_back(add_position(indx, d->r1));  o_j.push_back(add_position(indx, d->r2));
+      o_k.push_back(add_position(indx, d->r3));  o_l.push_back(add_position(indx, d->r4));
+      o_K.push_back(d->K);  o_C0.push_back(d->C0);  o_C1.push_back(d->C1);  o_C2.push_back(d->C2);
+      o_xi_0.push_back(d->xi_0);  o_opt.push_back(d->opt);
+      o_f1.push_back(d->f1);  o_f2.push_back(d->f2);  o_f3.push_back(d->f3);  o_f4.push_back(d->f4);
+      o_g1.push_back(d->g1);  o_g2.push_back(d->g2);  o_g3.push_back(d->g3);  o_g4.push_back(d->g4);
+    }
+    o_range[f+1] = o_i.size();
+  }
+  o_en = vector<double>(o_i.size(), 0.0);  o_out = vector<VECTOR>(4*o_i.size());
+
+  // vdW pairs
+  t = 4;  v_range = vector<int>(nfunc[t]+1, 0);
+  for(f=0;f<nfunc[t];f++){
+    sz = rows[t].size();
+    for(r=0;r<sz;r++){
+      n = rows[t][r];
+      if(inter[n].functional!=f){ continue; }
+      Hamiltonian_MM::vdw_interaction* d = inter[n].data_vdw;
+      slot_entry[n] = v_i.size();
+      v_i.push_back(add_position(indx, d->r1));  v_j.push_back(add_position(indx, d->r2));
+      v_sigma.push_back(d->sigma);  v_epsilon.push_back(d->scale*d->epsilon);  v_D.push_back(d->scale*d->D);
+      v_r0.push_back(d->r0);  v_alpha.push_back(d->alpha);
+      v_cut.push_back(d->is_cutoff);
+      v_R_on.push_back(d->R_on);  v_R_off.push_back(d->R_off);  v_R_on2.push_back(d->R_on2);  v_R_off2.push_back(d->R_off2);
+      v_f1.push_back(d->f1);  v_f2.push_back(d->f2);
+      v_g1.push_back(d->g1);  v_g2.push_back(d->g2);
+    }
+    v_range[f+1] = v_i.size();
+  }
+  v_en = vector<double>(v_i.size(), 0.0);  v_out = vector<VECTOR>(v_i.size());  v_on = vector<int>(v_i.size(), 0);
+
+  // Electrostatic pairs
+  t = 5;
+  sz = rows[t].size();
+  for(r=0;r<sz;r++){
+    n = rows[t][r];
+    Hamiltonian_MM::elec_interaction* d = inter[n].data_elec;
+    slot_entry[n] = e_i.size();
+    e_i.push_back(add_position(indx, d->r1));  e_j.push_back(add_position(indx, d->r2));
+    e_q1.push_back(d->q1);  e_q2.push_back(d->q2);  e_eps.push_back(d->eps);  e_delta.push_back(d->delta);
+    e_cut.push_back(d->is_cutoff);
+    e_R_on.push_back(d->R_on);  e_R_off.push_back(d->R_off);  e_R_on2.push_back(d->R_on2);  e_R_off2.push_back(d->R_off2);
+    e_f1.push_back(d->f1);  e_f2.push_back(d->f2);
+    e_g1.push_back(d->g1);  e_g2.push_back(d->g2);
+  }
+  e_en = vector<double>(e_i.size(), 0.0);  e_out = vector<VECTOR>(e_i.size());  e_on = vector<int>(e_i.size(), 0);
+
+  pos = vector<VECTOR>(pos_ptr.size());
+
+  is_built = 1;
+
+}
+
+
+void MM_Engine::compute_bonds(){
+/**
+  Bond energies and forces for all packed rows. The harmonic term is written out explicitly (the same
+  sequence of floating-point operations as in Bond_Harmonic), the others call the potentials library
+*/
+
+  int k;
+
+  // Harmonic
+  for(k=b_range[0];k<b_range[1];k++){
+    const VECTOR& ri = pos[b_i[k]];
+    const VECTOR& rj = pos[b_j[k]];
+    double dx = ri.x - rj.x;
+    double dy = ri.y - rj.y;
+    double dz = ri.z - rj.z;
+    double d  = sqrt(dx*dx+dy*dy+dz*dz);
+    double dr = (d - b_r0[k]);
+    double c  = -2.0*b_K[k]*dr;
+
+    VECTOR& fi = b_out[2*k];
+    VECTOR& fj = b_out[2*k+1];
+    fi.x = c*(dx/d);  fi.y = c*(dy/d);  fi.z = c*(dz/d);
+    fj.x = -fi.x;     fj.y = -fi.y;     fj.z = -fi.z;
+
+    b_en[k] = b_K[k]*dr*dr;
+  }
+
+  // Quartic
+  for(k=b_range[1];k<b_range[2];k++){
+    b_en[k] = Bond_Quartic(pos[b_i[k]],pos[b_j[k]],b_out[2*k],b_out[2*k+1],b_K[k],b_r0[k]);
+  }
+
+  // Morse
+  for(k=b_range[2];k<b_range[3];k++){
+    b_en[k] = Bond_Morse(pos[b_i[k]],pos[b_j[k]],b_out[2*k],b_out[2*k+1],b_D[k],b_r0[k],b_alpha[k]);
+  }
+
+}
+
+void MM_Engine::compute_angles(){
+/**
+  Angle energies and forces for all packed rows, one loop per functional
+*/
+
+  int k;
+  int sz = a_out.size();
+  for(k=0;k<sz;k++){ a_out[k] = 0.0; }
+
+  for(k=a_range[0];k<a_range[1];k++){
+    a_en[k] = Angle_Harmonic(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],a_k_theta[k],a_theta_0[k]);
+  }
+  for(k=a_range[1];k<a_range[2];k++){
+    a_en[k] = Angle_Fourier(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],
+                            a_k_theta[k],a_C0[k],a_C1[k],a_C2[k],a_coord[k]);
+  }
+  for(k=a_range[2];k<a_range[3];k++){
+    a_en[k] = Angle_Fourier_General(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],
+                                    a_k_theta[k],a_C0[k],a_C1[k],a_C2[k]);
+  }
+  for(k=a_range[3];k<a_range[4];k++){
+    a_en[k] = Angle_Fourier_Special(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],
+                                    a_k_theta[k],a_coord[k]);
+  }
+  for(k=a_range[4];k<a_range[5];k++){
+    a_en[k] = Angle_Harmonic_Cos(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],
+                                 a_k_theta[k],a_cos_theta_0[k],a_coord[k]);
+  }
+  for(k=a_range[5];k<a_range[6];k++){
+    a_en[k] = Angle_Harmonic_Cos_General(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],
+                                         a_k_theta[k],a_cos_theta_0[k]);
+  }
+  for(k=a_range[6];k<a_range[7];k++){
+    a_en[k] = Angle_Cubic(pos[a_i[k]],pos[a_j[k]],pos[a_k[k]],a_out[3*k],a_out[3*k+1],a_out[3*k+2],a_k_theta[k],a_theta_0[k]);
+  }
+
+}
+
+void MM_Engine::compute_dihedrals(){
+/**
+  Dihedral energies and forces for all packed rows, one loop per functional
+*/
+
+  int k;
+  int sz = d_out.size();
+  for(k=0;k<sz;k++){ d_out[k] = 0.0; }
+
+  for(k=d_range[0];k<d_range[1];k++){
+    d_en[k] = Dihedral_General(pos[d_i[k]],pos[d_j[k]],pos[d_k[k]],pos[d_l[k]],
+                               d_out[4*k],d_out[4*k+1],d_out[4*k+2],d_out[4*k+3],d_Vphi[k],d_phi0[k],d_n[k],d_opt[k]);
+  }
+  for(k=d_range[1];k<d_range[2];k++){
+    d_en[k] = Dihedral_Fourier(pos[d_i[k]],pos[d_j[k]],pos[d_k[k]],pos[d_l[k]],
+                               d_out[4*k],d_out[4*k+1],d_out[4*k+2],d_out[4*k+3],d_Vphi1[k],d_Vphi2[k],d_Vphi3[k],d_opt[k]);
+  }
+
+}
+
+void MM_Engine::compute_oops(){
+/**
+  Out-of-plane energies and forces for all packed rows, one loop per functional
+*/
+
+  int k;
+  int sz = o_out.size();
+  for(k=0;k<sz;k++){ o_out[k] = 0.0; }
+
+  for(k=o_range[0];k<o_range[1];k++){
+    o_en[k] = OOP_Fourier(pos[o_i[k]],pos[o_j[k]],pos[o_k[k]],pos[o_l[k]],
+                          o_out[4*k],o_out[4*k+1],o_out[4*k+2],o_out[4*k+3],o_K[k],o_C0[k],o_C1[k],o_C2[k],o_opt[k]);
+  }
+  for(k=o_range[1];k<o_range[2];k++){
+    o_en[k] = OOP_Wilson(pos[o_i[k]],pos[o_j[k]],pos[o_k[k]],pos[o_l[k]],
+                         o_out[4*k],o_out[4*k+1],o_out[4*k+2],o_out[4*k+3],o_K[k],o_xi_0[k]);
+  }
+  for(k=o_range[2];k<o_range[3];k++){
+    o_en[k] = OOP_Harmonic(pos[o_i[k]],pos[o_j[k]],pos[o_k[k]],pos[o_l[k]],
+                           o_out[4*k],o_out[4*k+1],o_out[4*k+2],o_out[4*k+3],o_K[k]);
+  }
+
+}
+
+void MM_Engine::compute_vdws(){
+/**
+  Switched vdW energies and pair forces (f12 = force on the first atom) for all packed rows. The Lennard-Jones term
+  is written out explicitly with the same sequence of floating-point operations as Vdw_LJ
+*/
+
+  int k;
+  int sz = v_i.size();
+  double SW, en;
+  VECTOR dSW, f1, f2;
+
+  for(k=0;k<sz;k++){
+    VECTOR& r1 = pos[v_i[k]];
+    VECTOR& r2 = pos[v_j[k]];
+    double dx = r1.x - r2.x;
+    double dy = r1.y - r2.y;
+    double dz = r1.z - r2.z;
+    double d12 = dx*dx+dy*dy+dz*dz;
+
+    SW = 1.0; dSW = 0.0;
+    if(v_cut[k]){
+      if(d12<=v_R_off2[k]){
+        if(d12>=v_R_on2[k]){  SWITCH(r1,r2,v_R_on[k],v_R_off[k],SW,dSW);  }
+      }else{ SW = 0.0; dSW = 0.0; }
+    }
+
+    v_on[k] = 0;
+    v_en[k] = 0.0;
+    if(SW>0.0){
+
+      if(k<v_range[1]){  // LJ
+        double r_2 = (v_sigma[k]*v_sigma[k]/d12);
+        double r_6 = r_2*r_2*r_2;
+        double r_12 = r_6*r_6;
+        en = v_epsilon[k]*(r_12-2.0*r_6);
+        double c = 12.0*v_epsilon[k]*(r_12 - r_6);
+        f1.x = c*(dx/d12);  f1.y = c*(dy/d12);  f1.z = c*(dz/d12);
+      }
+      else if(k<v_range[2]){ en = Vdw_Buffered14_7(r1,r2,f1,f2,v_sigma[k],v_epsilon[k]); }
+      else{ en = Vdw_Morse(r1,r2,f1,f2,v_D[k],v_r0[k],v_alpha[k]); }
+
+      v_en[k] += SW*en;
+      v_out[k] = (SW*f1 - en*dSW);
+      v_on[k] = 1;
+    }
+  }// for k
+
+}
+
+void MM_Engine::compute_elecs(){
+/**
+  Switched Coulomb energies and pair forces (f12 = force on the first atom) for all packed rows. The same sequence
+  of floating-point operations as in Elec_Coulomb
+*/
+
+  int k;
+  int sz = e_i.size();
+  double SW, en;
+  VECTOR dSW;
+
+  for(k=0;k<sz;k++){
+    VECTOR& r1 = pos[e_i[k]];
+    VECTOR& r2 = pos[e_j[k]];
+    double dx = r1.x - r2.x;
+    double dy = r1.y - r2.y;
+    double dz = r1.z - r2.z;
+    double d12 = dx*dx+dy*dy+dz*dz;
+
+    SW = 1.0; dSW = 0.0;
+    if(e_cut[k]){
+      if(d12<=e_R_off2[k]){
+        if(d12>=e_R_on2[k]){  SWITCH(r1,r2,e_R_on[k],e_R_off[k],SW,dSW);  }
+      }else{ SW = 0.0; dSW = 0.0; }
+    }
+
+    e_on[k] = 0;
+    e_en[k] = 0.0;
+    if(SW>0.0){
+      double d1 = sqrt(d12);
+      double d2 = d1 + e_delta[k];
+      en = (e_q1[k]*e_q2[k]/(e_eps[k]*d2));
+      double c = (en/d2);
+      VECTOR f1;
+      f1.x = c*(dx/d1);  f1.y = c*(dy/d1);  f1.z = c*(dz/d1);
+
+      e_en[k] += SW*en;
+      e_out[k] = (SW*f1 - en*dSW);
+      e_on[k] = 1;
+    }
+  }// for k
+
+}
+
+
+double MM_Engine::compute(vector<Hamiltonian_MM>& inter, MATRIX3x3& st_at, MATRIX3x3& st_fr, MATRIX3x3& st_ml, int respa_type){
+/**
+  \param[in,out] inter The list of interactions the tables were built from. The tables are (re)built if needed. Only the
+  interactions without a packed kernel are accessed during the calculations.
+  \param[out] st_at Total atomic stress (sum over the active interactions)
+  \param[out] st_fr Total fragment stress
+  \param[out] st_ml Total molecular stress
+  \param[in] respa_type If non-negative, only the interactions of this RESPA class (0 - fast, 1 - medium, 2 - slow) are
+  computed; the tables that have no rows of this class are skipped altogether
+
+  Returns the total MM energy. The forces are added to the force variables the interactions point to.
+*/
+
+  if(!is_built || n_slots!=inter.size()){ build(inter); }
+
+  int i, e, n;
+
+  // Gather the coordinates
+  int npos = pos_ptr.size();
+  for(i=0;i<npos;i++){ pos[i] = *pos_ptr[i]; }
+
+  // Compute all terms, type by type
+  int all = (respa_type<0 || respa_type>2);
+  if(all || n_respa[0][respa_type]){ compute_bonds(); }
+  if(all || n_respa[1][respa_type]){ compute_angles(); }
+  if(all || n_respa[2][respa_type]){ compute_dihedrals(); }
+  if(all || n_respa[3][respa_type]){ compute_oops(); }
+  if(all || n_respa[4][respa_type]){ compute_vdws(); }
+  if(all || n_respa[5][respa_type]){ compute_elecs(); }
+
+  // Scatter in the original order of the interactions
+  double res = 0.0;
+  st_at = 0.0;  st_fr = 0.0;  st_ml = 0.0;
+  MATRIX3x3 tp, s_at, s_fr, s_ml;
+  int tmp;
+
+  for(n=0;n<n_slots;n++){
+    if(!all && slot_respa[n]!=respa_type){ continue; }
+    e = slot_entry[n];
+
+    switch(slot_kind[n]){
+
+    case 0: {
+      VECTOR& f1 = b_out[2*e];  VECTOR& f2 = b_out[2*e+1];
+      res += b_en[e];
+      *(b_f1[e]) += f1;
+      *(b_f2[e]) += f2;
+      if(is_stress){
+        s_at = 0.0;  s_fr = 0.0;  s_ml = 0.0;
+        tp.tensor_product((pos[b_i[e]] - pos[b_j[e]]) , f1);   s_at += tp;
+        tp.tensor_product((*(b_g1[e]) - *(b_g2[e])) , f1);     s_fr += tp;
+        tp.tensor_product((*(b_m1[e]) - *(b_m2[e])) , f1);     s_ml += tp;
+        st_at += s_at;  st_fr += s_fr;  st_ml += s_ml;
+      }
+    } break;
+
+    case 1: {
+      VECTOR& f1 = a_out[3*e];  VECTOR& f2 = a_out[3*e+1];  VECTOR& f3 = a_out[3*e+2];
+      res += a_en[e];
+      *(a_f1[e]) += f1;
+      *(a_f2[e]) += f2;
+      *(a_f3[e]) += f3;
+      if(is_stress){
+        s_at = 0.0;  s_fr = 0.0;
+        tp.tensor_product(pos[a_i[e]] , f1);     s_at += tp;
+        tp.tensor_product(pos[a_j[e]] , f2);     s_at += tp;
+        tp.tensor_product(pos[a_k[e]] , f3);     s_at += tp;
+        tp.tensor_product(*(a_g1[e]) , f1);      s_fr += tp;
+        tp.tensor_product(*(a_g2[e]) , f2);      s_fr += tp;
+        tp.tensor_product(*(a_g3[e]) , f3);      s_fr += tp;
+        st_at += s_at;  st_fr += s_fr;
+      }
+    } break;
+
+    case 2: {
+      VECTOR& f1 = d_out[4*e];  VECTOR& f2 = d_out[4*e+1];  VECTOR& f3 = d_out[4*e+2];  VECTOR& f4 = d_out[4*e+3];
+      res += d_en[e];
+      *(d_f1[e]) += f1;
+      *(d_f2[e]) += f2;
+      *(d_f3[e]) += f3;
+      *(d_f4[e]) += f4;
+      if(is_stress){
+        s_at = 0.0;  s_fr = 0.0;
+        tp.tensor_product(pos[d_i[e]] , f1);     s_at += tp;
+        tp.tensor_product(pos[d_j[e]] , f2);     s_at += tp;
+        tp.tensor_product(pos[d_k[e]] , f3);     s_at += tp;
+        tp.tensor_product(pos[d_l[e]] , f4);     s_at += tp;
+        tp.tensor_product(*(d_g1[e]) , f1);      s_fr += tp;
+        tp.tensor_product(*(d_g2[e]) , f2);      s_fr += tp;
+        tp.tensor_product(*(d_g3[e]) , f3);      s_fr += tp;
+        tp.tensor_product(*(d_g4[e]) , f4);      s_fr += tp;
+        st_at += s_at;  st_fr += s_fr;
+      }
+    } break;
+
+    case 3: {
+      VECTOR& f1 = o_out[4*e];  VECTOR& f2 = o_out[4*e+1];  VECTOR& f3 = o_out[4*e+2];  VECTOR& f4 = o_out[4*e+3];
+      res += o_en[e];
+      *(o_f1[e]) += f1;
+      *(o_f2[e]) += f2;
+      *(o_f3[e]) += f3;
+      *(o_f4[e]) += f4;
+      if(is_stress){
+        s_at = 0.0;  s_fr = 0.0;
+        tp.tensor_product(pos[o_i[e]] , f1);     s_at += tp;
+        tp.tensor_product(pos[o_j[e]] , f2);     s_at += tp;
+        tp.tensor_product(pos[o_k[e]] , f3);     s_at += tp;
+        tp.tensor_product(pos[o_l[e]] , f4);     s_at += tp;
+        tp.tensor_product(*(o_g1[e]) , f1);      s_fr += tp;
+        tp.tensor_product(*(o_g2[e]) , f2);      s_fr += tp;
+        tp.tensor_product(*(o_g3[e]) , f3);      s_fr += tp;
+        tp.tensor_product(*(o_g4[e]) , f4);      s_fr += tp;
+        st_at += s_at;  st_fr += s_fr;
+      }
+    } break;
+
+    case 4: {
+      res += v_en[e];
+      if(v_on[e]){
+        VECTOR& f12 = v_out[e];
+        *(v_f1[e]) += f12;
+        *(v_f2[e]) -= f12;
+        if(is_stress){
+          s_at = 0.0;  s_fr = 0.0;
+          tp.tensor_product((pos[v_i[e]] - pos[v_j[e]]) , f12);   s_at += tp;
+          tp.tensor_product((*(v_g1[e]) - *(v_g2[e])) , f12);     s_fr += tp;
+          st_at += s_at;  st_fr += s_fr;
+        }
+      }
+    } break;
+
+    case 5: {
+      res += e_en[e];
+      if(e_on[e]){
+        VECTOR& f12 = e_out[e];
+        *(e_f1[e]) += f12;
+        *(e_f2[e]) -= f12;
+        if(is_stress){
+          s_at = 0.0;  s_fr = 0.0;
+          tp.tensor_product((pos[e_i[e]] - pos[e_j[e]]) , f12);   s_at += tp;
+          tp.tensor_product((*(e_g1[e]) - *(e_g2[e])) , f12);     s_fr += tp;
+          st_at += s_at;  st_fr += s_fr;
+        }
+      }
+    } break;
+
+    case -1: {
+      // No packed kernel - let the object do the work
+      res += inter[e].calculate(tmp);
+      if(is_stress && inter[e].get_status()){
+        st_at += inter[e].stress_at;
+        st_fr += inter[e].stress_fr;
+        st_ml += inter[e].stress_ml;
+      }
+    } break;
+
+    default: break;  // inactive interaction
+
+    }// switch
+  }// for n
+
+  return res;
+}
+
+
+void MM_Engine::show_info(){
+/**
+  Prints the sizes of the packed tables
+*/
+
+  int n_obj = 0, n_off = 0;
+  for(int n=0;n<n_slots;n++){
+    if(slot_kind[n]==-1){ n_obj++; }
+    else if(slot_kind[n]==-2){ n_off++; }
+  }
+
+  cout<<"MM_Engine: is_built = "<<is_built<<" number of interactions = "<<n_slots<<"\n";
+  cout<<"  bonds = "<<b_i.size()<<" angles = "<<a_i.size()<<" dihedrals = "<<d_i.size()<<" oops = "<<o_i.size()
+      <<" vdw = "<<v_i.size()<<" elec = "<<e_i.size()<<"\n";
+  cout<<"  evaluated by objects = "<<n_obj<<" inactive = "<<n_off<<" unique coordinates = "<<pos_ptr.size()<<"\n";
+
+}
+
+
+
+void listHamiltonian_MM::set_backend(int backend_){
+/**
+  \param[in] backend_ Selects how the interactions are evaluated: 0 - each Hamiltonian_MM object is called in turn (default),
+  1 - the structure-of-arrays engine (MM_Engine). Both give the same energies and forces.
+*/
+
+  if(backend_!=0 && backend_!=1){
+    cout<<"Error in listHamiltonian_MM::set_backend: backend = "<<backend_<<" is not known. Use 0 (objects) or 1 (SoA engine)\n";
+    exit(0);
+  }
+  backend = backend_;
+  engine.is_built = 0;
+
+}
+
+void listHamiltonian_MM::build_engine(){
+/**
+  Packs the current list of interactions into the SoA engine. This is done automatically on first use or when the number
+  of interactions changes, but needs to be called explicitly after (de)activation or re-parameterization of the existing
+  interactions
+*/
+
+  engine.build(interactions);
+
+}
+
+double listHamiltonian_MM::calculate(){
+/**
+  Computes all interactions with the selected back-end, adds the forces to the atoms and returns the total MM energy.
+  With the SoA back-end the total atomic, fragment and molecular stress are also stored in stress_at, stress_fr and stress_ml
+*/
+
+  double res = 0.0;
+
+  if(backend==1){
+    res = engine.compute(interactions, stress_at, stress_fr, stress_ml);
+    is_stress_at = is_stress_fr = is_stress_ml = engine.is_stress;
+  }
+  else{
+    int sz = interactions.size();
+    int tmp;
+    for(int i=0;i<sz;i++){  res += interactions[i].calculate(tmp);  }
+  }
+
+  return res;
+}
+
+double listHamiltonian_MM::calculate_respa(int respa_type){
+/**
+  \param[in] respa_type The RESPA class of the interactions to compute: 0 - fast, 1 - medium, 2 - slow
+
+  Same as calculate(), but only the interactions of the given RESPA class (see set_respa_types) are computed. This is
+  what multiple-time-step integrators use to evaluate each force class at its own time step.
+*/
+
+  double res = 0.0;
+
+  if(backend==1){
+    res = engine.compute(interactions, stress_at, stress_fr, stress_ml, respa_type);
+    is_stress_at = is_stress_fr = is_stress_ml = engine.is_stress;
+  }
+  else{
+    int sz = interactions.size();
+    int tmp;
+    for(int i=0;i<sz;i++){
+      if(interactions[i].get_respa_type()==respa_type){  res += interactions[i].calculate(tmp);  }
+    }
+  }
+
+  return res;
+}
+
+
+
+}// namespace libhamiltonian_mm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
@@ -336,6 +336,12 @@ void export_Hamiltonian_MM_objects(){
       .def("apply_pbc_to_interactions", &listHamiltonian_MM::apply_pbc_to_interactions)
       .def("set_respa_types", &listHamiltonian_MM::set_respa_types)
 
+      .def_readonly("backend", &listHamiltonian_MM::backend)
+      .def("set_backend", &listHamiltonian_MM::set_backend)
+      .def("build_engine", &listHamiltonian_MM::build_engine)
+      .def("calculate", &listHamiltonian_MM::calculate)
+      .def("calculate_respa", &listHamiltonian_MM::calculate_respa)
+
       .def("is_active", expt_is_active_v1)
       .def("is_active", expt_is_active_v2)
       .def("is_active", expt_is_active_v3)
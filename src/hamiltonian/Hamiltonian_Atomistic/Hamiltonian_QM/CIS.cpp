@@ -0,0 +1,579 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file CIS.cpp
+  \brief The file implements the Davidson solver for the CIS excited states, the transition densities
+  and the overlaps of the CIS states at different geometries
+*/
+
+#include <algorithm>
+#include "CIS.h"
+#include "Hamiltonian_INDO.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+static int cis_nvirt(Electronic_Structure& el, int spin, int nvirt){
+/**
+  The number of the active virtual orbitals: all the unoccupied (alpha, or beta for the spin-flip) orbitals
+  if nvirt is not positive or too large
+*/
+  int nv = el.Norb - ((spin==2) ? el.Nocc_bet : el.Nocc_alp);
+  return (nvirt>0 && nvirt<nv) ? nvirt : nv;
+}
+
+
+CIS::CIS(Electronic_Structure& el, int spin_, int nroots_, int nocc_, int nvirt_)
+: spin(spin_), nao(el.Norb), nocc_tot(el.Nocc_alp), nocc_tot_b(el.Nocc_bet),
+  nocc( (nocc_>0 && nocc_<el.Nocc_alp) ? nocc_ : el.Nocc_alp ),
+  nvirt( cis_nvirt(el, spin_, nvirt_) ),
+  nroots( std::min(std::max(nroots_, 1), nocc*nvirt) ),
+  max_iter(100), max_subspace(0), tol(1e-6), niter(0), converged(0),
+  e_occ(nocc, 1), e_virt(nvirt, 1), C_occ(nao, nocc_tot), C_occ_b(nao, nocc_tot_b), C_virt(nao, nvirt),
+  E(nroots, 1), X(nocc*nvirt, nroots){
+/**
+  \param[in] el The electronic structure of the reference (converged SCF): the orbitals and their energies
+  \param[in] spin_ The type of the excited states: 0 - singlets, 1 - triplets (both - for the closed-shell
+  reference), 2 - spin-flip states, alpha occupied -> beta virtual orbitals (for the high-spin reference)
+  \param[in] nroots_ The number of the lowest roots to find
+  \param[in] nocc_ The number of the highest occupied orbitals in the active space (0 - all)
+  \param[in] nvirt_ The number of the lowest virtual orbitals in the active space (0 - all)
+*/
+
+  if(spin<0 || spin>2){
+    cout<<"Error in CIS::CIS: spin = "<<spin<<" is not supported. Use 0 (singlets), 1 (triplets) or 2 (spin-flip)\n";
+    exit(0);
+  }
+  if(spin<2 && el.Nocc_alp!=el.Nocc_bet){
+    cout<<"Error in CIS::CIS: the singlet and triplet states need the closed-shell reference, but Nocc_alp = "
+        <<el.Nocc_alp<<" and Nocc_bet = "<<el.Nocc_bet<<"\n";
+    exit(0);
+  }
+  if(spin==2 && el.Nocc_alp<=el.Nocc_bet){
+    cout<<"Error in CIS::CIS: the spin-flip states need the high-spin reference (Nocc_alp > Nocc_bet)\n";
+    exit(0);
+  }
+  if(nocc*nvirt<=0){
+    cout<<"Error in CIS::CIS: the active space is empty: nocc = "<<nocc<<" nvirt = "<<nvirt<<"\n";
+    exit(0);
+  }
+
+  // The restricted reference is described by the alpha orbitals only
+  MATRIX* Cv = (spin==2) ? el.C_bet : el.C_alp;
+  MATRIX* Ev = (spin==2) ? el.E_bet : el.E_alp;
+  MATRIX* Cb = (spin==2) ? el.C_bet : el.C_alp;
+  int off = nocc_tot - nocc;
+  int v0 = (spin==2) ? nocc_tot_b : nocc_tot;
+
+  for(int mu=0;mu<nao;mu++){
+    for(int i=0;i<nocc_tot;i++){   C_occ.M[mu*nocc_tot+i] = el.C_alp->get(mu, i);  }
+    for(int i=0;i<nocc_tot_b;i++){ C_occ_b.M[mu*nocc_tot_b+i] = Cb->get(mu, i);  }
+    for(int a=0;a<nvirt;a++){      C_virt.M[mu*nvirt+a] = Cv->get(mu, v0+a);  }
+  }
+  for(int i=0;i<nocc;i++){  e_occ.M[i] = el.E_alp->get(off+i, off+i);  }
+  for(int a=0;a<nvirt;a++){ e_virt.M[a] = Ev->get(v0+a, v0+a);  }
+
+}
+
+
+void CIS::setup_integrals(System& syst, vector<AO>& basis_ao, Control_Parameters& prms, Model_Parameters& modprms,
+                          vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the quantum mechanical calculations (prms.hamiltonian)
+  \param[in] modprms The parameters of the atomistic Hamiltonian: the HF integrals or the INDO parameters
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+
+  Collects the list of the nonzero ERIs (mu nu|lam sig) of the same Hamiltonian that is used to build the
+  Fock matrix: all the stored integrals for the HF, the ZDO integrals (including the one-center exchange
+  ones) for the INDO, none for the EHT.
+*/
+
+  eri_idx.clear();
+  eri_val.clear();
+
+  if(prms.hamiltonian=="hf"){
+
+    int nint = modprms.hf_int.size();
+    for(int n=0;n<nint;n++){
+      int a,b,c,d;
+      double J_abcd, K_adcb;
+      modprms.hf_int.get_JK_element(n,a,b,c,d,J_abcd,K_adcb);
+      if(a>=0 && a<nao && b>=0 && b<nao && c>=0 && c<nao && d>=0 && d<nao && J_abcd!=0.0){
+        eri_idx.push_back(a); eri_idx.push_back(b); eri_idx.push_back(c); eri_idx.push_back(d);
+        eri_val.push_back(J_abcd);
+      }
+    }// for n
+
+  }
+  else if(prms.hamiltonian=="indo"){
+
+    int nat = syst.Number_of_atoms;
+    if(modprms.eri.size()<nat*nat){
+      cout<<"Error in CIS::setup_integrals: the INDO core parameters (modprms.eri) are not computed\n";
+      exit(0);
+    }
+
+    for(int i=0;i<nao;i++){
+      int a = ao_to_atom_map[i];
+      double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
+      double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
+
+      for(int k=0;k<nao;k++){
+        int b = ao_to_atom_map[k];
+
+        if(a==b){
+          double ii_kk, ik_ik; ii_kk = ik_ik = 0.0;
+          get_integrals(i,k,basis_ao,modprms.eri[a*nat+a],G1,F2,ii_kk,ik_ik);
+
+          eri_idx.push_back(i); eri_idx.push_back(i); eri_idx.push_back(k); eri_idx.push_back(k);
+          eri_val.push_back(ii_kk);
+
+          if(i!=k){  // one-center exchange: (ik|ik) = (ik|ki)
+            eri_idx.push_back(i); eri_idx.push_back(k); eri_idx.push_back(i); eri_idx.push_back(k);
+            eri_val.push_back(ik_ik);
+            eri_idx.push_back(i); eri_idx.push_back(k); eri_idx.push_back(k); eri_idx.push_back(i);
+            eri_val.push_back(ik_ik);
+          }
+        }
+        else{
+          eri_idx.push_back(i); eri_idx.push_back(i); eri_idx.push_back(k); eri_idx.push_back(k);
+          eri_val.push_back(modprms.eri[a*nat+b]);
+        }
+
+      }// for k
+    }// for i
+
+  }
+  else if(prms.hamiltonian=="eht"){  ;;  }
+  else{
+    cout<<"Error in CIS::setup_integrals: the Hamiltonian "<<prms.hamiltonian<<" is not supported. Use hf, indo or eht\n";
+    exit(0);
+  }
+
+}
+
+
+void CIS::sigma(vector<double>& x, vector<double>& s){
+/**
+  \param[in] x The trial vector: x[i*nvirt+a]
+  \param[out] s The product of the CIS matrix with the trial vector
+
+  s_ia = (e_a - e_i) x_ia + [ C_occ^T (c_J J[D] - K[D]) C_virt ]_ia,  D = C_occ x C_virt^T
+
+  with J[D]_mn = sum_ls (mn|ls) D_ls  and  K[D]_ml = sum_ns (mn|ls) D_ns
+*/
+
+  int off = nocc_tot - nocc;
+  int nint = eri_val.size();
+  double cJ = (spin==0) ? 2.0 : 0.0;
+
+  for(int i=0;i<nocc;i++){
+    for(int a=0;a<nvirt;a++){  s[i*nvirt+a] = (e_virt.M[a] - e_occ.M[i]) * x[i*nvirt+a];  }
+  }
+  if(nint==0){ return; }
+
+  const double* Co = C_occ.M;
+  const double* Cv = C_virt.M;
+
+  // The transition density in the AO basis
+  vector<double> T(nao*nvirt, 0.0);
+  vector<double> D(nao*nao, 0.0);
+
+  for(int mu=0;mu<nao;mu++){
+    for(int i=0;i<nocc;i++){
+      double c = Co[mu*nocc_tot+off+i];
+      if(c==0.0){ continue; }
+      for(int a=0;a<nvirt;a++){  T[mu*nvirt+a] += c * x[i*nvirt+a];  }
+    }
+  }
+  for(int mu=0;mu<nao;mu++){
+    for(int nu=0;nu<nao;nu++){
+      double sum = 0.0;
+      for(int a=0;a<nvirt;a++){  sum += T[mu*nvirt+a] * Cv[nu*nvirt+a];  }
+      D[mu*nao+nu] = sum;
+    }
+  }
+
+  // Coulomb and exchange parts
+  vector<double> F(nao*nao, 0.0);
+  for(int n=0;n<nint;n++){
+    const int* id = &eri_idx[4*n];
+    double v = eri_val[n];
+    if(cJ!=0.0){  F[id[0]*nao+id[1]] += cJ * v * D[id[2]*nao+id[3]];  }
+    F[id[0]*nao+id[2]] -= v * D[id[1]*nao+id[3]];
+  }
+
+  // Back to the MO basis
+  vector<double> G(nao*nvirt, 0.0);
+  for(int mu=0;mu<nao;mu++){
+    for(int nu=0;nu<nao;nu++){
+      double f = F[mu*nao+nu];
+      if(f==0.0){ continue; }
+      for(int a=0;a<nvirt;a++){  G[mu*nvirt+a] += f * Cv[nu*nvirt+a];  }
+    }
+  }
+  for(int mu=0;mu<nao;mu++){
+    for(int i=0;i<nocc;i++){
+      double c = Co[mu*nocc_tot+off+i];
+      if(c==0.0){ continue; }
+      for(int a=0;a<nvirt;a++){  s[i*nvirt+a] += c * G[mu*nvirt+a];  }
+    }
+  }
+
+}
+
+
+static double cis_dot(vector<double>& x, vector<double>& y){
+  double sum = 0.0;
+  for(int n=0;n<x.size();n++){  sum += x[n]*y[n];  }
+  return sum;
+}
+
+
+void CIS::solve(System& syst, vector<AO>& basis_ao, Control_Parameters& prms, Model_Parameters& modprms,
+                vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the quantum mechanical calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+
+  Finds the nroots lowest excitation energies (E) and the CI vectors (X) by the Davidson method. The initial
+  guesses are the lowest orbital energy differences; the corrections are preconditioned by the diagonal
+  (e_a - e_i). The products with the new trial vectors are computed in parallel, prms.fock_nthreads threads.
+  If the subspace grows above max_subspace, it is collapsed to the current Ritz vectors.
+*/
+
+  setup_integrals(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map);
+
+  int nov = nocc*nvirt;
+  int nth = fock_num_threads(prms);
+
+  int msub = (max_subspace>0) ? max_subspace : std::max(8*nroots, 40);
+  msub = std::min(std::max(msub, 2*nroots), nov);
+
+  vector<double> diag(nov, 0.0);
+  vector<int> order(nov, 0);
+  for(int i=0;i<nocc;i++){
+    for(int a=0;a<nvirt;a++){  diag[i*nvirt+a] = e_virt.M[a] - e_occ.M[i];  order[i*nvirt+a] = i*nvirt+a; }
+  }
+  std::stable_sort(order.begin(), order.end(), [&diag](int p, int q){ return diag[p] < diag[q]; });
+
+
+  // Initial guesses: the unit vectors of the lowest orbital energy differences
+  vector< vector<double> > V, S;
+  int nguess = std::min(2*nroots, msub);
+  for(int k=0;k<nguess;k++){
+    V.push_back(vector<double>(nov, 0.0));
+    V[k][order[k]] = 1.0;
+  }
+
+  vector<double> theta(nroots, 0.0);
+  vector< vector<double> > ritz(nroots, vector<double>(nov, 0.0));
+  vector< vector<double> > sritz(nroots, vector<double>(nov, 0.0));
+
+  niter = 0;
+  converged = 0;
+
+  while(niter<max_iter){
+
+    // Products with the new trial vectors
+    int nold = S.size();
+    int m = V.size();
+    for(int k=nold;k<m;k++){ S.push_back(vector<double>(nov, 0.0)); }
+
+    #pragma omp parallel for schedule(dynamic) num_threads(nth) if(nth>1)
+    for(int k=nold;k<m;k++){  sigma(V[k], S[k]);  }
+
+
+    // Subspace problem
+    MATRIX G(m, m), I(m, m), ev(m, m), U(m, m);
+    I.Init_Unit_Matrix(1.0);
+    for(int p=0;p<m;p++){
+      for(int q=p;q<m;q++){
+        double g = 0.5*(cis_dot(V[p], S[q]) + cis_dot(V[q], S[p]));
+        G.M[p*m+q] = G.M[q*m+p] = g;
+      }
+    }
+    solve_eigen(G, I, ev, U, 0);
+
+
+    // Ritz vectors and the residuals
+    vector< vector<double> > corr;
+    for(int k=0;k<nroots;k++){
+      theta[k] = ev.M[k*m+k];
+
+      for(int n=0;n<nov;n++){ ritz[k][n] = sritz[k][n] = 0.0; }
+      for(int p=0;p<m;p++){
+        double u = U.M[p*m+k];
+        for(int n=0;n<nov;n++){  ritz[k][n] += u*V[p][n];  sritz[k][n] += u*S[p][n];  }
+      }
+
+      vector<double> r(nov, 0.0);
+      double rnorm = 0.0;
+      for(int n=0;n<nov;n++){  r[n] = sritz[k][n] - theta[k]*ritz[k][n];  rnorm += r[n]*r[n];  }
+
+      if(sqrt(rnorm)>tol){
+        for(int n=0;n<nov;n++){
+          double den = theta[k] - diag[n];
+          if(fabs(den)<1e-8){ den = (den<0.0) ? -1e-8 : 1e-8; }
+          r[n] /= den;
+        }
+        corr.push_back(r);
+      }
+    }// for k
+
+    niter++;
+    if(corr.size()==0){ converged = 1; break; }
+
+
+    // Collapse the subspace to the Ritz vectors, if needed
+    if(m + corr.size() > msub){
+      V = ritz;
+      S = sritz;
+    }
+
+
+    // Orthonormalize the corrections and extend the subspace
+    int nadd = 0;
+    for(int c=0;c<corr.size();c++){
+      vector<double>& t = corr[c];
+      double nrm = sqrt(cis_dot(t, t));
+      if(nrm==0.0){ continue; }
+      for(int n=0;n<nov;n++){ t[n] /= nrm; }
+
+      for(int pass=0;pass<2;pass++){
+        for(int p=0;p<V.size();p++){
+          double proj = cis_dot(V[p], t);
+          for(int n=0;n<nov;n++){ t[n] -= proj*V[p][n]; }
+        }
+      }
+
+      nrm = sqrt(cis_dot(t, t));
+      if(nrm>1e-3 && V.size()<nov){
+        for(int n=0;n<nov;n++){ t[n] /= nrm; }
+        V.push_back(t);
+        nadd++;
+      }
+    }// for c
+
+    if(nadd==0){ break; }   // the subspace can not be extended any more
+
+  }// while
+
+
+  for(int k=0;k<nroots;k++){
+    E.M[k] = theta[k];
+    for(int n=0;n<nov;n++){  X.M[n*nroots+k] = ritz[k][n];  }
+  }
+
+}
+
+
+MATRIX CIS::transition_density(int root){
+/**
+  \param[in] root The index of the excited state
+
+  Returns the nao x nao transition density matrix between the reference and the excited state root:
+  D = f * C_occ * X_root * C_virt^T, with f = sqrt(2) for the singlets (summed over the spins) and
+  f = 1 for the triplets and the spin-flip states (one spin component).
+*/
+
+  if(root<0 || root>=nroots){
+    cout<<"Error in CIS::transition_density: root = "<<root<<" is out of range [0, "<<nroots<<")\n";
+    exit(0);
+  }
+
+  int off = nocc_tot - nocc;
+  double f = (spin==0) ? sqrt(2.0) : 1.0;
+
+  MATRIX T(nao, nvirt);
+  for(int mu=0;mu<nao;mu++){
+    for(int i=0;i<nocc;i++){
+      double c = f * C_occ.M[mu*nocc_tot+off+i];
+      for(int a=0;a<nvirt;a++){  T.M[mu*nvirt+a] += c * X.M[(i*nvirt+a)*nroots+root];  }
+    }
+  }
+
+  MATRIX D(nao, nao);
+  D = T * C_virt.T();
+
+  return D;
+}
+
+
+MATRIX CIS::transition_dipoles(MATRIX& mux, MATRIX& muy, MATRIX& muz){
+/**
+  \param[in] mux, muy, muz The matrices of the dipole moment components in the AO basis
+
+  Returns the nroots x 4 matrix: the components of the transition dipole moments from the reference to each
+  state (columns 0, 1, 2) and the oscillator strengths f = 2/3 * E * |mu|^2 (column 3). The transitions to
+  the triplet and spin-flip states are spin-forbidden, so all the values are zero for them.
+*/
+
+  MATRIX res(nroots, 4);
+  if(spin!=0){ return res; }
+
+  for(int k=0;k<nroots;k++){
+    MATRIX D(transition_density(k));
+
+    double m[3] = {0.0, 0.0, 0.0};
+    for(int n=0;n<nao*nao;n++){
+      m[0] += D.M[n]*mux.M[n];
+      m[1] += D.M[n]*muy.M[n];
+      m[2] += D.M[n]*muz.M[n];
+    }
+
+    res.M[k*4+0] = m[0];
+    res.M[k*4+1] = m[1];
+    res.M[k*4+2] = m[2];
+    res.M[k*4+3] = (2.0/3.0) * E.M[k] * (m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+  }
+
+  return res;
+}
+
+
+static MATRIX cis_full_vector(CIS& cis, int root){
+/**
+  The CI vector of the root as the nocc_tot x nvirt matrix (zero rows for the frozen occupied orbitals)
+*/
+  MATRIX x(cis.nocc_tot, cis.nvirt);
+  int off = cis.nocc_tot - cis.nocc;
+  for(int i=0;i<cis.nocc;i++){
+    for(int a=0;a<cis.nvirt;a++){  x.M[(off+i)*cis.nvirt+a] = cis.X.M[(i*cis.nvirt+a)*cis.nroots+root];  }
+  }
+  return x;
+}
+
+
+MATRIX cis_overlaps(CIS& cis_old, CIS& cis_new, MATRIX& S_ao){
+/**
+  \param[in] cis_old The CIS states at the time t
+  \param[in] cis_new The CIS states at the time t + dt
+  \param[in] S_ao The overlaps of the AOs at the two times: <AO(t)|AO(t+dt)>
+
+  Returns the (nroots_old + 1) x (nroots_new + 1) matrix of the overlaps <I(t)|J(t+dt)> of the many-electron
+  states, the index 0 being the reference (ground) state. The time-derivative couplings follow as
+  d_IJ = (<I(t)|J(t+dt)> - <J(t)|I(t+dt)>)/(2 dt).
+
+  With O = C_occ^T S_ao C_occ', W = O^-1, P = S_vo' W, Q = W S_ov' and T = S_vv' - S_vo' W S_ov', the overlap
+  of the singly-substituted determinants of the same spin is det(O) (W_ji T_ab + P_ai Q_jb), and
+  det(O) P_ai and det(O) Q_jb are the overlaps of the substituted and the reference determinants. So no
+  determinant has to be computed for every pair of the configurations.
+*/
+
+  if(cis_old.spin!=cis_new.spin || cis_old.nao!=cis_new.nao ||
+     cis_old.nocc_tot!=cis_new.nocc_tot || cis_old.nocc_tot_b!=cis_new.nocc_tot_b){
+    cout<<"Error in cis_overlaps: the two CIS objects are not compatible\n";
+    exit(0);
+  }
+  if(S_ao.n_rows!=cis_old.nao || S_ao.n_cols!=cis_new.nao){
+    cout<<"Error in cis_overlaps: S_ao must be "<<cis_old.nao<<" x "<<cis_new.nao<<"\n";
+    exit(0);
+  }
+
+  int n0 = cis_old.nroots, n1 = cis_new.nroots;
+  int no = cis_old.nocc_tot;
+  MATRIX res(n0+1, n1+1);
+
+
+  // The occupied orbitals of the spin that loses an electron (alpha for the spin-flip states)
+  MATRIX O(cis_old.C_occ.T() * S_ao * cis_new.C_occ);
+  double d = FullPivLU_det(O);
+  if(fabs(d)<1e-12){ return res; }  // the references are orthogonal, so are all the states
+  MATRIX W(no, no);
+  FullPivLU_inverse(O, W);
+
+  // The occupied orbitals of the spin that gains an electron (the same as above for the restricted reference)
+  int spin = cis_old.spin;
+  int nb = (spin==2) ? cis_old.nocc_tot_b : no;
+  MATRIX* Cb_old = (spin==2) ? &cis_old.C_occ_b : &cis_old.C_occ;
+  MATRIX* Cb_new = (spin==2) ? &cis_new.C_occ_b : &cis_new.C_occ;
+
+  double d_b = d;
+  MATRIX W_b(nb, nb);
+  if(spin!=2){ W_b = W; }
+  else{
+    MATRIX O_b(Cb_old->T() * S_ao * (*Cb_new));
+    d_b = FullPivLU_det(O_b);
+    if(fabs(d_b)<1e-12){ return res; }
+    FullPivLU_inverse(O_b, W_b);
+  }
+
+  MATRIX S_vo(cis_old.C_virt.T() * S_ao * (*Cb_new));
+  MATRIX S_ov(Cb_old->T() * S_ao * cis_new.C_virt);
+  MATRIX S_vv(cis_old.C_virt.T() * S_ao * cis_new.C_virt);
+  MATRIX P(S_vo * W_b);
+  MATRIX Q(W_b * S_ov);
+  MATRIX T(S_vv - S_vo * Q);
+
+  double dd = d * d_b;
+  res.M[0] = dd;
+
+  // <I|J> = dd * sum X_ia X'_jb W_ji T_ab  (+ the opposite-spin terms for the singlets)
+  vector<MATRIX> x_old, y_new;
+  vector<double> p_old(n0, 0.0), q_new(n1, 0.0);
+
+  for(int I=0;I<n0;I++){
+    x_old.push_back(cis_full_vector(cis_old, I));
+    if(spin!=0){ continue; }
+    for(int i=0;i<no;i++){
+      for(int a=0;a<cis_old.nvirt;a++){  p_old[I] += x_old[I].M[i*cis_old.nvirt+a] * P.M[a*no+i];  }
+    }
+  }
+  for(int J=0;J<n1;J++){
+    MATRIX x(cis_full_vector(cis_new, J));
+    y_new.push_back(W.T() * x * T.T());
+    if(spin==0){
+      for(int n=0;n<no*cis_new.nvirt;n++){  q_new[J] += Q.M[n] * x.M[n];  }
+    }
+  }
+
+  for(int I=0;I<n0;I++){
+    for(int J=0;J<n1;J++){
+      double t1 = 0.0;
+      for(int n=0;n<no*cis_old.nvirt;n++){  t1 += x_old[I].M[n] * y_new[J].M[n];  }
+
+      if(spin==0){      res.M[(I+1)*(n1+1)+J+1] = dd * (t1 + 2.0*p_old[I]*q_new[J]);  }
+      else{             res.M[(I+1)*(n1+1)+J+1] = dd * t1;  }
+    }
+  }
+
+  if(spin==0){
+    for(int I=0;I<n0;I++){ res.M[(I+1)*(n1+1)] = sqrt(2.0) * dd * p_old[I]; }
+    for(int J=0;J<n1;J++){ res.M[J+1] = sqrt(2.0) * dd * q_new[J]; }
+  }
+
+  return res;
+}
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
@@ -0,0 +1,105 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file CIS.h
+  \brief The file describes the configuration interaction singles (CIS, Tamm-Dancoff) excited states
+  on top of the HF, INDO and EHT reference determinants
+
+  The lowest roots are found by the Davidson method. The products of the CIS matrix with the trial vectors
+  are done in the AO basis, with the Coulomb and exchange matrices of the transition densities
+  D = C_occ * X * C_virt^T built from the same integrals as the Fock matrices:
+
+  sigma_ia = (e_a - e_i) * X_ia + [ C_occ^T * (c_J * J[D] - K[D]) * C_virt ]_ia
+
+  with c_J = 2 for the singlets, 0 for the triplets and the spin-flip states (alpha occupied -> beta virtual
+  orbitals of a high-spin reference).
+*/
+
+#ifndef CIS_H
+#define CIS_H
+
+#include "Electronic_Structure.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+class CIS{
+/**
+  The CIS excited states of one reference (one MD step): the orbitals, the excitation energies and the CI vectors.
+
+  The active space is made of the highest nocc occupied and the lowest nvirt virtual orbitals. The CI vector of
+  the root k is the column k of X, with the element (i, a) in the row i*nvirt + a. All the occupied orbitals
+  (also the frozen ones) are kept, since they are needed for the overlaps of the states at different geometries.
+*/
+
+  vector<int> eri_idx;          ///< the indices (mu, nu, lam, sig) of the nonzero ERIs, 4 per integral
+  vector<double> eri_val;       ///< the values of the nonzero ERIs (mu nu|lam sig)
+
+  void setup_integrals(System& syst, vector<AO>& basis_ao, Control_Parameters& prms, Model_Parameters& modprms,
+                       vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map);
+  void sigma(vector<double>& x, vector<double>& s);
+
+public:
+
+  int spin;             ///< 0 - singlets, 1 - triplets, 2 - spin-flip (alpha -> beta) states
+  int nao;              ///< the number of AOs
+  int nocc_tot;         ///< the number of the occupied (alpha) orbitals
+  int nocc_tot_b;       ///< the number of the occupied beta orbitals
+  int nocc;             ///< the number of the active occupied orbitals
+  int nvirt;            ///< the number of the active virtual orbitals
+  int nroots;           ///< the number of the roots
+
+  int max_iter;         ///< the maximal number of the Davidson iterations
+  int max_subspace;     ///< the maximal size of the Davidson subspace (0 - automatic)
+  double tol;           ///< the convergence threshold on the norms of the residuals
+  int niter;            ///< the number of the iterations done
+  int converged;        ///< 1 - all the roots are converged
+
+  MATRIX e_occ;         ///< nocc x 1: the energies of the active occupied orbitals
+  MATRIX e_virt;        ///< nvirt x 1: the energies of the active virtual orbitals
+  MATRIX C_occ;         ///< nao x nocc_tot: all the occupied (alpha) orbitals
+  MATRIX C_occ_b;       ///< nao x nocc_tot_b: all the occupied beta orbitals
+  MATRIX C_virt;        ///< nao x nvirt: the active virtual orbitals (beta for the spin-flip states)
+  MATRIX E;             ///< nroots x 1: the excitation energies
+  MATRIX X;             ///< (nocc*nvirt) x nroots: the CI vectors
+
+
+  CIS(Electronic_Structure& el, int spin_, int nroots_, int nocc_, int nvirt_);
+
+  void solve(System& syst, vector<AO>& basis_ao, Control_Parameters& prms, Model_Parameters& modprms,
+             vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map);
+
+  MATRIX transition_density(int root);
+  MATRIX transition_dipoles(MATRIX& mux, MATRIX& muy, MATRIX& muz);
+
+};
+
+
+MATRIX cis_overlaps(CIS& cis_old, CIS& cis_new, MATRIX& S_ao);
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
+#endif // CIS_H
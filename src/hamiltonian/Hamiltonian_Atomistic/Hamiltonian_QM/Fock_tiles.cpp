@@ -0,0 +1,92 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Fock_tiles.cpp
+  \brief The file implements the atom-block decomposition used for the multithreaded Fock matrix builds
+*/
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include "Fock_tiles.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+Fock_tiles::Fock_tiles(vector<int>& ao_to_atom_map, int nat){
+/**
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] nat The number of atoms
+
+  The tiles are built from ao_to_atom_map, so every row belongs to exactly one tile. Atoms without AOs give no tiles.
+*/
+
+  int Norb = ao_to_atom_map.size();
+
+  rows = vector< vector<int> >(nat);
+
+  for(int i=0;i<Norb;i++){
+    int a = ao_to_atom_map[i];
+    if(a<0 || a>=nat){
+      cout<<"Error in Fock_tiles: AO "<<i<<" is mapped to the atom "<<a<<", but there are only "<<nat<<" atoms\n"; exit(0);
+    }
+    rows[a].push_back(i);
+  }
+
+  vector< pair<int,int> > sz;  // (-size, atom) - sorting gives the larger tiles first, the ties in the order of atoms
+  for(int a=0;a<nat;a++){
+    if(rows[a].size()>0){  sz.push_back( pair<int,int>(-(int)rows[a].size(), a) );  }
+  }
+  std::sort(sz.begin(), sz.end());
+
+  order = vector<int>(sz.size());
+  for(int t=0;t<sz.size();t++){  order[t] = sz[t].second;  }
+
+}
+
+
+int fock_num_threads(Control_Parameters& prms){
+/**
+  \param[in] prms The parameters controlling the calculations: prms.fock_nthreads
+
+  Returns the number of threads to use for the Fock matrix build: prms.fock_nthreads if positive, all
+  available threads (OMP_NUM_THREADS) if 0. Always 1 if the library is compiled without OpenMP.
+*/
+
+  int nth = 1;
+
+#ifdef _OPENMP
+  nth = (prms.fock_nthreads>0) ? prms.fock_nthreads : omp_get_max_threads();
+#endif
+
+  return nth;
+}
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
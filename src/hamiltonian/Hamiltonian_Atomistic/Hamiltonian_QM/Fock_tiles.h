@@ -0,0 +1,69 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Fock_tiles.h
+  \brief The file describes the atom-block decomposition used for the multithreaded Fock matrix builds
+
+  Each tile owns the rows of the Fock matrix that belong to the AOs of one atom. A tile is processed by a
+  single thread, and each Fock matrix element is accumulated by the owner of its row in the same order as
+  in the serial code. So no reduction between the threads is needed and the Fock matrix does not depend on
+  the number of threads - it is the same bit for bit.
+*/
+
+#ifndef FOCK_TILES_H
+#define FOCK_TILES_H
+
+#include "../../../control_parameters/libcontrol_parameters.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libcontrol_parameters;
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+class Fock_tiles{
+/**
+  The partition of the AO indices (rows of the Fock matrix) into the atom blocks
+*/
+
+public:
+
+  vector< vector<int> > rows;   ///< rows[t] - the indices of the AOs owned by the tile t (in increasing order)
+  vector<int> order;            ///< the order in which the tiles are dispatched: larger tiles first, for the load balance
+
+  Fock_tiles(vector<int>& ao_to_atom_map, int nat);
+
+  int size(){ return order.size(); }
+  vector<int>& tile(int t){ return rows[order[t]]; }  ///< the rows of the t-th dispatched tile
+
+};
+
+
+int fock_num_threads(Control_Parameters& prms);
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
+#endif // FOCK_TILES_H
@@ -320,7 +320,8 @@ void Hamiltonian_core_deriv_eht
 
 
           VECTOR dSda, dSdb, dSdc;
-          double sao_ij = gaussian_overlap(&basis_ao[i],&basis_ao[j], 1, 1, dSda, dSdb);
+          double sao_ij = (modprms.int_cache!=NULL) ? modprms.int_cache->overlap(basis_ao[i],basis_ao[j], 1, dSda, dSdb)
+                                                    : gaussian_overlap(&basis_ao[i],&basis_ao[j], 1, 1, dSda, dSdb);
           // i - on atom a
           // j - on atom b
 
@@ -616,94 +617,87 @@ void Hamiltonian_Fock_eht(Electronic_Structure* el, System& syst, vector<AO>& ba
     }// for a
 
 
-    // Off-diagonal elements
-    double K_const = 0.0;// default value
-  
-    for(i=0;i<Norb;i++){
-      a = ao_to_atom_map[i];
-      for(j=i+1;j<Norb;j++){          
-          b = ao_to_atom_map[j];
-          // This is old and slow version
-          //K_const = modprms.eht_k.get_K_value(basis_ao[i].element,basis_ao[i].ao_shell,basis_ao[j].element,basis_ao[j].ao_shell);
-          K_const = modprms.meht_k.get_K_value(0,i,j);
+    // Orbital radii for the Calzaferi formula - computed once, before the threads start
+    vector<double> r_orb(Norb, 0.0);
+
+    if(prms.eht_formula==2){
+      for(i=0;i<Norb;i++){
+
+        std::string elt_i = basis_ao[i].element;
+        std::string sh_i  = basis_ao[i].ao_shell;
+
+        float n_i = modprms.PT[elt_i].Nquant[sh_i];
+        int nz_i  = modprms.PT[elt_i].Nzeta[sh_i];
+
+        if(nz_i==1){  r_orb[i] = (n_i/modprms.PT[elt_i].zetas[sh_i][0]); }
+        else if(nz_i==2){
+          double z1 = modprms.PT[elt_i].zetas[sh_i][0];
+          double z2 = modprms.PT[elt_i].zetas[sh_i][1];
+          double c1 = modprms.PT[elt_i].coeffs[sh_i][0];
+          double c2 = modprms.PT[elt_i].coeffs[sh_i][1];
+
+          r_orb[i] = n_i/(c1*c1*z1 + c2*c2*z2 + 
+                          ( pow(2.0,2.0*n_i)*pow(z1*z2, n_i+0.5)/pow((z1+z2),2.0*n_i)
+                          ) 
+                         ); 
+        }
+      }// for i
+    }// eht_formula==2
+
+
+    // Off-diagonal elements: the row i computes the elements (i,j) and (j,i) with j>i, so the rows are
+    // independent and are distributed over the threads in the atom blocks (see Fock_tiles.h)
+    double* F = el->Fao_alp->M;
+    double* S = el->Sao->M;
+
+    Fock_tiles tiles(ao_to_atom_map, syst.Number_of_atoms);
+    int nth = fock_num_threads(prms);
+
+    #pragma omp parallel for schedule(dynamic) num_threads(nth) if(nth>1)
+    for(int t=0;t<tiles.size();t++){
+
+      vector<int>& tile = tiles.tile(t);
+      int a = ao_to_atom_map[tile[0]];
+
+      for(int ii=0;ii<tile.size();ii++){
+        int i = tile[ii];
+
+        for(int j=i+1;j<Norb;j++){          
+          int b = ao_to_atom_map[j];
+          double K_const = modprms.meht_k.get_K_value(0,i,j);
+          double delt, delt2, delt4;
   
           if(prms.eht_formula==0){  // Unweighted formula
   
-            el->Fao_alp->M[i*Norb+j] = 0.5*K_const*(el->Fao_alp->M[i*Norb+i] + el->Fao_alp->M[j*Norb+j]) * el->Sao->M[i*Norb+j]; 
-            el->Fao_alp->M[j*Norb+i] = el->Fao_alp->M[i*Norb+j];
+            F[i*Norb+j] = 0.5*K_const*(F[i*Norb+i] + F[j*Norb+j]) * S[i*Norb+j]; 
+            F[j*Norb+i] = F[i*Norb+j];
           }
   
           else if(prms.eht_formula==1){  // Weighted formula:        
   
-            delt = (el->Fao_alp->M[i*Norb+i] - el->Fao_alp->M[j*Norb+j])/(el->Fao_alp->M[i*Norb+i] + el->Fao_alp->M[j*Norb+j]);
+            delt = (F[i*Norb+i] - F[j*Norb+j])/(F[i*Norb+i] + F[j*Norb+j]);
             delt2 = delt*delt;
             delt4 = delt2*delt2;
           
-            el->Fao_alp->M[i*Norb+j] = 0.5*(K_const + delt2 + (1.0 - K_const)*delt4)*(el->Fao_alp->M[i*Norb+i]+el->Fao_alp->M[j*Norb+j])*el->Sao->M[i*Norb+j];
-            el->Fao_alp->M[j*Norb+i] = el->Fao_alp->M[i*Norb+j];
+            F[i*Norb+j] = 0.5*(K_const + delt2 + (1.0 - K_const)*delt4)*(F[i*Norb+i]+F[j*Norb+j])*S[i*Norb+j];
+            F[j*Norb+i] = F[i*Norb+j];
   
           }
   
           else if(prms.eht_formula==2){  // Calzaferi formula:        
   
-            delt = (el->Fao_alp->M[i*Norb+i] - el->Fao_alp->M[j*Norb+j])/(el->Fao_alp->M[i*Norb+i] + el->Fao_alp->M[j*Norb+j]);
+            delt = (F[i*Norb+i] - F[j*Norb+j])/(F[i*Norb+i] + F[j*Norb+j]);
             delt2 = delt*delt;
             delt4 = delt2*delt2;
             
             double rab = (syst.Atoms[a].Atom_RB.rb_cm - syst.Atoms[b].Atom_RB.rb_cm).length();
             double delta = 0.13;
-  
-  
-            std::string elt_i = basis_ao[i].element;
-            std::string elt_j = basis_ao[j].element;
-            std::string sh_i  = basis_ao[i].ao_shell;
-            std::string sh_j  = basis_ao[j].ao_shell;
-  
-  
-            float n_i = modprms.PT[elt_i].Nquant[sh_i];
-            float n_j = modprms.PT[elt_j].Nquant[sh_j];
-            int nz_i  = modprms.PT[elt_i].Nzeta[sh_i];
-            int nz_j  = modprms.PT[elt_j].Nzeta[sh_j];
-  
-            double ri, rj;  // radii
-  
-            // for atom i 
-            if(nz_i==1){  ri = (n_i/modprms.PT[elt_i].zetas[sh_i][0]); }
-            else if(nz_i==2){
-              double z1 = modprms.PT[elt_i].zetas[sh_i][0];
-              double z2 = modprms.PT[elt_i].zetas[sh_i][1];
-              double c1 = modprms.PT[elt_i].coeffs[sh_i][0];
-              double c2 = modprms.PT[elt_i].coeffs[sh_i][1];
-  
-              ri = n_i/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_i)*pow(z1*z2, n_i+0.5)/pow((z1+z2),2.0*n_i)
-                         ) 
-                       ); 
-  
-            }
-  
-            // for atom j
-            if(nz_j==1){  rj = (n_j/modprms.PT[elt_j].zetas[sh_j][0]); }
-            else if(nz_j==2){
-              double z1 = modprms.PT[elt_j].zetas[sh_j][0];
-              double z2 = modprms.PT[elt_j].zetas[sh_j][1];
-              double c1 = modprms.PT[elt_j].coeffs[sh_j][0];
-              double c2 = modprms.PT[elt_j].coeffs[sh_j][1];
-  
-              rj = n_j/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_j)*pow(z1*z2, n_j+0.5)/pow((z1+z2),2.0*n_j)
-                         ) 
-                       ); 
-  
-            }
-  
-                                               
-            double d0 = ri + rj;    
+            double d0 = r_orb[i] + r_orb[j];    
   
             K_const = 1.0 + (0.75 + delt2 - 0.75*delt4)*exp(-delta*(rab - d0));
           
-            el->Fao_alp->M[i*Norb+j] = 0.5*K_const*(el->Fao_alp->M[i*Norb+i]+el->Fao_alp->M[j*Norb+j])*el->Sao->M[i*Norb+j];
-            el->Fao_alp->M[j*Norb+i] = el->Fao_alp->M[i*Norb+j];
+            F[i*Norb+j] = 0.5*K_const*(F[i*Norb+i]+F[j*Norb+j])*S[i*Norb+j];
+            F[j*Norb+i] = F[i*Norb+j];
   
           }
   
@@ -712,9 +706,9 @@ void Hamiltonian_Fock_eht(Electronic_Structure* el, System& syst, vector<AO>& ba
   
           }// ==3
        
-      }// for bj
-    }// for i
-
+        }// for j
+      }// for ii
+    }// for t
 
     // So far we have computed only Fao_alp
     *el->Fao_bet = *el->Fao_alp;
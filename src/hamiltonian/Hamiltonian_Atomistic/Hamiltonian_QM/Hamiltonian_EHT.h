@@ -17,6 +17,7 @@
 #define HAMILTONIAN_EHT_H
 
 #include "Electronic_Structure.h"
+#include "Fock_tiles.h"
 
 /// liblibra namespace
 namespace liblibra{
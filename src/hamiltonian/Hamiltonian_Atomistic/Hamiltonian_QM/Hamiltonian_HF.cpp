@@ -13,6 +13,7 @@
   \brief The file implements functions for Hartree-Fock (HF) calculations
 */
 
+#include <algorithm>
 #include "Hamiltonian_HF.h"
 
 /// liblibra namespace
@@ -154,29 +155,63 @@ void Hamiltonian_Fock_hf(Electronic_Structure* el, System& syst, vector<AO>& bas
 
 
   // Formation of the Fock matrix: add Coulomb and Exchange parts
+  //  F_ab += P_cd * (ab|cd) - P_alp_cd*(ad|cb)
+  // Only the stored integrals contribute (get_JK_values gives zeros for all others), so the stored list is
+  // bucketed by the row index a. Each bucket is sorted by (b, c, d), so every row takes its contributions
+  // in the same order as the serial loop over b, c, d, whatever the order of storage is
+  int nint = modprms.hf_int.size();
+  vector< vector< pair<long,int> > > row_keys(Norb);
+
+  for(int n=0;n<nint;n++){
+    double J_abcd,K_adcb;
+    modprms.hf_int.get_JK_element(n,a,b,c,d,J_abcd,K_adcb);
+    if(a>=0 && a<Norb && b>=0 && b<Norb && c>=0 && c<Norb && d>=0 && d<Norb){
+      row_keys[a].push_back(pair<long,int>((long(b)*Norb + c)*Norb + d, n));
+    }
+  }
+
+  vector< vector<int> > row_ints(Norb);
   for(a=0;a<Norb;a++){
-    for(b=0;b<Norb;b++){
-      for(c=0;c<Norb;c++){
-        for(d=0;d<Norb;d++){
-
-          //  (P_cd * (ab|cd) - P_alp_cd*(ad|cb))
-          double J_abcd,K_adcb;
-          modprms.hf_int.get_JK_values(a,b,c,d,J_abcd,K_adcb);
-
-          if(prms.use_rosh){
-            el->Fao_alp->M[a*Norb+b] += (el->P->M[c*Norb+d]*J_abcd - 0.5*el->P->M[c*Norb+d]*K_adcb);
-            el->Fao_bet->M[a*Norb+b] += (el->P->M[c*Norb+d]*J_abcd - 0.5*el->P->M[c*Norb+d]*K_adcb);
-          }
-          else{
-            el->Fao_alp->M[a*Norb+b] += (el->P->M[c*Norb+d]*J_abcd - el->P_alp->M[c*Norb+d]*K_adcb);
-            el->Fao_bet->M[a*Norb+b] += (el->P->M[c*Norb+d]*J_abcd - el->P_bet->M[c*Norb+d]*K_adcb);
-          }
-
-
-        }// for d
-      }// for c
-    }// for b
-  }// for a
+    std::sort(row_keys[a].begin(), row_keys[a].end());
+    for(int m=0;m<row_keys[a].size();m++){  row_ints[a].push_back(row_keys[a][m].second);  }
+  }
+
+  double* Fa = el->Fao_alp->M;
+  double* Fb = el->Fao_bet->M;
+  double* P  = el->P->M;
+  double* Pa = el->P_alp->M;
+  double* Pb = el->P_bet->M;
+
+  // Rows are distributed over the threads in the atom blocks (see Fock_tiles.h), so the result does not depend on the number of threads
+  Fock_tiles tiles(ao_to_atom_map, syst.Number_of_atoms);
+  int nth = fock_num_threads(prms);
+
+  #pragma omp parallel for schedule(dynamic) num_threads(nth) if(nth>1)
+  for(int t=0;t<tiles.size();t++){
+
+    vector<int>& tile = tiles.tile(t);
+
+    for(int ii=0;ii<tile.size();ii++){
+      int a = tile[ii];
+
+      for(int m=0;m<row_ints[a].size();m++){
+
+        int a1,b,c,d;
+        double J_abcd,K_adcb;
+        modprms.hf_int.get_JK_element(row_ints[a][m],a1,b,c,d,J_abcd,K_adcb);
+
+        if(prms.use_rosh){
+          Fa[a*Norb+b] += (P[c*Norb+d]*J_abcd - 0.5*P[c*Norb+d]*K_adcb);
+          Fb[a*Norb+b] += (P[c*Norb+d]*J_abcd - 0.5*P[c*Norb+d]*K_adcb);
+        }
+        else{
+          Fa[a*Norb+b] += (P[c*Norb+d]*J_abcd - Pa[c*Norb+d]*K_adcb);
+          Fb[a*Norb+b] += (P[c*Norb+d]*J_abcd - Pb[c*Norb+d]*K_adcb);
+        }
+
+      }// for m
+    }// for ii
+  }// for t
 
 }
 
@@ -18,6 +18,7 @@
 
 
 #include "Electronic_Structure.h"
+#include "Fock_tiles.h"
 
 
 /// liblibra namespace
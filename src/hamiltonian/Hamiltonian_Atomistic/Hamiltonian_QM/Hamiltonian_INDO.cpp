@@ -92,7 +92,8 @@ void compute_indo_core_parameters
   int J = sorb_indx[b];
      
   // ERI
-  eri = electron_repulsion_integral(basis_ao[I],basis_ao[I],basis_ao[J],basis_ao[J]); // eri[a][b]
+  if(modprms.int_cache!=NULL){  eri = modprms.int_cache->eri_ss(basis_ao[I],basis_ao[J]); } // from the tables
+  else{  eri = electron_repulsion_integral(basis_ao[I],basis_ao[I],basis_ao[J],basis_ao[J]); } // eri[a][b]
 
   // V_AB
   int B = b;
@@ -218,7 +219,15 @@ void compute_indo_core_parameters_derivs
 
   /// This version doesn't do memory re-allocation every time
 
-  double eri = electron_repulsion_integral(&basis_ao[I],&basis_ao[I],&basis_ao[J],&basis_ao[J],1,1,DA,DB,DC,DD, aux, n_aux, auxv, n_auxv);
+  double eri;
+  if(modprms.int_cache!=NULL){
+    // Only DA + DB and DC + DD are needed below, so keep them in DA and DC
+    eri = modprms.int_cache->eri_ss(basis_ao[I],basis_ao[J],1,DA,DC);
+    DB = 0.0;  DD = 0.0;
+  }
+  else{
+    eri = electron_repulsion_integral(&basis_ao[I],&basis_ao[I],&basis_ao[J],&basis_ao[J],1,1,DA,DB,DC,DD, aux, n_aux, auxv, n_auxv);
+  }
 
 
   VECTOR deri_dc; deri_dc = 0.0;
@@ -288,7 +297,15 @@ void compute_indo_core_parameters_derivs
   int I = sorb_indx[a];
   int J = sorb_indx[b];
 
-  double eri = electron_repulsion_integral(&basis_ao[I],&basis_ao[I],&basis_ao[J],&basis_ao[J],1,1,DA,DB,DC,DD, aux, n_aux, auxv, n_auxv);
+  double eri;
+  if(modprms.int_cache!=NULL){
+    // Only DA + DB and DC + DD are needed below, so keep them in DA and DC
+    eri = modprms.int_cache->eri_ss(basis_ao[I],basis_ao[J],1,DA,DC);
+    DB = 0.0;  DD = 0.0;
+  }
+  else{
+    eri = electron_repulsion_integral(&basis_ao[I],&basis_ao[I],&basis_ao[J],&basis_ao[J],1,1,DA,DB,DC,DD, aux, n_aux, auxv, n_auxv);
+  }
 
 
 
@@ -768,7 +785,8 @@ void Hamiltonian_core_indo
         else{           // centered on different atoms - use overlap formula
 
           // Overlap is set to identity in INDO, so need to recompute it explicitly
-          double sao_ij = gaussian_overlap(basis_ao[i],basis_ao[j]); // 0, dIdA,dIdB), mem->aux, mem->n_aux);
+          double sao_ij = (modprms.int_cache!=NULL) ? modprms.int_cache->overlap(basis_ao[i],basis_ao[j])
+                                                    : gaussian_overlap(basis_ao[i],basis_ao[j]); // 0, dIdA,dIdB), mem->aux, mem->n_aux);
 
           Hao->M[i*Norb+j] += 0.5*(modprms.PT[basis_ao[i].element].beta0[basis_ao[i].ao_shell] 
                                  + modprms.PT[basis_ao[j].element].beta0[basis_ao[j].ao_shell]) * sao_ij;
@@ -1034,7 +1052,8 @@ void Hamiltonian_core_deriv_indo
           //double sao_ij = gaussian_overlap(basis_ao[i],basis_ao[j]); // 0, dIdA,dIdB), mem->aux, mem->n_aux);
 
           VECTOR dSda, dSdb, dSdc;
-          double sao_ij = gaussian_overlap(&basis_ao[i],&basis_ao[j], 1, 1, dSda, dSdb);
+          double sao_ij = (modprms.int_cache!=NULL) ? modprms.int_cache->overlap(basis_ao[i],basis_ao[j], 1, dSda, dSdb)
+                                                    : gaussian_overlap(&basis_ao[i],&basis_ao[j], 1, 1, dSda, dSdb);
           // i - on atom a
           // j - on atom b
 
@@ -1214,113 +1233,102 @@ void Hamiltonian_Fock_indo(Electronic_Structure* el, System& syst, vector<AO>& b
 
 
     
-  // Formation of the Fock matrix: add Coulomb and Exchange parts    
+  // Per-orbital Slater-Condon parameters and the atomic charges seen by the other atoms - set up once, before the threads start
+  int nat = syst.Number_of_atoms;
+  vector<double> G1(Norb, 0.0), F2(Norb, 0.0);
+  vector<double> Q_net(nat, 0.0);
+
   for(i=0;i<Norb;i++){
-    a = ao_to_atom_map[i];
+    G1[i] = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
+    F2[i] = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
+  }
+  for(a=0;a<nat;a++){  Q_net[a] = Zeff[a] - syst.Atoms[a].Atom_mull_charge_net;  }
 
-    for(j=0;j<Norb;j++){
-      b = ao_to_atom_map[j];
+  double* Fa = el->Fao_alp->M;
+  double* Fb = el->Fao_bet->M;
+  double* P  = el->P->M;
+  double* Pa = el->P_alp->M;
+  double* Pb = el->P_bet->M;
 
-      if(i==j){  // Diagonal terms
 
-//        cout<<"Diagonal terms, i= "<<i<<endl;
-//        cout<<"el->Fao_alp->M[i*Norb+i] = "<<el->Fao_alp->M[i*Norb+i]<<endl;
+  // Formation of the Fock matrix: add Coulomb and Exchange parts    
+  // Rows are distributed over the threads in the atom blocks (see Fock_tiles.h), so the result does not depend on the number of threads
+  Fock_tiles tiles(ao_to_atom_map, nat);
+  int nth = fock_num_threads(prms);
 
-        for(int kk=0;kk<atom_to_ao_map[a].size();kk++){    // for all orbitals on atom a
-          k = atom_to_ao_map[a][kk];                       // global orbital index of AO kk on atom a
+  #pragma omp parallel for schedule(dynamic) num_threads(nth) if(nth>1)
+  for(int t=0;t<tiles.size();t++){
 
+    vector<int>& tile = tiles.tile(t);
+    int a = ao_to_atom_map[tile[0]];      // all orbitals of the tile are on the atom a
+    double eri_aa = modprms.eri[a*nat + a];
 
-          double ii_kk, ik_ik; ii_kk = ik_ik = 0.0;
-          double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
-          double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
-          double eri_aa = modprms.eri[a*syst.Number_of_atoms + a];
+    for(int ii=0;ii<tile.size();ii++){
+      int i = tile[ii];
 
-          get_integrals(i,k,basis_ao,eri_aa,G1,F2,ii_kk,ik_ik);
+      for(int j=0;j<Norb;j++){
+        int b = ao_to_atom_map[j];
 
-/*
-          cout<<"kk= "<<kk<<" k= "<<k
-              <<" basis_ao[i].ao_shell_type= "<<basis_ao[i].ao_shell_type
-              <<" basis_ao[k].ao_shell_type= "<<basis_ao[k].ao_shell_type
-              <<"basis_ao[i].exponents = ("<<basis_ao[i].x_exp<<","<<basis_ao[i].y_exp<<","<<basis_ao[i].z_exp
-              <<"basis_ao[k].exponents = ("<<basis_ao[k].x_exp<<","<<basis_ao[k].y_exp<<","<<basis_ao[k].z_exp
-              <<" el->P->M[k*Norb+k]= "<<el->P->M[k*Norb+k]
-              <<" el->P_alp->M[k*Norb+k]= "<<el->P_alp->M[k*Norb+k]
-              <<" ii_kk= "<<ii_kk<<" ik_ik= "<<ik_ik
-              <<endl;
-*/
+        if(i==j){  // Diagonal terms
 
-          if(prms.use_rosh){ // Restricted open-shell
-            el->Fao_alp->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - 0.5*el->P->M[k*Norb+k]*ik_ik);
-            el->Fao_bet->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - 0.5*el->P->M[k*Norb+k]*ik_ik);
+          for(int kk=0;kk<atom_to_ao_map[a].size();kk++){    // for all orbitals on atom a
+            int k = atom_to_ao_map[a][kk];                   // global orbital index of AO kk on atom a
 
-          }
-          else{ // unrestricted
-            el->Fao_alp->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - el->P_alp->M[k*Norb+k]*ik_ik);
-            el->Fao_bet->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - el->P_bet->M[k*Norb+k]*ik_ik);
+            double ii_kk, ik_ik; ii_kk = ik_ik = 0.0;
+            get_integrals(i,k,basis_ao,eri_aa,G1[i],F2[i],ii_kk,ik_ik);
 
-          }
+            if(prms.use_rosh){ // Restricted open-shell
+              Fa[i*Norb+i] += (P[k*Norb+k]*ii_kk - 0.5*P[k*Norb+k]*ik_ik);
+              Fb[i*Norb+i] += (P[k*Norb+k]*ii_kk - 0.5*P[k*Norb+k]*ik_ik);
+            }
+            else{ // unrestricted
+              Fa[i*Norb+i] += (P[k*Norb+k]*ii_kk - Pa[k*Norb+k]*ik_ik);
+              Fb[i*Norb+i] += (P[k*Norb+k]*ii_kk - Pb[k*Norb+k]*ik_ik);
+            }
 
-//          cout<<"at this point el->Fao_bet->M[i*Norb+i]= "<<el->Fao_bet->M[i*Norb+i]<<endl;
-  
-        }// for kk - all orbitals on atom A
-  
+          }// for kk - all orbitals on atom A
 
-        // Contributions from all other atoms to the diagonal terms
-        // don't worry that b determined above will be rewritten - this is ok
-        for(b=0;b<syst.Number_of_atoms;b++){
 
-          if(b!=a){
-
-            // Compute density matrix due to all orbitals on atom b 
-            el->Fao_alp->M[i*Norb+i] += (Zeff[b] - syst.Atoms[b].Atom_mull_charge_net)*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+i] += (Zeff[b] - syst.Atoms[b].Atom_mull_charge_net)*modprms.eri[a*syst.Number_of_atoms+b]; 
-          }
-        }// for b
-  
-  
-      }// i==j
-      else{      // Off-diagonal terms
-  
-        if(a==b){ // different orbitals are on the same atom
-          double ij_ij,ii_jj; ij_ij = ii_jj = 0.0;
+          // Contributions from all other atoms to the diagonal terms
+          for(int c=0;c<nat;c++){
+            if(c!=a){
+              Fa[i*Norb+i] += Q_net[c]*modprms.eri[a*nat+c];
+              Fb[i*Norb+i] += Q_net[c]*modprms.eri[a*nat+c];
+            }
+          }// for c
 
-          double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
-          double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
-          double eri_aa = modprms.eri[a*syst.Number_of_atoms+a];
-          get_integrals(i,j,basis_ao,eri_aa,G1,F2,ii_jj,ij_ij);
+        }// i==j
+        else if(a==b){ // different orbitals are on the same atom
 
-          //cout<<"i= "<<i<<" j= "<<j<<" ii_jj= "<<ii_jj<<", ij_ij= "<<ij_ij<<endl;
+          double ij_ij,ii_jj; ij_ij = ii_jj = 0.0;
+          get_integrals(i,j,basis_ao,eri_aa,G1[i],F2[i],ii_jj,ij_ij);
 
           if(prms.use_rosh){
-            el->Fao_alp->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - 0.5*el->P->M[i*Norb+j])*ij_ij - 0.5*el->P->M[i*Norb+j]*ii_jj );
-            el->Fao_bet->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - 0.5*el->P->M[i*Norb+j])*ij_ij - 0.5*el->P->M[i*Norb+j]*ii_jj );
+            Fa[i*Norb+j] += ( (2.0*P[i*Norb+j] - 0.5*P[i*Norb+j])*ij_ij - 0.5*P[i*Norb+j]*ii_jj );
+            Fb[i*Norb+j] += ( (2.0*P[i*Norb+j] - 0.5*P[i*Norb+j])*ij_ij - 0.5*P[i*Norb+j]*ii_jj );
           }
           else{  
-            el->Fao_alp->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - el->P_alp->M[i*Norb+j])*ij_ij - el->P_alp->M[i*Norb+j]*ii_jj );
-            el->Fao_bet->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - el->P_bet->M[i*Norb+j])*ij_ij - el->P_bet->M[i*Norb+j]*ii_jj );
+            Fa[i*Norb+j] += ( (2.0*P[i*Norb+j] - Pa[i*Norb+j])*ij_ij - Pa[i*Norb+j]*ii_jj );
+            Fb[i*Norb+j] += ( (2.0*P[i*Norb+j] - Pb[i*Norb+j])*ij_ij - Pb[i*Norb+j]*ii_jj );
           }
-  
-        }// a==b - different orbitals are on the same atom
-  
+
+        }// a==b
         else{ // different orbitals are on different atoms
 
           if(prms.use_rosh){
-            el->Fao_alp->M[i*Norb+j] -= 0.5*el->P->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+j] -= 0.5*el->P->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
+            Fa[i*Norb+j] -= 0.5*P[i*Norb+j]*modprms.eri[a*nat+b]; 
+            Fb[i*Norb+j] -= 0.5*P[i*Norb+j]*modprms.eri[a*nat+b]; 
           }
           else{
-            el->Fao_alp->M[i*Norb+j] -= el->P_alp->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+j] -= el->P_bet->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
+            Fa[i*Norb+j] -= Pa[i*Norb+j]*modprms.eri[a*nat+b]; 
+            Fb[i*Norb+j] -= Pb[i*Norb+j]*modprms.eri[a*nat+b]; 
           }
 
         }
-  
-  
-      }// i!=j
-  
-  
-    }// for j
-  }// for i
+
+      }// for j
+    }// for ii
+  }// for t
 
 }
 
@@ -19,6 +19,7 @@
 
 
 #include "Electronic_Structure.h"
+#include "Fock_tiles.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -973,7 +973,7 @@ double energy_and_forces
   int x_period = 0;    int y_period = 0;    int z_period = 0;
   VECTOR t1,t2,t3;
 
-  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *Sao);
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *Sao, modprms.int_cache);
 
 
   //=========== STEP 4: Parameters ================
@@ -1095,6 +1095,9 @@ listHamiltonian_QM::listHamiltonian_QM(const listHamiltonian_QM& ob){   ///< Cop
   //============ Excited states ================
   basis_ex = ob.basis_ex;  ///< Excitations for this sub-system -  may be the same as in prms, but may be different  
 
+  int_cache = ob.int_cache;
+  bind_integral_cache();    ///< the copied modprms point to the cache of ob - repoint them to our own copy
+
 }
 
 void listHamiltonian_QM::operator=(const listHamiltonian_QM& ob){   ///< Copying one listHamiltonian_QM into the other one
@@ -1114,6 +1117,9 @@ void listHamiltonian_QM::operator=(const listHamiltonian_QM& ob){   ///< Copying
   //============ Excited states ================
   basis_ex = ob.basis_ex;  ///< Excitations for this sub-system -  may be the same as in prms, but may be different  
 
+  int_cache = ob.int_cache;
+  bind_integral_cache();    ///< the copied modprms point to the cache of ob - repoint them to our own copy
+
 }
 
 
@@ -1162,6 +1168,7 @@ void listHamiltonian_QM::init(std::string ctrl_filename,System& syst){
   /// Create the Control_Paramters object from the ctrl_filename file
 
   libcontrol_parameters::get_parameters_from_file(ctrl_filename, prms);
+  bind_integral_cache();
 
 
   //=========== STEP 2:  Create model parameters and load them from file (using control parameters options) ================
@@ -1224,7 +1231,7 @@ void listHamiltonian_QM::init(std::string ctrl_filename,System& syst){
   int z_period = 0;
   VECTOR t1, t2, t3;
 
-  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *el->Sao); 
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *el->Sao, modprms.int_cache); 
 
   //=========== STEP 7: Method-specific Parameters ================
   /// Set up Hamiltonian-type-specific parameters
@@ -1284,7 +1291,34 @@ void listHamiltonian_QM::compute_overlap(System& syst){
   int z_period = 0;
   VECTOR t1, t2, t3;
 
-  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *el->Sao); 
+  bind_integral_cache();
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *el->Sao, modprms.int_cache); 
+
+}
+
+
+void listHamiltonian_QM::compute_overlap(System& syst, SYMMETRY& sym){
+/**
+  \param[in,out] syst The object containing structural information about system. 
+  \param[in] sym The symmetry of the system, e.g. from System::find_symmetry
+
+  Same as compute_overlap(syst), but only the symmetry-inequivalent atom-pair blocks of the AO overlap
+  are computed, the others are obtained by the transformation of the AOs (see update_overlap_matrix)
+*/
+
+  int x_period = 0;
+  int y_period = 0;
+  int z_period = 0;
+  VECTOR t1, t2, t3;
+  if(syst.is_Box){  syst.Box.get_vectors(t1, t2, t3);  }
+
+  if(sym.nat!=syst.Number_of_atoms){
+    cout<<"Error in listHamiltonian_QM::compute_overlap: the symmetry is found for "<<sym.nat<<" atoms, but the system has "
+        <<syst.Number_of_atoms<<" atoms\n"; exit(0);
+  }
+
+  bind_integral_cache();
+  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *el->Sao, modprms.int_cache, sym, ao_to_atom_map);
 
 }
 
@@ -1300,6 +1334,7 @@ void listHamiltonian_QM::compute_core_Hamiltonian(System& syst){
 
 
   int debug = 0;
+  bind_integral_cache();
   Hamiltonian_core(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *el->Hao,  *el->Sao, debug);
 
 
@@ -1393,6 +1428,7 @@ double listHamiltonian_QM::compute_scf(System& syst){
   /// Form core Hamiltonian
 
   int debug = 0;
+  bind_integral_cache();
   Hamiltonian_core(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *el->Hao,  *el->Sao, debug);
 
 
@@ -1442,11 +1478,24 @@ double listHamiltonian_QM::energy_and_forces(System& syst){
   Computes energy and forces (inclding excited state) for quantum part of the chemical system (given by syst)
 */
 
+  bind_integral_cache();
   return libhamiltonian_qm::energy_and_forces(*el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map );
 
 }
 
 
+void listHamiltonian_QM::bind_integral_cache(){
+/**
+  Makes the model parameters use the internal tables of the two-center integrals if prms.use_integral_cache = 1.
+  The tables persist between the calls, so only the first geometry pays for building them. Call int_cache.clear()
+  if the basis set parameters are changed.
+*/
+
+  modprms.int_cache = (prms.use_integral_cache) ? &int_cache : NULL;
+
+}
+
+
 void listHamiltonian_QM::add_excitation(int f_o, int f_s, int t_o, int t_s){
 /**
   \param[in] f_o "from orbital" The index of the orbital from which electron is excited
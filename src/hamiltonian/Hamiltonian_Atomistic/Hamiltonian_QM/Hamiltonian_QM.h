@@ -153,6 +153,7 @@ public:
     Control_Parameters prms;  ///< Control parameters defining how to perform calculations for this sub-system
                               ///< Note: different levels of treatment are possible for different sub-systems
     Model_Parameters modprms; ///< Model parameters for this sub-system
+    PairIntegralCache int_cache; ///< Tables of the two-center integrals, used if prms.use_integral_cache = 1
 
     //============= Ground state =================
     std::vector<AO> basis_ao;       ///< Basis for this sub-system
@@ -174,10 +175,12 @@ public:
     void set_electronic_structure(Electronic_Structure& el_);
 
     void compute_overlap(System& syst);
+    void compute_overlap(System& syst, SYMMETRY& sym);
     void compute_core_Hamiltonian(System& syst);
     double energy_and_forces(System& syst);
 
     void add_excitation(int f_o, int f_s, int t_o, int t_s);
+    void bind_integral_cache();
 
     //void set_excitonic_basis(boost::python::list basis_ex);
     void excite_alp(int I,int J);
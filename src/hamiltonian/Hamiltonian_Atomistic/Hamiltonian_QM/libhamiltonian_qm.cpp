@@ -361,6 +361,9 @@ void export_Hamiltonian_QM_objects(){
 
 
 
+  void (listHamiltonian_QM::*expt_compute_overlap_v1)(System& syst) = &listHamiltonian_QM::compute_overlap;
+  void (listHamiltonian_QM::*expt_compute_overlap_v2)(System& syst, SYMMETRY& sym) = &listHamiltonian_QM::compute_overlap;
+
   class_<listHamiltonian_QM>("listHamiltonian_QM",init<>())
       .def(init<std::string, System&>())
       .def(init<const listHamiltonian_QM&>())
@@ -371,6 +374,7 @@ void export_Hamiltonian_QM_objects(){
       .def_readwrite("Nelec", &listHamiltonian_QM::Nelec)
       .def_readwrite("prms", &listHamiltonian_QM::prms)
       .def_readwrite("modprms", &listHamiltonian_QM::modprms)
+      .def_readwrite("int_cache", &listHamiltonian_QM::int_cache)
       .def_readwrite("basis_ao", &listHamiltonian_QM::basis_ao)
       .def_readwrite("atom_to_ao_map", &listHamiltonian_QM::atom_to_ao_map)
       .def_readwrite("ao_to_atom_map", &listHamiltonian_QM::ao_to_atom_map)
@@ -381,7 +385,8 @@ void export_Hamiltonian_QM_objects(){
       .def("get_parameters_from_file", &listHamiltonian_QM::get_parameters_from_file)
       .def("get_electronic_structure", &listHamiltonian_QM::get_electronic_structure)
       .def("set_electronic_structure", &listHamiltonian_QM::set_electronic_structure)
-      .def("compute_overlap", &listHamiltonian_QM::compute_overlap)
+      .def("compute_overlap", expt_compute_overlap_v1)
+      .def("compute_overlap", expt_compute_overlap_v2)
       .def("compute_core_Hamiltonian", &listHamiltonian_QM::compute_core_Hamiltonian)
       .def("energy_and_forces", &listHamiltonian_QM::energy_and_forces)
 
@@ -400,6 +405,41 @@ void export_Hamiltonian_QM_objects(){
 
 
 
+  //--------------- CIS ------------------------------------
+  class_<CIS>("CIS",init<Electronic_Structure&, int, int, int, int>())
+      .def("__copy__", &generic__copy__<CIS>)
+      .def("__deepcopy__", &generic__deepcopy__<CIS>)
+
+      .def_readwrite("spin", &CIS::spin)
+      .def_readwrite("nao", &CIS::nao)
+      .def_readwrite("nocc_tot", &CIS::nocc_tot)
+      .def_readwrite("nocc_tot_b", &CIS::nocc_tot_b)
+      .def_readwrite("nocc", &CIS::nocc)
+      .def_readwrite("nvirt", &CIS::nvirt)
+      .def_readwrite("nroots", &CIS::nroots)
+      .def_readwrite("max_iter", &CIS::max_iter)
+      .def_readwrite("max_subspace", &CIS::max_subspace)
+      .def_readwrite("tol", &CIS::tol)
+      .def_readwrite("niter", &CIS::niter)
+      .def_readwrite("converged", &CIS::converged)
+      .def_readwrite("e_occ", &CIS::e_occ)
+      .def_readwrite("e_virt", &CIS::e_virt)
+      .def_readwrite("C_occ", &CIS::C_occ)
+      .def_readwrite("C_occ_b", &CIS::C_occ_b)
+      .def_readwrite("C_virt", &CIS::C_virt)
+      .def_readwrite("E", &CIS::E)
+      .def_readwrite("X", &CIS::X)
+
+      .def("solve", &CIS::solve)
+      .def("transition_density", &CIS::transition_density)
+      .def("transition_dipoles", &CIS::transition_dipoles)
+  ;
+
+  MATRIX (*expt_cis_overlaps_v1)(CIS& cis_old, CIS& cis_new, MATRIX& S_ao) = &cis_overlaps;
+  def("cis_overlaps", expt_cis_overlaps_v1);
+
+
+
 }
 
 
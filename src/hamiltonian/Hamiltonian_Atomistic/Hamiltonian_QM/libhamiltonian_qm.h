@@ -20,6 +20,7 @@
 
 #include "Hamiltonian_QM.h"
 #include "SCF.h"
+#include "CIS.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -92,6 +92,8 @@ void export_hamiltonian_atomistic_objects(){
 
       .def("apply_pbc_to_interactions", &Hamiltonian_Atomistic::apply_pbc_to_interactions)
       .def("set_respa_types", &Hamiltonian_Atomistic::set_respa_types)
+      .def("set_mm_backend", &Hamiltonian_Atomistic::set_mm_backend)
+      .def("energy_respa", &Hamiltonian_Atomistic::energy_respa)
 
       .def("init_qm_Hamiltonian",&Hamiltonian_Atomistic::init_qm_Hamiltonian)
       .def("add_excitation",&Hamiltonian_Atomistic::add_excitation)
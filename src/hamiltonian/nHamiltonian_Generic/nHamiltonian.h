@@ -23,6 +23,9 @@
 /// liblibra namespace
 namespace liblibra{
 
+// Forward declaration
+namespace libann{  class NeuralNetwork;  }
+
 
 /// libhamiltonian namespace
 namespace libhamiltonian{
@@ -376,6 +379,10 @@ public:
   void compute_diabatic(bp::object py_funct, bp::object q, bp::object params, int lvl); // for models defined in Python
   void compute_diabatic(bp::object py_funct, bp::object q, bp::object params); // for models defined in Python
 
+  ///< In nHamiltonian_compute_diabatic_ann.cpp
+  void compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q, int lvl); // for the models given by the trained ANN
+  void compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q);
+
 
   ///< In nHamiltonian_compute_ETHD.cpp
 
@@ -448,6 +455,13 @@ public:
   void compute_hvib_adi(vector<int>& id_);
   void compute_hvib_adi(int lvl);
 
+  void compute_nac_hvib_dia(const double* v, int stride);
+  void compute_nac_hvib_dia(MATRIX& p, const MATRIX& invM);
+  void compute_nac_hvib_dia(MATRIX& p, const MATRIX& invM, int lvl, int split);
+  void compute_nac_hvib_adi(const double* v, int stride);
+  void compute_nac_hvib_adi(MATRIX& p, const MATRIX& invM);
+  void compute_nac_hvib_adi(MATRIX& p, const MATRIX& invM, int lvl, int split);
+
 
 
   ///< In nHamiltonian_compute_Ehrenfest.cpp
@@ -491,6 +505,16 @@ CMATRIX compute_phase_corrections(CMATRIX& S);
 CMATRIX compute_phase_corrections(CMATRIX& U, CMATRIX& U_prev);
 
 
+///< In nHamiltonian_compute_nac.cpp
+void nac_hvib_kernel(vector<CMATRIX*>& dc1, const double* v, int stride, CMATRIX* nac, 
+                     CMATRIX* ham, CMATRIX* hvib, int antiherm);
+
+
+///< In nHamiltonian_compute_Ehrenfest_forces.cpp
+void contract_forces(CMATRIX& ampl, vector<CMATRIX*>& d1ham, vector<CMATRIX*>& dc1, CMATRIX* X,
+                     CMATRIX& A, CMATRIX& B);
+
+
 ///< In nHamiltonian_compute_ETHD.cpp
 double ETHD_energy(const MATRIX& q, const MATRIX& invM);
 MATRIX ETHD_forces(const MATRIX& q, const MATRIX& invM);
@@ -140,6 +140,10 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_adi(CMATRIX& ampl_adi){
   f_adi^MF.M[n] = Cadi.H() * (F_adi^MF[n]) * Cadi  
 
   The normalization factor is embedded in F_adi^MF[n]
+
+  The Hamiltonian ham_adi is diagonal, so the dc1^+ * H term is built by scaling the columns of
+  dc1^+ with the adiabatic energies - O(nadi^2) per DOF, rather than a matrix-matrix product.
+  The expectation values alone (Ehrenfest_forces_adi) do not need these tensors - see contract_forces.
   
 */
 
@@ -155,6 +159,7 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_adi(CMATRIX& ampl_adi){
 
   complex<double> norm = (ampl_adi.H() * ampl_adi).M[0]; 
 
+  int i,j;
   CMATRIX* tmp; tmp = new CMATRIX(nadi, nadi);
 
 
@@ -166,8 +171,13 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_adi(CMATRIX& ampl_adi){
     if(dc1_adi_mem_status[n]==0){ cout<<"Error in Ehrenfest_forces_tens_adi(): the derivatives couplings matrix in the adiabatic \
     basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
-    *tmp = (*dc1_adi[n]).H() * (*ham_adi);
-    *tmp = (*tmp + (*tmp).H() );
+    /// tmp = dc1^+ * H + H^+ * dc1, with H = diag(E):  tmp_ij = conj(dc1_ji) * E_j + conj(E_i) * dc1_ij
+    complex<double>* d = dc1_adi[n]->M;
+    for(i=0;i<nadi;i++){
+      for(j=0;j<nadi;j++){
+        tmp->M[i*nadi+j] = std::conj(d[j*nadi+i]) * ham_adi->M[j*nadi+j] + std::conj(ham_adi->M[i*nadi+i]) * d[i*nadi+j];
+      }
+    }
 
     res[n] = (-1.0/norm) * (*d1ham_adi[n] - *tmp );
 
@@ -205,6 +215,10 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_dia(CMATRIX& ampl_dia){
 
   The normalization factor is embedded in F_dia^MF[n]
 
+  The product S^-1 * H does not depend on the DOF, so it is formed once - one matrix-matrix
+  product per DOF remains. The expectation values alone (Ehrenfest_forces_dia) do not need 
+  these tensors - see contract_forces.
+
 */
 
   vector<CMATRIX> res; res = vector<CMATRIX>(nnucl, CMATRIX(ndia,ndia));
@@ -223,6 +237,7 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_dia(CMATRIX& ampl_dia){
   CMATRIX* invS; invS = new CMATRIX(nadi, nadi); 
 
   FullPivLU_inverse(*ovlp_dia, *invS);
+  *invS = (*invS) * (*ham_dia);   // S^-1 * H
   complex<double> norm = (ampl_dia.H() * (*ovlp_dia) * ampl_dia).M[0]; 
 
   
@@ -235,7 +250,7 @@ vector<CMATRIX> nHamiltonian::Ehrenfest_forces_tens_dia(CMATRIX& ampl_dia){
       basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
 
-      *dtilda = (*dc1_dia[n]).H() * (*invS) * (*ham_dia);
+      *dtilda = (*dc1_dia[n]).H() * (*invS);
       *dtilda = (*dtilda + (*dtilda).H() ) ;
 
       res[n] = (-1.0/norm) * (*d1ham_dia[n] - *dtilda );
@@ -34,6 +34,93 @@ using namespace libmeigen;
 
 
 
+void contract_forces(CMATRIX& ampl, vector<CMATRIX*>& d1ham, vector<CMATRIX*>& dc1, CMATRIX* X,
+                     CMATRIX& A, CMATRIX& B){
+/**
+  \brief The contraction kernel for the force-like expectation values, for all nuclear DOFs
+  and all trajectories at once
+
+  \param[in] ampl A [nst x ntraj] matrix of amplitudes, one column per trajectory
+  \param[in] d1ham The nnucl pointers to the [nst x nst] derivatives of the Hamiltonian
+  \param[in] dc1 The nnucl pointers to the [nst x nst] derivative coupling matrices; may be empty,
+  in which case B is not computed
+  \param[in] X A [nst x ntraj] matrix of the auxiliary vectors x (see below); only used if dc1 is not empty
+  \param[out] A A [nnucl x ntraj] matrix:  A(n,t) = c_t^+ * d1ham[n] * c_t
+  \param[out] B A [nnucl x ntraj] matrix:  B(n,t) = (dc1[n] * c_t)^+ * x_t + x_t^+ * (dc1[n] * c_t) = 2 Re[ (dc1[n] * c_t)^+ * x_t ]
+
+  With x_t = ham_adi * c_t, the B term is the expectation value c_t^+ * (dc1^+ * H + H * dc1) * c_t  that enters
+  the Ehrenfest forces, but it is computed with O(nst^2) operations per DOF, instead of two O(nst^3) 
+  matrix-matrix products per DOF.
+
+*/
+
+  int nst = ampl.n_rows;
+  int ntraj = ampl.n_cols;
+  int nnucl = d1ham.size();
+  int do_dc1 = (dc1.size()>0);
+
+  int i,j,n,t;
+
+  if(A.n_rows!=nnucl || A.n_cols!=ntraj){ cout<<"Error in contract_forces(): the matrix A should be of the dimensions "
+     <<nnucl<<" x "<<ntraj<<"\n"; exit(0);   }
+  if(do_dc1){
+    if(B.n_rows!=nnucl || B.n_cols!=ntraj){ cout<<"Error in contract_forces(): the matrix B should be of the dimensions "
+       <<nnucl<<" x "<<ntraj<<"\n"; exit(0);   }
+    if(dc1.size()!=nnucl){ cout<<"Error in contract_forces(): the sizes of the d1ham and dc1 lists differ\n"; exit(0); }
+  }
+
+
+  // Keep the amplitudes (and the auxiliary vectors) of each trajectory contiguously 
+  vector< complex<double> > c(nst*ntraj, complex<double>(0.0, 0.0));
+  vector< complex<double> > x;
+  vector< complex<double> > v(nst, complex<double>(0.0, 0.0));
+
+  for(i=0;i<nst;i++){  for(t=0;t<ntraj;t++){  c[t*nst+i] = ampl.M[i*ntraj+t];  }  }
+
+  if(do_dc1){
+    x = vector< complex<double> >(nst*ntraj, complex<double>(0.0, 0.0));
+    for(i=0;i<nst;i++){  for(t=0;t<ntraj;t++){  x[t*nst+i] = X->M[i*ntraj+t];  }  }
+  }
+
+
+  for(n=0;n<nnucl;n++){
+
+    complex<double>* h = d1ham[n]->M;
+    complex<double>* d = NULL;
+    if(do_dc1){ d = dc1[n]->M; }
+
+    for(t=0;t<ntraj;t++){
+
+      complex<double>* ct = &c[t*nst];
+      complex<double> a(0.0, 0.0);
+      complex<double> b(0.0, 0.0);
+
+      for(i=0;i<nst;i++){
+
+        // (d1ham[n] * c)_i
+        complex<double> hc(0.0, 0.0);
+        for(j=0;j<nst;j++){  hc += h[i*nst+j] * ct[j];  }
+        a += std::conj(ct[i]) * hc;
+
+        // (dc1[n] * c)_i
+        if(do_dc1){
+          complex<double> dc(0.0, 0.0);
+          for(j=0;j<nst;j++){  dc += d[i*nst+j] * ct[j];  }
+          b += std::conj(dc) * x[t*nst+i];
+        }
+
+      }// for i
+
+      A.M[n*ntraj+t] = a;
+      if(do_dc1){ B.M[n*ntraj+t] = 2.0 * b.real(); }
+
+    }// for t
+  }// for n
+
+}
+
+
+
 
 CMATRIX nHamiltonian::Ehrenfest_forces_dia_unit(CMATRIX& ampl_dia){
 /**
@@ -54,6 +141,13 @@ CMATRIX nHamiltonian::Ehrenfest_forces_dia_unit(CMATRIX& ampl_dia){
   for a systematic derivations, look here: 
   https://github.com/alexvakimov/Derivatory/blob/master/Ehrenfest.pdf
 
+  \param[in] ampl_dia A [ndia x ntraj] matrix of diabatic amplitudes; all trajectories 
+  are handled by the present Hamiltonian
+
+  Returns a [nnucl x ntraj] matrix of forces. The per-DOF matrices dtilda = dc1^+ * S^-1 * H
+  are never formed: the expectation values are contracted directly (see contract_forces), so 
+  the cost is O(ndia^2) per DOF and trajectory.
+
 */
 
   if(ovlp_dia_mem_status==0){ cout<<"Error in Ehrenfest_forces_dia_unit(): the overlap matrix in the diabatic basis is not allocated \
@@ -63,15 +157,8 @@ CMATRIX nHamiltonian::Ehrenfest_forces_dia_unit(CMATRIX& ampl_dia){
   but it is needed for the calculations\n"; exit(0); }
 
 
-  CMATRIX res(nnucl,1);
-  CMATRIX* dtilda; dtilda = new CMATRIX(nadi,nadi);
-  CMATRIX* invS; invS = new CMATRIX(nadi, nadi); 
-
-  FullPivLU_inverse(*ovlp_dia, *invS);
+  int ntraj = ampl_dia.n_cols;
 
-  complex<double> norm = ( ampl_dia.H() * (*ovlp_dia) * ampl_dia ).M[0]; 
-
-  
   for(int n=0;n<nnucl;n++){
 
       if(d1ham_dia_mem_status[n]==0){ cout<<"Error in Ehrenfest_forces_dia_unit(): the derivatives of the Hamiltonian matrix in the \
@@ -80,19 +167,35 @@ CMATRIX nHamiltonian::Ehrenfest_forces_dia_unit(CMATRIX& ampl_dia){
       if(dc1_dia_mem_status[n]==0){ cout<<"Error in Ehrenfest_forces_dia_unit(): the derivatives couplings matrix in the diabatic \
       basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
+  }// for n
 
-      *dtilda = (*dc1_dia[n]).H() * (*invS) * (*ham_dia);
-      *dtilda = (*dtilda + (*dtilda).H() ) ;
 
-      res.M[n] = -( ampl_dia.H() * (*d1ham_dia[n] - *dtilda ) * ampl_dia ).M[0];
+  CMATRIX invS(ndia, ndia); 
+  FullPivLU_inverse(*ovlp_dia, invS);
 
-  }// for n
+  /// x_t = S^-1 * H * c_t, so that  c_t^+ * (dtilda + dtilda^+) * c_t = 2 Re[ (dc1[n] * c_t)^+ * x_t ]
+  /// with dtilda = dc1[n]^+ * S^-1 * H
+  CMATRIX X(ndia, ntraj);
+  X = invS * ((*ham_dia) * ampl_dia);
+
+  CMATRIX SC(ndia, ntraj);
+  SC = (*ovlp_dia) * ampl_dia;
+
+  CMATRIX A(nnucl, ntraj);
+  CMATRIX B(nnucl, ntraj);
 
-  res /= norm; 
+  contract_forces(ampl_dia, d1ham_dia, dc1_dia, &X, A, B);
 
+  CMATRIX res(nnucl, ntraj);
+  for(int t=0;t<ntraj;t++){
 
-  delete dtilda;
-  delete invS;
+    complex<double> norm(0.0, 0.0);
+    for(int i=0;i<ndia;i++){  norm += std::conj(ampl_dia.M[i*ntraj+t]) * SC.M[i*ntraj+t];  }
+
+    for(int n=0;n<nnucl;n++){
+      res.M[n*ntraj+t] = -(A.M[n*ntraj+t] - B.M[n*ntraj+t]) / norm;
+    }
+  }
 
   return res;
  
@@ -130,6 +233,11 @@ CMATRIX nHamiltonian::Ehrenfest_forces_dia(CMATRIX& ampl_dia, int lvl){
     }
   }
 
+  if(lvl==0){
+    /// All trajectories share the same Hamiltonian - contract them all at once
+    return Ehrenfest_forces_dia_unit(ampl_dia);
+  }
+
   CMATRIX ampl_tmp(ampl_dia.n_rows, 1);
   CMATRIX frc_tmp(nnucl, 1);
   CMATRIX F(nnucl, ampl_dia.n_cols);
@@ -139,18 +247,14 @@ CMATRIX nHamiltonian::Ehrenfest_forces_dia(CMATRIX& ampl_dia, int lvl){
   vector<int> stenc_col(1, 0);
 
   for(i=0;i<ampl_dia.n_rows;i++){ stenc_ampl[i] = i;}
+  for(i=0;i<nnucl;i++){ stenc_frc[i] = i;}
 
   for(i=0;i<ampl_dia.n_cols;i++){
     stenc_col[0] = i;
 
     pop_submatrix(ampl_dia, ampl_tmp, stenc_ampl, stenc_col);
 
-    if(lvl==0){
-        frc_tmp = Ehrenfest_forces_dia_unit(ampl_tmp);
-    }
-    if(lvl==1){
-        frc_tmp = children[i]->Ehrenfest_forces_dia_unit(ampl_tmp);
-    }
+    frc_tmp = children[i]->Ehrenfest_forces_dia_unit(ampl_tmp);
 
     push_submatrix(F, frc_tmp, stenc_frc, stenc_col);
  
@@ -201,18 +305,20 @@ CMATRIX nHamiltonian::Ehrenfest_forces_adi_unit(CMATRIX& ampl_adi){
   for a systematic derivations, look here: 
   https://github.com/alexvakimov/Derivatory/blob/master/Ehrenfest.pdf
 
+  \param[in] ampl_adi A [nadi x ntraj] matrix of adiabatic amplitudes; all trajectories 
+  are handled by the present Hamiltonian
+
+  Returns a [nnucl x ntraj] matrix of forces. Since ham_adi is diagonal, the 
+  dc1^+ * H + H * dc1 terms are contracted with the amplitudes directly (see contract_forces), 
+  so the cost is O(nadi^2) per DOF and trajectory.
+
 */
 
   if(ham_adi_mem_status==0){ cout<<"Error in Ehrenfest_forces_adi(): the adiabatic Hamiltonian matrix is not allocated \
   but it is needed for the calculations\n"; exit(0); }
 
 
-  complex<double> norm = (ampl_adi.H() * ampl_adi).M[0]; 
-
-  CMATRIX res(nnucl,1);
-
-  CMATRIX* tmp; tmp = new CMATRIX(nadi, nadi);
-
+  int ntraj = ampl_adi.n_cols;
 
   for(int n=0;n<nnucl;n++){
 
@@ -222,16 +328,31 @@ CMATRIX nHamiltonian::Ehrenfest_forces_adi_unit(CMATRIX& ampl_adi){
     if(dc1_adi_mem_status[n]==0){ cout<<"Error in Ehrenfest_forces_adi_unit(): the derivatives couplings matrix in the adiabatic \
     basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
+  }// for n
+
 
-    *tmp = (*dc1_adi[n]).H() * (*ham_adi);
-    *tmp = (*tmp + (*tmp).H() );
+  /// x_t = H * c_t - the adiabatic Hamiltonian is diagonal, so this is only O(nadi) per trajectory
+  CMATRIX X(nadi, ntraj);
+  for(int i=0;i<nadi;i++){
+    complex<double> e_i = ham_adi->M[i*nadi+i];
+    for(int t=0;t<ntraj;t++){  X.M[i*ntraj+t] = e_i * ampl_adi.M[i*ntraj+t];  }
+  }
 
-    res.M[n] = -( ampl_adi.H() * (*d1ham_adi[n] - *tmp ) * ampl_adi ).M[0];
+  CMATRIX A(nnucl, ntraj);
+  CMATRIX B(nnucl, ntraj);
 
-  }// for n
+  contract_forces(ampl_adi, d1ham_adi, dc1_adi, &X, A, B);
 
-  res /= norm; 
-  delete tmp;
+  CMATRIX res(nnucl, ntraj);
+  for(int t=0;t<ntraj;t++){
+
+    complex<double> norm(0.0, 0.0);
+    for(int i=0;i<nadi;i++){  norm += std::conj(ampl_adi.M[i*ntraj+t]) * ampl_adi.M[i*ntraj+t];  }
+
+    for(int n=0;n<nnucl;n++){
+      res.M[n*ntraj+t] = -(A.M[n*ntraj+t] - B.M[n*ntraj+t]) / norm;
+    }
+  }
 
   return res;
 }
@@ -268,6 +389,11 @@ CMATRIX nHamiltonian::Ehrenfest_forces_adi(CMATRIX& ampl_adi, int lvl){
   }
 
 
+  if(lvl==0){
+    /// All trajectories share the same Hamiltonian - contract them all at once
+    return Ehrenfest_forces_adi_unit(ampl_adi);
+  }
+
   CMATRIX ampl_tmp(ampl_adi.n_rows, 1);
   CMATRIX frc_tmp(nnucl, 1);
   CMATRIX F(nnucl, ampl_adi.n_cols);
@@ -277,18 +403,14 @@ CMATRIX nHamiltonian::Ehrenfest_forces_adi(CMATRIX& ampl_adi, int lvl){
   vector<int> stenc_col(1, 0);
 
   for(i=0;i<ampl_adi.n_rows;i++){ stenc_ampl[i] = i;}
+  for(i=0;i<nnucl;i++){ stenc_frc[i] = i;}
 
   for(i=0;i<ampl_adi.n_cols;i++){
     stenc_col[0] = i;
 
     pop_submatrix(ampl_adi, ampl_tmp, stenc_ampl, stenc_col);
 
-    if(lvl==0){
-        frc_tmp = Ehrenfest_forces_adi_unit(ampl_tmp);
-    }
-    if(lvl==1){
-        frc_tmp = children[i]->Ehrenfest_forces_adi_unit(ampl_tmp);
-    }
+    frc_tmp = children[i]->Ehrenfest_forces_adi_unit(ampl_tmp);
 
     push_submatrix(F, frc_tmp, stenc_frc, stenc_col);
  
@@ -0,0 +1,162 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file nHamiltonian_compute_diabatic_ann.cpp
+  \brief The file implements the diabatic Hamiltonians given by a trained neural network
+
+*/
+
+#include "nHamiltonian.h"
+#include "../../math_ann/libann.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+using namespace libann;
+
+/// libhamiltonian_generic namespace
+namespace libhamiltonian_generic{
+
+
+
+static void set_dia_from_ann(nHamiltonian* ham, const MATRIX& res, const MATRIX& der, int n){
+/**
+  Sets the diabatic properties of the Hamiltonian <ham> from the n-th column of the ANN results
+*/
+
+  int ndia = ham->ndia;
+  int nnucl = ham->nnucl;
+  int npat = res.n_cols;
+  int i, j, k, a;
+
+  if(ham->ham_dia==NULL){
+    cout<<"Error in nHamiltonian::compute_diabatic: ham_dia is not allocated at the node "
+        <<"(level "<<ham->level<<", id "<<ham->id<<")\n"; exit(0);
+  }
+
+  k = 0;
+  for(i=0;i<ndia;i++){
+    for(j=i;j<ndia;j++){
+
+      double h = res.M[k*npat+n];
+      ham->ham_dia->set(i, j, complex<double>(h, 0.0));
+      ham->ham_dia->set(j, i, complex<double>(h, 0.0));
+
+      for(a=0;a<nnucl;a++){
+        if(ham->d1ham_dia[a]!=NULL){
+          double dh = der.M[(k*nnucl+a)*npat+n];
+          ham->d1ham_dia[a]->set(i, j, complex<double>(dh, 0.0));
+          ham->d1ham_dia[a]->set(j, i, complex<double>(dh, 0.0));
+        }
+      }// for a
+
+      k++;
+    }// for j
+  }// for i
+
+  // Orthonormal diabatic basis, independent of the coordinates
+  if(ham->ovlp_dia!=NULL){  ham->ovlp_dia->identity();  }
+  for(a=0;a<nnucl;a++){
+    if(ham->dc1_dia[a]!=NULL){  *ham->dc1_dia[a] = complex<double>(0.0, 0.0);  }
+  }
+
+}
+
+
+void nHamiltonian::compute_diabatic(NeuralNetwork& ann, const MATRIX& q){
+/**
+  Performs the diabatic properties calculation at the top-most level of the Hamiltonians
+  hierarchy. See the description of the more general function prototype for more info.
+*/
+
+  compute_diabatic(ann, q, 0);
+
+}
+
+
+void nHamiltonian::compute_diabatic(NeuralNetwork& ann, const MATRIX& q, int lvl){
+/**
+  Computes the diabatic Hamiltonian and its derivatives using a trained neural network
+
+  The network must have nnucl inputs (the nuclear coordinates) and ndia*(ndia+1)/2 outputs - the
+  unique elements of the real symmetric diabatic Hamiltonian in the row-major order of its upper triangle:
+  H(0,0), H(0,1), ..., H(0,ndia-1), H(1,1), ..., H(ndia-1,ndia-1). The derivatives d1ham_dia are computed
+  analytically from the network, so the forces are available. The diabatic basis is assumed orthonormal:
+  ovlp_dia = I, dc1_dia = 0.
+
+  q - the nuclear coordinates:  nnucl x 1, if lvl is the level of the calling Hamiltonian;
+      nnucl x nchildren, if lvl is the level of its children - the column i is used for the child i,
+      and all the children are evaluated by the network as a single batch.
+      For deeper levels, the same q is passed to each child.
+
+  lvl - is the level of the Hamiltonians in the hierarchy of Hamiltonians to be executed by this call
+*/
+
+  int npat;
+
+  if(level==lvl || lvl==level+1){
+
+    int nout = ndia*(ndia+1)/2;
+    int NL = ann.Nlayers - 1;
+
+    if(ann.Npe[0]!=nnucl || ann.Npe[NL]!=nout){
+      cout<<"Error in nHamiltonian::compute_diabatic: The ANN with "<<ann.Npe[0]<<" inputs and "<<ann.Npe[NL]
+          <<" outputs can not describe the Hamiltonian with nnucl = "<<nnucl<<" and ndia = "<<ndia
+          <<" (requires "<<nnucl<<" inputs and "<<nout<<" outputs)\n"; exit(0);
+    }
+
+    npat = (level==lvl) ? 1 : children.size();
+
+    if(q.n_rows!=nnucl || q.n_cols!=npat){
+      cout<<"Error in nHamiltonian::compute_diabatic: The coordinates matrix must be of size "
+          <<nnucl<<" x "<<npat<<"\n"; exit(0);
+    }
+
+    MATRIX res(nout, npat);
+    MATRIX der(nout*nnucl, npat);
+    ann.PropagateBatch(q, res, der);
+
+    if(level==lvl){  set_dia_from_ann(this, res, der, 0);  }
+    else{
+      for(int i=0;i<children.size();i++){
+        if(children[i]->ndia!=ndia || children[i]->nnucl!=nnucl){
+          cout<<"Error in nHamiltonian::compute_diabatic: The children must have the same ndia and nnucl as the parent\n"; exit(0);
+        }
+        set_dia_from_ann(children[i], res, der, i);
+      }
+    }
+
+  }
+  else if(lvl>level){
+
+    for(int i=0;i<children.size();i++){
+      children[i]->compute_diabatic(ann, q, lvl);
+    }
+
+  }
+
+  else{
+    cout<<"WARNING in nHamiltonian::compute_diabatic\n";
+    cout<<"Can not run evaluation of function in the parent Hamiltonian from the\
+     child node\n";
+  }
+
+}
+
+
+
+}// namespace libhamiltonian_generic
+}// namespace libhamiltonian
+}// liblibra
+
@@ -98,14 +98,26 @@ CMATRIX nHamiltonian::forces_adi(CMATRIX& ampl_adi){
 
   Return : f_adi.M[n] = Cadi.H() * (F_adi[n]) * Cadi   = -dE/dR
 
+  The force tensors F_adi[n] (see forces_tens_adi) are not constructed explicitly
+
 */
-  CMATRIX res(nnucl, 1);
-  vector<CMATRIX> dEdR;   dEdR = forces_tens_adi(ampl_adi);
+  for(int n=0;n<nnucl;n++){
 
-//  if(ampl_adi_mem_status==0){ cout<<"Error in forces_adi(): the amplitudes of the adiabatic states are\
-//  not allocated, but they are needed for the calculations\n"; exit(0); }
+    if(d1ham_adi_mem_status[n]==0){ cout<<"Error in forces_adi(): the derivatives of the Hamiltonian matrix in the \
+    adiabatic basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
+
+  }// for n
 
-  for(int n=0;n<nnucl;n++){  res.M[n] = (ampl_adi.H() * dEdR[n] * ampl_adi).M[0];   }
+  complex<double> norm = (ampl_adi.H() * ampl_adi).M[0]; 
+
+  /// Contract the derivatives directly, without making the force tensors
+  vector<CMATRIX*> no_dc1;
+  CMATRIX A(nnucl, ampl_adi.n_cols);
+  CMATRIX B(nnucl, ampl_adi.n_cols);
+  contract_forces(ampl_adi, d1ham_adi, no_dc1, NULL, A, B);
+
+  CMATRIX res(nnucl, 1);
+  for(int n=0;n<nnucl;n++){  res.M[n] = (-1.0/norm) * A.M[n*ampl_adi.n_cols];   }
 
   return res;
 }
@@ -201,16 +213,36 @@ CMATRIX nHamiltonian::forces_dia(CMATRIX& ampl_dia){
 
   Return : f_dia.M[n] = Cdia.H() * (F_dia[n]) * Cdia   = -dE/dR
 
+  The force tensors F_dia[n] (see forces_tens_dia) are not constructed explicitly
+
 */
 
 
-  CMATRIX res(nnucl, 1);
-  vector<CMATRIX> dEdR;   dEdR = forces_tens_dia(ampl_dia);
+  if(ovlp_dia_mem_status==0){ cout<<"Error in forces_dia(): the overlap matrix in the diabatic basis is not allocated \
+  but it is needed for the calculations\n"; exit(0); }
 
-//  if(ampl_dia_mem_status==0){ cout<<"Error in forces_dia(): the amplitudes of the diabatic states are\
-//  not allocated, but they are needed for the calculations\n"; exit(0); }
+  for(int n=0;n<nnucl;n++){
+
+    if(d1ham_dia_mem_status[n]==0){ cout<<"Error in forces_dia(): the derivatives of the Hamiltonian matrix in the \
+    diabatic basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
-  for(int n=0;n<nnucl;n++){  res.M[n] = ( ampl_dia.H() * dEdR[n] *  ampl_dia).M[0];   }
+    if(dc1_dia_mem_status[n]==0){ cout<<"Error in forces_dia(): the derivatives couplings matrix in the diabatic \
+    basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
+
+  }// for n
+
+  complex<double> norm = ( ampl_dia.H() * (*ovlp_dia) * ampl_dia).M[0]; 
+  complex<double> Etot = (ampl_dia.H() * (*ham_dia) * ampl_dia).M[0]/norm;
+
+  /// Contract the derivatives directly, without making the force tensors:
+  /// with x = c, B = c^+ * (dc1 + dc1^+) * c
+  int ncol = ampl_dia.n_cols;
+  CMATRIX A(nnucl, ncol);
+  CMATRIX B(nnucl, ncol);
+  contract_forces(ampl_dia, d1ham_dia, dc1_dia, &ampl_dia, A, B);
+
+  CMATRIX res(nnucl, 1);
+  for(int n=0;n<nnucl;n++){  res.M[n] = -(A.M[n*ncol] - Etot * B.M[n*ncol]);   }
 
   return res;
 }
@@ -36,6 +36,67 @@ using namespace libmeigen;
 
 
 
+void nac_hvib_kernel(vector<CMATRIX*>& dc1, const double* v, int stride, CMATRIX* nac, 
+                     CMATRIX* ham, CMATRIX* hvib, int antiherm){
+/**
+  \brief The fused kernel for the time-derivative couplings and the vibronic Hamiltonian
+
+  \param[in] dc1 The nnucl pointers to the [nst x nst] derivative coupling matrices
+  \param[in] v The nuclear velocities: v[n*stride] is the velocity of the DOF n. With stride = ntraj, 
+  this is a column of a row-major [nnucl x ntraj] matrix
+  \param[in] stride The distance between the velocities of the consecutive DOFs in the v array
+  \param[out] nac The [nst x nst] matrix of nonadiabatic couplings: nac = sum_n { v[n] * dc1[n] }
+  \param[in] ham The [nst x nst] electronic Hamiltonian; only used if hvib is not NULL
+  \param[out] hvib The [nst x nst] vibronic Hamiltonian, hvib = ham - i*hbar*nac; may be NULL
+  \param[in] antiherm If 1, the dc1 matrices are assumed to be anti-Hermitian (orthonormal basis), 
+  so only the upper triangle (including diagonal) is accumulated and the lower triangle is obtained as 
+  nac_ji = -conj(nac_ij). If 0, all the matrix elements are accumulated
+
+  This is a single pass over the contiguous dc1[n]->M arrays (a GEMV over [nnucl] x [nst^2]),
+  without the bounds-checking get/add calls and without an extra pass to assemble the Hvib.
+*/
+
+  int nnucl = dc1.size();
+  int nst = nac->n_rows;
+  int i,j,n;
+
+  complex<double>* x = nac->M;
+  const complex<double> ihbar(0.0, 1.0); // working in atomic units
+
+  for(i=0;i<nst*nst;i++){  x[i] = complex<double>(0.0, 0.0); }
+
+  for(n=0;n<nnucl;n++){ 
+
+    double v_n = v[n*stride];
+    complex<double>* d = dc1[n]->M;
+
+    if(antiherm){
+      for(i=0;i<nst;i++){
+        for(j=i;j<nst;j++){   x[i*nst+j] += v_n * d[i*nst+j];   }
+      }
+    }
+    else{
+      for(i=0;i<nst*nst;i++){   x[i] += v_n * d[i];   }
+    }
+
+  }// for n
+
+  if(antiherm){
+    for(i=0;i<nst;i++){
+      for(j=i+1;j<nst;j++){   x[j*nst+i] = -std::conj(x[i*nst+j]);   }
+    }
+  }
+
+  if(hvib!=NULL){
+    complex<double>* h = ham->M;
+    complex<double>* hv = hvib->M;
+    for(i=0;i<nst*nst;i++){  hv[i] = h[i] - ihbar * x[i];  }
+  }
+
+}
+
+
+
 
 void nHamiltonian::compute_nac_dia(MATRIX& p, const MATRIX& invM){
 /**  
@@ -52,24 +113,19 @@ void nHamiltonian::compute_nac_dia(MATRIX& p, const MATRIX& invM){
   if(nac_dia_mem_status==0){ cout<<"Error in compute_nac_dia(): the memory is not allocated for \
   nac_dia but is needed for the calculations \n"; exit(0); }
 
-  nac_dia->set(-1, std::complex<double>(0.0, 0.0));
+  vector<double> v(nnucl, 0.0);
 
   for(int n=0;n<nnucl;n++){ 
 
-    double v_n = p.get(n,0) * invM.get(n,0);
+    v[n] = p.get(n,0) * invM.get(n,0);
 
     if(dc1_dia_mem_status[n]==0){ cout<<"Error in compute_nac_dia(): the derivatives couplings matrix in the adiabatic \
     basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
-
-    for(int i=0;i<ndia;i++){
-      for(int j=0;j<ndia;j++){
-        nac_dia->add(i,j, v_n * dc1_dia[n]->get(i,j));
-      }// for j
-    }// for i
-
   }// for n
 
+  nac_hvib_kernel(dc1_dia, &v[0], 1, nac_dia, NULL, NULL, 0);
+
 }
 
 
@@ -182,23 +238,19 @@ void nHamiltonian::compute_nac_adi(MATRIX& p, const MATRIX& invM){
   if(nac_adi_mem_status==0){ cout<<"Error in compute_nac_adi(): the memory is not allocated for \
   nac_adi but is needed for the calculations \n"; exit(0); }
 
-  nac_adi->set(-1, std::complex<double>(0.0, 0.0));
+  vector<double> v(nnucl, 0.0);
 
   for(int n=0;n<nnucl;n++){ 
 
-    if(dc1_adi_mem_status[n]==0){ cout<<"Error in compute_nac_dia(): the derivatives couplings matrix in the adiabatic \
+    if(dc1_adi_mem_status[n]==0){ cout<<"Error in compute_nac_adi(): the derivatives couplings matrix in the adiabatic \
     basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
 
-    double v_n = p.get(n,0) * invM.get(n,0);
-
-    for(int i=0;i<nadi;i++){
-      for(int j=0;j<nadi;j++){
-        nac_adi->add(i,j, v_n * dc1_adi[n]->get(i,j));
-      }// for j
-    }// for i
+    v[n] = p.get(n,0) * invM.get(n,0);
 
   }// for n
 
+  nac_hvib_kernel(dc1_adi, &v[0], 1, nac_adi, NULL, NULL, 0);
+
 
 }
 
@@ -440,6 +492,247 @@ void nHamiltonian::compute_hvib_adi(int lvl){
 
 
 
+void nHamiltonian::compute_nac_hvib_dia(const double* v, int stride){
+/**
+  \brief Computes the diabatic NAC and Hvib of this Hamiltonian in one pass
+
+  \param[in] v The nuclear velocities, v[n*stride] is the velocity of DOF n
+
+  See nac_hvib_kernel for details
+*/
+
+  if(nac_dia_mem_status==0){ cout<<"Error in compute_nac_hvib_dia(): the memory is not allocated for \
+  nac_dia but is needed for the calculations \n"; exit(0); }
+
+  if(ham_dia_mem_status==0){ cout<<"Error in compute_nac_hvib_dia(): the memory is not allocated for \
+  ham_dia but is needed for the calculations \n"; exit(0); }
+
+  if(hvib_dia_mem_status==0){ cout<<"Error in compute_nac_hvib_dia(): the memory is not allocated for \
+  hvib_dia but is needed for the calculations \n"; exit(0); }
+
+  for(int n=0;n<nnucl;n++){ 
+    if(dc1_dia_mem_status[n]==0){ cout<<"Error in compute_nac_hvib_dia(): the derivatives couplings matrix in the diabatic \
+    basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
+  }
+
+  nac_hvib_kernel(dc1_dia, v, stride, nac_dia, ham_dia, hvib_dia, 0);
+
+}
+
+
+void nHamiltonian::compute_nac_hvib_dia(MATRIX& p, const MATRIX& invM){
+/**  
+  Computes both the nonadiabatic couplings and the vibronic Hamiltonian in the diabatic
+  representation, in a single pass:
+
+  nac_dia = sum_n { p[n]/mass[n] * dc1_dia[n] }
+  hvib_dia = ham_dia - i*hbar * nac_dia
+
+  The diabatic basis is not necessarily orthonormal, so the dc1_dia matrices are not 
+  anti-Hermitian and all the matrix elements are accumulated
+
+  \param[in] p [ndof x 1] matrix of nuclear momenta
+  \param[in] invM [ndof x 1] matrix of inverse nuclear masses
+
+  The result is the same as of compute_nac_dia(p, invM) followed by compute_hvib_dia()
+*/
+
+  vector<double> v(nnucl, 0.0);
+  for(int n=0;n<nnucl;n++){  v[n] = p.M[n*p.n_cols] * invM.M[n*invM.n_cols];  }
+
+  compute_nac_hvib_dia(&v[0], 1);
+
+}
+
+
+void nHamiltonian::compute_nac_hvib_dia(MATRIX& p, const MATRIX& invM, int lvl, int split){
+/**
+  \brief Computes both the NAC and the vibronic Hamiltonian in the diabatic representation, 
+  for the Hamiltonians of a given level
+
+  \param[in] p [ndof x 1] or [ndof x ntraj] matrix of nuclear momenta
+  \param[in] invM [ndof x 1] matrix of inverse nuclear masses
+  \param[in] lvl The level in the hierarchy of Hamiltonians at which we will perform the calculations
+  \param[in] split If 1, the column i of p is used by the i-th child of the present-level Hamiltonian.
+  The velocities of all the trajectories are computed at once and each child reads its column
+  directly, without extracting the sub-matrices
+
+  The use cases are the same as for compute_nac_dia(p, invM, lvl, split)
+*/
+  int i, n;
+
+  if(lvl==level){
+    if(split==0){   compute_nac_hvib_dia(p, invM);    }
+    else if(split==1){
+      // Check whether we have enough sub-Hamiltonians
+      if(children.size()!=p.n_cols){
+        cout<<"ERROR in void nHamiltonian::compute_nac_hvib_dia(const MATRIX& p, const MATRIX& invM, int lvl, int split):\n";
+        cout<<"The number of columns of the p ("<<p.n_cols<<")";
+        cout<<" should be equal to the number of children Hamiltonians ("<<children.size()<<")\n";
+        cout<<"Exiting...\n";
+        exit(0);
+      }
+
+      int ntraj = p.n_cols;
+      vector<double> v(nnucl*ntraj, 0.0);
+
+      for(n=0;n<nnucl;n++){
+        double im = invM.M[n*invM.n_cols];
+        for(i=0;i<ntraj;i++){  v[n*ntraj+i] = p.M[n*ntraj+i] * im;  }
+      }
+
+      for(i=0;i<ntraj;i++){
+        children[i]->compute_nac_hvib_dia(&v[i], ntraj);
+      }// for all children
+
+    }// split==1
+    else{
+      cout<<"ERROR in void nHamiltonian::compute_nac_hvib_dia(const MATRIX& p, const MATRIX& invM, int lvl, int split):\n";
+      cout<<"The parameters split = "<<split<<" is not defined\n";
+      cout<<"Exiting...\n";
+      exit(0);
+    }
+  }// lvl == level
+
+  else if(lvl>level){
+  
+    for(i=0;i<children.size();i++){
+      children[i]->compute_nac_hvib_dia(p, invM, lvl, split);
+    }
+
+  }// lvl >level
+
+  else{
+    cout<<"WARNING in nHamiltonian::compute_nac_hvib_dia\n"; 
+    cout<<"Can not run evaluation of function in the parent Hamiltonian from the\
+     child node\n";    
+  }
+}
+
+
+
+
+
+void nHamiltonian::compute_nac_hvib_adi(const double* v, int stride){
+/**
+  \brief Computes the adiabatic NAC and Hvib of this Hamiltonian in one pass
+
+  \param[in] v The nuclear velocities, v[n*stride] is the velocity of DOF n
+
+  See nac_hvib_kernel for details
+*/
+
+  if(nac_adi_mem_status==0){ cout<<"Error in compute_nac_hvib_adi(): the memory is not allocated for \
+  nac_adi but is needed for the calculations \n"; exit(0); }
+
+  if(ham_adi_mem_status==0){ cout<<"Error in compute_nac_hvib_adi(): the memory is not allocated for \
+  ham_adi but is needed for the calculations \n"; exit(0); }
+
+  if(hvib_adi_mem_status==0){ cout<<"Error in compute_nac_hvib_adi(): the memory is not allocated for \
+  hvib_adi but is needed for the calculations \n"; exit(0); }
+
+  for(int n=0;n<nnucl;n++){ 
+    if(dc1_adi_mem_status[n]==0){ cout<<"Error in compute_nac_hvib_adi(): the derivatives couplings matrix in the adiabatic \
+    basis w.r.t. the nuclear DOF "<<n<<" is not allocated but is needed for the calculations \n"; exit(0); }
+  }
+
+  nac_hvib_kernel(dc1_adi, v, stride, nac_adi, ham_adi, hvib_adi, 0);
+
+}
+
+
+void nHamiltonian::compute_nac_hvib_adi(MATRIX& p, const MATRIX& invM){
+/**  
+  Computes both the nonadiabatic couplings and the vibronic Hamiltonian in the adiabatic
+  representation, in a single pass:
+
+  nac_adi = sum_n { p[n]/mass[n] * dc1_adi[n] }
+  hvib_adi = ham_adi - i*hbar * nac_adi
+
+  All the elements of dc1_adi[n] are accumulated, as in compute_nac_adi: the derivative couplings
+  provided by the models need not be exactly anti-Hermitian, so they are not antisymmetrized here
+
+  \param[in] p [ndof x 1] matrix of nuclear momenta
+  \param[in] invM [ndof x 1] matrix of inverse nuclear masses
+
+  The result is the same as of compute_nac_adi(p, invM) followed by compute_hvib_adi()
+*/
+
+  vector<double> v(nnucl, 0.0);
+  for(int n=0;n<nnucl;n++){  v[n] = p.M[n*p.n_cols] * invM.M[n*invM.n_cols];  }
+
+  compute_nac_hvib_adi(&v[0], 1);
+
+}
+
+
+void nHamiltonian::compute_nac_hvib_adi(MATRIX& p, const MATRIX& invM, int lvl, int split){
+/**
+  \brief Computes both the NAC and the vibronic Hamiltonian in the adiabatic representation, 
+  for the Hamiltonians of a given level
+
+  \param[in] p [ndof x 1] or [ndof x ntraj] matrix of nuclear momenta
+  \param[in] invM [ndof x 1] matrix of inverse nuclear masses
+  \param[in] lvl The level in the hierarchy of Hamiltonians at which we will perform the calculations
+  \param[in] split If 1, the column i of p is used by the i-th child of the present-level Hamiltonian.
+  The velocities of all the trajectories are computed at once and each child reads its column
+  directly, without extracting the sub-matrices
+
+  The use cases are the same as for compute_nac_adi(p, invM, lvl, split)
+*/
+  int i, n;
+
+  if(lvl==level){
+    if(split==0){   compute_nac_hvib_adi(p, invM);    }
+    else if(split==1){
+      // Check whether we have enough sub-Hamiltonians
+      if(children.size()!=p.n_cols){
+        cout<<"ERROR in void nHamiltonian::compute_nac_hvib_adi(const MATRIX& p, const MATRIX& invM, int lvl, int split):\n";
+        cout<<"The number of columns of the p ("<<p.n_cols<<")";
+        cout<<" should be equal to the number of children Hamiltonians ("<<children.size()<<")\n";
+        cout<<"Exiting...\n";
+        exit(0);
+      }
+
+      int ntraj = p.n_cols;
+      vector<double> v(nnucl*ntraj, 0.0);
+
+      for(n=0;n<nnucl;n++){
+        double im = invM.M[n*invM.n_cols];
+        for(i=0;i<ntraj;i++){  v[n*ntraj+i] = p.M[n*ntraj+i] * im;  }
+      }
+
+      for(i=0;i<ntraj;i++){
+        children[i]->compute_nac_hvib_adi(&v[i], ntraj);
+      }// for all children
+
+    }// split==1
+    else{
+      cout<<"ERROR in void nHamiltonian::compute_nac_hvib_adi(const MATRIX& p, const MATRIX& invM, int lvl, int split):\n";
+      cout<<"The parameters split = "<<split<<" is not defined\n";
+      cout<<"Exiting...\n";
+      exit(0);
+    }
+  }// lvl == level
+
+  else if(lvl>level){
+  
+    for(i=0;i<children.size();i++){
+      children[i]->compute_nac_hvib_adi(p, invM, lvl, split);
+    }
+
+  }// lvl >level
+
+  else{
+    cout<<"WARNING in nHamiltonian::compute_nac_hvib_adi\n"; 
+    cout<<"Can not run evaluation of function in the parent Hamiltonian from the\
+     child node\n";    
+  }
+}
+
+
+
+
 }// namespace libhamiltonian_generic
 }// namespace libhamiltonian
 }// liblibra
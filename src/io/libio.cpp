@@ -30,11 +30,57 @@ void export_io_objects(){
 /** 
   \brief Exporter of libio classes and functions
 
-  It is empty - so far no functions/classes are exported to Python
-  mostly, they are for C++ utilization
+  Most of the functions are for C++ utilization, only the binary trajectory classes are exported
 
 */
 
+  scope().attr("TRJ_Q") = TRJ_Q;
+  scope().attr("TRJ_P") = TRJ_P;
+  scope().attr("TRJ_F") = TRJ_F;
+  scope().attr("TRJ_ISTATE") = TRJ_ISTATE;
+  scope().attr("TRJ_AMP") = TRJ_AMP;
+
+  class_<TrajectoryFrame>("TrajectoryFrame",init<>())
+      .def_readwrite("step",&TrajectoryFrame::step)
+      .def_readwrite("time",&TrajectoryFrame::time)
+      .def_readwrite("energies",&TrajectoryFrame::energies)
+      .def_readwrite("istate",&TrajectoryFrame::istate)
+      .def_readwrite("amp_re",&TrajectoryFrame::amp_re)
+      .def_readwrite("amp_im",&TrajectoryFrame::amp_im)
+      .def_readwrite("q",&TrajectoryFrame::q)
+      .def_readwrite("p",&TrajectoryFrame::p)
+      .def_readwrite("f",&TrajectoryFrame::f)
+  ;
+
+  class_<BinaryTrajectoryWriter, boost::noncopyable>("BinaryTrajectoryWriter",
+       init<std::string, int, int, int, int, int, double, double, double, int>())
+      .def(init<std::string, int, int, int, int, int, int>())
+      .def_readonly("ndof",&BinaryTrajectoryWriter::ndof)
+      .def_readonly("ntraj",&BinaryTrajectoryWriter::ntraj)
+      .def_readonly("nstates",&BinaryTrajectoryWriter::nstates)
+      .def_readonly("nenergies",&BinaryTrajectoryWriter::nenergies)
+      .def_readonly("flags",&BinaryTrajectoryWriter::flags)
+      .def_readonly("nframes",&BinaryTrajectoryWriter::nframes)
+      .def("write_frame",&BinaryTrajectoryWriter::write_frame)
+      .def("flush",&BinaryTrajectoryWriter::flush)
+      .def("close",&BinaryTrajectoryWriter::close)
+  ;
+
+  void (BinaryTrajectoryReader::*expt_read_frame_v1)(int, TrajectoryFrame&) = &BinaryTrajectoryReader::read_frame;
+  TrajectoryFrame (BinaryTrajectoryReader::*expt_read_frame_v2)(int) = &BinaryTrajectoryReader::read_frame;
+
+  class_<BinaryTrajectoryReader, boost::noncopyable>("BinaryTrajectoryReader",init<std::string>())
+      .def_readonly("ndof",&BinaryTrajectoryReader::ndof)
+      .def_readonly("ntraj",&BinaryTrajectoryReader::ntraj)
+      .def_readonly("nstates",&BinaryTrajectoryReader::nstates)
+      .def_readonly("nenergies",&BinaryTrajectoryReader::nenergies)
+      .def_readonly("flags",&BinaryTrajectoryReader::flags)
+      .def("nframes",&BinaryTrajectoryReader::nframes)
+      .def("refresh",&BinaryTrajectoryReader::refresh)
+      .def("read_frame",expt_read_frame_v1)
+      .def("read_frame",expt_read_frame_v2)
+  ;
+
 }// export_io_objects()
 
 
@@ -19,6 +19,7 @@
 
 
 #include "io.h"
+#include "traj_binary.h"
 
 /// liblibra 
 namespace liblibra{
@@ -0,0 +1,496 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file traj_binary.cpp
+  \brief The file implements the compact binary trajectory format (see traj_binary.h)
+*/
+
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <stdlib.h>
+#include <unistd.h>
+#include "traj_binary.h"
+
+
+/// liblibra
+namespace liblibra{
+
+/// libio namespace
+namespace libio{
+
+
+static const char TRJ_MAGIC[8] = {'L','I','B','R','A','T','R','J'};
+static const char FRM_MAGIC[4] = {'F','R','M','E'};
+static const int TRJ_VERSION = 1;
+static const int TRJ_HEADER_SIZE = 8 + 7*sizeof(int32_t) + 3*sizeof(double);
+
+
+template<typename X>
+static void put(vector<unsigned char>& buf, const X& val){
+  const unsigned char* c = (const unsigned char*)&val;
+  buf.insert(buf.end(), c, c + sizeof(X));
+}
+
+template<typename X>
+static void get(const unsigned char*& c, X& val){
+  memcpy(&val, c, sizeof(X));  c += sizeof(X);
+}
+
+template<typename X>
+static void get(const unsigned char*& c, const unsigned char* end, X& val){
+  if(end - c < (long)sizeof(X)){ cout<<"Error in BinaryTrajectoryReader::read_frame: the frame is shorter than its layout\n"; exit(0); }
+  get(c, val);
+}
+
+
+void compress_fixed_precision(const vector<double>& x, double prec, int stride, vector<unsigned char>& buf){
+/**
+  \brief Appends the fixed-precision (lossy) representation of an array to a byte buffer
+
+  \param[in] x The array to compress
+  \param[in] prec The precision: the values are stored with the resolution 1/prec
+  \param[in] stride The value x[i] is encoded as the difference with x[i-stride] (e.g. 3 - for Cartesian coordinates)
+  \param[in,out] buf The buffer to which the encoded bytes are appended
+*/
+
+  int n = x.size();
+  vector<int64_t> ix(n);
+  const double lim = 4.0e18;
+
+  for(int i=0;i<n;i++){
+    double v = x[i]*prec;
+    if(!(fabs(v)<lim)){
+      cout<<"Error in compress_fixed_precision: the value "<<x[i]<<" can not be represented with the precision "<<prec<<"\n";
+      exit(0);
+    }
+    ix[i] = (int64_t)llround(v);
+  }
+
+  for(int i=0;i<n;i++){
+    int64_t d = (i>=stride) ? (ix[i] - ix[i-stride]) : ix[i];
+    uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);   // zigzag: small |d| -> small z
+    while(z >= 0x80){  buf.push_back((unsigned char)(z | 0x80));  z >>= 7;  }
+    buf.push_back((unsigned char)z);
+  }
+
+}
+
+
+void decompress_fixed_precision(const unsigned char* buf, int nbytes, double prec, int stride, vector<double>& x){
+/**
+  \brief Decodes the array written by compress_fixed_precision
+
+  \param[in] buf The encoded bytes
+  \param[in] nbytes The number of the encoded bytes
+  \param[in] prec The precision used in the compression
+  \param[in] stride The stride used in the compression
+  \param[in,out] x The decoded array. Its size must be set to the number of encoded values on input
+*/
+
+  int n = x.size();
+  vector<int64_t> ix(n);
+  double iprec = 1.0/prec;
+  int pos = 0;
+
+  for(int i=0;i<n;i++){
+    uint64_t z = 0;
+    int shift = 0;
+    while(1){
+      if(pos>=nbytes){ cout<<"Error in decompress_fixed_precision: the compressed stream is too short\n"; exit(0); }
+      unsigned char c = buf[pos++];
+      z |= ((uint64_t)(c & 0x7f)) << shift;
+      if(!(c & 0x80)){ break; }
+      shift += 7;
+    }
+    int64_t d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+    ix[i] = (i>=stride) ? (ix[i-stride] + d) : d;
+    x[i] = ix[i]*iprec;
+  }
+
+}
+
+
+
+//========================== Writer ==================================
+
+void BinaryTrajectoryWriter::init(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_,
+                                  double prec_q_, double prec_p_, double prec_f_, int append){
+/**
+  \param[in] filename_ The name of the trajectory file. The index is written to filename_ + ".idx"
+  \param[in] ndof_ The number of coordinates (momenta, forces) per frame, e.g. 3*Natoms or nnucl*ntraj
+  \param[in] ntraj_ The number of trajectories the ndof_ values are composed of
+  \param[in] nstates_ The number of electronic states per trajectory (for TRJ_AMP)
+  \param[in] nenergies_ The number of per-frame scalars
+  \param[in] flags_ Which arrays to store: a combination of TRJ_Q, TRJ_P, TRJ_F, TRJ_ISTATE, TRJ_AMP
+  \param[in] prec_q_ The precision of the coordinates (1000.0 - the resolution is 0.001 Bohr)
+  \param[in] prec_p_ The precision of the momenta
+  \param[in] prec_f_ The precision of the forces
+  \param[in] append If 1 and the file exists, the new frames are added to it (the layout must be the same),
+  otherwise the file is overwritten. An empty file (or one shorter than the header) is started with a new header
+*/
+
+  filename = filename_;
+  ndof = ndof_;  ntraj = ntraj_;  nstates = nstates_;  nenergies = nenergies_;  flags = flags_;
+  prec_q = prec_q_;  prec_p = prec_p_;  prec_f = prec_f_;
+  nframes = 0;
+  is_open = 0;
+
+  if(ntraj<1 || ndof<0 || ndof % ntraj != 0){
+    cout<<"Error in BinaryTrajectoryWriter: ndof = "<<ndof<<" must be a multiple of ntraj = "<<ntraj<<"\n"; exit(0);
+  }
+  stride = ((ndof/ntraj) % 3 == 0) ? 3 : 1;
+
+  // An empty file, or one whose header was not written completely, holds no frames - it is started anew
+  int exists = 0;
+  if(append){
+    std::ifstream test(filename.c_str(), ios::binary | ios::ate);
+    exists = test.good() && (long long)test.tellg() >= TRJ_HEADER_SIZE;
+  }
+
+  if(exists){
+    // Check the layout and find the end of the last complete frame
+    vector<long long> offs;
+    long long end;
+    {
+      BinaryTrajectoryReader rd(filename);
+      if(rd.ndof!=ndof || rd.ntraj!=ntraj || rd.nstates!=nstates || rd.nenergies!=nenergies || rd.flags!=flags ||
+         rd.prec_q!=prec_q || rd.prec_p!=prec_p || rd.prec_f!=prec_f){
+        cout<<"Error in BinaryTrajectoryWriter: can not append to "<<filename<<" - the frame layout differs\n"; exit(0);
+      }
+      nframes = rd.nframes();
+      for(int i=0;i<nframes;i++){ offs.push_back(rd.get_offset(i)); }
+      end = rd.get_offset(nframes);
+    }
+
+    // Drop the incomplete frame (if any) and rewrite the index
+    if(truncate(filename.c_str(), end)!=0){
+      cout<<"Error in BinaryTrajectoryWriter: can not prepare "<<filename<<" for appending\n"; exit(0);
+    }
+    out.open(filename.c_str(), ios::in | ios::out | ios::binary);
+    out.seekp(0, ios::end);
+    idx.open((filename+".idx").c_str(), ios::out | ios::trunc | ios::binary);
+    if(nframes>0){ idx.write((const char*)&offs[0], nframes*sizeof(long long)); }
+  }
+  else{
+    out.open(filename.c_str(), ios::out | ios::trunc | ios::binary);
+    idx.open((filename+".idx").c_str(), ios::out | ios::trunc | ios::binary);
+    write_header();
+  }
+
+  if(!out.good() || !idx.good()){ cout<<"Error in BinaryTrajectoryWriter: can not open "<<filename<<"\n"; exit(0); }
+  is_open = 1;
+
+}
+
+BinaryTrajectoryWriter::BinaryTrajectoryWriter(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_,
+                                               double prec_q_, double prec_p_, double prec_f_, int append){
+/**
+  Opens the trajectory file for writing - see init() for the description of the parameters
+*/
+  init(filename_, ndof_, ntraj_, nstates_, nenergies_, flags_, prec_q_, prec_p_, prec_f_, append);
+}
+
+BinaryTrajectoryWriter::BinaryTrajectoryWriter(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_, int append){
+/**
+  Same as above, with the default precisions: 1e-3 for coordinates and momenta, 1e-5 for forces (atomic units)
+*/
+  init(filename_, ndof_, ntraj_, nstates_, nenergies_, flags_, 1000.0, 1000.0, 100000.0, append);
+}
+
+BinaryTrajectoryWriter::~BinaryTrajectoryWriter(){
+  close();
+}
+
+
+void BinaryTrajectoryWriter::write_header(){
+
+  vector<unsigned char> buf;
+  buf.insert(buf.end(), TRJ_MAGIC, TRJ_MAGIC + 8);
+  put(buf, (int32_t)TRJ_VERSION);
+  put(buf, (int32_t)ndof);
+  put(buf, (int32_t)ntraj);
+  put(buf, (int32_t)nstates);
+  put(buf, (int32_t)nenergies);
+  put(buf, (int32_t)flags);
+  put(buf, (int32_t)stride);
+  put(buf, prec_q);
+  put(buf, prec_p);
+  put(buf, prec_f);
+  out.write((const char*)&buf[0], buf.size());
+
+}
+
+
+void BinaryTrajectoryWriter::write_frame(const TrajectoryFrame& fr){
+/**
+  \brief Appends one frame to the trajectory and its offset to the index
+
+  \param[in] fr The frame. The sizes of all arrays selected by the flags must agree with the file layout
+*/
+
+  if(!is_open){ cout<<"Error in BinaryTrajectoryWriter::write_frame: the file is closed\n"; exit(0); }
+
+  int namp = ntraj*nstates;
+  if(fr.energies.size()!=nenergies){ cout<<"Error in BinaryTrajectoryWriter::write_frame: energies size must be "<<nenergies<<"\n"; exit(0); }
+  if((flags & TRJ_ISTATE) && fr.istate.size()!=ntraj){ cout<<"Error in BinaryTrajectoryWriter::write_frame: istate size must be "<<ntraj<<"\n"; exit(0); }
+  if((flags & TRJ_AMP) && (fr.amp_re.size()!=namp || fr.amp_im.size()!=namp)){
+    cout<<"Error in BinaryTrajectoryWriter::write_frame: amplitudes size must be "<<namp<<"\n"; exit(0);
+  }
+  if(((flags & TRJ_Q) && fr.q.size()!=ndof) || ((flags & TRJ_P) && fr.p.size()!=ndof) || ((flags & TRJ_F) && fr.f.size()!=ndof)){
+    cout<<"Error in BinaryTrajectoryWriter::write_frame: q, p and f sizes must be "<<ndof<<"\n"; exit(0);
+  }
+
+  vector<unsigned char> buf;
+  buf.reserve(64 + 8*nenergies + 4*ntraj + 16*namp + 3*2*ndof);
+
+  // Frame header; the payload size is filled in below
+  buf.insert(buf.end(), FRM_MAGIC, FRM_MAGIC + 4);
+  put(buf, (int32_t)0);
+  int head = buf.size();
+
+  put(buf, (int32_t)fr.step);
+  put(buf, fr.time);
+  for(int i=0;i<nenergies;i++){ put(buf, fr.energies[i]); }
+  if(flags & TRJ_ISTATE){ for(int i=0;i<ntraj;i++){ put(buf, (int32_t)fr.istate[i]); } }
+  if(flags & TRJ_AMP){
+    for(int i=0;i<namp;i++){ put(buf, fr.amp_re[i]); }
+    for(int i=0;i<namp;i++){ put(buf, fr.amp_im[i]); }
+  }
+
+  const vector<double>* arr[3] = { &fr.q, &fr.p, &fr.f };
+  const double prec[3] = { prec_q, prec_p, prec_f };
+  const int bit[3] = { TRJ_Q, TRJ_P, TRJ_F };
+
+  for(int a=0;a<3;a++){
+    if(!(flags & bit[a])){ continue; }
+    int pos = buf.size();
+    put(buf, (int32_t)0);
+    compress_fixed_precision(*arr[a], prec[a], stride, buf);
+    int32_t nb = buf.size() - pos - sizeof(int32_t);
+    memcpy(&buf[pos], &nb, sizeof(int32_t));
+  }
+
+  int32_t payload = buf.size() - head;
+  memcpy(&buf[4], &payload, sizeof(int32_t));
+
+  long long off = out.tellp();
+  out.write((const char*)&buf[0], buf.size());
+  idx.write((const char*)&off, sizeof(long long));
+  nframes++;
+
+}
+
+
+void BinaryTrajectoryWriter::flush(){
+/**
+  Forces the written frames to the disk, so they are visible to a concurrent reader
+*/
+  if(is_open){ out.flush(); idx.flush(); }
+}
+
+void BinaryTrajectoryWriter::close(){
+  if(is_open){ out.close(); idx.close(); is_open = 0; }
+}
+
+
+
+//========================== Reader ==================================
+
+BinaryTrajectoryReader::BinaryTrajectoryReader(std::string filename_){
+/**
+  \param[in] filename_ The name of the trajectory file
+
+  Reads the header and the frame index (rebuilding the latter if needed)
+*/
+
+  filename = filename_;
+  in.open(filename.c_str(), ios::binary);
+  if(!in.good()){ cout<<"Error in BinaryTrajectoryReader: can not open "<<filename<<"\n"; exit(0); }
+
+  read_header();
+  build_index();
+
+}
+
+BinaryTrajectoryReader::~BinaryTrajectoryReader(){
+  in.close();
+}
+
+
+void BinaryTrajectoryReader::read_header(){
+
+  unsigned char buf[TRJ_HEADER_SIZE];
+  in.seekg(0);
+  in.read((char*)buf, TRJ_HEADER_SIZE);
+  if(in.gcount()!=TRJ_HEADER_SIZE || memcmp(buf, TRJ_MAGIC, 8)){
+    cout<<"Error in BinaryTrajectoryReader: "<<filename<<" is not a binary trajectory file\n"; exit(0);
+  }
+
+  const unsigned char* c = buf + 8;
+  int32_t v;
+  get(c, v);  if(v!=TRJ_VERSION){ cout<<"Error in BinaryTrajectoryReader: unsupported version "<<v<<"\n"; exit(0); }
+  get(c, v);  ndof = v;
+  get(c, v);  ntraj = v;
+  get(c, v);  nstates = v;
+  get(c, v);  nenergies = v;
+  get(c, v);  flags = v;
+  get(c, v);  stride = v;
+  get(c, prec_q);
+  get(c, prec_p);
+  get(c, prec_f);
+
+}
+
+
+void BinaryTrajectoryReader::build_index(){
+/**
+  Uses the offsets from the .idx file as long as they point to valid frame headers, then scans the rest of
+  the file frame by frame (reading only the frame headers)
+*/
+
+  in.clear();
+  in.seekg(0, ios::end);
+  long long fsize = in.tellg();
+
+  offsets.clear();
+
+  std::ifstream ix((filename+".idx").c_str(), ios::binary);
+  long long off;
+  while(ix.good() && ix.read((char*)&off, sizeof(long long))){ offsets.push_back(off); }
+
+  // Validate the indexed frames; drop everything after the first inconsistency
+  long long expected = TRJ_HEADER_SIZE;
+  int n;
+  for(n=0;n<offsets.size();n++){
+    char mg[4]; int32_t sz;
+    if(offsets[n]!=expected || expected + 8 > fsize){ break; }
+    in.seekg(expected);
+    in.read(mg, 4);  in.read((char*)&sz, sizeof(int32_t));
+    if(memcmp(mg, FRM_MAGIC, 4) || sz<0 || expected + 8 + sz > fsize){ break; }
+    expected += 8 + sz;
+  }
+  offsets.resize(n);
+
+  // Scan the frames not covered by the index
+  while(expected + 8 <= fsize){
+    char mg[4]; int32_t sz;
+    in.clear();
+    in.seekg(expected);
+    in.read(mg, 4);  in.read((char*)&sz, sizeof(int32_t));
+    if(memcmp(mg, FRM_MAGIC, 4) || sz<0 || expected + 8 + sz > fsize){ break; }
+    offsets.push_back(expected);
+    expected += 8 + sz;
+  }
+  in.clear();
+
+  data_end = expected;
+
+}
+
+
+void BinaryTrajectoryReader::refresh(){
+/**
+  Updates the index to include the frames written since the file was opened
+*/
+  build_index();
+}
+
+
+void BinaryTrajectoryReader::read_frame(int i, TrajectoryFrame& fr){
+/**
+  \param[in] i The index of the frame to read (0 ... nframes()-1)
+  \param[out] fr The frame. The arrays not stored in the file are left empty
+
+  All reads are checked against the frame size, so a corrupt frame (or one that does not match the layout
+  in the header) stops with an error instead of reading past the frame
+*/
+
+  if(i<0 || i>=offsets.size()){
+    cout<<"Error in BinaryTrajectoryReader::read_frame: frame "<<i<<" is out of range [0,"<<offsets.size()<<")\n"; exit(0);
+  }
+
+  int32_t sz;
+  in.clear();
+  in.seekg(offsets[i] + 4);
+  in.read((char*)&sz, sizeof(int32_t));
+  if(in.gcount()!=sizeof(int32_t) || sz<=0){
+    cout<<"Error in BinaryTrajectoryReader::read_frame: frame "<<i<<" has an invalid size\n"; exit(0);
+  }
+  vector<unsigned char> buf(sz);
+  in.read((char*)&buf[0], sz);
+  if(in.gcount()!=sz){ cout<<"Error in BinaryTrajectoryReader::read_frame: frame "<<i<<" is truncated\n"; exit(0); }
+
+  const unsigned char* c = &buf[0];
+  const unsigned char* end = &buf[0] + sz;
+  int32_t v;
+  get(c, end, v);  fr.step = v;
+  get(c, end, fr.time);
+
+  fr.energies.resize(nenergies);
+  for(int k=0;k<nenergies;k++){ get(c, end, fr.energies[k]); }
+
+  fr.istate.clear();
+  if(flags & TRJ_ISTATE){
+    fr.istate.resize(ntraj);
+    for(int k=0;k<ntraj;k++){ get(c, end, v); fr.istate[k] = v; }
+  }
+
+  fr.amp_re.clear();  fr.amp_im.clear();
+  if(flags & TRJ_AMP){
+    int namp = ntraj*nstates;
+    fr.amp_re.resize(namp);  fr.amp_im.resize(namp);
+    for(int k=0;k<namp;k++){ get(c, end, fr.amp_re[k]); }
+    for(int k=0;k<namp;k++){ get(c, end, fr.amp_im[k]); }
+  }
+
+  vector<double>* arr[3] = { &fr.q, &fr.p, &fr.f };
+  const double prec[3] = { prec_q, prec_p, prec_f };
+  const int bit[3] = { TRJ_Q, TRJ_P, TRJ_F };
+
+  for(int a=0;a<3;a++){
+    arr[a]->clear();
+    if(!(flags & bit[a])){ continue; }
+    int32_t nb;
+    get(c, end, nb);
+    if(nb<0 || nb > end - c){
+      cout<<"Error in BinaryTrajectoryReader::read_frame: frame "<<i<<" - the compressed array is longer than the frame\n"; exit(0);
+    }
+    arr[a]->resize(ndof);
+    decompress_fixed_precision(c, nb, prec[a], stride, *arr[a]);
+    c += nb;
+  }
+
+}
+
+
+long long BinaryTrajectoryReader::get_offset(int i){
+/**
+  \param[in] i The index of the frame (0 ... nframes()). For i = nframes() - returns the end of the last complete frame
+*/
+  if(i<0 || i>offsets.size()){ cout<<"Error in BinaryTrajectoryReader::get_offset: frame "<<i<<" is out of range\n"; exit(0); }
+  return (i==offsets.size()) ? data_end : offsets[i];
+}
+
+
+TrajectoryFrame BinaryTrajectoryReader::read_frame(int i){
+/**
+  \param[in] i The index of the frame to read
+*/
+  TrajectoryFrame fr;
+  read_frame(i, fr);
+  return fr;
+}
+
+
+
+}// namespace libio
+}// liblibra
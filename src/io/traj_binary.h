@@ -0,0 +1,168 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file traj_binary.h
+  \brief The file describes the compact binary trajectory format and its writer/reader classes
+
+  File layout (native byte order):
+
+  Header:  "LIBRATRJ" | version | ndof | ntraj | nstates | nenergies | flags | stride | prec_q | prec_p | prec_f
+  Frame:   "FRME" | payload size | step | time | energies[nenergies] | istate[ntraj] | amp_re, amp_im[ntraj*nstates] |
+           for each of q, p, f present: nbytes | compressed stream
+
+  The q, p and f arrays are stored in the fixed-precision form (XTC-like): each value is rounded to an integer
+  in units of 1/prec, the difference with the same component of the previous particle (stride values back) is
+  zigzag-encoded and written as a variable-length integer. Small, smooth arrays then take 1-2 bytes per value.
+  The scalars (time, energies) and the amplitudes are stored without loss.
+
+  An index of the frame offsets is kept in the sidecar file <filename>.idx (64-bit offsets); it is rebuilt by
+  scanning the frame headers if it is missing or out of date. Frames left incomplete by an interrupted run are
+  ignored by the reader and overwritten by the next appending writer.
+*/
+
+#ifndef TRAJ_BINARY_H
+#define TRAJ_BINARY_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+
+/// liblibra
+namespace liblibra{
+
+using namespace std;
+
+/// libio namespace
+namespace libio{
+
+
+// Flags that define which arrays are stored in each frame
+const int TRJ_Q = 1;        ///< coordinates
+const int TRJ_P = 2;        ///< momenta
+const int TRJ_F = 4;        ///< forces
+const int TRJ_ISTATE = 8;   ///< active (occupied) state index of each trajectory
+const int TRJ_AMP = 16;     ///< electronic amplitudes of each trajectory
+
+
+class TrajectoryFrame{
+/**
+  \brief One frame of the binary trajectory
+
+  The q, p, f arrays contain ndof values each (for several trajectories - concatenated trajectory by trajectory),
+  istate - ntraj values, amp_re and amp_im - ntraj*nstates values each.
+*/
+
+public:
+
+  int step;                     ///< MD step index
+  double time;                  ///< time of the frame
+  vector<double> energies;      ///< any per-frame scalars (e.g. kinetic, potential, total energies)
+  vector<int> istate;           ///< active states
+  vector<double> amp_re;        ///< real parts of the electronic amplitudes
+  vector<double> amp_im;        ///< imaginary parts of the electronic amplitudes
+  vector<double> q;             ///< coordinates
+  vector<double> p;             ///< momenta
+  vector<double> f;             ///< forces
+
+  TrajectoryFrame(){ step = 0; time = 0.0; }
+
+};
+
+
+// Fixed-precision compression of an array of real values
+void compress_fixed_precision(const vector<double>& x, double prec, int stride, vector<unsigned char>& buf);
+void decompress_fixed_precision(const unsigned char* buf, int nbytes, double prec, int stride, vector<double>& x);
+
+
+class BinaryTrajectoryWriter{
+/**
+  \brief Writer of the appendable binary trajectories
+*/
+
+  std::string filename;
+  std::fstream out;             ///< trajectory file
+  std::fstream idx;             ///< sidecar index file
+  int is_open;
+
+  void init(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_,
+            double prec_q_, double prec_p_, double prec_f_, int append);
+  void write_header();
+
+public:
+
+  int ndof;                     ///< number of q (p, f) values per frame
+  int ntraj;                    ///< number of trajectories
+  int nstates;                  ///< number of electronic states per trajectory
+  int nenergies;                ///< number of per-frame scalars
+  int flags;                    ///< combination of TRJ_Q, TRJ_P, TRJ_F, TRJ_ISTATE, TRJ_AMP
+  int stride;                   ///< distance between the components that are delta-encoded against each other
+  double prec_q;                ///< precision (1/resolution) of the coordinates
+  double prec_p;                ///< precision of the momenta
+  double prec_f;                ///< precision of the forces
+  int nframes;                  ///< number of frames in the file
+
+
+  BinaryTrajectoryWriter(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_,
+                         double prec_q_, double prec_p_, double prec_f_, int append);
+  BinaryTrajectoryWriter(std::string filename_, int ndof_, int ntraj_, int nstates_, int nenergies_, int flags_, int append);
+ ~BinaryTrajectoryWriter();
+
+  void write_frame(const TrajectoryFrame& fr);
+  void flush();
+  void close();
+
+};
+
+
+class BinaryTrajectoryReader{
+/**
+  \brief Random-access reader of the binary trajectories
+*/
+
+  std::string filename;
+  std::ifstream in;
+  vector<long long> offsets;    ///< positions of the frames in the file
+  long long data_end;           ///< end of the last complete frame
+
+  void read_header();
+  void build_index();
+
+public:
+
+  int ndof;
+  int ntraj;
+  int nstates;
+  int nenergies;
+  int flags;
+  int stride;
+  double prec_q;
+  double prec_p;
+  double prec_f;
+
+  BinaryTrajectoryReader(std::string filename_);
+ ~BinaryTrajectoryReader();
+
+  int nframes(){ return offsets.size(); }  ///< Returns the number of complete frames in the file
+  void refresh();
+  long long get_offset(int i);
+
+  void read_frame(int i, TrajectoryFrame& fr);
+  TrajectoryFrame read_frame(int i);
+
+};
+
+
+}// namespace libio
+}// liblibra
+
+#endif // TRAJ_BINARY_H
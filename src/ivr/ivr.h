@@ -15,6 +15,7 @@
 #include "../math_linalg/liblinalg.h"
 #include "../math_random/librandom.h"
 #include "../math_meigen/libmeigen.h"
+#include <boost/python.hpp>
 
 /// liblibra namespace
 namespace liblibra{
@@ -76,6 +77,12 @@ public:
 
 
 
+/// The potential for the IVR propagators: given q (Ndof x 1) returns the 
+/// energy v, the gradient dv (Ndof x 1) and the Hessian d2v (Ndof x Ndof).
+/// From Python, the potential is given as a function py_funct(q, params) instead - see Integrator
+typedef void (*ivr_potential)(MATRIX& q, double& v, MATRIX& dv, MATRIX& d2v);
+
+
 class ivr_observable{
 
 public:
@@ -134,6 +141,9 @@ vector<complex<double> > DHK_prefactor
 ///============ Propagators  ===========================
 ///  In ivr_propagators.cpp
 void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt);
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, ivr_potential vdv);
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, 
+                boost::python::object py_funct, boost::python::object params);
 
 
 
@@ -154,6 +164,71 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,
 
 void normalize_tcf(vector< complex<double> >& TCF, vector<int>& MCnum);
 
+
+
+///============ Streaming TCF calculators  ===========================
+///  In ivr_timecorr_stream.cpp
+
+class ivr_tcf_accumulator{
+/**
+  Accumulates the unnormalized TCF one timestep at a time, keeping the running
+  state (overlap ratio, Maslov indices and the previous prefactors) of the current 
+  trajectory (pair), so the trajectories don't have to be stored
+*/
+
+public:
+
+  int ivr_opt;                          ///< 0 - Husimi/FF_MQC, 1 - LS-IVR/DHK
+  int observable_type;                  ///< 0 - for q, 1 - for p
+  int observable_label;                 ///< index of the DOF
+
+  vector< complex<double> > TCF;        ///< unnormalized TCF
+  vector<int> MCnum;                    ///< the number of the successful trajectories at every time step
+
+  double normC;                         ///< normalization constant of the current trajectory pair
+  complex<double> OverlapR;             ///< the overlap ratio of the current trajectory pair
+  vector<int> Maslov;                   ///< the Maslov indices along the current trajectory pair
+  vector< complex<double> > prev;       ///< the prefactors at the previous timestep
+
+  ivr_tcf_accumulator(int Ntime, int ivr_opt_, int observable_type_, int observable_label_);
+
+  void start(ivr_params& prms, MATRIX& q0, MATRIX& p0, MATRIX& qp0, MATRIX& pp0);
+  void add(int i, MATRIX& q, MATRIX& p, int status);
+  void add(ivr_params& prms, int i,
+           MATRIX& q,  MATRIX& p,  int status,  double action,  vector<MATRIX>& Mono,
+           MATRIX& qp, MATRIX& pp, int statusp, double actionp);
+  void merge(ivr_tcf_accumulator& acc);
+  vector< complex<double> > normalized();
+
+};
+
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, ivr_potential vdv);
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, 
+                       boost::python::object py_funct, boost::python::object params);
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label);
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, ivr_potential vdv);
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label,
+                       boost::python::object py_funct, boost::python::object params);
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label);
+
+
 }// namespace libivr
 }// liblibra
 
@@ -56,7 +56,8 @@ MATRIX divm(MATRIX& M, MATRIX& mass){
 }
 
 
-void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt){
+static void integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, 
+                       ivr_potential vdv, bp::object* py_funct, bp::object* params){
 /**
   \brief Symplectic integrator
 
@@ -67,6 +68,10 @@ void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX&
   \param[in/out] action - action 
   \param[in] mass - massed associated with all DOFs, a Ndof x Ndof matrix
   \param[in] dt - integration timestep
+  \param[in] vdv - the function that computes the potential, its gradient and Hessian at a given q
+  \param[in] py_funct, params - the Python function py_funct(q, params) that returns the list [v, dv, d2v]
+             (double, Ndof x 1 MATRIX, Ndof x Ndof MATRIX), and its parameters; used if vdv is NULL.
+             If both are NULL, the potential is zero (free particle)
 
 
 */
@@ -93,8 +98,13 @@ void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX&
   for(int j=0;j<4;j++){ 
 
    if(j>0){
-      ///   call vdv(q,v,dv,d2v)  !!! FIXME: Need to connect to the 
-      ///                         potential/derivative calculation                                 
+      if(vdv!=NULL){  vdv(q, v, dv, d2v);  }
+      else if(py_funct!=NULL){
+        bp::object res = (*py_funct)(q, *params);
+        v = bp::extract<double>(res[0]);
+        dv = bp::extract<MATRIX>(res[1]);
+        d2v = bp::extract<MATRIX>(res[2]);
+      }
 
       action   = action - b[j] * v;
       p   = p - b[j] * dv;
@@ -119,5 +129,35 @@ void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX&
 
 }
 
+
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt){
+/**
+  \brief Symplectic integrator - the version without the potential (free particle)
+*/
+
+  integrator(q, p, M, action, mass, dt, NULL, NULL, NULL);
+
+}
+
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, ivr_potential vdv){
+/**
+  \brief Symplectic integrator with the potential given by the C++ function vdv(q, v, dv, d2v)
+*/
+
+  integrator(q, p, M, action, mass, dt, vdv, NULL, NULL);
+
+}
+
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, 
+                bp::object py_funct, bp::object params){
+/**
+  \brief Symplectic integrator with the potential given by the Python function py_funct(q, params)
+  that returns the list [v, dv, d2v]
+*/
+
+  integrator(q, p, M, action, mass, dt, NULL, &py_funct, &params);
+
+}
+
 }/// namespace libivr
 }/// liblibra
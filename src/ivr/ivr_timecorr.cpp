@@ -27,6 +27,9 @@
   so we assume all the trajectories and the corresponding dependent quantities
   have been pre-computed and are now passed into these routines.
 
+  For the versions that don't need the whole trajectories to be stored, see
+  ivr_timecorr_stream.cpp
+
 */
 
 #include "ivr.h"
@@ -67,36 +70,14 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,
 
   int Ntime = TCF.size();
 
-  for(int i = 0; i < Ntime; i++){    MCnum[i] += status[i];   }
-
-
-  if(ivr_opt==0){  /// Husimi
-
-    for(int i = 0; i < Ntime; i++){  
-      if(status[i]==1){
-
-        TCF[i] = TCF[i] + mat_elt_HUS_B(q[i], p[i], observable_type, observable_label);
-
-      }
-    } // for i
-
-  }/// Husimi
-
-
-  else if(ivr_opt==1){  /// LS-IVR
-
-    for(int i = 0; i < Ntime; i++){  
-      if(status[i]==1){
-
-        TCF[i] = TCF[i] + mat_elt_LSC_B(q[i], p[i], observable_type, observable_label);
-
-      }
-    } // for i
-
-  }/// LS-IVR
-
+  ivr_tcf_accumulator acc(Ntime, ivr_opt, observable_type, observable_label);
 
+  for(int i = 0; i < Ntime; i++){  acc.add(i, q[i], p[i], status[i]);  }
 
+  for(int i = 0; i < Ntime; i++){
+    TCF[i] += acc.TCF[i];
+    MCnum[i] += acc.MCnum[i];
+  }
 
 }
 
@@ -130,7 +111,8 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,  ivr_params
   \param[in] pp - same meaning as p, just another point in the pair of the initial starting phase space points
   \param[in] statusp - same meaning as status, but for the "primed" trajectories (qp, pp)
   \param[in] actionp - action computed for all the time points of the trajectory, just another point ---
-  \param[in] Monop - monodromy matrices sampled along the trajectory, just another point ---
+  \param[in] Monop - monodromy matrices sampled along the trajectory, just another point --- (not used:
+             the prefactors are computed from Mono)
   \param[in] ivr_opt - option for slection of the type of the IVR: 0 (FF_MQC),  1 (DHK)
   \param[in] observable_type - a selector of the observable type: 0 - coordinates, 1 - momenta
   \param[in] observable_label - a selector of a specific DOF 
@@ -138,150 +120,22 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,  ivr_params
 
 */
 
-  int i;
-  int Ndof = q[0].n_rows;
   int Ntime = TCF.size();
 
-  for(i = 0; i < Ntime; i++){   MCnum[i] += status[i] * statusp[i];     }
-
-
-  MATRIX qIn(prms.get_qIn());
-  MATRIX pIn(prms.get_pIn());
-  MATRIX Width0(prms.get_Width0()); 
-  MATRIX invWidth0(prms.get_invWidth0());
-  MATRIX WidthT(prms.get_WidthT()); 
-  MATRIX invWidthT(prms.get_invWidthT());
-  MATRIX TuningQ(prms.get_TuningQ());
-  MATRIX invTuningQ(prms.get_invTuningQ());
-  MATRIX TuningP(prms.get_TuningP());
-  MATRIX invTuningP(prms.get_invTuningP());
-
-
-
-  if(ivr_opt==0){  /// FF_MQC
-
-
-    MATRIX norm(Ndof, Ndof); norm  = invTuningQ * invTuningP;
-    double normC = 1.0;
-    for(i = 0; i<Ndof; i++){   normC = normC * norm.get(i,i);   }
-    normC = sqrt(normC);
-
-
-    MATRIX qav(Ndof, 1); qav = 0.5*(q[0] + qp[0]);
-    MATRIX pav(Ndof, 1); pav = 0.5*(p[0] + pp[0]);
-
-    complex<double> ovlp = CS_overlap(qav, pav, qIn, pIn, Width0, invWidth0);
-    double sampling = (std::conj(ovlp) * ovlp).real();
-
-
-    // INITIAL COHERENT STATE OVERLAPS
-    ovlp  = CS_overlap(q[0],  p[0],  qIn, pIn, Width0, invWidth0);
-    complex<double> ovlpp = CS_overlap(qp[0], pp[0], qIn, pIn, Width0, invWidth0);
-
-    // OVERLAP RATIO
-    complex<double> OverlapR = (std::conj(ovlpp) * ovlp)/sampling;
-
-
-    int Maslov  = 0;
-    complex<double> prev(1.0, 0.0);
-
-    for(i = 0; i < Ntime; i++){  
-
-      if(status[i]==1 && statusp[i]==1){
+  /// The same accumulation as the streaming version (ivr_tcf_accumulator), only applied 
+  /// to the pre-computed trajectories
+  ivr_tcf_accumulator acc(Ntime, ivr_opt, observable_type, observable_label);
 
+  acc.start(prms, q[0], p[0], qp[0], pp[0]);
 
-        // POSITION MATRIX ELEMENT AT TIME t
-        complex<double> posn = mat_elt_FF_B(q[i], p[i], qp[i], pp[i], WidthT, invWidthT, observable_type, observable_label);
-
-        // MONODROMY MATRICES FOR PREFACTOR
-        vector<CMATRIX> Mfwd(4);  
-        Mfwd[0] = CMATRIX(Mono[i][0]);
-        Mfwd[1] = CMATRIX(Mono[i][1]);
-        Mfwd[2] = CMATRIX(Mono[i][2]);
-        Mfwd[3] = CMATRIX(Mono[i][3]);
-
-        vector<CMATRIX> Mbck(4);  
-        Mbck[0] = CMATRIX(Mono[i][3]).T();
-        Mbck[1] =-1.0 * CMATRIX(Mono[i][1]).T();
-        Mbck[2] =-1.0 * CMATRIX(Mono[i][2]).T();
-        Mbck[3] = CMATRIX(Mono[i][0]).T();
-
-        // CALCULATE PREFACTOR
-        complex<double> pref;
-        pref = MQC_prefactor_FF_G( Mfwd, Mbck, prms);
-
-
-        // TRACK MASLOV INDEX
-        if ((std::abs(pref)<0.0) && (pref.imag()*prev.imag()<0.0) ) { Maslov = Maslov + 1; }
-        prev  = pref;
-
-        // CALCULATE TCF
-        double argg = action[i] - actionp[i];
-        TCF[i] = TCF[i] + normC * OverlapR * pow(-1.0, Maslov) * posn * sqrt(pref) * complex<double>(cos(argg), sin(argg));
-
-      }
-    } // for i
-
-  }/// FF_QMC
-
-
-  if(ivr_opt==1){  /// DHK
-
-    vector<int> Maslov(2, 0);
-    vector<complex<double> > pref(2, complex<double>(1.0, 0.0)); 
-    vector<complex<double> > prev(2, complex<double>(1.0, 0.0)); 
-
-
-    // INITIAL COHERENT STATE OVERLAPS
-    complex<double> ovlp  = CS_overlap(q[0],  p[0],  qIn, pIn, Width0, invWidth0);
-    complex<double> ovlpp = CS_overlap(qp[0], pp[0], qIn, pIn, Width0, invWidth0);
-
-    // OVERLAP RATIO
-    complex<double> OverlapR = 1.0/(std::conj(ovlpp) * ovlp);
-
-
-
-    for(i = 0; i < Ntime; i++){  
-
-      if(status[i]==1 && statusp[i]==1){
-
-        // POSITION MATRIX ELEMENT AT TIME t
-        complex<double> posn = mat_elt_FF_B(q[i], p[i], qp[i], pp[i], WidthT, invWidthT, observable_type, observable_label);
-
-        // MONODROMY MATRICES FOR PREFACTOR
-        vector<CMATRIX> Mfwd(4);  
-        Mfwd[0] = CMATRIX(Mono[i][0]);
-        Mfwd[1] = CMATRIX(Mono[i][1]);
-        Mfwd[2] = CMATRIX(Mono[i][2]);
-        Mfwd[3] = CMATRIX(Mono[i][3]);
-
-        vector<CMATRIX> Mbck(4);  
-        Mbck[0] = CMATRIX(Mono[i][3]).T();
-        Mbck[1] =-1.0 * CMATRIX(Mono[i][1]).T();
-        Mbck[2] =-1.0 * CMATRIX(Mono[i][2]).T();
-        Mbck[3] = CMATRIX(Mono[i][0]).T();
-
-        // CALCULATE PREFACTOR
-        pref = DHK_prefactor(Mfwd, Mbck, prms);
-
-        // TRACK MASLOV INDEX
-        if ((std::abs(pref[0])<0.0) && (pref[0].imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
-        if ((std::abs(pref[1])<0.0) && (pref[1].imag()*prev[1].imag()<0.0) ) { Maslov[1] = Maslov[1] + 1; }
-        prev  = pref;
-
-
-        // CALCULATE TCF
-        double argg = action[i] - actionp[i];
-        TCF[i] = TCF[i] + OverlapR * pow(-1.0, Maslov[0]+Maslov[1]) * posn * sqrt(pref[0]*pref[1]) * complex<double>(cos(argg), sin(argg));
-
-
-      }// if trajectories are included
-
-    }// for i
-
-  }// DHK
-
+  for(int i = 0; i < Ntime; i++){  
+    acc.add(prms, i, q[i], p[i], status[i], action[i], Mono[i], qp[i], pp[i], statusp[i], actionp[i]);
+  }
 
+  for(int i = 0; i < Ntime; i++){
+    TCF[i] += acc.TCF[i];
+    MCnum[i] += acc.MCnum[i];
+  }
 
 }
 
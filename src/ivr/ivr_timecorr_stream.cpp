@@ -0,0 +1,498 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file ivr_timecorr_stream.cpp
+  \brief The streaming version of the TCF calculators in ivr_timecorr.cpp
+
+  Instead of storing q, p, action and the monodromy matrices for all the timesteps
+  of a trajectory (pair) and then computing its contribution to the TCF, the
+  contribution of each timestep is folded into the TCF as soon as the timestep is
+  available. The running quantities (overlap ratio, Maslov indices, previous prefactors)
+  are kept in the ivr_tcf_accumulator object.
+
+*/
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ivr.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libivr namespace
+namespace libivr{
+
+
+
+ivr_tcf_accumulator::ivr_tcf_accumulator(int Ntime, int ivr_opt_, int observable_type_, int observable_label_){
+/**
+  \brief Constructor
+
+  \param[in] Ntime - the number of time points in the TCF
+  \param[in] ivr_opt_ - the type of the IVR. With the single-trajectory add() it is 0 (Husimi) or 1 (LS-IVR),
+             with the trajectory-pair add() it is 0 (FF_MQC) or 1 (DHK) - same as in compute_tcf
+  \param[in] observable_type_ - a selector of the observable type: 0 - coordinates, 1 - momenta
+  \param[in] observable_label_ - a selector of a specific DOF
+*/
+
+  ivr_opt = ivr_opt_;
+  observable_type = observable_type_;
+  observable_label = observable_label_;
+
+  TCF = vector< complex<double> >(Ntime, complex<double>(0.0, 0.0));
+  MCnum = vector<int>(Ntime, 0);
+
+  normC = 1.0;
+  OverlapR = complex<double>(1.0, 0.0);
+  Maslov = vector<int>(2, 0);
+  prev = vector< complex<double> >(2, complex<double>(1.0, 0.0));
+
+}
+
+
+void ivr_tcf_accumulator::start(ivr_params& prms, MATRIX& q0, MATRIX& p0, MATRIX& qp0, MATRIX& pp0){
+/**
+  \brief Starts the accumulation of a new trajectory pair
+
+  Computes the initial coherent state overlaps and resets the Maslov index tracking.
+
+  \param[in] prms - the IVR parameters
+  \param[in] q0, p0 - the initial phase space point of the trajectory
+  \param[in] qp0, pp0 - the initial phase space point of the "primed" trajectory
+*/
+
+  int i;
+  int Ndof = q0.n_rows;
+
+  MATRIX qIn(prms.get_qIn());
+  MATRIX pIn(prms.get_pIn());
+  MATRIX Width0(prms.get_Width0()); 
+  MATRIX invWidth0(prms.get_invWidth0());
+
+  Maslov = vector<int>(2, 0);
+  prev = vector< complex<double> >(2, complex<double>(1.0, 0.0));
+
+
+  // INITIAL COHERENT STATE OVERLAPS
+  complex<double> ovlp  = CS_overlap(q0,  p0,  qIn, pIn, Width0, invWidth0);
+  complex<double> ovlpp = CS_overlap(qp0, pp0, qIn, pIn, Width0, invWidth0);
+
+
+  if(ivr_opt==0){  /// FF_MQC
+
+    MATRIX norm(Ndof, Ndof); norm = prms.get_invTuningQ() * prms.get_invTuningP();
+    normC = 1.0;
+    for(i = 0; i<Ndof; i++){   normC = normC * norm.get(i,i);   }
+    normC = sqrt(normC);
+
+    MATRIX qav(Ndof, 1); qav = 0.5*(q0 + qp0);
+    MATRIX pav(Ndof, 1); pav = 0.5*(p0 + pp0);
+
+    complex<double> ovlp_av = CS_overlap(qav, pav, qIn, pIn, Width0, invWidth0);
+    double sampling = (std::conj(ovlp_av) * ovlp_av).real();
+
+    // OVERLAP RATIO
+    OverlapR = (std::conj(ovlpp) * ovlp)/sampling;
+
+  }
+  else if(ivr_opt==1){  /// DHK
+
+    normC = 1.0;
+
+    // OVERLAP RATIO
+    OverlapR = 1.0/(std::conj(ovlpp) * ovlp);
+
+  }
+
+}
+
+
+void ivr_tcf_accumulator::add(int i, MATRIX& q, MATRIX& p, int status){
+/**
+  \brief Adds the contribution of the timestep i of a single trajectory (Husimi or LS-IVR)
+
+  \param[in] i - the index of the timestep
+  \param[in] q, p - the phase space point of the trajectory at this timestep
+  \param[in] status - 1 (success) or 0 (bad trajectory at this point - not included)
+*/
+
+  MCnum[i] += status;
+
+  if(status==1){
+
+    if(ivr_opt==0){  /// Husimi
+      TCF[i] = TCF[i] + mat_elt_HUS_B(q, p, observable_type, observable_label);
+    }
+    else if(ivr_opt==1){  /// LS-IVR
+      TCF[i] = TCF[i] + mat_elt_LSC_B(q, p, observable_type, observable_label);
+    }
+
+  }
+
+}
+
+
+void ivr_tcf_accumulator::add(ivr_params& prms, int i,
+     MATRIX& q,  MATRIX& p,  int status,  double action,  vector<MATRIX>& Mono,
+     MATRIX& qp, MATRIX& pp, int statusp, double actionp){
+/**
+  \brief Adds the contribution of the timestep i of a trajectory pair (FF_MQC or DHK)
+
+  The function start() should have been called for this trajectory pair before.
+  The timesteps must be added in order, since the Maslov index is tracked along the trajectory.
+
+  \param[in] prms - the IVR parameters
+  \param[in] i - the index of the timestep
+  \param[in] q, p, status, action, Mono - the phase space point, status, action and the 4 monodromy
+  matrices (M11, M12, M21, M22) of the trajectory at this timestep
+  \param[in] qp, pp, statusp, actionp - same for the "primed" trajectory (its monodromy matrices
+  do not enter the prefactors)
+*/
+
+  MCnum[i] += status * statusp;
+
+  if(status==1 && statusp==1){
+
+    MATRIX WidthT(prms.get_WidthT()); 
+    MATRIX invWidthT(prms.get_invWidthT());
+
+    // POSITION MATRIX ELEMENT AT TIME t
+    complex<double> posn = mat_elt_FF_B(q, p, qp, pp, WidthT, invWidthT, observable_type, observable_label);
+
+    // MONODROMY MATRICES FOR PREFACTOR
+    // (pushed back, rather than assigned to the default-constructed elements, which have no storage)
+    vector<CMATRIX> Mfwd;
+    Mfwd.push_back(CMATRIX(Mono[0]));
+    Mfwd.push_back(CMATRIX(Mono[1]));
+    Mfwd.push_back(CMATRIX(Mono[2]));
+    Mfwd.push_back(CMATRIX(Mono[3]));
+
+    vector<CMATRIX> Mbck;
+    Mbck.push_back( CMATRIX(Mono[3]).T());
+    Mbck.push_back(-1.0 * CMATRIX(Mono[1]).T());
+    Mbck.push_back(-1.0 * CMATRIX(Mono[2]).T());
+    Mbck.push_back( CMATRIX(Mono[0]).T());
+
+    double argg = action - actionp;
+
+    if(ivr_opt==0){  /// FF_MQC
+
+      // CALCULATE PREFACTOR
+      complex<double> pref = MQC_prefactor_FF_G( Mfwd, Mbck, prms);
+
+      // TRACK MASLOV INDEX
+      if ((std::abs(pref)<0.0) && (pref.imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
+      prev[0] = pref;
+
+      // CALCULATE TCF
+      TCF[i] = TCF[i] + normC * OverlapR * pow(-1.0, Maslov[0]) * posn * sqrt(pref) * complex<double>(cos(argg), sin(argg));
+
+    }
+    else if(ivr_opt==1){  /// DHK
+
+      // CALCULATE PREFACTOR
+      vector<complex<double> > pref = DHK_prefactor(Mfwd, Mbck, prms);
+
+      // TRACK MASLOV INDEX
+      if ((std::abs(pref[0])<0.0) && (pref[0].imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
+      if ((std::abs(pref[1])<0.0) && (pref[1].imag()*prev[1].imag()<0.0) ) { Maslov[1] = Maslov[1] + 1; }
+      prev = pref;
+
+      // CALCULATE TCF
+      TCF[i] = TCF[i] + OverlapR * pow(-1.0, Maslov[0]+Maslov[1]) * posn * sqrt(pref[0]*pref[1]) * complex<double>(cos(argg), sin(argg));
+
+    }
+
+  }// if trajectories are included
+
+}
+
+
+void ivr_tcf_accumulator::merge(ivr_tcf_accumulator& acc){
+/**
+  \brief Adds the unnormalized TCF and the counters of another accumulator to this one
+*/
+
+  if(acc.TCF.size()!=TCF.size()){
+    cout<<"Error in ivr_tcf_accumulator::merge: The number of time points in the accumulators ("
+        <<TCF.size()<<" and "<<acc.TCF.size()<<") differ\n";
+    exit(0);
+  }
+
+  for(int i=0; i<TCF.size(); i++){
+    TCF[i] += acc.TCF[i];
+    MCnum[i] += acc.MCnum[i];
+  }
+
+}
+
+
+vector< complex<double> > ivr_tcf_accumulator::normalized(){
+/**
+  \brief Returns the normalized TCF (see normalize_tcf); the accumulated data are not changed
+*/
+
+  vector< complex<double> > res(TCF);
+  normalize_tcf(res, MCnum);
+  return res;
+
+}
+
+
+
+
+static void tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                      vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                      int ivr_opt, int observable_type, int observable_label, 
+                      ivr_potential vdv, bp::object* py_funct, bp::object* params){
+/**
+  \brief Propagates a batch of Monte Carlo samples and accumulates their contributions to the
+  unnormalized TCF (Husimi or LS-IVR), without storing the trajectories
+
+  \param[in/out] TCF - the storage for the unnormalized TCF being computed; Ntime = TCF.size() time points
+  \param[in/out] MCnum - a counter of the successful trajectories at every time step
+  \param[in] q0, p0 - the initial coordinates and momenta of all the MC samples (Ndof x 1 matrices each)
+  \param[in] mass - massed associated with all DOFs, a Ndof x Ndof matrix
+  \param[in] dt - integration timestep
+  \param[in] ivr_opt - 0 (Husimi), 1 (LS-IVR)
+  \param[in] observable_type - a selector of the observable type: 0 - coordinates, 1 - momenta
+  \param[in] observable_label - a selector of a specific DOF
+  \param[in] vdv, py_funct, params - the potential, see Integrator
+
+  The samples are distributed over the OpenMP threads (if enabled), each with its own accumulator.
+  The partial sums are then added in the order of the threads. A Python potential can only be called
+  by the thread holding the interpreter lock, so in this case the samples are propagated serially.
+
+*/
+
+  int nsamples = q0.size();
+  int Ntime = TCF.size();
+  int nthreads = 1;
+
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+
+  vector<ivr_tcf_accumulator> acc(nthreads, ivr_tcf_accumulator(Ntime, ivr_opt, observable_type, observable_label));
+
+  #pragma omp parallel for schedule(static) if(py_funct==NULL)
+  for(int s=0; s<nsamples; s++){
+
+    int ith = 0;
+#ifdef _OPENMP
+    ith = omp_get_thread_num();
+#endif
+
+    int Ndof = q0[s].n_rows;
+    MATRIX q(q0[s]);
+    MATRIX p(p0[s]);
+    vector<MATRIX> M(4, MATRIX(Ndof, Ndof));
+    double action = 0.0;
+
+    for(int i=0; i<Ntime; i++){
+      if(i>0){
+        if(py_funct!=NULL){  Integrator(q, p, M, action, mass, dt, *py_funct, *params);  }
+        else{  Integrator(q, p, M, action, mass, dt, vdv);  }
+      }
+      acc[ith].add(i, q, p, 1);
+    }
+
+  }// for s
+
+  for(int ith=0; ith<nthreads; ith++){
+    for(int i=0; i<Ntime; i++){
+      TCF[i] += acc[ith].TCF[i];
+      MCnum[i] += acc[ith].MCnum[i];
+    }
+  }
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, ivr_potential vdv){
+/**
+  \brief Husimi or LS-IVR TCF of a batch of samples, with the potential given by the C++ function vdv
+  (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, q0, p0, mass, dt, ivr_opt, observable_type, observable_label, vdv, NULL, NULL);
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, 
+                       bp::object py_funct, bp::object params){
+/**
+  \brief Husimi or LS-IVR TCF of a batch of samples, with the potential given by the Python function
+  py_funct(q, params) that returns the list [v, dv, d2v] (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, q0, p0, mass, dt, ivr_opt, observable_type, observable_label, NULL, &py_funct, &params);
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label){
+/**
+  \brief Husimi or LS-IVR TCF of a batch of free particles (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, q0, p0, mass, dt, ivr_opt, observable_type, observable_label, NULL, NULL, NULL);
+
+}
+
+
+
+static void tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                      vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                      MATRIX& mass, double dt,
+                      int ivr_opt, int observable_type, int observable_label, 
+                      ivr_potential vdv, bp::object* py_funct, bp::object* params){
+/**
+  \brief Propagates a batch of Monte Carlo trajectory pairs and accumulates their contributions to the
+  unnormalized TCF (FF_MQC or DHK), without storing the trajectories or the monodromy matrices
+
+  \param[in/out] TCF - the storage for the unnormalized TCF being computed; Ntime = TCF.size() time points
+  \param[in/out] MCnum - a counter of the successful trajectories at every time step
+  \param[in] prms - the IVR parameters
+  \param[in] q0, p0 - the initial coordinates and momenta of all the MC samples (Ndof x 1 matrices each)
+  \param[in] qp0, pp0 - the initial coordinates and momenta of the "primed" trajectories of all the MC samples
+  \param[in] mass - massed associated with all DOFs, a Ndof x Ndof matrix
+  \param[in] dt - integration timestep
+  \param[in] ivr_opt - 0 (FF_MQC), 1 (DHK)
+  \param[in] observable_type - a selector of the observable type: 0 - coordinates, 1 - momenta
+  \param[in] observable_label - a selector of a specific DOF
+  \param[in] vdv, py_funct, params - the potential, see Integrator
+
+  The monodromy matrices start as identities (M11 = M22 = I, M12 = M21 = 0), the actions are
+  accumulated along each trajectory. Each trajectory pair keeps only its current state, so the
+  memory does not grow with the length of the propagation. As in the single-trajectory version, the
+  pairs are propagated serially if the potential is a Python function.
+
+*/
+
+  int nsamples = q0.size();
+  int Ntime = TCF.size();
+  int nthreads = 1;
+
+  if(p0.size()!=nsamples || qp0.size()!=nsamples || pp0.size()!=nsamples){
+    cout<<"Error in compute_tcf_batch: The number of samples in q0, p0, qp0 and pp0 should be the same\n";
+    exit(0);
+  }
+
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+
+  vector<ivr_tcf_accumulator> acc(nthreads, ivr_tcf_accumulator(Ntime, ivr_opt, observable_type, observable_label));
+
+  #pragma omp parallel for schedule(static) if(py_funct==NULL)
+  for(int s=0; s<nsamples; s++){
+
+    int ith = 0;
+#ifdef _OPENMP
+    ith = omp_get_thread_num();
+#endif
+
+    int Ndof = q0[s].n_rows;
+
+    MATRIX q(q0[s]);   MATRIX p(p0[s]);
+    MATRIX qp(qp0[s]); MATRIX pp(pp0[s]);
+
+    MATRIX I(Ndof, Ndof); I.identity();
+    vector<MATRIX> M(4, MATRIX(Ndof, Ndof));  M[0] = I;  M[3] = I;
+    vector<MATRIX> Mp(M);
+
+    double action = 0.0, actionp = 0.0;
+    double daction = 0.0, dactionp = 0.0;
+
+    acc[ith].start(prms, q, p, qp, pp);
+
+    for(int i=0; i<Ntime; i++){
+
+      if(i>0){
+        if(py_funct!=NULL){
+          Integrator(q,  p,  M,  daction,  mass, dt, *py_funct, *params);
+          Integrator(qp, pp, Mp, dactionp, mass, dt, *py_funct, *params);
+        }
+        else{
+          Integrator(q,  p,  M,  daction,  mass, dt, vdv);
+          Integrator(qp, pp, Mp, dactionp, mass, dt, vdv);
+        }
+        action  += daction;
+        actionp += dactionp;
+      }
+
+      acc[ith].add(prms, i, q, p, 1, action, M, qp, pp, 1, actionp);
+
+    }// for i
+
+  }// for s
+
+  for(int ith=0; ith<nthreads; ith++){
+    for(int i=0; i<Ntime; i++){
+      TCF[i] += acc[ith].TCF[i];
+      MCnum[i] += acc[ith].MCnum[i];
+    }
+  }
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label, ivr_potential vdv){
+/**
+  \brief FF_MQC or DHK TCF of a batch of trajectory pairs, with the potential given by the C++ function vdv
+  (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, prms, q0, p0, qp0, pp0, mass, dt, ivr_opt, observable_type, observable_label, vdv, NULL, NULL);
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label,
+                       bp::object py_funct, bp::object params){
+/**
+  \brief FF_MQC or DHK TCF of a batch of trajectory pairs, with the potential given by the Python function
+  py_funct(q, params) that returns the list [v, dv, d2v] (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, prms, q0, p0, qp0, pp0, mass, dt, ivr_opt, observable_type, observable_label, NULL, &py_funct, &params);
+
+}
+
+void compute_tcf_batch(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label){
+/**
+  \brief FF_MQC or DHK TCF of a batch of free trajectory pairs (see tcf_batch)
+*/
+
+  tcf_batch(TCF, MCnum, prms, q0, p0, qp0, pp0, mass, dt, ivr_opt, observable_type, observable_label, NULL, NULL, NULL);
+
+}
+
+
+
+}/// namespace libivr
+}/// liblibra
+
@@ -163,7 +163,10 @@ void export_ivr_objects(){
   ///============ Propagators  ===========================
   ///  In ivr_propagators.cpp
   void (*expt_Integrator_v1)(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt) = &Integrator;
+  void (*expt_Integrator_v2)(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt,
+                             bp::object py_funct, bp::object params) = &Integrator;
   def("Integrator", expt_Integrator_v1);
+  def("Integrator", expt_Integrator_v2);
 
 
 
@@ -189,6 +192,54 @@ void export_ivr_objects(){
 
 
 
+  ///============ Streaming TCF calculators  ===========================
+  ///  In ivr_timecorr_stream.cpp
+
+  void (ivr_tcf_accumulator::*expt_add_v1)(int i, MATRIX& q, MATRIX& p, int status) = &ivr_tcf_accumulator::add;
+  void (ivr_tcf_accumulator::*expt_add_v2)(ivr_params& prms, int i,
+           MATRIX& q,  MATRIX& p,  int status,  double action,  vector<MATRIX>& Mono,
+           MATRIX& qp, MATRIX& pp, int statusp, double actionp) = &ivr_tcf_accumulator::add;
+
+  class_<ivr_tcf_accumulator>("ivr_tcf_accumulator",init<int, int, int, int>())
+    .def("start", &ivr_tcf_accumulator::start)
+    .def("add", expt_add_v1)
+    .def("add", expt_add_v2)
+    .def("merge", &ivr_tcf_accumulator::merge)
+    .def("normalized", &ivr_tcf_accumulator::normalized)
+
+    .def_readwrite("ivr_opt",&ivr_tcf_accumulator::ivr_opt)
+    .def_readwrite("observable_type",&ivr_tcf_accumulator::observable_type)
+    .def_readwrite("observable_label",&ivr_tcf_accumulator::observable_label)
+    .def_readwrite("TCF",&ivr_tcf_accumulator::TCF)
+    .def_readwrite("MCnum",&ivr_tcf_accumulator::MCnum)
+  ;
+
+
+  void (*expt_compute_tcf_batch_v1)(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label) = &compute_tcf_batch;
+  void (*expt_compute_tcf_batch_v2)(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label) = &compute_tcf_batch;
+  void (*expt_compute_tcf_batch_v3)(vector< complex<double> >& TCF, vector<int>& MCnum,
+                       vector<MATRIX>& q0, vector<MATRIX>& p0, MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label,
+                       bp::object py_funct, bp::object params) = &compute_tcf_batch;
+  void (*expt_compute_tcf_batch_v4)(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms,
+                       vector<MATRIX>& q0,  vector<MATRIX>& p0, vector<MATRIX>& qp0, vector<MATRIX>& pp0,
+                       MATRIX& mass, double dt,
+                       int ivr_opt, int observable_type, int observable_label,
+                       bp::object py_funct, bp::object params) = &compute_tcf_batch;
+
+  def("compute_tcf_batch", expt_compute_tcf_batch_v1);
+  def("compute_tcf_batch", expt_compute_tcf_batch_v2);
+  def("compute_tcf_batch", expt_compute_tcf_batch_v3);
+  def("compute_tcf_batch", expt_compute_tcf_batch_v4);
+
+
+
+
 } // export_ivr_objects()
 
 
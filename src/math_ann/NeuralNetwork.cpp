@@ -50,6 +50,9 @@ void NeuralNetwork::set(object obj){
   set_value(is_norm_exp,      norm_exp,      obj, "norm_exp");
   set_value(is_a_plus,        a_plus,        obj, "a_plus");
   set_value(is_a_minus,       a_minus,       obj, "a_minus");
+  set_value(is_adam_beta1,    adam_beta1,    obj, "adam_beta1");
+  set_value(is_adam_beta2,    adam_beta2,    obj, "adam_beta2");
+  set_value(is_adam_epsilon,  adam_epsilon,  obj, "adam_epsilon");
 
   set_list(is_weight_decay,   weight_decay,  obj, "weight_decay");
 
@@ -72,6 +75,9 @@ void NeuralNetwork::set(boost::python::dict d){
     else if(key=="norm_exp") { norm_exp = extract<double>(d.values()[i]);  is_norm_exp = 1; }
     else if(key=="a_plus") { a_plus = extract<double>(d.values()[i]);  is_a_plus = 1; }
     else if(key=="a_minus") { a_minus = extract<double>(d.values()[i]);  is_a_minus = 1; }
+    else if(key=="adam_beta1") { adam_beta1 = extract<double>(d.values()[i]);  is_adam_beta1 = 1; }
+    else if(key=="adam_beta2") { adam_beta2 = extract<double>(d.values()[i]);  is_adam_beta2 = 1; }
+    else if(key=="adam_epsilon") { adam_epsilon = extract<double>(d.values()[i]);  is_adam_epsilon = 1; }
     else if(key=="weight_decay") { 
       boost::python::list tmp = extract<boost::python::list>(d.values()[i]);
       for(int j=0; j<len(tmp); j++){  weight_decay.push_back( extract<double>(tmp[j]) );  }
@@ -99,6 +105,9 @@ NeuralNetwork::NeuralNetwork(const NeuralNetwork& ann){
             is_norm_exp        = 0;
             is_a_plus          = 0;
             is_a_minus         = 0;
+            is_adam_beta1      = 0;
+            is_adam_beta2      = 0;
+            is_adam_epsilon    = 0;
 
             derivs_flag = 0;
 
@@ -117,6 +126,9 @@ NeuralNetwork::NeuralNetwork(const NeuralNetwork& ann){
   if(ann.is_norm_exp)      { norm_exp       = ann.norm_exp;      is_norm_exp      = 1; }
   if(ann.is_a_plus)        { a_plus         = ann.a_plus;        is_a_plus        = 1; }
   if(ann.is_a_minus)       { a_minus        = ann.a_minus;       is_a_minus       = 1; }
+  if(ann.is_adam_beta1)    { adam_beta1     = ann.adam_beta1;    is_adam_beta1    = 1; }
+  if(ann.is_adam_beta2)    { adam_beta2     = ann.adam_beta2;    is_adam_beta2    = 1; }
+  if(ann.is_adam_epsilon)  { adam_epsilon   = ann.adam_epsilon;  is_adam_epsilon  = 1; }
 
 
   if(ann.is_weight_decay)  { weight_decay   = ann.weight_decay;  is_weight_decay  = 1; }
@@ -156,6 +168,8 @@ NeuralNetwork::NeuralNetwork(const NeuralNetwork& ann){
 
   D            = ann.D;
   Delta        = ann.Delta;
+  dW2          = ann.dW2;
+  dB2          = ann.dB2;
 
 
 
@@ -181,6 +195,9 @@ NeuralNetwork& NeuralNetwork::operator=(const NeuralNetwork& ann){
             is_norm_exp        = 0;
             is_a_plus          = 0;
             is_a_minus         = 0;
+            is_adam_beta1      = 0;
+            is_adam_beta2      = 0;
+            is_adam_epsilon    = 0;
 
             derivs_flag = 0;
 
@@ -197,6 +214,9 @@ NeuralNetwork& NeuralNetwork::operator=(const NeuralNetwork& ann){
   if(ann.is_norm_exp)      { norm_exp       = ann.norm_exp;      is_norm_exp      = 1; }
   if(ann.is_a_plus)        { a_plus         = ann.a_plus;        is_a_plus        = 1; }
   if(ann.is_a_minus)       { a_minus        = ann.a_minus;       is_a_minus       = 1; }
+  if(ann.is_adam_beta1)    { adam_beta1     = ann.adam_beta1;    is_adam_beta1    = 1; }
+  if(ann.is_adam_beta2)    { adam_beta2     = ann.adam_beta2;    is_adam_beta2    = 1; }
+  if(ann.is_adam_epsilon)  { adam_epsilon   = ann.adam_epsilon;  is_adam_epsilon  = 1; }
 
 
   if(ann.is_weight_decay)  { weight_decay   = ann.weight_decay;  is_weight_decay  = 1; }
@@ -236,6 +256,8 @@ NeuralNetwork& NeuralNetwork::operator=(const NeuralNetwork& ann){
 
   D            = ann.D;
   Delta        = ann.Delta;
+  dW2          = ann.dW2;
+  dB2          = ann.dB2;
 
 
   return *this;
@@ -255,6 +277,10 @@ void NeuralNetwork::CreateANN(boost::python::list ann){
 
    Nlayers = Npe.size();
 
+   // The Adam moments of any previous network are rebuilt by ANNTrainBatch
+   if(dW2.size()>0)     {dW2.clear();  }
+   if(dB2.size()>0)     {dB2.clear();  }
+
         srand((unsigned)time(0));
 
         MATRIX w; w.Init_Unit_Matrix(1.0);
@@ -357,6 +383,8 @@ int NeuralNetwork::ImportANN(std::string filename){
   if(dB.size()>0)      {dB.clear();  }
   if(dBcurr.size()>0)  {dBcurr.clear();  }
   if(dBold.size()>0)   {dBold.clear();}
+  if(dW2.size()>0)     {dW2.clear();  }
+  if(dB2.size()>0)     {dB2.clear();  }
   if(D.size()>0)       {D.clear();  }
   if(Delta.size()>0)   {Delta.clear();  }
    
@@ -592,6 +620,9 @@ void NeuralNetwork::save(boost::property_tree::ptree& pt,std::string path){
   if(is_norm_exp){  libio::save(pt,path+".norm_exp",norm_exp);    }
   if(is_a_plus){  libio::save(pt,path+".a_plus",a_plus);    }
   if(is_a_minus){  libio::save(pt,path+".a_minus",a_minus);    }
+  if(is_adam_beta1){  libio::save(pt,path+".adam_beta1",adam_beta1);    }
+  if(is_adam_beta2){  libio::save(pt,path+".adam_beta2",adam_beta2);    }
+  if(is_adam_epsilon){  libio::save(pt,path+".adam_epsilon",adam_epsilon);    }
 
   libio::save(pt,path+".scale_method",scale_method);
   libio::save(pt,path+".Iteration",Iteration);
@@ -647,6 +678,9 @@ void NeuralNetwork::load(boost::property_tree::ptree& pt,std::string path,int& s
   libio::load(pt,path+".norm_exp",norm_exp,is_norm_exp); if(is_norm_exp==1) { status=1;}
   libio::load(pt,path+".a_plus",a_plus,is_a_plus); if(is_a_plus==1) { status=1;}
   libio::load(pt,path+".a_minus",a_minus,is_a_minus); if(is_a_minus==1) { status=1;}
+  libio::load(pt,path+".adam_beta1",adam_beta1,is_adam_beta1); if(is_adam_beta1==1) { status=1;}
+  libio::load(pt,path+".adam_beta2",adam_beta2,is_adam_beta2); if(is_adam_beta2==1) { status=1;}
+  libio::load(pt,path+".adam_epsilon",adam_epsilon,is_adam_epsilon); if(is_adam_epsilon==1) { status=1;}
 
   libio::load(pt,path+".scale_method",scale_method,st); if(st==1) { status=1;}
   libio::load(pt,path+".Iteration",Iteration,st); if(st==1) { status=1;}
@@ -73,6 +73,9 @@ public:
   double norm_exp;                 int is_norm_exp;
   double a_plus;                   int is_a_plus;
   double a_minus;                  int is_a_minus;
+  double adam_beta1;               int is_adam_beta1;
+  double adam_beta2;               int is_adam_beta2;
+  double adam_epsilon;             int is_adam_epsilon;
 
   std::string scale_method;
   int Iteration;
@@ -107,6 +110,8 @@ public:
   vector<MATRIX> dWold; 
   vector<MATRIX> D;
   vector<MATRIX> Delta;
+  vector<MATRIX> dW2; // second moments of the gradients (Adam)
+  vector<MATRIX> dB2;
  
   //--------------- Methods ---------------------
   // Default constructor
@@ -125,6 +130,9 @@ public:
    is_norm_exp        = 0;
    is_a_plus          = 0;
    is_a_minus         = 0;
+   is_adam_beta1      = 0;
+   is_adam_beta2      = 0;
+   is_adam_epsilon    = 0;
    derivs_flag = 0;
 
    scale_method = "none";
@@ -171,6 +179,11 @@ public:
   int Propagate(const MATRIX& input, MATRIX& result, MATRIX& derivs);  
   void LearningHistory(std::string filename,std::string data_flag);
 
+  // In NeuralNetwork_Batch.cpp
+  int PropagateBatch(const MATRIX& input, MATRIX& result);
+  int PropagateBatch(const MATRIX& input, MATRIX& result, MATRIX& derivs);
+  double ANNTrainBatch();
+
 
 };
 
@@ -0,0 +1,404 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file NeuralNetwork_Batch.cpp
+  \brief Batched (minibatch) propagation and training of the NeuralNetwork
+
+  A batch of patterns is stored as a matrix with one pattern per column: the input batch is sz_x x npat,
+  the output batch is sz_y x npat. Each layer is then evaluated as one matrix-matrix product W[L] * Y[L-1]
+  followed by the elementwise bias and activation. The same input/output scaling (Inputs[i], Outputs[i])
+  as in the single-pattern Propagate functions is applied.
+*/
+
+#include <Eigen/Core>
+#include "NeuralNetwork.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace boost;
+
+/// libann namespace
+namespace libann{
+
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrix;
+typedef Eigen::Map<RowMatrix> RowMatrixMap;
+
+/// Row-major view of the MATRIX memory, no copy
+static RowMatrixMap as_eigen(const MATRIX& x){  return RowMatrixMap(x.M, x.n_rows, x.n_cols); }
+
+
+static void scale_inputs(NeuralNetwork& ann, const MATRIX& input, MATRIX& x){
+/**
+  Transforms the batch of the external inputs into the internal representation: x = scale_factor * input + shift_amount
+*/
+  int nx = ann.Npe[0];
+  int npat = input.n_cols;
+  int is_scaled = (ann.Inputs.size()==nx);
+
+  for(int i=0;i<nx;i++){
+    double s = is_scaled ? ann.Inputs[i].scale_factor : 1.0;
+    double a = is_scaled ? ann.Inputs[i].shift_amount : 0.0;
+    for(int n=0;n<npat;n++){  x.M[i*npat+n] = s * input.M[i*npat+n] + a;  }
+  }
+
+}
+
+
+static void forward_batch(NeuralNetwork& ann, const MATRIX& x, vector<MATRIX>& Y){
+/**
+  Forward propagation of the batch x (internal units, Npe[0] x npat). On return Y[L] (Npe[L] x npat)
+  contains the outputs of the layer L, Y[0] = x.
+*/
+  int NL = ann.Nlayers - 1;
+  int npat = x.n_cols;
+
+  Y.clear();
+  Y.push_back(x);
+
+  for(int L=1;L<=NL;L++){
+
+    MATRIX y(ann.Npe[L], npat);
+    as_eigen(y).noalias() = as_eigen(ann.W[L]) * as_eigen(Y[L-1]);
+
+    for(int j=0;j<ann.Npe[L];j++){
+      double b = ann.B[L].M[j];
+      double* yj = y.M + j*npat;
+      for(int n=0;n<npat;n++){  yj[n] = tanh(yj[n] + b);  }
+    }
+
+    Y.push_back(y);
+
+  }// for L
+
+}
+
+
+static void unscale_outputs(NeuralNetwork& ann, const MATRIX& y, MATRIX& result){
+/**
+  Transforms the batch of the internal outputs (the last layer) to the external units
+*/
+  int ny = y.n_rows;
+  int npat = y.n_cols;
+  int is_scaled = (ann.Outputs.size()==ny);
+
+  for(int i=0;i<ny;i++){
+    double s = is_scaled ? ann.Outputs[i].scale_factor : 0.0;
+    double a = is_scaled ? ann.Outputs[i].shift_amount : 0.0;
+
+    for(int n=0;n<npat;n++){
+      double tmp = y.M[i*npat+n];
+
+      if(ann.scale_method=="normalize_and_transform"){
+        if(tmp>=0.99){ tmp = 0.99; }
+        else if(tmp<=-0.99) { tmp = -0.99; }
+        tmp = 0.5*log((1.0+tmp)/(1.0-tmp));
+      }
+      if(s!=0.0){  tmp = (1.0/s)*(tmp - a);  }
+
+      result.M[i*npat+n] = tmp;
+    }
+  }// for i
+
+}
+
+
+static void check_batch(NeuralNetwork& ann, const MATRIX& input, MATRIX& result, std::string fname){
+
+  int NL = ann.Nlayers - 1;
+
+  if(input.n_rows!=ann.Npe[0]){
+    std::cout<<"Error in "<<fname<<": The number of rows of the input ("<<input.n_rows
+             <<") does not match the ANN architecture ("<<ann.Npe[0]<<")\n"; exit(0);
+  }
+  if(result.n_rows!=ann.Npe[NL] || result.n_cols!=input.n_cols){
+    std::cout<<"Error in "<<fname<<": The result matrix must be of size "<<ann.Npe[NL]<<" x "<<input.n_cols<<"\n"; exit(0);
+  }
+
+}
+
+
+
+int NeuralNetwork::PropagateBatch(const MATRIX& input, MATRIX& result){
+/**
+  \brief Propagates a batch of patterns through the ANN
+
+  \param[in] input The batch of the inputs (external units), sz_x x npat - one pattern per column
+  \param[out] result The outputs of the ANN (external units), sz_y x npat - must be allocated
+*/
+
+  check_batch(*this, input, result, "NeuralNetwork::PropagateBatch");
+
+  int NL = Nlayers - 1;
+  MATRIX x(input.n_rows, input.n_cols);
+  vector<MATRIX> Y;
+
+  scale_inputs(*this, input, x);
+  forward_batch(*this, x, Y);
+  unscale_outputs(*this, Y[NL], result);
+
+  return 0;
+}
+
+
+int NeuralNetwork::PropagateBatch(const MATRIX& input, MATRIX& result, MATRIX& derivs){
+/**
+  \brief Propagates a batch of patterns through the ANN and computes the derivatives of the outputs w.r.t. the inputs
+
+  \param[in] input The batch of the inputs (external units), sz_x x npat - one pattern per column
+  \param[out] result The outputs of the ANN (external units), sz_y x npat - must be allocated
+  \param[out] derivs The derivatives dY_i/dX_j (external units), (sz_y*sz_x) x npat - must be allocated.
+  The row index is sz_x*i+j, as in the Derivs data of the single-pattern version.
+
+  The derivatives are computed by the back-propagation of each output through the network, so the
+  cost is sz_y backward passes over the whole batch. Unlike the single-pattern Propagate, the scaling of the
+  derivatives is obtained from the scaling factors of the inputs and outputs (which is the convention used
+  for the Derivs data) and includes the inverse output transformation of the "normalize_and_transform" method,
+  so the derivatives are consistent with the returned outputs.
+*/
+
+  check_batch(*this, input, result, "NeuralNetwork::PropagateBatch");
+
+  int NL = Nlayers - 1;
+  int nx = Npe[0];
+  int ny = Npe[NL];
+  int npat = input.n_cols;
+  int i, j, n, L;
+
+  if(derivs.n_rows!=nx*ny || derivs.n_cols!=npat){
+    std::cout<<"Error in NeuralNetwork::PropagateBatch: The derivs matrix must be of size "<<nx*ny<<" x "<<npat<<"\n"; exit(0);
+  }
+
+  MATRIX x(nx, npat);
+  vector<MATRIX> Y;
+
+  scale_inputs(*this, input, x);
+  forward_batch(*this, x, Y);
+  unscale_outputs(*this, Y[NL], result);
+
+  // Conversion of the internal derivatives to the external units: dy/dt for each output and dx/dX for each input
+  MATRIX fac(ny, npat);
+  for(i=0;i<ny;i++){
+    double s = (Outputs.size()==ny) ? Outputs[i].scale_factor : 0.0;
+    for(n=0;n<npat;n++){
+      double t = Y[NL].M[i*npat+n];
+      double f = 1.0;
+      if(scale_method=="normalize_and_transform"){   f = (fabs(t)>=0.99) ? 0.0 : 1.0/(1.0-t*t);   }
+      if(s!=0.0){ f /= s; }
+      fac.M[i*npat+n] = f * (1.0 - t*t);  // also includes the derivative of the output activation
+    }
+  }
+  vector<double> sx(nx, 1.0);
+  if(Inputs.size()==nx){  for(j=0;j<nx;j++){ sx[j] = Inputs[j].scale_factor; }  }
+
+
+  // Back-propagation of each output
+  vector<MATRIX> G;
+  for(L=0;L<=NL;L++){  G.push_back(MATRIX(Npe[L], npat));  }
+
+  for(i=0;i<ny;i++){
+
+    G[NL] = 0.0;
+    for(n=0;n<npat;n++){  G[NL].M[i*npat+n] = fac.M[i*npat+n];  }
+
+    for(L=NL;L>=1;L--){
+
+      as_eigen(G[L-1]).noalias() = as_eigen(W[L]).transpose() * as_eigen(G[L]);
+
+      if(L>1){
+        for(j=0;j<Npe[L-1]*npat;j++){  G[L-1].M[j] *= (1.0 - Y[L-1].M[j]*Y[L-1].M[j]);  }
+      }
+    }// for L
+
+    for(j=0;j<nx;j++){
+      for(n=0;n<npat;n++){  derivs.M[(i*nx+j)*npat+n] = G[0].M[j*npat+n] * sx[j];  }
+    }
+
+  }// for i
+
+  return 0;
+}
+
+
+
+double NeuralNetwork::ANNTrainBatch(){
+/**
+  \brief Minibatch training of the ANN
+
+  Performs iterations_in_cycle updates of the weights and biases, each using the gradient of the error over
+  a minibatch of epoch_size patterns. The minibatches are taken from a random permutation of the training
+  patterns, which is renewed after each pass over the whole set.
+
+  The training data (Inputs, Outputs) must be already scaled (internal units), as for ANNTrain.
+  The gradients w.r.t. the weights are computed by the batched back-propagation, so each layer costs two
+  matrix-matrix products per minibatch.
+
+  learning_method:
+    "SGD"  - stochastic gradient descent with the momentum_term
+    "Adam" - Adam optimizer with the parameters adam_beta1, adam_beta2, adam_epsilon
+
+  Also uses: learning_rate, weight_decay (one per weight matrix), norm_exp.
+  The derivatives (grad_weight) are not fitted by this function - use ANNTrain for that.
+
+  Returns the mean squared error per pattern, averaged over all the minibatches of this cycle.
+*/
+
+  int NL = Nlayers - 1;
+  int i, j, n, L, it;
+
+  sz_x = Inputs.size();
+  sz_y = Outputs.size();
+  num_of_patterns = Inputs[0].Data.size();
+
+  if(sz_x!=Npe[0] || sz_y!=Npe[NL]){
+    std::cout<<"Error in NeuralNetwork::ANNTrainBatch: The training data ("<<sz_x<<" inputs, "<<sz_y
+             <<" outputs) do not match the ANN architecture\n"; exit(0);
+  }
+
+
+  //============== Check the settings ======================
+  if(!is_learning_method || (learning_method!="SGD" && learning_method!="Adam")){
+    std::cout<<"Error in NeuralNetwork::ANNTrainBatch: learning_method must be \"SGD\" or \"Adam\"\n";
+    std::cout<<"Now exiting...\n";
+    exit(103);
+  }
+  if(!is_learning_rate){
+    learning_rate = 0.001;  is_learning_rate = 1;
+    std::cout<<"Warning: Learning rate is not defined! Setting learning rate to = "<<learning_rate<<"\n";
+  }
+  if(!is_epoch_size){
+    epoch_size = (num_of_patterns<32) ? num_of_patterns : 32;  is_epoch_size = 1;
+    std::cout<<"Warning: The epoch_size (minibatch size) has not been defined. Using default value = "<<epoch_size<<"\n";
+  }
+  if(epoch_size>num_of_patterns){ epoch_size = num_of_patterns; }
+  if(!is_momentum_term){ momentum_term = 0.0;  is_momentum_term = 1; }
+  if(!is_norm_exp){ norm_exp = 0;  is_norm_exp = 1; }
+  if(!is_iterations_in_cycle){
+    iterations_in_cycle = 1000;  is_iterations_in_cycle = 1;
+    std::cout<<"Warning: The number of iterations in one cycle has not been defined. Using default value = 1000\n";
+  }
+  if(!is_weight_decay){
+    for(i=0;i<NL;i++){ weight_decay.push_back(0.0); }
+    is_weight_decay = 1;
+  }
+  else if(weight_decay.size()!=NL){
+    std::cout<<"Error: The number of decay constants should be equal to the number of weight matrices\n";
+    std::cout<<"Now exiting...\n";
+    exit(91);
+  }
+  if(!is_adam_beta1){ adam_beta1 = 0.9;  is_adam_beta1 = 1; }
+  if(!is_adam_beta2){ adam_beta2 = 0.999;  is_adam_beta2 = 1; }
+  if(!is_adam_epsilon){ adam_epsilon = 1e-8;  is_adam_epsilon = 1; }
+
+  // Storage of the moments: dW, dB - the momentum (SGD) or the first moments (Adam); dW2, dB2 - the second moments
+  int reset_moments = (dW2.size()!=W.size() || dB2.size()!=B.size());
+  for(L=0;L<=NL && !reset_moments;L++){
+    if(dW2[L].n_rows!=W[L].n_rows || dW2[L].n_cols!=W[L].n_cols){ reset_moments = 1; }
+    if(dB2[L].n_rows!=B[L].n_rows || dB2[L].n_cols!=B[L].n_cols){ reset_moments = 1; }
+  }
+  if(reset_moments){
+    dW2.clear();  dB2.clear();
+    dW2 = W;  dB2 = B;
+    for(L=0;L<=NL;L++){  dW2[L] = 0.0;  dB2[L] = 0.0;  dW[L] = 0.0;  dB[L] = 0.0;  }
+  }
+
+
+  //============== Training ======================
+  int nb = epoch_size;
+  MATRIX X(sz_x, nb), T(sz_y, nb);
+  vector<MATRIX> Y, Delta_b, gW, gB;
+  for(L=0;L<=NL;L++){
+    Delta_b.push_back(MATRIX(Npe[L], nb));
+    gW.push_back(MATRIX(W[L].n_rows, W[L].n_cols));
+    gB.push_back(MATRIX(Npe[L], 1));
+  }
+
+  vector<int> perm;
+  int pos = num_of_patterns;  // forces the permutation at the first step
+  double err = 0.0;
+
+  for(it=0;it<iterations_in_cycle;it++){
+
+    // Assemble the minibatch
+    for(n=0;n<nb;n++){
+      if(pos==num_of_patterns){  perm.clear(); randperm(num_of_patterns, num_of_patterns, perm);  pos = 0; }
+      int indx = perm[pos];  pos++;
+
+      for(j=0;j<sz_x;j++){ X.M[j*nb+n] = Inputs[j].Data[indx];  }
+      for(j=0;j<sz_y;j++){ T.M[j*nb+n] = Outputs[j].Data[indx]; }
+    }
+
+    forward_batch(*this, X, Y);
+
+    // Output layer: Delta = f'(net) * e
+    double e2 = 0.0;
+    for(j=0;j<sz_y*nb;j++){
+      double diff = T.M[j] - Y[NL].M[j];
+      e2 += diff*diff;
+      double e = (norm_exp==0.0) ? diff : pow(diff, (2.0*norm_exp+1));
+      Delta_b[NL].M[j] = (1.0 - Y[NL].M[j]*Y[NL].M[j]) * e;
+    }
+    err += e2/double(nb);
+
+    // Hidden layers
+    for(L=NL-1;L>=1;L--){
+      as_eigen(Delta_b[L]).noalias() = as_eigen(W[L+1]).transpose() * as_eigen(Delta_b[L+1]);
+      for(j=0;j<Npe[L]*nb;j++){  Delta_b[L].M[j] *= (1.0 - Y[L].M[j]*Y[L].M[j]);  }
+    }
+
+    // Negative gradients, averaged over the minibatch
+    for(L=1;L<=NL;L++){
+      as_eigen(gW[L]).noalias() = as_eigen(Delta_b[L]) * as_eigen(Y[L-1]).transpose();
+      as_eigen(gW[L]) *= (1.0/double(nb));
+      as_eigen(gW[L]) -= weight_decay[L-1] * as_eigen(W[L]);
+
+      as_eigen(gB[L]) = as_eigen(Delta_b[L]).rowwise().sum() * (1.0/double(nb));
+    }
+
+    // Update
+    Iteration++;
+
+    if(learning_method=="SGD"){
+      for(L=1;L<=NL;L++){
+        as_eigen(dW[L]) = learning_rate * as_eigen(gW[L]) + momentum_term * as_eigen(dW[L]);
+        as_eigen(dB[L]) = learning_rate * as_eigen(gB[L]) + momentum_term * as_eigen(dB[L]);
+        as_eigen(W[L]) += as_eigen(dW[L]);
+        as_eigen(B[L]) += as_eigen(dB[L]);
+      }
+    }
+    else if(learning_method=="Adam"){
+
+      double c1 = 1.0/(1.0 - pow(adam_beta1, Iteration));
+      double c2 = 1.0/(1.0 - pow(adam_beta2, Iteration));
+
+      for(L=1;L<=NL;L++){
+        as_eigen(dW[L])  = adam_beta1 * as_eigen(dW[L])  + (1.0-adam_beta1) * as_eigen(gW[L]);
+        as_eigen(dB[L])  = adam_beta1 * as_eigen(dB[L])  + (1.0-adam_beta1) * as_eigen(gB[L]);
+        as_eigen(dW2[L]) = adam_beta2 * as_eigen(dW2[L]) + (1.0-adam_beta2) * as_eigen(gW[L]).cwiseAbs2();
+        as_eigen(dB2[L]) = adam_beta2 * as_eigen(dB2[L]) + (1.0-adam_beta2) * as_eigen(gB[L]).cwiseAbs2();
+
+        as_eigen(W[L]).array() += learning_rate * (c1*as_eigen(dW[L]).array()) / ((c2*as_eigen(dW2[L]).array()).sqrt() + adam_epsilon);
+        as_eigen(B[L]).array() += learning_rate * (c1*as_eigen(dB[L]).array()) / ((c2*as_eigen(dB2[L]).array()).sqrt() + adam_epsilon);
+      }
+    }
+
+  }// for it
+
+  Cycle++;
+
+  return err/double(iterations_in_cycle);
+}
+
+
+
+}// namespace libann
+}// namespace liblibra
@@ -34,6 +34,8 @@ int (NeuralNetwork::*Propagate1)(const MATRIX&, MATRIX&)
 int (NeuralNetwork::*Propagate2)(boost::python::list,boost::python::list&)        = &NeuralNetwork::Propagate;
 int (NeuralNetwork::*Propagate3)(const MATRIX&, MATRIX&, MATRIX&)                          = &NeuralNetwork::Propagate;
 int (NeuralNetwork::*Propagate4)(boost::python::list,boost::python::list&,boost::python::list&)        = &NeuralNetwork::Propagate;
+int (NeuralNetwork::*PropagateBatch1)(const MATRIX&, MATRIX&)                             = &NeuralNetwork::PropagateBatch;
+int (NeuralNetwork::*PropagateBatch2)(const MATRIX&, MATRIX&, MATRIX&)                    = &NeuralNetwork::PropagateBatch;
 
 
 //---------------------------------------------------------------------
@@ -188,7 +190,10 @@ ExportANN_docstring += tmp;
         .def("Propagate",Propagate2)
         .def("Propagate",Propagate3)
         .def("Propagate",Propagate4)
+        .def("PropagateBatch",PropagateBatch1)
+        .def("PropagateBatch",PropagateBatch2)
         .def("ANNTrain",&NeuralNetwork::ANNTrain)
+        .def("ANNTrainBatch",&NeuralNetwork::ANNTrainBatch)
         .def("LearningHistory",&NeuralNetwork::LearningHistory)
 
 
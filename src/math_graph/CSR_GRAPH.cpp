@@ -0,0 +1,556 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file CSR_GRAPH.cpp
+  \brief The file implements the CSR graph and the topological algorithms on it
+
+  The ring perception follows:
+
+  [1] P. Vismara "Union of all the minimum cycle bases of a graph" Electron. J. Comb. 1997, 4, R9
+  [2] J. D. Horton "A polynomial-time algorithm to find the shortest cycle basis of a graph"
+      SIAM J. Comput. 1987, 16, 358-366
+
+  The candidate cycles are the Vismara prototypes: for every root r, only the vertices preceding r in a fixed
+  order are visited by the BFS, so every cycle family is generated from its largest vertex only. The cycles are
+  represented by the bitsets over the edges, and the greedy Gaussian elimination over GF(2) of the candidates
+  sorted by length gives the minimum cycle basis (the smallest set of smallest rings, SSSR). A candidate is a
+  relevant cycle if it is independent of all the strictly shorter cycles.
+*/
+
+#include <algorithm>
+#include "CSR_GRAPH.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libgraph namespace
+namespace libgraph{
+
+
+CSR_GRAPH::CSR_GRAPH(){
+/**
+  The empty graph
+*/
+  nv = 0;
+  ne = 0;
+  xadj = vector<int>(1, 0);
+}
+
+
+CSR_GRAPH::CSR_GRAPH(int _nv, vector<int>& v1, vector<int>& v2){
+/**
+  The graph with _nv vertices and the edges (v1[k], v2[k])
+*/
+  init(_nv, v1, v2);
+}
+
+
+void CSR_GRAPH::init(int _nv, vector<int>& v1, vector<int>& v2){
+/**
+  Builds the graph from the list of edges
+
+  \param[in] _nv The number of vertices
+  \param[in] v1, v2 The vertices of the edges: the edge k connects v1[k] and v2[k]
+
+  The self-loops and the repeated edges are dropped.
+*/
+
+  if(v1.size()!=v2.size()){
+    cout<<"Error in CSR_GRAPH::init: the sizes of v1 and v2 are different\n"; exit(0);
+  }
+
+  int i, k;
+  int sz = v1.size();
+
+  nv = _nv;
+  edge_v1.clear();
+  edge_v2.clear();
+
+  // Drop the self-loops and the duplicates: sort the edges by the (min, max) vertex pairs
+  vector< pair< pair<int,int>, int> > ed;
+  for(k=0;k<sz;k++){
+    int a = v1[k], b = v2[k];
+    if(a<0 || a>=nv || b<0 || b>=nv){
+      cout<<"Error in CSR_GRAPH::init: the edge "<<k<<" ("<<a<<", "<<b<<") refers to a non-existing vertex\n"; exit(0);
+    }
+    if(a==b){ continue; }
+    ed.push_back(make_pair(make_pair(std::min(a,b), std::max(a,b)), k));
+  }
+  std::stable_sort(ed.begin(), ed.end());
+
+  vector<int> keep;
+  for(i=0;i<ed.size();i++){
+    if(i>0 && ed[i].first==ed[i-1].first){ continue; }
+    keep.push_back(ed[i].second);
+  }
+  std::sort(keep.begin(), keep.end());  // the original order of the edges
+
+  vector<int> deg(nv, 0);
+
+  ne = keep.size();
+  for(k=0;k<ne;k++){
+    edge_v1.push_back(v1[keep[k]]);
+    edge_v2.push_back(v2[keep[k]]);
+    deg[edge_v1[k]]++;
+    deg[edge_v2[k]]++;
+  }
+
+  xadj = vector<int>(nv+1, 0);
+  for(i=0;i<nv;i++){  xadj[i+1] = xadj[i] + deg[i];  }
+
+  adj = vector<int>(2*ne, 0);
+  adj_edge = vector<int>(2*ne, 0);
+  vector<int> pos(xadj.begin(), xadj.end()-1);
+
+  for(k=0;k<ne;k++){
+    int a = edge_v1[k], b = edge_v2[k];
+    adj[pos[a]] = b;  adj_edge[pos[a]] = k;  pos[a]++;
+    adj[pos[b]] = a;  adj_edge[pos[b]] = k;  pos[b]++;
+  }
+
+}
+
+
+vector<int> CSR_GRAPH::neighbors(int v){
+/**
+  The list of the vertices adjacent to v
+*/
+  return vector<int>(adj.begin()+xadj[v], adj.begin()+xadj[v+1]);
+}
+
+
+int CSR_GRAPH::find_edge(int u, int v){
+/**
+  Returns the index of the edge connecting u and v, or -1 if there is no such edge
+*/
+  for(int k=xadj[u]; k<xadj[u+1]; k++){
+    if(adj[k]==v){ return adj_edge[k]; }
+  }
+  return -1;
+}
+
+
+
+void CSR_GRAPH::bfs(int src, vector<int>& dist, vector<int>& parent){
+/**
+  The breadth-first search from the vertex src
+
+  \param[in] src The source vertex
+  \param[out] dist The topological distances (the numbers of edges) from src; -1 for the unreachable vertices
+  \param[out] parent The previous vertex on a shortest path from src; -1 for src and the unreachable vertices
+*/
+
+  dist = vector<int>(nv, -1);
+  parent = vector<int>(nv, -1);
+
+  vector<int> queue;  queue.reserve(nv);
+  queue.push_back(src);
+  dist[src] = 0;
+
+  for(int h=0; h<queue.size(); h++){
+    int u = queue[h];
+    for(int k=xadj[u]; k<xadj[u+1]; k++){
+      int w = adj[k];
+      if(dist[w]<0){
+        dist[w] = dist[u] + 1;
+        parent[w] = u;
+        queue.push_back(w);
+      }
+    }
+  }
+
+}
+
+
+int CSR_GRAPH::connected_components(vector<int>& comp){
+/**
+  Labels the connected components of the graph
+
+  \param[out] comp The index of the component of every vertex. The components are numbered in the order of
+  their smallest vertices
+
+  Returns the number of components
+*/
+
+  comp = vector<int>(nv, -1);
+  vector<int> stack;
+  int nc = 0;
+
+  for(int s=0; s<nv; s++){
+    if(comp[s]>=0){ continue; }
+
+    comp[s] = nc;
+    stack.push_back(s);
+
+    while(stack.size()>0){
+      int u = stack.back();  stack.pop_back();
+      for(int k=xadj[u]; k<xadj[u+1]; k++){
+        int w = adj[k];
+        if(comp[w]<0){  comp[w] = nc;  stack.push_back(w);  }
+      }
+    }
+    nc++;
+  }
+
+  return nc;
+}
+
+
+vector< vector<int> > CSR_GRAPH::connected_components(){
+/**
+  Returns the lists of the vertices of every connected component (e.g. the molecules of a system)
+*/
+
+  vector<int> comp;
+  int nc = connected_components(comp);
+
+  vector< vector<int> > res(nc);
+  for(int v=0; v<nv; v++){  res[comp[v]].push_back(v);  }
+
+  return res;
+}
+
+
+vector<int> CSR_GRAPH::split_by_edge(int i, int j){
+/**
+  Returns all the vertices that can be reached from i without going through the edge i-j (the vertex i is
+  included). If the edge is a bridge, this is the fragment on the i side of the bond, e.g. the part of the
+  molecule to be rotated around the i-j bond. Otherwise, the result contains j too.
+*/
+
+  vector<int> mark(nv, 0);
+  vector<int> res, stack;
+
+  mark[i] = 1;
+  stack.push_back(i);
+
+  while(stack.size()>0){
+    int u = stack.back();  stack.pop_back();
+    res.push_back(u);
+
+    for(int k=xadj[u]; k<xadj[u+1]; k++){
+      int w = adj[k];
+      if(u==i && w==j){ continue; }
+      if(!mark[w]){  mark[w] = 1;  stack.push_back(w);  }
+    }
+  }
+
+  std::sort(res.begin(), res.end());
+
+  return res;
+}
+
+
+int CSR_GRAPH::cycle_rank(){
+/**
+  The dimension of the cycle space (the number of rings in the SSSR): ne - nv + number_of_components
+*/
+
+  vector<int> comp;
+  return ne - nv + connected_components(comp);
+}
+
+
+vector<int> CSR_GRAPH::two_core(){
+/**
+  Returns the flags (1 or 0) for the vertices of the 2-core of the graph: what remains after the iterative
+  removal of all the vertices of degree 0 and 1. Only these vertices can belong to the rings.
+*/
+
+  vector<int> deg(nv), in_core(nv, 1), stack;
+
+  for(int v=0; v<nv; v++){
+    deg[v] = degree(v);
+    if(deg[v]<2){  in_core[v] = 0;  stack.push_back(v);  }
+  }
+
+  while(stack.size()>0){
+    int u = stack.back();  stack.pop_back();
+    for(int k=xadj[u]; k<xadj[u+1]; k++){
+      int w = adj[k];
+      if(in_core[w]){
+        deg[w]--;
+        if(deg[w]<2){  in_core[w] = 0;  stack.push_back(w);  }
+      }
+    }
+  }
+
+  return in_core;
+}
+
+
+
+void CSR_GRAPH::cycle_candidates(vector<Path>& cand){
+/**
+  Generates the Vismara prototype cycles (as the ordered lists of vertices). Among them there is at least one
+  cycle of every relevant cycle family, so they contain a minimum cycle basis.
+*/
+
+  int v, k;
+  vector<int> in_core = two_core();
+
+  // The order of the vertices: by the degree, then by the index
+  vector< pair<int,int> > ord;
+  for(v=0; v<nv; v++){
+    if(in_core[v]){  ord.push_back(pair<int,int>(degree(v), v));  }
+  }
+  std::sort(ord.begin(), ord.end());
+
+  vector<int> rank(nv, -1);
+  for(k=0; k<ord.size(); k++){  rank[ord[k].second] = k;  }
+
+  vector<int> dist(nv, -1), parent(nv, -1), mark(nv, 0), queue;
+  int stamp = 0;
+
+  for(int ir=0; ir<ord.size(); ir++){
+    int r = ord[ir].second;
+
+    // BFS from r in the subgraph of the vertices preceding r
+    queue.clear();
+    queue.push_back(r);
+    dist[r] = 0;  parent[r] = -1;
+
+    for(int h=0; h<queue.size(); h++){
+      int u = queue[h];
+      for(k=xadj[u]; k<xadj[u+1]; k++){
+        int w = adj[k];
+        if(rank[w]<0 || rank[w]>ir || w==r){ continue; }
+        if(dist[w]<0){  dist[w] = dist[u]+1;  parent[w] = u;  queue.push_back(w);  }
+      }
+    }
+
+    // Checks that the shortest paths r->a and r->b have only r in common
+    #define DISJOINT(a, b, res) { \
+      stamp++; \
+      for(int x=a; x!=r; x=parent[x]){ mark[x] = stamp; } \
+      res = 1; \
+      for(int x=b; x!=r; x=parent[x]){ if(mark[x]==stamp){ res = 0; break; } } \
+    }
+
+    for(int h=1; h<queue.size(); h++){
+      int y = queue[h];
+      vector<int> S;
+
+      for(k=xadj[y]; k<xadj[y+1]; k++){
+        int z = adj[k];
+        if(rank[z]<0 || rank[z]>ir || dist[z]<0){ continue; }
+
+        if(dist[z]+1==dist[y]){  S.push_back(z);  }
+
+        else if(dist[z]==dist[y] && rank[z]<rank[y]){
+          // Odd cycle: r -> y, z -> r
+          int ok;  DISJOINT(y, z, ok);
+          if(ok){
+            Path c;
+            for(int x=y; x!=-1; x=parent[x]){ c.push_back(x); }
+            std::reverse(c.begin(), c.end());
+            for(int x=z; x!=r; x=parent[x]){ c.push_back(x); }
+            cand.push_back(c);
+          }
+        }
+      }// for k
+
+      // Even cycles: r -> p, y, q -> r
+      for(int a=0; a<S.size(); a++){
+        for(int b=a+1; b<S.size(); b++){
+          int ok;  DISJOINT(S[a], S[b], ok);
+          if(ok){
+            Path c;
+            for(int x=S[a]; x!=-1; x=parent[x]){ c.push_back(x); }
+            std::reverse(c.begin(), c.end());
+            c.push_back(y);
+            for(int x=S[b]; x!=r; x=parent[x]){ c.push_back(x); }
+            cand.push_back(c);
+          }
+        }
+      }
+
+    }// for h
+
+    #undef DISJOINT
+
+    for(int h=0; h<queue.size(); h++){  dist[queue[h]] = -1;  parent[queue[h]] = -1;  }
+
+  }// for ir
+
+}
+
+
+void CSR_GRAPH::cycle_to_bits(Path& cycle, vector<uint64_t>& bits){
+/**
+  The edge incidence vector of the cycle as a bitset
+*/
+
+  bits = vector<uint64_t>((ne+63)/64, 0);
+  int sz = cycle.size();
+
+  for(int i=0;i<sz;i++){
+    int e = find_edge(cycle[i], cycle[(i+1)%sz]);
+    bits[e/64] ^= ((uint64_t)1 << (e%64));
+  }
+}
+
+
+// The reduction of the bitset x by the basis in the echelon form: every row has a distinct pivot - its lowest
+// bit, and pivot_row[b] is the index of the row with the pivot b (or -1). Returns the remaining lowest bit
+// (x is then independent of the basis) or -1 (x is a combination of the basis rows).
+static int reduce_bits(vector<uint64_t>& x, vector< vector<uint64_t> >& rows, vector<int>& pivot_row){
+
+  int nw = x.size();
+  int w = 0;
+
+  while(1){
+    while(w<nw && x[w]==0){ w++; }
+    if(w==nw){ return -1; }
+
+    int b = 64*w + __builtin_ctzll(x[w]);
+    int r = pivot_row[b];
+    if(r<0){ return b; }
+
+    vector<uint64_t>& row = rows[r];
+    for(int i=w; i<nw; i++){  x[i] ^= row[i];  }
+  }
+
+}
+
+
+int CSR_GRAPH::select_cycles(vector<Path>& cand, int is_relevant, vector<Path>& res){
+/**
+  Selects the cycles from the candidates in the order of the increasing length
+
+  \param[in] cand The candidate cycles
+  \param[in] is_relevant 0 - select the minimum cycle basis; 1 - select all the cycles independent of the strictly
+             shorter cycles (the relevant cycles)
+  \param[out] res The selected cycles
+
+  Returns the number of the independent cycles found (the rank of the basis)
+*/
+
+  int i, k;
+  int rank_max = cycle_rank();
+
+  vector<int> order(cand.size());
+  for(i=0;i<cand.size();i++){ order[i] = i; }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b){ return cand[a].size() < cand[b].size(); });
+
+  vector< vector<uint64_t> > rows, rows0;
+  vector<int> pivot_row(ne, -1), pivot_row0;
+  vector<uint64_t> bits;
+
+  int cur_len = -1;
+  int max_len = 0;
+
+  res.clear();
+
+  for(k=0;k<order.size();k++){
+    Path& c = cand[order[k]];
+    int len = c.size();
+
+    if(len!=cur_len){
+      // The basis is complete and all the cycles of the longest basis length are checked
+      if(rows.size()==rank_max && (len>max_len || !is_relevant)){ break; }
+
+      cur_len = len;
+      if(is_relevant){  rows0 = rows;  pivot_row0 = pivot_row;  }
+    }
+
+    cycle_to_bits(c, bits);
+
+    if(is_relevant){
+      vector<uint64_t> x = bits;
+      if(reduce_bits(x, rows0, pivot_row0)>=0){  res.push_back(c);  }
+    }
+
+    int b = reduce_bits(bits, rows, pivot_row);
+    if(b>=0){
+      pivot_row[b] = rows.size();
+      rows.push_back(bits);
+      max_len = len;
+      if(!is_relevant){  res.push_back(c);  }
+    }
+  }
+
+  if(rows.size()!=rank_max){
+    cout<<"Warning in CSR_GRAPH::select_cycles: found "<<rows.size()<<" independent cycles, but the cycle rank is "
+        <<rank_max<<"\n";
+  }
+
+  return rows.size();
+}
+
+
+vector<Path> CSR_GRAPH::find_sssr(){
+/**
+  Returns the smallest set of smallest rings (SSSR): the minimum cycle basis. Every ring is the list of its
+  vertices in the order along the ring. The number of rings is equal to the cycle rank.
+*/
+
+  vector<Path> cand, res;
+
+  cycle_candidates(cand);
+  select_cycles(cand, 0, res);
+
+  return res;
+}
+
+
+vector<Path> CSR_GRAPH::find_relevant_cycles(){
+/**
+  Returns the relevant cycles: those that are not sums of strictly shorter cycles. Their union is the union of
+  all the minimum cycle bases, so unlike the SSSR the result does not depend on the arbitrary choices (e.g. all
+  the 6 faces of the cube are returned). For every family of relevant cycles that differ only by the choice
+  among the equal shortest paths (prototypes in [1]) only one representative is returned.
+*/
+
+  vector<Path> cand, res;
+
+  cycle_candidates(cand);
+  select_cycles(cand, 1, res);
+
+  return res;
+}
+
+
+void CSR_GRAPH::ring_membership(vector<Path>& rings, vector< vector<int> >& ring_sizes, vector<int>& min_ring_size){
+/**
+  Computes the ring properties of every vertex
+
+  \param[in] rings The rings (e.g. from find_sssr)
+  \param[out] ring_sizes The sorted list of the distinct sizes of the rings containing the vertex
+  \param[out] min_ring_size The size of the smallest ring containing the vertex, 0 if it is not in any ring
+*/
+
+  ring_sizes = vector< vector<int> >(nv);
+  min_ring_size = vector<int>(nv, 0);
+
+  for(int i=0;i<rings.size();i++){
+    int sz = rings[i].size();
+    for(int j=0;j<sz;j++){
+      int v = rings[i][j];
+      if(std::find(ring_sizes[v].begin(), ring_sizes[v].end(), sz)==ring_sizes[v].end()){
+        ring_sizes[v].push_back(sz);
+      }
+    }
+  }
+
+  for(int v=0; v<nv; v++){
+    std::sort(ring_sizes[v].begin(), ring_sizes[v].end());
+    if(ring_sizes[v].size()>0){  min_ring_size[v] = ring_sizes[v][0];  }
+  }
+
+}
+
+
+
+}// namespace libgraph
+}// liblibra
+
@@ -0,0 +1,88 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file CSR_GRAPH.h
+  \brief The file describes the compact (CSR) undirected graph and the topological algorithms on it:
+  connected components, ring perception (SSSR and relevant cycles)
+
+*/
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+#include "GRAPH.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace std;
+
+/// libgraph namespace
+namespace libgraph{
+
+
+class CSR_GRAPH{
+/**
+  The undirected simple graph stored in the compressed sparse row (CSR) format: the neighbors of the vertex v are
+  adj[xadj[v]], ... , adj[xadj[v+1]-1], and adj_edge[k] is the index of the edge connecting v to adj[k].
+
+  The vertices are 0, ... , nv-1, the edges are 0, ... , ne-1 in the order they were given (without the
+  self-loops and the repeated edges, which are dropped).
+*/
+
+  void cycle_candidates(vector<Path>& cand);
+  int select_cycles(vector<Path>& cand, int is_relevant, vector<Path>& res);
+  void cycle_to_bits(Path& cycle, vector<uint64_t>& bits);
+
+public:
+
+  int nv;                     ///< the number of vertices
+  int ne;                     ///< the number of edges
+  vector<int> xadj;           ///< the offsets of the adjacency lists - nv+1 elements
+  vector<int> adj;            ///< the adjacent vertices - 2*ne elements
+  vector<int> adj_edge;       ///< the indices of the corresponding edges - 2*ne elements
+  vector<int> edge_v1;        ///< the first vertex of every edge - ne elements
+  vector<int> edge_v2;        ///< the second vertex of every edge - ne elements
+
+
+  CSR_GRAPH();
+  CSR_GRAPH(int _nv, vector<int>& v1, vector<int>& v2);
+  void init(int _nv, vector<int>& v1, vector<int>& v2);
+
+  int degree(int v){ return xadj[v+1] - xadj[v]; }
+  vector<int> neighbors(int v);
+  int find_edge(int u, int v);
+
+  // Traversals and components
+  void bfs(int src, vector<int>& dist, vector<int>& parent);
+  int connected_components(vector<int>& comp);
+  vector< vector<int> > connected_components();
+  vector<int> split_by_edge(int i, int j);
+  int cycle_rank();
+  vector<int> two_core();
+
+  // Rings
+  vector<Path> find_sssr();
+  vector<Path> find_relevant_cycles();
+  void ring_membership(vector<Path>& rings, vector< vector<int> >& ring_sizes, vector<int>& min_ring_size);
+
+};
+
+
+}// namespace libgraph
+}// liblibra
+
+#endif // CSR_GRAPH_H
+
@@ -23,6 +23,37 @@ using namespace boost::python;
 namespace libgraph{
 
 void export_GRAPH_objects(){
+
+  int (CSR_GRAPH::*expt_connected_components_v1)(vector<int>& comp) = &CSR_GRAPH::connected_components;
+  vector< vector<int> > (CSR_GRAPH::*expt_connected_components_v2)() = &CSR_GRAPH::connected_components;
+
+
+  class_<CSR_GRAPH>("CSR_GRAPH",init<>())
+      .def(init<int, vector<int>&, vector<int>& >())
+
+      .def_readonly("nv", &CSR_GRAPH::nv)
+      .def_readonly("ne", &CSR_GRAPH::ne)
+      .def_readonly("xadj", &CSR_GRAPH::xadj)
+      .def_readonly("adj", &CSR_GRAPH::adj)
+      .def_readonly("adj_edge", &CSR_GRAPH::adj_edge)
+      .def_readonly("edge_v1", &CSR_GRAPH::edge_v1)
+      .def_readonly("edge_v2", &CSR_GRAPH::edge_v2)
+
+      .def("init", &CSR_GRAPH::init)
+      .def("degree", &CSR_GRAPH::degree)
+      .def("neighbors", &CSR_GRAPH::neighbors)
+      .def("find_edge", &CSR_GRAPH::find_edge)
+      .def("bfs", &CSR_GRAPH::bfs)
+      .def("connected_components", expt_connected_components_v1)
+      .def("connected_components", expt_connected_components_v2)
+      .def("split_by_edge", &CSR_GRAPH::split_by_edge)
+      .def("cycle_rank", &CSR_GRAPH::cycle_rank)
+      .def("two_core", &CSR_GRAPH::two_core)
+      .def("find_sssr", &CSR_GRAPH::find_sssr)
+      .def("find_relevant_cycles", &CSR_GRAPH::find_relevant_cycles)
+      .def("ring_membership", &CSR_GRAPH::ring_membership)
+  ;
+
 }
 
 
@@ -13,6 +13,7 @@
 #define LIB_GRAPH_H
 
 #include "GRAPH.h"
+#include "CSR_GRAPH.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -94,6 +94,11 @@ void export_mEigen_objects(){
   def("exp_matrix", expt_exp_matrix_v1);
   def("exp_matrix", expt_exp_matrix_v2);
 
+  int (*expt_expmv_krylov_v1)(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian, double tol, int m_max) = &expmv_krylov;
+  int (*expt_expmv_krylov_v2)(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian) = &expmv_krylov;
+  def("expmv_krylov", expt_expmv_krylov_v1);
+  def("expmv_krylov", expt_expmv_krylov_v2);
+
 
   void (*expt_FullPivLU_rank_invertible_v1)(MATRIX& A, int& rank, int& is_inver) = &FullPivLU_rank_invertible;
   void (*expt_FullPivLU_rank_invertible_v2)(CMATRIX& A, int& rank, int& is_inver) = &FullPivLU_rank_invertible;
@@ -88,6 +88,12 @@ void exp_matrix(CMATRIX& res, CMATRIX& S, complex<double> dt, int do_phase_corre
 void exp_matrix(CMATRIX& res, CMATRIX& S, complex<double> dt);
 
 
+///=========== Look in: mEigen_krylov.cpp ==================
+///< Action of the matrix exponential on a set of vectors: C <- exp(H*dt) * C (Lanczos or Arnoldi)
+int expmv_krylov(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian, double tol, int m_max);
+int expmv_krylov(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian);
+
+
 ///=========== Look in: mEigen_decompositions.cpp ==================
 ///< LU decomposition
 void FullPivLU_decomposition(MATRIX& A, MATRIX& P, MATRIX& L, MATRIX& U, MATRIX& Q);
@@ -0,0 +1,268 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file mEigen_krylov.cpp
+  \brief The file implements the action of the matrix exponential on a vector, exp(H*dt) * c, by the
+  short-iterative Krylov (Lanczos or Arnoldi) method
+
+  Only the matrix-vector products with H are needed, and the exponential is computed for a small
+  (m x m, m <= m_max) projection of H onto the Krylov subspace {c, H c, ... , H^{m-1} c}.
+*/
+
+#include <Eigen/LU>
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+#include <Eigen/Core>
+#include "mEigen.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+
+using namespace Eigen;
+using namespace std;
+using namespace liblinalg;
+
+/// libmeigen namespace
+namespace libmeigen{
+
+
+typedef Matrix<complex<double>, Dynamic, Dynamic, RowMajor> RowMatrixXcd;
+
+
+MatrixXcd pade_exp(const MatrixXcd& A){
+/**
+  Computes exp(A) for a small general matrix A by the (6,6) Pade approximant with scaling and squaring
+*/
+
+  int sz = A.rows();
+  double nrm = A.cwiseAbs().rowwise().sum().maxCoeff();  // infinity norm
+
+  int s = 0;
+  if(nrm>0.5){  s = std::max(0, int(std::ceil(std::log2(nrm/0.5))));  }
+
+  MatrixXcd X = A / std::pow(2.0, s);
+
+  const double c[7] = { 1.0, 0.5, 5.0/44.0, 1.0/66.0, 1.0/792.0, 1.0/15840.0, 1.0/665280.0 };
+
+  MatrixXcd I = MatrixXcd::Identity(sz, sz);
+  MatrixXcd X2 = X * X;
+  MatrixXcd X4 = X2 * X2;
+  MatrixXcd X6 = X4 * X2;
+
+  MatrixXcd U = X * (c[1]*I + c[3]*X2 + c[5]*X4);   // odd part
+  MatrixXcd V = c[0]*I + c[2]*X2 + c[4]*X4 + c[6]*X6;  // even part
+
+  MatrixXcd E = (V - U).partialPivLu().solve(V + U);
+
+  for(int i=0;i<s;i++){  E = E * E;  }
+
+  return E;
+}
+
+
+VectorXcd krylov_small_exp(MatrixXcd& Hm, int m, complex<double> tau, int is_hermitian){
+/**
+  Returns exp(tau * Hm[0:m,0:m]) * e_1. In the Hermitian case the m x m block of Hm is a real symmetric
+  tridiagonal matrix and is exponentiated via its eigendecomposition.
+*/
+
+  VectorXcd y(m);
+
+  if(is_hermitian){
+    MatrixXd T = Hm.block(0, 0, m, m).real();
+    SelfAdjointEigenSolver<MatrixXd> es(T);
+
+    const VectorXd& lam = es.eigenvalues();
+    const MatrixXd& Q = es.eigenvectors();
+
+    for(int i=0;i<m;i++){
+      complex<double> s(0.0, 0.0);
+      for(int k=0;k<m;k++){  s += Q(i,k) * std::exp(tau * lam(k)) * Q(0,k);  }
+      y(i) = s;
+    }
+  }
+  else{
+    MatrixXcd E = pade_exp(tau * Hm.block(0, 0, m, m));
+    y = E.col(0);
+  }
+
+  return y;
+}
+
+
+
+int expmv_krylov(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian, double tol, int m_max){
+/**
+  This function computes C <- exp(H*dt) * C without forming the matrix exponential
+
+  \param[in] H The N x N matrix (e.g. -i * Hvib for the TD-SE)
+  \param[in,out] C The N x M matrix: every column is propagated independently, the result overwrites the input
+  \param[in] dt The scaling factor (the time step)
+  \param[in] is_hermitian 1 - H is Hermitian: use the Lanczos recurrence (the Krylov projection is a real
+             tridiagonal matrix); 0 - general H (e.g. with a complex absorbing potential or the non-Hermitian
+             NACs): use the Arnoldi process
+  \param[in] tol The error tolerance: the estimated error per unit fraction of the step, relative to the norm
+             of the vector
+  \param[in] m_max The maximal dimension of the Krylov subspace. The dimension is increased adaptively until
+             the error estimate is below tol. If it is not enough, the step is split into the sub-steps
+             (for which the same subspace is used), and a new subspace is built for every remaining sub-step.
+             If tol can not be met even for a 1e-8 fraction of the step, the function exits with an error.
+
+  Returns the total number of the matrix-vector products with H.
+
+  For the Hermitian case, the exp(H*dt) * C is computed for any complex dt, e.g. dt = -i * time_step gives the
+  unitary propagation with the Hamiltonian H.
+*/
+
+  if(H.n_cols != H.n_rows){
+    cout<<"Error in libmeigen::expmv_krylov : the input matrix is not square\n"; exit(0);
+  }
+  if(C.n_rows != H.n_rows){
+    cout<<"Error in libmeigen::expmv_krylov : the number of rows of C = "<<C.n_rows
+        <<" is not equal to the size of H = "<<H.n_rows<<"\n"; exit(0);
+  }
+  if(m_max<1){
+    cout<<"Error in libmeigen::expmv_krylov : m_max must be positive\n"; exit(0);
+  }
+
+
+  int n = H.n_rows;
+  int ncol = C.n_cols;
+  int mmax = std::min(m_max, n);
+  int n_matvec = 0;
+
+  Map<RowMatrixXcd> Hmap(H.M, n, n);
+
+  double Hnorm = Hmap.cwiseAbs().rowwise().sum().maxCoeff();
+  double breakdown = 1e-12 * std::max(Hnorm, 1e-300);
+
+  MatrixXcd V(n, mmax+1);      // the Krylov basis
+  MatrixXcd Hm(mmax+1, mmax);  // the projection of H onto the basis
+  VectorXcd w(n), v(n), y;
+
+
+  for(int col=0; col<ncol; col++){
+
+    for(int i=0;i<n;i++){  v(i) = C.M[i*ncol+col];  }
+
+    double s = 1.0;      // the remaining fraction of the step
+    double tau = 1.0;    // the current sub-step
+
+    while(s>0.0){
+
+      double beta = v.norm();
+      if(beta==0.0){ break; }
+
+      V.col(0) = v / beta;
+      Hm.setZero();
+
+      int m = 0;
+      int is_converged = 0;
+      double err = 0.0;
+
+      tau = std::min(2.0*tau, s);  // try a longer sub-step - it is reduced below if needed
+
+      for(int j=0;j<mmax;j++){
+
+        w.noalias() = Hmap * V.col(j);
+        n_matvec++;
+
+        if(is_hermitian){
+          // Lanczos: 3-term recurrence, plus one pass of the reorthogonalization
+          double alp = V.col(j).dot(w).real();
+          w -= alp * V.col(j);
+          if(j>0){  w -= Hm(j,j-1) * V.col(j-1);  }
+          for(int k=0;k<=j;k++){  w -= V.col(k).dot(w) * V.col(k);  }
+
+          Hm(j,j) = alp;
+        }
+        else{
+          // Arnoldi: modified Gram-Schmidt, plus one pass of the reorthogonalization
+          for(int k=0;k<=j;k++){
+            complex<double> h = V.col(k).dot(w);
+            Hm(k,j) = h;
+            w -= h * V.col(k);
+          }
+          for(int k=0;k<=j;k++){
+            complex<double> h = V.col(k).dot(w);
+            Hm(k,j) += h;
+            w -= h * V.col(k);
+          }
+        }
+
+        double hnext = w.norm();
+        m = j+1;
+
+        if(hnext < breakdown){
+          // Happy breakdown - the subspace is invariant, so the projection is exact
+          is_converged = 1;
+          tau = s;
+          y = krylov_small_exp(Hm, m, tau*dt, is_hermitian);
+          err = 0.0;
+          break;
+        }
+
+        Hm(j+1,j) = hnext;
+        if(is_hermitian && j+1<mmax){  Hm(j,j+1) = hnext;  }
+        V.col(j+1) = w / hnext;
+
+        // Error estimate: beta * |tau*dt| * h_{m+1,m} * |e_m^T exp(tau*dt*H_m) e_1|
+        y = krylov_small_exp(Hm, m, tau*dt, is_hermitian);
+        err = beta * std::abs(tau*dt) * hnext * std::abs(y(m-1));
+
+        if(err <= tol * tau * beta){  is_converged = 1; break;  }
+
+      }// for j
+
+      // The maximal dimension is not enough: reduce the sub-step, reusing the same subspace
+      if(!is_converged){
+        double hnext = std::abs(Hm(m, m-1));
+        while(err > tol * tau * beta && tau > 1e-8){
+          tau *= 0.5;
+          y = krylov_small_exp(Hm, m, tau*dt, is_hermitian);
+          err = beta * std::abs(tau*dt) * hnext * std::abs(y(m-1));
+        }
+        if(err > tol * tau * beta){
+          cout<<"Error in libmeigen::expmv_krylov : the error estimate "<<err/(tau*beta)<<" is above tol = "<<tol
+              <<" even for the sub-step of "<<tau<<" of the step; increase m_max = "<<m_max<<" or tol\n"; exit(0);
+        }
+      }
+
+      v = beta * (V.leftCols(m) * y);
+      s -= tau;
+      if(s < 1e-14){ s = 0.0; }
+
+    }// while s > 0
+
+    for(int i=0;i<n;i++){  C.M[i*ncol+col] = v(i);  }
+
+  }// for col
+
+  return n_matvec;
+
+}// expmv_krylov
+
+
+int expmv_krylov(CMATRIX& H, CMATRIX& C, complex<double> dt, int is_hermitian){
+/**
+  Same as above with the error tolerance of 1e-10 and the maximal Krylov dimension of 30
+*/
+
+  return expmv_krylov(H, C, dt, is_hermitian, 1e-10, 30);
+}
+
+
+
+}// namespace libmeigen
+}// namespace liblibra
+
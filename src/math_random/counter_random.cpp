@@ -0,0 +1,137 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file counter_random.cpp
+  \brief The file implements the counter-based random number generator (Philox4x32-10)
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include "counter_random.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// librandom namespace
+namespace librandom{
+
+using namespace std;
+
+
+void CounterRandom::block(uint32_t* out){
+/**
+  Salmon, Moraes, Dror, Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC'11
+*/
+
+  const uint32_t M0 = 0xD2511F53;
+  const uint32_t M1 = 0xCD9E8D57;
+  const uint32_t W0 = 0x9E3779B9;
+  const uint32_t W1 = 0xBB67AE85;
+
+  uint32_t c0 = (uint32_t)counter;
+  uint32_t c1 = (uint32_t)(counter >> 32);
+  uint32_t c2 = (uint32_t)stream;
+  uint32_t c3 = (uint32_t)(stream >> 32);
+  uint32_t k0 = (uint32_t)seed;
+  uint32_t k1 = (uint32_t)(seed >> 32);
+
+  for(int r=0;r<10;r++){
+
+    uint64_t p0 = (uint64_t)M0 * c0;
+    uint64_t p1 = (uint64_t)M1 * c2;
+
+    uint32_t hi0 = (uint32_t)(p0 >> 32), lo0 = (uint32_t)p0;
+    uint32_t hi1 = (uint32_t)(p1 >> 32), lo1 = (uint32_t)p1;
+
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+
+    k0 += W0;  k1 += W1;
+  }
+
+  out[0] = c0;  out[1] = c1;  out[2] = c2;  out[3] = c3;
+
+  counter++;
+}
+
+
+double CounterRandom::uniform(){
+
+  uint32_t r[4];
+  block(r);
+
+  uint64_t x = ((uint64_t)r[0] << 32) | r[1];
+  return (x >> 11) * (1.0/9007199254740992.0);
+}
+
+
+double CounterRandom::uniform(double a, double b){
+
+  return a + (b-a)*uniform();
+}
+
+
+double CounterRandom::normal(){
+/**
+  Both uniform numbers of the Box-Muller transform come from the same block
+*/
+
+  uint32_t r[4];
+  block(r);
+
+  uint64_t x1 = ((uint64_t)r[0] << 32) | r[1];
+  uint64_t x2 = ((uint64_t)r[2] << 32) | r[3];
+
+  double u1 = ((x1 >> 11) + 1.0) * (1.0/9007199254740992.0);  // (0, 1]
+  double u2 = (x2 >> 11) * (1.0/9007199254740992.0);
+
+  return sqrt(-2.0*log(u1)) * cos(2.0*M_PI*u2);
+}
+
+
+double CounterRandom::gamma(double a){
+/**
+  \brief Gamma distribution with the shape a > 0 and the unit scale
+
+  G. Marsaglia, W. W. Tsang, ACM Trans. Math. Softw. 26, 363 (2000). For a < 1 the deviate of a + 1 is
+  scaled by u^(1/a). The number of the consumed counter values varies with the rejections.
+*/
+
+  if(a<=0.0){
+    cout<<"Error in CounterRandom::gamma: the shape "<<a<<" must be positive\n"; exit(0);
+  }
+
+  if(a<1.0){
+    double u = 1.0 - uniform();  // (0, 1]
+    return gamma(a + 1.0) * pow(u, 1.0/a);
+  }
+
+  double d = a - 1.0/3.0;
+  double c = 1.0/sqrt(9.0*d);
+
+  while(1){
+    double x = normal();
+    double v = 1.0 + c*x;
+    if(v<=0.0){ continue; }
+
+    v = v*v*v;
+    double u = uniform();
+    if(u < 1.0 - 0.0331*x*x*x*x){ return d*v; }
+    if(u>0.0 && log(u) < 0.5*x*x + d*(1.0 - v + log(v))){ return d*v; }
+  }
+}
+
+
+
+}// namespace librandom
+}// namespace liblibra
@@ -0,0 +1,65 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file counter_random.h
+  \brief The file describes the counter-based random number generator (Philox4x32-10)
+
+  The i-th random number of the stream is a fixed function of (seed, stream, i), so many independent
+  streams (e.g. one per Monte Carlo chain or per trajectory) can be used in parallel and the results do
+  not depend on the number of threads or the order in which the streams are advanced.
+*/
+
+#ifndef COUNTER_RANDOM_H
+#define COUNTER_RANDOM_H
+
+#include <stdint.h>
+#include <math.h>
+
+/// liblibra namespace
+namespace liblibra{
+
+/// librandom namespace
+namespace librandom{
+
+
+class CounterRandom{
+/**
+  Each call of uniform() or normal() consumes one counter value: one block of the Philox4x32-10 function,
+  128 random bits; gamma() consumes a variable number of them
+*/
+
+  void block(uint32_t* out);    ///< Philox4x32-10 of the current (counter, stream) with the key made from the seed
+
+  public:
+
+  uint64_t seed;      ///< key of the generator
+  uint64_t stream;    ///< index of the stream
+  uint64_t counter;   ///< number of the blocks used so far - the whole state of the stream
+
+  CounterRandom(){ seed = 0; stream = 0; counter = 0; }
+  CounterRandom(uint64_t seed_, uint64_t stream_){ seed = seed_; stream = stream_; counter = 0; }
+  ~CounterRandom(){ ;; }
+
+  void set_counter(uint64_t c){ counter = c; }
+  uint64_t get_counter(){ return counter; }
+
+  double uniform();                     ///< in [0, 1)
+  double uniform(double a, double b);   ///< in [a, b)
+  double normal();                      ///< standard normal (Box-Muller)
+  double gamma(double a);               ///< Gamma(a, 1) distribution (Marsaglia-Tsang)
+
+}; // class CounterRandom
+
+
+}// namespace librandom
+}// namespace liblibra
+
+#endif // COUNTER_RANDOM_H
@@ -30,6 +30,9 @@ void export_Random_objects(){
 //  def("scale", expt_scale1);
 
   class_<Random>("Random",init<>())
+      .def(init<int>())
+      .def("set_seed",&Random::set_seed)
+      .def("set_seed_from_time",&Random::set_seed_from_time)
 //      .def("__copy__", &generic__copy__<Random>)
 //      .def("__deepcopy__", &generic__deepcopy__<Random>)
 
@@ -61,6 +64,23 @@ void export_Random_objects(){
   ;
 
 
+  double (CounterRandom::*expt_uniform_v1)() = &CounterRandom::uniform;
+  double (CounterRandom::*expt_uniform_v2)(double a, double b) = &CounterRandom::uniform;
+
+  class_<CounterRandom>("CounterRandom",init<>())
+      .def(init<uint64_t, uint64_t>())
+      .def_readwrite("seed",&CounterRandom::seed)
+      .def_readwrite("stream",&CounterRandom::stream)
+      .def_readwrite("counter",&CounterRandom::counter)
+      .def("set_counter",&CounterRandom::set_counter)
+      .def("get_counter",&CounterRandom::get_counter)
+      .def("uniform",expt_uniform_v1)
+      .def("uniform",expt_uniform_v2)
+      .def("normal",&CounterRandom::normal)
+      .def("gamma",&CounterRandom::gamma)
+  ;
+
+
 }
 
 
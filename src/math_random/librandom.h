@@ -14,6 +14,7 @@
 
 
 #include "random.h"
+#include "counter_random.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -18,6 +18,66 @@ namespace liblibra{
 namespace librandom{
 
 
+Random::Random(){
+/**
+  Uses a fixed default seed, so the runs are reproducible (as with the default seed of the global rand()
+  used before). The objects created one after another get different streams: the n-th one is seeded
+  with 7919*n. The counter is atomic, so this also holds when the objects are created concurrently.
+  Call set_seed_from_time() for a run-dependent stream.
+*/
+  static std::atomic<int> counter(0);
+  set_seed(7919*(counter++));
+}
+
+Random::Random(int seed){
+/**
+  \param[in] seed The seed of the generator - the same seed gives the same sequence of random numbers
+*/
+  set_seed(seed);
+}
+
+void Random::set_seed(int seed){
+/**
+  \param[in] seed Re-initializes the generator state from this seed (using the splitmix64 sequence)
+*/
+  uint64_t x = (uint64_t)(uint32_t)seed;
+  for(int i=0;i<4;i++){
+    x += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    state[i] = z ^ (z >> 31);
+  }
+}
+
+void Random::set_seed_from_time(){
+/**
+  Re-seeds the generator from the current time - the sequence differs from run to run
+*/
+  static std::atomic<int> counter(0);
+  set_seed((int)time(0) + 7919*(counter++));
+}
+
+uint64_t Random::next(){
+/**
+  One step of the xoshiro256** generator. Unlike the C library rand(), the whole state is kept in the
+  object, so it can be checkpointed and restored exactly.
+*/
+  uint64_t res = state[1] * 5;
+  res = ((res << 7) | (res >> 57)) * 9;
+  uint64_t t = state[1] << 17;
+
+  state[2] ^= state[0];
+  state[3] ^= state[1];
+  state[1] ^= state[2];
+  state[0] ^= state[3];
+  state[2] ^= t;
+  state[3] = (state[3] << 45) | (state[3] >> 19);
+
+  return res;
+}
+
+
 int Random::fact(int k){
   if(k<=1){  return 1; }
   else{ return k*fact(k-1); }
@@ -56,7 +116,7 @@ void Random::bin(vector<double>& in,double minx,double maxx,double dx,vector< pa
 
 double Random::uniform(double a,double b){
 
-  double ksi = rand()/((double)RAND_MAX);
+  double ksi = (next() >> 11) * (1.0/9007199254740992.0);  // [0,1) with 53 random bits
   return (a + (b-a)*ksi);
 }
 double Random::p_uniform(double a,double b){
@@ -18,6 +18,8 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <stdint.h>
+#include <atomic>
 #include <boost/python.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
@@ -36,11 +38,19 @@ class Random{
   double Gamma(double a);
   void bin(vector<double>& in,double minx,double maxx,double dx,vector< pair<double,double> >& out);
 
+  uint64_t next();  // raw 64-bit output of the generator
+
   public:
 
-  Random(){   srand(time(0)); }
+  uint64_t state[4];  ///< state of the xoshiro256** generator owned by this object - may be saved and restored
+
+  Random();
+  Random(int seed);
   ~Random(){ ;; }
 
+  void set_seed(int seed);
+  void set_seed_from_time();
+
 
   // Uniform distribution
   double uniform(double a,double b);   // the random number of the disctribution below
@@ -0,0 +1,470 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Symmetry.cpp
+  \brief The file implements the SYMMETRY class: the detection of the point/space group of a structure,
+  the orbits of atoms and the irreducible k-points
+
+*/
+
+#include "Symmetry.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace std;
+using namespace liblinalg;
+
+/// libsymmetry namespace
+namespace libsymmetry{
+
+
+
+SYMMETRY::SYMMETRY(){
+/**
+  The empty set of operations
+*/
+  is_periodic = 0;
+  tol = 1e-3;
+  nat = 0;
+  T.identity();
+  invT.identity();
+}
+
+
+int SYMMETRY::match(MATRIX3x3& W, VECTOR& w, vector<int>& p, vector<int>& L){
+/**
+  Checks if the operation x -> W*x + w maps the structure onto itself
+
+  \param[in] W, w The operation (in the coordinates of pos)
+  \param[out] p The permutation of atoms induced by the operation
+  \param[out] L The lattice shifts of the images (3 integers per atom, zero for the molecules)
+
+  Returns 1 if every atom is mapped onto a distinct atom of the same type within the tolerance, 0 otherwise
+*/
+
+  p = vector<int>(nat, -1);
+  L = vector<int>(3*nat, 0);
+  vector<int> used(nat, 0);
+
+  double tol2 = tol*tol;
+
+  for(int i=0;i<nat;i++){
+    VECTOR y = W * pos[i] + w;
+
+    for(int j=0;j<nat;j++){
+      if(used[j] || types[j]!=types[i]){ continue; }
+
+      VECTOR d = y - pos[j];
+      VECTOR n(0.0, 0.0, 0.0);
+      if(is_periodic){
+        n = VECTOR(floor(d.x+0.5), floor(d.y+0.5), floor(d.z+0.5));
+        d = T * (d - n);
+      }
+
+      if(d.length2()<tol2){
+        p[i] = j;  used[j] = 1;
+        L[3*i+0] = (int)n.x;  L[3*i+1] = (int)n.y;  L[3*i+2] = (int)n.z;
+        break;
+      }
+    }// for j
+
+    if(p[i]<0){ return 0; }
+  }// for i
+
+  return 1;
+}
+
+
+void SYMMETRY::add_operation(MATRIX3x3& W, VECTOR& w, MATRIX3x3& _rot, VECTOR& t, vector<int>& p, vector<int>& L){
+/**
+  Adds the operation to the list, unless the same operation is already there
+*/
+
+  double det = _rot.Determinant();
+
+  for(int g=0;g<rot.size();g++){
+    if(perm[g]==p && rot[g].Determinant()*det>0.0){
+      if(!is_periodic){ return; }
+
+      // Crystals: the same W and the same w up to a lattice vector
+      MATRIX3x3 dW = rot_frac[g] - W;
+      VECTOR dw = trans_frac[g] - w;
+      dw = dw - VECTOR(floor(dw.x+0.5), floor(dw.y+0.5), floor(dw.z+0.5));
+      double mx = 0.0;
+      mx = std::max(mx, fabs(dW.xx)); mx = std::max(mx, fabs(dW.xy)); mx = std::max(mx, fabs(dW.xz));
+      mx = std::max(mx, fabs(dW.yx)); mx = std::max(mx, fabs(dW.yy)); mx = std::max(mx, fabs(dW.yz));
+      mx = std::max(mx, fabs(dW.zx)); mx = std::max(mx, fabs(dW.zy)); mx = std::max(mx, fabs(dW.zz));
+      if(mx<1e-6 && dw.length()<1e-6){ return; }
+    }
+  }
+
+  rot.push_back(_rot);
+  trans.push_back(t);
+  rot_frac.push_back(W);
+  trans_frac.push_back(w);
+  perm.push_back(p);
+  lattice_shift.push_back(L);
+
+  MATRIX op(3,4);
+  op.M[0] = W.xx;  op.M[1] = W.xy;  op.M[2]  = W.xz;  op.M[3]  = w.x;
+  op.M[4] = W.yx;  op.M[5] = W.yy;  op.M[6]  = W.yz;  op.M[7]  = w.y;
+  op.M[8] = W.zx;  op.M[9] = W.zy;  op.M[10] = W.zz;  op.M[11] = w.z;
+  operators.push_back(op);
+
+}
+
+
+// Clears all the operations
+static void clear_ops(SYMMETRY& s){
+  s.operators.clear();  s.rot.clear();  s.trans.clear();
+  s.rot_frac.clear();  s.trans_frac.clear();  s.perm.clear();  s.lattice_shift.clear();
+}
+
+
+void SYMMETRY::find_point_group(vector<VECTOR>& R, vector<int>& _types, double _tol){
+/**
+  Finds the point group of a molecule
+
+  \param[in] R The coordinates of atoms
+  \param[in] _types The types of atoms (e.g. the atomic numbers): only the atoms of the same type can be equivalent
+  \param[in] _tol The tolerance on the positions of atoms (same units as R)
+
+  The operations are defined about the geometric center c of the molecule: r -> R*(r - c) + c, so
+  trans = c - R*c.
+*/
+
+  int i, a, b, ap, bp;
+
+  if(R.size()!=_types.size()){
+    cout<<"Error in SYMMETRY::find_point_group: the sizes of R and types are different\n"; exit(0);
+  }
+
+  clear_ops(*this);
+  is_periodic = 0;
+  tol = _tol;
+  nat = R.size();
+  types = _types;
+  T.identity();  invT.identity();
+
+  VECTOR c(0.0, 0.0, 0.0);
+  for(i=0;i<nat;i++){ c += R[i]; }
+  if(nat>0){ c = c/((double)nat); }
+
+  pos = vector<VECTOR>(nat);
+  for(i=0;i<nat;i++){ pos[i] = R[i] - c; }
+
+  vector<int> p, L;
+  VECTOR zero(0.0, 0.0, 0.0);
+
+  // Identity - always the first
+  MATRIX3x3 E;  E.identity();
+  match(E, zero, p, L);
+  add_operation(E, zero, E, zero, p, L);
+
+
+  // The number of off-center atoms of every type: the reference atoms are taken from the rarest types
+  vector<int> cnt(nat, 0);
+  for(i=0;i<nat;i++){
+    if(pos[i].length()<tol){ continue; }
+    for(int j=0;j<nat;j++){  if(types[j]==types[i] && pos[j].length()>=tol){ cnt[i]++; }  }
+  }
+
+  a = -1;
+  for(i=0;i<nat;i++){
+    if(cnt[i]>0 && (a<0 || cnt[i]<cnt[a])){ a = i; }
+  }
+
+  b = -1;
+  if(a>=0){
+    VECTOR ea = pos[a]/pos[a].length();
+    for(i=0;i<nat;i++){
+      if(cnt[i]==0){ continue; }
+      if(cross(1.0, ea, pos[i]).length()<tol){ continue; }  // collinear with a
+      if(b<0 || cnt[i]<cnt[b]){ b = i; }
+    }
+  }
+
+
+  if(b<0){
+    // An atom or a linear molecule: only the inversion is checked
+    MATRIX3x3 I;  I.diag(-1.0);
+    if(match(I, zero, p, L)){
+      VECTOR t = c - I*c;
+      add_operation(I, zero, I, t, p, L);
+    }
+    return;
+  }
+
+
+  // The orthonormal frame of the two reference vectors
+  #define FRAME(u, v, F) { \
+    VECTOR e1 = u/u.length(); \
+    VECTOR e2 = v - (v*e1)*e1;  e2 = e2/e2.length(); \
+    VECTOR e3 = cross(1.0, e1, e2); \
+    F.init(e1, e2, e3); \
+  }
+
+  MATRIX3x3 F, Fp, S;
+  FRAME(pos[a], pos[b], F);
+  S.diag(1.0, 1.0, -1.0);
+
+  double ra = pos[a].length(), rb = pos[b].length(), rab = (pos[a]-pos[b]).length();
+
+  for(ap=0; ap<nat; ap++){
+    if(types[ap]!=types[a] || fabs(pos[ap].length()-ra)>tol){ continue; }
+
+    for(bp=0; bp<nat; bp++){
+      if(bp==ap || types[bp]!=types[b]){ continue; }
+      if(fabs(pos[bp].length()-rb)>tol || fabs((pos[ap]-pos[bp]).length()-rab)>2.0*tol){ continue; }
+      if(cross(1.0, pos[ap]/pos[ap].length(), pos[bp]).length()<0.5*tol){ continue; }
+
+      FRAME(pos[ap], pos[bp], Fp);
+
+      for(int is_improper=0; is_improper<2; is_improper++){
+        MATRIX3x3 Rg = (is_improper) ? Fp * S * F.T() : Fp * F.T();
+
+        if(match(Rg, zero, p, L)){
+          VECTOR t = c - Rg*c;
+          add_operation(Rg, zero, Rg, t, p, L);
+        }
+      }
+
+    }// for bp
+  }// for ap
+
+  #undef FRAME
+
+  // In the molecular case W = R and w = t: fix the fractional translations (set to zero above)
+  for(int g=0; g<rot.size(); g++){
+    trans_frac[g] = trans[g];
+    operators[g].M[3] = trans[g].x;  operators[g].M[7] = trans[g].y;  operators[g].M[11] = trans[g].z;
+  }
+
+}
+
+
+void SYMMETRY::find_space_group(vector<VECTOR>& R, vector<int>& _types, VECTOR& t1, VECTOR& t2, VECTOR& t3, double _tol){
+/**
+  Finds the space group of a crystal
+
+  \param[in] R The Cartesian coordinates of atoms in the unit cell (they do not need to be wrapped into the cell)
+  \param[in] _types The types of atoms (e.g. the atomic numbers): only the atoms of the same type can be equivalent
+  \param[in] t1, t2, t3 The cell vectors
+  \param[in] _tol The tolerance on the positions of atoms (same units as R)
+
+  The operations that are only the symmetries of the structure for a non-reduced choice of the cell (the
+  rotation matrices with the elements beyond -1, 0, 1) are not found.
+*/
+
+  int i;
+
+  if(R.size()!=_types.size()){
+    cout<<"Error in SYMMETRY::find_space_group: the sizes of R and types are different\n"; exit(0);
+  }
+
+  clear_ops(*this);
+  is_periodic = 1;
+  tol = _tol;
+  nat = R.size();
+  types = _types;
+
+  T.init(t1, t2, t3);
+  if(fabs(T.Determinant())<1e-12){
+    cout<<"Error in SYMMETRY::find_space_group: the cell vectors are linearly dependent\n"; exit(0);
+  }
+  invT = T.inverse();
+
+  pos = vector<VECTOR>(nat);
+  for(i=0;i<nat;i++){ pos[i] = invT * R[i]; }
+
+
+  vector<int> p, L;
+  VECTOR zero(0.0, 0.0, 0.0);
+
+  // Identity - always the first
+  MATRIX3x3 E;  E.identity();
+  match(E, zero, p, L);
+  add_operation(E, zero, E, zero, p, L);
+
+  if(nat==0){ return; }
+
+  // The reference atom: of the rarest type
+  int a = 0, cnt_a = nat+1;
+  for(i=0;i<nat;i++){
+    int cnt = 0;
+    for(int j=0;j<nat;j++){ if(types[j]==types[i]){ cnt++; } }
+    if(cnt<cnt_a){ a = i; cnt_a = cnt; }
+  }
+
+  // The tolerance on the orthogonality of the Cartesian rotation
+  double lmin = std::min(t1.length(), std::min(t2.length(), t3.length()));
+  double eps = std::max(1e-8, 2.0*tol/lmin);
+
+  double w9[9];
+  for(int code=0; code<19683; code++){
+    int c = code;
+    for(int k=0;k<9;k++){ w9[k] = (double)(c % 3 - 1);  c /= 3; }
+
+    MATRIX3x3 W;
+    W.xx = w9[0];  W.xy = w9[1];  W.xz = w9[2];
+    W.yx = w9[3];  W.yy = w9[4];  W.yz = w9[5];
+    W.zx = w9[6];  W.zy = w9[7];  W.zz = w9[8];
+
+    if(fabs(fabs(W.Determinant())-1.0)>1e-8){ continue; }
+
+    // The Cartesian rotation must be orthogonal
+    MATRIX3x3 Rg = T * W * invT;
+    MATRIX3x3 RR = Rg.T() * Rg;
+    if(fabs(RR.xx-1.0)>eps || fabs(RR.yy-1.0)>eps || fabs(RR.zz-1.0)>eps ||
+       fabs(RR.xy)>eps || fabs(RR.xz)>eps || fabs(RR.yz)>eps){ continue; }
+
+    // The translations mapping the reference atom onto the atoms of the same type
+    VECTOR ya = W * pos[a];
+    for(int b=0;b<nat;b++){
+      if(types[b]!=types[a]){ continue; }
+
+      VECTOR w = pos[b] - ya;
+      w = w - VECTOR(floor(w.x+1e-8), floor(w.y+1e-8), floor(w.z+1e-8));  // into [0, 1)
+
+      if(match(W, w, p, L)){
+        VECTOR t = T * w;
+        add_operation(W, w, Rg, t, p, L);
+      }
+    }// for b
+
+  }// for code
+
+}
+
+
+
+vector<int> SYMMETRY::equivalent_atoms(){
+/**
+  Returns, for every atom, the smallest index of the atoms symmetry-equivalent to it (the representative of its
+  orbit)
+*/
+
+  vector<int> res(nat);
+
+  for(int i=0;i<nat;i++){
+    res[i] = i;
+    for(int g=0;g<perm.size();g++){  res[i] = std::min(res[i], perm[g][i]);  }
+  }
+
+  return res;
+}
+
+
+vector<int> SYMMETRY::irreducible_atoms(){
+/**
+  Returns the list of the symmetry-inequivalent atoms: one representative (the smallest index) per orbit
+*/
+
+  vector<int> eq = equivalent_atoms();
+  vector<int> res;
+
+  for(int i=0;i<nat;i++){  if(eq[i]==i){ res.push_back(i); }  }
+
+  return res;
+}
+
+
+
+void SYMMETRY::irreducible_kpoints(int n1, int n2, int n3, int time_reversal,
+                                   vector<VECTOR>& k, vector<double>& weights, vector<int>& k_map){
+/**
+  Reduces the Gamma-centered n1 x n2 x n3 grid of k-points to the irreducible wedge of the Brillouin zone
+
+  \param[in] n1, n2, n3 The numbers of the k-points along the reciprocal vectors
+  \param[in] time_reversal If 1, k and -k are also treated as equivalent
+  \param[out] k The irreducible k-points in the fractional coordinates of the reciprocal lattice
+  \param[out] weights The weights of the irreducible k-points (the fractions of the grid points in their stars)
+  \param[out] k_map For every point of the full grid (index (i1*n2 + i2)*n3 + i3) - the index of its irreducible
+              k-point: the quantities computed in the wedge are unfolded to the full grid via this map
+
+  In the fractional coordinates the k-point kappa is mapped by the operation (W, w) onto W^T * kappa (taken over
+  the whole group, W^T and W^{-T} give the same stars). The operations that do not map the grid onto itself are
+  skipped.
+*/
+
+  if(!is_periodic){
+    cout<<"Error in SYMMETRY::irreducible_kpoints: the k-points are only defined for the periodic systems\n"; exit(0);
+  }
+  if(n1<=0 || n2<=0 || n3<=0){
+    cout<<"Error in SYMMETRY::irreducible_kpoints: the numbers of k-points should be positive\n"; exit(0);
+  }
+
+  int N = n1*n2*n3;
+  int n[3] = {n1, n2, n3};
+
+  k.clear();
+  weights.clear();
+  k_map = vector<int>(N, -1);
+
+  vector<int> cnt;
+
+  for(int i1=0;i1<n1;i1++){
+    for(int i2=0;i2<n2;i2++){
+      for(int i3=0;i3<n3;i3++){
+
+        int I = (i1*n2 + i2)*n3 + i3;
+        if(k_map[I]>=0){ continue; }
+
+        int ik = k.size();
+        k.push_back(VECTOR(i1/(double)n1, i2/(double)n2, i3/(double)n3));
+        cnt.push_back(0);
+
+        double kap[3] = { i1/(double)n1, i2/(double)n2, i3/(double)n3 };
+
+        for(int g=0; g<rot_frac.size(); g++){
+          MATRIX3x3& W = rot_frac[g];
+          double Wm[3][3] = { {W.xx, W.xy, W.xz}, {W.yx, W.yy, W.yz}, {W.zx, W.zy, W.zz} };
+
+          int m[3], ok = 1;
+          for(int a=0;a<3;a++){
+            double x = 0.0;
+            for(int b=0;b<3;b++){ x += Wm[b][a]*kap[b]; }  // (W^T * kappa)_a
+            x *= n[a];
+            double xr = floor(x+0.5);
+            if(fabs(x-xr)>1e-6){ ok = 0; break; }
+            m[a] = (int)xr;
+          }
+          if(!ok){ continue; }
+
+          for(int tr=0; tr<=time_reversal; tr++){
+            int j[3];
+            for(int a=0;a<3;a++){
+              j[a] = (tr==0) ? m[a] : -m[a];
+              j[a] = ((j[a] % n[a]) + n[a]) % n[a];
+            }
+            int J = (j[0]*n2 + j[1])*n3 + j[2];
+            if(k_map[J]<0){ k_map[J] = ik; cnt[ik]++; }
+          }
+        }// for g
+
+        if(k_map[I]<0){ k_map[I] = ik; cnt[ik]++; }  // no operations - e.g. the empty group
+
+      }// for i3
+    }// for i2
+  }// for i1
+
+  weights = vector<double>(k.size());
+  for(int ik=0; ik<k.size(); ik++){ weights[ik] = cnt[ik]/(double)N; }
+
+}
+
+
+
+}//namespace libsymmetry
+}//namespace liblibra
+
@@ -0,0 +1,100 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Symmetry.h
+  \brief The file describes the SYMMETRY class: the detection of the point/space group of a given structure
+  and the atom permutation maps induced by the symmetry operations
+
+*/
+
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "../math_linalg/liblinalg.h"
+#include <vector>
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libsymmetry namespace
+namespace libsymmetry{
+
+
+class SYMMETRY{
+/**
+  This class finds and holds the symmetry operations of a given structure (a molecule or a periodic crystal).
+
+  Every operation g maps the point r to R*r + t. For the crystals, the operation is also stored in the fractional
+  coordinates x (r = T*x, with the columns of T being the cell vectors): x -> W*x + w, where W is an integer matrix.
+  The operation maps the atom i onto the atom perm[g][i], possibly in another cell:
+
+  W * x_i + w = x_{perm[g][i]} + L,  with L = lattice_shift[g][3*i ... 3*i+2] (integers)
+
+  For the molecules, W = R, w = t and L = 0.
+
+  The operations are found by the direct search with the tolerance tol on the atomic positions:
+  - the molecules: all the orthogonal transformations about the geometric center that map two non-collinear
+    reference atoms onto the atoms of the same types are tried, so the finite point groups are found completely
+    (for the linear molecules only the identity and the inversion are kept);
+  - the crystals: the integer matrices W with the elements -1, 0, 1 that preserve the metric of the lattice
+    (the complete lattice point group of a reduced cell) are combined with all the translations that map the
+    reference atom onto the atoms of the same type. For the supercells this also gives the pure translations.
+*/
+
+  void add_operation(MATRIX3x3& W, VECTOR& w, MATRIX3x3& rot, VECTOR& t, vector<int>& p, vector<int>& L);
+  int match(MATRIX3x3& W, VECTOR& w, vector<int>& p, vector<int>& L);
+
+  vector<VECTOR> pos;           ///< the coordinates used in the search: Cartesian (molecules) or fractional (crystals)
+  vector<int> types;            ///< the types of atoms
+  MATRIX3x3 T;                  ///< the cell vectors as the columns
+  MATRIX3x3 invT;               ///< the inverse of T
+
+public:
+
+  int is_periodic;              ///< 1 - the space group of a crystal, 0 - the point group of a molecule
+  double tol;                   ///< the tolerance on the atomic positions (the units of the coordinates)
+  int nat;                      ///< the number of atoms
+
+  vector<MATRIX> operators;     ///< the operations as 3x4 matrices [W | w] - same convention as in SPACE_GROUP
+  vector<MATRIX3x3> rot;        ///< the Cartesian rotation (proper or improper) of every operation
+  vector<VECTOR> trans;         ///< the Cartesian translation of every operation
+  vector<MATRIX3x3> rot_frac;   ///< W: the rotation in the fractional coordinates (integer-valued for crystals)
+  vector<VECTOR> trans_frac;    ///< w: the translation in the fractional coordinates
+  vector< vector<int> > perm;   ///< perm[g][i] - the atom onto which the operation g maps the atom i
+  vector< vector<int> > lattice_shift; ///< the cell of the image: 3 integers per atom for every operation
+
+
+  SYMMETRY();
+
+  void find_point_group(vector<VECTOR>& R, vector<int>& _types, double _tol);
+  void find_space_group(vector<VECTOR>& R, vector<int>& _types, VECTOR& t1, VECTOR& t2, VECTOR& t3, double _tol);
+
+  int order(){ return rot.size(); }
+  MATRIX3x3 get_cell(){ return T; }     ///< the cell vectors (as the columns) used in the search
+  MATRIX3x3 get_rot(int g){ return rot[g]; }
+  MATRIX3x3 get_rot_frac(int g){ return rot_frac[g]; }
+
+  vector<int> equivalent_atoms();
+  vector<int> irreducible_atoms();
+
+  void irreducible_kpoints(int n1, int n2, int n3, int time_reversal,
+                           vector<VECTOR>& k, vector<double>& weights, vector<int>& k_map);
+
+};
+
+
+}//namespace libsymmetry
+}//namespace liblibra
+
+
+#endif // SYMMETRY_H
@@ -51,6 +51,30 @@ void export_symmetry_objects(){
   def("Apply_Symmetry",expt_Apply_Symmetry_v1);
 
 
+  class_<SYMMETRY>("SYMMETRY",init<>())
+      .def("__copy__", &generic__copy__<SYMMETRY>) 
+      .def("__deepcopy__", &generic__deepcopy__<SYMMETRY>)
+
+      .def_readwrite("is_periodic",&SYMMETRY::is_periodic)
+      .def_readwrite("tol",&SYMMETRY::tol)
+      .def_readwrite("nat",&SYMMETRY::nat)
+      .def_readwrite("operators",&SYMMETRY::operators)
+      .def_readwrite("trans",&SYMMETRY::trans)
+      .def_readwrite("trans_frac",&SYMMETRY::trans_frac)
+      .def_readwrite("perm",&SYMMETRY::perm)
+      .def_readwrite("lattice_shift",&SYMMETRY::lattice_shift)
+
+      .def("find_point_group",&SYMMETRY::find_point_group)
+      .def("find_space_group",&SYMMETRY::find_space_group)
+      .def("order",&SYMMETRY::order)
+      .def("get_rot",&SYMMETRY::get_rot)
+      .def("get_rot_frac",&SYMMETRY::get_rot_frac)
+      .def("equivalent_atoms",&SYMMETRY::equivalent_atoms)
+      .def("irreducible_atoms",&SYMMETRY::irreducible_atoms)
+      .def("irreducible_kpoints",&SYMMETRY::irreducible_kpoints)
+  ;
+
+
 
 }// export_symmetry_objects()
 
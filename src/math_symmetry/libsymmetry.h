@@ -20,6 +20,7 @@
 
 
 #include "Space_Groups.h"
+#include "Symmetry.h"
 
 /// liblibra namespace
 namespace liblibra{
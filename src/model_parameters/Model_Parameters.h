@@ -52,6 +52,12 @@ class HF_integrals{
   void set_JK_values(int,int,int,int,double, double);  
   void get_JK_values(int,int,int,int,double&,double&);  
 
+  int size(){ return data.size(); }   ///< the number of the stored integrals
+  void get_JK_element(int n, int& a, int& b, int& c, int& d, double& J, double& K){   ///< the n-th stored integral
+    a = data[n].a;  b = data[n].b;  c = data[n].c;  d = data[n].d;
+    J = data[n].J_abcd;  K = data[n].K_adcb;
+  }
+
   friend bool operator == (const HF_integrals& m1, const HF_integrals& m2){
     // Equal
     int res = 1;
@@ -559,10 +565,13 @@ public:
   vector<double> eri;  ///< precomputed electron repulsion integrals (only (ss|ss) type between all pairs of atoms)
   vector<double> V_AB; ///< precomputed core-core repulsion terms for all pairs of atoms
 
+  PairIntegralCache* int_cache; ///< tables of the two-center integrals (not owned; NULL - compute the integrals directly)
+
   
   //-------------- Constructor --------------
   Model_Parameters(){  
     indo_opt = 1;
+    int_cache = NULL;
     set_default_elements(PT);
   }
 
@@ -576,6 +585,7 @@ public:
     indo_opt = ob.indo_opt;
     eri = ob.eri;
     V_AB = ob.V_AB;
+    int_cache = ob.int_cache;
   }
 
 
@@ -0,0 +1,232 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file TargetDensity.cpp
+  \brief The file implements the built-in target densities and the registry of the compiled densities
+
+*/
+
+#include "TargetDensity.h"
+#include "../Units.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libmontecarlo namespace
+namespace libmontecarlo{
+
+
+static void check_sizes(std::string fname, int n, vector<double>& x, std::string xname){
+  if(x.size()!=n){
+    cout<<"Error in "<<fname<<": the size of "<<xname<<" ("<<x.size()<<") should be "<<n<<"\n"; exit(0);
+  }
+}
+
+
+HarmonicDensity::HarmonicDensity(vector<double>& mass_, vector<double>& omega_, vector<double>& q0_, double T){
+/**
+  \param[in] mass_ Masses of the oscillators [a.u.]
+  \param[in] omega_ Frequencies of the oscillators [a.u.]
+  \param[in] q0_ Equilibrium positions
+  \param[in] T Temperature [K]
+*/
+
+  ndof = mass_.size();
+  check_sizes("HarmonicDensity", ndof, omega_, "omega");
+  check_sizes("HarmonicDensity", ndof, q0_, "q0");
+
+  if(T<=0.0){ cout<<"Error in HarmonicDensity: the temperature must be positive\n"; exit(0); }
+
+  mass = mass_;  omega = omega_;  q0 = q0_;
+  kT = (boltzmann/hartree) * T;
+
+}
+
+double HarmonicDensity::log_density(const double* x){
+
+  double res = 0.0;
+  for(int i=0;i<ndof;i++){
+    double dq = x[i] - q0[i];
+    res -= 0.5 * mass[i] * omega[i] * omega[i] * dq * dq;
+  }
+  return res / kT;
+
+}
+
+
+
+WignerDensity::WignerDensity(vector<double>& mass_, vector<double>& omega_, vector<double>& q0_, vector<double>& p0_, double T){
+/**
+  \param[in] mass_ Masses of the oscillators [a.u.]
+  \param[in] omega_ Frequencies of the oscillators [a.u.]
+  \param[in] q0_ Centers of the coordinates distributions
+  \param[in] p0_ Centers of the momenta distributions
+  \param[in] T Temperature [K]; T = 0 gives the ground state Wigner function
+*/
+
+  int n = mass_.size();
+  check_sizes("WignerDensity", n, omega_, "omega");
+  check_sizes("WignerDensity", n, q0_, "q0");
+  check_sizes("WignerDensity", n, p0_, "p0");
+
+  ndof = 2*n;
+  mass = mass_;  omega = omega_;  q0 = q0_;  p0 = p0_;
+
+  double kT = (boltzmann/hartree) * T;
+
+  alpha = vector<double>(n, 0.0);
+  for(int i=0;i<n;i++){
+    alpha[i] = (T>0.0) ? tanh(0.5*omega[i]/kT) / omega[i] : 1.0 / omega[i];
+  }
+
+}
+
+double WignerDensity::log_density(const double* x){
+
+  int n = ndof/2;
+  double res = 0.0;
+
+  for(int i=0;i<n;i++){
+    double dq = x[i] - q0[i];
+    double dp = x[n+i] - p0[i];
+    res -= alpha[i] * ( dp*dp/mass[i] + mass[i]*omega[i]*omega[i]*dq*dq );
+  }
+  return res;
+
+}
+
+
+
+BoltzmannDensity::BoltzmannDensity(Hamiltonian& ham_, int istate_, double T){
+/**
+  \param[in] ham_ The model Hamiltonian - is referenced, not copied
+  \param[in] istate_ The index of the electronic state
+  \param[in] T Temperature [K]
+*/
+
+  if(T<=0.0){ cout<<"Error in BoltzmannDensity: the temperature must be positive\n"; exit(0); }
+
+  ham = &ham_;
+  istate = istate_;
+  ndof = ham->nnucl;
+  kT = (boltzmann/hartree) * T;
+  q = vector<double>(ndof, 0.0);
+
+}
+
+double BoltzmannDensity::log_density(const double* x){
+
+  for(int i=0;i<ndof;i++){ q[i] = x[i]; }
+
+  ham->set_q(q);
+  ham->compute();
+
+  return -ham->H(istate, istate).real() / kT;
+
+}
+
+
+
+//========================= Registry of the compiled densities ========================
+
+static double gaussian_log_density(const double* x, int ndof, const vector<double>& params){
+
+  double res = 0.0;
+  for(int i=0;i<ndof;i++){
+    double dx = (x[i] - params[i]) / params[ndof+i];
+    res -= 0.5*dx*dx;
+  }
+  return res;
+}
+
+static double double_well_log_density(const double* x, int ndof, const vector<double>& params){
+
+  double res = 0.0;
+  for(int i=0;i<ndof;i++){
+    double x2 = x[i]*x[i];
+    res -= params[0] * (params[1]*x2*x2 - params[2]*x2);
+  }
+  return res;
+}
+
+
+static std::map<std::string, log_density_function>& density_registry(){
+/**
+  The registry is created on the first use, with the built-in functions in it
+*/
+
+  static std::map<std::string, log_density_function> registry;
+
+  if(registry.size()==0){
+    registry["gaussian"] = &gaussian_log_density;
+    registry["double_well"] = &double_well_log_density;
+  }
+
+  return registry;
+}
+
+
+void register_density(std::string name, log_density_function f){
+/**
+  Makes a compiled density function available by its name (for CompiledDensity).
+  Registering a function under an existing name replaces the old function.
+*/
+
+  density_registry()[name] = f;
+
+}
+
+log_density_function find_density(std::string name){
+
+  std::map<std::string, log_density_function>::iterator it = density_registry().find(name);
+
+  if(it==density_registry().end()){
+    cout<<"Error in find_density: the density \""<<name<<"\" is not registered\n"; exit(0);
+  }
+
+  return it->second;
+}
+
+vector<std::string> registered_densities(){
+
+  vector<std::string> res;
+  std::map<std::string, log_density_function>::iterator it;
+  for(it=density_registry().begin(); it!=density_registry().end(); it++){  res.push_back(it->first);  }
+
+  return res;
+}
+
+
+
+CompiledDensity::CompiledDensity(std::string name_, int ndof_, vector<double>& params_){
+/**
+  \param[in] name_ The name of the registered density function
+  \param[in] ndof_ The dimensionality of the sampled space
+  \param[in] params_ The parameters passed to the function
+*/
+
+  name = name_;
+  ndof = ndof_;
+  params = params_;
+  f = find_density(name);
+
+  if(name=="gaussian"){  check_sizes("CompiledDensity", 2*ndof, params, "params");  }
+  if(name=="double_well"){  check_sizes("CompiledDensity", 3, params, "params");  }
+
+}
+
+
+
+
+}// namespace libmontecarlo
+}// liblibra
+
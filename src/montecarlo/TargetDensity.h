@@ -0,0 +1,156 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file TargetDensity.h
+  \brief The file describes the target probability densities for the native Monte Carlo samplers
+
+  All the densities return the natural logarithm of the (unnormalized) probability density, so the
+  samplers never need to divide small numbers. Atomic units are used, hbar = 1.
+*/
+
+#ifndef TARGET_DENSITY_H
+#define TARGET_DENSITY_H
+
+#include <string>
+#include <map>
+#include "../math_linalg/liblinalg.h"
+#include "../hamiltonian/Hamiltonian_Generic/Hamiltonian.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace libhamiltonian::libhamiltonian_generic;
+
+/// libmontecarlo namespace
+namespace libmontecarlo{
+
+
+class TargetDensity{
+/**
+  The interface of the target densities. A compiled density is defined by deriving from this class
+  (in C++) or by registering a function with register_density() and using CompiledDensity.
+*/
+
+public:
+
+  int ndof;       ///< dimensionality of the sampled space
+
+  TargetDensity(){ ndof = 0; }
+  virtual ~TargetDensity(){ ;; }
+
+  virtual double log_density(const double* x){ return 0.0; }   ///< ln p(x) + const, x has ndof components
+  virtual int thread_safe(){ return 1; }   ///< 0 - if the chains may not evaluate the density concurrently
+
+  double log_density(const MATRIX& x){ return log_density(x.M); }
+
+};
+
+
+class HarmonicDensity : public TargetDensity{
+/**
+  Classical Boltzmann distribution of the coordinates of independent harmonic oscillators:
+
+  ln p(q) = - sum_i { 0.5 * mass_i * omega_i^2 * (q_i - q0_i)^2 } / kT
+*/
+
+public:
+
+  vector<double> mass;
+  vector<double> omega;
+  vector<double> q0;
+  double kT;             ///< in Ha
+
+  HarmonicDensity(vector<double>& mass_, vector<double>& omega_, vector<double>& q0_, double T);
+  double log_density(const double* x);
+
+};
+
+
+class WignerDensity : public TargetDensity{
+/**
+  Wigner distribution of independent quantum harmonic oscillators at temperature T (T = 0 - the ground state).
+  The sampled vector is (q_0, ..., q_{n-1}, p_0, ..., p_{n-1}), so ndof = 2n:
+
+  ln p(q,p) = - sum_i { tanh(omega_i/2kT) / omega_i * [ (p_i - p0_i)^2 / mass_i + mass_i * omega_i^2 * (q_i - q0_i)^2 ] }
+*/
+
+public:
+
+  vector<double> mass;
+  vector<double> omega;
+  vector<double> q0;
+  vector<double> p0;
+  vector<double> alpha;  ///< tanh(omega_i/2kT) / omega_i
+
+  WignerDensity(vector<double>& mass_, vector<double>& omega_, vector<double>& q0_, vector<double>& p0_, double T);
+  double log_density(const double* x);
+
+};
+
+
+class BoltzmannDensity : public TargetDensity{
+/**
+  Classical Boltzmann distribution on the potential energy surface <istate> of a model Hamiltonian:
+
+  ln p(q) = - H(istate, istate)(q) / kT
+
+  The energy is taken in the representation set for the Hamiltonian (ham.rep). The Hamiltonian object keeps
+  the coordinates as its state, so the chains are advanced sequentially when this density is used.
+*/
+
+public:
+
+  Hamiltonian* ham;
+  int istate;
+  double kT;
+  vector<double> q;
+
+  BoltzmannDensity(Hamiltonian& ham_, int istate_, double T);
+  double log_density(const double* x);
+  int thread_safe(){ return 0; }
+
+};
+
+
+/// Signature of the compiled densities that may be registered by name
+typedef double (*log_density_function)(const double* x, int ndof, const vector<double>& params);
+
+void register_density(std::string name, log_density_function f);
+log_density_function find_density(std::string name);
+vector<std::string> registered_densities();
+
+
+class CompiledDensity : public TargetDensity{
+/**
+  The density given by a registered function. The built-in functions:
+
+  "gaussian" - params = [x0_0, ..., x0_{n-1}, sigma_0, ..., sigma_{n-1}]
+  "double_well" - ln p = -sum_i beta*(a*x_i^4 - b*x_i^2),  params = [beta, a, b]
+*/
+
+public:
+
+  std::string name;
+  log_density_function f;
+  vector<double> params;
+
+  CompiledDensity(std::string name_, int ndof_, vector<double>& params_);
+  double log_density(const double* x){ return f(x, ndof, params); }
+
+};
+
+
+}// namespace libmontecarlo
+}// liblibra
+
+#endif // TARGET_DENSITY_H
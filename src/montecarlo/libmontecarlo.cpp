@@ -45,6 +45,61 @@ void export_montecarlo_objects(){
   def("metropolis_gau",expt_metropolis_gau_v1);
 
 
+  class_<TargetDensity, boost::noncopyable>("TargetDensity",no_init)
+      .def_readonly("ndof",&TargetDensity::ndof)
+      .def("thread_safe",&TargetDensity::thread_safe)
+  ;
+
+  class_<HarmonicDensity, bases<TargetDensity>, boost::noncopyable>("HarmonicDensity",
+      init<vector<double>&, vector<double>&, vector<double>&, double>())
+  ;
+
+  class_<WignerDensity, bases<TargetDensity>, boost::noncopyable>("WignerDensity",
+      init<vector<double>&, vector<double>&, vector<double>&, vector<double>&, double>())
+  ;
+
+  class_<BoltzmannDensity, bases<TargetDensity>, boost::noncopyable>("BoltzmannDensity",
+      init<Hamiltonian&, int, double>()[with_custodian_and_ward<1,2>()])
+  ;
+
+  class_<CompiledDensity, bases<TargetDensity>, boost::noncopyable>("CompiledDensity",
+      init<std::string, int, vector<double>&>())
+      .def_readonly("name",&CompiledDensity::name)
+      .def_readwrite("params",&CompiledDensity::params)
+  ;
+
+  def("registered_densities", &registered_densities);
+
+
+  class_<MCSamples>("MCSamples",init<>())
+      .def_readwrite("nchains",&MCSamples::nchains)
+      .def_readwrite("ndof",&MCSamples::ndof)
+      .def_readwrite("nsamples",&MCSamples::nsamples)
+      .def_readwrite("beta",&MCSamples::beta)
+      .def_readwrite("samples",&MCSamples::samples)
+      .def_readwrite("acceptance",&MCSamples::acceptance)
+      .def_readwrite("swap_acceptance",&MCSamples::swap_acceptance)
+      .def_readwrite("tau",&MCSamples::tau)
+      .def_readwrite("ess",&MCSamples::ess)
+      .def_readwrite("rhat",&MCSamples::rhat)
+      .def("get_samples",&MCSamples::get_samples)
+  ;
+
+
+  MCSamples (*expt_metropolis_parallel_v1)
+             (TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed) = &metropolis_parallel;
+  MCSamples (*expt_metropolis_parallel_v2)
+             (TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed,
+              vector<double>& beta, int exchange_interval) = &metropolis_parallel;
+
+  def("metropolis_parallel",expt_metropolis_parallel_v1);
+  def("metropolis_parallel",expt_metropolis_parallel_v2);
+
+
+  double (*expt_integrated_autocorrelation_time_v1)(vector<double>& x) = &integrated_autocorrelation_time;
+  def("integrated_autocorrelation_time",expt_integrated_autocorrelation_time_v1);
+
+
 }// export_montecarlo_objects()
 
 
@@ -0,0 +1,278 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file metropolis_parallel.cpp
+  \brief The file implements the parallel-chain (and replica-exchange) Metropolis sampling with native target densities
+
+*/
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "montecarlo.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace librandom;
+
+/// libmontecarlo namespace
+namespace libmontecarlo{
+
+
+double integrated_autocorrelation_time(const double* x, int n){
+/**
+  Integrated autocorrelation time tau = 1 + 2 sum_t rho(t), with the self-consistent window of Sokal:
+  the sum is truncated at the first t >= 5 tau. The effective number of independent samples is n / tau.
+
+  \param[in] x The time series
+  \param[in] n The length of the series
+*/
+
+  if(n<2){ return 1.0; }
+
+  double ave = 0.0;
+  for(int i=0;i<n;i++){ ave += x[i]; }
+  ave /= double(n);
+
+  double var = 0.0;
+  for(int i=0;i<n;i++){ var += (x[i]-ave)*(x[i]-ave); }
+  var /= double(n);
+
+  if(var<=0.0){ return 1.0; }
+
+  double tau = 1.0;
+  for(int t=1;t<n;t++){
+
+    if(double(t) >= 5.0*tau){ break; }
+
+    double c = 0.0;
+    for(int i=0;i<n-t;i++){ c += (x[i]-ave)*(x[i+t]-ave); }
+    tau += 2.0 * c / (double(n-t) * var);
+
+  }
+
+  return (tau<1.0) ? 1.0 : tau;
+}
+
+double integrated_autocorrelation_time(vector<double>& x){
+
+  return integrated_autocorrelation_time(&x[0], x.size());
+
+}
+
+
+static void compute_diagnostics(MCSamples& res){
+/**
+  Autocorrelation times, effective sample sizes and the Gelman-Rubin factors of the chains with beta = 1
+*/
+
+  int c, i, n;
+  int N = res.nsamples;
+
+  vector<int> chains;
+  for(c=0;c<res.nchains;c++){  if(res.beta[c]==1.0){ chains.push_back(c); }  }
+
+  int nch = chains.size();
+
+  res.tau = vector<double>(res.ndof, 0.0);
+  res.ess = vector<double>(res.ndof, 0.0);
+  res.rhat = vector<double>(res.ndof, 0.0);
+
+  if(nch==0 || N==0){ return; }
+
+  for(i=0;i<res.ndof;i++){
+
+    vector<double> ave(nch, 0.0), var(nch, 0.0);
+
+    for(int k=0;k<nch;k++){
+
+      const double* x = res.samples[chains[k]].M + i*N;
+      double t = integrated_autocorrelation_time(x, N);
+
+      res.tau[i] += t / double(nch);
+      res.ess[i] += double(N) / t;
+
+      for(n=0;n<N;n++){ ave[k] += x[n]; }
+      ave[k] /= double(N);
+      for(n=0;n<N;n++){ var[k] += (x[n]-ave[k])*(x[n]-ave[k]); }
+      if(N>1){ var[k] /= double(N-1); }
+    }
+
+    if(nch>1 && N>1){
+
+      double W = 0.0, mean = 0.0, B = 0.0;
+      for(int k=0;k<nch;k++){ W += var[k]/double(nch);  mean += ave[k]/double(nch); }
+      for(int k=0;k<nch;k++){ B += (ave[k]-mean)*(ave[k]-mean); }
+      B *= double(N)/double(nch-1);
+
+      if(W>0.0){  res.rhat[i] = sqrt( ((N-1.0)/N * W + B/N) / W );  }
+      else{  res.rhat[i] = 1.0; }
+    }
+
+  }// for i
+
+}
+
+
+
+MCSamples metropolis_parallel(TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed,
+                              vector<double>& beta, int exchange_interval){
+/**
+  \brief Metropolis sampling with many chains advanced in parallel, optionally with replica exchange
+
+  Each chain c samples the density p(x)^beta[c] with the Gaussian random-walk proposals of the width
+  gau_var/sqrt(beta[c]). Every step of a chain (accepted or not) after the first start_sampling steps is stored
+  as a sample. Every exchange_interval steps, the swaps of the configurations of the neighbouring chains
+  (c, c+1) are attempted - the even pairs and the odd pairs in turns. With all beta = 1 and exchange_interval = 0
+  the chains are independent.
+
+  Each chain uses its own counter-based random stream (seed, c), and the exchanges - the stream (seed, nchains),
+  so the results are the same for any number of OpenMP threads.
+
+  \param[in] target The target density; the chains run concurrently if target.thread_safe() is 1
+  \param[in] x0 The starting points of the chains: ndof x nchains matrix
+  \param[in] nsamples The number of samples to collect in each chain
+  \param[in] start_sampling The number of the initial (equilibration) steps to disregard
+  \param[in] gau_var The width of the Gaussian proposal
+  \param[in] seed The seed of the random streams
+  \param[in] beta The inverse temperature factors of the chains (nchains values)
+  \param[in] exchange_interval How often to attempt the replica exchange, 0 - never
+
+  Returns the samples of all the chains and the diagnostics of the chains with beta = 1.
+*/
+
+  int ndof = target.ndof;
+  int nchains = x0.n_cols;
+  int c, i;
+
+  if(x0.n_rows!=ndof){
+    cout<<"Error in metropolis_parallel: the number of rows of x0 ("<<x0.n_rows<<") should be equal to the number of dofs of the target ("<<ndof<<")\n";
+    exit(0);
+  }
+  if(beta.size()!=nchains){
+    cout<<"Error in metropolis_parallel: the number of beta values ("<<beta.size()<<") should be equal to the number of chains ("<<nchains<<")\n";
+    exit(0);
+  }
+
+  MCSamples res;
+  res.nchains = nchains;
+  res.ndof = ndof;
+  res.nsamples = nsamples;
+  res.beta = beta;
+  res.samples = vector<MATRIX>(nchains, MATRIX(ndof, nsamples));
+  res.acceptance = vector<double>(nchains, 0.0);
+  res.swap_acceptance = vector<double>((nchains>1) ? nchains-1 : 0, 0.0);
+
+  vector< vector<double> > x(nchains, vector<double>(ndof, 0.0));
+  vector<double> lp(nchains, 0.0);
+  vector<CounterRandom> rnd;
+  vector<int> nacc(nchains, 0);
+
+  for(c=0;c<nchains;c++){
+    for(i=0;i<ndof;i++){ x[c][i] = x0.M[i*nchains+c]; }
+    lp[c] = target.log_density(&x[c][0]);
+    rnd.push_back(CounterRandom(seed, c));
+  }
+  CounterRandom rnd_swap(seed, nchains);
+  vector<int> nswap_try(res.swap_acceptance.size(), 0);
+  vector<int> nswap_acc(res.swap_acceptance.size(), 0);
+
+  int nsteps = start_sampling + nsamples;
+  int seg_len = (exchange_interval>0 && nchains>1) ? exchange_interval : nsteps;
+  int parallel = target.thread_safe();
+
+  int step0 = 0, iseg = 0;
+  while(step0<nsteps){
+
+    int step1 = step0 + seg_len;
+    if(step1>nsteps){ step1 = nsteps; }
+
+    // Advance all the chains independently
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+    for(int c1=0;c1<nchains;c1++){
+
+      vector<double> x_new(ndof, 0.0);
+      double width = gau_var / sqrt(beta[c1]);
+
+      for(int step=step0; step<step1; step++){
+
+        for(int k=0;k<ndof;k++){  x_new[k] = x[c1][k] + width * rnd[c1].normal();  }
+
+        double lp_new = target.log_density(&x_new[0]);
+        double ksi = rnd[c1].uniform();
+
+        if(log(ksi) < beta[c1] * (lp_new - lp[c1])){
+          x[c1] = x_new;
+          lp[c1] = lp_new;
+          nacc[c1]++;
+        }
+
+        if(step>=start_sampling){
+          int n = step - start_sampling;
+          for(int k=0;k<ndof;k++){  res.samples[c1].M[k*nsamples+n] = x[c1][k];  }
+        }
+
+      }// for step
+    }// for c1
+
+    // Replica exchange between the neighbouring chains
+    if(step1<nsteps && seg_len<nsteps){
+
+      for(c=iseg%2; c+1<nchains; c+=2){
+
+        double arg = (beta[c] - beta[c+1]) * (lp[c+1] - lp[c]);
+        nswap_try[c]++;
+
+        if(log(rnd_swap.uniform()) < arg){
+          x[c].swap(x[c+1]);
+          double tmp = lp[c];  lp[c] = lp[c+1];  lp[c+1] = tmp;
+          nswap_acc[c]++;
+        }
+      }
+
+    }
+
+    step0 = step1;
+    iseg++;
+
+  }// while
+
+
+  for(c=0;c<nchains;c++){  res.acceptance[c] = (nsteps>0) ? double(nacc[c])/double(nsteps) : 0.0;  }
+  for(c=0;c<nswap_try.size();c++){
+    res.swap_acceptance[c] = (nswap_try[c]>0) ? double(nswap_acc[c])/double(nswap_try[c]) : 0.0;
+  }
+
+  compute_diagnostics(res);
+
+  return res;
+}
+
+
+MCSamples metropolis_parallel(TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed){
+/**
+  Independent chains sampling the target density itself (all beta = 1, no exchanges)
+*/
+
+  vector<double> beta(x0.n_cols, 1.0);
+
+  return metropolis_parallel(target, x0, nsamples, start_sampling, gau_var, seed, beta, 0);
+
+}
+
+
+
+}// namespace libmontecarlo
+}// liblibra
+
@@ -22,6 +22,7 @@
 #include "../math_linalg/liblinalg.h"
 #include "../math_random/librandom.h"
 #include "../io/libio.h"
+#include "TargetDensity.h"
 
 namespace bp = boost::python;
 
@@ -41,6 +42,42 @@ vector<MATRIX> metropolis_gau(Random& rnd, bp::object target_distribution, MATRI
                               int sample_size, int start_sampling, double gau_var);
 
 
+class MCSamples{
+/**
+  The results of the parallel-chain Metropolis sampling
+*/
+
+public:
+
+  int nchains;                      ///< number of chains
+  int ndof;                         ///< dimensionality of the sampled space
+  int nsamples;                     ///< number of samples per chain
+  vector<double> beta;              ///< inverse temperature factor of each chain (1.0 - the target density itself)
+
+  vector<MATRIX> samples;           ///< samples[c] - ndof x nsamples matrix of the samples of the chain c
+  vector<double> acceptance;        ///< fraction of the accepted moves in each chain
+  vector<double> swap_acceptance;   ///< fraction of the accepted exchanges between the chains c and c+1
+
+  // Diagnostics, computed over the chains with beta = 1
+  vector<double> tau;               ///< integrated autocorrelation time of each dof (in steps), averaged over the chains
+  vector<double> ess;               ///< effective sample size of each dof, summed over the chains
+  vector<double> rhat;              ///< Gelman-Rubin potential scale reduction factor of each dof (0, if only 1 chain)
+
+  MCSamples(){ nchains = 0; ndof = 0; nsamples = 0; }
+
+  MATRIX get_samples(int c){ return samples[c]; }
+
+};
+
+
+double integrated_autocorrelation_time(vector<double>& x);
+double integrated_autocorrelation_time(const double* x, int n);
+
+MCSamples metropolis_parallel(TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed);
+MCSamples metropolis_parallel(TargetDensity& target, MATRIX& x0, int nsamples, int start_sampling, double gau_var, int seed,
+                              vector<double>& beta, int exchange_interval);
+
+
 
 }// namespace libmontecarlo
 }// liblibra
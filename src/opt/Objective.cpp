@@ -0,0 +1,291 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Objective.cpp
+  \brief The file implements the objective functions and the adapters of the Hamiltonians
+
+*/
+
+#include "Objective.h"
+
+namespace bp = boost::python;
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libopt namespace
+namespace libopt{
+
+
+double Objective::compute(const MATRIX& x, MATRIX& grad){
+/**
+  The base class defines f = 0 - derive from it to define an actual function
+*/
+  nevals++;
+  grad = 0.0;
+  return 0.0;
+}
+
+double Objective::value(const MATRIX& x){
+
+  MATRIX grad(ndof, 1);
+  return compute(x, grad);
+
+}
+
+MATRIX Objective::gradient(const MATRIX& x){
+
+  MATRIX grad(ndof, 1);
+  compute(x, grad);
+  return grad;
+
+}
+
+
+
+PyObjective::PyObjective(bp::object py_funct_, bp::object params_, int ndof_){
+/**
+  \param[in] py_funct_ The Python function: [f, grad] = py_funct_(x, params_)
+  \param[in] params_ The parameters passed to the function
+  \param[in] ndof_ The number of the degrees of freedom
+*/
+
+  py_funct = py_funct_;
+  params = params_;
+  ndof = ndof_;
+
+}
+
+double PyObjective::compute(const MATRIX& x, MATRIX& grad){
+
+  nevals++;
+
+  bp::object res = py_funct(MATRIX(x), params);
+
+  double f = bp::extract<double>(res[0]);
+  MATRIX g = bp::extract<MATRIX>(res[1]);
+
+  if(g.n_elts!=ndof){
+    cout<<"Error in PyObjective::compute: the Python function returned the gradient with "<<g.n_elts
+        <<" elements, but "<<ndof<<" are expected\n"; exit(0);
+  }
+
+  for(int i=0;i<ndof;i++){ grad.M[i] = g.M[i]; }
+
+  return f;
+}
+
+
+
+double SurfaceObjective::compute(const MATRIX& x, MATRIX& grad){
+
+  nevals++;
+
+  update(x);
+  energy_gradient(state, grad);
+
+  return energy(state);
+}
+
+
+
+HamiltonianObjective::HamiltonianObjective(Hamiltonian& ham_, int state_){
+/**
+  \param[in] ham_ The Hamiltonian (e.g. Hamiltonian_Atomistic with the System and the interactions set up)
+  \param[in] state_ The index of the electronic state
+*/
+
+  ham = &ham_;
+  state = state_;
+  ndof = ham->nnucl;
+  q = vector<double>(ndof, 0.0);
+
+  if(state<0 || state>=ham->nelec){
+    cout<<"Error in HamiltonianObjective: the state index "<<state<<" is out of the range [0, "<<ham->nelec<<")\n"; exit(0);
+  }
+
+}
+
+void HamiltonianObjective::update(const MATRIX& x){
+
+  for(int i=0;i<ndof;i++){ q[i] = x.M[i]; }
+
+  ham->set_q(q);
+  ham->compute();
+
+}
+
+double HamiltonianObjective::energy(int i){
+
+  return ham->H(i, i).real();
+
+}
+
+void HamiltonianObjective::energy_gradient(int i, MATRIX& grad){
+
+  for(int n=0;n<ndof;n++){ grad.M[n] = ham->dHdq(i, i, n).real(); }
+
+}
+
+
+
+nHamiltonianObjective::nHamiltonianObjective(nHamiltonian& ham_, int model_, vector<double>& model_params_, int state_){
+/**
+  \param[in] ham_ The nHamiltonian with the diabatic and the adiabatic properties allocated
+  \param[in] model_ The index of the internal model (see nHamiltonian::compute_diabatic)
+  \param[in] model_params_ The parameters of the model
+  \param[in] state_ The index of the adiabatic state
+*/
+
+  ham = &ham_;
+  model_type = 0;
+  model = model_;
+  model_params = model_params_;
+  ann = NULL;
+  state = state_;
+  ndof = ham->nnucl;
+
+  if(state<0 || state>=ham->nadi){
+    cout<<"Error in nHamiltonianObjective: the state index "<<state<<" is out of the range [0, "<<ham->nadi<<")\n"; exit(0);
+  }
+
+}
+
+nHamiltonianObjective::nHamiltonianObjective(nHamiltonian& ham_, libann::NeuralNetwork& ann_, int state_){
+/**
+  \param[in] ham_ The nHamiltonian with the diabatic and the adiabatic properties allocated
+  \param[in] ann_ The trained ANN model of the diabatic Hamiltonian (see nHamiltonian::compute_diabatic)
+  \param[in] state_ The index of the adiabatic state
+*/
+
+  ham = &ham_;
+  model_type = 1;
+  model = -1;
+  ann = &ann_;
+  state = state_;
+  ndof = ham->nnucl;
+
+  if(state<0 || state>=ham->nadi){
+    cout<<"Error in nHamiltonianObjective: the state index "<<state<<" is out of the range [0, "<<ham->nadi<<")\n"; exit(0);
+  }
+
+}
+
+nHamiltonianObjective::nHamiltonianObjective(nHamiltonian& ham_, bp::object py_funct_, bp::object py_params_, int state_){
+/**
+  \param[in] ham_ The nHamiltonian with the diabatic and the adiabatic properties allocated
+  \param[in] py_funct_ The Python function of the diabatic Hamiltonian (see nHamiltonian::compute_diabatic)
+  \param[in] py_params_ The parameters of the function
+  \param[in] state_ The index of the adiabatic state
+*/
+
+  ham = &ham_;
+  model_type = 2;
+  model = -1;
+  ann = NULL;
+  py_funct = py_funct_;
+  py_params = py_params_;
+  state = state_;
+  ndof = ham->nnucl;
+
+  if(state<0 || state>=ham->nadi){
+    cout<<"Error in nHamiltonianObjective: the state index "<<state<<" is out of the range [0, "<<ham->nadi<<")\n"; exit(0);
+  }
+
+}
+
+void nHamiltonianObjective::update(const MATRIX& x){
+
+  if(model_type==0){
+    vector<double> q(ndof, 0.0);
+    for(int i=0;i<ndof;i++){ q[i] = x.M[i]; }
+    ham->compute_diabatic(model, q, model_params);
+  }
+  else if(model_type==1){
+    ham->compute_diabatic(*ann, x);
+  }
+  else if(model_type==2){
+    ham->compute_diabatic(py_funct, bp::object(MATRIX(x)), py_params);
+  }
+
+  ham->compute_adiabatic(1);
+
+}
+
+double nHamiltonianObjective::energy(int i){
+
+  return ham->ham_adi->get(i, i).real();
+
+}
+
+void nHamiltonianObjective::energy_gradient(int i, MATRIX& grad){
+
+  for(int n=0;n<ndof;n++){ grad.M[n] = ham->d1ham_adi[n]->get(i, i).real(); }
+
+}
+
+
+
+MECPObjective::MECPObjective(SurfaceObjective& surf_, int state_i_, int state_j_, double sigma_, double alpha_){
+/**
+  \param[in] surf_ The surfaces (Hamiltonian or nHamiltonian adapter) - referenced, not copied
+  \param[in] state_i_ The index of the lower state
+  \param[in] state_j_ The index of the upper state
+  \param[in] sigma_ The penalty strength (dimensionless), e.g. 3.5
+  \param[in] alpha_ The smoothing parameter of the penalty [Ha], e.g. 0.02
+*/
+
+  if(alpha_<=0.0){ cout<<"Error in MECPObjective: alpha must be positive\n"; exit(0); }
+
+  surf = &surf_;
+  state_i = state_i_;
+  state_j = state_j_;
+  sigma = sigma_;
+  alpha = alpha_;
+  gap = 0.0;
+  ndof = surf->ndof;
+
+}
+
+double MECPObjective::compute(const MATRIX& x, MATRIX& grad){
+
+  nevals++;
+
+  MATRIX gi(ndof, 1), gj(ndof, 1);
+
+  surf->update(x);
+  double ei = surf->energy(state_i);
+  double ej = surf->energy(state_j);
+  surf->energy_gradient(state_i, gi);
+  surf->energy_gradient(state_j, gj);
+
+  gap = ej - ei;
+  double dE = fabs(gap);
+  double sgn = (gap>=0.0) ? 1.0 : -1.0;
+
+  double pen = sigma * dE * dE / (dE + alpha);
+  double dpen = sigma * (dE*dE + 2.0*alpha*dE) / ((dE + alpha)*(dE + alpha));
+
+  for(int n=0;n<ndof;n++){
+    grad.M[n] = 0.5*(gi.M[n] + gj.M[n]) + dpen * sgn * (gj.M[n] - gi.M[n]);
+  }
+
+  return 0.5*(ei + ej) + pen;
+}
+
+
+
+}// namespace libopt
+}// liblibra
+
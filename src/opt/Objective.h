@@ -0,0 +1,181 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Objective.h
+  \brief The file describes the objective functions (value + gradient) for the native minimizers
+
+  The minimizers only see the Objective interface, so the energy and the gradient of the
+  model or atomistic Hamiltonians are evaluated without going through Python on every step.
+*/
+
+#ifndef OBJECTIVE_H
+#define OBJECTIVE_H
+
+
+// External dependencies
+#include "../math_linalg/liblinalg.h"
+#include "../hamiltonian/Hamiltonian_Generic/Hamiltonian.h"
+#include "../hamiltonian/nHamiltonian_Generic/nHamiltonian.h"
+
+namespace bp = boost::python;
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+using namespace libhamiltonian::libhamiltonian_generic;
+
+/// libopt namespace
+namespace libopt{
+
+
+class Objective{
+/**
+  The function f(x) to be minimized. The coordinates and the gradient are ndof x 1 matrices.
+*/
+
+public:
+
+  int ndof;     ///< the number of the degrees of freedom
+  int nevals;   ///< the number of calls of compute() made so far
+
+  Objective(){ ndof = 0; nevals = 0; }
+  virtual ~Objective(){ ;; }
+
+  virtual double compute(const MATRIX& x, MATRIX& grad);  ///< returns f(x) and puts df/dx into grad
+
+  double value(const MATRIX& x);      ///< f(x) only - for the Python side
+  MATRIX gradient(const MATRIX& x);   ///< df/dx only - for the Python side
+
+};
+
+
+class PyObjective : public Objective{
+/**
+  The objective defined by a Python function with the following signature:
+
+  [f, grad] = py_funct(MATRIX x, params)
+
+  where f is a float and grad is a MATRIX(ndof, 1). Only one Python call per evaluation is made.
+*/
+
+public:
+
+  bp::object py_funct;
+  bp::object params;
+
+  PyObjective(bp::object py_funct_, bp::object params_, int ndof_);
+  double compute(const MATRIX& x, MATRIX& grad);
+
+};
+
+
+class SurfaceObjective : public Objective{
+/**
+  The energy of one electronic state of a Hamiltonian, as a function of the nuclear coordinates.
+  The derived classes define how the Hamiltonian is updated and how the energies and gradients
+  of any of its states are read, so the same object also serves the crossing-point searches.
+*/
+
+public:
+
+  int state;    ///< the index of the state which is minimized
+
+  virtual void update(const MATRIX& x){ ;; }       ///< recompute the Hamiltonian at the coordinates x
+  virtual double energy(int i){ return 0.0; }       ///< energy of the state i - after update()
+  virtual void energy_gradient(int i, MATRIX& grad){ grad = 0.0; }   ///< gradient of the energy of the state i - after update()
+
+  double compute(const MATRIX& x, MATRIX& grad);
+
+};
+
+
+class HamiltonianObjective : public SurfaceObjective{
+/**
+  The surfaces of the Hamiltonian class and of its derived classes, e.g. Hamiltonian_Atomistic (then the
+  coordinates are the Cartesian coordinates of all atoms of the bound System, and the MM energies and forces
+  come from the force field) or Hamiltonian_Model. The representation set for the Hamiltonian (ham.rep)
+  is used. The Hamiltonian is referenced, not copied.
+*/
+
+public:
+
+  Hamiltonian* ham;
+  vector<double> q;
+
+  HamiltonianObjective(Hamiltonian& ham_, int state_);
+
+  void update(const MATRIX& x);
+  double energy(int i);
+  void energy_gradient(int i, MATRIX& grad);
+
+};
+
+
+class nHamiltonianObjective : public SurfaceObjective{
+/**
+  The adiabatic surfaces of the nHamiltonian class. The diabatic Hamiltonian is computed by one of the
+  internal models (model > 0), by a trained ANN or by a Python function, and then converted to the
+  adiabatic representation. The nHamiltonian (and the ANN) are referenced, not copied.
+*/
+
+public:
+
+  nHamiltonian* ham;
+
+  int model_type;               ///< 0 - internal model, 1 - ANN, 2 - Python function
+  int model;                    ///< the index of the internal model
+  vector<double> model_params;  ///< parameters of the internal model
+  libann::NeuralNetwork* ann;   ///< the ANN model
+  bp::object py_funct;          ///< the Python model
+  bp::object py_params;         ///< parameters of the Python model
+
+  nHamiltonianObjective(nHamiltonian& ham_, int model_, vector<double>& model_params_, int state_);
+  nHamiltonianObjective(nHamiltonian& ham_, libann::NeuralNetwork& ann_, int state_);
+  nHamiltonianObjective(nHamiltonian& ham_, bp::object py_funct_, bp::object py_params_, int state_);
+
+  void update(const MATRIX& x);
+  double energy(int i);
+  void energy_gradient(int i, MATRIX& grad);
+
+};
+
+
+class MECPObjective : public Objective{
+/**
+  The penalty function for the search of the minimum energy crossing point of the states i < j
+  (Levine, Coe, Martinez, J. Phys. Chem. B 2008, 112, 405):
+
+  F = (E_i + E_j)/2 + sigma * dE^2 / (dE + alpha),   dE = E_j - E_i
+
+  Near the minimum of F the gap is ~ alpha / (2 sigma - 1), so sigma is increased (mecp()) until the gap
+  is small enough.
+*/
+
+public:
+
+  SurfaceObjective* surf;
+  int state_i, state_j;
+  double sigma, alpha;
+  double gap;               ///< E_j - E_i at the last evaluated point
+
+  MECPObjective(SurfaceObjective& surf_, int state_i_, int state_j_, double sigma_, double alpha_);
+  double compute(const MATRIX& x, MATRIX& grad);
+
+};
+
+
+
+}// namespace libopt
+}// liblibra
+
+#endif // OBJECTIVE_H
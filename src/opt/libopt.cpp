@@ -15,6 +15,7 @@
 */
 
 #include "libopt.h"
+#include "../math_ann/libann.h"
 
 #include <stdlib.h>
 #include <boost/python.hpp>
@@ -46,6 +47,65 @@ void export_opt_objects(){
   def("grad_descent",expt_grad_descent_v1);
 
 
+  class_<Objective>("Objective",init<>())
+      .def_readonly("ndof",&Objective::ndof)
+      .def_readwrite("nevals",&Objective::nevals)
+      .def("value",&Objective::value)
+      .def("gradient",&Objective::gradient)
+  ;
+
+  class_<PyObjective, bases<Objective> >("PyObjective",init<bp::object, bp::object, int>())
+  ;
+
+  class_<SurfaceObjective, bases<Objective> >("SurfaceObjective",no_init)
+      .def_readwrite("state",&SurfaceObjective::state)
+  ;
+
+  class_<HamiltonianObjective, bases<SurfaceObjective> >("HamiltonianObjective",
+      init<Hamiltonian&, int>()[with_custodian_and_ward<1,2>()])
+  ;
+
+  class_<nHamiltonianObjective, bases<SurfaceObjective> >("nHamiltonianObjective",
+      init<nHamiltonian&, int, vector<double>&, int>()[with_custodian_and_ward<1,2>()])
+      .def(init<nHamiltonian&, libann::NeuralNetwork&, int>()[with_custodian_and_ward<1,2, with_custodian_and_ward<1,3> >()])
+      .def(init<nHamiltonian&, bp::object, bp::object, int>()[with_custodian_and_ward<1,2>()])
+      .def_readwrite("model_params",&nHamiltonianObjective::model_params)
+  ;
+
+  class_<MECPObjective, bases<Objective> >("MECPObjective",
+      init<SurfaceObjective&, int, int, double, double>()[with_custodian_and_ward<1,2>()])
+      .def_readwrite("sigma",&MECPObjective::sigma)
+      .def_readwrite("alpha",&MECPObjective::alpha)
+      .def_readonly("gap",&MECPObjective::gap)
+  ;
+
+
+  class_<OptResult>("OptResult",init<int>())
+      .def_readwrite("x",&OptResult::x)
+      .def_readwrite("grad",&OptResult::grad)
+      .def_readwrite("f",&OptResult::f)
+      .def_readwrite("grad_norm",&OptResult::grad_norm)
+      .def_readwrite("nsteps",&OptResult::nsteps)
+      .def_readwrite("nevals",&OptResult::nevals)
+      .def_readwrite("converged",&OptResult::converged)
+  ;
+
+
+  OptResult (*expt_lbfgs_v1)(Objective& obj, MATRIX& x0, int m, double grad_tol, int max_steps) = &lbfgs;
+  OptResult (*expt_lbfgs_v2)(Objective& obj, MATRIX& x0, double grad_tol, int max_steps) = &lbfgs;
+  def("lbfgs",expt_lbfgs_v1);
+  def("lbfgs",expt_lbfgs_v2);
+
+  OptResult (*expt_conjugate_gradient_v1)(Objective& obj, MATRIX& x0, double grad_tol, int max_steps) = &conjugate_gradient;
+  def("conjugate_gradient",expt_conjugate_gradient_v1);
+
+  OptResult (*expt_fire_v1)(Objective& obj, MATRIX& x0, double dt, double dt_max, double grad_tol, int max_steps) = &fire;
+  def("fire",expt_fire_v1);
+
+  OptResult (*expt_mecp_v1)(MECPObjective& obj, MATRIX& x0, double gap_tol, double grad_tol, int max_steps) = &mecp;
+  def("mecp",expt_mecp_v1);
+
+
 }// export_opt_objects()
 
 
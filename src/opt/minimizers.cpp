@@ -0,0 +1,488 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file minimizers.cpp
+  \brief The file implements the L-BFGS, conjugate gradient and FIRE minimizers of the native objectives
+
+*/
+
+#include "opt.h"
+
+namespace bp = boost::python;
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libopt namespace
+namespace libopt{
+
+
+static double dot(const MATRIX& a, const MATRIX& b){
+  double res = 0.0;
+  for(int i=0;i<a.n_elts;i++){ res += a.M[i]*b.M[i]; }
+  return res;
+}
+
+static double max_abs(const MATRIX& a){
+  double res = 0.0;
+  for(int i=0;i<a.n_elts;i++){ if(fabs(a.M[i])>res){ res = fabs(a.M[i]); } }
+  return res;
+}
+
+static void axpy(MATRIX& res, const MATRIX& x, double a, const MATRIX& d){
+/** res = x + a * d */
+  for(int i=0;i<res.n_elts;i++){ res.M[i] = x.M[i] + a*d.M[i]; }
+}
+
+static void copy_to(MATRIX& dst, const MATRIX& src){
+  for(int i=0;i<dst.n_elts;i++){ dst.M[i] = src.M[i]; }
+}
+
+static void check_dof(std::string fname, Objective& obj, MATRIX& x0){
+  if(x0.n_elts!=obj.ndof){
+    cout<<"Error in "<<fname<<": the number of elements of x0 ("<<x0.n_elts<<") should be equal to the number of dofs of the objective ("<<obj.ndof<<")\n";
+    exit(0);
+  }
+}
+
+
+
+double line_search(Objective& obj, const MATRIX& x, double f0, const MATRIX& g0, const MATRIX& d,
+                   double alpha_init, double c1, double c2, int max_iter,
+                   MATRIX& x_new, MATRIX& g_new, double& f_new){
+/**
+  \brief Line search for the step satisfying the strong Wolfe conditions
+
+  Nocedal & Wright, "Numerical Optimization", Algorithms 3.5 and 3.6: bracketing followed by the zoom phase
+  with the safeguarded quadratic interpolation.
+
+  \param[in] obj The objective
+  \param[in] x, f0, g0 The starting point, the function and the gradient there
+  \param[in] d The search (descent) direction
+  \param[in] alpha_init The first trial step
+  \param[in] c1, c2 The sufficient decrease and the curvature constants, 0 < c1 < c2 < 1
+  \param[in] max_iter The maximal number of the function evaluations
+  \param[out] x_new, g_new, f_new The accepted point, the gradient and the function there
+
+  Returns the accepted step length, or 0 if no decrease was found (x_new, g_new, f_new are then x, g0, f0)
+*/
+
+  double dg0 = dot(g0, d);
+
+  if(dg0>=0.0){
+    copy_to(x_new, x); copy_to(g_new, g0); f_new = f0;
+    return 0.0;
+  }
+
+  double a_prev = 0.0, f_prev = f0, dg_prev = dg0;
+  double a = alpha_init;
+  double a_lo = 0.0, a_hi = 0.0, f_lo = f0, f_hi = f0, dg_lo = dg0;
+  int zoom = 0;
+
+  int iter;
+  for(iter=0; iter<max_iter; iter++){
+
+    axpy(x_new, x, a, d);
+    f_new = obj.compute(x_new, g_new);
+    double dg = dot(g_new, d);
+
+    if(f_new > f0 + c1*a*dg0 || (iter>0 && f_new >= f_prev)){
+      a_lo = a_prev; f_lo = f_prev; dg_lo = dg_prev;
+      a_hi = a; f_hi = f_new;
+      zoom = 1; break;
+    }
+    if(fabs(dg) <= -c2*dg0){  return a;  }
+
+    if(dg >= 0.0){
+      a_lo = a; f_lo = f_new; dg_lo = dg;
+      a_hi = a_prev; f_hi = f_prev;
+      zoom = 1; break;
+    }
+
+    a_prev = a; f_prev = f_new; dg_prev = dg;
+    a *= 2.0;
+  }
+
+  if(zoom){
+
+    for(; iter<max_iter; iter++){
+
+      // Minimum of the quadratic through f_lo, dg_lo and f_hi, kept inside the bracket
+      double da = a_hi - a_lo;
+      double denom = 2.0*(f_hi - f_lo - dg_lo*da);
+      double aj = (denom!=0.0) ? a_lo - dg_lo*da*da/denom : a_lo + 0.5*da;
+
+      double lo = (da>0.0) ? a_lo + 0.1*da : a_hi - 0.1*da;
+      double hi = (da>0.0) ? a_hi - 0.1*da : a_lo + 0.1*da;
+      if(!(aj>=lo && aj<=hi)){ aj = a_lo + 0.5*da; }
+
+      axpy(x_new, x, aj, d);
+      f_new = obj.compute(x_new, g_new);
+      double dg = dot(g_new, d);
+
+      if(f_new > f0 + c1*aj*dg0 || f_new >= f_lo){
+        a_hi = aj; f_hi = f_new;
+      }
+      else{
+        if(fabs(dg) <= -c2*dg0){  return aj;  }
+        if(dg*(a_hi - a_lo) >= 0.0){  a_hi = a_lo; f_hi = f_lo;  }
+        a_lo = aj; f_lo = f_new; dg_lo = dg;
+      }
+
+      if(fabs(a_hi - a_lo) < 1e-14*fabs(a_lo)){ break; }
+    }
+
+    // No strong Wolfe point - accept the best point with the sufficient decrease
+    if(a_lo>0.0){
+      axpy(x_new, x, a_lo, d);
+      f_new = obj.compute(x_new, g_new);
+      return a_lo;
+    }
+
+  }
+  else if(f_new < f0){  return a;  }
+
+  copy_to(x_new, x); copy_to(g_new, g0); f_new = f0;
+  return 0.0;
+
+}
+
+
+
+
+OptResult lbfgs(Objective& obj, MATRIX& x0, int m, double grad_tol, int max_steps){
+/**
+  \brief Limited-memory BFGS minimization with the strong Wolfe line search
+
+  Nocedal & Wright, "Numerical Optimization", Algorithm 7.4 (two-loop recursion)
+
+  \param[in] obj The objective
+  \param[in] x0 The starting point: ndof x 1 matrix
+  \param[in] m The number of the stored correction pairs (5 - 20 is typical)
+  \param[in] grad_tol Convergence criterion: the maximal absolute component of the gradient
+  \param[in] max_steps The maximal number of the iterations
+
+  Returns the final point, the function and the gradient there and the statistics.
+*/
+
+  check_dof("lbfgs", obj, x0);
+
+  int n = obj.ndof;
+  int k, i;
+  int nevals0 = obj.nevals;
+
+  OptResult res(n);
+  MATRIX x(n,1), g(n,1), x_new(n,1), g_new(n,1), d(n,1);
+
+  copy_to(x, x0);
+  double f = obj.compute(x, g);
+  double f_new = f;
+
+  vector<MATRIX> S, Y;
+  vector<double> rho;
+  vector<double> a(m, 0.0);
+
+  int iter = 0;
+  int converged = (max_abs(g) < grad_tol);
+
+  while(!converged && iter<max_steps){
+
+    // Two-loop recursion: d = -H * g
+    copy_to(d, g);
+    int sz = S.size();
+
+    for(k=sz-1; k>=0; k--){
+      a[k] = rho[k] * dot(S[k], d);
+      for(i=0;i<n;i++){ d.M[i] -= a[k] * Y[k].M[i]; }
+    }
+
+    double gamma = 1.0;
+    if(sz>0){ gamma = dot(S[sz-1], Y[sz-1]) / dot(Y[sz-1], Y[sz-1]); }
+    d *= gamma;
+
+    for(k=0; k<sz; k++){
+      double b = rho[k] * dot(Y[k], d);
+      for(i=0;i<n;i++){ d.M[i] += (a[k] - b) * S[k].M[i]; }
+    }
+
+    d *= -1.0;
+
+    // The first step is scaled to move the largest component by ~0.1
+    double alpha0 = 1.0;
+    if(sz==0){ double gm = max_abs(g); if(gm>0.0){ alpha0 = 0.1/gm; } if(alpha0>1.0){ alpha0 = 1.0; } }
+
+    double step = line_search(obj, x, f, g, d, alpha0, 1e-4, 0.9, 40, x_new, g_new, f_new);
+
+    if(step==0.0){
+      if(sz==0){ break; }   // even the steepest descent direction does not give any decrease
+      S.clear(); Y.clear(); rho.clear();   // restart from the steepest descent direction
+      continue;
+    }
+
+    MATRIX s(n,1), y(n,1);
+    for(i=0;i<n;i++){ s.M[i] = x_new.M[i] - x.M[i];  y.M[i] = g_new.M[i] - g.M[i]; }
+
+    double sy = dot(s, y);
+    if(sy > 1e-12*sqrt(dot(s,s)*dot(y,y))){
+      if(S.size()==m){ S.erase(S.begin()); Y.erase(Y.begin()); rho.erase(rho.begin()); }
+      S.push_back(s); Y.push_back(y); rho.push_back(1.0/sy);
+    }
+
+    copy_to(x, x_new); copy_to(g, g_new); f = f_new;
+    iter++;
+
+    converged = (max_abs(g) < grad_tol);
+  }
+
+  copy_to(res.x, x);  copy_to(res.grad, g);
+  res.f = f;
+  res.grad_norm = max_abs(g);
+  res.nsteps = iter;
+  res.nevals = obj.nevals - nevals0;
+  res.converged = converged;
+
+  return res;
+}
+
+OptResult lbfgs(Objective& obj, MATRIX& x0, double grad_tol, int max_steps){
+
+  return lbfgs(obj, x0, 10, grad_tol, max_steps);
+
+}
+
+
+
+
+OptResult conjugate_gradient(Objective& obj, MATRIX& x0, double grad_tol, int max_steps){
+/**
+  \brief Nonlinear conjugate gradient (Polak-Ribiere+) minimization with the strong Wolfe line search
+
+  The direction is reset to the steepest descent when beta < 0 or when the direction is not a descent one.
+
+  \param[in] obj The objective
+  \param[in] x0 The starting point: ndof x 1 matrix
+  \param[in] grad_tol Convergence criterion: the maximal absolute component of the gradient
+  \param[in] max_steps The maximal number of the iterations
+*/
+
+  check_dof("conjugate_gradient", obj, x0);
+
+  int n = obj.ndof;
+  int i;
+  int nevals0 = obj.nevals;
+
+  OptResult res(n);
+  MATRIX x(n,1), g(n,1), x_new(n,1), g_new(n,1), d(n,1);
+
+  copy_to(x, x0);
+  double f = obj.compute(x, g);
+  double f_new = f;
+  double step = 0.0;
+
+  for(i=0;i<n;i++){ d.M[i] = -g.M[i]; }
+
+  int iter = 0;
+  int restart = 1;  // the first step and the steepest-descent retries start from the scaled-gradient step
+  int converged = (max_abs(g) < grad_tol);
+
+  while(!converged && iter<max_steps){
+
+    double dg = dot(d, g);
+    if(dg>=0.0){  for(i=0;i<n;i++){ d.M[i] = -g.M[i]; }  dg = -dot(g,g);  }
+
+    // The step of the previous iteration rescaled by the change of the slope (N&W, eq. 3.60)
+    double alpha0;
+    if(restart){ double gm = max_abs(g); alpha0 = (gm>0.0) ? 0.1/gm : 1.0; if(alpha0>1.0){ alpha0 = 1.0; } }
+    else{ alpha0 = step; }
+
+    double prev_dg = dg;
+    step = line_search(obj, x, f, g, d, alpha0, 1e-4, 0.1, 40, x_new, g_new, f_new);
+
+    if(step==0.0){
+      // Retry along the steepest descent before giving up
+      double sd = 0.0; for(i=0;i<n;i++){ sd += (d.M[i] + g.M[i])*(d.M[i] + g.M[i]); }
+      if(sd==0.0){ break; }
+      for(i=0;i<n;i++){ d.M[i] = -g.M[i]; }
+      restart = 1;
+      iter++;
+      continue;
+    }
+    restart = 0;
+
+    double gg = dot(g, g);
+    double beta = 0.0;
+    for(i=0;i<n;i++){ beta += g_new.M[i]*(g_new.M[i] - g.M[i]); }
+    beta = (gg>0.0) ? beta/gg : 0.0;
+    if(beta<0.0){ beta = 0.0; }
+
+    for(i=0;i<n;i++){ d.M[i] = -g_new.M[i] + beta*d.M[i]; }
+
+    double new_dg = dot(d, g_new);
+    step = (new_dg<0.0) ? step * prev_dg / new_dg : 1.0;
+    if(step>1.0){ step = 1.0; }
+
+    copy_to(x, x_new); copy_to(g, g_new); f = f_new;
+    iter++;
+
+    converged = (max_abs(g) < grad_tol);
+  }
+
+  copy_to(res.x, x);  copy_to(res.grad, g);
+  res.f = f;
+  res.grad_norm = max_abs(g);
+  res.nsteps = iter;
+  res.nevals = obj.nevals - nevals0;
+  res.converged = converged;
+
+  return res;
+}
+
+
+
+
+OptResult fire(Objective& obj, MATRIX& x0, double dt, double dt_max, double grad_tol, int max_steps){
+/**
+  \brief The Fast Inertial Relaxation Engine
+
+  Bitzek, Koskinen, Gahler, Moseler, Gumbsch, Phys. Rev. Lett. 2006, 97, 170201
+  Unit masses, velocity Verlet (Euler semi-implicit) steps with the standard parameters:
+  N_min = 5, f_inc = 1.1, f_dec = 0.5, alpha_start = 0.1, f_alpha = 0.99.
+  The displacement per step is limited to 0.2 (in the units of x).
+
+  \param[in] obj The objective
+  \param[in] x0 The starting point: ndof x 1 matrix
+  \param[in] dt The initial time step
+  \param[in] dt_max The maximal time step
+  \param[in] grad_tol Convergence criterion: the maximal absolute component of the gradient
+  \param[in] max_steps The maximal number of the iterations
+*/
+
+  check_dof("fire", obj, x0);
+
+  const int N_min = 5;
+  const double f_inc = 1.1;
+  const double f_dec = 0.5;
+  const double alpha_start = 0.1;
+  const double f_alpha = 0.99;
+  const double max_disp = 0.2;
+
+  int n = obj.ndof;
+  int i;
+  int nevals0 = obj.nevals;
+
+  OptResult res(n);
+  MATRIX x(n,1), g(n,1), v(n,1);
+
+  copy_to(x, x0);
+  v = 0.0;
+  double f = obj.compute(x, g);
+
+  double alpha = alpha_start;
+  int n_pos = 0;
+  int iter = 0;
+  int converged = (max_abs(g) < grad_tol);
+
+  while(!converged && iter<max_steps){
+
+    // Power P = F * v, with F = -g
+    double P = -dot(g, v);
+
+    if(P>0.0){
+      double vn = sqrt(dot(v,v));
+      double gn = sqrt(dot(g,g));
+      if(gn>0.0){  for(i=0;i<n;i++){ v.M[i] = (1.0-alpha)*v.M[i] - alpha*vn*g.M[i]/gn; }  }
+
+      n_pos++;
+      if(n_pos>N_min){
+        dt *= f_inc;  if(dt>dt_max){ dt = dt_max; }
+        alpha *= f_alpha;
+      }
+    }
+    else{
+      n_pos = 0;
+      dt *= f_dec;
+      alpha = alpha_start;
+      v = 0.0;
+    }
+
+    // MD step
+    for(i=0;i<n;i++){ v.M[i] -= dt * g.M[i]; }
+
+    double disp = dt * max_abs(v);
+    double scl = (disp>max_disp) ? max_disp/disp : 1.0;
+    for(i=0;i<n;i++){ x.M[i] += scl * dt * v.M[i]; }
+
+    f = obj.compute(x, g);
+    iter++;
+
+    converged = (max_abs(g) < grad_tol);
+  }
+
+  copy_to(res.x, x);  copy_to(res.grad, g);
+  res.f = f;
+  res.grad_norm = max_abs(g);
+  res.nsteps = iter;
+  res.nevals = obj.nevals - nevals0;
+  res.converged = converged;
+
+  return res;
+}
+
+
+
+
+OptResult mecp(MECPObjective& obj, MATRIX& x0, double gap_tol, double grad_tol, int max_steps){
+/**
+  \brief Minimum energy crossing point search by a sequence of the penalty function minimizations
+
+  Each minimization (L-BFGS) starts from the result of the previous one; after each of them the penalty strength
+  obj.sigma is doubled, until |E_j - E_i| < gap_tol (at most 10 times).
+
+  \param[in] obj The penalty objective - its sigma is modified
+  \param[in] x0 The starting point: ndof x 1 matrix
+  \param[in] gap_tol The tolerance of the energy gap [Ha]
+  \param[in] grad_tol Convergence criterion of each minimization
+  \param[in] max_steps The maximal number of the iterations of each minimization
+*/
+
+  check_dof("mecp", obj, x0);
+
+  int nevals0 = obj.nevals;
+  int nsteps = 0;
+
+  OptResult res = lbfgs(obj, x0, grad_tol, max_steps);
+  nsteps += res.nsteps;
+  obj.value(res.x);   // the gap at the final point, not at the last trial point
+
+  for(int cycle=0; cycle<10 && fabs(obj.gap)>=gap_tol; cycle++){
+    obj.sigma *= 2.0;
+    OptResult res1 = lbfgs(obj, res.x, grad_tol, max_steps);
+    copy_to(res.x, res1.x);  copy_to(res.grad, res1.grad);
+    res.f = res1.f;  res.grad_norm = res1.grad_norm;  res.converged = res1.converged;
+    nsteps += res1.nsteps;
+    obj.value(res.x);
+  }
+
+  res.nsteps = nsteps;
+  res.nevals = obj.nevals - nevals0;
+  res.converged = res.converged && (fabs(obj.gap)<gap_tol);
+
+  return res;
+}
+
+
+
+}// namespace libopt
+}// liblibra
+
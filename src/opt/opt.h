@@ -21,6 +21,7 @@
 // External dependencies
 #include "../math_linalg/liblinalg.h"
 #include "../io/libio.h"
+#include "Objective.h"
 
 namespace bp = boost::python;
 
@@ -38,6 +39,38 @@ namespace libopt{
 MATRIX grad_descent(bp::object grad_function, MATRIX& dof, bp::object funct_params, double grad_tol, double step_size, int max_steps);
 
 
+class OptResult{
+/**
+  The outcome of a minimization
+*/
+
+public:
+
+  MATRIX x;           ///< the final point
+  MATRIX grad;        ///< the gradient at the final point
+  double f;           ///< the function at the final point
+  double grad_norm;   ///< the maximal absolute component of the gradient
+  int nsteps;         ///< the number of the iterations made
+  int nevals;         ///< the number of the function + gradient evaluations made
+  int converged;      ///< 1 - if the convergence criterion is satisfied
+
+  OptResult(int ndof) : x(ndof,1), grad(ndof,1){ f = 0.0; grad_norm = 0.0; nsteps = 0; nevals = 0; converged = 0; }
+
+};
+
+
+///< In minimizers.cpp
+double line_search(Objective& obj, const MATRIX& x, double f0, const MATRIX& g0, const MATRIX& d,
+                   double alpha_init, double c1, double c2, int max_iter,
+                   MATRIX& x_new, MATRIX& g_new, double& f_new);
+
+OptResult lbfgs(Objective& obj, MATRIX& x0, int m, double grad_tol, int max_steps);
+OptResult lbfgs(Objective& obj, MATRIX& x0, double grad_tol, int max_steps);
+OptResult conjugate_gradient(Objective& obj, MATRIX& x0, double grad_tol, int max_steps);
+OptResult fire(Objective& obj, MATRIX& x0, double dt, double dt_max, double grad_tol, int max_steps);
+OptResult mecp(MECPObjective& obj, MATRIX& x0, double gap_tol, double grad_tol, int max_steps);
+
+
 }// namespace libopt
 }// liblibra
 
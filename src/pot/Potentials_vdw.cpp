@@ -83,8 +83,9 @@ double Vdw_Buffered14_7(VECTOR& ri,VECTOR& rj,          /*Inputs*/
   energy = epsilon * AB_term;
 
   fi = mod*rij.unit();
-  fj = -fj;
+  fj = -fi;
 
+  return energy;
 }
 
 double Vdw_Morse(VECTOR& ri,VECTOR& rj,            /*Inputs*/
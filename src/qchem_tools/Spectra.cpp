@@ -0,0 +1,481 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Spectra.cpp
+  \brief This file implements the projected densities of states and the absorption spectra accumulated
+  over many snapshots
+*/
+
+#include <map>
+#include <sstream>
+#include "Spectra.h"
+#include "../math_meigen/libmeigen.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libmeigen;
+
+/// libqchem_tools namespace
+namespace libqchem_tools{
+
+
+
+vector<int> pdos_channels(vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode,
+                          vector<std::string>& labels){
+/**
+  \brief Assigns every AO to a projection channel
+
+  \param[in] basis_ao AO basis for the entire system
+  \param[in] atom_to_ao_map The mapping between global atomic and AO indices, so atom_to_ao_map[a][i] is the global index
+  of i-th orbital of the atom with index a
+  \param[in] mode The type of the channels: 0 - atoms, 1 - elements, 2 - angular momenta (s, p, d, ...),
+  3 - atoms and angular momenta, 4 - elements and angular momenta
+  \param[out] labels The names of the channels, e.g. "5", "C", "p", "5_p", "C_p"
+
+  Returns: the channel index of every AO (-1 for the AOs that are not in atom_to_ao_map).
+  The channels are numbered in the order of their first appearance.
+*/
+
+  if(mode<0 || mode>4){
+    cout<<"Error in pdos_channels: mode = "<<mode<<" is not known. Use 0 - atoms, 1 - elements, 2 - angular momenta,"
+        <<" 3 - atoms and angular momenta, 4 - elements and angular momenta\n"; exit(0);
+  }
+
+  const std::string l_names = "spdfghi";
+
+  vector<int> ao_channel(basis_ao.size(), -1);
+  map<std::string, int> index;
+  labels.clear();
+
+  for(int a=0; a<atom_to_ao_map.size(); a++){
+    for(int n=0; n<atom_to_ao_map[a].size(); n++){
+
+      int I = atom_to_ao_map[a][n];
+      if(I<0 || I>=basis_ao.size()){
+        cout<<"Error in pdos_channels: the AO index "<<I<<" of the atom "<<a<<" is out of range\n"; exit(0);
+      }
+
+      std::string l = basis_ao[I].ao_shell_type;
+      if(l.size()==0){
+        int L = basis_ao[I].x_exp + basis_ao[I].y_exp + basis_ao[I].z_exp;
+        l = (L<l_names.size()) ? l_names.substr(L,1) : "L";
+      }
+
+      stringstream ss(stringstream::in | stringstream::out);
+      if(mode==0){ ss<<a; }
+      else if(mode==1){ ss<<basis_ao[I].element; }
+      else if(mode==2){ ss<<l; }
+      else if(mode==3){ ss<<a<<"_"<<l; }
+      else if(mode==4){ ss<<basis_ao[I].element<<"_"<<l; }
+
+      std::string key = ss.str();
+      if(index.find(key)==index.end()){  index[key] = labels.size(); labels.push_back(key); }
+
+      ao_channel[I] = index[key];
+
+    }// for n
+  }// for a
+
+  return ao_channel;
+
+}
+
+vector<int> pdos_channels(vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode){
+/**
+  \brief Same as pdos_channels(basis_ao, atom_to_ao_map, mode, labels), without the channel names
+*/
+
+  vector<std::string> labels;
+  return pdos_channels(basis_ao, atom_to_ao_map, mode, labels);
+
+}
+
+
+
+MATRIX pdos_weights(MATRIX& C, MATRIX& S, vector<int>& ao_channel, int nchannels, int projection){
+/**
+  \brief Computes the weights of all the orbitals in the projection channels
+
+  \param[in] C The MO-LCAO coefficients: Nao x Norb
+  \param[in] S The AO overlap matrix: Nao x Nao
+  \param[in] ao_channel The channel of every AO (-1 - not projected), see pdos_channels(...)
+  \param[in] nchannels The number of the channels
+  \param[in] projection 0 - Mulliken: w_ik = C_ik * (S*C)_ik;  1 - Lowdin: w_ik = ((S^1/2)*C)_ik^2
+
+  The products with the (symmetric) S or S^1/2 are done in the blocks of orbitals, in parallel,
+  without forming the full Nao x Norb intermediate.
+
+  Returns: the Norb x nchannels matrix W, W(k,ch) = sum_{i in ch} w_ik
+*/
+
+  const int blk = 32;
+
+  int nao = C.n_rows;
+  int norb = C.n_cols;
+
+  if(S.n_rows!=nao || S.n_cols!=nao){
+    cout<<"Error in pdos_weights: the sizes of the overlap ("<<S.n_rows<<" x "<<S.n_cols<<") and of the MO-LCAO ("
+        <<nao<<" x "<<norb<<") matrices do not match\n"; exit(0);
+  }
+  if(ao_channel.size()!=nao){
+    cout<<"Error in pdos_weights: the size of ao_channel ("<<ao_channel.size()<<") is not equal to the number of AOs ("<<nao<<")\n"; exit(0);
+  }
+  if(projection<0 || projection>1){
+    cout<<"Error in pdos_weights: projection = "<<projection<<" is not known. Use 0 - Mulliken, 1 - Lowdin\n"; exit(0);
+  }
+
+
+  // The matrix applied to C: S (Mulliken) or S^1/2 (Lowdin)
+  MATRIX X(S);
+
+  if(projection==1){
+    MATRIX e(nao, nao);
+    MATRIX U(nao, nao);
+    solve_eigen(S, e, U, 0);
+
+    for(int i=0; i<nao; i++){
+      for(int j=0; j<nao; j++){
+        double x = 0.0;
+        for(int k=0; k<nao; k++){
+          double ek = e.M[k*nao+k];
+          if(ek>0.0){ x += U.M[i*nao+k] * sqrt(ek) * U.M[j*nao+k]; }
+        }
+        X.M[i*nao+j] = x;
+      }
+    }
+  }
+
+
+  MATRIX W(norb, nchannels);
+  int nblk = (norb + blk - 1)/blk;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int b=0; b<nblk; b++){
+
+    int k0 = b*blk;
+    int nb = std::min(blk, norb - k0);
+    vector<double> xc(nao*nb, 0.0);
+
+    for(int i=0; i<nao; i++){
+      if(ao_channel[i]<0){ continue; }
+      double* xci = &xc[i*nb];
+      for(int j=0; j<nao; j++){
+        double x = X.M[i*nao+j];
+        if(x==0.0){ continue; }
+        const double* cj = &C.M[j*norb+k0];
+        for(int k=0; k<nb; k++){ xci[k] += x*cj[k]; }
+      }
+    }
+
+    for(int i=0; i<nao; i++){
+      int ch = ao_channel[i];
+      if(ch<0){ continue; }
+      if(ch>=nchannels){
+        cout<<"Error in pdos_weights: the channel "<<ch<<" of the AO "<<i<<" is out of range\n"; exit(0);
+      }
+      const double* ci = &C.M[i*norb+k0];
+      const double* xci = &xc[i*nb];
+      for(int k=0; k<nb; k++){
+        W.M[(k0+k)*nchannels+ch] += (projection==0) ? ci[k]*xci[k] : xci[k]*xci[k];
+      }
+    }
+
+  }// for b
+
+  return W;
+
+}
+
+
+vector<double> oscillator_strengths(vector<double>& dE, vector<VECTOR>& mu){
+/**
+  \brief The oscillator strengths of the transitions: f = (2/3) * dE * |mu|^2  (atomic units)
+
+  \param[in] dE The transition energies
+  \param[in] mu The transition dipole moments
+*/
+
+  if(dE.size()!=mu.size()){
+    cout<<"Error in oscillator_strengths: the numbers of the energies ("<<dE.size()<<") and of the dipoles ("
+        <<mu.size()<<") are not equal\n"; exit(0);
+  }
+
+  vector<double> f(dE.size(), 0.0);
+  for(int i=0; i<dE.size(); i++){  f[i] = (2.0/3.0) * dE[i] * mu[i].length2();  }
+
+  return f;
+
+}
+
+
+
+MATRIX broaden_spectrum(MATRIX& hist, double de, double width, int lineshape){
+/**
+  \brief Convolves the binned lines with the normalized line shape
+
+  \param[in] hist The binned line weights: npts x nchannels, on the grid with the spacing de
+  \param[in] de The grid spacing
+  \param[in] width The broadening: the standard deviation of the Gaussian or the half-width of the Lorentzian
+  \param[in] lineshape 0 - Gaussian, 1 - Lorentzian
+
+  The convolution is done by FFT (cfft1/inv_cfft1) on the zero-padded grid, two channels at a time (as
+  the real and the imaginary parts of one complex signal). The Gaussian is cut at 6*width, the Lorentzian - at the
+  extent of the grid.
+
+  Returns: the npts x nchannels matrix of the broadened spectra (the weights per unit energy)
+*/
+
+  int npts = hist.n_rows;
+  int nch = hist.n_cols;
+
+  if(width<=0.0 || de<=0.0){
+    cout<<"Error in broaden_spectrum: the width ("<<width<<") and the grid spacing ("<<de<<") must be positive\n"; exit(0);
+  }
+  if(lineshape<0 || lineshape>1){
+    cout<<"Error in broaden_spectrum: lineshape = "<<lineshape<<" is not known. Use 0 - Gaussian, 1 - Lorentzian\n"; exit(0);
+  }
+
+  int K = (lineshape==0) ? (int)ceil(6.0*width/de) : npts;
+  if(K>npts){ K = npts; }
+
+  int L = 1;
+  while(L < npts + K + 1){ L <<= 1; }
+
+
+  // The line shape on the periodic padded grid
+  CMATRIX kern(L, 1);
+  double nrm = 0.0;
+
+  for(int d=-K; d<=K; d++){
+    double x = d*de;
+    double g;
+    if(lineshape==0){ g = exp(-0.5*x*x/(width*width)) / (sqrt(2.0*M_PI)*width); }
+    else{ g = (width/M_PI) / (x*x + width*width); }
+
+    kern.M[(d+L)%L] = g*de;
+    nrm += g*de;
+  }
+
+  // The truncated Gaussian is renormalized, so the weights are preserved exactly
+  if(lineshape==0){ for(int m=0; m<L; m++){ kern.M[m] /= nrm; } }
+
+  // With the unit spacing and the grids starting at 0, cfft1 is the discrete transform 
+  // sum_n a_n exp(-2*pi*i*n*k/L), and inv_cfft1 is its inverse (including the 1/L factor)
+  CMATRIX kern_k(L, 1);
+  cfft1(kern, kern_k, 0.0, 0.0, 1.0);
+
+
+  MATRIX res(npts, nch);
+  CMATRIX a(L, 1);
+  CMATRIX a_k(L, 1);
+
+  for(int c=0; c<nch; c+=2){
+
+    a = complex<double>(0.0, 0.0);
+    for(int i=0; i<npts; i++){
+      a.M[i] = complex<double>(hist.M[i*nch+c], (c+1<nch) ? hist.M[i*nch+c+1] : 0.0);
+    }
+
+    cfft1(a, a_k, 0.0, 0.0, 1.0);
+    for(int m=0; m<L; m++){ a_k.M[m] *= kern_k.M[m]; }
+    inv_cfft1(a_k, a, 0.0, 0.0, 1.0);
+
+    for(int i=0; i<npts; i++){
+      res.M[i*nch+c] = a.M[i].real()/de;
+      if(c+1<nch){ res.M[i*nch+c+1] = a.M[i].imag()/de; }
+    }
+
+  }// for c
+
+  return res;
+
+}
+
+
+
+
+Spectrum_Accumulator::Spectrum_Accumulator(double emin_, double emax_, double de_, int nchannels_)
+: hist(std::max(1, (de_>0.0 ? (int)floor((emax_-emin_)/de_ + 1e-8) + 1 : 1)), std::max(1, nchannels_)){
+/**
+  \brief Constructor
+
+  \param[in] emin_ The lowest energy of the grid
+  \param[in] emax_ The highest energy of the grid
+  \param[in] de_ The grid spacing
+  \param[in] nchannels_ The number of the channels
+*/
+
+  if(de_<=0.0 || emax_<=emin_ || nchannels_<1){
+    cout<<"Error in Spectrum_Accumulator: the grid ["<<emin_<<", "<<emax_<<"] with the spacing "<<de_
+        <<" and "<<nchannels_<<" channels is not valid\n"; exit(0);
+  }
+
+  emin = emin_;
+  de = de_;
+  npts = hist.n_rows;
+  nchannels = nchannels_;
+  nframes = 0;
+
+}
+
+void Spectrum_Accumulator::reset(){
+/**
+  \brief Removes all the accumulated data
+*/
+
+  hist *= 0.0;
+  nframes = 0;
+
+}
+
+void Spectrum_Accumulator::add_lines(vector<double>& E, MATRIX& W){
+/**
+  \brief Adds one snapshot of the lines
+
+  \param[in] E The energies of the lines
+  \param[in] W The weights of the lines: E.size() x nchannels
+
+  The lines outside of the grid are ignored
+*/
+
+  if(W.n_rows!=E.size() || W.n_cols!=nchannels){
+    cout<<"Error in Spectrum_Accumulator::add_lines: the weights must be a "<<E.size()<<" x "<<nchannels<<" matrix\n"; exit(0);
+  }
+
+  for(int k=0; k<E.size(); k++){
+
+    double x = (E[k] - emin)/de;
+    int i = (int)floor(x);
+    double f = x - i;
+
+    if(i<0 || i>=npts){ continue; }
+    if(i==npts-1){ if(f>1e-8){ continue; } f = 0.0; }
+
+    for(int c=0; c<nchannels; c++){
+      double w = W.M[k*nchannels+c];
+      hist.M[i*nchannels+c] += (1.0-f)*w;
+      if(f>0.0){ hist.M[(i+1)*nchannels+c] += f*w; }
+    }
+  }
+
+  nframes++;
+
+}
+
+void Spectrum_Accumulator::add_lines(vector<double>& E, vector<double>& w){
+/**
+  \brief Adds one snapshot of the lines, for the single-channel accumulator
+
+  \param[in] E The energies of the lines
+  \param[in] w The weights of the lines
+*/
+
+  if(nchannels!=1 || w.size()!=E.size()){
+    cout<<"Error in Spectrum_Accumulator::add_lines: one weight per line and one channel are expected\n"; exit(0);
+  }
+
+  MATRIX W(E.size(), 1);
+  for(int k=0; k<E.size(); k++){ W.M[k] = w[k]; }
+
+  add_lines(E, W);
+
+}
+
+void Spectrum_Accumulator::add_orbitals(MATRIX& E, MATRIX& C, MATRIX& S, vector<int>& ao_channel, int projection){
+/**
+  \brief Adds one snapshot of the projected DOS
+
+  \param[in] E The orbital energies: Norb x Norb (diagonal) or Norb x 1 matrix
+  \param[in] C The MO-LCAO coefficients: Nao x Norb
+  \param[in] S The AO overlap matrix
+  \param[in] ao_channel The channel of every AO, see pdos_channels(...)
+  \param[in] projection 0 - Mulliken, 1 - Lowdin
+*/
+
+  int norb = C.n_cols;
+  vector<double> e(norb, 0.0);
+
+  if(E.n_rows==norb && E.n_cols==norb){ for(int k=0; k<norb; k++){ e[k] = E.M[k*norb+k]; } }
+  else if(E.n_elts==norb){ for(int k=0; k<norb; k++){ e[k] = E.M[k]; } }
+  else{
+    cout<<"Error in Spectrum_Accumulator::add_orbitals: the orbital energies do not match "<<norb<<" orbitals\n"; exit(0);
+  }
+
+  MATRIX W(pdos_weights(C, S, ao_channel, nchannels, projection));
+
+  add_lines(e, W);
+
+}
+
+void Spectrum_Accumulator::add_orbitals(Electronic_Structure& el, vector<int>& ao_channel, int projection){
+/**
+  \brief Adds one snapshot of the projected DOS of both spin channels of the electronic structure
+
+  \param[in] el The electronic structure: E_alp, E_bet, C_alp, C_bet, Sao are used
+  \param[in] ao_channel The channel of every AO, see pdos_channels(...)
+  \param[in] projection 0 - Mulliken, 1 - Lowdin
+*/
+
+  add_orbitals(*el.E_alp, *el.C_alp, *el.Sao, ao_channel, projection);
+  add_orbitals(*el.E_bet, *el.C_bet, *el.Sao, ao_channel, projection);
+
+  nframes--;  // both spin channels make one snapshot
+
+}
+
+void Spectrum_Accumulator::add_transitions(vector<double>& dE, vector<VECTOR>& mu){
+/**
+  \brief Adds one snapshot of the absorption lines: the oscillator strengths at the transition energies.
+  The accumulator must have one channel.
+
+  \param[in] dE The transition energies
+  \param[in] mu The transition dipole moments
+*/
+
+  vector<double> f(oscillator_strengths(dE, mu));
+
+  add_lines(dE, f);
+
+}
+
+MATRIX Spectrum_Accumulator::energy_grid(){
+/**
+  \brief Returns the npts x 1 matrix of the grid energies
+*/
+
+  MATRIX e(npts, 1);
+  for(int i=0; i<npts; i++){ e.M[i] = emin + i*de; }
+
+  return e;
+
+}
+
+MATRIX Spectrum_Accumulator::spectrum(double width, int lineshape){
+/**
+  \brief Returns the broadened spectrum averaged over the snapshots: npts x nchannels
+
+  \param[in] width The broadening: the standard deviation of the Gaussian or the half-width of the Lorentzian
+  \param[in] lineshape 0 - Gaussian, 1 - Lorentzian
+*/
+
+  MATRIX res(broaden_spectrum(hist, de, width, lineshape));
+  if(nframes>0){ res /= double(nframes); }
+
+  return res;
+
+}
+
+
+
+}// namespace libqchem_tools
+}// liblibra
+
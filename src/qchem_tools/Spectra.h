@@ -0,0 +1,85 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Spectra.h
+  \brief This file describes the accumulation of the projected densities of states and of the absorption
+  spectra over many snapshots, with the broadening done by the FFT convolution of the binned lines
+*/
+
+#ifndef SPECTRA_H
+#define SPECTRA_H
+
+#include "../qobjects/libqobjects.h"
+#include "../hamiltonian/Hamiltonian_Atomistic/Hamiltonian_QM/Electronic_Structure.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libqobjects;
+using namespace libhamiltonian::libhamiltonian_atomistic::libhamiltonian_qm;
+
+
+/// libqchem_tools namespace
+namespace libqchem_tools{
+
+
+vector<int> pdos_channels(vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode,
+                          vector<std::string>& labels);
+vector<int> pdos_channels(vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode);
+
+MATRIX pdos_weights(MATRIX& C, MATRIX& S, vector<int>& ao_channel, int nchannels, int projection);
+
+vector<double> oscillator_strengths(vector<double>& dE, vector<VECTOR>& mu);
+
+MATRIX broaden_spectrum(MATRIX& hist, double de, double width, int lineshape);
+
+
+class Spectrum_Accumulator{
+/**
+  \brief Accumulates the weighted lines (energy, weights in several channels) of many snapshots
+  on the uniform energy grid emin + i*de, i = 0, ... npts-1
+
+  Every line is shared between the two nearest grid points (linear binning), so the sum of the weights and
+  their average energy are kept exactly. The broadened spectrum is the FFT convolution of the binned lines
+  with the normalized line shape, averaged over the snapshots.
+*/
+
+public:
+
+  double emin;                  ///< the lowest grid energy
+  double de;                    ///< the grid spacing
+  int npts;                     ///< the number of the grid points
+  int nchannels;                ///< the number of the channels (columns of the spectrum)
+  int nframes;                  ///< the number of the snapshots accumulated
+  MATRIX hist;                  ///< npts x nchannels: the binned line weights summed over the snapshots
+
+  Spectrum_Accumulator(double emin_, double emax_, double de_, int nchannels_);
+
+  void reset();
+
+  void add_lines(vector<double>& E, MATRIX& W);
+  void add_lines(vector<double>& E, vector<double>& w);
+
+  void add_orbitals(MATRIX& E, MATRIX& C, MATRIX& S, vector<int>& ao_channel, int projection);
+  void add_orbitals(Electronic_Structure& el, vector<int>& ao_channel, int projection);
+
+  void add_transitions(vector<double>& dE, vector<VECTOR>& mu);
+
+  MATRIX energy_grid();
+  MATRIX spectrum(double width, int lineshape);
+
+};
+
+
+}// namespace libqchem_tools
+}// liblibra
+
+#endif // SPECTRA_H
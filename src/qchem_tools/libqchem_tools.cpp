@@ -70,6 +70,52 @@ void export_qchem_tools_objects(){
 
 
 
+  vector<int> (*expt_pdos_channels_v1)
+  (vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode, vector<std::string>& labels) = &pdos_channels;
+  vector<int> (*expt_pdos_channels_v2)
+  (vector<AO>& basis_ao, vector< vector<int> >& atom_to_ao_map, int mode) = &pdos_channels;
+
+  def("pdos_channels", expt_pdos_channels_v1);
+  def("pdos_channels", expt_pdos_channels_v2);
+
+  MATRIX (*expt_pdos_weights_v1)(MATRIX& C, MATRIX& S, vector<int>& ao_channel, int nchannels, int projection) = &pdos_weights;
+  def("pdos_weights", expt_pdos_weights_v1);
+
+  vector<double> (*expt_oscillator_strengths_v1)(vector<double>& dE, vector<VECTOR>& mu) = &oscillator_strengths;
+  def("oscillator_strengths", expt_oscillator_strengths_v1);
+
+  MATRIX (*expt_broaden_spectrum_v1)(MATRIX& hist, double de, double width, int lineshape) = &broaden_spectrum;
+  def("broaden_spectrum", expt_broaden_spectrum_v1);
+
+
+  void (Spectrum_Accumulator::*expt_add_lines_v1)(vector<double>& E, MATRIX& W) = &Spectrum_Accumulator::add_lines;
+  void (Spectrum_Accumulator::*expt_add_lines_v2)(vector<double>& E, vector<double>& w) = &Spectrum_Accumulator::add_lines;
+  void (Spectrum_Accumulator::*expt_add_orbitals_v1)
+  (MATRIX& E, MATRIX& C, MATRIX& S, vector<int>& ao_channel, int projection) = &Spectrum_Accumulator::add_orbitals;
+  void (Spectrum_Accumulator::*expt_add_orbitals_v2)
+  (Electronic_Structure& el, vector<int>& ao_channel, int projection) = &Spectrum_Accumulator::add_orbitals;
+
+  class_<Spectrum_Accumulator>("Spectrum_Accumulator",init<double, double, double, int>())
+      .def("__copy__", &generic__copy__<Spectrum_Accumulator>)
+      .def("__deepcopy__", &generic__deepcopy__<Spectrum_Accumulator>)
+      .def_readonly("emin", &Spectrum_Accumulator::emin)
+      .def_readonly("de", &Spectrum_Accumulator::de)
+      .def_readonly("npts", &Spectrum_Accumulator::npts)
+      .def_readonly("nchannels", &Spectrum_Accumulator::nchannels)
+      .def_readonly("nframes", &Spectrum_Accumulator::nframes)
+      .def_readwrite("hist", &Spectrum_Accumulator::hist)
+      .def("reset", &Spectrum_Accumulator::reset)
+      .def("add_lines", expt_add_lines_v1)
+      .def("add_lines", expt_add_lines_v2)
+      .def("add_orbitals", expt_add_orbitals_v1)
+      .def("add_orbitals", expt_add_orbitals_v2)
+      .def("add_transitions", &Spectrum_Accumulator::add_transitions)
+      .def("energy_grid", &Spectrum_Accumulator::energy_grid)
+      .def("spectrum", &Spectrum_Accumulator::spectrum)
+  ;
+
+
+
 }// export_qchem_tools_objects()
 
 
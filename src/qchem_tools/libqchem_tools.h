@@ -19,6 +19,7 @@
 
 #include "Charge_Density.h"
 #include "DOS.h"
+#include "Spectra.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -0,0 +1,397 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Integral_Cache.cpp
+  \brief The file implements the cache of the tabulated two-center integrals of the AOs
+*/
+
+#include "Integral_Cache.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libqobjects namespace
+namespace libqobjects{
+
+
+void RadialSpline::build(vector<double>& f_, double dR_, int is_even){
+/**
+  \param[in] f_ The values of the function on the grid
+  \param[in] dR_ The grid spacing
+  \param[in] is_even 1 - the function is even in R, so its derivative at R = 0 is 0 (clamped spline);
+  0 - the function is odd in R, so its second derivative at R = 0 is 0 (natural spline)
+
+  The tridiagonal system for the second derivatives is solved by the Thomas algorithm
+*/
+
+  f = f_;
+  dR = dR_;
+
+  int n = f.size();
+  d2 = vector<double>(n, 0.0);
+  if(n<3){ return; }
+
+  vector<double> c(n, 0.0), r(n, 0.0);
+
+  // Row 0, clamped:  2 d2[0] + d2[1] = 6 ((f[1] - f[0]) / dR - f'(0)) / dR,  with f'(0) = 0
+  // (natural: d2[0] = 0, so c[0] = r[0] = 0)
+  if(is_even){
+    c[0] = 0.5;
+    r[0] = 3.0*(f[1] - f[0])/(dR*dR);
+  }
+
+  // Rows i = 1 ... n-2:  d2[i-1] + 4 d2[i] + d2[i+1] = 6 (f[i+1] - 2 f[i] + f[i-1]) / dR^2
+  for(int i=1;i<n-1;i++){
+    double rhs = 6.0*(f[i+1] - 2.0*f[i] + f[i-1])/(dR*dR);
+    double m = 4.0 - c[i-1];
+    c[i] = 1.0/m;
+    r[i] = (rhs - r[i-1])/m;
+  }
+
+  for(int i=n-2;i>=0;i--){  d2[i] = r[i] - c[i]*d2[i+1];  }
+
+}
+
+
+double RadialSpline::value(double R, double& dfdR) const{
+
+  int n = f.size();
+  int i = int(R/dR);
+  if(i>n-2){ i = n-2; }
+  if(i<0){ i = 0; }
+
+  double b = (R - i*dR)/dR;
+  double a = 1.0 - b;
+
+  double res = a*f[i] + b*f[i+1] + ((a*a*a - a)*d2[i] + (b*b*b - b)*d2[i+1])*dR*dR/6.0;
+  dfdR = (f[i+1] - f[i])/dR + ((1.0 - 3.0*a*a)*d2[i] + (3.0*b*b - 1.0)*d2[i+1])*dR/6.0;
+
+  return res;
+}
+
+
+
+
+PairIntegralCache::PairIntegralCache(){
+/**
+  The tables cover 0 - 20 Bohr with the spacing of 0.01 Bohr
+*/
+
+  R_max = 20.0;
+  dR = 0.01;
+  n_lookups = 0;
+  n_direct = 0;
+
+}
+
+PairIntegralCache::PairIntegralCache(double R_max_, double dR_){
+/**
+  \param[in] R_max_ The range of the tables [Bohr]
+  \param[in] dR_ The grid spacing of the tables [Bohr]
+*/
+
+  if(dR_<=0.0 || R_max_<=2.0){
+    cout<<"Error in PairIntegralCache: the grid spacing must be positive and the range must be larger than 2 Bohr\n"; exit(0);
+  }
+
+  R_max = R_max_;
+  dR = dR_;
+  n_lookups = 0;
+  n_direct = 0;
+
+}
+
+PairIntegralCache::PairIntegralCache(const PairIntegralCache& ob){
+
+  *this = ob;
+
+}
+
+PairIntegralCache& PairIntegralCache::operator=(const PairIntegralCache& ob){
+
+  if(this==&ob){ return *this; }
+
+  radial_types = ob.radial_types;
+  templates = ob.templates;
+  template_l = ob.template_l;
+  tables = ob.tables;
+  R_max = ob.R_max;
+  dR = ob.dR;
+  n_lookups = ob.n_lookups;
+  n_direct = ob.n_direct;
+
+  return *this;
+}
+
+
+void PairIntegralCache::clear(){
+/**
+  Drop all the tables - e.g. after the basis set parameters are changed
+*/
+
+  radial_types.clear();
+  templates.clear();
+  template_l.clear();
+  tables.clear();
+  n_lookups = 0;
+  n_direct = 0;
+
+}
+
+
+int PairIntegralCache::radial_type(AO& ao, int& comp, int& l_type){
+/**
+  Returns the index of the radial type of the AO, or -1 if the AO is not of the s or p type.
+  comp is set to the Cartesian component of the p-type AO: 0 - x, 1 - y, 2 - z (-1 for s).
+  l_type is set to the angular momentum of the radial type (-1 if there is none).
+  The new types are registered in the critical section shared with table(); template_l is read
+  in the same section, since another thread may be growing it
+*/
+
+  comp = -1;
+  l_type = -1;
+  if(ao.expansion_size==0 || ao.primitives.size()==0){ return -1; }
+
+  int lx = ao.primitives[0].x_exp;
+  int ly = ao.primitives[0].y_exp;
+  int lz = ao.primitives[0].z_exp;
+  int l = lx + ly + lz;
+
+  if(l>1){ return -1; }
+  if(l==1){ comp = (lx==1) ? 0 : ((ly==1) ? 1 : 2); }
+
+  if(ao.element.size()==0 || ao.ao_shell.size()==0){ return -1; }
+
+  std::string key = ao.element + ":" + ao.ao_shell;
+  int indx = -1;
+
+  #pragma omp critical(pair_integral_cache)
+  {
+    std::map<std::string, int>::iterator it = radial_types.find(key);
+
+    if(it!=radial_types.end()){ indx = it->second; }
+    else{
+      // New radial type: keep the AO centered at the origin, with p along z
+      AO t(ao);
+      VECTOR zero(0.0, 0.0, 0.0);
+      t.set_position(zero);
+      for(int i=0;i<t.primitives.size();i++){
+        t.primitives[i].x_exp = 0;
+        t.primitives[i].y_exp = 0;
+        t.primitives[i].z_exp = l;
+      }
+      t.x_exp = 0; t.y_exp = 0; t.z_exp = l;
+
+      indx = templates.size();
+      templates.push_back(t);
+      template_l.push_back(l);
+      radial_types[key] = indx;
+    }
+    l_type = template_l[indx];
+  }// critical
+
+  return indx;
+}
+
+
+const RadialSpline& PairIntegralCache::table(int kind, int ta, int tb){
+/**
+  kind = 0 - <s_A|s_B>,  1 - <s_A|pz_B>,  2 - <pz_A|s_B>,  3 - <pz_A|pz_B>,  4 - <px_A|px_B>,  5 - (s_A s_A|s_B s_B)
+  with A at the origin and B at (0, 0, R). The s-p functions (kinds 1 and 2) are odd in R, the others are even.
+
+  A missing table is computed in the critical section, so the threads that need it wait for the first one
+  to finish it. The returned reference stays valid until clear() is called.
+*/
+
+  long key = (long(kind)*100000 + ta)*100000 + tb;
+  RadialSpline* sp = NULL;
+
+  #pragma omp critical(pair_integral_cache)
+  {
+    std::map<long, RadialSpline>::iterator it = tables.find(key);
+
+    if(it!=tables.end()){ sp = &it->second; }
+    else{
+      int n = int(R_max/dR) + 1;
+      vector<double> f(n, 0.0);
+
+      AO a(templates[ta]);
+      AO b(templates[tb]);
+
+      if(kind==4){
+        for(int i=0;i<a.primitives.size();i++){ a.primitives[i].x_exp = 1; a.primitives[i].z_exp = 0; }
+        for(int i=0;i<b.primitives.size();i++){ b.primitives[i].x_exp = 1; b.primitives[i].z_exp = 0; }
+      }
+
+      for(int i=0;i<n;i++){
+        VECTOR Rb(0.0, 0.0, i*dR);
+        b.set_position(Rb);
+
+        if(kind==5){ f[i] = electron_repulsion_integral(a, a, b, b); }
+        else{ f[i] = gaussian_overlap(a, b); }
+      }
+
+      sp = &tables[key];
+      sp->build(f, dR, (kind!=1 && kind!=2));
+    }
+  }// critical
+
+  return *sp;
+}
+
+
+
+double PairIntegralCache::overlap(AO& a, AO& b, int is_derivs, VECTOR& dIdA, VECTOR& dIdB){
+/**
+  \param[in] a, b The AOs
+  \param[in] is_derivs 1 - compute also the derivatives
+  \param[out] dIdA, dIdB The derivatives of the overlap w.r.t. the centers of a and b
+
+  Same as gaussian_overlap(a, b, 1, is_derivs, dIdA, dIdB)
+*/
+
+  int ca, cb, la, lb;
+  int ta = radial_type(a, ca, la);
+  int tb = radial_type(b, cb, lb);
+
+  VECTOR Rab; Rab = b.primitives[0].R - a.primitives[0].R;
+  double R = Rab.length();
+
+  if(ta<0 || tb<0 || R<1e-6 || R>R_max-1.0){
+    #pragma omp atomic
+    n_direct++;
+    if(is_derivs){ return gaussian_overlap(a, b, 1, 1, dIdA, dIdB); }
+    return gaussian_overlap(a, b);
+  }
+
+  #pragma omp atomic
+  n_lookups++;
+
+  double u[3] = { Rab.x/R, Rab.y/R, Rab.z/R };
+  double G[3] = { 0.0, 0.0, 0.0 };   // dS/dR_B
+  double S = 0.0;
+
+  if(la==0 && lb==0){
+    double df;
+    S = table(0, ta, tb).value(R, df);
+    for(int m=0;m<3;m++){ G[m] = df*u[m]; }
+  }
+  else if(la==0 && lb==1){
+    double dg;
+    double g = table(1, ta, tb).value(R, dg);
+    int k = cb;
+    S = u[k]*g;
+    for(int m=0;m<3;m++){ G[m] = u[k]*u[m]*dg + g*(((k==m) ? 1.0 : 0.0) - u[k]*u[m])/R; }
+  }
+  else if(la==1 && lb==0){
+    double dg;
+    double g = table(2, ta, tb).value(R, dg);
+    int k = ca;
+    S = u[k]*g;
+    for(int m=0;m<3;m++){ G[m] = u[k]*u[m]*dg + g*(((k==m) ? 1.0 : 0.0) - u[k]*u[m])/R; }
+  }
+  else{
+    double dsig, dpi;
+    double sig = table(3, ta, tb).value(R, dsig);
+    double pi  = table(4, ta, tb).value(R, dpi);
+    int i = ca, j = cb;
+    double dij = (i==j) ? 1.0 : 0.0;
+
+    S = u[i]*u[j]*(sig - pi) + dij*pi;
+    for(int m=0;m<3;m++){
+      double dim = (i==m) ? 1.0 : 0.0;
+      double djm = (j==m) ? 1.0 : 0.0;
+      G[m] = u[i]*u[j]*u[m]*(dsig - dpi) + dij*u[m]*dpi
+           + (sig - pi)*((dim - u[i]*u[m])*u[j] + u[i]*(djm - u[j]*u[m]))/R;
+    }
+  }
+
+  if(is_derivs){
+    dIdB = VECTOR(G[0], G[1], G[2]);
+    dIdA = -dIdB;
+  }
+
+  return S;
+}
+
+double PairIntegralCache::overlap(AO& a, AO& b){
+
+  VECTOR dIdA, dIdB;
+  return overlap(a, b, 0, dIdA, dIdB);
+
+}
+
+
+
+double PairIntegralCache::eri_ss(AO& a, AO& b, int is_derivs, VECTOR& dIdA, VECTOR& dIdB){
+/**
+  \param[in] a, b The s-type AOs
+  \param[in] is_derivs 1 - compute also the derivatives
+  \param[out] dIdA, dIdB The derivatives of (aa|bb) w.r.t. the centers of a and b
+
+  Same as electron_repulsion_integral(a, a, b, b), with dIdA = DA + DB and dIdB = DC + DD
+*/
+
+  int ca, cb, la, lb;
+  int ta = radial_type(a, ca, la);
+  int tb = radial_type(b, cb, lb);
+
+  VECTOR Rab; Rab = b.primitives[0].R - a.primitives[0].R;
+  double R = Rab.length();
+
+  if(ta<0 || tb<0 || la!=0 || lb!=0 || R>R_max-1.0){
+    #pragma omp atomic
+    n_direct++;
+    if(is_derivs){
+      VECTOR DA, DB, DC, DD;
+      double res = electron_repulsion_integral(a, a, b, b, 1, 1, DA, DB, DC, DD);
+      dIdA = DA + DB;  dIdB = DC + DD;
+      return res;
+    }
+    return electron_repulsion_integral(a, a, b, b);
+  }
+
+  #pragma omp atomic
+  n_lookups++;
+
+  const RadialSpline& sp = table(5, ta, tb);
+
+  if(R<1e-6){
+    if(is_derivs){ dIdA = 0.0; dIdB = 0.0; }
+    return sp.f[0];
+  }
+
+  double df;
+  double res = sp.value(R, df);
+
+  if(is_derivs){
+    dIdB = (df/R)*Rab;
+    dIdA = -dIdB;
+  }
+
+  return res;
+}
+
+double PairIntegralCache::eri_ss(AO& a, AO& b){
+
+  VECTOR dIdA, dIdB;
+  return eri_ss(a, b, 0, dIdA, dIdB);
+
+}
+
+
+
+}// namespace libqobjects
+}// namespace liblibra
+
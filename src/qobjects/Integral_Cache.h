@@ -0,0 +1,110 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Integral_Cache.h
+  \brief The file describes the cache of the tabulated two-center integrals of the AOs
+
+  The two-center integrals of the s and p AOs are combinations of a few functions of the distance
+  between the centers (sigma and pi integrals in the local frame, where the z axis goes from A to B),
+  and of the direction cosines of the A->B vector (Slater-Koster rules). The functions of the distance
+  are tabulated once for every pair of the AO types (given by the element and the shell names) and
+  interpolated by cubic splines afterwards, so the integrals at a new geometry are the table lookups
+  plus the rotation to the molecular frame.
+
+  The cache may be used from several OpenMP threads: the tables are found and created in a critical
+  section, and they are kept in a node-based container, so the references to them stay valid.
+*/
+
+#ifndef INTEGRAL_CACHE_H
+#define INTEGRAL_CACHE_H
+
+#include <map>
+#include "AO.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libqobjects namespace
+namespace libqobjects{
+
+
+class RadialSpline{
+/**
+  Cubic spline of a function tabulated on the uniform grid R_i = i * dR, i = 0, ... , n-1.
+  At R = 0 either the first derivative is set to 0 (clamped - for the functions even in R) or the second
+  one (natural - for the odd ones); at the end of the grid the spline is natural.
+*/
+
+public:
+
+  double dR;
+  vector<double> f;    ///< the tabulated values
+  vector<double> d2;   ///< the second derivatives at the grid points
+
+  RadialSpline(){ dR = 1.0; }
+  void build(vector<double>& f_, double dR_, int is_even);
+  double value(double R, double& dfdR) const;
+
+};
+
+
+class PairIntegralCache{
+/**
+  The cache of the tabulated two-center integrals. The AOs with the same element and shell names (e.g. "C", "2p")
+  are assumed to have the same contraction. The integrals involving other than s and p AOs, the AOs on the same
+  center and the centers farther than R_max - 1 Bohr apart are computed directly.
+*/
+
+  std::map<std::string, int> radial_types;   ///< "element:shell" -> index of the radial type
+  vector<AO> templates;                       ///< the AO of each radial type, centered at the origin, along z for p
+  vector<int> template_l;                     ///< the angular momentum of each radial type: 0 - s, 1 - p
+
+  std::map<long, RadialSpline> tables;        ///< (kind, type A, type B) -> the table
+
+  int radial_type(AO& ao, int& comp, int& l_type);
+  const RadialSpline& table(int kind, int ta, int tb);
+
+public:
+
+  double R_max;       ///< the range of the tables [Bohr]
+  double dR;          ///< the grid spacing of the tables [Bohr]
+
+  long n_lookups;     ///< the number of the integrals obtained from the tables (updated atomically)
+  long n_direct;      ///< the number of the integrals computed directly (updated atomically)
+
+  PairIntegralCache();
+  PairIntegralCache(double R_max_, double dR_);
+  PairIntegralCache(const PairIntegralCache& ob);
+  PairIntegralCache& operator=(const PairIntegralCache& ob);
+  ~PairIntegralCache(){ ;; }
+
+  void clear();
+  int num_tables(){ return tables.size(); }
+
+  ///< <a|b> and its derivatives w.r.t. the centers of a and b
+  double overlap(AO& a, AO& b, int is_derivs, VECTOR& dIdA, VECTOR& dIdB);
+  double overlap(AO& a, AO& b);
+
+  ///< (aa|bb) of the s-type AOs and its derivatives w.r.t. the centers of a and b
+  double eri_ss(AO& a, AO& b, int is_derivs, VECTOR& dIdA, VECTOR& dIdB);
+  double eri_ss(AO& a, AO& b);
+
+};
+
+
+}// namespace libqobjects
+}// namespace liblibra
+
+
+#endif // INTEGRAL_CACHE_H
@@ -435,6 +435,27 @@ void export_qobjects_objects(){
   ;
 
 
+  double (PairIntegralCache::*expt_overlap_v1)(AO& a, AO& b) = &PairIntegralCache::overlap;
+  double (PairIntegralCache::*expt_eri_ss_v1)(AO& a, AO& b) = &PairIntegralCache::eri_ss;
+
+  class_<PairIntegralCache>("PairIntegralCache",init<>())
+      .def(init<double, double>())
+      .def(init<const PairIntegralCache&>())
+      .def("__copy__", &generic__copy__<PairIntegralCache>) 
+      .def("__deepcopy__", &generic__deepcopy__<PairIntegralCache>)
+
+      .def_readonly("R_max",&PairIntegralCache::R_max)
+      .def_readonly("dR",&PairIntegralCache::dR)
+      .def_readwrite("n_lookups",&PairIntegralCache::n_lookups)
+      .def_readwrite("n_direct",&PairIntegralCache::n_direct)
+
+      .def("clear",&PairIntegralCache::clear)
+      .def("num_tables",&PairIntegralCache::num_tables)
+      .def("overlap",expt_overlap_v1)
+      .def("eri_ss",expt_eri_ss_v1)
+  ;
+
+
 
 
 
@@ -21,6 +21,7 @@
 #include "AO.h"
 #include "PW.h"
 #include "SD.h"
+#include "Integral_Cache.h"
 
 /// liblibra namespace
 namespace liblibra{
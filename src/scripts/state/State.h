@@ -87,6 +87,11 @@ class State{
   void init_variables();           // Initializes variables
   void copy_content(const State&); // Copies the content which is defined
 
+  // Thermostat/barostat and momentum half-steps shared by the MD drivers, defined in State_methods.cpp
+  void propagate_nhc_half(double dt_half, int is_thermostat, int is_barostat);       // Operator NHCB(dt/2)
+  void propagate_baro_half(double dt_half, int is_thermostat, int is_barostat);      // Operator B(dt/2)
+  double propagate_momenta_half(double dt_half, int is_thermostat, int is_barostat); // Operator A(dt/2)
+
   //
   int is_md_initialized; 
 
@@ -147,8 +152,8 @@ public:
   void run_md(Electronic& el, Hamiltonian& ham);
 
 
-  // Defined in State_methods2.cpp
-//  void run_md_respa();
+  // Defined in State_methods3.cpp
+  void run_md_respa(libhamiltonian_atomistic::Hamiltonian_Atomistic& ham);
 
 };
 
@@ -42,6 +42,87 @@ void State::cool(){
 }
 
 
+void State::propagate_nhc_half(double dt_half, int is_thermostat, int is_barostat){
+/**
+  \param[in] dt_half The time interval of the operator (half of the MD step or of its outer sub-step)
+  \param[in] is_thermostat The flag telling whether the thermostat is active in the current ensemble
+  \param[in] is_barostat The flag telling whether the barostat is active in the current ensemble
+
+  Operator NHCB(dt/2): updates the thermostat forces and propagates the Nose-Hoover chains
+*/
+
+  if(is_thermostat){
+    double ekin_baro = 0.0;
+    if(is_barostat){  ekin_baro = barostat->ekin_baro(); }
+    thermostat->update_thermostat_forces(syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
+    thermostat->propagate_nhc(dt_half,syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
+  }
+}
+
+void State::propagate_baro_half(double dt_half, int is_thermostat, int is_barostat){
+/**
+  \param[in] dt_half The time interval of the operator (half of the MD step or of its outer sub-step)
+  \param[in] is_thermostat The flag telling whether the thermostat is active in the current ensemble
+  \param[in] is_barostat The flag telling whether the barostat is active in the current ensemble
+
+  Operator B(dt/2): updates the barostat forces with the current volume and pressure (tensor) and
+  propagates the barostat velocity, damped by the thermostat variable ksi_b
+*/
+
+  if(is_barostat){
+    if(md->ensemble=="NPT"||md->ensemble=="NPH"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P);   }
+    else if(md->ensemble=="NPT_FLEX"||md->ensemble=="NPH_FLEX"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P_tens);   }
+    double scl = 0.0; if(is_thermostat){ scl = thermostat->get_ksi_b();  }
+    barostat->propagate_velocity(dt_half,scl);
+  }
+}
+
+double State::propagate_momenta_half(double dt_half, int is_thermostat, int is_barostat){
+/**
+  \param[in] dt_half The time interval of the operator (half of the MD step)
+  \param[in] is_thermostat The flag telling whether the thermostat is active in the current ensemble
+  \param[in] is_barostat The flag telling whether the barostat is active in the current ensemble
+
+  Operator A(dt/2): applies the stored forces and torques of all fragments to their momenta, together with
+  the thermostat/barostat friction. Returns the kinetic energy of the fragments after the update.
+*/
+
+  int i;
+  double sc3,sc4,ksi_r;
+  MATRIX3x3 S,I,sc1,sc2;
+  double ekin = 0.0;
+
+  //-------------------- Linear momentum propagation --------------------
+  S = 0.0; I.identity();
+  if(is_barostat){
+    int Nf_b = barostat->get_Nf_b();
+    if(Nf_b==9){ S = barostat->ksi_eps + (barostat->ksi_eps.tr()/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
+    else if(Nf_b==1){S = barostat->ksi_eps_iso * I + (3.0*barostat->ksi_eps_iso/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
+  }
+  if(is_thermostat){   S = S + thermostat->get_ksi_t() * I;      }
+  sc1 = (exp_(S,-dt_half));//.symmetrized();
+  sc2 = dt_half*(exp1_(S,-dt_half*0.5));//.symmetrized()*dt_half;
+
+  //------------------- Angular momentum propagation -----------------------
+  if(is_thermostat){ ksi_r = thermostat->get_ksi_r();}else{ ksi_r = 0.0;}
+  sc3 = exp(-dt_half*ksi_r);
+  sc4 = dt_half*exp(-0.5*dt_half*ksi_r)*sinh_(0.5*dt_half*ksi_r);
+
+
+  for(i=0;i<syst->Number_of_fragments;i++){
+    RigidBody& top = syst->Fragments[i].Group_RB;
+    //-------------------- Linear momentum propagation --------------------
+    top.scale_linear_(sc1);
+    top.apply_force(sc2);
+    //------------------- Angular momentum propagation -----------------------
+    top.scale_angular_(sc3);
+    top.apply_torque(sc4);
+    ekin += (top.ekin_rot() + top.ekin_tr());
+  }// for i
+
+  return ekin;
+}
+
 
 }// namespace libstate
 }// namespace libscripts
@@ -114,34 +114,18 @@ void State::run_md(Electronic& el, Hamiltonian& ham){
   double dt = md->dt;
   double dt_half = 0.5*md->dt;
   double Nf = syst->Nf_t + syst->Nf_r;
-  int Nf_b = 0;
-  if(is_barostat) {Nf_b = barostat->get_Nf_b();}
-  double scl,sc3,sc4,ksi_r;
-  MATRIX3x3 S,I,sc1,sc2;
+  MATRIX3x3 sc1,sc2;
 
 
   while(md->curr_step<md->max_step){
 
     // Operator NHCB(dt/2)
-    if(is_thermostat){
-      double ekin_baro = 0.0;
-      if(is_barostat){  ekin_baro = barostat->ekin_baro(); }
-      thermostat->update_thermostat_forces(syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
-      thermostat->propagate_nhc(dt_half,syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
-    }
-
+    propagate_nhc_half(dt_half, is_thermostat, is_barostat);
 
     if(is_thermostat){  thermostat->propagate_sPs(dt_half);    }
 
-    //bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb
     // Operator B(dt/2)
-    if(is_barostat){
-      if(md->ensemble=="NPT"||md->ensemble=="NPH"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P);   }
-      else if(md->ensemble=="NPT_FLEX"||md->ensemble=="NPH_FLEX"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P_tens);   }
-      scl = 0.0; if(is_thermostat){ scl = thermostat->get_ksi_b();  }
-      barostat->propagate_velocity(dt_half,scl);
-    }
-    //bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb
+    propagate_baro_half(dt_half, is_thermostat, is_barostat);
 
 
     double s_var,Ps,dt_half_s,dt_over_s,dt_over_s2;
@@ -159,40 +143,8 @@ void State::run_md(Electronic& el, Hamiltonian& ham){
       }
     }
 
-    //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa    
     // Operator A(dt/2)
-    //-------------------- Linear momentum propagation --------------------
-    S = 0.0; I.identity();
-    if(is_barostat){
-      if(Nf_b==9){ S = barostat->ksi_eps + (barostat->ksi_eps.tr()/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
-      else if(Nf_b==1){S = barostat->ksi_eps_iso * I + (3.0*barostat->ksi_eps_iso/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
-    }
-    if(is_thermostat){   S = S + thermostat->get_ksi_t() * I;      }
-    sc1 = (exp_(S,-dt_half));//.symmetrized();
-    sc2 = dt_half*(exp1_(S,-dt_half*0.5));//.symmetrized()*dt_half;
-
-    //------------------- Angular momentum propagation -----------------------    
-    if(is_thermostat){ ksi_r = thermostat->get_ksi_r();}else{ ksi_r = 0.0;}
-    sc3 = exp(-dt_half*ksi_r);
-    sc4 = dt_half*exp(-0.5*dt_half*ksi_r)*sinh_(0.5*dt_half*ksi_r);
-
-
-
-    for(i=0;i<syst->Number_of_fragments;i++){
-      RigidBody& top = syst->Fragments[i].Group_RB;
-      //-------------------- Linear momentum propagation --------------------
-      top.scale_linear_(sc1);
-      top.apply_force(sc2);
-      //------------------- Angular momentum propagation -----------------------
-      top.scale_angular_(sc3);
-      top.apply_torque(sc4);       
-    }// for i
-    
-
-//    if(is_thermostat){
-//      thermostat->propagate_Ps(-dt_half*E_pot);
-//    }
-    //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
+    propagate_momenta_half(dt_half, is_thermostat, is_barostat);
 
     if(is_thermostat){  thermostat->propagate_Ps(-dt_half*E_pot);    }
 
@@ -296,37 +248,8 @@ void State::run_md(Electronic& el, Hamiltonian& ham){
     //cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc
 
     
-    //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
     // Operator A(dt/2)
-    E_kin = 0.0;
-    //-------------------- Linear momentum propagation --------------------
-    S = 0.0; I.identity();
-    if(is_barostat){
-      if(Nf_b==9){ S = barostat->ksi_eps + (barostat->ksi_eps.tr()/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
-      else if(Nf_b==1){S = barostat->ksi_eps_iso * I + (3.0*barostat->ksi_eps_iso/(barostat->get_Nf_t()/*+barostat->get_Nf_r()*/))*I; }
-    }
-    if(is_thermostat){   S = S + thermostat->get_ksi_t() * I;      }
-    sc1 = (exp_(S,-dt_half));//.symmetrized();
-    sc2 = dt_half*(exp1_(S,-dt_half*0.5));//.symmetrized()*dt_half;
-
-    //------------------- Angular momentum propagation -----------------------
-    if(is_thermostat){ ksi_r = thermostat->get_ksi_r();}else{ ksi_r = 0.0;}
-    sc3 = exp(-dt_half*ksi_r);
-    sc4 = dt_half*exp(-0.5*dt_half*ksi_r)*sinh_(0.5*dt_half*ksi_r);
-
-
-    for(i=0;i<syst->Number_of_fragments;i++){
-      RigidBody& top = syst->Fragments[i].Group_RB;
-      //-------------------- Linear momentum propagation --------------------
-      top.scale_linear_(sc1);
-      top.apply_force(sc2);
-      //------------------- Angular momentum propagation -----------------------
-      top.scale_angular_(sc3);
-      top.apply_torque(sc4);
-      E_kin += (top.ekin_rot() + top.ekin_tr());
-    }// for i
-
-    //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
+    E_kin = propagate_momenta_half(dt_half, is_thermostat, is_barostat);
 
     if(is_thermostat){ thermostat->propagate_Ps( -dt_half*E_pot); }
    //------- Update state variables ------------
@@ -338,26 +261,13 @@ void State::run_md(Electronic& el, Hamiltonian& ham){
 //   curr_V = 1e+10;
    //-------------------------------------------
 
-    //bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb
     // Operator B(dt/2)
-    if(is_barostat){
-      if(md->ensemble=="NPT"||md->ensemble=="NPH"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P);   }
-      else if(md->ensemble=="NPT_FLEX"||md->ensemble=="NPH_FLEX"){ barostat->update_barostat_forces(syst->ekin_tr(),syst->ekin_rot(),curr_V,curr_P_tens);   }
-      scl = 0.0; if(is_thermostat){ scl = thermostat->get_ksi_b();  }
-      barostat->propagate_velocity(dt_half,scl);
-    }
-
-    //bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb
+    propagate_baro_half(dt_half, is_thermostat, is_barostat);
 
     if(is_thermostat){thermostat->propagate_sPs(dt_half); }
 
     // Operator NHCB(dt/2)
-    if(is_thermostat){
-      double ekin_baro = 0.0;
-      if(is_barostat){  ekin_baro = barostat->ekin_baro(); }
-      thermostat->update_thermostat_forces(syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
-      thermostat->propagate_nhc(dt_half,syst->ekin_tr(),syst->ekin_rot(),ekin_baro);
-    }
+    propagate_nhc_half(dt_half, is_thermostat, is_barostat);
 
 
     if(md->ensemble=="NVE"){ s_var = 1.0;  Ps = 0.0;}
@@ -0,0 +1,269 @@
+/*********************************************************************************
+* Copyright (C) 2015-2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+
+#include "State.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libhamiltonian::libhamiltonian_atomistic;
+
+namespace libscripts{
+namespace libstate{
+
+
+static double respa_forces(System* syst, Hamiltonian_Atomistic& ham, std::string respa_type){
+/**
+  \param[in,out] syst The System which atoms and fragments receive the forces
+  \param[in,out] ham The atomistic Hamiltonian bound to the same System object
+  \param[in] respa_type The class of the interactions: "fast", "medium" or "slow"
+
+  Computes the forces of only one RESPA class and converts them into the fragment forces and torques.
+  Returns the energy of this class of interactions.
+*/
+
+  syst->zero_forces_and_torques();
+  double res = ham.energy_respa(respa_type);
+  syst->update_fragment_forces_and_torques();
+
+  return res;
+}
+
+static void respa_kick(System* syst, double dt){
+/**
+  \param[in,out] syst The System which fragment momenta are updated
+  \param[in] dt The time interval of the impulse
+
+  Applies the currently stored fragment forces and torques for the time interval dt (no thermostat scaling).
+*/
+
+  for(int i=0;i<syst->Number_of_fragments;i++){
+    RigidBody& top = syst->Fragments[i].Group_RB;
+    top.apply_force(dt);
+    top.apply_torque(dt);
+  }
+}
+
+
+void State::run_md_respa(Hamiltonian_Atomistic& ham){
+/**
+  \param[in,out] ham The atomistic Hamiltonian bound to the simulated System. The MM interactions must be
+  classified with listHamiltonian_MM::set_respa_types (0 - fast, 1 - medium, 2 - slow)
+
+  Reversible multiple-time-step (r-RESPA) version of run_md. The slow forces are applied with the step md->dt,
+  the medium ones - with md->dt/md->n_medium, the fast ones - with md->dt/(md->n_medium*md->n_fast). The free
+  (core) propagation of the fragments is done at the innermost level. The thermostat and barostat operators are
+  applied at the outermost level, each split into md->n_outer sub-steps.
+  The step is: NHCB(dt/2) A_slow(dt/2) [ A_med(dt_m/2) [ A_fast(dt_f/2) Core(dt_f) A_fast(dt_f/2) ]^n_fast  A_med(dt_m/2) ]^n_medium
+  A_slow(dt/2) NHCB(dt/2)
+*/
+
+  int i, s_m, s_f, s_o;
+  if(md==NULL) { std::cout<<"Error: MD parameters have not been defined\n"; exit(1);}
+  if(!is_md_initialized){    std::cout<<"Error: Need to call init_md() first. MD is not initialized\n"; exit(2);   }
+  if(md->n_medium<1 || md->n_fast<1 || md->n_outer<1){
+    std::cout<<"Error: RESPA requires n_medium, n_fast and n_outer to be positive\n"; exit(1);
+  }
+
+  int is_thermostat, is_barostat;
+  is_thermostat = ((thermostat!=NULL) && ((md->ensemble=="NVT")||(md->ensemble=="NPT")||(md->ensemble=="NPT_FLEX")));
+  is_barostat   = ((barostat!=NULL) && ((md->ensemble=="NPT")||(md->ensemble=="NPT_FLEX")||(md->ensemble=="NPH")||(md->ensemble=="NPH_FLEX")));
+
+  double dt = md->dt;
+  double dt_half = 0.5*md->dt;
+  double dt_m = dt/((double)md->n_medium);
+  double dt_m_half = 0.5*dt_m;
+  double dt_f = dt_m/((double)md->n_fast);
+  double dt_f_half = 0.5*dt_f;
+  double dt_o_half = dt_half/((double)md->n_outer);
+
+  double Nf = syst->Nf_t + syst->Nf_r;
+  MATRIX3x3 sc1,sc2;
+  double E_fast, E_medium, E_slow;
+
+
+  // Initial forces of all classes: the fast and medium are stored, the slow ones stay in the fragments
+  E_fast = respa_forces(syst, ham, "fast");     syst->save_respa_state("fast");
+  E_medium = respa_forces(syst, ham, "medium"); syst->save_respa_state("medium");
+  E_slow = respa_forces(syst, ham, "slow");
+  E_pot = E_fast + E_medium + E_slow;
+
+
+  while(md->curr_step<md->max_step){
+
+    for(s_o=0;s_o<md->n_outer;s_o++){
+      // Operator NHCB(dt/2)
+      propagate_nhc_half(dt_o_half, is_thermostat, is_barostat);
+
+      if(is_thermostat){  thermostat->propagate_sPs(dt_o_half);    }
+
+      // Operator B(dt/2)
+      propagate_baro_half(dt_o_half, is_thermostat, is_barostat);
+    }// for s_o
+
+
+    double s_var,Ps,dt_over_s,dt_over_s2;
+    s_var = 1.0; Ps = 0.0;
+    dt_over_s = dt_f;
+    dt_over_s2 = dt_f;
+
+    if(is_thermostat){
+      s_var = thermostat->get_s_var();
+      dt_over_s = (dt_f/s_var);
+      dt_over_s2 = (dt_over_s/s_var);
+    }
+
+    // Operator A_slow(dt/2): slow forces + thermostat/barostat friction on momenta
+    propagate_momenta_half(dt_half, is_thermostat, is_barostat);
+
+    if(is_thermostat){  thermostat->propagate_Ps(-dt_half*E_pot);    }
+
+
+    for(s_m=0;s_m<md->n_medium;s_m++){
+
+      // Operator A_medium(dt_m/2)
+      syst->load_respa_state("medium");
+      respa_kick(syst, dt_m_half);
+
+      for(s_f=0;s_f<md->n_fast;s_f++){
+
+        // Operator A_fast(dt_f/2)
+        syst->load_respa_state("fast");
+        respa_kick(syst, dt_f_half);
+
+        //ccccccccccccccccccccccccccccccc Core part ccccccccccccccccccccccccccccccccccccc
+        sc1.identity();
+        sc2.identity();
+        sc2 = sc2 * dt_f;
+        if(is_barostat){
+          sc1 = (barostat->pos_scale(dt_f));
+          sc2 = dt_f*barostat->vpos_scale(dt_f);
+        }
+
+        for(i=0;i<syst->Number_of_fragments;i++){
+          RigidBody& top = syst->Fragments[i].Group_RB;
+          if(is_thermostat){  thermostat->propagate_Ps( 0.5*dt_over_s2*(top.ekin_rot()+top.ekin_tr()) ); }
+          if(md->integrator=="Jacobi")    { top.propagate_exact_rb(dt_over_s); }
+          else if(md->integrator=="DLML")  { top.propagate_dlml(dt_over_s,Ps); }
+          else if(md->integrator=="Terec") { top.propagate_terec(dt_over_s);}
+          else if(md->integrator=="qTerec") { top.propagate_qterec(dt_over_s);}
+          else if(md->integrator=="NO_SQUISH"){ top.propagate_no_squish(dt_over_s);}
+          else if(md->integrator=="KLN")   { top.propagate_kln(dt_over_s);}
+          else if(md->integrator=="Omelyan"){ top.propagate_omelyan(dt_over_s);}
+
+          if(is_thermostat){  thermostat->propagate_Ps( 0.5*dt_over_s2*(top.ekin_rot()+top.ekin_tr()) ); }
+          if(is_barostat) {
+            top.scale_position(sc1);
+            top.shift_position(sc2*top.rb_p*top.rb_iM);
+          }
+          else{
+            top.shift_position(dt_over_s*top.rb_p*top.rb_iM);
+          }
+        }// for i - all fragments
+
+        if(is_thermostat){  thermostat->propagate_Ps(dt_f*( H0 - Nf*boltzmann*thermostat->Temperature*(log(thermostat->s_var)+1.0) ) ); }
+
+        // Update cell shape
+        if(is_barostat){
+          if(syst->is_Box) {  syst->Box  =  barostat->pos_scale(dt_f) * syst->Box;  }
+        }
+
+        // Update atomic positions and recompute the fast forces
+        for(i=0;i<syst->Number_of_fragments;i++){ syst->update_atoms_for_fragment(i);  }
+        E_fast = respa_forces(syst, ham, "fast");
+        syst->save_respa_state("fast");
+        //cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc
+
+        // Operator A_fast(dt_f/2)
+        respa_kick(syst, dt_f_half);
+
+      }// for s_f
+
+      // Operator A_medium(dt_m/2)
+      E_medium = respa_forces(syst, ham, "medium");
+      syst->save_respa_state("medium");
+      respa_kick(syst, dt_m_half);
+
+    }// for s_m
+
+    E_slow = respa_forces(syst, ham, "slow");
+    E_pot = E_fast + E_medium + E_slow;
+
+
+    // Operator A_slow(dt/2)
+    E_kin = propagate_momenta_half(dt_half, is_thermostat, is_barostat);
+
+    if(is_thermostat){ thermostat->propagate_Ps( -dt_half*E_pot); }
+
+    //------- Update state variables ------------
+    curr_P_tens = syst->pressure_tensor();
+    curr_P = (curr_P_tens.tr()/3.0);
+    curr_V = syst->volume();
+
+
+    for(s_o=0;s_o<md->n_outer;s_o++){
+      // Operator B(dt/2)
+      propagate_baro_half(dt_o_half, is_thermostat, is_barostat);
+
+      if(is_thermostat){thermostat->propagate_sPs(dt_o_half); }
+
+      // Operator NHCB(dt/2)
+      propagate_nhc_half(dt_o_half, is_thermostat, is_barostat);
+    }// for s_o
+
+
+    if(is_thermostat){   E_kin/=(thermostat->s_var*thermostat->s_var); }
+
+    E_kin_tr = syst->ekin_tr();
+    E_kin_rot = syst->ekin_rot();
+    E_tot = E_kin + E_pot;
+
+    if(md->ensemble=="NVE"){  H_NP = E_tot; }
+    else if(md->ensemble=="NVT"){
+      if(is_thermostat){
+        if(!is_H0){ H0 = E_tot + thermostat->energy(); is_H0 = 1;}
+        if(thermostat->thermostat_type=="Nose-Poincare"){    H_NP = thermostat->s_var*(E_tot + thermostat->energy() - H0);   }
+        else if(thermostat->thermostat_type=="Nose-Hoover"){ H_NP = E_tot + thermostat->energy();    }
+      }
+    }
+    else if(md->ensemble=="NPH"||md->ensemble=="NPH_FLEX"){
+      if(is_barostat){  H_NP = E_tot + barostat->ekin_baro() + curr_V * barostat->Pressure;   }
+    }
+    else if(md->ensemble=="NPT" || md->ensemble=="NPT_FLEX"){
+      if(is_barostat){   H_NP = E_tot + barostat->ekin_baro() + curr_V * barostat->Pressure;  }
+      if(is_thermostat){ H_NP += thermostat->energy();   }
+    }
+
+    curr_T = 2.0*E_kin/(Nf*(boltzmann/hartree));
+
+    //------------- Angular velocity --------------
+    L_tot = 0.0;
+    P_tot = 0.0;
+    for(i=0;i<syst->Number_of_fragments;i++){
+      RigidBody& top = syst->Fragments[i].Group_RB;
+      VECTOR tmp; tmp.cross(top.rb_cm,top.rb_p);
+      L_tot += top.rb_A_I_to_e_T * top.rb_l_e + tmp;
+      P_tot += top.rb_p;
+    }
+
+    md->curr_step++;
+    md->curr_time+=dt;
+
+  }// while
+
+  md->curr_step = 0;
+  md->curr_time = 0.0;
+}
+
+
+}// namespace libstate
+}// namespace libscripts
+}// liblibra
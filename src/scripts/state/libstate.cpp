@@ -83,7 +83,7 @@ void export_state_objects(){
 
       .def("run_md",expt_run_md_v1)
       .def("run_md",expt_run_md_v2)
-//      .def("run_md_respa",&State::run_md_respa)
+      .def("run_md_respa",&State::run_md_respa)
   ;
 
 
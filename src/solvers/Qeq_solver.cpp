@@ -0,0 +1,747 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+ \file Qeq_solver.cpp
+ \brief The file implements the matrix-free charge equilibration (Qeq) solver
+
+ The Coulomb interaction between the atoms i and j is J_ij(r) given by one of the libmolint::Coulomb_Integral
+ approximations. At large r they all approach f/r, with f = lim r*J_ij(r): f = 1/epsilon for kernel 1,
+ f = 1.2 for kernel 3 (Nishimoto-Mataga-Weiss) and f = 1 for others. Only this long-range tail needs a special
+ treatment:
+
+ method 0:  A_ij = J_ij(r_ij) for all pairs, evaluated on the fly (O(N^2) per matrix-vector product)
+
+ method 1:  A_ij = J_ij(r) - f/r + f*erfc(alpha*r)/r - f*erfc(alpha*Rcut)/Rcut  for r < Rcut
+            A_ii += -f * ( erfc(alpha*Rcut)/Rcut + 2*alpha/sqrt(pi) )
+            This is the damped shifted sum of Wolf et al. (J. Chem. Phys. 1999, 110, 8254), with alpha = 0
+            it is the plain shifted Coulomb potential.
+
+ method 2:  A_ij = J_ij(r) - f/r + f*erfc(beta*r)/r  for r < Rcut  (all periodic images)
+                 + (4*pi*f/V) * sum_{k!=0} { exp(-k^2/(4*beta^2))/k^2 * cos(k*(r_i - r_j)) }
+            A_ii += -2*beta*f/sqrt(pi)
+            This is the Ewald summation. The k = 0 term is omitted (neutralizing background).
+
+ The short-range part is stored as a neighbor list (built with the linked cells in O(N)), so every matrix-vector
+ product costs O(N * neighbors) + O(N * number_of_k_vectors). Note that the shielding correction J_ij(r) - f/r is
+ truncated at Rcut as well; it decays as 1/r^3 for the Ohno-type kernels and only as 1/r^2 for the Nishimoto-Mataga
+ ones, so Rcut should not be too short.
+*/
+
+#include <cmath>
+#include "Qeq_solver.h"
+#include "../molint/libmolint.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libmolint;
+
+/// libsolvers namespace
+namespace libsolvers{
+
+
+QeqSolver::QeqSolver(){
+/**
+  The default constructor: Ohno-Klopman kernel, the damped shifted sum with the 20 Bohr cutoff, no PBC
+*/
+
+  nat = 0;
+  kernel = 5;
+  method = 1;
+  is_periodic = 0;
+  epsilon = 1.0;
+  Rcut = 20.0;
+  alpha = 0.0;
+  ewald_tol = 1e-8;
+  ewald_beta = 0.0;
+  tol = 1e-8;
+  max_iter = 1000;
+  n_extrap = 1;
+
+  n_iter = 0;
+  is_converged = 0;
+  mu = 0.0;
+
+  volume = 0.0;
+  ew_self = 0.0;
+  beta = 0.0;
+  is_ready = 0;
+}
+
+
+void QeqSolver::set_cell(VECTOR& _t1, VECTOR& _t2, VECTOR& _t3){
+/**
+  Sets the periodic cell and turns on the periodic boundary conditions
+
+  \param[in] _t1, _t2, _t3 The cell vectors [Bohr]
+*/
+
+  t1 = _t1;  t2 = _t2;  t3 = _t3;
+
+  VECTOR g;
+  g.cross(t2,t3);   volume = t1*g;
+
+  if(fabs(volume)<1e-10){
+    cout<<"Error in QeqSolver::set_cell: the cell vectors are linearly dependent\n"; exit(0);
+  }
+
+  g.cross(t2,t3);   g1 = g/volume;
+  g.cross(t3,t1);   g2 = g/volume;
+  g.cross(t1,t2);   g3 = g/volume;
+
+  volume = fabs(volume);
+  is_periodic = 1;
+  is_ready = 0;
+}
+
+
+void QeqSolver::reset(){
+/**
+  Forgets the previous solutions, so the next solve starts from the Jacobi guess
+*/
+
+  q_hist.clear();
+}
+
+
+double QeqSolver::lr_factor(){
+/**
+  The prefactor of the long-range tail f/r of the selected Coulomb kernel: f = lim r*J_ij(r) for r -> infinity
+*/
+
+  if(kernel==1){ return 1.0/epsilon; }   // 1/(epsilon*r)
+  if(kernel==3){ return 1.2; }           // 1.2/(r + 2*1.2/(J_i + J_j))
+
+  return 1.0;
+}
+
+
+double QeqSolver::kernel_value(int i, int j, double r){
+/**
+  The two-center Coulomb integral J_ij(r) [Ha] for the atoms i and j at the distance r [Bohr]
+*/
+
+  if(kernel==0){
+    return Coulomb_Integral(r, n[i], J[i], ksi[i], type[i], qref[i], n[j], J[j], ksi[j], type[j], qref[j], epsilon, kernel);
+  }
+
+  return Coulomb_Integral(r, 0, J[i], 0.0, "", 0.0, 0, J[j], 0.0, "", 0.0, epsilon, kernel);
+}
+
+
+
+void QeqSolver::set_system(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J){
+/**
+  Sets up the geometry and the atomic parameters, and prepares the kernel for the matrix-vector products
+
+  \param[in] _R The coordinates of the atoms [Bohr]
+  \param[in] _chi The electronegativities [Ha]
+  \param[in] _J The hardnesses [Ha]
+
+  The kernel and the summation parameters (kernel, method, Rcut, ...) should be set before calling this function.
+  The Slater-type kernel 0 needs more parameters - use the version below.
+*/
+
+  if(kernel==0){
+    cout<<"Error in QeqSolver::set_system: the kernel 0 needs the Slater parameters - use the extended version\n";
+    exit(0);
+  }
+
+  vector<double> _ksi;
+  vector<int> _n;
+  vector<std::string> _type;
+  vector<double> _q;
+
+  set_system(_R, _chi, _J, _ksi, _n, _type, _q);
+}
+
+
+void QeqSolver::set_system(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J,
+                           vector<double>& _ksi, vector<int>& _n, vector<std::string>& _type, vector<double>& _q){
+/**
+  Sets up the geometry and the atomic parameters, and prepares the kernel for the matrix-vector products
+
+  \param[in] _R The coordinates of the atoms [Bohr]
+  \param[in] _chi The electronegativities [Ha]
+  \param[in] _J The hardnesses [Ha]
+  \param[in] _ksi The Slater exponents [1/Bohr] (only needed for the kernel 0)
+  \param[in] _n The principal quantum numbers (only needed for the kernel 0)
+  \param[in] _type The element names (only needed for the kernel 0)
+  \param[in] _q The current charges (only needed for the kernel 0, in which the H-H integrals depend on them)
+*/
+
+  int sz = _R.size();
+
+  if(sz==0){
+    cout<<"Error in QeqSolver::set_system: the system has no atoms\n"; exit(0);
+  }
+  if(_chi.size()!=sz || _J.size()!=sz){
+    cout<<"Error in QeqSolver::set_system: the sizes of R, chi and J should be the same\n"; exit(0);
+  }
+  if(kernel==0){
+    if(_ksi.size()!=sz || _n.size()!=sz || _type.size()!=sz || _q.size()!=sz){
+      cout<<"Error in QeqSolver::set_system: the sizes of ksi, n, type and q should be equal to the number of atoms\n";
+      exit(0);
+    }
+  }
+  if(kernel<0 || kernel>7){
+    cout<<"Error in QeqSolver::set_system: the kernel should be in the range 0 to 7\n"; exit(0);
+  }
+  if(method<0 || method>2){
+    cout<<"Error in QeqSolver::set_system: the method should be 0, 1 or 2\n"; exit(0);
+  }
+  if(method==0 && is_periodic){
+    cout<<"Error in QeqSolver::set_system: the method 0 (all pairs) can not be used with the PBC\n"; exit(0);
+  }
+  if(method==2 && !is_periodic){
+    cout<<"Error in QeqSolver::set_system: the method 2 (Ewald) needs the periodic cell - call set_cell first\n"; exit(0);
+  }
+  if(method>0 && Rcut<=0.0){
+    cout<<"Error in QeqSolver::set_system: Rcut should be positive\n"; exit(0);
+  }
+
+  if(sz!=nat){ reset(); }
+
+  nat = sz;
+  R = _R;
+  chi = _chi;
+  J = _J;
+  ksi = _ksi;
+  n = _n;
+  type = _type;
+  qref = _q;
+
+  diag = vector<double>(nat, 0.0);
+  diag0 = vector<double>(nat, 0.0);
+  ew_coef.clear();  ew_cos.clear();  ew_sin.clear();
+  ew_self = 0.0;
+
+  if(method==0){
+    diag = J;
+    diag0 = J;
+  }
+  else{
+    build_pairs();
+    if(method==2){  build_ewald();  }
+  }
+
+  for(int i=0;i<nat;i++){
+    if(diag[i]<=0.0){
+      cout<<"Error in QeqSolver::set_system: the diagonal element A_ii = "<<diag[i]<<" of the atom "<<i
+          <<" is not positive\n"; exit(0);
+    }
+  }
+
+  is_ready = 1;
+}
+
+
+
+void QeqSolver::build_pairs(){
+/**
+  Builds the full neighbor list of all the atoms (and their periodic images) within Rcut, and the
+  real-space kernel values for these pairs. The linked-cell algorithm is used.
+*/
+
+  if(nat==0){
+    cout<<"Error in QeqSolver::build_pairs: the system has no atoms\n"; exit(0);
+  }
+
+  int i, j, a;
+  double f = lr_factor();
+  double Rcut2 = Rcut*Rcut;
+  double damp = (method==1) ? alpha : 0.0;
+  double shift = 0.0;
+
+  if(method==1){  shift = f*std::erfc(alpha*Rcut)/Rcut;  }
+  else{  beta = (ewald_beta>0.0) ? ewald_beta : sqrt(-log(ewald_tol))/Rcut;  damp = beta;  }
+
+
+  // Fold the atoms into the cell and assign them to the sub-cells
+  vector<VECTOR> r(nat);
+  vector<int> bin(3*nat);
+  int nb[3], span[3];
+
+  if(is_periodic){
+    VECTOR g[3] = {g1, g2, g3};
+    vector<double> s(3*nat);
+
+    for(a=0;a<3;a++){
+      double d = 1.0/g[a].length();   // the distance between the lattice planes
+      nb[a] = std::max(1, std::min(64, int(floor(d/Rcut))));
+      span[a] = int(ceil(Rcut*nb[a]/d));
+    }
+
+    for(i=0;i<nat;i++){
+      for(a=0;a<3;a++){
+        double x = g[a]*R[i];
+        x -= floor(x);
+        s[3*i+a] = x;
+        bin[3*i+a] = std::min(nb[a]-1, int(floor(x*nb[a])));
+      }
+      r[i] = s[3*i]*t1 + s[3*i+1]*t2 + s[3*i+2]*t3;
+    }
+  }
+  else{
+    VECTOR rmin, rmax;  rmin = rmax = R[0];
+    for(i=0;i<nat;i++){
+      r[i] = R[i];
+      if(R[i].x<rmin.x){ rmin.x = R[i].x; }  if(R[i].x>rmax.x){ rmax.x = R[i].x; }
+      if(R[i].y<rmin.y){ rmin.y = R[i].y; }  if(R[i].y>rmax.y){ rmax.y = R[i].y; }
+      if(R[i].z<rmin.z){ rmin.z = R[i].z; }  if(R[i].z>rmax.z){ rmax.z = R[i].z; }
+    }
+
+    double lo[3] = {rmin.x, rmin.y, rmin.z};
+    double L[3] = {rmax.x-rmin.x, rmax.y-rmin.y, rmax.z-rmin.z};
+    double w[3];
+
+    for(a=0;a<3;a++){
+      w[a] = std::max(Rcut, L[a]/64.0);
+      nb[a] = int(floor(L[a]/w[a])) + 1;
+      span[a] = 1;
+    }
+    for(i=0;i<nat;i++){
+      double x[3] = {r[i].x, r[i].y, r[i].z};
+      for(a=0;a<3;a++){  bin[3*i+a] = std::min(nb[a]-1, int(floor((x[a]-lo[a])/w[a])));  }
+    }
+  }
+
+  vector< vector<int> > cell2at(nb[0]*nb[1]*nb[2]);
+  for(i=0;i<nat;i++){
+    cell2at[(bin[3*i]*nb[1] + bin[3*i+1])*nb[2] + bin[3*i+2]].push_back(i);
+  }
+
+
+  // Collect the pairs
+  nb_start = vector<int>(nat+1, 0);
+  nb_j.clear();
+  nb_K.clear();
+
+  for(i=0;i<nat;i++){
+    nb_start[i] = nb_j.size();
+
+    for(int d0=-span[0]; d0<=span[0]; d0++){
+      for(int d1=-span[1]; d1<=span[1]; d1++){
+        for(int d2=-span[2]; d2<=span[2]; d2++){
+
+          int d[3] = {d0, d1, d2};
+          int c[3], img[3];
+          int is_out = 0;
+
+          for(a=0;a<3;a++){
+            int u = bin[3*i+a] + d[a];
+            if(is_periodic){
+              img[a] = (int)floor(double(u)/double(nb[a]));
+              c[a] = u - img[a]*nb[a];
+            }
+            else{
+              img[a] = 0;
+              c[a] = u;
+              if(u<0 || u>=nb[a]){ is_out = 1; }
+            }
+          }
+          if(is_out){ continue; }
+
+          VECTOR T;  T = 0.0;
+          if(is_periodic){  T = img[0]*t1 + img[1]*t2 + img[2]*t3;  }
+          int is_central = (img[0]==0 && img[1]==0 && img[2]==0);
+
+          vector<int>& atoms = cell2at[(c[0]*nb[1] + c[1])*nb[2] + c[2]];
+
+          for(int k=0;k<atoms.size();k++){
+            j = atoms[k];
+            if(j==i && is_central){ continue; }
+
+            VECTOR dR;  dR = r[j] + T - r[i];
+            double r2 = dR.length2();
+            if(r2>Rcut2){ continue; }
+
+            double rij = sqrt(r2);
+            if(rij<1e-8){
+              cout<<"Error in QeqSolver::build_pairs: the atoms "<<i<<" and "<<j<<" overlap\n"; exit(0);
+            }
+
+            double K = kernel_value(i, j, rij) - f/rij + f*std::erfc(damp*rij)/rij - shift;
+
+            nb_j.push_back(j);
+            nb_K.push_back(K);
+
+            if(j==i){  diag[i] += K;  }  // the interaction with own periodic images
+          }// for k
+
+        }// for d2
+      }// for d1
+    }// for d0
+
+  }// for i
+  nb_start[nat] = nb_j.size();
+
+
+  // The diagonal: the hardness and the self-interaction corrections
+  double dself = 0.0;
+  if(method==1){  dself = -f*(std::erfc(alpha*Rcut)/Rcut + 2.0*alpha/sqrt(M_PI));  }
+  else{  dself = -2.0*beta*f/sqrt(M_PI);  }
+
+  for(i=0;i<nat;i++){
+    diag0[i] = J[i] + dself;
+    diag[i] += diag0[i];
+  }
+
+}
+
+
+
+void QeqSolver::build_ewald(){
+/**
+  Sets up the reciprocal-space part of the Ewald sum: the k-vectors with |k| < 2*beta*sqrt(-ln(ewald_tol)),
+  and cos(k*r_i), sin(k*r_i) for all the atoms. Only a half of the k-space is used, since the terms for k and -k
+  are the same.
+*/
+
+  if(ewald_tol<=0.0 || ewald_tol>=1.0){
+    cout<<"Error in QeqSolver::build_ewald: ewald_tol should be in the (0,1) range\n"; exit(0);
+  }
+
+  int i, k;
+  double f = lr_factor();
+  double kcut = 2.0*beta*sqrt(-log(ewald_tol));
+  double kcut2 = kcut*kcut;
+
+  int hmax1 = int(ceil(kcut*t1.length()/(2.0*M_PI)));
+  int hmax2 = int(ceil(kcut*t2.length()/(2.0*M_PI)));
+  int hmax3 = int(ceil(kcut*t3.length()/(2.0*M_PI)));
+
+  vector<VECTOR> kvec;
+  ew_coef.clear();
+
+  for(int h1=0; h1<=hmax1; h1++){
+    for(int h2=-hmax2; h2<=hmax2; h2++){
+      for(int h3=-hmax3; h3<=hmax3; h3++){
+
+        // half of the k-space
+        if(h1==0 && (h2<0 || (h2==0 && h3<=0))){ continue; }
+
+        VECTOR kv;  kv = 2.0*M_PI*(h1*g1 + h2*g2 + h3*g3);
+        double k2 = kv.length2();
+        if(k2>kcut2){ continue; }
+
+        kvec.push_back(kv);
+        ew_coef.push_back( 2.0*(4.0*M_PI*f/volume)*exp(-0.25*k2/(beta*beta))/k2 );
+      }
+    }
+  }
+
+  int nk = kvec.size();
+  ew_cos = vector<double>(nat*nk, 0.0);
+  ew_sin = vector<double>(nat*nk, 0.0);
+
+  ew_self = 0.0;
+  for(k=0;k<nk;k++){  ew_self += ew_coef[k];  }
+
+  for(i=0;i<nat;i++){
+    for(k=0;k<nk;k++){
+      double kr = kvec[k]*R[i];
+      ew_cos[i*nk+k] = cos(kr);
+      ew_sin[i*nk+k] = sin(kr);
+    }
+    diag[i] += ew_self;
+  }
+
+}
+
+
+
+void QeqSolver::apply(vector<double>& x, vector<double>& Ax){
+/**
+  Computes the product Ax = A * x without forming the matrix A
+
+  \param[in] x The input vector - nat elements
+  \param[out] Ax The result - nat elements
+*/
+
+  if(!is_ready){
+    cout<<"Error in QeqSolver::apply: the system is not set up - call set_system first\n"; exit(0);
+  }
+  if(x.size()!=nat){
+    cout<<"Error in QeqSolver::apply: the size of x should be "<<nat<<"\n"; exit(0);
+  }
+
+  int i, j, k;
+  Ax = vector<double>(nat, 0.0);
+
+  if(method==0){
+    for(i=0;i<nat;i++){
+      double sum = J[i]*x[i];
+      for(j=0;j<nat;j++){
+        if(j==i){ continue; }
+        sum += kernel_value(i, j, (R[i]-R[j]).length()) * x[j];
+      }
+      Ax[i] = sum;
+    }
+    return;
+  }
+
+
+  // Real space: the own periodic images of the atom are in its neighbor list
+  int nk = ew_coef.size();
+  for(i=0;i<nat;i++){
+    double sum = diag0[i]*x[i];
+    for(k=nb_start[i]; k<nb_start[i+1]; k++){  sum += nb_K[k] * x[nb_j[k]];  }
+    Ax[i] = sum;
+  }
+
+  // Reciprocal space
+  if(nk>0){
+    vector<double> C(nk, 0.0), S(nk, 0.0);
+
+    for(i=0;i<nat;i++){
+      for(k=0;k<nk;k++){
+        C[k] += x[i]*ew_cos[i*nk+k];
+        S[k] += x[i]*ew_sin[i*nk+k];
+      }
+    }
+    for(k=0;k<nk;k++){  C[k] *= ew_coef[k];  S[k] *= ew_coef[k];  }
+
+    for(i=0;i<nat;i++){
+      double sum = 0.0;
+      for(k=0;k<nk;k++){  sum += ew_cos[i*nk+k]*C[k] + ew_sin[i*nk+k]*S[k];  }
+      Ax[i] += sum;
+    }
+  }
+
+}
+
+
+
+void QeqSolver::precondition(vector<double>& r, vector<double>& z){
+/**
+  The Jacobi preconditioner restricted to the plane sum(z) = 0:
+
+  z = D^-1 * r - D^-1 * 1 * sum(D^-1 * r) / sum(D^-1 * 1),   D = diag(A)
+*/
+
+  double sz = 0.0, sw = 0.0;
+  z = vector<double>(nat, 0.0);
+
+  for(int i=0;i<nat;i++){
+    z[i] = r[i]/diag[i];
+    sz += z[i];
+    sw += 1.0/diag[i];
+  }
+  for(int i=0;i<nat;i++){  z[i] -= (sz/sw)/diag[i];  }
+
+}
+
+
+int QeqSolver::cg(double Qtot, vector<double>& q){
+/**
+  Solves chi + A * q = mu, sum(q) = Qtot by the projected preconditioned conjugate gradient method
+
+  \param[in] Qtot The total charge
+  \param[in,out] q The initial guess on input (the total charge is corrected if needed), the solution on output
+
+  Returns the number of iterations. The equalized electronegativity is stored in mu. If the convergence is
+  not reached in max_iter iterations, the is_converged flag is set to 0.
+*/
+
+  int i;
+  vector<double> r(nat), z, p(nat), Aq, Ap;
+
+  // Put the initial guess onto the constraint plane
+  double sq = 0.0, sw = 0.0;
+  for(i=0;i<nat;i++){  sq += q[i];  sw += 1.0/diag[i];  }
+  for(i=0;i<nat;i++){  q[i] += ((Qtot - sq)/sw)/diag[i];  }
+
+  // The residual r = -(chi + A*q); at the solution it is -mu for all atoms
+  apply(q, Aq);
+  for(i=0;i<nat;i++){  r[i] = -chi[i] - Aq[i];  }
+
+  precondition(r, z);
+  p = z;
+
+  // r^T * z is computed as z^T * D * z: the two are equal, but the former suffers from the cancellation of
+  // the large constant part of r (which is -mu), and the CG stagnates
+  double rz = 0.0;
+  for(i=0;i<nat;i++){  rz += diag[i]*z[i]*z[i];  }
+
+  is_converged = 0;
+  int iter = 0;
+
+  while(1){
+
+    // The spread of the electronegativities
+    double rmean = 0.0, dev = 0.0;
+    for(i=0;i<nat;i++){  rmean += r[i];  }
+    rmean /= double(nat);
+    for(i=0;i<nat;i++){  dev += (r[i]-rmean)*(r[i]-rmean);  }
+    dev = sqrt(dev/double(nat));
+
+    mu = -rmean;
+
+    if(dev<=tol){ is_converged = 1; break; }
+    if(iter>=max_iter){ break; }
+
+    apply(p, Ap);
+
+    double pAp = 0.0;
+    for(i=0;i<nat;i++){  pAp += p[i]*Ap[i];  }
+
+    if(pAp<=0.0){
+      cout<<"Error in QeqSolver::cg: the matrix is not positive definite on the plane of the constant total charge\n";
+      exit(0);
+    }
+
+    double a = rz/pAp;
+    for(i=0;i<nat;i++){
+      q[i] += a*p[i];
+      r[i] -= a*Ap[i];
+    }
+
+    precondition(r, z);
+
+    double rz_new = 0.0;
+    for(i=0;i<nat;i++){  rz_new += diag[i]*z[i]*z[i];  }
+
+    double bt = rz_new/rz;
+    rz = rz_new;
+    for(i=0;i<nat;i++){  p[i] = z[i] + bt*p[i];  }
+
+    iter++;
+  }
+
+  return iter;
+}
+
+
+
+void QeqSolver::guess(double Qtot, vector<double>& q){
+/**
+  The initial guess for the charges: the polynomial extrapolation of the previous solutions (if available),
+  otherwise the Jacobi guess q = -chi / diag(A). The total charge is fixed in the CG.
+*/
+
+  int sz = q_hist.size();
+  int i;
+
+  q = vector<double>(nat, 0.0);
+
+  if(n_extrap<0 || sz==0){
+    for(i=0;i<nat;i++){  q[i] = -chi[i]/diag[i];  }
+    return;
+  }
+
+  int order = std::min(n_extrap, sz-1);
+
+  if(order==0){  q = q_hist[sz-1];  }
+  else if(order==1){
+    for(i=0;i<nat;i++){  q[i] = 2.0*q_hist[sz-1][i] - q_hist[sz-2][i];  }
+  }
+  else{
+    for(i=0;i<nat;i++){  q[i] = 3.0*q_hist[sz-1][i] - 3.0*q_hist[sz-2][i] + q_hist[sz-3][i];  }
+  }
+
+}
+
+
+void QeqSolver::push_history(vector<double>& q){
+/**
+  Stores the solution for the warm start of the following calls
+*/
+
+  if(n_extrap<0){ return; }
+
+  q_hist.push_back(q);
+  while(q_hist.size() > std::min(n_extrap, 2) + 1){  q_hist.erase(q_hist.begin());  }
+
+}
+
+
+
+double QeqSolver::solve(double Qtot, vector<double>& q){
+/**
+  Computes the equilibrated charges for the system defined in the last set_system call
+
+  \param[in] Qtot The total charge of the system
+  \param[out] q The charges
+
+  Returns the equalized electronegativity mu [Ha]: chi_i + sum_j { A_ij * q_j } = mu for all i
+*/
+
+  if(!is_ready){
+    cout<<"Error in QeqSolver::solve: the system is not set up - call set_system first\n"; exit(0);
+  }
+
+  guess(Qtot, q);
+  n_iter = cg(Qtot, q);
+  push_history(q);
+
+  return mu;
+}
+
+
+double QeqSolver::solve(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J, double Qtot, vector<double>& q){
+/**
+  Same as above, but sets up the system first. This is the version to call at every MD step: the solutions
+  of the previous steps are used as the initial guess.
+
+  \param[in] _R The coordinates of the atoms [Bohr]
+  \param[in] _chi The electronegativities [Ha]
+  \param[in] _J The hardnesses [Ha]
+  \param[in] Qtot The total charge of the system
+  \param[out] q The charges
+*/
+
+  set_system(_R, _chi, _J);
+  return solve(Qtot, q);
+}
+
+
+
+double QeqSolver::energy(vector<double>& q){
+/**
+  The electrostatic energy of the charges q [Ha]: E = sum_i { chi_i * q_i } + 1/2 * sum_ij { q_i * A_ij * q_j }
+*/
+
+  vector<double> Aq;
+  apply(q, Aq);
+
+  double E = 0.0;
+  for(int i=0;i<nat;i++){  E += chi[i]*q[i] + 0.5*q[i]*Aq[i];  }
+
+  return E;
+}
+
+
+MATRIX QeqSolver::dense_matrix(){
+/**
+  Returns the matrix A, obtained column-by-column from the matrix-vector products - for testing and
+  small systems only
+*/
+
+  MATRIX A(nat, nat);
+  vector<double> x(nat, 0.0), Ax;
+
+  for(int j=0;j<nat;j++){
+    x[j] = 1.0;
+    apply(x, Ax);
+    for(int i=0;i<nat;i++){  A.set(i, j, Ax[i]);  }
+    x[j] = 0.0;
+  }
+
+  return A;
+}
+
+
+
+}// namespace libsolvers
+}// liblibra
+
@@ -0,0 +1,137 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+ \file Qeq_solver.h
+ \brief The file describes the matrix-free charge equilibration (Qeq) solver
+
+*/
+
+
+#ifndef QEQ_SOLVER_H
+#define QEQ_SOLVER_H
+
+#include <boost/python.hpp>
+#include <boost/python/suite/indexing/vector_indexing_suite.hpp>
+#include "../math_linalg/liblinalg.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace boost::python;
+using namespace liblinalg;
+
+
+/// libsolvers namespace
+namespace libsolvers{
+
+
+class QeqSolver{
+/**
+  This is the class that solves the charge equilibration (Qeq) problem:
+
+  min_q  E(q) = sum_i { chi_i * q_i } + 1/2 * sum_ij { q_i * A_ij * q_j },   subject to  sum_i { q_i } = Qtot
+
+  with A_ii = J_i (the atomic hardness) and A_ij = J_ij(R_ij) (the shielded Coulomb interaction). The matrix A
+  is never formed: it is only applied to vectors. The stationarity condition chi + A*q = mu (mu is the equalized
+  electronegativity) is solved by the conjugate gradient (CG) method projected onto the plane sum(q) = Qtot,
+  with the Jacobi preconditioner. The projection matters: the uniform (non-neutral) mode of the shielded
+  periodic kernels is not well defined, but it never enters the constrained problem.
+
+  The charges of the previous calls are kept and extrapolated to the current geometry to provide the initial
+  guess for the CG (the extended-Lagrangian-style warm start), so in MD only a few CG iterations are needed
+  per step.
+
+  All quantities are in atomic units: R in Bohr, chi and J in Ha.
+*/
+
+  int nat;                     ///< the number of atoms
+  vector<VECTOR> R;            ///< the coordinates of atoms [Bohr]
+  vector<double> chi;          ///< the electronegativities [Ha]
+  vector<double> J;            ///< the hardnesses (idempotentials) [Ha]
+  vector<double> ksi;          ///< the Slater exponents (only for kernel 0)
+  vector<int> n;               ///< the principal quantum numbers (only for kernel 0)
+  vector<std::string> type;    ///< the element names (only for kernel 0)
+  vector<double> qref;         ///< the charges for the charge-dependent kernel 0
+
+  VECTOR t1, t2, t3;           ///< the periodic cell vectors [Bohr]
+  VECTOR g1, g2, g3;           ///< the reciprocal vectors: g_a * t_b = delta_ab (no 2*pi factor)
+  double volume;               ///< the cell volume [Bohr^3]
+
+  // The short-range (real-space) part of A: the full neighbor list in the CSR format
+  vector<int> nb_start;        ///< the neighbors of atom i are nb_j[nb_start[i] ... nb_start[i+1]-1]
+  vector<int> nb_j;            ///< the indices of the neighbors
+  vector<double> nb_K;         ///< the kernel values for the neighbor pairs (the images are separate entries)
+  vector<double> diag0;        ///< the hardness plus the self-interaction correction of the summation method
+  vector<double> diag;         ///< the full diagonal of A (used as the preconditioner)
+
+  // The reciprocal-space part of A (for the Ewald method)
+  vector<double> ew_coef;      ///< the prefactors of the k-vectors (half of the k-space)
+  vector<double> ew_cos;       ///< cos(k*r_i): ew_cos[i*nk + k]
+  vector<double> ew_sin;       ///< sin(k*r_i): ew_sin[i*nk + k]
+  double ew_self;              ///< the diagonal correction of the Ewald sum
+  double beta;                 ///< the Ewald splitting parameter actually used [1/Bohr]
+
+  vector< vector<double> > q_hist;  ///< the charges from the previous calls, the latest is the last
+
+  int is_ready;                ///< the flag telling if the kernel has been set up for the current geometry
+
+  double kernel_value(int i, int j, double r);
+  double lr_factor();
+  void build_pairs();
+  void build_ewald();
+  void precondition(vector<double>& r, vector<double>& z);
+  void guess(double Qtot, vector<double>& q);
+  void push_history(vector<double>& q);
+
+public:
+
+  int kernel;         ///< the two-center Coulomb integral: the mode of libmolint::Coulomb_Integral (0 to 7)
+  int method;         ///< 0 - all pairs, no cutoff (non-periodic only); 1 - damped shifted cutoff (Wolf) sum;
+                      ///< 2 - Ewald sum (periodic only)
+  int is_periodic;    ///< 1 - use the periodic boundary conditions given by the cell vectors, 0 - no PBC
+  double epsilon;     ///< the dielectric constant (only used by kernel 1)
+  double Rcut;        ///< the real-space cutoff radius [Bohr] (methods 1 and 2)
+  double alpha;       ///< the damping parameter of the method 1 [1/Bohr]; 0 - plain shifted Coulomb
+  double ewald_tol;   ///< the target accuracy of the Ewald sum, defines the splitting and the k-space cutoff
+  double ewald_beta;  ///< the Ewald splitting parameter [1/Bohr]; if <= 0, it is defined by ewald_tol and Rcut
+  double tol;         ///< the convergence criterion of the CG: the RMS deviation of chi + A*q from mu [Ha]
+  int max_iter;       ///< the maximal number of the CG iterations
+  int n_extrap;       ///< the order of the extrapolation of the previous solutions: 0 - use the last one,
+                      ///< 1 - linear, 2 - quadratic; -1 - no warm start
+  int n_iter;         ///< the number of the CG iterations done in the last solve (output)
+  int is_converged;   ///< 1 - the CG converged in the last call (output)
+  double mu;          ///< the equalized electronegativity (the Lagrange multiplier) from the last solve (output)
+
+
+  QeqSolver();
+
+  void set_cell(VECTOR& _t1, VECTOR& _t2, VECTOR& _t3);
+  void set_system(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J);
+  void set_system(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J,
+                  vector<double>& _ksi, vector<int>& _n, vector<std::string>& _type, vector<double>& _q);
+  void reset();
+
+  void apply(vector<double>& x, vector<double>& Ax);
+  int cg(double Qtot, vector<double>& q);
+
+  double solve(double Qtot, vector<double>& q);
+  double solve(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J, double Qtot, vector<double>& q);
+
+  double energy(vector<double>& q);
+  MATRIX dense_matrix();
+
+};
+
+
+}// namespace libsolvers
+}// liblibra
+
+#endif // QEQ_SOLVER_H
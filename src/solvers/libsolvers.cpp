@@ -59,6 +59,48 @@ void export_solvers_objects(){
   ;
 
 
+
+  //----------------- Qeq_solver.cpp ------------------------------
+
+  void (QeqSolver::*expt_set_system_v1)(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J) = &QeqSolver::set_system;
+  void (QeqSolver::*expt_set_system_v2)(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J,
+       vector<double>& _ksi, vector<int>& _n, vector<std::string>& _type, vector<double>& _q) = &QeqSolver::set_system;
+  double (QeqSolver::*expt_solve_v1)(double Qtot, vector<double>& q) = &QeqSolver::solve;
+  double (QeqSolver::*expt_solve_v2)(vector<VECTOR>& _R, vector<double>& _chi, vector<double>& _J,
+       double Qtot, vector<double>& q) = &QeqSolver::solve;
+
+  class_<QeqSolver>("QeqSolver",init<>())
+      .def("__copy__", &generic__copy__<QeqSolver>)
+      .def("__deepcopy__", &generic__deepcopy__<QeqSolver>)
+
+      .def("set_cell", &QeqSolver::set_cell)
+      .def("set_system", expt_set_system_v1)
+      .def("set_system", expt_set_system_v2)
+      .def("reset", &QeqSolver::reset)
+      .def("apply", &QeqSolver::apply)
+      .def("cg", &QeqSolver::cg)
+      .def("solve", expt_solve_v1)
+      .def("solve", expt_solve_v2)
+      .def("energy", &QeqSolver::energy)
+      .def("dense_matrix", &QeqSolver::dense_matrix)
+
+      .def_readwrite("kernel",&QeqSolver::kernel)
+      .def_readwrite("method",&QeqSolver::method)
+      .def_readwrite("is_periodic",&QeqSolver::is_periodic)
+      .def_readwrite("epsilon",&QeqSolver::epsilon)
+      .def_readwrite("Rcut",&QeqSolver::Rcut)
+      .def_readwrite("alpha",&QeqSolver::alpha)
+      .def_readwrite("ewald_tol",&QeqSolver::ewald_tol)
+      .def_readwrite("ewald_beta",&QeqSolver::ewald_beta)
+      .def_readwrite("tol",&QeqSolver::tol)
+      .def_readwrite("max_iter",&QeqSolver::max_iter)
+      .def_readwrite("n_extrap",&QeqSolver::n_extrap)
+      .def_readwrite("n_iter",&QeqSolver::n_iter)
+      .def_readwrite("is_converged",&QeqSolver::is_converged)
+      .def_readwrite("mu",&QeqSolver::mu)
+  ;
+
+
 }// export_solvers_objects()
 
 
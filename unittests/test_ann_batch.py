@@ -0,0 +1,111 @@
+#*********************************************************************************  
+#* Copyright (C) 2018 Alexey V. Akimov 
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version. 
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>. 
+#* 
+#*********************************************************************************/
+"""
+ The minibatch training of the ANN: the batched propagation must agree with the
+ single-pattern one, and the SGD and Adam training must reduce the error
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class patt():
+    pass
+
+
+def _training_set(npat):
+    """y = sin(2*x) on [-1, 1]"""
+
+    res = []
+    for i in range(npat):
+        x = -1.0 + 2.0*i/(npat-1)
+        p = patt()
+        p.Input = [x]
+        p.Output = [math.sin(2.0*x)]
+        p.Derivs = [2.0*math.cos(2.0*x)]
+        res.append(p)
+    return res
+
+
+def _make_ann(topology, method):
+
+    ann = NeuralNetwork()
+    ann.CreateANN(topology)
+    ann.SetTrainingData(_training_set(40), 1)
+    ann.NormalizeAndScaleTrainingData(1, 1, [-0.9, -0.9], [0.9, 0.9])
+    ann.set({"learning_method":method, "learning_rate":0.01, "epoch_size":8,
+             "momentum_term":0.5, "iterations_in_cycle":500})
+    return ann
+
+
+class TestANNBatch(unittest.TestCase):
+
+    def test_batch_propagation(self):
+        """PropagateBatch gives the same outputs as Propagate, pattern by pattern"""
+
+        ann = _make_ann([1, 6, 1], "Adam")
+        ann.ANNTrainBatch()
+
+        npat = 7
+        X = MATRIX(1, npat)
+        for i in range(npat):
+            X.set(0, i, -0.9 + 0.3*i)
+        Y = MATRIX(1, npat)
+        ann.PropagateBatch(X, Y)
+
+        for i in range(npat):
+            x = MATRIX(1,1);  x.set(0, 0, X.get(0, i))
+            y = MATRIX(1,1)
+            ann.Propagate(x, y)
+            self.assertAlmostEqual(Y.get(0, i), y.get(0, 0), 10)
+
+    def test_training(self):
+        """Several cycles of the SGD and Adam training reduce the error"""
+
+        for method in ["SGD", "Adam"]:
+            ann = _make_ann([1, 8, 1], method)
+            err0 = ann.ANNTrainBatch()
+            err = err0
+            for cycle in range(10):
+                err = ann.ANNTrainBatch()
+            print("%s: error after the first cycle = %g, after 11 cycles = %g" % (method, err0, err))
+            self.assertTrue(err < 0.5*err0)
+
+    def test_new_topology(self):
+        """The Adam moments are rebuilt when the network of the same depth changes its shape"""
+
+        ann = _make_ann([1, 8, 1], "Adam")
+        ann.ANNTrainBatch()
+        ann.ExportANN("_ann_batch_test.txt")
+
+        small = _make_ann([1, 3, 1], "Adam")
+        small.ANNTrainBatch()
+
+        # The same object now gets the wider network of the file
+        small.ImportANN("_ann_batch_test.txt")
+        small.ClearTrainingData()
+        small.SetTrainingData(_training_set(40), 1)
+        small.NormalizeAndScaleTrainingData(1, 1, [-0.9, -0.9], [0.9, 0.9])
+        err = small.ANNTrainBatch()
+        os.remove("_ann_batch_test.txt")
+
+        self.assertTrue(err==err and err < 1.0)
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,79 @@
+#*********************************************************************************  
+#* Copyright (C) 2018 Alexey V. Akimov 
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version. 
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>. 
+#* 
+#*********************************************************************************/
+"""
+ The conjugate gradient minimizer must recover when the line search along the conjugate
+ direction fails: the steepest descent retry starts from the scaled-gradient trial step,
+ not from the zero step of the failed search
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def rotated_gradient(x, params):
+    """
+    f = 1/2 * (a^2 + k * b^2)
+
+    The returned gradient is the true one plus c times the true one rotated by 90 degrees:
+    the steepest descent is still a descent direction, but the conjugate directions built
+    from such gradients may not be, so the strong Wolfe search along them fails
+    """
+
+    k, c = params["k"], params["c"]
+    a, b = x.get(0), x.get(1)
+
+    ga, gb = a, k*b
+
+    grd = MATRIX(2,1)
+    grd.set(0, ga - c*gb)
+    grd.set(1, gb + c*ga)
+
+    return [0.5*(a*a + k*b*b), grd]
+
+
+class TestCGRetry(unittest.TestCase):
+
+    def test_first_cg_direction_fails(self):
+        """For this start the line search along the very first conjugate direction fails"""
+
+        obj = PyObjective(rotated_gradient, {"k":100.0, "c":1.0}, 2)
+
+        x0 = MATRIX(2,1);  x0.set(0, 1.0);  x0.set(1, 1.0)
+        res = conjugate_gradient(obj, x0, 1e-8, 200)
+
+        print("nsteps = %i nevals = %i f = %g" % (res.nsteps, res.nevals, res.f))
+        self.assertEqual(res.converged, 1)
+        self.assertTrue(res.nsteps > 2)
+        self.assertAlmostEqual(res.x.get(0), 0.0, 6)
+        self.assertAlmostEqual(res.x.get(1), 0.0, 6)
+
+
+    def test_repeated_retries(self):
+        """Several retries along the run"""
+
+        obj = PyObjective(rotated_gradient, {"k":25.0, "c":2.0}, 2)
+
+        x0 = MATRIX(2,1);  x0.set(0, 1.0);  x0.set(1, -1.0)
+        res = conjugate_gradient(obj, x0, 1e-8, 200)
+
+        self.assertEqual(res.converged, 1)
+        self.assertTrue(res.f < 1e-12)
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,208 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The checkpoint/restart of the dynamics state: a run interrupted after k steps, saved,
+ restored into fresh objects and continued for N - k steps must reproduce the uninterrupted
+ N-step run bitwise - the coordinates, momenta, electronic amplitudes, Nose-Hoover chain
+ variables and the following random numbers
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class tmp:
+    pass
+
+
+def model(q, params, full_id):
+    """
+    2 diabatic states, 2 DOFs:  H00 = 1/2 * k * |q|^2,  H11 = 1/2 * k * |q - x0|^2 + dE,  H01 = V
+    for the trajectory full_id[-1]
+    """
+
+    indx = Cpp2Py(full_id)[-1]
+    k, x0, dE, V = params["k"], params["x0"], params["dE"], params["V"]
+
+    obj = tmp()
+    obj.ham_dia = CMATRIX(2,2)
+    obj.ovlp_dia = CMATRIX(2,2);  obj.ovlp_dia.identity()
+    obj.d1ham_dia = CMATRIXList()
+    obj.dc1_dia = CMATRIXList()
+
+    e0, e1 = 0.0, dE
+    for i in range(2):
+        x = q.get(i, indx)
+        e0 = e0 + 0.5*k*x*x
+        e1 = e1 + 0.5*k*(x - x0)*(x - x0)
+
+        d1 = CMATRIX(2,2)
+        d1.set(0, 0, k*x+0.0j)
+        d1.set(1, 1, k*(x - x0)+0.0j)
+        obj.d1ham_dia.append(d1)
+        obj.dc1_dia.append(CMATRIX(2,2))
+
+    obj.ham_dia.set(0, 0, e0+0.0j)
+    obj.ham_dia.set(1, 1, e1+0.0j)
+    obj.ham_dia.set(0, 1, V+0.0j)
+    obj.ham_dia.set(1, 0, V+0.0j)
+
+    return obj
+
+
+params = {"k":0.01, "x0":0.5, "dE":0.01, "V":0.002}
+ndof, ntraj, dt = 2, 2, 10.0
+
+
+class State:
+    """The dynamical variables of the run, created fresh for every run"""
+
+    def __init__(self):
+        self.q = MATRIX(ndof, ntraj)
+        self.p = MATRIX(ndof, ntraj)
+        self.C = [CMATRIX(2,1) for tr in range(ntraj)]
+
+        self.therm = Thermostat({"thermostat_type":"Nose-Hoover", "Temperature":300.0, "NHC_size":3, "nu_therm":0.01})
+        self.therm.set_Nf_t(ndof*ntraj)
+        self.therm.set_Nf_r(0)
+        self.therm.init_nhc()
+
+        self.rnd = Random(12345)
+
+        self.ham = nHamiltonian(2, 2, ndof)
+        self.ham.init_all(2)
+        self.children = []
+        for tr in range(ntraj):
+            self.children.append( nHamiltonian(2, 2, ndof) )
+            self.children[tr].init_all(2)
+            self.ham.add_child(self.children[tr])
+
+
+    def start(self):
+        for tr in range(ntraj):
+            self.q.set(0, tr, 0.3 - 0.2*tr);  self.q.set(1, tr, -0.1*tr)
+            self.C[tr].set(0, 0, 1.0+0.0j)
+        self.update_ham()
+
+
+    def update_ham(self):
+        self.ham.compute_diabatic(model, self.q, params, 1)
+        self.ham.compute_adiabatic(1, 1)
+
+
+    def step(self):
+        """Nose-Hoover MD on the ground state, the diabatic TD-SE, and the random momentum kicks"""
+
+        iM = MATRIX(ndof, 1)
+        for i in range(ndof):
+            iM.set(i, 0, 1.0/2000.0)
+
+        Verlet1_nvt(dt, self.q, self.p, iM, self.ham, model, params, self.therm)
+
+        for tr in range(ntraj):
+            Hdia = self.ham.get_ham_dia(Py2Cpp_int([0, tr]))
+            propagate_electronic(dt, self.C[tr], Hdia)
+            for i in range(ndof):
+                self.p.add(i, tr, 0.5*self.rnd.normal())
+
+
+    def save(self, filename):
+        w = CheckpointWriter(filename)
+        w.save(self.q)
+        w.save(self.p)
+        for tr in range(ntraj):
+            w.save(self.C[tr])
+        w.save(self.therm)
+        w.save(self.rnd)
+        w.save(self.ham)
+        w.close()
+
+
+    def load(self, filename):
+        r = CheckpointReader(filename)
+        r.load(self.q)
+        r.load(self.p)
+        for tr in range(ntraj):
+            r.load(self.C[tr])
+        r.load(self.therm)
+        r.load(self.rnd)
+        r.load(self.ham)
+
+
+
+class TestCheckpoint(unittest.TestCase):
+
+    def test_bitwise_restart(self):
+        N, k = 200, 70
+        filename = "_test_checkpoint.bin"
+
+        # The uninterrupted run
+        ref = State()
+        ref.start()
+        for step in range(N):
+            ref.step()
+
+        # The run interrupted after k steps
+        run1 = State()
+        run1.start()
+        for step in range(k):
+            run1.step()
+        run1.save(filename)
+
+        # ... and continued in fresh objects
+        run2 = State()
+        run2.rnd = Random(999)
+        run2.load(filename)
+        for step in range(k, N):
+            run2.step()
+
+        os.remove(filename)
+
+        for tr in range(ntraj):
+            for i in range(ndof):
+                self.assertEqual(ref.q.get(i, tr), run2.q.get(i, tr))
+                self.assertEqual(ref.p.get(i, tr), run2.p.get(i, tr))
+            for i in range(2):
+                self.assertEqual(ref.C[tr].get(i, 0), run2.C[tr].get(i, 0))
+
+        for i in range(3):
+            self.assertEqual(ref.therm.s_t[i], run2.therm.s_t[i])
+            self.assertEqual(ref.therm.ksi_t[i], run2.therm.ksi_t[i])
+            self.assertEqual(ref.therm.G_t[i], run2.therm.G_t[i])
+
+        for i in range(5):
+            self.assertEqual(ref.rnd.uniform(0.0, 1.0), run2.rnd.uniform(0.0, 1.0))
+            self.assertEqual(ref.rnd.normal(), run2.rnd.normal())
+
+
+    def test_default_seed(self):
+        """Random() uses a fixed default seed: separate runs get the same sequences"""
+
+        cmd = sys.executable + " -c \"from liblibra_core import *; r1 = Random(); r2 = Random(); "
+        cmd = cmd + "print(r1.uniform(0.0, 1.0), r2.uniform(0.0, 1.0))\""
+
+        out1 = os.popen(cmd).read()
+        out2 = os.popen(cmd).read()
+
+        x1, x2 = out1.split()
+        self.assertEqual(out1, out2)
+        self.assertNotEqual(x1, x2)
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,207 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The Davidson CIS solver: the lowest roots and vectors of the singlet, triplet and spin-flip
+ problems must agree with the full diagonalization of the explicit CIS A matrix built from
+ the MO integrals of a small HF molecule (H6, STO-3G), and the overlaps of a set of states
+ with itself at the same geometry must give the identity
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+n = 6
+nroots = 3
+
+
+def make_molecule():
+    """The distorted H6 chain with the STO-3G basis: the AOs, the centers, S, H and the AO ERIs"""
+
+    alp = [3.42525091, 0.62391373, 0.16885540]
+    cf = [0.15432897, 0.53532814, 0.44463454]
+
+    R, aos = [], AOList()
+    for i in range(n):
+        R.append(VECTOR(0.0, (i%2)*0.3, 1.7*i + 0.2*(i%3)))
+        ao = AO()
+        for k in range(3):
+            ao.add_primitive(cf[k], PrimitiveG(0, 0, 0, alp[k], R[i]))
+        aos.append(ao)
+
+    S, H = MATRIX(n,n), MATRIX(n,n)
+    eri = [0.0]*(n*n*n*n)
+    for a in range(n):
+        for b in range(n):
+            S.set(a, b, gaussian_overlap(aos[a], aos[b]))
+            h = kinetic_integral(aos[a], aos[b])
+            for c in range(n):
+                h = h - nuclear_attraction_integral(aos[a], aos[b], R[c])
+            H.set(a, b, h)
+            for c in range(n):
+                for d in range(n):
+                    eri[((a*n+b)*n+c)*n+d] = electron_repulsion_integral(aos[a], aos[b], aos[c], aos[d])
+
+    return aos, S, H, eri
+
+
+def density(C, nocc):
+    return [[sum([C.get(m,i)*C.get(l,i) for i in range(nocc)]) for l in range(n)] for m in range(n)]
+
+
+def uhf(S, H, eri, na, nb):
+    """The UHF orbitals:  F_a = H + J[P_a + P_b] - K[P_a],  F_b = H + J[P_a + P_b] - K[P_b]"""
+
+    Ea, Ca = MATRIX(n,n), MATRIX(n,n)
+    solve_eigen(H, S, Ea, Ca, 0)
+    Eb, Cb = MATRIX(Ea), MATRIX(Ca)
+
+    e_old = None
+    for it in range(200):
+        Pa, Pb = density(Ca, na), density(Cb, nb)
+        Fa, Fb = MATRIX(H), MATRIX(H)
+        for m in range(n):
+            for nn in range(n):
+                for l in range(n):
+                    for s in range(n):
+                        v = eri[((m*n+nn)*n+l)*n+s]
+                        Fa.add(m, nn, v*(Pa[l][s] + Pb[l][s]))
+                        Fb.add(m, nn, v*(Pa[l][s] + Pb[l][s]))
+                        Fa.add(m, l, -v*Pa[nn][s])
+                        Fb.add(m, l, -v*Pb[nn][s])
+        solve_eigen(Fa, S, Ea, Ca, 0)
+        solve_eigen(Fb, S, Eb, Cb, 0)
+
+        e = [Ea.get(i,i) for i in range(n)] + [Eb.get(i,i) for i in range(n)]
+        if e_old != None and max([abs(e[i] - e_old[i]) for i in range(2*n)]) < 1e-12:
+            break
+        e_old = e
+
+    return Ea, Ca, Eb, Cb
+
+
+def mo_eri(eri, C1, C2, C3, C4):
+    """(pq|rs) = sum_{abcd} C1_ap C2_bq C3_cr C4_ds (ab|cd), by the quarter transformations"""
+
+    t = eri
+    for k, C in enumerate([C1, C2, C3, C4]):
+        st = n**(3-k)
+        t2 = [0.0]*(n**4)
+        for idx in range(n**4):
+            p = (idx // st) % n
+            base = idx - p*st
+            t2[idx] = sum([C.get(a,p)*t[base + a*st] for a in range(n)])
+        t = t2
+    return t
+
+
+class TestCIS(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        cls.aos, cls.S, cls.H, cls.eri = make_molecule()
+
+        cls.hf = HF_integrals()
+        for a in range(n):
+            for b in range(n):
+                for c in range(n):
+                    for d in range(n):
+                        cls.hf.set_JK_values(a, b, c, d, cls.eri[((a*n+b)*n+c)*n+d], cls.eri[((a*n+d)*n+c)*n+b])
+
+        cls.modprms = Model_Parameters()
+        cls.modprms.hf_int = cls.hf
+        cls.prms = Control_Parameters()
+        cls.prms.hamiltonian = "hf"
+
+
+    def run_cis(self, spin):
+        """
+        The Davidson solution and the full diagonalization of
+        A[ia,jb] = cJ * (ia|jb) - (ij|ab) + delta_ij delta_ab (e_a - e_i),  cJ = 2 for singlets, 0 otherwise
+        the occupied orbitals are alpha, the virtual ones are beta for the spin-flip (spin = 2)
+        """
+
+        na, nb = (4, 2) if spin==2 else (3, 3)
+        Ea, Ca, Eb, Cb = uhf(self.S, self.H, self.eri, na, nb)
+
+        el = Electronic_Structure(n)
+        el.Nocc_alp = na
+        el.Nocc_bet = nb
+        el.set_C_alp(Ca);  el.set_C_bet(Cb)
+        el.set_E_alp(Ea);  el.set_E_bet(Eb)
+
+        cis = CIS(el, spin, nroots, 0, 0)
+        cis.tol = 1e-7
+        cis.max_subspace = 6
+        cis.solve(System(), self.aos, self.prms, self.modprms, intMap(), intList())
+        self.assertEqual(cis.converged, 1)
+
+        Cv, Ev, v0 = (Cb, Eb, nb) if spin==2 else (Ca, Ea, na)
+        no, nv = na, n - v0
+        nov = no*nv
+        cJ = 2.0 if spin==0 else 0.0
+
+        iajb = mo_eri(self.eri, Ca, Cv, Ca, Cv)
+        ijab = mo_eri(self.eri, Ca, Ca, Cv, Cv)
+
+        A = MATRIX(nov, nov)
+        for i in range(no):
+            for a in range(nv):
+                for j in range(no):
+                    for b in range(nv):
+                        v = cJ*iajb[((i*n + v0+a)*n + j)*n + v0+b] - ijab[((i*n + j)*n + v0+a)*n + v0+b]
+                        if i==j and a==b:
+                            v = v + Ev.get(v0+a, v0+a) - Ea.get(i, i)
+                        A.set(i*nv+a, j*nv+b, v)
+
+        I, E, U = MATRIX(nov, nov), MATRIX(nov, nov), MATRIX(nov, nov)
+        I.Init_Unit_Matrix(1.0)
+        solve_eigen(A, I, E, U, 0)
+
+        for k in range(nroots):
+            ov = sum([U.get(m,k)*cis.X.get(m,k) for m in range(nov)])
+            print("spin = %i root = %i E_davidson = %12.8f E_full = %12.8f |<x|u>| = %12.8f" % (spin, k, cis.E.get(k,0), E.get(k,k), abs(ov)))
+            self.assertAlmostEqual(cis.E.get(k,0), E.get(k,k), 6)
+            self.assertAlmostEqual(abs(ov), 1.0, 5)
+
+        return cis
+
+
+    def test_singlets(self):
+        self.run_cis(0)
+
+    def test_triplets(self):
+        self.run_cis(1)
+
+    def test_spin_flip(self):
+        self.run_cis(2)
+
+
+    def test_self_overlap(self):
+        """The ground state and the CIS states overlap with themselves at the same geometry as the identity"""
+
+        for spin in [0, 1, 2]:
+            cis = self.run_cis(spin)
+            O = cis_overlaps(cis, cis, self.S)
+            for a in range(nroots+1):
+                for b in range(nroots+1):
+                    self.assertAlmostEqual(O.get(a,b), 1.0 if a==b else 0.0, 8)
+
+
+if __name__=='__main__':
+    unittest.main()
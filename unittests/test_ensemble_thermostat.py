@@ -0,0 +1,141 @@
+#*********************************************************************************  
+#* Copyright (C) 2018 Alexey V. Akimov 
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version. 
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>. 
+#* 
+#*********************************************************************************/
+"""
+ The ensemble thermostats on the harmonic oscillators: the average kinetic energy must
+ approach 1/2 * Nf * kT, and for the Nose-Hoover chains the energy of each trajectory plus
+ the energy of its bath must be conserved
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class tmp:
+    pass
+
+
+def harmonic(q, params, full_id):
+    """1 state, E = sum_i 1/2 * k_i * q_i^2 for the trajectory full_id[-1]"""
+
+    indx = Cpp2Py(full_id)[-1]
+    k = params["k"]
+    ndof = len(k)
+
+    obj = tmp()
+    obj.ham_dia = CMATRIX(1,1)
+    obj.ovlp_dia = CMATRIX(1,1);  obj.ovlp_dia.set(0, 0, 1.0+0.0j)
+    obj.d1ham_dia = CMATRIXList()
+    obj.dc1_dia = CMATRIXList()
+
+    e = 0.0
+    for i in range(ndof):
+        x = q.get(i, indx)
+        e = e + 0.5*k[i]*x*x
+        d1 = CMATRIX(1,1);  d1.set(0, 0, k[i]*x+0.0j)
+        obj.d1ham_dia.append(d1)
+        obj.dc1_dia.append(CMATRIX(1,1))
+    obj.ham_dia.set(0, 0, e+0.0j)
+
+    return obj
+
+
+def run(prms, ntraj, nsteps, dt, nskip):
+    """
+    Returns <K> / (1/2 * Nf * kT) over the steps after nskip and the largest drift of
+    E + E_bath over all the trajectories
+    """
+
+    params = {"k":[0.01, 0.02, 0.035]}
+    ndof = len(params["k"])
+
+    ham = nHamiltonian(1, 1, ndof)
+    ham.init_all(2)
+    children = []
+    for tr in range(ntraj):
+        children.append( nHamiltonian(1, 1, ndof) )
+        children[tr].init_all(2)
+        ham.add_child(children[tr])
+
+    q = MATRIX(ndof, ntraj);  p = MATRIX(ndof, ntraj);  iM = MATRIX(ndof, 1)
+    for i in range(ndof):
+        iM.set(i, 0, 1.0/2000.0)
+        for tr in range(ntraj):
+            q.set(i, tr, 0.1*(tr % 5) - 0.2*i)
+
+    therm = Ensemble_Thermostat(prms, ntraj, ndof)
+
+    ham.compute_diabatic(harmonic, q, params, 1)
+    ham.compute_adiabatic(1, 1)
+
+    def etot(tr):
+        e = 0.0
+        for i in range(ndof):
+            e = e + 0.5*iM.get(i,0)*p.get(i,tr)**2 + 0.5*params["k"][i]*q.get(i,tr)**2
+        return e + therm.energy(tr)
+
+    E0 = [etot(tr) for tr in range(ntraj)]
+
+    ekin, n = 0.0, 0
+    for step in range(nsteps):
+        Verlet1_nvt(dt, q, p, iM, ham, harmonic, params, therm)
+        if step >= nskip:
+            K = therm.kinetic_energies(p, iM)
+            for tr in range(ntraj):
+                ekin = ekin + K.get(tr);  n = n + 1
+
+    drift = max([abs(etot(tr) - E0[tr]) for tr in range(ntraj)])
+
+    return ekin / n / (0.5*therm.Nf*therm.kT()), drift
+
+
+class TestEnsembleThermostat(unittest.TestCase):
+
+    def check_temperature(self, prms):
+        ratio, drift = run(prms, 20, 3000, 10.0, 500)
+        print("%s: <K>/(Nf kT/2) = %8.4f" % (prms["thermostat_type"], ratio))
+        self.assertAlmostEqual(ratio, 1.0, delta=0.08)
+
+    def test_nose_hoover(self):
+        self.check_temperature({"thermostat_type":"Nose-Hoover", "Temperature":300.0, "NHC_size":3, "nu_therm":0.01})
+
+    def test_langevin(self):
+        self.check_temperature({"thermostat_type":"Langevin", "Temperature":300.0, "gamma":0.005})
+
+    def test_bussi(self):
+        self.check_temperature({"thermostat_type":"Bussi", "Temperature":300.0, "tau":200.0})
+
+    def test_andersen(self):
+        self.check_temperature({"thermostat_type":"Andersen", "Temperature":300.0, "nu_andersen":0.005})
+
+    def test_nhc_conservation(self):
+        """E + E_bath of every trajectory is conserved by the Nose-Hoover chains"""
+
+        prms = {"thermostat_type":"Nose-Hoover", "Temperature":300.0, "NHC_size":3, "nu_therm":0.01}
+        ratio, drift = run(prms, 5, 2000, 5.0, 0)
+        print("Nose-Hoover: max |d(E + E_bath)| = %g" % drift)
+        self.assertTrue(drift < 1e-5)
+
+    def test_readonly_sizes(self):
+        therm = Ensemble_Thermostat({"thermostat_type":"Bussi"}, 4, 3)
+        self.assertEqual(therm.ntraj, 4)
+        with self.assertRaises(AttributeError):
+            therm.ntraj = 10
+
+
+if __name__=='__main__':
+    unittest.main()
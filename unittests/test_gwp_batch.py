@@ -0,0 +1,125 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The batched GWP integrals: the overlap, kinetic and time-derivative matrices of a basis of
+ packets must agree element-wise with the pairwise functions gwp_overlap, gwp_kinetic,
+ gwp_coupling and gwp_dipole, and tau + tau^+ must be the time-derivative of the overlap
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+Ndof, N = 3, 4
+alp, hbar = 0.7, 1.0
+
+
+def make_basis():
+    q, p, gamma = MATRIX(Ndof, N), MATRIX(Ndof, N), MATRIX(N, 1)
+    dqdt, dpdt, dgamma = MATRIX(Ndof, N), MATRIX(Ndof, N), MATRIX(N, 1)
+
+    for k in range(Ndof):
+        for a in range(N):
+            q.set(k, a, 0.3*math.sin(1.0 + a + 2*k))
+            p.set(k, a, 1.5*math.cos(0.5*a - k))
+            dqdt.set(k, a, 0.01*(a + 1) - 0.02*k)
+            dpdt.set(k, a, -0.05*(a - k))
+
+    for a in range(N):
+        gamma.set(a, 0, 0.2*a - 0.1)
+        dgamma.set(a, 0, 0.03*a + 0.01)
+
+    return q, p, gamma, dqdt, dpdt, dgamma
+
+
+class TestGWPBatch(unittest.TestCase):
+
+    def test_ints(self):
+        """S and T of gwp_ints_batch vs gwp_overlap and -hbar^2/2 * gwp_kinetic (unit masses)"""
+
+        q, p, gamma, dqdt, dpdt, dgamma = make_basis()
+        iM = MATRIX(Ndof, 1)
+        for k in range(Ndof):
+            iM.set(k, 0, 1.0)
+
+        S, T = CMATRIX(N, N), CMATRIX(N, N)
+        gwp_ints_batch(q, p, gamma, iM, alp, hbar, S, T)
+        S1 = gwp_overlap_matrix(q, p, gamma, alp, hbar)
+        T1 = gwp_kinetic_matrix(q, p, gamma, iM, alp, hbar)
+
+        for a in range(N):
+            for b in range(N):
+                qa, pa, qb, pb = q.col(a), p.col(a), q.col(b), p.col(b)
+
+                s = gwp_overlap(qa, pa, gamma.get(a), qb, pb, gamma.get(b), alp, hbar)
+                t = -0.5*hbar*hbar*gwp_kinetic(qa, pa, gamma.get(a), qb, pb, gamma.get(b), alp, hbar)
+
+                self.assertTrue(abs(S.get(a, b) - s) < 1e-12)
+                self.assertTrue(abs(T.get(a, b) - t) < 1e-12)
+                self.assertTrue(abs(S1.get(a, b) - s) < 1e-12)
+                self.assertTrue(abs(T1.get(a, b) - t) < 1e-12)
+
+
+    def test_tdc(self):
+        """
+        tau_ab = <G_a|dG_b/dt> = sum_k { -<G_a|d/dr_k|G_b> * dq_bk/dt + (i/hbar) * <G_a|r_k - q_bk|G_b> * dp_bk/dt }
+                                 + (i/hbar) * S_ab * dgamma_b/dt
+        """
+
+        q, p, gamma, dqdt, dpdt, dgamma = make_basis()
+
+        S, tau = CMATRIX(N, N), CMATRIX(N, N)
+        S = gwp_overlap_matrix(q, p, gamma, alp, hbar)
+        gwp_tdc_batch(q, p, dqdt, dpdt, dgamma, alp, hbar, S, tau)
+
+        for a in range(N):
+            for b in range(N):
+                qa, pa, qb, pb = q.col(a), p.col(a), q.col(b), p.col(b)
+
+                s = gwp_overlap(qa, pa, gamma.get(a), qb, pb, gamma.get(b), alp, hbar)
+                c = gwp_coupling(qa, pa, gamma.get(a), qb, pb, gamma.get(b), alp, hbar)
+                d = gwp_dipole(qa, pa, gamma.get(a), qb, pb, gamma.get(b), alp, hbar)
+
+                t = 1.0j*s*dgamma.get(b)/hbar
+                for k in range(Ndof):
+                    t = t - c.get(k, 0)*dqdt.get(k, b) + (1.0j/hbar)*(d.get(k, 0) - qb.get(k, 0)*s)*dpdt.get(k, b)
+
+                self.assertTrue(abs(tau.get(a, b) - t) < 1e-12)
+
+
+    def test_tdc_overlap_derivative(self):
+        """tau + tau^+ = dS/dt, by the central finite differences along the linear path of the parameters"""
+
+        q, p, gamma, dqdt, dpdt, dgamma = make_basis()
+        h = 1e-5
+
+        S, tau = CMATRIX(N, N), CMATRIX(N, N)
+        S = gwp_overlap_matrix(q, p, gamma, alp, hbar)
+        gwp_tdc_batch(q, p, dqdt, dpdt, dgamma, alp, hbar, S, tau)
+
+        Sp = gwp_overlap_matrix(q + h*dqdt, p + h*dpdt, gamma + h*dgamma, alp, hbar)
+        Sm = gwp_overlap_matrix(q - h*dqdt, p - h*dpdt, gamma - h*dgamma, alp, hbar)
+
+        for a in range(N):
+            for b in range(N):
+                dS = (Sp.get(a, b) - Sm.get(a, b))/(2.0*h)
+                self.assertTrue(abs(tau.get(a, b) + tau.get(b, a).conjugate() - dS) < 1e-8)
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,109 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The native parallel-chain Metropolis sampler: the built-in harmonic density must give
+ <(x - x0)^2> = kT/k and <x> = x0 within the statistical error, the chains must be
+ converged (R-hat close to 1), and the samples must not depend on the number of OpenMP threads
+"""
+
+import os
+import sys
+import math
+import subprocess
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def to_list(x, typ):
+    res = typ()
+    for a in x:
+        res.append(a)
+    return res
+
+
+mass, omega, q0 = [2000.0, 1000.0], [0.005, 0.01], [0.5, -0.2]
+T = 300.0
+kT = T * 1.9872065e-3 / 627.5094709      # (boltzmann/hartree) * T, Ha
+nchains, nsamples = 8, 20000
+
+
+def sample():
+    target = HarmonicDensity(to_list(mass, doubleList), to_list(omega, doubleList), to_list(q0, doubleList), T)
+
+    x0 = MATRIX(2, nchains)
+    for c in range(nchains):
+        x0.set(0, c, q0[0] + 0.3*(c - 3.5)/3.5)
+        x0.set(1, c, q0[1] - 0.1*(c - 3.5)/3.5)
+
+    return metropolis_parallel(target, x0, nsamples, 2000, 0.2, 17)
+
+
+def print_checksum():
+    """The last samples of all the chains, with the full precision"""
+
+    res = sample()
+    for c in range(nchains):
+        s = res.get_samples(c)
+        print("%.17g %.17g" % (s.get(0, nsamples-1), s.get(1, nsamples-1)))
+
+
+
+class TestMetropolisParallel(unittest.TestCase):
+
+    def test_harmonic(self):
+        """<x> = x0 and <(x - x0)^2> = kT/(m*omega^2), within 5 standard errors (estimated with the ESS)"""
+
+        res = sample()
+
+        for i in range(2):
+            ave, ave2, n = 0.0, 0.0, 0
+            for c in range(nchains):
+                s = res.get_samples(c)
+                for k in range(nsamples):
+                    dq = s.get(i, k) - q0[i]
+                    ave = ave + dq
+                    ave2 = ave2 + dq*dq
+                    n = n + 1
+            ave, ave2 = ave/n, ave2/n
+
+            ref = kT / (mass[i]*omega[i]**2)
+            print("dof = %i <x - x0> = %g <(x - x0)^2> = %g kT/k = %g ESS = %g R-hat = %g" % (i, ave, ave2, ref, res.ess[i], res.rhat[i]))
+
+            self.assertTrue(abs(ave) < 5.0*math.sqrt(ref/res.ess[i]))
+            self.assertTrue(abs(ave2/ref - 1.0) < 5.0*math.sqrt(2.0/res.ess[i]))
+            self.assertTrue(abs(res.rhat[i] - 1.0) < 0.02)
+
+        for c in range(nchains):
+            self.assertTrue(res.acceptance[c] > 0.2 and res.acceptance[c] < 0.6)
+
+
+    def test_thread_count(self):
+        """The same samples with 1 and 3 OpenMP threads"""
+
+        cmd = [sys.executable, "-c", "import sys; sys.path.insert(0, %r); import test_metropolis_parallel as t; t.print_checksum()"
+               % os.path.dirname(os.path.abspath(__file__))]
+
+        out = []
+        for nt in ["1", "3"]:
+            env = dict(os.environ)
+            env["OMP_NUM_THREADS"] = nt
+            out.append(subprocess.check_output(cmd, env=env))
+
+        self.assertEqual(len(out[0].split()), 2*nchains)
+        self.assertEqual(out[0], out[1])
+
+
+if __name__=='__main__':
+    unittest.main()
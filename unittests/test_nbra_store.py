@@ -0,0 +1,86 @@
+#*********************************************************************************  
+#* Copyright (C) 2018 Alexey V. Akimov 
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version. 
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>. 
+#* 
+#*********************************************************************************/
+"""
+ Tests of the NBRA Hvib store: the access by the snapshot index and by the time,
+ and the runs that start late in the stored series
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def _make_series(nsteps, nstates):
+    """Hvib_ab(i) = (a + 0.1*i) on the diagonal and i*0.01*(a-b) on the off-diagonal (imaginary)"""
+
+    Hvib = CMATRIXList()
+    for i in range(0, nsteps):
+        h = CMATRIX(nstates, nstates)
+        for a in range(0, nstates):
+            h.set(a, a, (a + 0.1*i)*(1.0+0.0j))
+            for b in range(0, nstates):
+                if a!=b:
+                    h.set(a, b, 0.01*i*(a-b)*1.0j)
+        Hvib.append(h)
+
+    return Hvib
+
+
+class TestNBRAStore(unittest.TestCase):
+
+    def setUp(self):
+        self.dt = 41.0
+        self.store = NBRAStore(_make_series(10, 2), self.dt)
+
+    def test_snapshot(self):
+        """The integer argument is the snapshot index, the time axis is cyclic"""
+
+        H = self.store.get_Hvib_snapshot(3)
+        self.assertAlmostEqual(H.get(0,0).real, 0.3, 12)
+        self.assertAlmostEqual(H.get(1,1).real, 1.3, 12)
+        self.assertAlmostEqual(H.get(1,0).imag, 0.03, 12)
+
+        H = self.store.get_Hvib_snapshot(13)
+        self.assertAlmostEqual(H.get(0,0).real, 0.3, 12)
+
+    def test_time(self):
+        """The float argument is the time in a.u., Hvib is interpolated between the snapshots"""
+
+        H = self.store.get_Hvib_at(3.5*self.dt)
+        self.assertAlmostEqual(H.get(0,0).real, 0.35, 12)
+        self.assertAlmostEqual(H.get(1,0).imag, 0.035, 12)
+
+        # An integer time is still a time, not an index
+        H = self.store.get_Hvib_at(82)
+        self.assertAlmostEqual(H.get(0,0).real, 0.1*82.0/self.dt, 12)
+
+    def test_late_start(self):
+        """Runs started at different points of the series see the shifted Hamiltonians"""
+
+        prms = NBRAParams()
+        prms.nsteps = 4
+        prms.ntraj = 10
+        prms.method = 0
+
+        res = run_nbra(self.store, prms, Py2Cpp_int([7]), Py2Cpp_int([1]))
+        self.assertAlmostEqual(res.E_sh.get(0,0), 1.7, 12)
+        self.assertAlmostEqual(res.E_se.get(0,0), 1.7, 12)
+        self.assertEqual(res.ntraj, 10)
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,143 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The matrix-free Qeq solver: the charges of the all-pairs (PCG), the damped shifted (Wolf)
+ and the Ewald methods must agree with the dense solution of the bordered Qeq system built
+ from Coulomb_Integral, and the shifted pair terms must vanish at the cutoff
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_cluster():
+    """A distorted cube of 8 atoms, with the 2.8 Bohr edge"""
+
+    R, chi, J = VECTORList(), doubleList(), doubleList()
+    pos = [[0,0,0],[2.8,0,0],[0,2.8,0],[0,0,2.8],[2.8,2.8,0],[2.8,0,2.8],[0,2.8,2.8],[2.8,2.8,2.8]]
+
+    for i in range(8):
+        R.append(VECTOR(pos[i][0] + 0.3*(i%3), pos[i][1] - 0.2*(i%2), pos[i][2]))
+        chi.append(0.15 + 0.05*(i%4))
+        J.append(0.35 + 0.04*(i%3))
+
+    return R, chi, J
+
+
+def dense_charges(R, chi, J, kernel, epsilon, Qtot):
+    """
+    Solves  chi_i + sum_j { A_ij * q_j } = mu,  sum_i { q_i } = Qtot  with the explicit matrix
+    A_ii = J_i,  A_ij = Coulomb_Integral(R_ij)
+    """
+
+    n = len(R)
+    M = MATRIX(n+1, n+1)
+    rhs = MATRIX(n+1, 1)
+
+    for i in range(n):
+        for j in range(n):
+            if i==j:
+                M.set(i, j, J[i])
+            else:
+                rij = (R[i] - R[j]).length()
+                M.set(i, j, Coulomb_Integral(rij, 0, J[i], 0.0, "", 0.0, 0, J[j], 0.0, "", 0.0, epsilon, kernel))
+        M.set(i, n, -1.0)
+        M.set(n, i, 1.0)
+        rhs.set(i, 0, -chi[i])
+    rhs.set(n, 0, Qtot)
+
+    invM = MATRIX(n+1, n+1)
+    FullPivLU_inverse(M, invM)
+    x = invM * rhs
+
+    return [x.get(i, 0) for i in range(n)]
+
+
+class TestQeqSolver(unittest.TestCase):
+
+    def check_method(self, method, tol):
+        R, chi, J = make_cluster()
+
+        for kernel in [1, 2, 3]:
+            q_ref = dense_charges(R, chi, J, kernel, 1.5, 0.0)
+
+            solver = QeqSolver()
+            solver.kernel = kernel
+            solver.epsilon = 1.5
+            solver.method = method
+            solver.tol = 1e-10
+
+            if method==1:
+                solver.Rcut = 40.0
+                solver.alpha = 0.02
+            elif method==2:
+                L = 60.0
+                solver.set_cell(VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L))
+                solver.Rcut = 25.0
+                solver.ewald_tol = 1e-10
+
+            q = doubleList()
+            solver.set_system(R, chi, J)
+            solver.solve(0.0, q)
+
+            self.assertEqual(solver.is_converged, 1)
+            self.assertAlmostEqual(sum(q), 0.0, 10)
+
+            err = max([abs(q[i] - q_ref[i]) for i in range(len(R))])
+            print("kernel = %i method = %i max|q - q_dense| = %g" % (kernel, method, err))
+            self.assertTrue(err < tol)
+
+
+    def test_pcg(self):
+        """All pairs, no cutoff: the same matrix as the dense one"""
+        self.check_method(0, 1e-8)
+
+    def test_wolf(self):
+        """The weakly damped shifted sum with the cutoff beyond the cluster size"""
+        self.check_method(1, 1e-3)
+
+    def test_ewald(self):
+        """The cluster in a large periodic box"""
+        self.check_method(2, 1e-3)
+
+
+    def test_shifted_tail(self):
+        """
+        With alpha = 0 the pair terms are J_ij(r) - f/Rcut, which vanish at r = Rcut only if f is the
+        true asymptote of the kernel (1.2 for Nishimoto-Mataga-Weiss, 1/epsilon for 1/(epsilon*r))
+        """
+
+        R, chi, J = VECTORList(), doubleList(), doubleList()
+        R.append(VECTOR(0.0, 0.0, 0.0));    chi.append(0.2);  J.append(0.35)
+        R.append(VECTOR(399.0, 0.0, 0.0));  chi.append(0.2);  J.append(0.35)
+
+        for kernel in [1, 2, 3]:
+            solver = QeqSolver()
+            solver.kernel = kernel
+            solver.epsilon = 1.5
+            solver.method = 1
+            solver.Rcut = 400.0
+            solver.alpha = 0.0
+            solver.set_system(R, chi, J)
+
+            A = solver.dense_matrix()
+            self.assertTrue(abs(A.get(0, 1)) < 1e-4)
+
+
+if __name__=='__main__':
+    unittest.main()
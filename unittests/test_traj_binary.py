@@ -0,0 +1,149 @@
+#*********************************************************************************
+#* Copyright (C) 2018 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ The compact binary trajectory format: the frames written, appended and read back in a
+ random order must agree with the originals within the storage precision; an incomplete
+ last frame must be ignored by the reader and dropped by an appending writer
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+nat = 10
+ndof = 3*nat
+nstates = 2
+flags = TRJ_Q | TRJ_P | TRJ_F | TRJ_ISTATE | TRJ_AMP
+filename = "_test_traj.trj"
+
+
+def to_list(x, typ):
+    res = typ()
+    for a in x:
+        res.append(a)
+    return res
+
+
+def make_frame(s):
+    """The frame of the step s: all arrays are smooth functions of s"""
+
+    fr = TrajectoryFrame()
+    fr.step = s
+    fr.time = 0.5*s
+    fr.energies = to_list([-1.0 + 0.01*s, 0.5*s], doubleList)
+    fr.istate = to_list([s % nstates], intList)
+    fr.amp_re = to_list([math.cos(0.1*s), 0.3], doubleList)
+    fr.amp_im = to_list([math.sin(0.1*s), -0.7], doubleList)
+    fr.q = to_list([math.sin(0.3*i) + 0.01*s*i for i in range(ndof)], doubleList)
+    fr.p = to_list([0.5*math.cos(0.2*i + 0.05*s) for i in range(ndof)], doubleList)
+    fr.f = to_list([1e-3*(i - 15) + 1e-4*s for i in range(ndof)], doubleList)
+
+    return fr
+
+
+def write_frames(first, last, append):
+    w = BinaryTrajectoryWriter(filename, ndof, 1, nstates, 2, flags, append)
+    for s in range(first, last):
+        w.write_frame(make_frame(s))
+    w.close()
+
+
+def cleanup():
+    for name in [filename, filename + ".idx"]:
+        if os.path.exists(name):
+            os.remove(name)
+
+
+class TestTrajBinary(unittest.TestCase):
+
+    def check_frame(self, fr, s):
+        ref = make_frame(s)
+
+        self.assertEqual(fr.step, s)
+        self.assertEqual(fr.time, ref.time)
+        self.assertEqual(fr.istate[0], ref.istate[0])
+        for k in range(2):
+            self.assertEqual(fr.energies[k], ref.energies[k])
+            self.assertEqual(fr.amp_re[k], ref.amp_re[k])
+            self.assertEqual(fr.amp_im[k], ref.amp_im[k])
+
+        # The default precisions: 1e-3 for q and p, 1e-5 for f (the rounding error is a half of that)
+        for i in range(ndof):
+            self.assertTrue(abs(fr.q[i] - ref.q[i]) <= 0.5e-3 + 1e-12)
+            self.assertTrue(abs(fr.p[i] - ref.p[i]) <= 0.5e-3 + 1e-12)
+            self.assertTrue(abs(fr.f[i] - ref.f[i]) <= 0.5e-5 + 1e-12)
+
+
+    def test_append_random_access(self):
+        """Write 20 frames, append 10 more, read them in a scrambled order"""
+
+        cleanup()
+        write_frames(0, 20, 0)
+        write_frames(20, 30, 1)
+
+        r = BinaryTrajectoryReader(filename)
+        self.assertEqual(r.nframes(), 30)
+
+        for s in [29, 0, 17, 20, 3, 19, 25, 11]:
+            self.check_frame(r.read_frame(s), s)
+
+        cleanup()
+
+
+    def test_truncated_file(self):
+        """The incomplete last frame is skipped by the reader (also without the index) and overwritten on append"""
+
+        cleanup()
+        write_frames(0, 10, 0)
+
+        size = os.path.getsize(filename)
+        with open(filename, "r+b") as f:
+            f.truncate(size - 7)
+        os.remove(filename + ".idx")
+
+        r = BinaryTrajectoryReader(filename)
+        self.assertEqual(r.nframes(), 9)
+        self.check_frame(r.read_frame(8), 8)
+
+        write_frames(9, 12, 1)
+
+        r = BinaryTrajectoryReader(filename)
+        self.assertEqual(r.nframes(), 12)
+        for s in range(12):
+            self.check_frame(r.read_frame(s), s)
+
+        cleanup()
+
+
+    def test_empty_file(self):
+        """Appending to an empty file starts it with a new header"""
+
+        cleanup()
+        open(filename, "wb").close()
+
+        write_frames(0, 3, 1)
+
+        r = BinaryTrajectoryReader(filename)
+        self.assertEqual(r.nframes(), 3)
+        self.check_frame(r.read_frame(2), 2)
+
+        cleanup()
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,116 @@
+#*********************************************************************************  
+#* Copyright (C) 2018 Alexey V. Akimov 
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version. 
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>. 
+#* 
+#*********************************************************************************/
+"""
+ The adaptive TSH on the Tully's simple avoided crossing: the trajectories must refine
+ their steps when passing the crossing and return to the coarse step after it
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class tmp:
+    pass
+
+
+def compute_model(q, params, full_id):
+    """Tully's simple avoided crossing for the trajectory full_id[-1]"""
+
+    indx = Cpp2Py(full_id)[-1]
+
+    obj = tmp()
+    obj.ham_dia = CMATRIX(2,2)
+    obj.ovlp_dia = CMATRIX(2,2)
+    obj.d1ham_dia = CMATRIXList();  obj.d1ham_dia.append( CMATRIX(2,2) )
+    obj.dc1_dia = CMATRIXList();  obj.dc1_dia.append( CMATRIX(2,2) )
+
+    qq = doubleList();  qq.append(q.get(0, indx))
+    model_SAC(obj.ham_dia, obj.ovlp_dia, obj.d1ham_dia, obj.dc1_dia, qq, doubleList())
+    obj.rep = 0
+
+    return obj
+
+
+class TestTSHAdaptive(unittest.TestCase):
+
+    def test_split_and_merge(self):
+
+        ntraj, nst, ndof = 4, 2, 1
+        dt, p0, mass = 40.0, 20.0, 2000.0
+
+        ham = nHamiltonian(nst, nst, ndof)
+        ham.init_all(2)
+        children = []
+        for tr in range(ntraj):
+            children.append( nHamiltonian(nst, nst, ndof) )
+            children[tr].init_all(2)
+            ham.add_child(children[tr])
+
+        q = MATRIX(ndof, ntraj);  p = MATRIX(ndof, ntraj);  iM = MATRIX(ndof, 1)
+        iM.set(0, 0, 1.0/mass)
+        C = CMATRIX(nst, ntraj)
+        for tr in range(ntraj):
+            q.set(0, tr, -8.0);  p.set(0, tr, p0);  C.set(0, tr, 1.0+0.0j)
+        states = Py2Cpp_int([0]*ntraj)
+
+        params = {}
+        params1 = {"rep":1, "tsh_method":0}
+
+        ham.compute_diabatic(compute_model, q, params, 1)
+        ham.compute_adiabatic(1, 1)
+
+        rnd = Random()
+        ctrl = TSH_Adaptive_Control(ntraj)
+        ctrl.max_level = 5
+
+        # Cross the coupling region at x = 0 and leave it
+        nsteps = int(16.0 / (p0/mass) / dt)
+        for i in range(nsteps):
+            tsh1_adaptive(dt, q, p, iM, C, states, ham, compute_model, params, params1, rnd, ctrl)
+
+        for tr in range(ntraj):
+            print("traj %i: nsplit = %i nmerge = %i level = %i max_dE = %g" % 
+                  (tr, ctrl.nsplit[tr], ctrl.nmerge[tr], ctrl.level[tr], ctrl.max_dE[tr]))
+
+            self.assertTrue(ctrl.nsplit[tr] >= 1)
+            self.assertEqual(ctrl.nsplit[tr], ctrl.nmerge[tr])
+            self.assertEqual(ctrl.level[tr], 0)
+            self.assertAlmostEqual(ctrl.time[tr], nsteps*dt, 8)
+
+            # The substeps of the log cover the whole run
+            log = ctrl.get_log(tr)
+            tsum = 0.0
+            for r in range(log.num_of_rows):
+                tsum = tsum + log.get(r, 1)
+            self.assertAlmostEqual(tsum, nsteps*dt, 8)
+            self.assertTrue(log.num_of_rows > nsteps)
+
+            self.assertTrue(ctrl.max_dE[tr] < 1e-3)
+
+            # Every substep is checked for the reversibility (rev_stride = 1)
+            self.assertEqual(log.num_of_cols, 11)
+            for r in range(log.num_of_rows):
+                self.assertTrue(log.get(r, 8) >= 0.0 and log.get(r, 9) >= 0.0 and log.get(r, 10) >= 0.0)
+            self.assertTrue(ctrl.max_rev[tr] < 1e-6)
+
+        # Far fewer Hamiltonian evaluations than with the finest step everywhere
+        self.assertTrue(ctrl.nevals < nsteps * 2**ctrl.max_level / 4)
+
+
+if __name__=='__main__':
+    unittest.main()